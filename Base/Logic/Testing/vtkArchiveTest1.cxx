@@ -166,6 +166,43 @@ int vtkArchiveTest1(int argc, char * argv[] )
     std::cerr << "failed to extract archive : " << "extractedArchiveTest" << std::endl;
     return EXIT_FAILURE;
     }
+  vtksys::SystemTools::ChangeDirectory("..");
+
+  //
+  // read a single entry in memory
+  //
+  std::string content;
+  res = read_archive_entry(zipFilePath.c_str(), "archiveTest/vol.mrml", content);
+  if (!res || content.find("<MRML") == std::string::npos)
+    {
+    std::cerr << "failed to read archive entry archiveTest/vol.mrml" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (read_archive_entry(zipFilePath.c_str(), "archiveTest/missing.mrml", content))
+    {
+    std::cerr << "read a missing archive entry" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // extract a single entry
+  //
+  if ( vtksys::SystemTools::FileExists("partialArchiveTest") )
+    {
+    vtksys::SystemTools::RemoveADirectory("partialArchiveTest");
+    }
+  vtksys::SystemTools::MakeDirectory("partialArchiveTest");
+  std::set<std::string> entries;
+  entries.insert("archiveTest/vol_and_cube.mrml");
+  std::vector<std::string> extractedFiles;
+  res = extract_archive_entries(zipFilePath.c_str(), "partialArchiveTest", entries, &extractedFiles);
+  if (!res || extractedFiles.size() != 1
+      || !vtksys::SystemTools::FileExists("partialArchiveTest/archiveTest/vol_and_cube.mrml")
+      || vtksys::SystemTools::FileExists("partialArchiveTest/archiveTest/vol.mrml"))
+    {
+    std::cerr << "failed to extract archive entry archiveTest/vol_and_cube.mrml" << std::endl;
+    return EXIT_FAILURE;
+    }
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,197 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// MRML includes
+#include <vtkMRMLAbstractLogic.h>
+
+// VTK includes
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+
+// ITKSYS includes
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+class vtkTaskRecorderLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkTaskRecorderLogic *New();
+  vtkTypeMacro(vtkTaskRecorderLogic, vtkMRMLAbstractLogic);
+
+  /// Task function: block while Blocked is set, then record the task id.
+  void RecordTask(void* clientData)
+    {
+    int taskId = *reinterpret_cast<int*>(clientData);
+    while (this->IsBlocked())
+      {
+      itksys::SystemTools::Delay(10);
+      }
+    this->Lock.Lock();
+    this->ExecutedTasks.push_back(taskId);
+    this->Lock.Unlock();
+    }
+
+  void SetBlocked(bool blocked)
+    {
+    this->Lock.Lock();
+    this->Blocked = blocked;
+    this->Lock.Unlock();
+    }
+  bool IsBlocked()
+    {
+    this->Lock.Lock();
+    bool blocked = this->Blocked;
+    this->Lock.Unlock();
+    return blocked;
+    }
+  std::vector<int> GetExecutedTasks()
+    {
+    this->Lock.Lock();
+    std::vector<int> tasks = this->ExecutedTasks;
+    this->Lock.Unlock();
+    return tasks;
+    }
+
+protected:
+  vtkTaskRecorderLogic() : Blocked(false) {}
+  ~vtkTaskRecorderLogic() {}
+
+  vtkSimpleMutexLock Lock;
+  bool Blocked;
+  std::vector<int> ExecutedTasks;
+};
+vtkStandardNewMacro(vtkTaskRecorderLogic);
+
+//----------------------------------------------------------------------------
+bool WaitForCompletedTasks(vtkSlicerApplicationLogic* appLogic, unsigned long expected)
+{
+  for (int i = 0; i < 500; ++i)
+    {
+    if (appLogic->GetNumberOfCompletedTasks() + appLogic->GetNumberOfCanceledTasks() >= expected)
+      {
+      return true;
+      }
+    itksys::SystemTools::Delay(10);
+    }
+  std::cerr << "Timeout while waiting for " << expected << " tasks" << std::endl;
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void ScheduleRecordTask(vtkSlicerApplicationLogic* appLogic, vtkTaskRecorderLogic* logic,
+                        int* taskId, int priority, vtkSlicerTask* task = 0)
+{
+  vtkNew<vtkSlicerTask> newTask;
+  if (!task)
+    {
+    task = newTask.GetPointer();
+    }
+  task->SetTypeToProcessing();
+  task->SetPriority(priority);
+  task->SetTaskFunction(logic, (vtkSlicerTask::TaskFunctionPointer)
+                        &vtkTaskRecorderLogic::RecordTask, taskId);
+  appLogic->ScheduleTask(task);
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerApplicationLogicTest2(int , char * [])
+{
+  int taskIds[] = {0, 1, 2, 3, 4};
+
+  vtkNew<vtkTaskRecorderLogic> logic;
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+
+  // Tasks can't be scheduled before the threads are started
+  vtkNew<vtkSlicerTask> task;
+  CHECK_INT(appLogic->ScheduleTask(task.GetPointer()), 0);
+
+  // Use a single worker to check the order of execution
+  appLogic->SetNumberOfProcessingThreads(1);
+  CHECK_INT(appLogic->GetNumberOfProcessingThreads(), 1);
+  appLogic->CreateProcessingThread();
+
+  // First task blocks the worker while the others are queued
+  logic->SetBlocked(true);
+  ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[0], 0);
+  while (appLogic->GetNumberOfRunningTasks() == 0)
+    {
+    itksys::SystemTools::Delay(10);
+    }
+
+  vtkNew<vtkSlicerTask> canceledTask;
+  ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[1], 0);
+  ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[2], 0, canceledTask.GetPointer());
+  ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[3], 10);
+  ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[4], 0);
+  canceledTask->Cancel();
+  CHECK_INT(appLogic->GetNumberOfQueuedTasks(), 4);
+
+  logic->SetBlocked(false);
+  CHECK_BOOL(WaitForCompletedTasks(appLogic.GetPointer(), 5), true);
+
+  // High priority task runs first, canceled task is skipped,
+  // equal priority tasks run in scheduling order.
+  std::vector<int> executedTasks = logic->GetExecutedTasks();
+  CHECK_INT(static_cast<int>(executedTasks.size()), 4);
+  CHECK_INT(executedTasks[0], 0);
+  CHECK_INT(executedTasks[1], 3);
+  CHECK_INT(executedTasks[2], 1);
+  CHECK_INT(executedTasks[3], 4);
+
+  CHECK_INT(appLogic->GetNumberOfCompletedTasks(), 4);
+  CHECK_INT(appLogic->GetNumberOfCanceledTasks(), 1);
+  CHECK_INT(appLogic->GetNumberOfQueuedTasks(), 0);
+  CHECK_BOOL(appLogic->GetTotalTaskWaitTime() > 0., true);
+  CHECK_BOOL(appLogic->GetTotalTaskRunTime() > 0., true);
+
+  appLogic->ResetTaskStatistics();
+  CHECK_INT(appLogic->GetNumberOfCompletedTasks(), 0);
+
+  appLogic->TerminateProcessingThread();
+
+  // Several workers run tasks concurrently: blocked tasks occupy all of them.
+  appLogic->SetNumberOfProcessingThreads(3);
+  appLogic->CreateProcessingThread();
+  logic->SetBlocked(true);
+  for (int i = 0; i < 3; ++i)
+    {
+    ScheduleRecordTask(appLogic.GetPointer(), logic.GetPointer(), &taskIds[i], 0);
+    }
+  for (int i = 0; i < 500 && appLogic->GetNumberOfRunningTasks() < 3; ++i)
+    {
+    itksys::SystemTools::Delay(10);
+    }
+  CHECK_INT(appLogic->GetNumberOfRunningTasks(), 3);
+  logic->SetBlocked(false);
+  CHECK_BOOL(WaitForCompletedTasks(appLogic.GetPointer(), 3), true);
+
+  appLogic->TerminateProcessingThread();
+
+  return EXIT_SUCCESS;
+}
@@ -354,6 +354,7 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
        ( !(cm->GetEnableForceRedownload())) )
     {
     dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
+    cm->TouchCachedFile ( dest );
     vtkDebugMacro("QueueRead: the destination file is there and we're not forceing redownload");
     return 1;
     }
@@ -716,7 +717,11 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
         {
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
         this->GetApplicationLogic()->RequestModified( dt );
-        handler->StageFileRead( source, dest);
+        handler->StageFileRead( source, dest, dt );
+        if ( iom->GetCacheManager() != NULL )
+          {
+          iom->GetCacheManager()->AddCachedFile( dest, source );
+          }
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Completed );
         this->GetApplicationLogic()->RequestModified( dt );
 
@@ -758,7 +763,11 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
       else
         {
         vtkDebugMacro("ApplyTransfer: stage file read on the handler..., source = " << source << ", dest = " << dest);
-        handler->StageFileRead( source, dest);
+        handler->StageFileRead( source, dest, dt );
+        if ( iom != NULL && iom->GetCacheManager() != NULL )
+          {
+          iom->GetCacheManager()->AddCachedFile( dest, source );
+          }
         }
       }
     }
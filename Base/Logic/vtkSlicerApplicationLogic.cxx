@@ -34,6 +34,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkTimerLog.h>
 
 // ITKSYS includes
 #include <itksys/SystemTools.hxx>
@@ -49,10 +50,75 @@
 
 #include <queue>
 
+// ITK includes
+#include <itkConditionVariable.h>
+
 #include "vtkSlicerApplicationLogicRequests.h"
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
+struct ProcessingTaskEntry
+{
+  vtkSmartPointer<vtkSlicerTask> Task;
+  int Priority;
+  /// Order of scheduling, used to run tasks of equal priority first-in first-out
+  unsigned long Sequence;
+  /// Time at which the task has been scheduled
+  double ScheduledTime;
+};
+
+//----------------------------------------------------------------------------
+struct ProcessingTaskEntryCompare
+{
+  bool operator()(const ProcessingTaskEntry& a, const ProcessingTaskEntry& b) const
+    {
+    if (a.Priority != b.Priority)
+      {
+      return a.Priority < b.Priority;
+      }
+    return a.Sequence > b.Sequence;
+    }
+};
+
+//----------------------------------------------------------------------------
+// Priority queue of tasks shared by a pool of worker threads.
+// Workers wait on Condition while the queue is empty instead of polling.
+class ProcessingTaskQueue
+  : public std::priority_queue<ProcessingTaskEntry,
+                               std::vector<ProcessingTaskEntry>,
+                               ProcessingTaskEntryCompare>
+{
+public:
+  ProcessingTaskQueue()
+    {
+    this->Condition = itk::ConditionVariable::New();
+    this->Active = false;
+    this->NextSequence = 0;
+    this->NumberOfRunningTasks = 0;
+    this->ResetStatistics();
+    }
+  void ResetStatistics()
+    {
+    this->NumberOfCompletedTasks = 0;
+    this->NumberOfCanceledTasks = 0;
+    this->TotalWaitTime = 0.;
+    this->MaximumWaitTime = 0.;
+    this->TotalRunTime = 0.;
+    }
+
+  /// Protects the queue and all the members below
+  itk::SimpleMutexLock Lock;
+  itk::ConditionVariable::Pointer Condition;
+  bool Active;
+  unsigned long NextSequence;
+  unsigned int NumberOfRunningTasks;
+  unsigned long NumberOfCompletedTasks;
+  unsigned long NumberOfCanceledTasks;
+  double TotalWaitTime;
+  double MaximumWaitTime;
+  double TotalRunTime;
+};
+
+//----------------------------------------------------------------------------
 class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
 class ReadDataQueue : public std::queue<DataRequest*> {};
 class WriteDataQueue : public std::queue<DataRequest*> {};
@@ -64,10 +130,10 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::MultiThreader::New();
-  this->ProcessingThreadId = -1;
+  this->NumberOfProcessingThreads = 0;
+  this->NumberOfNetworkingThreads = 4;
   this->ProcessingThreadActive = false;
   this->ProcessingThreadActiveLock = itk::MutexLock::New();
-  this->ProcessingTaskQueueLock = itk::MutexLock::New();
 
   this->ModifiedQueueActive = false;
   this->ModifiedQueueActiveLock = itk::MutexLock::New();
@@ -82,6 +148,7 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
   this->WriteDataQueueLock = itk::MutexLock::New();
 
   this->InternalTaskQueue = new ProcessingTaskQueue;
+  this->InternalNetworkingTaskQueue = new ProcessingTaskQueue;
   this->InternalModifiedQueue = new ModifiedQueue;
 
   this->InternalReadDataQueue = new ReadDataQueue;
@@ -92,22 +159,12 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 {
   // Note that TerminateThread does not kill a thread, it only waits
-  // for the thread to finish.  We need to signal the thread that we
+  // for the thread to finish.  We need to signal the threads that we
   // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
-    {
-    // Signal the processingThread that we are terminating.
-    this->ProcessingThreadActiveLock->Lock();
-    this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-
-    this->ProcessingThreadId = -1;
-    }
+  this->TerminateProcessingThread();
 
   delete this->InternalTaskQueue;
+  delete this->InternalNetworkingTaskQueue;
 
   this->ModifiedQueueLock->Lock();
   while (!(*this->InternalModifiedQueue).empty())
@@ -181,41 +238,102 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
   this->vtkObject::PrintSelf(os, indent);
 
   os << indent << "SlicerApplicationLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NumberOfProcessingThreads: " << this->GetNumberOfProcessingThreads() << "\n";
+  os << indent << "NumberOfNetworkingThreads: " << this->GetNumberOfNetworkingThreads() << "\n";
+  os << indent << "NumberOfQueuedTasks: " << this->GetNumberOfQueuedTasks() << "\n";
+  os << indent << "NumberOfRunningTasks: " << this->GetNumberOfRunningTasks() << "\n";
+  os << indent << "NumberOfCompletedTasks: " << this->GetNumberOfCompletedTasks() << "\n";
+  os << indent << "NumberOfCanceledTasks: " << this->GetNumberOfCanceledTasks() << "\n";
+  os << indent << "TotalTaskWaitTime: " << this->GetTotalTaskWaitTime() << "\n";
+  os << indent << "MaximumTaskWaitTime: " << this->GetMaximumTaskWaitTime() << "\n";
+  os << indent << "TotalTaskRunTime: " << this->GetTotalTaskRunTime() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetNumberOfProcessingThreads(int numberOfThreads)
+{
+  if (this->NumberOfProcessingThreads == numberOfThreads)
+    {
+    return;
+    }
+  if (!this->ProcessingThreadIDs.empty())
+    {
+    vtkWarningMacro("SetNumberOfProcessingThreads: processing threads are already running, "
+                    "the new value is used at the next call to CreateProcessingThread()");
+    }
+  this->NumberOfProcessingThreads = numberOfThreads;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfProcessingThreads()
+{
+  int numberOfThreads = this->NumberOfProcessingThreads;
+  if (numberOfThreads < 1)
+    {
+    numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  // Keep room in the threader for the networking threads.
+  return std::max(1, std::min(numberOfThreads,
+                              ITK_MAX_THREADS - this->GetNumberOfNetworkingThreads()));
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetNumberOfNetworkingThreads(int numberOfThreads)
+{
+  if (this->NumberOfNetworkingThreads == numberOfThreads)
+    {
+    return;
+    }
+  if (!this->NetworkingThreadIDs.empty())
+    {
+    vtkWarningMacro("SetNumberOfNetworkingThreads: networking threads are already running, "
+                    "the new value is used at the next call to CreateProcessingThread()");
+    }
+  this->NumberOfNetworkingThreads = numberOfThreads;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfNetworkingThreads()
+{
+  return std::max(1, std::min(this->NumberOfNetworkingThreads, ITK_MAX_THREADS / 2));
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
     {
     this->ProcessingThreadActiveLock->Lock();
     this->ProcessingThreadActive = true;
     this->ProcessingThreadActiveLock->Unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
-
-    // Start four network threads (TODO: make the number of threads a setting)
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    /*
-     * TODO: it looks like curl is not thread safe by default
-     * - maybe there's a setting that cmcurl can have
-     *   similar to the --enable-threading of the standard curl build
-     *
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    */
+    ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+    for (int i = 0; i < 2; ++i)
+      {
+      queues[i]->Lock.Lock();
+      queues[i]->Active = true;
+      queues[i]->Lock.Unlock();
+      }
+
+    const int numberOfThreads = this->GetNumberOfProcessingThreads();
+    for (int i = 0; i < numberOfThreads; ++i)
+      {
+      this->ProcessingThreadIDs.push_back( this->ProcessingThreader
+          ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                        this) );
+      }
+
+    // Networking threads. curl handles are not shared between threads:
+    // vtkHTTPHandler runs all its transfers from its own engine thread.
+    const int numberOfNetworkingThreads = this->GetNumberOfNetworkingThreads();
+    for (int i = 0; i < numberOfNetworkingThreads; ++i)
+      {
+      this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
+            ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
+                      this) );
+      }
 
     // Setup the communication channel back to the main thread
     this->ModifiedQueueActiveLock->Lock();
@@ -238,7 +356,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
     {
     this->ModifiedQueueActiveLock->Lock();
     this->ModifiedQueueActive = false;
@@ -256,18 +374,30 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock->Unlock();
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    // Wake up all the idle workers so that they notice the termination
+    ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+    for (int i = 0; i < 2; ++i)
+      {
+      queues[i]->Lock.Lock();
+      queues[i]->Active = false;
+      queues[i]->Condition->Broadcast();
+      queues[i]->Lock.Unlock();
+      }
 
     std::vector<int>::const_iterator idIterator;
-    idIterator = this->NetworkingThreadIDs.begin();
-    while (idIterator != this->NetworkingThreadIDs.end())
+    for (idIterator = this->ProcessingThreadIDs.begin();
+         idIterator != this->ProcessingThreadIDs.end(); ++idIterator)
       {
       this->ProcessingThreader->TerminateThread( *idIterator );
-      ++idIterator;
       }
-    this->NetworkingThreadIDs.clear();
+    this->ProcessingThreadIDs.clear();
 
+    for (idIterator = this->NetworkingThreadIDs.begin();
+         idIterator != this->NetworkingThreadIDs.end(); ++idIterator)
+      {
+      this->ProcessingThreader->TerminateThread( *idIterator );
+      }
+    this->NetworkingThreadIDs.clear();
     }
 }
 
@@ -310,47 +440,50 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
+  this->ProcessTaskQueue(this->InternalTaskQueue);
+}
 
-  while (active)
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessTaskQueue(ProcessingTaskQueue* queue)
+{
+  while (true)
     {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    if (active)
+    // pull a task off the queue, sleep until one is available
+    queue->Lock.Lock();
+    while (queue->Active && queue->empty())
       {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
-      this->ProcessingTaskQueueLock->Unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = 0;
-        }
+      queue->Condition->Wait(&queue->Lock);
       }
-
-    // busy wait
-    itksys::SystemTools::Delay(100);
+    if (!queue->Active)
+      {
+      queue->Lock.Unlock();
+      break;
+      }
+    ProcessingTaskEntry entry = queue->top();
+    queue->pop();
+    if (entry.Task->GetCanceled())
+      {
+      ++queue->NumberOfCanceledTasks;
+      queue->Lock.Unlock();
+      continue;
+      }
+    double startTime = vtkTimerLog::GetUniversalTime();
+    double waitTime = startTime - entry.ScheduledTime;
+    queue->TotalWaitTime += waitTime;
+    queue->MaximumWaitTime = std::max(queue->MaximumWaitTime, waitTime);
+    ++queue->NumberOfRunningTasks;
+    queue->Lock.Unlock();
+
+    entry.Task->Execute();
+    double runTime = vtkTimerLog::GetUniversalTime() - startTime;
+    // release the task (and the logic it references) outside of the lock
+    entry.Task = 0;
+
+    queue->Lock.Lock();
+    --queue->NumberOfRunningTasks;
+    ++queue->NumberOfCompletedTasks;
+    queue->TotalRunTime += runTime;
+    queue->Lock.Unlock();
     }
 }
 
@@ -392,46 +525,7 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
-
-  while (active)
-    {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    if (active)
-      {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
-      this->ProcessingTaskQueueLock->Unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = 0;
-        }
-      }
-
-    // busy wait
-    itksys::SystemTools::Delay(100);
-    }
+  this->ProcessTaskQueue(this->InternalNetworkingTaskQueue);
 }
 
 //----------------------------------------------------------------------------
@@ -441,17 +535,138 @@ int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
   this->ProcessingThreadActiveLock->Lock();
   int active = this->ProcessingThreadActive;
   this->ProcessingThreadActiveLock->Unlock();
-  if (!active)
+  if (!active || !task)
     {
     return false;
     }
 
-  this->ProcessingTaskQueueLock->Lock();
-  (*this->InternalTaskQueue).push( task );
-  this->ProcessingTaskQueueLock->Unlock();
+  ProcessingTaskQueue* queue = (task->GetType() == vtkSlicerTask::Networking ?
+    this->InternalNetworkingTaskQueue : this->InternalTaskQueue);
+
+  ProcessingTaskEntry entry;
+  entry.Task = task;
+  entry.Priority = task->GetPriority();
+  entry.ScheduledTime = vtkTimerLog::GetUniversalTime();
+
+  queue->Lock.Lock();
+  entry.Sequence = queue->NextSequence++;
+  queue->push(entry);
+  // wake up one idle worker
+  queue->Condition->Signal();
+  queue->Lock.Unlock();
   return true;
 }
 
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetNumberOfQueuedTasks()
+{
+  unsigned int count = 0;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    count += static_cast<unsigned int>(queues[i]->size());
+    queues[i]->Lock.Unlock();
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetNumberOfRunningTasks()
+{
+  unsigned int count = 0;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    count += queues[i]->NumberOfRunningTasks;
+    queues[i]->Lock.Unlock();
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSlicerApplicationLogic::GetNumberOfCompletedTasks()
+{
+  unsigned long count = 0;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    count += queues[i]->NumberOfCompletedTasks;
+    queues[i]->Lock.Unlock();
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSlicerApplicationLogic::GetNumberOfCanceledTasks()
+{
+  unsigned long count = 0;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    count += queues[i]->NumberOfCanceledTasks;
+    queues[i]->Lock.Unlock();
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetTotalTaskWaitTime()
+{
+  double time = 0.;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    time += queues[i]->TotalWaitTime;
+    queues[i]->Lock.Unlock();
+    }
+  return time;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetMaximumTaskWaitTime()
+{
+  double time = 0.;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    time = std::max(time, queues[i]->MaximumWaitTime);
+    queues[i]->Lock.Unlock();
+    }
+  return time;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetTotalTaskRunTime()
+{
+  double time = 0.;
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    time += queues[i]->TotalRunTime;
+    queues[i]->Lock.Unlock();
+    }
+  return time;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ResetTaskStatistics()
+{
+  ProcessingTaskQueue* queues[2] = {this->InternalTaskQueue, this->InternalNetworkingTaskQueue};
+  for (int i = 0; i < 2; ++i)
+    {
+    queues[i]->Lock.Lock();
+    queues[i]->ResetStatistics();
+    queues[i]->Lock.Unlock();
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestModified(vtkObject *obj)
 {
@@ -69,11 +69,53 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// (display it in the Fiducials GUI)
   void PropagateFiducialListSelection();
 
-  /// Create a thread for processing
+  /// Create the processing threads.
+  /// A pool of GetNumberOfProcessingThreads() workers is started for
+  /// processing tasks, and a pool of GetNumberOfNetworkingThreads() workers
+  /// for networking tasks.
+  /// Workers sleep until a task is scheduled.
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing threads.
+  /// Running tasks are waited for, queued tasks are not executed.
   void TerminateProcessingThread();
+
+  /// Set the number of threads used to run processing tasks.
+  /// A value smaller than 1 (default) uses the number of cores reported by
+  /// itk::MultiThreader::GetGlobalDefaultNumberOfThreads().
+  /// Must be called before CreateProcessingThread() to have an effect.
+  void SetNumberOfProcessingThreads(int numberOfThreads);
+  /// Return the number of threads that are (or will be) used to run
+  /// processing tasks.
+  int GetNumberOfProcessingThreads();
+
+  /// Set the number of threads used to run networking tasks (4 by default).
+  /// Networking tasks mostly wait for remote servers, several of them are run
+  /// concurrently so that the URI handlers can pipeline the transfers.
+  /// Must be called before CreateProcessingThread() to have an effect.
+  void SetNumberOfNetworkingThreads(int numberOfThreads);
+  int GetNumberOfNetworkingThreads();
+
+  /// Return the number of scheduled tasks (processing and networking) that
+  /// have not started yet.
+  unsigned int GetNumberOfQueuedTasks();
+  /// Return the number of tasks currently being executed.
+  unsigned int GetNumberOfRunningTasks();
+  /// Return the number of tasks that have been executed since the
+  /// last call to ResetTaskStatistics().
+  unsigned long GetNumberOfCompletedTasks();
+  /// Return the number of tasks that have been dropped because they were
+  /// canceled before being executed.
+  unsigned long GetNumberOfCanceledTasks();
+  /// Return the cumulated time (in seconds) tasks spent in the queue
+  /// before being executed.
+  double GetTotalTaskWaitTime();
+  /// Return the longest time (in seconds) a task spent in the queue.
+  double GetMaximumTaskWaitTime();
+  /// Return the cumulated execution time (in seconds) of the completed tasks.
+  double GetTotalTaskRunTime();
+  /// Reset completed/canceled counters and wait/run times.
+  void ResetTaskStatistics();
   /// List of events potentially fired by the application logic
   enum RequestEvents
     {
@@ -90,6 +132,10 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// Schedule a task to run in the processing thread. Returns true if
   /// task was successfully scheduled. ScheduleTask() is called from the
   /// main thread to run something in the processing thread.
+  /// Networking tasks are run by the networking thread, any other task is
+  /// run by the first idle processing thread. Tasks with higher
+  /// vtkSlicerTask::GetPriority() are started first.
+  /// \sa vtkSlicerTask::Cancel()
   int ScheduleTask( vtkSlicerTask* );
 
   /// Request a Modified call on an object.  This method allows a
@@ -223,6 +269,10 @@ protected:
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
 
+  /// Wait for tasks on \a queue and execute them until the queue is
+  /// deactivated.
+  void ProcessTaskQueue(ProcessingTaskQueue* queue);
+
   /// Process a request to read data into a scene.  This method is
   /// called by ProcessReadData() in the application main thread
   /// because calls to load data will cause a Modified() on a node
@@ -236,7 +286,6 @@ private:
 
   itk::MultiThreader::Pointer ProcessingThreader;
   itk::MutexLock::Pointer ProcessingThreadActiveLock;
-  itk::MutexLock::Pointer ProcessingTaskQueueLock;
   itk::MutexLock::Pointer ModifiedQueueActiveLock;
   itk::MutexLock::Pointer ModifiedQueueLock;
   itk::MutexLock::Pointer ReadDataQueueActiveLock;
@@ -244,14 +293,17 @@ private:
   itk::MutexLock::Pointer WriteDataQueueActiveLock;
   itk::MutexLock::Pointer WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
   std::vector<int> NetworkingThreadIDs;
+  int NumberOfProcessingThreads;
+  int NumberOfNetworkingThreads;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
   int ReadDataQueueActive;
   int WriteDataQueueActive;
 
   ProcessingTaskQueue* InternalTaskQueue;
+  ProcessingTaskQueue* InternalNetworkingTaskQueue;
   ModifiedQueue*       InternalModifiedQueue;
   ReadDataQueue*       InternalReadDataQueue;
   WriteDataQueue*      InternalWriteDataQueue;
@@ -163,8 +163,10 @@ public:
     if (m_DeleteFile)
      {
       int removed;
-      // is it a shared memory location?
-      if (m_Filename.find("slicer:") != std::string::npos)
+      // is it a shared memory location? (MRML scene or shared memory
+      // segment already removed by the CLI logic)
+      if (m_Filename.find("slicer:") != std::string::npos ||
+          m_Filename.compare(0, 4, "shm:") == 0)
         {
         removed = 1;
         }
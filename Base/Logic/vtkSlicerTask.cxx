@@ -1,6 +1,7 @@
 #include "vtkSlicerTask.h"
 
 // VTK includes
+#include <vtkMutexLock.h>
 #include <vtkObjectFactory.h>
 
 //----------------------------------------------------------------------------
@@ -11,11 +12,16 @@ vtkSlicerTask::vtkSlicerTask()
 {
   this->TaskObject = 0;
   this->TaskFunction = 0;
+  this->TaskClientData = 0;
   this->Type = vtkSlicerTask::Undefined;
+  this->Priority = 0;
+  this->Canceled = false;
+  this->CanceledLock = vtkSimpleMutexLock::New();
 }
 //----------------------------------------------------------------------------
 vtkSlicerTask::~vtkSlicerTask()
 {
+  this->CanceledLock->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -37,8 +43,29 @@ void vtkSlicerTask::Execute()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerTask::Cancel()
+{
+  this->CanceledLock->Lock();
+  this->Canceled = true;
+  this->CanceledLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerTask::GetCanceled()
+{
+  this->CanceledLock->Lock();
+  bool canceled = this->Canceled;
+  this->CanceledLock->Unlock();
+  return canceled;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerTask::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "Type: " << this->GetTypeAsString() << "\n";
+  os << indent << "Priority: " << this->Priority << "\n";
+  os << indent << "Canceled: " << this->GetCanceled() << "\n";
 }
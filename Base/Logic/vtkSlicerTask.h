@@ -6,6 +6,8 @@
 #include "vtkMRMLAbstractLogic.h"
 #include "vtkSlicerBaseLogic.h"
 
+class vtkSimpleMutexLock;
+
 class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerTask : public vtkObject
 {
 public:
@@ -38,6 +40,21 @@ public:
   void SetTypeToProcessing() {this->SetType(vtkSlicerTask::Processing);};
   void SetTypeToNetworking() {this->SetType(vtkSlicerTask::Networking);};
 
+  ///
+  /// Priority of the task. Tasks with a higher priority are dequeued
+  /// first by the application logic; tasks of equal priority run in the
+  /// order they were scheduled. Default is 0.
+  vtkSetMacro(Priority, int);
+  vtkGetMacro(Priority, int);
+
+  ///
+  /// Request the cancellation of the task. A task that is canceled
+  /// before it is dequeued is dropped by the application logic without
+  /// being executed. Tasks that are already running are not interrupted.
+  /// Cancel() and GetCanceled() can be called from any thread.
+  void Cancel();
+  bool GetCanceled();
+
   const char* GetTypeAsString( ) {
     switch (this->Type)
       {
@@ -60,6 +77,10 @@ private:
   void *TaskClientData;
 
   int Type;
+  int Priority;
+  bool Canceled;
+  /// Protects Canceled, read by the scheduler thread
+  vtkSimpleMutexLock* CanceledLock;
 
 };
 #endif
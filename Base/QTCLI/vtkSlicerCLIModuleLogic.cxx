@@ -20,6 +20,7 @@
 // MRML includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLColorNode.h>
+#include <vtkMRMLDiffusionWeightedVolumeNode.h>
 #include <vtkMRMLDisplayableNode.h>
 #include <vtkMRMLDisplayNode.h>
 #include <vtkMRMLFiducialListNode.h>
@@ -27,19 +28,27 @@
 #include <vtkMRMLModelHierarchyNode.h>
 #include <vtkMRMLModelNode.h>
 #include <vtkMRMLROIListNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
+#include <vtkMRMLTensorVolumeNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVectorVolumeNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
 #include <vtksys/SystemTools.hxx>
 
+// ITK includes
+#include <itkMRMLIDImageIO.h>
+#include <itkSharedMemoryImageIO.h>
+
 // ITKSYS includes
 #include <itksys/Process.h>
 #include <itksys/SystemTools.hxx>
@@ -81,6 +90,49 @@ struct DigitsToCharacters
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 class MRMLIDMap : public std::map<std::string, std::string> {};
 
+namespace
+{
+
+// Shared memory segment names must be unique within the process, even
+// when several CLI logics run tasks concurrently.
+vtkSimpleMutexLock SharedMemorySegmentCountLock;
+unsigned long SharedMemorySegmentCount = 0;
+
+// Command line modules are started with a modified ITK_AUTOLOAD_PATH. The
+// environment is global to the process and itksysProcess has no per process
+// environment, so the modification, the start of the process and the
+// restoration are done by one task at a time.
+vtkSimpleMutexLock ProcessEnvironmentLock;
+
+//----------------------------------------------------------------------------
+std::string ConstructMRMLIDFileName(vtkMRMLScene* scene, vtkMRMLNode* node)
+{
+  std::ostringstream fileName;
+  char sceneAddress[64];
+  sprintf(sceneAddress, "%p", scene);
+  fileName << "slicer:" << sceneAddress << "#" << node->GetID();
+  return fileName.str();
+}
+
+//----------------------------------------------------------------------------
+void CopyImageInformation(itk::ImageIOBase* source, itk::ImageIOBase* target)
+{
+  unsigned int dimension = source->GetNumberOfDimensions();
+  target->SetNumberOfDimensions(dimension);
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    target->SetDimensions(i, source->GetDimensions(i));
+    target->SetSpacing(i, source->GetSpacing(i));
+    target->SetOrigin(i, source->GetOrigin(i));
+    target->SetDirection(i, source->GetDirection(i));
+    }
+  target->SetComponentType(source->GetComponentType());
+  target->SetPixelType(source->GetPixelType());
+  target->SetNumberOfComponents(source->GetNumberOfComponents());
+}
+
+} // end of anonymous namespace
+
 //---------------------------------------------------------------------------
 class vtkSlicerCLIRescheduleCallback : public vtkCallbackCommand
 {
@@ -91,8 +143,12 @@ public:
   }
   virtual void Execute(vtkObject* caller, unsigned long eid, void *callData)
   {
-    if (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
-                  vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end())
+    // Several CLI tasks can run concurrently in the processing threads
+    this->ThreadIDsLock.Lock();
+    bool reschedule = (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
+      vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end());
+    this->ThreadIDsLock.Unlock();
+    if (reschedule)
       {
       if (this->CLIModuleLogic)
         {
@@ -128,14 +184,21 @@ public:
       {
       return;
       }
+    this->ThreadIDsLock.Lock();
     if (reschedule)
       {
       this->ThreadIDs.push_back(id);
       }
     else
       {
-      std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id);
+      std::vector<vtkMultiThreaderIDType>::iterator it =
+        std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(), id);
+      if (it != this->ThreadIDs.end())
+        {
+        this->ThreadIDs.erase(it);
+        }
       }
+    this->ThreadIDsLock.Unlock();
   }
 protected:
   vtkSlicerCLIRescheduleCallback()
@@ -151,6 +214,7 @@ protected:
   vtkSlicerCLIModuleLogic* CLIModuleLogic;
   int Delay;
   std::vector<vtkMultiThreaderIDType> ThreadIDs;
+  vtkSimpleMutexLock ThreadIDsLock;
 };
 
 //---------------------------------------------------------------------------
@@ -198,6 +262,7 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
 
   int RedirectModuleStreams;
 
@@ -281,6 +346,124 @@ public:
       }
   }
 
+  /// Return the directory of ITK_AUTOLOAD_PATH that contains the
+  /// SharedMemoryIOPlugin, an empty string if there is none.
+  static std::string FindSharedMemoryPluginDirectory()
+  {
+    if (!itk::SharedMemoryImageIO::IsSupported())
+      {
+      return std::string();
+      }
+    std::string autoLoadPath;
+    itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", autoLoadPath);
+    std::vector<std::string> directories =
+      itksys::SystemTools::SplitString(autoLoadPath, ':');
+    for (std::vector<std::string>::const_iterator it = directories.begin();
+         it != directories.end(); ++it)
+      {
+      std::string pluginDirectory = *it + "/SharedMemory";
+      if (!it->empty() &&
+          itksys::SystemTools::FileIsDirectory(pluginDirectory.c_str()))
+        {
+        return pluginDirectory;
+        }
+      }
+    return std::string();
+  }
+
+  /// Return true if the node image can be exchanged through shared memory.
+  /// Diffusion weighted and tensor volumes need their meta-data to be
+  /// written in a file.
+  static bool CanUseSharedMemoryTransfer(vtkMRMLNode* node)
+  {
+    return (vtkMRMLScalarVolumeNode::SafeDownCast(node) != 0 ||
+            vtkMRMLVectorVolumeNode::SafeDownCast(node) != 0) &&
+           vtkMRMLDiffusionWeightedVolumeNode::SafeDownCast(node) == 0 &&
+           vtkMRMLTensorVolumeNode::SafeDownCast(node) == 0;
+  }
+
+  /// Return a new shared memory filename (shm:/name) unique to the process.
+  /// The name is kept short as it is limited to 31 characters on macOS.
+  static std::string ConstructSharedMemoryFileName()
+  {
+    SharedMemorySegmentCountLock.Lock();
+    unsigned long segmentId = ++SharedMemorySegmentCount;
+    SharedMemorySegmentCountLock.Unlock();
+    std::ostringstream fileName;
+    fileName << "shm:/slicer";
+#ifndef _WIN32
+    fileName << getpid();
+#endif
+    fileName << "_" << segmentId;
+    return fileName.str();
+  }
+
+  /// Create the shared memory segment of an input volume and copy the
+  /// node voxels into it.
+  /// Return false if the segment can't be created.
+  static bool WriteSharedMemoryImage(vtkMRMLScene* scene, vtkMRMLNode* node,
+                                     const std::string& fileName)
+  {
+    vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+    if (!volumeNode || !volumeNode->GetImageData())
+      {
+      return false;
+      }
+    try
+      {
+      itk::MRMLIDImageIO::Pointer mrmlIO = itk::MRMLIDImageIO::New();
+      mrmlIO->SetFileName(ConstructMRMLIDFileName(scene, node));
+      mrmlIO->ReadImageInformation();
+
+      itk::SharedMemoryImageIO::Pointer sharedMemoryIO =
+        itk::SharedMemoryImageIO::New();
+      CopyImageInformation(mrmlIO.GetPointer(), sharedMemoryIO.GetPointer());
+      sharedMemoryIO->SetFileName(fileName);
+      // Voxels are copied straight from the node into the segment
+      mrmlIO->Read(sharedMemoryIO->CreateBuffer());
+      }
+    catch (itk::ExceptionObject& exc)
+      {
+      vtkGenericWarningMacro("Unable to write " << node->GetID()
+                             << " into shared memory: " << exc);
+      itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+      return false;
+      }
+    return true;
+  }
+
+  /// Copy the shared memory segment written by the CLI into the output
+  /// volume node.
+  /// Return false if the segment doesn't exist or is invalid.
+  static bool ReadSharedMemoryImage(vtkMRMLScene* scene, vtkMRMLNode* node,
+                                    const std::string& fileName)
+  {
+    itk::SharedMemoryImageIO::Pointer sharedMemoryIO =
+      itk::SharedMemoryImageIO::New();
+    if (!vtkMRMLVolumeNode::SafeDownCast(node) ||
+        !sharedMemoryIO->CanReadFile(fileName.c_str()))
+      {
+      return false;
+      }
+    try
+      {
+      sharedMemoryIO->SetFileName(fileName);
+      sharedMemoryIO->ReadImageInformation();
+
+      itk::MRMLIDImageIO::Pointer mrmlIO = itk::MRMLIDImageIO::New();
+      CopyImageInformation(sharedMemoryIO.GetPointer(), mrmlIO.GetPointer());
+      mrmlIO->SetFileName(ConstructMRMLIDFileName(scene, node));
+      mrmlIO->Write(sharedMemoryIO->GetBuffer());
+      }
+    catch (itk::ExceptionObject& exc)
+      {
+      vtkGenericWarningMacro("Unable to read " << node->GetID()
+                             << " from shared memory: " << exc);
+      return false;
+      }
+    return true;
+  }
+
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
   RequestType LastRequests;
@@ -300,6 +483,7 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
   this->Internal->ProcessesKillLock = itk::MutexLock::New();
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 1;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -403,6 +587,22 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+    {
+    this->Internal->AllowSharedMemoryTransfer = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -916,6 +1116,19 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vector of files to delete
   std::set<std::string> filesToDelete;
 
+  // Executables can exchange images through shared memory segments
+  // (see itkSharedMemoryImageIO) instead of temporary files if the
+  // SharedMemoryIOPlugin can be loaded by the executable.
+  std::string sharedMemoryPluginDirectory;
+  if (commandType == CommandLineModule && this->GetAllowSharedMemoryTransfer())
+    {
+    sharedMemoryPluginDirectory = vtkInternal::FindSharedMemoryPluginDirectory();
+    }
+  // shared memory segments to remove and file names to use instead of
+  // input segments that can't be created.
+  std::set<std::string> sharedMemorySegments;
+  std::map<std::string, std::string> sharedMemoryFallbackFileNames;
+
   // iterators for parameter groups
   std::vector<ModuleParameterGroup>::iterator pgbeginit
     = node0->GetModuleDescription().GetParameterGroups().begin();
@@ -965,7 +1178,20 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              (*pit).GetFileExtensions(),
                                              commandType);
 
-        filesToDelete.insert(fname);
+        if (!sharedMemoryPluginDirectory.empty() && (*pit).GetTag() == "image"
+            && vtkInternal::CanUseSharedMemoryTransfer(
+                 this->GetMRMLScene()->GetNodeByID(id.c_str())))
+          {
+          std::string sharedMemoryFileName =
+            vtkInternal::ConstructSharedMemoryFileName();
+          sharedMemorySegments.insert(sharedMemoryFileName);
+          sharedMemoryFallbackFileNames[sharedMemoryFileName] = fname;
+          fname = sharedMemoryFileName;
+          }
+        else
+          {
+          filesToDelete.insert(fname);
+          }
         if ((*pit).GetChannel() == "input")
           {
           nodesToWrite[id] = fname;
@@ -1018,6 +1244,19 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     vtkMRMLNode *nd
       = this->GetMRMLScene()->GetNodeByID( (*id2fn0).first.c_str() );
 
+    if (itk::SharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str()))
+      {
+      if (vtkInternal::WriteSharedMemoryImage(this->GetMRMLScene(), nd,
+                                              (*id2fn0).second))
+        {
+        continue;
+        }
+      // Fall back to a temporary file
+      std::string fname = sharedMemoryFallbackFileNames[(*id2fn0).second];
+      nodesToWrite[(*id2fn0).first] = fname;
+      filesToDelete.insert(fname);
+      }
+
     vtkSmartPointer<vtkMRMLStorageNode> out = 0;
     vtkSmartPointer<vtkMRMLStorageNode> defaultOut = 0;
 
@@ -1831,16 +2070,23 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
 
     // Unset ITK_AUTOLOAD_PATH environment variable to prevent the CLI from
     // loading the itkMRMLIDIOPlugin plugin because executable CLIs read images
-    // from file and not from shared memory. Worst the plugin in the CLI
+    // from file and not from the MRML scene. Worst the plugin in the CLI
     // could clash by loading libraries (ITK, VTK, MRML) other than the
     // statically linked to the executable.
     // Historically, there was an nvidia driver bug that causes the module
     // to fail on exit with undefined symbol.
+    // If images are exchanged through shared memory, only the directory of
+    // the SharedMemoryIOPlugin (that depends on ITK only) is kept.
+     ProcessEnvironmentLock.Lock();
      std::string saveITKAutoLoadPath;
      itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
-     std::string emptyString("ITK_AUTOLOAD_PATH=");
+     std::string autoLoadPathString("ITK_AUTOLOAD_PATH=");
+     if (!sharedMemorySegments.empty())
+       {
+       autoLoadPathString += sharedMemoryPluginDirectory;
+       }
      int putSuccess =
-       itksys::SystemTools::PutEnv(const_cast <char *> (emptyString.c_str()));
+       itksys::SystemTools::PutEnv(const_cast <char *> (autoLoadPathString.c_str()));
      if (!putSuccess)
        {
        vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
@@ -1850,7 +2096,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     //
     itksysProcess *process = itksysProcess_New();
 
+    this->Internal->ProcessesKillLock->Lock();
     this->Internal->Processes.push_back(process);
+    this->Internal->ProcessesKillLock->Unlock();
 
     // setup the command
     itksysProcess_SetCommand(process, command);
@@ -1872,6 +2120,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       {
       vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
       }
+    ProcessEnvironmentLock.Unlock();
 
     // Wait for the command to finish
     char *tbuffer;
@@ -1897,9 +2146,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       // Check to see if the plugin was cancelled
       if (node0->GetModuleDescription().GetProcessInformation()->Abort)
         {
+        // the process is removed from the list when it is deleted
+        this->Internal->ProcessesKillLock->Lock();
         itksysProcess_Kill(process);
-        this->Internal->Processes.erase(
-              std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+        this->Internal->ProcessesKillLock->Unlock();
         node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
         node0->GetModuleDescription().GetProcessInformation()->StageProgress =0;
         this->GetApplicationLogic()->RequestModified( node0 );
@@ -2144,8 +2394,12 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
 
       // clean up
       this->Internal->ProcessesKillLock->Lock();
-      this->Internal->Processes.erase(
-            std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+      std::vector<itksysProcess*>::iterator processIt =
+        std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process);
+      if (processIt != this->Internal->Processes.end())
+        {
+        this->Internal->Processes.erase(processIt);
+        }
       itksysProcess_Delete(process);
       this->Internal->ProcessesKillLock->Unlock();
       }
@@ -2367,6 +2621,26 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       MRMLIDMap::iterator mit = sceneToMiniSceneMap.find((*id2fn0).first);
       if (mit == sceneToMiniSceneMap.end())
         {
+        if (itk::SharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str()))
+          {
+          // Copy the segment written by the executable into the node from
+          // this thread. The node events are invoked on the main thread.
+          vtkMRMLNode* node = this->GetMRMLScene()->GetNodeByID((*id2fn0).first);
+          this->Internal->StartRescheduleNodeEvents(node);
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), true);
+          if (!vtkInternal::ReadSharedMemoryImage(this->GetMRMLScene(), node,
+                                                  (*id2fn0).second))
+            {
+            vtkErrorMacro("Unable to read output " << (*id2fn0).first
+                          << " from shared memory " << (*id2fn0).second);
+            }
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), false);
+          this->Internal->StopRescheduleNodeEvents(node);
+          itk::SharedMemoryImageIO::RemoveSegment((*id2fn0).second.c_str());
+          }
+
         // Node is not being communicated in the miniscene, load via a file
 
         // Make request that data be reloaded. The data will loaded and
@@ -2559,6 +2833,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       }
     }
 
+  // Shared memory segments are always removed, they are not backed by files
+  // that could be inspected.
+  std::set<std::string>::const_iterator sit;
+  for (sit = sharedMemorySegments.begin(); sit != sharedMemorySegments.end(); ++sit)
+    {
+    itk::SharedMemoryImageIO::RemoveSegment((*sit).c_str());
+    }
+
   // The CLI node is only completed if the outputs are loaded back into the
   // scene.
   // This is a special case where no output is needed to be read. Usually
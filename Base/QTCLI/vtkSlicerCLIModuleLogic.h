@@ -80,6 +80,14 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory segments to exchange images with
+  /// executable CLIs instead of temporary files. It is only used if the
+  /// SharedMemoryIOPlugin is found in ITK_AUTOLOAD_PATH and if the
+  /// platform supports shared memory.
+  /// Enabled by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
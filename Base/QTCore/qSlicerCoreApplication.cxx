@@ -97,6 +97,9 @@
 #endif
 #include <vtkMRMLScene.h>
 
+// vtkITK includes
+#include <vtkITKArchetypeImageSeriesReader.h>
+
 // CTKLauncherLib includes
 #include <ctkAppLauncherEnvironment.h>
 #include <ctkAppLauncherSettings.h>
@@ -403,6 +406,10 @@ void qSlicerCoreApplicationPrivate::initDataIO()
   this->MRMLRemoteIOLogic->GetCacheManager()->SetRemoteCacheDirectory(
     QFileInfo(q->temporaryPath(), "RemoteIO").
     absoluteFilePath().toLatin1());
+  // Keep the DICOM tags read when scanning series for the next sessions
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(
+    QFileInfo(q->temporaryPath(), "DICOMHeaderCache").
+    absoluteFilePath().toLatin1());
 
   this->DataIOManagerLogic = vtkSmartPointer<vtkDataIOManagerLogic>::New();
   this->DataIOManagerLogic->SetMRMLApplicationLogic(this->AppLogic);
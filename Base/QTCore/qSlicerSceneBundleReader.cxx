@@ -84,7 +84,7 @@ bool qSlicerSceneBundleReader::load(const qSlicerIO::IOProperties& properties)
                         QString("/__BundleLoadTemp") +
                           QDateTime::currentDateTime().toString("yyyy-MM-dd_hh+mm+ss.zzz") );
 
-  qDebug() << "Unpacking bundle " << file << " to " << unpackPath;
+  qDebug() << "Loading bundle " << file << " using " << unpackPath;
 
   if (QFileInfo(unpackPath).isDir())
     {
@@ -99,34 +99,25 @@ bool qSlicerSceneBundleReader::load(const qSlicerIO::IOProperties& properties)
     return false;
     }
 
-  vtkNew<vtkMRMLApplicationLogic> appLogic;
-  appLogic->SetMRMLScene( this->mrmlScene() );
-  std::string mrmlFile = appLogic->UnpackSlicerDataBundle(
-                                          file.toLatin1(), unpackPath.toLatin1() );
-
-  this->mrmlScene()->SetURL(mrmlFile.c_str());
-
   bool clear = false;
   if (properties.contains("clear"))
     {
     clear = properties["clear"].toBool();
     }
-  int res = 0;
-  if (clear)
-    {
-    res = this->mrmlScene()->Connect();
-    }
-  else
-    {
-    res = this->mrmlScene()->Import();
-    }
+
+  // The data files are extracted one storable node at a time while they are
+  // read, the bundle is never fully unpacked
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  appLogic->SetMRMLScene( this->mrmlScene() );
+  bool res = appLogic->LoadSlicerDataBundle(
+    file.toLatin1(), unpackPath.toLatin1(), clear);
 
   if (!ctk::removeDirRecursively(unpackPath))
     {
     return false;
     }
 
-  qDebug() << "Loaded bundle from " << unpackPath;
+  qDebug() << "Loaded bundle " << file;
   // since the unpack path has been deleted, reset the scene to where the data bundle is
   QString mrbDirectoryPath = QFileInfo(file).dir().absolutePath();
   QString mrbBaseName = QFileInfo(file).baseName();
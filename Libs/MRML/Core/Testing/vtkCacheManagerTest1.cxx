@@ -0,0 +1,148 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkCacheManager.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// VTKsys includes
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+void writeFile(const std::string& fileName, int size)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  std::string content(size, 'x');
+  file.write(content.c_str(), size);
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkCacheManagerTest1(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string cacheDirectory = std::string(argv[1]) + "/vtkCacheManagerTest1";
+  vtksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+
+  const int fileSize = 1000000; // 1MB
+  const int numberOfFiles = 4;
+  std::string fileNames[numberOfFiles];
+  {
+  vtkNew<vtkCacheManager> cacheManager;
+  cacheManager->AutomaticEvictionOff();
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  CHECK_BOOL(vtksys::SystemTools::FileIsDirectory(cacheDirectory.c_str()), true);
+  CHECK_DOUBLE(cacheManager->GetCurrentCacheSize(), 0.);
+
+  // Downloaded files are indexed
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream fileName;
+    fileName << cacheDirectory << "/file" << i << ".nrrd";
+    fileNames[i] = fileName.str();
+    writeFile(fileNames[i], fileSize);
+    cacheManager->AddCachedFile(fileNames[i].c_str(), "http://www.slicer.org/file.nrrd");
+    vtksys::SystemTools::Delay(10);
+    }
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), numberOfFiles * fileSize / 1000000., 0.001);
+  cacheManager->UpdateCacheInformation();
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), numberOfFiles);
+
+  // Files outside of the cache directory are not indexed
+  cacheManager->AddCachedFile(argv[0]);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), numberOfFiles * fileSize / 1000000., 0.001);
+
+  // The first file is the most recently used
+  cacheManager->TouchCachedFile(fileNames[0].c_str());
+
+  // Least recently used files are evicted
+  cacheManager->SetRemoteCacheLimit(3);
+  cacheManager->SetRemoteCacheFreeBufferSize(1);
+  CHECK_INT(cacheManager->EvictLeastRecentlyUsedFiles(), 3);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), fileSize / 1000000., 0.001);
+  // Evicted files leave their path before they are deleted
+  for (int i = 1; i < numberOfFiles; ++i)
+    {
+    CHECK_BOOL(vtksys::SystemTools::FileExists(fileNames[i].c_str()), false);
+    }
+  // A file downloaded again to an evicted path is not deleted
+  writeFile(fileNames[1], fileSize);
+  cacheManager->AddCachedFile(fileNames[1].c_str());
+  cacheManager->WaitForEviction();
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileNames[0].c_str()), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileNames[1].c_str()), true);
+  for (int i = 2; i < numberOfFiles; ++i)
+    {
+    CHECK_BOOL(vtksys::SystemTools::FileExists(fileNames[i].c_str()), false);
+    }
+  std::string trashDirectory = cacheDirectory + "/" + vtkCacheManager::GetCacheTrashDirectoryName();
+  CHECK_INT(static_cast<int>(vtksys::Directory::GetNumberOfFilesInDirectory(trashDirectory.c_str())), 2); // . and ..
+  CHECK_INT(cacheManager->EvictLeastRecentlyUsedFiles(), 0);
+
+  // Index is saved when the cache manager is deleted
+  }
+
+  {
+  // Index is read instead of scanning the directory: files that have been added
+  // without the cache manager are not known until the index is rebuilt.
+  writeFile(cacheDirectory + "/unknown.nrrd", fileSize);
+  vtkNew<vtkCacheManager> cacheManager;
+  cacheManager->AutomaticEvictionOff();
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 2 * fileSize / 1000000., 0.001);
+  cacheManager->RebuildCacheIndex();
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 3 * fileSize / 1000000., 0.001);
+
+  // Deleted files are removed from the index
+  cacheManager->DeleteFromCache(fileNames[0].c_str());
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileNames[0].c_str()), false);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 2 * fileSize / 1000000., 0.001);
+
+  // Automatic eviction keeps the cache within its limit
+  cacheManager->SetRemoteCacheLimit(2);
+  cacheManager->SetRemoteCacheFreeBufferSize(0);
+  cacheManager->AutomaticEvictionOn();
+  cacheManager->UpdateCacheInformation();
+  cacheManager->WaitForEviction();
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), fileSize / 1000000., 0.001);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 1);
+
+  cacheManager->ClearCache();
+  CHECK_DOUBLE(cacheManager->GetCurrentCacheSize(), 0.);
+  }
+
+  vtksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkObservation.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkObject.h>
+#include <vtkWeakPointer.h>
+
+namespace
+{
+
+struct CallbackData
+{
+  CallbackData() : NumberOfCalls(0), LastCallData(0) {}
+  int NumberOfCalls;
+  void* LastCallData;
+};
+
+//----------------------------------------------------------------------------
+void countCalls(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                void* clientData, void* callData)
+{
+  CallbackData* data = reinterpret_cast<CallbackData*>(clientData);
+  data->NumberOfCalls++;
+  data->LastCallData = callData;
+}
+
+//----------------------------------------------------------------------------
+int testCoalescing()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkObject> subject;
+  vtkNew<vtkObject> observer;
+  CallbackData data;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(countCalls);
+  callback->SetClientData(&data);
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent,
+                         observer.GetPointer(), callback.GetPointer());
+
+  subject->Modified();
+  CHECK_INT(data.NumberOfCalls, 1);
+
+  broker->StartCoalescing();
+  CHECK_BOOL(broker->GetCoalescing(), true);
+  for (int i = 0; i < 10; ++i)
+    {
+    subject->Modified();
+    }
+  CHECK_INT(data.NumberOfCalls, 1);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 1);
+
+  // nested windows are processed by the outermost one
+  broker->StartCoalescing();
+  subject->Modified();
+  broker->EndCoalescing();
+  CHECK_INT(data.NumberOfCalls, 1);
+  broker->EndCoalescing();
+  CHECK_BOOL(broker->GetCoalescing(), false);
+  CHECK_INT(data.NumberOfCalls, 2);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  // the most recent call data is kept when compressing call data
+  int firstCallData = 0;
+  int lastCallData = 0;
+  broker->CompressCallDataOn();
+  broker->StartCoalescing();
+  subject->InvokeEvent(vtkCommand::ModifiedEvent, &firstCallData);
+  subject->InvokeEvent(vtkCommand::ModifiedEvent, &lastCallData);
+  broker->EndCoalescing();
+  broker->CompressCallDataOff();
+  CHECK_INT(data.NumberOfCalls, 3);
+  CHECK_BOOL(data.LastCallData == &lastCallData, true);
+
+  // otherwise each unique call data is invoked
+  broker->StartCoalescing();
+  subject->InvokeEvent(vtkCommand::ModifiedEvent, &firstCallData);
+  subject->InvokeEvent(vtkCommand::ModifiedEvent, &lastCallData);
+  subject->InvokeEvent(vtkCommand::ModifiedEvent, &lastCallData);
+  broker->EndCoalescing();
+  CHECK_INT(data.NumberOfCalls, 5);
+
+  // unbalanced calls are reported
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  broker->EndCoalescing();
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  broker->RemoveObservations(subject.GetPointer(), observer.GetPointer());
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testCancelQueuedObservations()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkObject> observer;
+  CallbackData data;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(countCalls);
+  callback->SetClientData(&data);
+
+  const int numberOfSubjects = 5;
+  vtkNew<vtkObject> subjects[numberOfSubjects];
+  for (int i = 0; i < numberOfSubjects; ++i)
+    {
+    broker->AddObservation(subjects[i].GetPointer(), vtkCommand::ModifiedEvent,
+                           observer.GetPointer(), callback.GetPointer());
+    }
+
+  broker->StartCoalescing();
+  for (int i = 0; i < numberOfSubjects; ++i)
+    {
+    subjects[i]->Modified();
+    }
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), numberOfSubjects);
+
+  // removed observations are not invoked
+  broker->RemoveObservations(subjects[1].GetPointer(), observer.GetPointer());
+  broker->RemoveObservations(subjects[3].GetPointer(), observer.GetPointer());
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), numberOfSubjects - 2);
+  vtkObservation* observation = broker->GetNthQueuedObservation(1);
+  CHECK_NOT_NULL(observation);
+  CHECK_BOOL(observation->GetSubject() == subjects[2].GetPointer(), true);
+  CHECK_NULL(broker->GetNthQueuedObservation(numberOfSubjects - 2));
+
+  // deleted subjects are not invoked either
+  vtkObject* deletedSubject = vtkObject::New();
+  broker->AddObservation(deletedSubject, vtkCommand::ModifiedEvent,
+                         observer.GetPointer(), callback.GetPointer());
+  deletedSubject->Modified();
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), numberOfSubjects - 1);
+  deletedSubject->Delete();
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), numberOfSubjects - 2);
+
+  // removed observations at the end of the queue are released when the
+  // queue is processed
+  vtkWeakPointer<vtkObservation> lastObservation =
+    broker->GetNthQueuedObservation(numberOfSubjects - 3);
+  CHECK_NOT_NULL(lastObservation.GetPointer());
+  CHECK_BOOL(lastObservation->GetSubject() == subjects[numberOfSubjects - 1].GetPointer(), true);
+  broker->RemoveObservations(subjects[numberOfSubjects - 1].GetPointer(), observer.GetPointer());
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), numberOfSubjects - 3);
+  CHECK_NOT_NULL(lastObservation.GetPointer());
+
+  broker->EndCoalescing();
+  CHECK_INT(data.NumberOfCalls, numberOfSubjects - 3);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  CHECK_NULL(lastObservation.GetPointer());
+
+  broker->RemoveObservations(observer.GetPointer());
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testEventStatistics()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkObject> subject;
+  vtkNew<vtkObject> observer;
+  CallbackData data;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(countCalls);
+  callback->SetClientData(&data);
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent,
+                         observer.GetPointer(), callback.GetPointer());
+  broker->AddObservation(subject.GetPointer(), vtkCommand::UserEvent + 1,
+                         observer.GetPointer(), callback.GetPointer());
+
+  // nothing is collected by default
+  CHECK_INT(broker->GetCollectEventStatistics(), 0);
+  subject->Modified();
+  CHECK_INT(broker->GetNumberOfEventStatistics(), 0);
+
+  broker->CollectEventStatisticsOn();
+  subject->Modified();
+  subject->InvokeEvent(vtkCommand::UserEvent + 1);
+  broker->StartCoalescing();
+  for (int i = 0; i < 10; ++i)
+    {
+    subject->Modified();
+    }
+  broker->EndCoalescing();
+
+  CHECK_INT(broker->GetNumberOfEventStatistics(), 2);
+  CHECK_INT(static_cast<int>(broker->GetNthEventStatisticsEventId(0)), vtkCommand::ModifiedEvent);
+  CHECK_INT(static_cast<int>(broker->GetNthEventStatisticsEventId(1)), vtkCommand::UserEvent + 1);
+  CHECK_INT(broker->GetEventInvocationCount(vtkCommand::ModifiedEvent), 2);
+  CHECK_INT(broker->GetEventCoalescedCount(vtkCommand::ModifiedEvent), 9);
+  CHECK_INT(broker->GetEventInvocationCount(vtkCommand::UserEvent + 1), 1);
+  CHECK_INT(broker->GetEventCoalescedCount(vtkCommand::UserEvent + 1), 0);
+  CHECK_INT(broker->GetEventInvocationCount(vtkCommand::EndEvent), 0);
+  CHECK_BOOL(broker->GetEventTotalElapsedTime(vtkCommand::ModifiedEvent) >= 0., true);
+  CHECK_BOOL(broker->GetEventMaximumElapsedTime(vtkCommand::ModifiedEvent)
+             <= broker->GetEventTotalElapsedTime(vtkCommand::ModifiedEvent), true);
+  broker->PrintEventStatistics(std::cout);
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  broker->GetNthEventStatisticsEventId(2);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  broker->ResetEventStatistics();
+  CHECK_INT(broker->GetNumberOfEventStatistics(), 0);
+  CHECK_INT(broker->GetEventInvocationCount(vtkCommand::ModifiedEvent), 0);
+  broker->CollectEventStatisticsOff();
+
+  broker->RemoveObservations(subject.GetPointer(), observer.GetPointer());
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkEventBrokerTest1(int , char * [] )
+{
+  CHECK_EXIT_SUCCESS(testCoalescing());
+  CHECK_EXIT_SUCCESS(testCancelQueuedObservations());
+  CHECK_EXIT_SUCCESS(testEventStatistics());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageAppendComponents.h>
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkImageLogic.h>
+#include <vtkImageMapToColors.h>
+#include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageStencil.h>
+#include <vtkImageThreshold.h>
+#include <vtkLookupTable.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkROIStencilSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Pipeline of vtkMRMLScalarVolumeDisplayNode before it used
+// vtkImageMapToWindowLevelThresholdColors.
+class LegacyPipeline
+{
+public:
+  LegacyPipeline()
+    {
+    this->MapToWindowLevelColors->SetOutputFormatToLuminance();
+    this->MapToColors->SetOutputFormatToRGBA();
+    this->MapToColors->SetInputConnection(this->MapToWindowLevelColors->GetOutputPort());
+    this->ExtractRGB->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractRGB->SetComponents(0, 1, 2);
+    this->ExtractAlpha->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractAlpha->SetComponents(3);
+    this->Threshold->ReplaceInOn();
+    this->Threshold->SetInValue(255);
+    this->Threshold->ReplaceOutOn();
+    this->Threshold->SetOutValue(255);
+    this->Threshold->SetOutputScalarTypeToUnsignedChar();
+    this->MultiplyAlpha->SetInputConnection(0, this->ExtractAlpha->GetOutputPort());
+    this->MultiplyAlpha->SetBackgroundValue(0);
+    this->AlphaLogic->SetOperationToAnd();
+    this->AlphaLogic->SetOutputTrueValue(255);
+    this->AlphaLogic->SetInputConnection(0, this->Threshold->GetOutputPort());
+    this->AlphaLogic->SetInputConnection(1, this->MultiplyAlpha->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort());
+    }
+
+  void SetInputData(vtkImageData* image)
+    {
+    this->MapToWindowLevelColors->SetInputData(image);
+    this->Threshold->SetInputData(image);
+    }
+
+  vtkNew<vtkImageMapToWindowLevelColors> MapToWindowLevelColors;
+  vtkNew<vtkImageMapToColors> MapToColors;
+  vtkNew<vtkImageExtractComponents> ExtractRGB;
+  vtkNew<vtkImageExtractComponents> ExtractAlpha;
+  vtkNew<vtkImageStencil> MultiplyAlpha;
+  vtkNew<vtkImageThreshold> Threshold;
+  vtkNew<vtkImageLogic> AlphaLogic;
+  vtkNew<vtkImageAppendComponents> AppendComponents;
+};
+
+//----------------------------------------------------------------------------
+void createImage(vtkImageData* image, int scalarType, int dimension)
+{
+  image->SetDimensions(dimension, dimension, 1);
+  image->AllocateScalars(scalarType, 1);
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  const double minimum = std::max(-1200., scalars->GetDataTypeMin());
+  const double maximum = std::min(3000., scalars->GetDataTypeMax());
+  vtkMath::RandomSeed(1);
+  for (vtkIdType i = 0; i < scalars->GetNumberOfTuples(); ++i)
+    {
+    scalars->SetTuple1(i, vtkMath::Random(minimum, maximum));
+    }
+}
+
+//----------------------------------------------------------------------------
+int compareImages(vtkImageData* expected, vtkImageData* actual)
+{
+  CHECK_INT(actual->GetNumberOfScalarComponents(), 4);
+  CHECK_INT(actual->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(static_cast<int>(actual->GetNumberOfPoints()),
+            static_cast<int>(expected->GetNumberOfPoints()));
+  CHECK_INT(memcmp(expected->GetScalarPointer(), actual->GetScalarPointer(),
+                   actual->GetNumberOfPoints() * 4), 0);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testIdenticalPixels(int scalarType)
+{
+  vtkNew<vtkImageData> image;
+  createImage(image.GetPointer(), scalarType, 64);
+
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->SetNumberOfTableValues(256);
+  lookupTable->SetTableRange(0, 255);
+  lookupTable->SetHueRange(0., 0.7);
+  lookupTable->Build();
+  lookupTable->SetTableValue(0, 0., 0., 0., 0.);
+
+  vtkNew<vtkROIStencilSource> stencil;
+  stencil->SetShapeToEllipsoid();
+  stencil->SetBounds(10, 50, 5, 40, -1, 1);
+  stencil->SetInformationInput(image.GetPointer());
+
+  LegacyPipeline legacy;
+  legacy.SetInputData(image.GetPointer());
+  legacy.MapToColors->SetLookupTable(lookupTable.GetPointer());
+
+  vtkNew<vtkImageMapToWindowLevelThresholdColors> fused;
+  fused->SetInputData(image.GetPointer());
+  fused->SetLookupTable(lookupTable.GetPointer());
+
+  const double windowLevels[][2] = {
+    {256., 128.}, {1000., 400.}, {-800., 200.}, {1., 10.}, {100000., 0.}};
+  const double thresholds[][2] = {{VTK_SHORT_MIN, VTK_SHORT_MAX}, {-100.5, 800.5}};
+  for (int useStencil = 0; useStencil < 2; ++useStencil)
+    {
+    legacy.MultiplyAlpha->SetStencilConnection(useStencil ? stencil->GetOutputPort() : 0);
+    fused->SetStencilConnection(useStencil ? stencil->GetOutputPort() : 0);
+    for (int applyThreshold = 0; applyThreshold < 2; ++applyThreshold)
+      {
+      legacy.Threshold->SetOutValue(applyThreshold ? 0 : 255);
+      fused->SetApplyThreshold(applyThreshold);
+      for (int t = 0; t < 2; ++t)
+        {
+        legacy.Threshold->ThresholdBetween(thresholds[t][0], thresholds[t][1]);
+        fused->ThresholdBetween(thresholds[t][0], thresholds[t][1]);
+        for (int w = 0; w < 5; ++w)
+          {
+          legacy.MapToWindowLevelColors->SetWindow(windowLevels[w][0]);
+          legacy.MapToWindowLevelColors->SetLevel(windowLevels[w][1]);
+          fused->SetWindow(windowLevels[w][0]);
+          fused->SetLevel(windowLevels[w][1]);
+          legacy.AppendComponents->Update();
+          fused->Update();
+          CHECK_EXIT_SUCCESS(compareImages(legacy.AppendComponents->GetOutput(), fused->GetOutput()));
+          }
+        }
+      }
+    }
+
+  // The output is updated when the lookup table is modified
+  lookupTable->SetTableValue(255, 0., 0., 0., 0.);
+  legacy.AppendComponents->Update();
+  fused->Update();
+  CHECK_EXIT_SUCCESS(compareImages(legacy.AppendComponents->GetOutput(), fused->GetOutput()));
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int benchmark(int dimension, int repeat)
+{
+  vtkNew<vtkImageData> image;
+  createImage(image.GetPointer(), VTK_SHORT, dimension);
+
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->SetRampToLinear();
+  lookupTable->SetTableRange(0, 255);
+  lookupTable->Build();
+
+  vtkNew<vtkROIStencilSource> stencil;
+  stencil->SetShapeToBox();
+  stencil->SetBounds(0, dimension / 2, 0, dimension, -1, 1);
+  stencil->SetInformationInput(image.GetPointer());
+
+  LegacyPipeline legacy;
+  legacy.SetInputData(image.GetPointer());
+  legacy.MapToColors->SetLookupTable(lookupTable.GetPointer());
+  legacy.MultiplyAlpha->SetStencilConnection(stencil->GetOutputPort());
+  legacy.MapToWindowLevelColors->SetWindow(1000.);
+  legacy.MapToWindowLevelColors->SetLevel(400.);
+
+  vtkNew<vtkImageMapToWindowLevelThresholdColors> fused;
+  fused->SetInputData(image.GetPointer());
+  fused->SetLookupTable(lookupTable.GetPointer());
+  fused->SetStencilConnection(stencil->GetOutputPort());
+  fused->SetWindow(1000.);
+  fused->SetLevel(400.);
+
+  vtkNew<vtkTimerLog> timer;
+  double legacyTime = 0.;
+  double fusedTime = 0.;
+  for (int i = 0; i < repeat; ++i)
+    {
+    // Same as a new slice being resliced
+    image->Modified();
+    timer->StartTimer();
+    legacy.AppendComponents->Update();
+    timer->StopTimer();
+    legacyTime += timer->GetElapsedTime();
+
+    timer->StartTimer();
+    fused->Update();
+    timer->StopTimer();
+    fusedTime += timer->GetElapsedTime();
+    }
+  CHECK_EXIT_SUCCESS(compareImages(legacy.AppendComponents->GetOutput(), fused->GetOutput()));
+
+  std::cout << "<DartMeasurement name=\"LegacyPipelineTime\" type=\"numeric/double\">"
+            << legacyTime / repeat << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"SinglePassTime\" type=\"numeric/double\">"
+            << fusedTime / repeat << "</DartMeasurement>" << std::endl;
+  std::cout << dimension << "x" << dimension << " slice: "
+            << legacyTime / repeat << "s with the legacy pipeline, "
+            << fusedTime / repeat << "s in a single pass" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColorsTest1(int argc, char * argv[])
+{
+  CHECK_EXIT_SUCCESS(testIdenticalPixels(VTK_SHORT));
+  CHECK_EXIT_SUCCESS(testIdenticalPixels(VTK_UNSIGNED_CHAR));
+  CHECK_EXIT_SUCCESS(testIdenticalPixels(VTK_FLOAT));
+
+  // Slice size, e.g. 4096 for a 4K slice view
+  int dimension = (argc > 1 ? atoi(argv[1]) : 1024);
+  CHECK_EXIT_SUCCESS(benchmark(dimension, 10));
+  return EXIT_SUCCESS;
+}
@@ -12,10 +12,71 @@
 
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLScene.h"
+
+// vtkAddon includes
+#include <vtkOrientedGridTransform.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool gridUsesCachedInverse(vtkMRMLGridTransformNode* node)
+{
+  vtkOrientedGridTransform* gridTransform = vtkOrientedGridTransform::SafeDownCast(
+    node->GetTransformFromParentAs("vtkOrientedGridTransform"));
+  return gridTransform && gridTransform->GetUseCachedInverse();
+}
+
+//----------------------------------------------------------------------------
+int testUseCachedInverse()
+{
+  vtkNew<vtkMRMLGridTransformNode> node;
+  CHECK_BOOL(node->GetUseCachedInverse(), false);
+  CHECK_BOOL(gridUsesCachedInverse(node.GetPointer()), false);
+
+  // The setting is applied to the current and to the new grid transforms
+  node->UseCachedInverseOn();
+  CHECK_BOOL(gridUsesCachedInverse(node.GetPointer()), true);
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  CHECK_BOOL(gridTransform->GetUseCachedInverse(), false);
+  node->SetAndObserveTransformFromParent(gridTransform.GetPointer());
+  CHECK_BOOL(gridTransform->GetUseCachedInverse(), true);
+
+  vtkNew<vtkMRMLGridTransformNode> copiedNode;
+  copiedNode->Copy(node.GetPointer());
+  CHECK_BOOL(copiedNode->GetUseCachedInverse(), true);
+  CHECK_BOOL(gridUsesCachedInverse(copiedNode.GetPointer()), true);
+
+  // Saved in the scene
+  vtkNew<vtkMRMLScene> scene;
+  scene->AddNode(node.GetPointer());
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  std::string sceneXMLString = scene->GetSceneXMLString();
+  CHECK_BOOL(sceneXMLString.find("useCachedInverse=\"true\"") != std::string::npos, true);
+
+  vtkNew<vtkMRMLScene> loadedScene;
+  loadedScene->SetLoadFromXMLString(1);
+  loadedScene->SetSceneXMLString(sceneXMLString);
+  loadedScene->Import();
+  vtkMRMLGridTransformNode* loadedNode = vtkMRMLGridTransformNode::SafeDownCast(
+    loadedScene->GetFirstNodeByClass("vtkMRMLGridTransformNode"));
+  CHECK_NOT_NULL(loadedNode);
+  CHECK_BOOL(loadedNode->GetUseCachedInverse(), true);
+  CHECK_BOOL(gridUsesCachedInverse(loadedNode), true);
+
+  node->UseCachedInverseOff();
+  CHECK_BOOL(gridTransform->GetUseCachedInverse(), false);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
 
 int vtkMRMLGridTransformNodeTest1(int , char * [] )
 {
   vtkNew<vtkMRMLGridTransformNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+  CHECK_EXIT_SUCCESS(testUseCachedInverse());
   return EXIT_SUCCESS;
 }
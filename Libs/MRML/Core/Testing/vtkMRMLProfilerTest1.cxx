@@ -0,0 +1,219 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLProfiler.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int countOccurrences(const std::string& str, const std::string& substr)
+{
+  int count = 0;
+  for (size_t pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + 1))
+    {
+    ++count;
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int testScopes()
+{
+  vtkMRMLProfiler* profiler = vtkMRMLProfiler::GetInstance();
+  profiler->Clear();
+
+  // nothing is recorded while disabled
+  CHECK_BOOL(profiler->GetEnabled(), false);
+    {
+    vtkMRMLProfiler::Scope scope("Category", "Disabled");
+    }
+  CHECK_INT(profiler->GetNumberOfRecords(), 0);
+
+  profiler->EnabledOn();
+  for (int i = 0; i < 3; ++i)
+    {
+    vtkMRMLProfiler::Scope outerScope("Category", "Outer", vtkCommand::ModifiedEvent);
+      {
+      vtkMRMLProfiler::Scope innerScope("Category", "Inner");
+      }
+    }
+  profiler->EnabledOff();
+
+  CHECK_INT(profiler->GetNumberOfRecords(), 6);
+  CHECK_INT(profiler->GetCallCount("Category", "Outer"), 3);
+  CHECK_INT(profiler->GetCallCount("Category", "Inner"), 3);
+  CHECK_INT(profiler->GetCallCount("Category", "Disabled"), 0);
+  CHECK_INT(profiler->GetCallCount("Other", "Outer"), 0);
+  // times are inclusive
+  CHECK_BOOL(profiler->GetTotalTime("Category", "Outer")
+             >= profiler->GetTotalTime("Category", "Inner"), true);
+  profiler->PrintStatistics(std::cout);
+
+  std::stringstream trace;
+  profiler->WriteChromeTrace(trace);
+  CHECK_INT(countOccurrences(trace.str(), "\"traceEvents\""), 1);
+  CHECK_INT(countOccurrences(trace.str(), "\"ph\":\"X\""), 6);
+  CHECK_INT(countOccurrences(trace.str(), "\"name\":\"Outer\""), 3);
+  CHECK_INT(countOccurrences(trace.str(), "\"event\":\"ModifiedEvent\""), 3);
+  // inner scopes end first
+  CHECK_BOOL(trace.str().find("\"Inner\"") < trace.str().find("\"Outer\""), true);
+
+  profiler->Clear();
+  CHECK_INT(profiler->GetNumberOfRecords(), 0);
+  CHECK_INT(profiler->GetCallCount("Category", "Outer"), 0);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testRingBuffer()
+{
+  vtkMRMLProfiler* profiler = vtkMRMLProfiler::GetInstance();
+  int defaultBufferSize = profiler->GetBufferSize();
+  profiler->Clear();
+  profiler->SetBufferSize(4);
+
+  double startTime = vtkMRMLProfiler::GetTime();
+  const char* names[] = {"0", "1", "2", "3", "4", "5"};
+  for (int i = 0; i < 6; ++i)
+    {
+    profiler->AddRecord("Category", names[i], vtkCommand::NoEvent, startTime + i, 0.5);
+    }
+  CHECK_INT(profiler->GetNumberOfRecords(), 4);
+  CHECK_INT(profiler->GetNumberOfDroppedRecords(), 2);
+  // statistics are not limited by the buffer size
+  CHECK_INT(profiler->GetCallCount("Category", "0"), 1);
+  CHECK_DOUBLE(profiler->GetTotalTime("Category", "5"), 0.5);
+
+  // the most recent records are written, oldest first
+  std::stringstream trace;
+  profiler->WriteChromeTrace(trace);
+  CHECK_INT(countOccurrences(trace.str(), "\"ph\":\"X\""), 4);
+  CHECK_INT(countOccurrences(trace.str(), "\"name\":\"1\""), 0);
+  CHECK_BOOL(trace.str().find("\"name\":\"2\"") < trace.str().find("\"name\":\"5\""), true);
+  CHECK_INT(countOccurrences(trace.str(), "\"dur\":500000"), 4);
+  CHECK_INT(countOccurrences(trace.str(), "\"args\""), 0);
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  profiler->SetBufferSize(0);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_INT(profiler->GetBufferSize(), 4);
+
+  profiler->SetBufferSize(defaultBufferSize);
+  profiler->Clear();
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE addRecordThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  // thread 0 is the calling thread
+  if (threadInfo->ThreadID == 1)
+    {
+    vtkMRMLProfiler::GetInstance()->AddRecord("Category", "Thread", vtkCommand::NoEvent,
+                                              vtkMRMLProfiler::GetTime(), 0.);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+int testThreads()
+{
+  vtkMRMLProfiler* profiler = vtkMRMLProfiler::GetInstance();
+  profiler->Clear();
+
+  profiler->AddRecord("Category", "Main", vtkCommand::NoEvent, vtkMRMLProfiler::GetTime(), 0.);
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(2);
+  threader->SetSingleMethod(addRecordThreadFunction, 0);
+  threader->SingleMethodExecute();
+  profiler->AddRecord("Category", "Main", vtkCommand::NoEvent, vtkMRMLProfiler::GetTime(), 0.);
+  CHECK_INT(profiler->GetNumberOfRecords(), 3);
+
+  // each thread is written as its own track
+  std::stringstream trace;
+  profiler->WriteChromeTrace(trace);
+  CHECK_INT(countOccurrences(trace.str(), "\"tid\":1,"), 2);
+  CHECK_INT(countOccurrences(trace.str(), "\"tid\":2,"), 1);
+  CHECK_BOOL(trace.str().find("\"tid\":2,") > trace.str().find("\"name\":\"Thread\""), true);
+
+  // thread ids are numbered again after Clear()
+  profiler->Clear();
+  threader->SingleMethodExecute();
+  std::stringstream clearedTrace;
+  profiler->WriteChromeTrace(clearedTrace);
+  CHECK_INT(countOccurrences(clearedTrace.str(), "\"tid\":1,"), 1);
+
+  profiler->Clear();
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void emptyCallback(vtkObject*, unsigned long, void*, void*)
+{
+}
+
+//----------------------------------------------------------------------------
+int testEventBrokerInstrumentation()
+{
+  vtkMRMLProfiler* profiler = vtkMRMLProfiler::GetInstance();
+  profiler->Clear();
+
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkObject> subject;
+  vtkNew<vtkCallbackCommand> observer;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(emptyCallback);
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent,
+                         observer.GetPointer(), callback.GetPointer());
+
+  profiler->EnabledOn();
+  subject->Modified();
+  subject->Modified();
+  profiler->EnabledOff();
+  broker->RemoveObservations(subject.GetPointer(), observer.GetPointer());
+
+#ifdef MRML_USE_PROFILER
+  CHECK_INT(profiler->GetCallCount("vtkEventBroker", "vtkCallbackCommand"), 2);
+#else
+  CHECK_INT(profiler->GetNumberOfRecords(), 0);
+#endif
+  profiler->Clear();
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLProfilerTest1(int , char * [] )
+{
+  CHECK_EXIT_SUCCESS(testScopes());
+  CHECK_EXIT_SUCCESS(testRingBuffer());
+  CHECK_EXIT_SUCCESS(testThreads());
+  CHECK_EXIT_SUCCESS(testEventBrokerInstrumentation());
+  return EXIT_SUCCESS;
+}
@@ -10,12 +10,58 @@
 
 =========================================================================auto=*/
 
+#include "vtkImageMapToWindowLevelThresholdColors.h"
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The filter that maps the displayed slice
+vtkImageMapToWindowLevelThresholdColors* outputFilter(vtkMRMLScalarVolumeDisplayNode* node)
+{
+  return vtkImageMapToWindowLevelThresholdColors::SafeDownCast(
+    node->GetOutputImageDataConnection()->GetProducer());
+}
+
+//----------------------------------------------------------------------------
+int testWindowLevel()
+{
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> node;
+  CHECK_NOT_NULL(outputFilter(node.GetPointer()));
+
+  node->SetWindowLevel(100., 20.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetWindow(), 100.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetLevel(), 20.);
+
+  node->SetWindow(300.);
+  node->SetLevel(-50.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetWindow(), 300.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetLevel(), -50.);
+
+  node->SetWindowLevelMinMax(0., 1000.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetWindow(), 1000.);
+  CHECK_DOUBLE(outputFilter(node.GetPointer())->GetLevel(), 500.);
+
+  // Copy goes through SetWindowLevel
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> copy;
+  copy->Copy(node.GetPointer());
+  CHECK_DOUBLE(copy->GetWindow(), 1000.);
+  CHECK_DOUBLE(outputFilter(copy.GetPointer())->GetWindow(), 1000.);
+  CHECK_DOUBLE(outputFilter(copy.GetPointer())->GetLevel(), 500.);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
 int vtkMRMLScalarVolumeDisplayNodeTest1(int , char * [] )
 {
   vtkNew<vtkMRMLScalarVolumeDisplayNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+  CHECK_EXIT_SUCCESS(testWindowLevel());
   return EXIT_SUCCESS;
 }
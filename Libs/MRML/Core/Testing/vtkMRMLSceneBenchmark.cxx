@@ -0,0 +1,393 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Benchmark of the MRML scene operations that are on the hot path when
+// working with large scenes. Results are written in JSON and/or CSV so
+// that they can be compared across releases.
+//
+// Usage:
+//   vtkMRMLSceneBenchmark [--nodes N[,N...]] [--repeat R]
+//                         [--json results.json] [--csv results.csv]
+
+// MRML includes
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+struct BenchmarkResult
+{
+  std::string Operation;
+  int NumberOfNodes;
+  int NumberOfCalls;
+  /// Best time of all the repetitions, in seconds
+  double Time;
+};
+
+//---------------------------------------------------------------------------
+class Benchmark
+{
+public:
+  Benchmark(int numberOfNodes, int numberOfRepetitions)
+    : NumberOfNodes(numberOfNodes)
+    , NumberOfRepetitions(std::max(1, numberOfRepetitions))
+  {
+  }
+
+  void Run(std::vector<BenchmarkResult>& results);
+
+private:
+  /// Add NumberOfNodes nodes to the scene: chains of transforms and models
+  /// with display nodes, all of them referencing their parent transform.
+  void PopulateScene(vtkMRMLScene* scene);
+  /// Put all the transform and model nodes in subject hierarchy folders
+  void BuildSubjectHierarchy(vtkMRMLScene* scene);
+
+  void StartTimer();
+  /// Record the time elapsed since StartTimer() for the given operation
+  void StopTimer(int operation, int numberOfCalls);
+
+  int NumberOfNodes;
+  int NumberOfRepetitions;
+  vtkNew<vtkTimerLog> Timer;
+  std::vector<double> BestTimes;
+  std::vector<int> NumberOfCalls;
+};
+
+//---------------------------------------------------------------------------
+void Benchmark::PopulateScene(vtkMRMLScene* scene)
+{
+  const int transformChainLength = 10;
+  vtkMRMLTransformNode* parentTransformNode = 0;
+  for (int i = 0; i < this->NumberOfNodes / 3; ++i)
+    {
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    scene->AddNode(transformNode.GetPointer());
+    if (i % transformChainLength == 0)
+      {
+      parentTransformNode = 0;
+      }
+    if (parentTransformNode)
+      {
+      transformNode->SetAndObserveTransformNodeID(parentTransformNode->GetID());
+      }
+    parentTransformNode = transformNode.GetPointer();
+
+    vtkNew<vtkMRMLModelDisplayNode> displayNode;
+    scene->AddNode(displayNode.GetPointer());
+    vtkNew<vtkMRMLModelNode> modelNode;
+    scene->AddNode(modelNode.GetPointer());
+    modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+    modelNode->SetAndObserveTransformNodeID(transformNode->GetID());
+    }
+}
+
+//---------------------------------------------------------------------------
+void Benchmark::BuildSubjectHierarchy(vtkMRMLScene* scene)
+{
+  const int numberOfItemsPerFolder = 100;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene);
+  shNode->RemoveAllItems();
+  vtkIdType folderItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+  int numberOfItems = 0;
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLTransformableNode", nodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    if (numberOfItems++ % numberOfItemsPerFolder == 0)
+      {
+      std::stringstream folderName;
+      folderName << "Folder" << numberOfItems / numberOfItemsPerFolder;
+      folderItemID = shNode->CreateFolderItem(shNode->GetSceneItemID(), folderName.str());
+      }
+    shNode->CreateItem(folderItemID, *it);
+    }
+}
+
+//---------------------------------------------------------------------------
+void Benchmark::StartTimer()
+{
+  this->Timer->StartTimer();
+}
+
+//---------------------------------------------------------------------------
+void Benchmark::StopTimer(int operation, int numberOfCalls)
+{
+  this->Timer->StopTimer();
+  this->BestTimes[operation] = std::min(this->BestTimes[operation], this->Timer->GetElapsedTime());
+  this->NumberOfCalls[operation] = numberOfCalls;
+}
+
+//---------------------------------------------------------------------------
+void Benchmark::Run(std::vector<BenchmarkResult>& results)
+{
+  std::cout << "Scene with " << this->NumberOfNodes << " nodes" << std::endl;
+  const int numberOfQueries = 100;
+  const char* classNames[] = {"vtkMRMLModelNode", "vtkMRMLDisplayNode", "vtkMRMLTransformNode"};
+  const char* operations[] = {"AddNode", "GetNodeByID", "GetNodesByClass",
+    "SubjectHierarchyRebuild", "SubjectHierarchyGetItemByDataNode",
+    "SaveStateForUndo", "Commit", "Import", "RemoveNode", "Clear"};
+  const int numberOfOperations = sizeof(operations) / sizeof(operations[0]);
+  this->BestTimes.assign(numberOfOperations, VTK_DOUBLE_MAX);
+  this->NumberOfCalls.assign(numberOfOperations, 0);
+
+  // Each repetition works on its own scene so that operations are timed on
+  // the same input. The best time of all the repetitions is reported.
+  for (int repetition = 0; repetition < this->NumberOfRepetitions; ++repetition)
+    {
+    int operation = 0;
+    vtkNew<vtkMRMLScene> scene;
+
+    this->StartTimer();
+    this->PopulateScene(scene.GetPointer());
+    this->StopTimer(operation++, scene->GetNumberOfNodes());
+
+    std::vector<std::string> nodeIDs;
+    std::vector<vtkMRMLNode*> nodes;
+    scene->GetNodesByClass("vtkMRMLNode", nodes);
+    for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+      {
+      nodeIDs.push_back((*it)->GetID());
+      }
+    this->StartTimer();
+    for (std::vector<std::string>::iterator it = nodeIDs.begin(); it != nodeIDs.end(); ++it)
+      {
+      scene->GetNodeByID(*it);
+      }
+    this->StopTimer(operation++, static_cast<int>(nodeIDs.size()));
+
+    std::vector<vtkMRMLNode*> queriedNodes;
+    this->StartTimer();
+    for (int i = 0; i < numberOfQueries; ++i)
+      {
+      scene->GetNodesByClass(classNames[i % 3], queriedNodes);
+      }
+    this->StopTimer(operation++, numberOfQueries);
+
+    this->StartTimer();
+    this->BuildSubjectHierarchy(scene.GetPointer());
+    this->StopTimer(operation++, 1);
+
+    vtkMRMLSubjectHierarchyNode* shNode =
+      vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+    std::vector<vtkMRMLNode*> transformableNodes;
+    scene->GetNodesByClass("vtkMRMLTransformableNode", transformableNodes);
+    this->StartTimer();
+    for (std::vector<vtkMRMLNode*>::iterator it = transformableNodes.begin();
+         it != transformableNodes.end(); ++it)
+      {
+      shNode->GetItemByDataNode(*it);
+      }
+    this->StopTimer(operation++, static_cast<int>(transformableNodes.size()));
+
+    scene->SetUndoOn();
+    this->StartTimer();
+    scene->SaveStateForUndo();
+    this->StopTimer(operation++, 1);
+    scene->ClearUndoStack();
+    scene->SetUndoOff();
+
+    scene->SetSaveToXMLString(1);
+    this->StartTimer();
+    scene->Commit();
+    this->StopTimer(operation++, 1);
+
+    {
+    vtkNew<vtkMRMLScene> importedScene;
+    importedScene->SetLoadFromXMLString(1);
+    importedScene->SetSceneXMLString(scene->GetSceneXMLString());
+    this->StartTimer();
+    importedScene->Import();
+    this->StopTimer(operation++, 1);
+    }
+
+    // Remove 10% of the models, spread over the scene
+    std::vector<vtkMRMLNode*> modelNodes;
+    scene->GetNodesByClass("vtkMRMLModelNode", modelNodes);
+    std::vector<vtkMRMLNode*> removedNodes;
+    for (size_t i = 0; i < modelNodes.size(); i += 10)
+      {
+      removedNodes.push_back(modelNodes[i]);
+      }
+    this->StartTimer();
+    for (std::vector<vtkMRMLNode*>::iterator it = removedNodes.begin(); it != removedNodes.end(); ++it)
+      {
+      scene->RemoveNode(*it);
+      }
+    this->StopTimer(operation++, static_cast<int>(removedNodes.size()));
+
+    this->StartTimer();
+    scene->Clear(1);
+    this->StopTimer(operation++, 1);
+    }
+
+  for (int operation = 0; operation < numberOfOperations; ++operation)
+    {
+    BenchmarkResult result;
+    result.Operation = operations[operation];
+    result.NumberOfNodes = this->NumberOfNodes;
+    result.NumberOfCalls = this->NumberOfCalls[operation];
+    result.Time = this->BestTimes[operation];
+    results.push_back(result);
+    std::cout << "  " << result.Operation << ": " << result.Time << "s for "
+              << result.NumberOfCalls << " calls" << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------
+bool writeJSON(const std::string& fileName, const std::vector<BenchmarkResult>& results)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file.is_open())
+    {
+    std::cerr << "Failed to open " << fileName << " for writing" << std::endl;
+    return false;
+    }
+  file << "{\n"
+       << "  \"benchmark\": \"vtkMRMLSceneBenchmark\",\n"
+       << "  \"vtkVersion\": \"" << vtkVersion::GetVTKVersion() << "\",\n"
+       << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); ++i)
+    {
+    const BenchmarkResult& result = results[i];
+    file << "    {\"operation\": \"" << result.Operation << "\""
+         << ", \"nodes\": " << result.NumberOfNodes
+         << ", \"calls\": " << result.NumberOfCalls
+         << ", \"seconds\": " << result.Time
+         << ", \"secondsPerCall\": " << result.Time / std::max(1, result.NumberOfCalls)
+         << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+  file << "  ]\n"
+       << "}\n";
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool writeCSV(const std::string& fileName, const std::vector<BenchmarkResult>& results)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file.is_open())
+    {
+    std::cerr << "Failed to open " << fileName << " for writing" << std::endl;
+    return false;
+    }
+  file << "operation,nodes,calls,seconds,secondsPerCall\n";
+  for (size_t i = 0; i < results.size(); ++i)
+    {
+    const BenchmarkResult& result = results[i];
+    file << result.Operation << ","
+         << result.NumberOfNodes << ","
+         << result.NumberOfCalls << ","
+         << result.Time << ","
+         << result.Time / std::max(1, result.NumberOfCalls) << "\n";
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void printUsage(const char* executable)
+{
+  std::cerr << "Usage: " << executable
+            << " [--nodes N[,N...]] [--repeat R] [--json results.json] [--csv results.csv]"
+            << std::endl;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  std::vector<int> sceneSizes;
+  int numberOfRepetitions = 3;
+  std::string jsonFileName;
+  std::string csvFileName;
+  for (int i = 1; i < argc; ++i)
+    {
+    std::string argument = argv[i];
+    if (i + 1 >= argc)
+      {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+      }
+    std::string value = argv[++i];
+    if (argument == "--nodes")
+      {
+      std::stringstream sizes(value);
+      std::string size;
+      while (std::getline(sizes, size, ','))
+        {
+        sceneSizes.push_back(atoi(size.c_str()));
+        }
+      }
+    else if (argument == "--repeat")
+      {
+      numberOfRepetitions = atoi(value.c_str());
+      }
+    else if (argument == "--json")
+      {
+      jsonFileName = value;
+      }
+    else if (argument == "--csv")
+      {
+      csvFileName = value;
+      }
+    else
+      {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+      }
+    }
+  if (sceneSizes.empty())
+    {
+    sceneSizes.push_back(10000);
+    sceneSizes.push_back(100000);
+    }
+
+  std::vector<BenchmarkResult> results;
+  for (std::vector<int>::iterator size = sceneSizes.begin(); size != sceneSizes.end(); ++size)
+    {
+    Benchmark benchmark(*size, numberOfRepetitions);
+    benchmark.Run(results);
+    }
+
+  if (!jsonFileName.empty() && !writeJSON(jsonFileName, results))
+    {
+    return EXIT_FAILURE;
+    }
+  if (!csvFileName.empty() && !writeCSV(csvFileName, results))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
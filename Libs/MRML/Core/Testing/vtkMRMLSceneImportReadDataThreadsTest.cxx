@@ -0,0 +1,199 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkPointSet.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void addStorableNode(vtkMRMLScene* scene, vtkMRMLStorableNode* node,
+                     vtkMRMLStorageNode* storageNode, const char* fileName)
+{
+  storageNode->SetFileName(fileName);
+  scene->AddNode(storageNode);
+  node->SetName(fileName);
+  scene->AddNode(node);
+  node->SetAndObserveStorageNodeID(storageNode->GetID());
+}
+
+//----------------------------------------------------------------------------
+std::string createSceneXML(const std::string& dataPath, bool withMissingFile)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(dataPath.c_str());
+
+  const char* modelFileNames[] = {"cube.vtk", "cube.vtp", "sphere.vtk", "sphere.vtp", "PentaHexa.vtk"};
+  for (int i = 0; i < 5; ++i)
+    {
+    vtkNew<vtkMRMLModelNode> modelNode;
+    vtkNew<vtkMRMLModelStorageNode> storageNode;
+    addStorableNode(scene.GetPointer(), modelNode.GetPointer(), storageNode.GetPointer(),
+                    (dataPath + "/" + modelFileNames[i]).c_str());
+    }
+  const char* volumeFileNames[] = {"fixed.nrrd", "moving.nrrd", "helixMask.nrrd"};
+  for (int i = 0; i < 3; ++i)
+    {
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+    addStorableNode(scene.GetPointer(), volumeNode.GetPointer(), storageNode.GetPointer(),
+                    (dataPath + "/" + volumeFileNames[i]).c_str());
+    }
+  if (withMissingFile)
+    {
+    vtkNew<vtkMRMLModelNode> modelNode;
+    vtkNew<vtkMRMLModelStorageNode> storageNode;
+    addStorableNode(scene.GetPointer(), modelNode.GetPointer(), storageNode.GetPointer(),
+                    (dataPath + "/missing.vtk").c_str());
+    }
+
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  return scene->GetSceneXMLString();
+}
+
+//----------------------------------------------------------------------------
+// Number of points of each loaded model and volume, in node order
+std::vector<vtkIdType> loadedPointCounts(vtkMRMLScene* scene)
+{
+  std::vector<vtkIdType> counts;
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLStorableNode", nodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(*it);
+    vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(*it);
+    if (modelNode)
+      {
+      counts.push_back(modelNode->GetMesh() ? modelNode->GetMesh()->GetNumberOfPoints() : 0);
+      }
+    else if (volumeNode)
+      {
+      counts.push_back(volumeNode->GetImageData() ? volumeNode->GetImageData()->GetNumberOfPoints() : 0);
+      }
+    }
+  return counts;
+}
+
+//----------------------------------------------------------------------------
+int importScene(const std::string& sceneXML, const std::string& dataPath,
+                int numberOfThreads, vtkMRMLScene* scene, double& importTime)
+{
+  scene->SetRootDirectory(dataPath.c_str());
+  scene->SetNumberOfReadDataThreads(numberOfThreads);
+  CHECK_INT(scene->GetNumberOfReadDataThreads(), numberOfThreads);
+  scene->SetLoadFromXMLString(1);
+  scene->SetSceneXMLString(sceneXML);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  scene->Import();
+  timer->StopTimer();
+  importTime = timer->GetElapsedTime();
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testImport(const std::string& dataPath)
+{
+  std::string sceneXML = createSceneXML(dataPath, false);
+  int numberOfThreads = std::max(2, vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+
+  vtkNew<vtkMRMLScene> serialScene;
+  double serialTime = 0.;
+  CHECK_EXIT_SUCCESS(importScene(sceneXML, dataPath, 1, serialScene.GetPointer(), serialTime));
+  CHECK_INT(serialScene->GetErrorCode(), 0);
+
+  vtkNew<vtkMRMLScene> threadedScene;
+  double threadedTime = 0.;
+  CHECK_EXIT_SUCCESS(importScene(sceneXML, dataPath, numberOfThreads, threadedScene.GetPointer(), threadedTime));
+  CHECK_INT(threadedScene->GetErrorCode(), 0);
+
+  // The same data is loaded in the same nodes
+  std::vector<vtkIdType> serialCounts = loadedPointCounts(serialScene.GetPointer());
+  std::vector<vtkIdType> threadedCounts = loadedPointCounts(threadedScene.GetPointer());
+  CHECK_INT(static_cast<int>(serialCounts.size()), 8);
+  CHECK_INT(static_cast<int>(threadedCounts.size()), 8);
+  for (size_t i = 0; i < serialCounts.size(); ++i)
+    {
+    CHECK_BOOL(serialCounts[i] > 0, true);
+    CHECK_INT(threadedCounts[i], serialCounts[i]);
+    }
+  vtkMRMLModelNode* ugridModelNode = vtkMRMLModelNode::SafeDownCast(
+    threadedScene->GetFirstNodeByName((dataPath + "/PentaHexa.vtk").c_str()));
+  CHECK_NOT_NULL(ugridModelNode);
+  CHECK_NOT_NULL(ugridModelNode->GetUnstructuredGrid());
+
+  std::cout << "<DartMeasurement name=\"SerialImportTime\" type=\"numeric/double\">"
+            << serialTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"ThreadedImportTime\" type=\"numeric/double\">"
+            << threadedTime << "</DartMeasurement>" << std::endl;
+  std::cout << "Import: serial " << serialTime << "s, " << numberOfThreads
+            << " threads " << threadedTime << "s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testImportWithMissingFile(const std::string& dataPath)
+{
+  std::string sceneXML = createSceneXML(dataPath, true);
+
+  // Read errors are reported by the calling thread, as for a serial import
+  vtkNew<vtkMRMLScene> scene;
+  double importTime = 0.;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_EXIT_SUCCESS(importScene(sceneXML, dataPath, 4, scene.GetPointer(), importTime));
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_INT(scene->GetErrorCode(), 1);
+
+  std::vector<vtkIdType> counts = loadedPointCounts(scene.GetPointer());
+  CHECK_INT(static_cast<int>(counts.size()), 9);
+  CHECK_INT(counts[8], 0);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSceneImportReadDataThreadsTest(int argc, char * argv[] )
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkMRMLSceneImportReadDataThreadsTest /path/to/TestData" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string dataPath = argv[1];
+
+  CHECK_EXIT_SUCCESS(testImport(dataPath));
+  CHECK_EXIT_SUCCESS(testImportWithMissingFile(dataPath));
+  return EXIT_SUCCESS;
+}
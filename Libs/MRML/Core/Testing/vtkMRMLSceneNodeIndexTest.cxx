@@ -0,0 +1,256 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+int testClassIndex();
+int testNameIndex();
+int testInsertAndRemove();
+int testPerformance(int numberOfNodes);
+
+//---------------------------------------------------------------------------
+// Reference implementation: walk the whole scene
+std::vector<vtkMRMLNode*> scanNodesByClass(vtkMRMLScene* scene, const char* className)
+{
+  std::vector<vtkMRMLNode*> nodes;
+  vtkCollection* sceneNodes = scene->GetNodes();
+  vtkCollectionSimpleIterator it;
+  vtkMRMLNode* node = 0;
+  for (sceneNodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
+    {
+    if (node->IsA(className))
+      {
+      nodes.push_back(node);
+      }
+    }
+  return nodes;
+}
+
+//---------------------------------------------------------------------------
+int checkNodesByClass(vtkMRMLScene* scene, const char* className)
+{
+  std::vector<vtkMRMLNode*> expectedNodes = scanNodesByClass(scene, className);
+  // the vector is replaced, not appended to
+  std::vector<vtkMRMLNode*> nodes(3, static_cast<vtkMRMLNode*>(0));
+  CHECK_INT(scene->GetNodesByClass(className, nodes), static_cast<int>(expectedNodes.size()));
+  CHECK_INT(static_cast<int>(nodes.size()), static_cast<int>(expectedNodes.size()));
+  CHECK_INT(scene->GetNumberOfNodesByClass(className), static_cast<int>(expectedNodes.size()));
+  for (size_t i = 0; i < expectedNodes.size(); ++i)
+    {
+    CHECK_POINTER(nodes[i], expectedNodes[i]);
+    CHECK_POINTER(scene->GetNthNodeByClass(static_cast<int>(i), className), expectedNodes[i]);
+    }
+  CHECK_NULL(scene->GetNthNodeByClass(static_cast<int>(expectedNodes.size()), className));
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+void populateScene(vtkMRMLScene* scene, int numberOfNodes)
+{
+  for (int i = 0; i < numberOfNodes / 3; ++i)
+    {
+    vtkNew<vtkMRMLModelNode> modelNode;
+    scene->AddNode(modelNode.GetPointer());
+    vtkNew<vtkMRMLModelDisplayNode> displayNode;
+    scene->AddNode(displayNode.GetPointer());
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    scene->AddNode(transformNode.GetPointer());
+    }
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneNodeIndexTest(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(testClassIndex());
+  CHECK_EXIT_SUCCESS(testNameIndex());
+  CHECK_EXIT_SUCCESS(testInsertAndRemove());
+  CHECK_EXIT_SUCCESS(testPerformance(1000));
+  CHECK_EXIT_SUCCESS(testPerformance(10000));
+  CHECK_EXIT_SUCCESS(testPerformance(100000));
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int testClassIndex()
+{
+  vtkNew<vtkMRMLScene> scene;
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 0);
+
+  populateScene(scene.GetPointer(), 30);
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLDisplayableNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLNode"));
+
+  // Nodes added after the class has been indexed
+  populateScene(scene.GetPointer(), 30);
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLDisplayableNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLTransformNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLDisplayNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLNode"));
+
+  vtkSmartPointer<vtkCollection> nodes;
+  nodes.TakeReference(scene->GetNodesByClass("vtkMRMLLinearTransformNode"));
+  CHECK_INT(nodes->GetNumberOfItems(), 20);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLLinearTransformNode"),
+                scene->GetNodeByID("vtkMRMLLinearTransformNode1"));
+  CHECK_POINTER(scene->GetFirstNode(0, "vtkMRMLTransformNode"),
+                scene->GetNodeByID("vtkMRMLLinearTransformNode1"));
+  CHECK_NULL(scene->GetFirstNodeByClass("vtkMRMLScalarVolumeNode"));
+
+  scene->Clear(1);
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), 0);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testNameIndex()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer(), 9);
+
+  vtkMRMLNode* modelNode = scene->GetNodeByID("vtkMRMLModelNode2");
+  CHECK_NOT_NULL(modelNode);
+  CHECK_POINTER(scene->GetFirstNodeByName(modelNode->GetName()), modelNode);
+
+  // Renaming a node in the scene updates the index
+  std::string oldName = modelNode->GetName();
+  modelNode->SetName("Liver");
+  CHECK_NULL(scene->GetFirstNodeByName(oldName.c_str()));
+  CHECK_POINTER(scene->GetFirstNodeByName("Liver"), modelNode);
+
+  // Several nodes with the same name are returned in the scene order
+  vtkMRMLNode* transformNode = scene->GetNodeByID("vtkMRMLLinearTransformNode1");
+  vtkMRMLNode* lastModelNode = scene->GetNodeByID("vtkMRMLModelNode3");
+  lastModelNode->SetName("Liver");
+  transformNode->SetName("Liver");
+  vtkSmartPointer<vtkCollection> nodes;
+  nodes.TakeReference(scene->GetNodesByName("Liver"));
+  CHECK_INT(nodes->GetNumberOfItems(), 3);
+  CHECK_POINTER(nodes->GetItemAsObject(0), transformNode);
+  CHECK_POINTER(nodes->GetItemAsObject(1), modelNode);
+  CHECK_POINTER(nodes->GetItemAsObject(2), lastModelNode);
+
+  nodes.TakeReference(scene->GetNodesByClassByName("vtkMRMLModelNode", "Liver"));
+  CHECK_INT(nodes->GetNumberOfItems(), 2);
+  CHECK_POINTER(scene->GetFirstNode("Liver", "vtkMRMLModelNode"), modelNode);
+
+  scene->RemoveNode(modelNode);
+  CHECK_POINTER(scene->GetFirstNodeByName("Liver"), transformNode);
+  nodes.TakeReference(scene->GetNodesByName("Liver"));
+  CHECK_INT(nodes->GetNumberOfItems(), 2);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testInsertAndRemove()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer(), 15);
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+
+  // Inserted nodes are not appended, the index must follow the scene order.
+  vtkNew<vtkMRMLModelNode> insertedNode;
+  scene->InsertBeforeNode(scene->GetNodeByID("vtkMRMLModelNode2"), insertedNode.GetPointer());
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_POINTER(scene->GetNthNodeByClass(1, "vtkMRMLModelNode"), insertedNode.GetPointer());
+
+  scene->RemoveNode(scene->GetNodeByID("vtkMRMLModelNode1"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLModelNode"), insertedNode.GetPointer());
+
+  scene->RemoveNode(insertedNode.GetPointer());
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLModelNode"));
+  CHECK_EXIT_SUCCESS(checkNodesByClass(scene.GetPointer(), "vtkMRMLNode"));
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testPerformance(int numberOfNodes)
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer(), numberOfNodes);
+  const int numberOfQueries = 100;
+  const char* classNames[] = {"vtkMRMLModelNode", "vtkMRMLDisplayNode", "vtkMRMLTransformNode"};
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  size_t scannedCount = 0;
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    scannedCount += scanNodesByClass(scene.GetPointer(), classNames[i % 3]).size();
+    }
+  timer->StopTimer();
+  double scanTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  size_t indexedCount = 0;
+  std::vector<vtkMRMLNode*> nodes;
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    indexedCount += scene->GetNodesByClass(classNames[i % 3], nodes);
+    }
+  timer->StopTimer();
+  double indexedTime = timer->GetElapsedTime();
+  CHECK_INT(static_cast<int>(indexedCount), static_cast<int>(scannedCount));
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    std::stringstream name;
+    name << "vtkMRMLModelNode_" << (i * 7) % (numberOfNodes / 3);
+    scene->GetFirstNodeByName(name.str().c_str());
+    }
+  timer->StopTimer();
+  double nameTime = timer->GetElapsedTime();
+
+  std::cout << "<DartMeasurement name=\"vtkMRMLScene-ScanNodesByClass-"
+            << numberOfNodes << "\" type=\"numeric/double\">"
+            << scanTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"vtkMRMLScene-GetNodesByClass-"
+            << numberOfNodes << "\" type=\"numeric/double\">"
+            << indexedTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"vtkMRMLScene-GetFirstNodeByName-"
+            << numberOfNodes << "\" type=\"numeric/double\">"
+            << nameTime << "</DartMeasurement>" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,198 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+namespace
+{
+
+int testVolumeUndo();
+int testModelUndo();
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneUndoBulkDataTest(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(testVolumeUndo());
+  CHECK_EXIT_SUCCESS(testModelUndo());
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int testVolumeUndo()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(16, 16, 16);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->FillComponent(0, 1.);
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+
+  // Snapshots reference the scalars of the image data, they don't copy them
+  vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+  vtkNew<vtkMRMLScalarVolumeNode> snapshot1;
+  snapshot1->CopyWithSceneSharingBulkData(volumeNode.GetPointer());
+  vtkNew<vtkMRMLScalarVolumeNode> snapshot2;
+  snapshot2->CopyWithSceneSharingBulkData(volumeNode.GetPointer());
+  CHECK_POINTER_DIFFERENT(snapshot1->GetImageData(), imageData.GetPointer());
+  CHECK_POINTER(snapshot1->GetImageData(), snapshot2->GetImageData());
+  CHECK_POINTER(snapshot1->GetImageData()->GetPointData()->GetScalars(), scalars);
+
+  // Editing the scalars in place after StartBulkDataModify() does not change
+  // the snapshots, the image data object of the node is kept
+  volumeNode->StartBulkDataModify();
+  CHECK_POINTER(volumeNode->GetImageData(), imageData.GetPointer());
+  CHECK_POINTER_DIFFERENT(imageData->GetPointData()->GetScalars(), scalars);
+  CHECK_POINTER(snapshot1->GetImageData()->GetPointData()->GetScalars(), scalars);
+  imageData->GetPointData()->GetScalars()->SetTuple1(0, 2.);
+  imageData->GetPointData()->GetScalars()->Modified();
+  CHECK_INT(scalars->GetTuple1(0), 1);
+  vtkNew<vtkMRMLScalarVolumeNode> snapshot3;
+  snapshot3->CopyWithSceneSharingBulkData(volumeNode.GetPointer());
+  CHECK_POINTER(snapshot3->GetImageData()->GetPointData()->GetScalars(),
+                imageData->GetPointData()->GetScalars());
+  CHECK_INT(snapshot3->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 2);
+
+  // Data that is not referenced by snapshots is not copied
+  vtkDataArray* modifiedScalars = imageData->GetPointData()->GetScalars();
+  volumeNode->StartBulkDataModify();
+  CHECK_POINTER_DIFFERENT(imageData->GetPointData()->GetScalars(), modifiedScalars);
+  modifiedScalars = imageData->GetPointData()->GetScalars();
+  volumeNode->StartBulkDataModify();
+  CHECK_POINTER(imageData->GetPointData()->GetScalars(), modifiedScalars);
+
+  // Restoring a snapshot references the scalars of the snapshot
+  volumeNode->Copy(snapshot1.GetPointer());
+  CHECK_POINTER_DIFFERENT(volumeNode->GetImageData(), imageData.GetPointer());
+  CHECK_POINTER_DIFFERENT(volumeNode->GetImageData(), snapshot1->GetImageData());
+  CHECK_POINTER(volumeNode->GetImageData()->GetPointData()->GetScalars(), scalars);
+  CHECK_INT(volumeNode->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 1);
+
+  // The image data of the node is kept if it is unmodified since the
+  // snapshot was made
+  vtkImageData* restoredImageData = volumeNode->GetImageData();
+  vtkNew<vtkMRMLScalarVolumeNode> snapshot4;
+  snapshot4->CopyWithSceneSharingBulkData(volumeNode.GetPointer());
+  CHECK_POINTER(snapshot4->GetImageData(), snapshot1->GetImageData());
+  volumeNode->Copy(snapshot4.GetPointer());
+  CHECK_POINTER(volumeNode->GetImageData(), restoredImageData);
+
+  // Undo restores the values of scalars edited in place
+  scene->SaveStateForUndo(volumeNode.GetPointer());
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 1);
+  volumeNode->StartBulkDataModify();
+  scalars = volumeNode->GetImageData()->GetPointData()->GetScalars();
+  scalars->SetTuple1(0, 3.);
+  scalars->Modified();
+
+  scene->Undo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 0);
+  CHECK_INT(volumeNode->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 1);
+
+  scene->Redo();
+  CHECK_INT(volumeNode->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 3);
+
+  // Replacing the image data in place does not change the undo stack
+  scene->SaveStateForUndo(volumeNode.GetPointer());
+  vtkNew<vtkImageData> newImageData;
+  newImageData->SetDimensions(8, 8, 8);
+  newImageData->AllocateScalars(VTK_SHORT, 1);
+  volumeNode->GetImageData()->DeepCopy(newImageData.GetPointer());
+  CHECK_INT(volumeNode->GetImageData()->GetDimensions()[0], 8);
+
+  scene->Undo();
+  CHECK_INT(volumeNode->GetImageData()->GetDimensions()[0], 16);
+  CHECK_INT(volumeNode->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 3);
+
+  scene->Redo();
+  CHECK_INT(volumeNode->GetImageData()->GetDimensions()[0], 8);
+
+  // Undoing the state of the whole scene does not copy unmodified data
+  scene->SaveStateForUndo();
+  restoredImageData = volumeNode->GetImageData();
+  volumeNode->SetName("Renamed");
+  scene->Undo();
+  CHECK_POINTER(volumeNode->GetImageData(), restoredImageData);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testModelUndo()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->Update();
+  vtkNew<vtkPolyData> polyData;
+  polyData->DeepCopy(sphere->GetOutput());
+  vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObservePolyData(polyData.GetPointer());
+  scene->AddNode(modelNode.GetPointer());
+
+  scene->SaveStateForUndo(modelNode.GetPointer());
+  CHECK_POINTER_DIFFERENT(modelNode->GetPolyData(), NULL);
+
+  // Replacing the mesh in place does not change the undo stack
+  modelNode->GetPolyData()->Initialize();
+  CHECK_INT(modelNode->GetPolyData()->GetNumberOfPoints(), 0);
+
+  scene->Undo();
+  CHECK_INT(modelNode->GetPolyData()->GetNumberOfPoints(), numberOfPoints);
+  CHECK_POINTER_DIFFERENT(modelNode->GetPolyData(), polyData.GetPointer());
+
+  // Moving points in place does not change the undo stack
+  double point[3] = {0., 0., 0.};
+  modelNode->GetPolyData()->GetPoint(0, point);
+  scene->SaveStateForUndo(modelNode.GetPointer());
+  modelNode->StartBulkDataModify();
+  vtkPoints* points = modelNode->GetPolyData()->GetPoints();
+  points->SetPoint(0, point[0] + 10., point[1], point[2]);
+  points->Modified();
+
+  scene->Undo();
+  double restoredPoint[3] = {0., 0., 0.};
+  modelNode->GetPolyData()->GetPoint(0, restoredPoint);
+  CHECK_DOUBLE(restoredPoint[0], point[0]);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,179 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyConstants.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string seriesUID(int series)
+{
+  std::stringstream ss;
+  ss << "1.2.840.99999.1." << series;
+  return ss.str();
+}
+
+//----------------------------------------------------------------------------
+std::string instanceUID(int series, int instance)
+{
+  std::stringstream ss;
+  ss << "1.2.840.99999.2." << series << "." << instance;
+  return ss.str();
+}
+
+//----------------------------------------------------------------------------
+int testLookups()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  const char* uidName = vtkMRMLSubjectHierarchyConstants::GetDICOMUIDName();
+  const char* instanceUIDName = vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName();
+
+  vtkIdType studyItemID = shNode->CreateStudyItem(shNode->GetSceneItemID(), "Study");
+  vtkIdType folderItemID = shNode->CreateFolderItem(shNode->GetSceneItemID(), "Folder");
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  vtkIdType volumeItemID = shNode->CreateItem(studyItemID, volumeNode.GetPointer());
+  shNode->SetItemUID(volumeItemID, uidName, "1.2.3");
+  shNode->SetItemUID(volumeItemID, instanceUIDName, "1.2.3.1 1.2.3.2 1.2.3.10");
+
+  CHECK_INT(shNode->GetItemByDataNode(volumeNode.GetPointer()), volumeItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2.3"), volumeItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3.2"), volumeItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3.10"), volumeItemID);
+  // UIDs need to match a whole element of the list
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3.3"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Changing a UID updates the lookup
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  shNode->SetItemUID(volumeItemID, uidName, "1.2.4");
+  TESTING_OUTPUT_ASSERT_WARNINGS_END(); // Expected warning: UID with name already exists, replacing it
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2.3"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2.4"), volumeItemID);
+
+  // Reparenting keeps the lookup
+  shNode->SetItemParent(volumeItemID, folderItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volumeNode.GetPointer()), volumeItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3.1"), volumeItemID);
+
+  // Removed items are not found
+  CHECK_BOOL(shNode->RemoveItem(volumeItemID, false), true);
+  CHECK_INT(shNode->GetItemByDataNode(volumeNode.GetPointer()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2.4"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "1.2.3.1"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Items of another scene are not found
+  vtkNew<vtkMRMLScene> otherScene;
+  vtkMRMLSubjectHierarchyNode* otherShNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(otherScene.GetPointer());
+  vtkIdType otherStudyItemID = otherShNode->CreateStudyItem(otherShNode->GetSceneItemID(), "Study");
+  otherShNode->SetItemUID(otherStudyItemID, uidName, "1.2.5");
+  CHECK_INT(otherShNode->GetItemByUID(uidName, "1.2.5"), otherStudyItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "1.2.5"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int benchmark(int numberOfSeries, int numberOfInstances)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  const char* uidName = vtkMRMLSubjectHierarchyConstants::GetDICOMUIDName();
+  const char* instanceUIDName = vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName();
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+
+  // Import series the way the DICOM plugins do: look up the study and the series
+  // by UID, then create the series item and set its UIDs
+  vtkIdType patientItemID = shNode->CreateSubjectItem(shNode->GetSceneItemID(), "Patient");
+  std::vector<vtkIdType> seriesItemIDs;
+  for (int series = 0; series < numberOfSeries; ++series)
+    {
+    std::stringstream studyUID;
+    studyUID << "1.2.840.99999.0." << series / 10;
+    vtkIdType studyItemID = shNode->GetItemByUID(uidName, studyUID.str().c_str());
+    if (studyItemID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+      {
+      studyItemID = shNode->CreateStudyItem(patientItemID, studyUID.str());
+      shNode->SetItemUID(studyItemID, uidName, studyUID.str());
+      }
+    CHECK_INT(shNode->GetItemByUID(uidName, seriesUID(series).c_str()), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    scene->AddNode(volumeNode.GetPointer());
+    vtkIdType seriesItemID = shNode->CreateItem(studyItemID, volumeNode.GetPointer());
+    shNode->SetItemUID(seriesItemID, uidName, seriesUID(series));
+    std::string instanceUIDs;
+    for (int instance = 0; instance < numberOfInstances; ++instance)
+      {
+      instanceUIDs += instanceUID(series, instance) + " ";
+      }
+    shNode->SetItemUID(seriesItemID, instanceUIDName, instanceUIDs);
+    seriesItemIDs.push_back(seriesItemID);
+    }
+  timer->StopTimer();
+  double importTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  for (int series = 0; series < numberOfSeries; ++series)
+    {
+    vtkMRMLNode* dataNode = shNode->GetItemDataNode(seriesItemIDs[series]);
+    CHECK_INT(shNode->GetItemByDataNode(dataNode), seriesItemIDs[series]);
+    CHECK_INT(shNode->GetItemByUID(uidName, seriesUID(series).c_str()), seriesItemIDs[series]);
+    for (int instance = 0; instance < numberOfInstances; instance += 10)
+      {
+      CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, instanceUID(series, instance).c_str()), seriesItemIDs[series]);
+      }
+    }
+  timer->StopTimer();
+  double lookupTime = timer->GetElapsedTime();
+
+  std::cout << "<DartMeasurement name=\"ImportSeriesTime\" type=\"numeric/double\">"
+            << importTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"LookupSeriesTime\" type=\"numeric/double\">"
+            << lookupTime << "</DartMeasurement>" << std::endl;
+  std::cout << numberOfSeries << " series of " << numberOfInstances << " instances: imported in "
+            << importTime << "s, looked up in " << lookupTime << "s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNodeTest1(int , char * [] )
+{
+  CHECK_EXIT_SUCCESS(testLookups());
+  CHECK_EXIT_SUCCESS(benchmark(500, 200));
+  return EXIT_SUCCESS;
+}
@@ -20,8 +20,13 @@
 
 // VTK includes
 #include "vtkImageData.h"
+#include "vtkMath.h"
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
+#include "vtkTimerLog.h"
+
+// STD includes
+#include <vector>
 
 typedef double itkVectorComponentType;
 typedef itk::Vector<itkVectorComponentType, 3> itkVectorPixelType;
@@ -286,6 +291,115 @@ double getInverseErrorVtk(const double inputPoint[3], vtkOrientedGridTransform*
   return errorOfInverseComputation;
 }
 
+//----------------------------------------------------------------------------
+// Compare the inverse computed from the cached inverse grid to the iterative
+// inverse. Returns the number of mismatches.
+int compareCachedInverse(vtkOrientedGridTransform* iterativeGridVtk, vtkOrientedGridTransform* cachedGridVtk,
+  double origin[3], double spacing[3], double direction[3][3], double dims[3])
+{
+  vtkAbstractTransform* iterativeInverse = iterativeGridVtk->GetInverse();
+  vtkAbstractTransform* cachedInverse = cachedGridVtk->GetInverse();
+
+  // Compute the cached grid outside of the timed loop
+  double cachedInverseError = vtkOrientedGridTransform::SafeDownCast(cachedInverse)->GetCachedInverseError();
+  std::cout << "Cached inverse error: " << cachedInverseError << std::endl;
+  if (cachedInverseError < 0 || cachedInverseError > cachedGridVtk->GetCachedInverseMaximumError())
+    {
+    std::cout << "ERROR: Cached inverse error is out of range" << std::endl;
+    return 1;
+    }
+
+  std::vector<double> inputPoints;
+  const int numberOfSamplesPerAxis = 30;
+  for (int k = 0; k < numberOfSamplesPerAxis; k++)
+    {
+    for (int j = 0; j < numberOfSamplesPerAxis; j++)
+      {
+      for (int i = 0; i < numberOfSamplesPerAxis; i++)
+        {
+        double index[3] =
+          {
+          0.5 + (dims[0] - 2) * i / numberOfSamplesPerAxis,
+          0.5 + (dims[1] - 2) * j / numberOfSamplesPerAxis,
+          0.5 + (dims[2] - 2) * k / numberOfSamplesPerAxis
+          };
+        for (int row = 0; row < 3; row++)
+          {
+          inputPoints.push_back(origin[row]
+            + direction[row][0]*spacing[0]*index[0]
+            + direction[row][1]*spacing[1]*index[1]
+            + direction[row][2]*spacing[2]*index[2]);
+          }
+        }
+      }
+    }
+  const size_t numberOfPoints = inputPoints.size() / 3;
+  std::vector<double> iterativePoints(inputPoints.size());
+  std::vector<double> cachedPoints(inputPoints.size());
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (size_t i = 0; i < numberOfPoints; i++)
+    {
+    iterativeInverse->TransformPoint(&inputPoints[3*i], &iterativePoints[3*i]);
+    }
+  timer->StopTimer();
+  double iterativeTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  for (size_t i = 0; i < numberOfPoints; i++)
+    {
+    cachedInverse->TransformPoint(&inputPoints[3*i], &cachedPoints[3*i]);
+    }
+  timer->StopTimer();
+  double cachedTime = timer->GetElapsedTime();
+  std::cout << "<DartMeasurement name=\"IterativeInverseTime\" type=\"numeric/double\">"
+            << iterativeTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"CachedInverseTime\" type=\"numeric/double\">"
+            << cachedTime << "</DartMeasurement>" << std::endl;
+
+  int numberOfMismatches = 0;
+  for (size_t i = 0; i < numberOfPoints; i++)
+    {
+    double difference = sqrt(vtkMath::Distance2BetweenPoints(&iterativePoints[3*i], &cachedPoints[3*i]));
+    if (difference > cachedGridVtk->GetCachedInverseMaximumError())
+      {
+      std::cout << "ERROR: Cached inverse differs from the iterative inverse by " << difference
+                << " at (" << inputPoints[3*i] << ", " << inputPoints[3*i+1] << ", " << inputPoints[3*i+2] << ")" << std::endl;
+      numberOfMismatches++;
+      }
+    }
+  return numberOfMismatches;
+}
+
+//----------------------------------------------------------------------------
+int testCachedInverse(double origin[3], double spacing[3], double direction[3][3], double dims[3])
+{
+  vtkNew<vtkOrientedGridTransform> gridVtk;
+  CreateGridTransformVtk(gridVtk.GetPointer(), origin, spacing, direction, dims);
+  int nodeIndex[3] = {3, 4, 3};
+  double nodeValue[3] = {20.0, -30.0, 25.0};
+  SetGridNodeVtk(gridVtk.GetPointer(), nodeIndex, nodeValue);
+
+  vtkNew<vtkOrientedGridTransform> cachedGridVtk;
+  cachedGridVtk->DeepCopy(gridVtk.GetPointer());
+  cachedGridVtk->UseCachedInverseOn();
+  cachedGridVtk->SetCachedInverseGridRefinement(4);
+  cachedGridVtk->SetCachedInverseMaximumError(0.5);
+
+  int numberOfMismatches = compareCachedInverse(gridVtk.GetPointer(), cachedGridVtk.GetPointer(),
+    origin, spacing, direction, dims);
+
+  // The cached inverse grid is recomputed when the displacement field changes
+  double newNodeValue[3] = {-25.0, 10.0, 30.0};
+  SetGridNodeVtk(gridVtk.GetPointer(), nodeIndex, newNodeValue);
+  gridVtk->GetDisplacementGrid()->Modified();
+  numberOfMismatches += compareCachedInverse(gridVtk.GetPointer(), cachedGridVtk.GetPointer(),
+    origin, spacing, direction, dims);
+
+  std::cout << "Number of cached inverse mismatches: " << numberOfMismatches << std::endl;
+  return numberOfMismatches;
+}
+
 //----------------------------------------------------------------------------
 int vtkOrientedGridTransformTest1(int , char * [] )
 {
@@ -424,7 +538,10 @@ int vtkOrientedGridTransformTest1(int , char * [] )
   std::cout << "Number of derivative mismatches: " << numberOfDerivativeMismatches << std::endl;
   std::cout << "Number of inverse mismatches: " << numberOfInverseMismatches << std::endl;
 
-  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0)
+  int numberOfCachedInverseMismatches = testCachedInverse(origin, spacing, direction, dims);
+
+  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0
+    && numberOfCachedInverseMismatches==0)
     {
     std::cout << "Test result: PASSED" << std::endl;
     return EXIT_SUCCESS;
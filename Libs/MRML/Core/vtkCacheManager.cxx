@@ -8,12 +8,240 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <vtkCallbackCommand.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <sstream>
 
 vtkStandardNewMacro ( vtkCacheManager );
 
 #define MB 1000000.0
 
+//----------------------------------------------------------------------------
+class vtkCacheManager::vtkInternal
+{
+public:
+  vtkInternal();
+
+  struct CacheEntry
+    {
+    CacheEntry() : Size(0.), LastAccessTime(0.) {}
+    std::string URI;
+    double Size;
+    double LastAccessTime;
+    };
+  /// Full path of the cached file -> entry
+  typedef std::map<std::string, CacheEntry> CacheIndexType;
+
+  /// Add or update a file. IndexLock must be held.
+  void AddFile(const std::string& path, const char* uri, double size, double lastAccessTime);
+  /// Remove a file or all the files of a directory. IndexLock must be held.
+  void RemoveFiles(const std::string& path);
+  /// Return the full path of a cached file given as full path
+  /// or relative to the cache directory. Empty if the file does not exist.
+  static std::string GetCachedFilePath(const std::string& cacheDirectory, const char* filename);
+
+  /// Move a file or directory out of the way, into the trash directory of
+  /// the cache, so that the path can be reused before it is deleted.
+  /// Return the new path, or an empty string if it could not be moved.
+  std::string MoveToTrash(const std::string& cacheDirectory, const std::string& path);
+
+  /// Delete the files from disk in the background thread.
+  void QueueDeletion(const std::vector<std::string>& paths);
+  void WaitForDeletion();
+  static VTK_THREAD_RETURN_TYPE DeletionThreadFunction(void* arg);
+
+  CacheIndexType CacheIndex;
+  /// Sum of the sizes of the files in the index, in bytes
+  double CacheIndexSize;
+  bool CacheIndexModified;
+  vtkSimpleMutexLock IndexLock;
+
+  vtkNew<vtkMultiThreader> DeletionThreader;
+  int DeletionThreadID;
+  bool DeletionThreadRunning;
+  std::deque<std::string> PendingDeletions;
+  unsigned long TrashCounter;
+  vtkSimpleMutexLock DeletionLock;
+};
+
+//----------------------------------------------------------------------------
+vtkCacheManager::vtkInternal::vtkInternal()
+{
+  this->CacheIndexSize = 0.;
+  this->CacheIndexModified = false;
+  this->DeletionThreadID = -1;
+  this->DeletionThreadRunning = false;
+  this->TrashCounter = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::AddFile(const std::string& path, const char* uri,
+                                           double size, double lastAccessTime)
+{
+  CacheIndexType::iterator it = this->CacheIndex.find(path);
+  if (it == this->CacheIndex.end())
+    {
+    it = this->CacheIndex.insert(std::make_pair(path, CacheEntry())).first;
+    }
+  this->CacheIndexSize += size - it->second.Size;
+  it->second.Size = size;
+  it->second.LastAccessTime = lastAccessTime;
+  if (uri)
+    {
+    it->second.URI = uri;
+    }
+  this->CacheIndexModified = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::RemoveFiles(const std::string& path)
+{
+  CacheIndexType::iterator it = this->CacheIndex.find(path);
+  if (it != this->CacheIndex.end())
+    {
+    this->CacheIndexSize -= it->second.Size;
+    this->CacheIndex.erase(it);
+    this->CacheIndexModified = true;
+    }
+  // entries are sorted by path, files of a directory are next to each other
+  std::string directoryPrefix = path + "/";
+  it = this->CacheIndex.lower_bound(directoryPrefix);
+  while (it != this->CacheIndex.end() && it->first.compare(0, directoryPrefix.size(), directoryPrefix) == 0)
+    {
+    this->CacheIndexSize -= it->second.Size;
+    this->CacheIndex.erase(it++);
+    this->CacheIndexModified = true;
+    }
+  if (this->CacheIndex.empty())
+    {
+    // avoid accumulating rounding errors
+    this->CacheIndexSize = 0.;
+    }
+}
+
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::vtkInternal::GetCachedFilePath(const std::string& cacheDirectory, const char* filename)
+{
+  if (filename == NULL)
+    {
+    return std::string();
+    }
+  if (vtksys::SystemTools::FileExists(filename))
+    {
+    return vtksys::SystemTools::CollapseFullPath(filename);
+    }
+  std::string testFile = cacheDirectory + "/" + filename;
+  if (vtksys::SystemTools::FileExists(testFile.c_str()))
+    {
+    return vtksys::SystemTools::CollapseFullPath(testFile.c_str());
+    }
+  return std::string();
+}
+
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::vtkInternal::MoveToTrash(const std::string& cacheDirectory,
+                                                      const std::string& path)
+{
+  std::string trashDirectory = cacheDirectory + "/" + vtkCacheManager::GetCacheTrashDirectoryName();
+  if (!vtksys::SystemTools::FileIsDirectory(trashDirectory.c_str()) &&
+      !vtksys::SystemTools::MakeDirectory(trashDirectory.c_str()))
+    {
+    return std::string();
+    }
+  // unique among the files of this and previous sessions
+  std::string trashPath;
+  do
+    {
+    std::stringstream ss;
+    ss << trashDirectory << "/" << static_cast<long long>(vtkTimerLog::GetUniversalTime() * 1e6)
+       << "_" << this->TrashCounter++ << "_" << vtksys::SystemTools::GetFilenameName(path);
+    trashPath = ss.str();
+    }
+  while (vtksys::SystemTools::FileExists(trashPath.c_str()));
+  if (!vtksys::SystemTools::RenameFile(path.c_str(), trashPath.c_str()))
+    {
+    return std::string();
+    }
+  return trashPath;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::QueueDeletion(const std::vector<std::string>& paths)
+{
+  if (paths.empty())
+    {
+    return;
+    }
+  bool startThread = false;
+  this->DeletionLock.Lock();
+  this->PendingDeletions.insert(this->PendingDeletions.end(), paths.begin(), paths.end());
+  if (!this->DeletionThreadRunning)
+    {
+    this->DeletionThreadRunning = true;
+    startThread = true;
+    }
+  this->DeletionLock.Unlock();
+  if (startThread)
+    {
+    if (this->DeletionThreadID >= 0)
+      {
+      // join the previous thread, it has already finished its work
+      this->DeletionThreader->TerminateThread(this->DeletionThreadID);
+      }
+    this->DeletionThreadID = this->DeletionThreader->SpawnThread(
+      &vtkCacheManager::vtkInternal::DeletionThreadFunction, this);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::WaitForDeletion()
+{
+  if (this->DeletionThreadID >= 0)
+    {
+    this->DeletionThreader->TerminateThread(this->DeletionThreadID);
+    this->DeletionThreadID = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkCacheManager::vtkInternal::DeletionThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkInternal* self = static_cast<vtkInternal*>(threadInfo->UserData);
+  while (true)
+    {
+    self->DeletionLock.Lock();
+    if (self->PendingDeletions.empty())
+      {
+      self->DeletionThreadRunning = false;
+      self->DeletionLock.Unlock();
+      break;
+      }
+    std::string path = self->PendingDeletions.front();
+    self->PendingDeletions.pop_front();
+    self->DeletionLock.Unlock();
+
+    if (vtksys::SystemTools::FileIsDirectory(path.c_str()))
+      {
+      vtksys::SystemTools::RemoveADirectory(path.c_str());
+      }
+    else
+      {
+      vtksys::SystemTools::RemoveFile(path.c_str());
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //----------------------------------------------------------------------------
 vtkCacheManager::vtkCacheManager()
 {
@@ -25,15 +253,20 @@ vtkCacheManager::vtkCacheManager()
   this->RemoteCacheFreeBufferSize = 10;
   this->CurrentCacheSize = 0;
   this->EnableForceRedownload = 0;
+  this->AutomaticEviction = 1;
   this->InsufficientFreeBufferNotificationFlag = 0;
   // this->EnableRemoteCacheOverwriting = 1;
   this->uriMap.clear();
+  this->Internal = new vtkInternal;
 }
 
 
 //----------------------------------------------------------------------------
 vtkCacheManager::~vtkCacheManager()
 {
+  this->WaitForEviction();
+  this->SaveCacheIndex();
+  delete this->Internal;
 
   this->MRMLScene = NULL;
   this->uriMap.clear();
@@ -128,12 +361,20 @@ void vtkCacheManager::SetRemoteCacheDirectory (const char *dir )
     return;
     }
 
+  // save the index of the previous cache directory
+  this->SaveCacheIndex();
+
   this->RemoteCacheDirectory = dirstring;
   if (!vtksys::SystemTools::FileExists(this->RemoteCacheDirectory.c_str()))
     {
     vtksys::SystemTools::MakeDirectory(this->RemoteCacheDirectory.c_str());
     }
-  // scan files in cache, it calls Modified
+  // read the cache index, the directory is only scanned if there is no index yet
+  if (!this->LoadCacheIndex())
+    {
+    this->RebuildCacheIndex();
+    }
+  // it calls Modified
   this->UpdateCacheInformation();
 }
 
@@ -254,6 +495,10 @@ void vtkCacheManager::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "RemoteCacheFreeBufferSize: " << this->GetRemoteCacheFreeBufferSize() << "\n";
   //os << indent << "EnableRemoteCacheOverwriting: " << this->GetEnableRemoteCacheOverwriting() << "\n";
   os << indent << "EnableForceRedownload: " << this->GetEnableForceRedownload() << "\n";
+  os << indent << "AutomaticEviction: " << this->GetAutomaticEviction() << "\n";
+  this->Internal->IndexLock.Lock();
+  os << indent << "NumberOfIndexedFiles: " << this->Internal->CacheIndex.size() << "\n";
+  this->Internal->IndexLock.Unlock();
 }
 
 
@@ -300,6 +545,11 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
 
           //--- if the file is a directory, have to go inside and
           //--- do some recursive thing to add those files to cached list
+          //--- (evicted files waiting for deletion are not cached files)
+          if ( !strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)), vtkCacheManager::GetCacheTrashDirectoryName()) )
+            {
+            continue;
+            }
           if(vtksys::SystemTools::FileIsDirectory(fullName.c_str()))
             {
             if ( ! this->GetCachedFileList ( fullName.c_str() ) )
@@ -307,9 +557,14 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
               return (0);
               }
             }
-          else
+          else if ( strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)), vtkCacheManager::GetCacheIndexFileName()) )
             {
             this->CachedFileList.push_back ( dir.GetFile(static_cast<unsigned long>(fileNum) ));
+            this->Internal->IndexLock.Lock();
+            this->Internal->AddFile(vtksys::SystemTools::CollapseFullPath(fullName.c_str()), NULL,
+              static_cast<double>(vtksys::SystemTools::FileLength(fullName.c_str())),
+              static_cast<double>(vtksys::SystemTools::ModifiedTime(fullName.c_str())));
+            this->Internal->IndexLock.Unlock();
             }
           }
         }
@@ -508,18 +763,260 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
 //----------------------------------------------------------------------------
 void vtkCacheManager::UpdateCacheInformation ( )
 {
-  //--- now recompute cache size
-  // this->CurrentCacheSize = ?;
-
-  //--- recompute free buffer size
-  // this->RemoteCacheFreeBufferSize = ?;
+  if ( this->AutomaticEviction )
+    {
+    this->EvictLeastRecentlyUsedFiles();
+    }
 
-  //--- and refresh list of cached files.
+  //--- refresh list of cached files from the index.
   this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
+  this->Internal->IndexLock.Lock();
+  for (vtkInternal::CacheIndexType::iterator it = this->Internal->CacheIndex.begin();
+       it != this->Internal->CacheIndex.end(); ++it)
+    {
+    this->CachedFileList.push_back ( vtksys::SystemTools::GetFilenameName ( it->first ) );
+    }
+  this->CurrentCacheSize = static_cast<float>(this->Internal->CacheIndexSize / MB);
+  this->Internal->IndexLock.Unlock();
+
+  this->SaveCacheIndex();
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+const char* vtkCacheManager::GetCacheIndexFileName ( )
+{
+  return ".SlicerCacheIndex.txt";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkCacheManager::GetCacheTrashDirectoryName ( )
+{
+  return ".SlicerCacheTrash";
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCachedFile ( const char *filename, const char *uri )
+{
+  std::string path = vtkInternal::GetCachedFilePath ( this->RemoteCacheDirectory, filename );
+  if ( path.empty() || vtksys::SystemTools::FileIsDirectory ( path.c_str() ) )
+    {
+    vtkDebugMacro ( "AddCachedFile: " << (filename ? filename : "(null)") << " is not a file." );
+    return;
+    }
+  //--- only files in the cache directory may be evicted
+  std::string cacheDirectory = vtksys::SystemTools::CollapseFullPath ( this->RemoteCacheDirectory.c_str() ) + "/";
+  if ( this->RemoteCacheDirectory.empty() || path.compare ( 0, cacheDirectory.size(), cacheDirectory ) != 0 )
+    {
+    vtkDebugMacro ( "AddCachedFile: " << path << " is not in the cache directory." );
+    return;
+    }
+  double size = static_cast<double>(vtksys::SystemTools::FileLength ( path.c_str() ));
+  this->Internal->IndexLock.Lock();
+  this->Internal->AddFile ( path, uri, size, vtkTimerLog::GetUniversalTime() );
+  this->Internal->IndexLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::TouchCachedFile ( const char *filename )
+{
+  std::string path = vtkInternal::GetCachedFilePath ( this->RemoteCacheDirectory, filename );
+  if ( path.empty() )
+    {
+    return;
+    }
+  this->Internal->IndexLock.Lock();
+  vtkInternal::CacheIndexType::iterator it = this->Internal->CacheIndex.find ( path );
+  if ( it != this->Internal->CacheIndex.end() )
+    {
+    it->second.LastAccessTime = vtkTimerLog::GetUniversalTime();
+    this->Internal->CacheIndexModified = true;
+    }
+  this->Internal->IndexLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RebuildCacheIndex ( )
+{
+  this->Internal->IndexLock.Lock();
+  this->Internal->CacheIndex.clear();
+  this->Internal->CacheIndexSize = 0.;
+  this->Internal->CacheIndexModified = true;
+  this->Internal->IndexLock.Unlock();
+
+  this->CachedFileList.clear();
+  if ( !this->RemoteCacheDirectory.empty() )
+    {
+    this->GetCachedFileList ( this->RemoteCacheDirectory.c_str() );
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::LoadCacheIndex ( )
+{
+  if ( this->RemoteCacheDirectory.empty() )
+    {
+    return 0;
+    }
+  std::string indexFileName = this->RemoteCacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  std::ifstream indexFile ( indexFileName.c_str() );
+  if ( !indexFile.is_open() )
+    {
+    return 0;
+    }
+  std::string line;
+  if ( !std::getline ( indexFile, line ) || line != "# vtkCacheManager index 1" )
+    {
+    vtkWarningMacro ( "LoadCacheIndex: invalid cache index file " << indexFileName );
+    return 0;
+    }
+
+  this->Internal->IndexLock.Lock();
+  this->Internal->CacheIndex.clear();
+  this->Internal->CacheIndexSize = 0.;
+  //--- one line per file: size, last access time, path relative to the cache directory, uri
+  while ( std::getline ( indexFile, line ) )
+    {
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    for (int i = 0; i < 3; ++i)
+      {
+      std::string::size_type end = line.find ( '\t', start );
+      if ( end == std::string::npos )
+        {
+        break;
+        }
+      fields.push_back ( line.substr ( start, end - start ) );
+      start = end + 1;
+      }
+    if ( fields.size() != 3 )
+      {
+      continue;
+      }
+    std::string path = vtksys::SystemTools::CollapseFullPath ( fields[2].c_str(), this->RemoteCacheDirectory.c_str() );
+    //--- files may have been removed since the index was saved
+    if ( !vtksys::SystemTools::FileExists ( path.c_str() ) )
+      {
+      continue;
+      }
+    std::string uri = line.substr ( start );
+    this->Internal->AddFile ( path, uri.c_str(), atof ( fields[0].c_str() ), atof ( fields[1].c_str() ) );
+    }
+  this->Internal->CacheIndexModified = false;
+  this->Internal->IndexLock.Unlock();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::SaveCacheIndex ( )
+{
+  if ( this->RemoteCacheDirectory.empty() )
+    {
+    return 0;
+    }
+  this->Internal->IndexLock.Lock();
+  if ( !this->Internal->CacheIndexModified )
+    {
+    this->Internal->IndexLock.Unlock();
+    return 1;
+    }
+  std::string indexFileName = this->RemoteCacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  std::ofstream indexFile ( indexFileName.c_str() );
+  if ( !indexFile.is_open() )
+    {
+    this->Internal->IndexLock.Unlock();
+    vtkWarningMacro ( "SaveCacheIndex: unable to write cache index file " << indexFileName );
+    return 0;
+    }
+  indexFile.precision ( 15 );
+  indexFile << "# vtkCacheManager index 1" << std::endl;
+  //--- paths are stored relative to the cache directory so that it can be moved
+  std::string cacheDirectory = vtksys::SystemTools::CollapseFullPath ( this->RemoteCacheDirectory.c_str() ) + "/";
+  for (vtkInternal::CacheIndexType::iterator it = this->Internal->CacheIndex.begin();
+       it != this->Internal->CacheIndex.end(); ++it)
+    {
+    if ( it->first.compare ( 0, cacheDirectory.size(), cacheDirectory ) != 0 )
+      {
+      continue;
+      }
+    indexFile << it->second.Size << "\t" << it->second.LastAccessTime << "\t"
+              << it->first.substr ( cacheDirectory.size() ) << "\t"
+              << it->second.URI << "\n";
+    }
+  this->Internal->CacheIndexModified = false;
+  this->Internal->IndexLock.Unlock();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::EvictLeastRecentlyUsedFiles ( )
+{
+  double budget = ( static_cast<double>(this->RemoteCacheLimit) - this->RemoteCacheFreeBufferSize ) * MB;
+  std::vector<std::string> evictedFiles;
+  this->Internal->IndexLock.Lock();
+  if ( this->Internal->CacheIndexSize >= budget )
+    {
+    std::vector< std::pair<double, std::string> > filesByAccessTime;
+    filesByAccessTime.reserve ( this->Internal->CacheIndex.size() );
+    for (vtkInternal::CacheIndexType::iterator it = this->Internal->CacheIndex.begin();
+         it != this->Internal->CacheIndex.end(); ++it)
+      {
+      filesByAccessTime.push_back ( std::make_pair ( it->second.LastAccessTime, it->first ) );
+      }
+    std::sort ( filesByAccessTime.begin(), filesByAccessTime.end() );
+    for (std::vector< std::pair<double, std::string> >::iterator it = filesByAccessTime.begin();
+         it != filesByAccessTime.end() && this->Internal->CacheIndexSize >= budget; ++it)
+      {
+      this->Internal->RemoveFiles ( it->second );
+      evictedFiles.push_back ( it->second );
+      }
+    }
+  this->CurrentCacheSize = static_cast<float>(this->Internal->CacheIndexSize / MB);
+  this->Internal->IndexLock.Unlock();
+
+  if ( evictedFiles.empty() )
+    {
+    return 0;
+    }
+  vtkDebugMacro ( "EvictLeastRecentlyUsedFiles: evicting " << evictedFiles.size() << " files from the cache." );
+  if ( this->MRMLScene )
+    {
+    for (std::vector<std::string>::iterator it = evictedFiles.begin(); it != evictedFiles.end(); ++it)
+      {
+      this->MarkNodesBeforeDeletingDataFromCache ( it->c_str() );
+      }
+    }
+  //--- The files are moved out of their cache path before returning, a file
+  //--- downloaded again or reused at the same path is not deleted by the thread.
+  std::vector<std::string> trashFiles;
+  std::string cacheDirectory = vtksys::SystemTools::CollapseFullPath ( this->RemoteCacheDirectory.c_str() );
+  for (std::vector<std::string>::iterator it = evictedFiles.begin(); it != evictedFiles.end(); ++it)
+    {
+    std::string trashFile = this->Internal->MoveToTrash ( cacheDirectory, *it );
+    if ( !trashFile.empty() )
+      {
+      trashFiles.push_back ( trashFile );
+      }
+    else if ( vtksys::SystemTools::FileIsDirectory ( it->c_str() ) )
+      {
+      vtksys::SystemTools::RemoveADirectory ( it->c_str() );
+      }
+    else
+      {
+      vtksys::SystemTools::RemoveFile ( it->c_str() );
+      }
+    }
+  this->Internal->QueueDeletion ( trashFiles );
+  this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
+  return static_cast<int>(evictedFiles.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::WaitForEviction ( )
+{
+  this->Internal->WaitForDeletion();
+}
+
 
 
 
@@ -558,14 +1055,23 @@ void vtkCacheManager::DeleteFromCache( const char *target )
 
   //--- discover if target already has Remote Cache Directory prepended to path.
   //--- if not, put it there.
-
-  if (this->FindCachedFile( target, this->GetRemoteCacheDirectory() ) == NULL)
+  //--- Indexed files are found without scanning the cache directory.
+  std::string str = vtkInternal::GetCachedFilePath( this->RemoteCacheDirectory, target );
+  this->Internal->IndexLock.Lock();
+  bool indexed = (!str.empty() && this->Internal->CacheIndex.count ( str ) > 0);
+  this->Internal->IndexLock.Unlock();
+  if ( !indexed )
     {
-    vtkDebugMacro("RemoveFromCache: can't find the target file " << target << ", so there's nothing to do, returning.");
-    return;
+    const char* foundFile = this->FindCachedFile( target, this->GetRemoteCacheDirectory() );
+    if (foundFile == NULL)
+      {
+      vtkDebugMacro("RemoveFromCache: can't find the target file " << target << ", so there's nothing to do, returning.");
+      return;
+      }
+    str = foundFile;
+    delete [] foundFile;
     }
 
-  std::string str = this->FindCachedFile( target, this->GetRemoteCacheDirectory() );
   if ( str.c_str() != NULL )
     {
     this->MarkNodesBeforeDeletingDataFromCache ( target );
@@ -580,6 +1086,9 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
+        this->Internal->IndexLock.Lock();
+        this->Internal->RemoveFiles ( vtksys::SystemTools::CollapseFullPath ( str.c_str() ) );
+        this->Internal->IndexLock.Unlock();
         this->UpdateCacheInformation ( );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
@@ -592,6 +1101,9 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
+        this->Internal->IndexLock.Lock();
+        this->Internal->RemoveFiles ( vtksys::SystemTools::CollapseFullPath ( str.c_str() ) );
+        this->Internal->IndexLock.Unlock();
         this->UpdateCacheInformation ( );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
@@ -638,11 +1150,18 @@ int vtkCacheManager::ClearCache()
   //--- directory and all of its contents...
   //--- Removes the CacheDirectory all together
   //--- and then creates the directory again.
+  //--- pending evictions would race with the removal of the directory
+  this->WaitForEviction();
   if ( this->RemoteCacheDirectory.c_str() != NULL )
     {
     this->MarkNodesBeforeDeletingDataFromCache ( this->RemoteCacheDirectory.c_str() );
     vtksys::SystemTools::RemoveADirectory ( this->RemoteCacheDirectory.c_str() );
     }
+  this->Internal->IndexLock.Lock();
+  this->Internal->CacheIndex.clear();
+  this->Internal->CacheIndexSize = 0.;
+  this->Internal->CacheIndexModified = true;
+  this->Internal->IndexLock.Unlock();
   if ( vtksys::SystemTools::MakeDirectory ( this->RemoteCacheDirectory.c_str() ) == false )
     {
     vtkWarningMacro ( "Cache cleared: Error: unable to recreate cache directory after deleting its contents." );
@@ -658,11 +1177,14 @@ int vtkCacheManager::ClearCache()
 //----------------------------------------------------------------------------
 float vtkCacheManager::GetCurrentCacheSize ()
 {
-  if ( this->RemoteCacheDirectory.c_str() == NULL )
+  if ( this->RemoteCacheDirectory.empty() )
     {
     return (0.0);
     }
-  float size = this->ComputeCacheSize ( this->RemoteCacheDirectory.c_str(), 0 );
+  //--- the index is kept up-to-date, no need to scan the cache directory
+  this->Internal->IndexLock.Lock();
+  float size = static_cast<float>(this->Internal->CacheIndexSize / MB);
+  this->Internal->IndexLock.Unlock();
   this->SetCurrentCacheSize ( size );
   return ( this->CurrentCacheSize );
 
@@ -676,6 +1198,10 @@ void vtkCacheManager::MarkNode ( std::string str )
   //--- If such a node exists, mark it as modified since read,
   //--- so that a user will be prompted to save the
   //--- data elsewhere (since it'll be deleted from cache.)
+  if ( this->MRMLScene == NULL )
+    {
+    return;
+    }
   int nnodes = this->MRMLScene->GetNumberOfNodesByClass ( "vtkMRMLStorableNode" );
   vtkMRMLStorableNode *node;
   std::string uri;
@@ -793,6 +1319,11 @@ float vtkCacheManager::ComputeCacheSize( const char *dirName, unsigned long sz )
         {
         //--- test to see if the file is a directory;
         //--- if so, go inside and count up file sizes, return value
+        //--- (evicted files are not counted)
+        if ( !strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)), vtkCacheManager::GetCacheTrashDirectoryName()) )
+          {
+          continue;
+          }
         subdirString = dirName;
         subdirString += "/";
         subdirString += dir.GetFile  (static_cast<unsigned long>(fileNum));
@@ -830,10 +1361,13 @@ float vtkCacheManager::ComputeCacheSize( const char *dirName, unsigned long sz )
 void vtkCacheManager::CacheSizeCheck()
 {
 
-  //--- Compute size of the current cache
-  this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
-  //--- Invoke an event if cache size is exceeded.
-  if ( this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
+  //--- Evict old files if cache size is exceeded.
+  if ( this->AutomaticEviction && this->GetCurrentCacheSize() > (float) (this->RemoteCacheLimit) )
+    {
+    this->EvictLeastRecentlyUsedFiles();
+    }
+  //--- Invoke an event if cache size is still exceeded.
+  if ( this->GetCurrentCacheSize() > (float) (this->RemoteCacheLimit) )
     {
     // remove the file just downloaded?
      this->InvokeEvent ( vtkCacheManager::CacheLimitExceededEvent );
@@ -844,7 +1378,7 @@ void vtkCacheManager::CacheSizeCheck()
 float vtkCacheManager::GetFreeCacheSpaceRemaining()
 {
 
-  float cachesize = this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  float cachesize = this->GetCurrentCacheSize();
   // cache limit - current cache size = total space left in cache.
   // total space in cache - free buffer size = amount that can be used.
   float diff = ( float (this->RemoteCacheLimit) - cachesize );
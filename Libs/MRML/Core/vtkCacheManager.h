@@ -43,7 +43,57 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
 
   ///
   /// Called when a file is loaded or removed from the cache.
+  /// Refreshes the list of cached files from the cache index (the cache
+  /// directory is not scanned), saves the index if it has been modified and,
+  /// if AutomaticEviction is enabled, evicts least recently used files
+  /// when the cache is over its limit.
   void UpdateCacheInformation ( );
+
+  ///
+  /// Record a file that has been downloaded or written to the cache in
+  /// the cache index. The file size is read from disk once, after that
+  /// cache size queries only use the index.
+  /// Can be called from any thread.
+  void AddCachedFile ( const char *filename, const char *uri=NULL );
+  ///
+  /// Update the last access time of a cached file, used for choosing
+  /// the files to evict. Can be called from any thread.
+  void TouchCachedFile ( const char *filename );
+  ///
+  /// Scan the cache directory and rebuild the cache index.
+  /// Only needed if files are added to the cache directory
+  /// without using the cache manager.
+  void RebuildCacheIndex ( );
+  ///
+  /// Write the cache index to the cache directory so that the
+  /// directory does not need to be scanned at next startup.
+  /// Returns 0 on failure.
+  int SaveCacheIndex ( );
+  ///
+  /// Name of the cache index file in the remote cache directory.
+  static const char* GetCacheIndexFileName ( );
+  ///
+  /// Name of the directory of the cache where evicted files are moved
+  /// until they are deleted.
+  static const char* GetCacheTrashDirectoryName ( );
+
+  ///
+  /// Remove least recently used files until the cache size is below
+  /// the cache limit minus the free buffer size. Files are removed from
+  /// the cache index and moved to the trash directory of the cache
+  /// immediately, they are deleted from disk in a background thread.
+  /// Returns the number of evicted files.
+  int EvictLeastRecentlyUsedFiles ( );
+  ///
+  /// Block until the files queued for deletion by
+  /// EvictLeastRecentlyUsedFiles are deleted from disk.
+  void WaitForEviction ( );
+  ///
+  /// If enabled (default), least recently used files are evicted when the
+  /// cache is over its limit, instead of only invoking CacheLimitExceededEvent.
+  vtkGetMacro ( AutomaticEviction, int );
+  vtkSetMacro ( AutomaticEviction, int );
+  vtkBooleanMacro ( AutomaticEviction, int );
   ///
   /// Removes a target from the list of locally cached files and directories
   void DeleteFromCachedFileList ( const char * target );
@@ -110,7 +160,12 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
 
   void CacheSizeCheck();
   void FreeCacheBufferCheck();
+  ///
+  /// Walk the directory and compute the size of all files (in MB).
+  /// This is slow for large caches, use GetCurrentCacheSize instead.
   float ComputeCacheSize( const char *dirname, unsigned long size );
+  ///
+  /// Size of the cache in MB, computed from the cache index.
   float GetCurrentCacheSize();
   float GetFreeCacheSpaceRemaining();
 
@@ -160,11 +215,15 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   float CurrentCacheSize;
   int RemoteCacheFreeBufferSize;
   int EnableForceRedownload;
+  int AutomaticEviction;
   //int EnableRemoteCacheOverwriting;
   vtkMRMLScene *MRMLScene;
 
   std::string RemoteCacheDirectory;
+  /// Scan the directory, add files to CachedFileList and to the cache index.
   int GetCachedFileList(const char *dirname);
+  /// Read the cache index file, returns 0 if it does not exist or is invalid.
+  int LoadCacheIndex();
   std::vector< std::string > GetAllCachedFiles();
   /// This array contains a list of cached file names (without paths)
   /// in case it's faster to search thru this list than to
@@ -182,6 +241,9 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   /// Holder for callback
   vtkCallbackCommand *CallbackCommand;
 
+  class vtkInternal;
+  vtkInternal* Internal;
+
 };
 
 #endif
@@ -46,6 +46,13 @@ class VTK_MRML_EXPORT vtkDataTransfer : public vtkObject
       this->TransferStatus = val;
       }
 
+  /// Update the progress without invoking a ModifiedEvent, so that it can be
+  /// called from the thread running the transfer.
+  void SetProgressNoModify ( int val)
+      {
+      this->Progress = val;
+      }
+
   const char* GetTransferStatusString( ) {
     switch (this->TransferStatus)
       {
@@ -14,6 +14,7 @@
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLProfiler.h"
 #include "vtkObservation.h"
 
 // VTK includes
@@ -22,6 +23,10 @@
 #include <vtkObjectFactory.h>
 #include <vtkTimerLog.h>
 
+// STD includes
+#include <algorithm>
+#include <vector>
+
 vtkCxxSetObjectMacro(vtkEventBroker, TimerLog, vtkTimerLog);
 
 //----------------------------------------------------------------------------
@@ -95,6 +100,9 @@ vtkEventBroker::vtkEventBroker()
   this->EventNestingLevel = 0;
   this->TimerLog = vtkTimerLog::New();
   this->CompressCallData = 0;
+  this->NumberOfCancelledQueuedObservations = 0;
+  this->CoalescingLevel = 0;
+  this->CollectEventStatistics = 0;
   this->LogFileName = NULL;
   this->ScriptHandler = NULL;
   this->ScriptHandlerClientData = NULL;
@@ -123,6 +131,12 @@ vtkEventBroker::~vtkEventBroker()
 //----------------------------------------------------------------------------
 void vtkEventBroker::DetachObservations()
 {
+  // release the references held by the event queue
+  while (!this->EventQueue.empty())
+    {
+    this->PopEventQueue();
+    }
+
   // for each subject, remove observations in its list
   ObjectToObservationVectorMap::iterator mapiter;
   ObservationVector::iterator oiter;
@@ -304,30 +318,33 @@ void vtkEventBroker::RemoveObservations (ObservationVector observations)
     }
 
   // remove from event queue
-  std::deque< vtkObservation *>::iterator queueIter;
-  for(queueIter=this->EventQueue.begin(); queueIter != this->EventQueue.end();)
-    {
-    // foreach of the broker's observations see if it is in the list of items to be removed
-    if (observations.find(*queueIter)!=observations.end())
-      {
-      // these event is related to the observations to be deleted
-      queueIter=this->EventQueue.erase(queueIter);
-      }
-    else
-      {
-      ++queueIter;
-      }
-    }
+  this->CancelQueuedObservations(observations);
 
   // detach and delete each of the observations
   for(ObservationVector::iterator removeIter=observations.begin(); removeIter != observations.end(); removeIter++)
     {
-    (*removeIter)->SetInEventQueue( 0 );
     this->DetachObservation( *removeIter );
     (*removeIter)->Delete();
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::CancelQueuedObservations(const ObservationVector& observations)
+{
+  // Searching the queue would be linear in its size, instead the observations
+  // are flagged as no longer queued and skipped when the queue is processed.
+  // The queue holds a reference so that they are not deleted until then.
+  for(ObservationVector::const_iterator obsIter=observations.begin(); obsIter != observations.end(); ++obsIter)
+    {
+    if ( (*obsIter)->GetInEventQueue() )
+      {
+      (*obsIter)->SetInEventQueue( 0 );
+      (*obsIter)->GetCallDataList()->clear();
+      this->NumberOfCancelledQueuedObservations++;
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (vtkObject *observer)
 {
@@ -681,11 +698,13 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
   //
   if ( eid == observation->GetEvent() || observation->GetEvent() == vtkCommand::AnyEvent )
     {
-    if ( this->EventMode == vtkEventBroker::Synchronous || eid == vtkCommand::DeleteEvent )
+    if ( (this->EventMode == vtkEventBroker::Synchronous && this->CoalescingLevel == 0)
+         || eid == vtkCommand::DeleteEvent )
       {
       this->InvokeObservation( observation, eid, callData );
       }
-    else if ( this->EventMode == vtkEventBroker::Asynchronous )
+    else if ( this->EventMode == vtkEventBroker::Asynchronous
+              || this->EventMode == vtkEventBroker::Synchronous )
       {
       this->QueueObservation( observation, eid, callData );
       }
@@ -751,9 +770,11 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
   // If the event is not currently in the queue, add it and keep a flag.
   //
   vtkObservation::CallType call(eid, callData);
+  bool coalesced = false;
   if ( this->GetCompressCallData() &&
        observation->GetEvent() != vtkCommand::AnyEvent)
     {
+    coalesced = !observation->GetCallDataList()->empty();
     observation->GetCallDataList()->clear();
     observation->GetCallDataList()->push_back( call );
     }
@@ -772,10 +793,20 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
       {
       observation->GetCallDataList()->push_back( call );
       }
+    else
+      {
+      coalesced = true;
+      }
+    }
+  if ( coalesced && this->CollectEventStatistics )
+    {
+    this->EventStatistics[eid].CoalescedCount++;
     }
 
   if ( !observation->GetInEventQueue() )
     {
+    // the queue keeps a reference, released by DequeueObservation
+    observation->Register( this );
     this->EventQueue.push_back( observation );
     observation->SetInEventQueue(1);
     }
@@ -784,7 +815,7 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
 //----------------------------------------------------------------------------
 int vtkEventBroker::GetNumberOfQueuedObservations ()
 {
-  return static_cast<int>( this->EventQueue.size() );
+  return static_cast<int>( this->EventQueue.size() ) - this->NumberOfCancelledQueuedObservations;
 }
 
 //----------------------------------------------------------------------------
@@ -794,15 +825,52 @@ vtkObservation *vtkEventBroker::GetNthQueuedObservation ( int n )
     {
     return NULL;
     }
-  return (this->EventQueue[n]);
+  if ( this->NumberOfCancelledQueuedObservations == 0 )
+    {
+    return (this->EventQueue[n]);
+    }
+  // skip the cancelled observations
+  std::deque< vtkObservation * >::const_iterator queueIter;
+  for (queueIter = this->EventQueue.begin(); queueIter != this->EventQueue.end(); ++queueIter)
+    {
+    if ( (*queueIter)->GetInEventQueue() && n-- == 0 )
+      {
+      return *queueIter;
+      }
+    }
+  return NULL;
 }
 
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::DequeueObservation ()
+{
+  // cancelled observations are removed first, they are not returned
+  while ( !this->EventQueue.empty() && !this->EventQueue.front()->GetInEventQueue() )
+    {
+    this->PopEventQueue();
+    }
+  if ( this->EventQueue.empty() )
+    {
+    return NULL;
+    }
+  return this->PopEventQueue();
+}
+
+//----------------------------------------------------------------------------
+vtkObservation *vtkEventBroker::PopEventQueue ()
 {
   vtkObservation *observation = this->EventQueue.front();
   this->EventQueue.pop_front();
-  observation->SetInEventQueue(0);
+  if ( observation->GetInEventQueue() )
+    {
+    observation->SetInEventQueue(0);
+    }
+  else
+    {
+    this->NumberOfCancelledQueuedObservations--;
+    }
+  // release the reference of the queue, the observation may be deleted
+  observation->UnRegister( this );
   return( observation );
 }
 
@@ -812,6 +880,10 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
 {
   this->EventNestingLevel++;
 
+  vtkMRMLProfileScopeMacro("vtkEventBroker",
+    observation->GetObserver() ? observation->GetObserver()->GetClassName()
+                               : observation->GetSubject()->GetClassName(), eid);
+
   double startTime = this->TimerLog->GetUniversalTime();
 
   // Register so observation won't be deleted while callback is running
@@ -842,6 +914,13 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
   observation->SetTotalElapsedTime (observation->GetTotalElapsedTime() + elapsedTime);
   observation->SetLastElapsedTime (elapsedTime);
   this->LogEvent (observation);
+  if ( this->CollectEventStatistics )
+    {
+    EventStatisticsType& statistics = this->EventStatistics[eid];
+    statistics.InvocationCount++;
+    statistics.TotalElapsedTime += elapsedTime;
+    statistics.MaximumElapsedTime = std::max(statistics.MaximumElapsedTime, elapsedTime);
+    }
 
   // clear reference to observation (may cause delete)
   observation->Delete();
@@ -858,10 +937,18 @@ void vtkEventBroker::ProcessEventQueue ()
   //   gets deleted during handling of the event
   // - if the observation is no longer in the queue, stop processing events
   // - unregister before after dequeing in case the observation should go away
+  // - skip the observations that were cancelled while queued
+  // - pop the cancelled observations at the end of the queue too, the queue
+  //   keeps them alive
   //
-  while ( this->GetNumberOfQueuedObservations() > 0 )
+  while ( !this->EventQueue.empty() )
     {
     vtkObservation *observation = this->EventQueue.front();
+    if ( !observation->GetInEventQueue() )
+      {
+      this->PopEventQueue();
+      continue;
+      }
     observation->Register( this );
     int finished = 0;
     while ( !finished )
@@ -877,11 +964,125 @@ void vtkEventBroker::ProcessEventQueue ()
         break;
         }
       }
-    this->DequeueObservation();
+    this->PopEventQueue();
     observation->Delete();
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::StartCoalescing()
+{
+  this->CoalescingLevel++;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::EndCoalescing()
+{
+  if ( this->CoalescingLevel <= 0 )
+    {
+    vtkErrorMacro("EndCoalescing: no matching StartCoalescing");
+    return;
+    }
+  this->CoalescingLevel--;
+  if ( this->CoalescingLevel == 0 && this->EventMode == vtkEventBroker::Synchronous )
+    {
+    this->ProcessEventQueue();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkEventBroker::EventStatisticsType::EventStatisticsType()
+  : InvocationCount(0)
+  , CoalescedCount(0)
+  , TotalElapsedTime(0.)
+  , MaximumElapsedTime(0.)
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::ResetEventStatistics()
+{
+  this->EventStatistics.clear();
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetNumberOfEventStatistics()
+{
+  return static_cast<int>( this->EventStatistics.size() );
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkEventBroker::GetNthEventStatisticsEventId(int n)
+{
+  if ( n < 0 || n >= this->GetNumberOfEventStatistics() )
+    {
+    vtkErrorMacro("GetNthEventStatisticsEventId: index " << n << " out of range");
+    return vtkCommand::NoEvent;
+    }
+  EventStatisticsMapType::const_iterator it = this->EventStatistics.begin();
+  std::advance(it, n);
+  return it->first;
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetEventInvocationCount(unsigned long eid)
+{
+  EventStatisticsMapType::const_iterator it = this->EventStatistics.find(eid);
+  return it != this->EventStatistics.end() ? it->second.InvocationCount : 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetEventCoalescedCount(unsigned long eid)
+{
+  EventStatisticsMapType::const_iterator it = this->EventStatistics.find(eid);
+  return it != this->EventStatistics.end() ? it->second.CoalescedCount : 0;
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetEventTotalElapsedTime(unsigned long eid)
+{
+  EventStatisticsMapType::const_iterator it = this->EventStatistics.find(eid);
+  return it != this->EventStatistics.end() ? it->second.TotalElapsedTime : 0.;
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetEventMaximumElapsedTime(unsigned long eid)
+{
+  EventStatisticsMapType::const_iterator it = this->EventStatistics.find(eid);
+  return it != this->EventStatistics.end() ? it->second.MaximumElapsedTime : 0.;
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+bool compareTotalElapsedTime(const std::pair<double, unsigned long>& a,
+                             const std::pair<double, unsigned long>& b)
+{
+  return a.first > b.first;
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::PrintEventStatistics(ostream& os)
+{
+  std::vector< std::pair<double, unsigned long> > events;
+  EventStatisticsMapType::const_iterator it;
+  for (it = this->EventStatistics.begin(); it != this->EventStatistics.end(); ++it)
+    {
+    events.push_back(std::make_pair(it->second.TotalElapsedTime, it->first));
+    }
+  std::sort(events.begin(), events.end(), compareTotalElapsedTime);
+  for (size_t i = 0; i < events.size(); ++i)
+    {
+    const EventStatisticsType& statistics = this->EventStatistics[events[i].second];
+    os << vtkCommand::GetStringFromEventId(events[i].second)
+       << " (" << events[i].second << "): " << statistics.InvocationCount << " invocations"
+       << ", " << statistics.CoalescedCount << " coalesced"
+       << ", " << statistics.TotalElapsedTime << "s total"
+       << ", " << statistics.MaximumElapsedTime << "s max\n";
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -892,6 +1093,14 @@ void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "EventMode: " << this->GetEventModeAsString() << "\n";
   os << indent << "EventLogging: " << this->EventLogging << "\n";
   os << indent << "EventNestingLevel: " << this->EventNestingLevel << "\n";
+  os << indent << "CompressCallData: " << this->CompressCallData << "\n";
+  os << indent << "CoalescingLevel: " << this->CoalescingLevel << "\n";
+  os << indent << "CollectEventStatistics: " << this->CollectEventStatistics << "\n";
+  if ( !this->EventStatistics.empty() )
+    {
+    os << indent << "EventStatistics:\n";
+    this->PrintEventStatistics(os);
+    }
   os << indent << "LogFileName: " <<
     (this->LogFileName ? this->LogFileName : "(none)") << "\n";
 }
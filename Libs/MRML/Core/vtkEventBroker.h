@@ -203,6 +203,45 @@ public:
   }
 
 
+  /// Event coalescing
+  ///
+  /// Between StartCoalescing() and the matching EndCoalescing(), events are
+  /// queued as in asynchronous mode instead of being invoked. An observation
+  /// triggered several times is queued once: it is invoked once per event
+  /// with the most recent call data if CompressCallData is on, otherwise
+  /// once per unique call data. The queue is processed by the outermost
+  /// EndCoalescing() call in synchronous mode. Delete events are always
+  /// invoked immediately. Calls can be nested. As for asynchronous mode, the
+  /// call data pointers must stay valid until the events are invoked.
+  /// \sa GetCoalescing(), ProcessEventQueue()
+  void StartCoalescing();
+  void EndCoalescing();
+  /// Return true if events are being coalesced
+  bool GetCoalescing() {return this->CoalescingLevel > 0;};
+
+  /// Event statistics
+  ///
+  /// When CollectEventStatistics is on, the number of invocations and the
+  /// time spent in the callbacks are accumulated per event id, along with the
+  /// number of events that were merged into an already queued observation.
+  /// The time of an invocation includes the time of the nested invocations.
+  /// Useful to find the events that are invoked the most often. Off by default.
+  vtkBooleanMacro (CollectEventStatistics, int);
+  vtkSetMacro (CollectEventStatistics, int);
+  vtkGetMacro (CollectEventStatistics, int);
+  /// Clear the statistics collected so far
+  void ResetEventStatistics();
+  /// Number of event ids with statistics, and the Nth of these event ids
+  int GetNumberOfEventStatistics();
+  unsigned long GetNthEventStatisticsEventId(int n);
+  /// Statistics of an event id, 0 if the event has not been invoked or queued
+  int GetEventInvocationCount(unsigned long eid);
+  int GetEventCoalescedCount(unsigned long eid);
+  double GetEventTotalElapsedTime(unsigned long eid);
+  double GetEventMaximumElapsedTime(unsigned long eid);
+  /// Print the statistics, one line per event id sorted by total elapsed time
+  void PrintEventStatistics(ostream& os);
+
   /// Event queue processing
 
   ///
@@ -213,6 +252,9 @@ public:
   /// the callData field of the event back)
   /// TODO: if the callData is needed, we will need another class/struct to
   /// go into the event queue that saves them
+  /// - observations that are removed while queued are not invoked, they are
+  /// not counted by GetNumberOfQueuedObservations(). The queue keeps a
+  /// reference on the observations, DequeueObservation() releases it.
   void QueueObservation (vtkObservation *observation, unsigned long eid,
                          void *callData);
   int GetNumberOfQueuedObservations ();
@@ -272,8 +314,31 @@ protected:
   ObjectToObservationVectorMap SubjectMap;
   ObjectToObservationVectorMap ObserverMap;
 
-  /// The event queue of triggered but not-yet-invoked observations
+  /// The event queue of triggered but not-yet-invoked observations.
+  /// Removed observations are cancelled in constant time by resetting their
+  /// InEventQueue flag, they stay in the queue until it is processed.
   std::deque< vtkObservation * > EventQueue;
+  int NumberOfCancelledQueuedObservations;
+
+  int CoalescingLevel;
+
+  struct EventStatisticsType
+  {
+    EventStatisticsType();
+    int InvocationCount;
+    int CoalescedCount;
+    double TotalElapsedTime;
+    double MaximumElapsedTime;
+  };
+  typedef std::map< unsigned long, EventStatisticsType > EventStatisticsMapType;
+  EventStatisticsMapType EventStatistics;
+  int CollectEventStatistics;
+
+  /// Remove the observations from the event queue, in constant time
+  void CancelQueuedObservations(const ObservationVector& observations);
+  /// Remove the front of the event queue, cancelled or not, and release the
+  /// reference of the queue on it
+  vtkObservation *PopEventQueue();
 
   void (*ScriptHandler) (const char* script, void* clientData);
   void *ScriptHandlerClientData;
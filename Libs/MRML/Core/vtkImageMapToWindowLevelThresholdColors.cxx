@@ -0,0 +1,349 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkDataArray.h>
+#include <vtkExecutive.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkImageStencilIterator.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+
+// STD includes
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageMapToWindowLevelThresholdColors);
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkImageMapToWindowLevelThresholdColors, LookupTable, vtkScalarsToColors);
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetNumberOfInputPorts(2);
+  this->Window = 255.;
+  this->Level = 127.5;
+  this->LookupTable = NULL;
+  this->ApplyThreshold = 0;
+  this->LowerThreshold = VTK_SHORT_MIN;
+  this->UpperThreshold = VTK_SHORT_MAX;
+  for (int i = 0; i < 256; ++i)
+    {
+    this->ColorTable[4 * i + 0] = static_cast<unsigned char>(i);
+    this->ColorTable[4 * i + 1] = static_cast<unsigned char>(i);
+    this->ColorTable[4 * i + 2] = static_cast<unsigned char>(i);
+    this->ColorTable[4 * i + 3] = 255;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::~vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetLookupTable(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::ThresholdBetween(double lower, double upper)
+{
+  if (this->LowerThreshold == lower && this->UpperThreshold == upper)
+    {
+    return;
+    }
+  this->LowerThreshold = lower;
+  this->UpperThreshold = upper;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::SetStencilConnection(vtkAlgorithmOutput* outputPort)
+{
+  this->SetInputConnection(1, outputPort);
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput* vtkImageMapToWindowLevelThresholdColors::GetStencilConnection()
+{
+  return this->GetNumberOfInputConnections(1) ? this->GetInputConnection(1, 0) : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::SetStencilData(vtkImageStencilData* stencil)
+{
+  this->SetInputData(1, stencil);
+}
+
+//----------------------------------------------------------------------------
+vtkImageStencilData* vtkImageMapToWindowLevelThresholdColors::GetStencil()
+{
+  if (this->GetNumberOfInputConnections(1) < 1)
+    {
+    return NULL;
+    }
+  return vtkImageStencilData::SafeDownCast(this->GetExecutive()->GetInputData(1, 0));
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageMapToWindowLevelThresholdColors::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->LookupTable && this->LookupTable->GetMTime() > mTime)
+    {
+    mTime = this->LookupTable->GetMTime();
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (port == 1)
+    {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageStencilData");
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+    return 1;
+    }
+  return this->Superclass::FillInputPortInformation(port, info);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestInformation(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector),
+  vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestData(
+  vtkInformation* request,
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  // The table is shared by all the threads, fill it once before splitting.
+  this->UpdateColorTable();
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::UpdateColorTable()
+{
+  if (!this->LookupTable)
+    {
+    for (int i = 0; i < 256; ++i)
+      {
+      this->ColorTable[4 * i + 0] = static_cast<unsigned char>(i);
+      this->ColorTable[4 * i + 1] = static_cast<unsigned char>(i);
+      this->ColorTable[4 * i + 2] = static_cast<unsigned char>(i);
+      this->ColorTable[4 * i + 3] = 255;
+      }
+    return;
+    }
+  // Map the 256 possible luminance values the same way vtkImageMapToColors
+  // maps every voxel of the luminance image.
+  unsigned char luminances[256];
+  for (int i = 0; i < 256; ++i)
+    {
+    luminances[i] = static_cast<unsigned char>(i);
+    }
+  this->LookupTable->Build();
+  this->LookupTable->MapScalarsThroughTable2(
+    luminances, this->ColorTable, VTK_UNSIGNED_CHAR, 256, 1, VTK_RGBA);
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Same clamping as vtkImageMapToWindowLevelColors: values outside of the
+// window are mapped to lowerValue/upperValue without overflowing T.
+template <class T>
+void vtkImageMapToWindowLevelThresholdColorsClamps(
+  vtkImageData* data, double window, double level,
+  T& lower, T& upper, unsigned char& lowerValue, unsigned char& upperValue)
+{
+  double range[2];
+  data->GetPointData()->GetScalars()->GetDataTypeRange(range);
+
+  double fLower = level - fabs(window) / 2.0;
+  double fUpper = fLower + fabs(window);
+  double adjustedLower;
+  double adjustedUpper;
+
+  if (fLower <= range[1])
+    {
+    adjustedLower = (fLower >= range[0] ? fLower : range[0]);
+    }
+  else
+    {
+    adjustedLower = range[1];
+    }
+  lower = static_cast<T>(adjustedLower);
+
+  if (fUpper >= range[0])
+    {
+    adjustedUpper = (fUpper <= range[1] ? fUpper : range[1]);
+    }
+  else
+    {
+    adjustedUpper = range[0];
+    }
+  upper = static_cast<T>(adjustedUpper);
+
+  double fLowerValue = 255.0 * (adjustedLower - fLower) / window;
+  double fUpperValue = 255.0 * (adjustedUpper - fLower) / window;
+  if (window < 0)
+    {
+    fLowerValue += 255.0;
+    fUpperValue += 255.0;
+    }
+  lowerValue = static_cast<unsigned char>(
+    fLowerValue > 255 ? 255 : (fLowerValue < 0 ? 0 : fLowerValue));
+  upperValue = static_cast<unsigned char>(
+    fUpperValue > 255 ? 255 : (fUpperValue < 0 ? 0 : fUpperValue));
+}
+
+//----------------------------------------------------------------------------
+// Same clamping as vtkImageThreshold.
+template <class T>
+T vtkImageMapToWindowLevelThresholdColorsClampThreshold(vtkImageData* data, double threshold)
+{
+  if (threshold < data->GetScalarTypeMin())
+    {
+    return static_cast<T>(data->GetScalarTypeMin());
+    }
+  if (threshold > data->GetScalarTypeMax())
+    {
+    return static_cast<T>(data->GetScalarTypeMax());
+    }
+  return static_cast<T>(threshold);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageMapToWindowLevelThresholdColorsExecute(
+  vtkImageMapToWindowLevelThresholdColors* self,
+  vtkImageData* inData, vtkImageData* outData, vtkImageStencilData* stencil,
+  int outExt[6], int threadId, T*)
+{
+  const double window = self->GetWindow();
+  const double shift = window / 2.0 - self->GetLevel();
+  const double scale = 255.0 / window;
+  T lower;
+  T upper;
+  unsigned char lowerValue;
+  unsigned char upperValue;
+  vtkImageMapToWindowLevelThresholdColorsClamps(
+    inData, window, self->GetLevel(), lower, upper, lowerValue, upperValue);
+
+  const bool applyThreshold = (self->GetApplyThreshold() != 0);
+  const T lowerThreshold =
+    vtkImageMapToWindowLevelThresholdColorsClampThreshold<T>(inData, self->GetLowerThreshold());
+  const T upperThreshold =
+    vtkImageMapToWindowLevelThresholdColorsClampThreshold<T>(inData, self->GetUpperThreshold());
+
+  const unsigned char* colorTable = self->GetColorTable();
+  const int numberOfComponents = inData->GetNumberOfScalarComponents();
+
+  // Both iterators walk the same spans, only the output reports progress.
+  vtkImageStencilIterator<T> inIter(inData, stencil, outExt);
+  vtkImageStencilIterator<unsigned char> outIter(outData, stencil, outExt, self, threadId);
+  while (!outIter.IsAtEnd())
+    {
+    const T* inPtr = inIter.BeginSpan();
+    unsigned char* outPtr = outIter.BeginSpan();
+    unsigned char* outEnd = outIter.EndSpan();
+    const unsigned char visibleAlpha = (outIter.IsInStencil() ? 255 : 0);
+    for (; outPtr != outEnd; outPtr += 4, inPtr += numberOfComponents)
+      {
+      const T value = *inPtr;
+      unsigned char luminance;
+      if (value <= lower)
+        {
+        luminance = lowerValue;
+        }
+      else if (value >= upper)
+        {
+        luminance = upperValue;
+        }
+      else
+        {
+        luminance = static_cast<unsigned char>((value + shift) * scale);
+        }
+      const unsigned char* color = colorTable + 4 * luminance;
+      outPtr[0] = color[0];
+      outPtr[1] = color[1];
+      outPtr[2] = color[2];
+      const bool visible = color[3] != 0 &&
+        (!applyThreshold || (lowerThreshold <= value && value <= upperThreshold));
+      outPtr[3] = (visible ? visibleAlpha : 0);
+      }
+    inIter.NextSpan();
+    outIter.NextSpan();
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::ThreadedRequestData(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector),
+  vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData,
+  vtkImageData** outData,
+  int outExt[6], int threadId)
+{
+  vtkImageData* input = inData[0][0];
+  if (!input || !input->GetPointData()->GetScalars())
+    {
+    return;
+    }
+  vtkImageStencilData* stencil = this->GetStencil();
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageMapToWindowLevelThresholdColorsExecute(
+        this, input, outData[0], stencil, outExt, threadId,
+        static_cast<VTK_TT*>(0)));
+    default:
+      vtkErrorMacro(<< "ThreadedRequestData: Unknown input ScalarType");
+      return;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Window: " << this->Window << "\n";
+  os << indent << "Level: " << this->Level << "\n";
+  os << indent << "LookupTable: " << this->LookupTable << "\n";
+  os << indent << "ApplyThreshold: " << this->ApplyThreshold << "\n";
+  os << indent << "LowerThreshold: " << this->LowerThreshold << "\n";
+  os << indent << "UpperThreshold: " << this->UpperThreshold << "\n";
+}
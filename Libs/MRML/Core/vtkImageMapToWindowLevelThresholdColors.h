@@ -0,0 +1,120 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkImageMapToWindowLevelThresholdColors_h
+#define __vtkImageMapToWindowLevelThresholdColors_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+class vtkAlgorithmOutput;
+class vtkImageStencilData;
+class vtkScalarsToColors;
+
+/// \brief Map a scalar image to RGBA in a single pass.
+///
+/// Computes in one pass over the input the same RGBA image as the
+/// pipeline that vtkMRMLScalarVolumeDisplayNode used to chain:
+/// vtkImageMapToWindowLevelColors (luminance) -> vtkImageMapToColors (RGBA)
+/// -> vtkImageExtractComponents (RGB and alpha) -> vtkImageStencil (alpha)
+/// -> vtkImageThreshold -> vtkImageLogic (AND) -> vtkImageAppendComponents.
+///
+/// The first component of the input is windowed into an unsigned char
+/// luminance and mapped through the lookup table. The output alpha is 255
+/// where the alpha of the lookup table is not 0, the voxel is inside the
+/// optional stencil and, if ApplyThreshold is on, the voxel is within
+/// [LowerThreshold, UpperThreshold]; it is 0 otherwise.
+/// Without a lookup table, the luminance is used for the RGB components.
+class VTK_MRML_EXPORT vtkImageMapToWindowLevelThresholdColors
+  : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageMapToWindowLevelThresholdColors *New();
+  vtkTypeMacro(vtkImageMapToWindowLevelThresholdColors, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Window and level used to map the input scalars into [0, 255].
+  /// Same as vtkImageMapToWindowLevelColors.
+  vtkSetMacro(Window, double);
+  vtkGetMacro(Window, double);
+  vtkSetMacro(Level, double);
+  vtkGetMacro(Level, double);
+
+  /// Lookup table used to map the windowed luminance into RGBA.
+  virtual void SetLookupTable(vtkScalarsToColors*);
+  vtkGetObjectMacro(LookupTable, vtkScalarsToColors);
+
+  /// If on, voxels outside of [LowerThreshold, UpperThreshold] are
+  /// transparent. Off by default.
+  vtkSetMacro(ApplyThreshold, int);
+  vtkGetMacro(ApplyThreshold, int);
+  vtkBooleanMacro(ApplyThreshold, int);
+
+  /// Inclusive range of the visible voxel values when ApplyThreshold is on.
+  void ThresholdBetween(double lower, double upper);
+  vtkGetMacro(LowerThreshold, double);
+  vtkGetMacro(UpperThreshold, double);
+
+  /// Optional stencil, voxels outside of it are transparent.
+  void SetStencilConnection(vtkAlgorithmOutput* outputPort);
+  vtkAlgorithmOutput* GetStencilConnection();
+  void SetStencilData(vtkImageStencilData* stencil);
+  vtkImageStencilData* GetStencil();
+
+  /// Take the lookup table modification time into account.
+  virtual vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+  /// Colors of the 256 luminance values, as RGBA tuples.
+  /// Internally used by the execute method, only valid during RequestData.
+  const unsigned char* GetColorTable() const { return this->ColorTable; }
+
+protected:
+  vtkImageMapToWindowLevelThresholdColors();
+  virtual ~vtkImageMapToWindowLevelThresholdColors();
+
+  virtual int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+  virtual int RequestInformation(vtkInformation* request,
+                                 vtkInformationVector** inputVector,
+                                 vtkInformationVector* outputVector) VTK_OVERRIDE;
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector) VTK_OVERRIDE;
+  virtual void ThreadedRequestData(vtkInformation* request,
+                                   vtkInformationVector** inputVector,
+                                   vtkInformationVector* outputVector,
+                                   vtkImageData*** inData,
+                                   vtkImageData** outData,
+                                   int outExt[6], int threadId) VTK_OVERRIDE;
+
+  /// Fill ColorTable from the lookup table.
+  void UpdateColorTable();
+
+  double Window;
+  double Level;
+  vtkScalarsToColors* LookupTable;
+  int ApplyThreshold;
+  double LowerThreshold;
+  double UpperThreshold;
+
+  unsigned char ColorTable[256 * 4];
+
+private:
+  vtkImageMapToWindowLevelThresholdColors(const vtkImageMapToWindowLevelThresholdColors&);
+  void operator=(const vtkImageMapToWindowLevelThresholdColors&);
+};
+
+#endif
@@ -13,6 +13,7 @@ Version:   $Revision: 1.2 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
 #include "vtkMRMLDiffusionWeightedVolumeDisplayNode.h"
 
 // VTK includes
@@ -38,6 +39,8 @@ vtkMRMLDiffusionWeightedVolumeDisplayNode::vtkMRMLDiffusionWeightedVolumeDisplay
   this->Threshold->SetInputConnection( this->ExtractComponent->GetOutputPort());
   this->MapToWindowLevelColors->SetInputConnection(
     this->ExtractComponent->GetOutputPort());
+  this->MapToWindowLevelThresholdColors->SetInputConnection(
+    this->ExtractComponent->GetOutputPort());
 }
 
 //----------------------------------------------------------------------------
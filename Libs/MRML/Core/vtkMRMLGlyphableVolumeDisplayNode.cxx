@@ -17,6 +17,7 @@ Version:   $Revision: 1.2 $
 #include "vtkMRMLScene.h"
 
 #include "vtkCallbackCommand.h"
+#include "vtkImageAppendComponents.h"
 #include "vtkObjectFactory.h"
 
 #include <sstream>
@@ -70,6 +71,12 @@ vtkMRMLGlyphableVolumeDisplayNode::~vtkMRMLGlyphableVolumeDisplayNode()
   this->SetAndObserveGlyphColorNodeID( NULL);
 }
 
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput* vtkMRMLGlyphableVolumeDisplayNode::GetOutputImageDataConnection()
+{
+  return this->AppendComponents->GetOutputPort();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLGlyphableVolumeDisplayNode::WriteXML(ostream& of, int nIndent)
 {
@@ -139,6 +139,12 @@ class VTK_MRML_EXPORT vtkMRMLGlyphableVolumeDisplayNode : public vtkMRMLScalarVo
     this->Superclass::GetDisplayScalarRange(range);
     }
 
+  ///
+  /// Gets the pipeline output. Glyphable volumes rewire the filters of the
+  /// scalar volume display pipeline, the single pass filter of
+  /// vtkMRMLScalarVolumeDisplayNode can't be used.
+  virtual vtkAlgorithmOutput* GetOutputImageDataConnection() VTK_OVERRIDE;
+
 protected:
   vtkMRMLGlyphableVolumeDisplayNode();
   ~vtkMRMLGlyphableVolumeDisplayNode();
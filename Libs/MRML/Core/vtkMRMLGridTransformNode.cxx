@@ -16,6 +16,7 @@ Version:   $Revision: 1.14 $
 #include "vtkMRMLGridTransformNode.h"
 
 // VTK includes
+#include <vtkCollection.h>
 #include <vtkOrientedGridTransform.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
@@ -30,6 +31,8 @@ vtkMRMLNodeNewMacro(vtkMRMLGridTransformNode);
 //----------------------------------------------------------------------------
 vtkMRMLGridTransformNode::vtkMRMLGridTransformNode()
 {
+  this->UseCachedInverse = false;
+
   // Set up the node with a dummy displacement field (that contains one single
   // null-vector) to make sure the node is valid and can be saved
   vtkNew<vtkImageData> emptyDisplacementField;
@@ -55,12 +58,30 @@ vtkMRMLGridTransformNode::~vtkMRMLGridTransformNode()
 void vtkMRMLGridTransformNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent);
+
+  of << " useCachedInverse=\"" << (this->UseCachedInverse ? "true" : "false") << "\"";
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLGridTransformNode::ReadXMLAttributes(const char** atts)
 {
+  int disabledModify = this->StartModify();
+
   Superclass::ReadXMLAttributes(atts);
+
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "useCachedInverse"))
+      {
+      this->SetUseCachedInverse(!strcmp(attValue, "true"));
+      }
+    }
+
+  this->EndModify(disabledModify);
 }
 
 //----------------------------------------------------------------------------
@@ -68,11 +89,71 @@ void vtkMRMLGridTransformNode::ReadXMLAttributes(const char** atts)
 // Does NOT copy: ID, FilePrefix, Name, VolumeID
 void vtkMRMLGridTransformNode::Copy(vtkMRMLNode *anode)
 {
+  vtkMRMLGridTransformNode *node = vtkMRMLGridTransformNode::SafeDownCast(anode);
+  int disabledModify = this->StartModify();
+
   Superclass::Copy(anode);
+
+  if (node)
+    {
+    this->SetUseCachedInverse(node->GetUseCachedInverse());
+    }
+  // the transforms are copied without SetAndObserveTransform
+  this->UpdateGridTransformsUseCachedInverse();
+
+  this->EndModify(disabledModify);
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLGridTransformNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseCachedInverse: " << this->UseCachedInverse << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::SetUseCachedInverse(bool use)
+{
+  if (this->UseCachedInverse == use)
+    {
+    return;
+    }
+  this->UseCachedInverse = use;
+  this->UpdateGridTransformsUseCachedInverse();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::SetAndObserveTransform(vtkAbstractTransform** originalTransformPtr,
+  vtkAbstractTransform** inverseTransformPtr, vtkAbstractTransform *transform)
+{
+  this->Superclass::SetAndObserveTransform(originalTransformPtr, inverseTransformPtr, transform);
+  this->UpdateGridTransformsUseCachedInverse();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::UpdateGridTransformsUseCachedInverse()
+{
+  // The inverse of a transform is computed from the transform, which is
+  // enough: the grid transforms of the inverse copy the setting.
+  vtkAbstractTransform* transforms[2] = { this->TransformFromParent, this->TransformToParent };
+  vtkNew<vtkCollection> gridTransforms;
+  for (int i = 0; i < 2; ++i)
+    {
+    if (transforms[i] == NULL)
+      {
+      continue;
+      }
+    vtkMRMLTransformNode::FlattenGeneralTransform(gridTransforms.GetPointer(), transforms[i]);
+    for (int j = 0; j < gridTransforms->GetNumberOfItems(); ++j)
+      {
+      vtkOrientedGridTransform* gridTransform =
+        vtkOrientedGridTransform::SafeDownCast(gridTransforms->GetItemAsObject(j));
+      if (gridTransform)
+        {
+        gridTransform->SetUseCachedInverse(this->UseCachedInverse);
+        }
+      }
+    }
 }
@@ -46,11 +46,30 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() VTK_OVERRIDE {return "GridTransform";}
 
+  ///
+  /// If enabled, the inverse of the displacement grids is computed once at
+  /// the nodes of a grid instead of iteratively for each transformed point.
+  /// It is applied to all the vtkOrientedGridTransform of the node, including
+  /// the ones set later.
+  /// Disabled by default.
+  /// \sa vtkOrientedGridTransform::SetUseCachedInverse()
+  virtual void SetUseCachedInverse(bool use);
+  vtkGetMacro(UseCachedInverse, bool);
+  vtkBooleanMacro(UseCachedInverse, bool);
+
 protected:
   vtkMRMLGridTransformNode();
   ~vtkMRMLGridTransformNode();
   vtkMRMLGridTransformNode(const vtkMRMLGridTransformNode&);
   void operator=(const vtkMRMLGridTransformNode&);
+
+  virtual void SetAndObserveTransform(vtkAbstractTransform** originalTransformPtr,
+    vtkAbstractTransform** inverseTransformPtr, vtkAbstractTransform *transform) VTK_OVERRIDE;
+
+  /// Set UseCachedInverse to the grid transforms of the node.
+  void UpdateGridTransformsUseCachedInverse();
+
+  bool UseCachedInverse;
 };
 
 #endif
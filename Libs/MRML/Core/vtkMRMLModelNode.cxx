@@ -82,7 +82,18 @@ void vtkMRMLModelNode::Copy(vtkMRMLNode *anode)
     // Only copy bulk data if it exists - this handles the case
     // of restoring from SceneViews, where the nodes will not
     // have bulk data.
-    if (modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType)
+    if (this->SharesBulkData && modelNode->GetMesh())
+      {
+      // Snapshot: read-only shallow copy of the mesh, see
+      // StartBulkDataModify()
+      this->SetAndObserveBulkData(modelNode->GetSharedBulkDataCopy());
+      }
+    else if (modelNode->SharesBulkData && modelNode->GetMesh())
+      {
+      // Restore from a snapshot
+      this->CopySharedBulkData(modelNode);
+      }
+    else if (modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType)
       {
       this->SetPolyDataConnection(modelNode->GetMeshConnection());
       }
@@ -149,6 +160,7 @@ void vtkMRMLModelNode::SetAndObserveMesh(vtkPointSet *mesh)
 {
   if (mesh == 0)
     {
+    this->ReleaseSharedBulkData();
     this->SetMeshConnection(0);
     }
   else
@@ -184,6 +196,8 @@ void vtkMRMLModelNode::SetAndObserveMesh(vtkPointSet *mesh)
       }
     this->DataEventForwarder->SetTarget(tp.GetPointer());
     mesh->AddObserver(vtkCommand::ModifiedEvent, this->DataEventForwarder);
+    // the undo snapshots keep the arrays of the previous mesh
+    this->ReleaseSharedBulkData();
 
     if (polydata)
       {
@@ -912,9 +926,26 @@ void vtkMRMLModelNode
 ::SetMeshToDisplayNode(vtkMRMLModelDisplayNode* modelDisplayNode)
 {
   assert(modelDisplayNode);
+  if (this->SharesBulkData)
+    {
+    // the display nodes belong to the node the snapshot was made from
+    return;
+    }
   modelDisplayNode->SetInputMeshConnection(this->MeshConnection);
 }
 
+//----------------------------------------------------------------------------
+vtkDataObject* vtkMRMLModelNode::GetBulkData()
+{
+  return this->GetMesh();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelNode::SetAndObserveBulkData(vtkDataObject* data)
+{
+  this->SetAndObserveMesh(vtkPointSet::SafeDownCast(data));
+}
+
 //---------------------------------------------------------------------------
 bool vtkMRMLModelNode::GetModifiedSinceRead()
 {
@@ -23,6 +23,7 @@ class vtkMRMLStorageNode;
 // VTK includes
 class vtkAlgorithmOutput;
 class vtkAssignAttributes;
+class vtkDataObject;
 class vtkEventForwarderCommand;
 class vtkDataArray;
 class vtkPointSet;
@@ -258,6 +259,10 @@ protected:
   /// Called by SetPolyDataConnection and SetUnstructuredGridConnection
   virtual void SetMeshConnection(vtkAlgorithmOutput *inputPort);
 
+  /// The mesh is the bulk data of the node.
+  virtual vtkDataObject* GetBulkData() VTK_OVERRIDE;
+  virtual void SetAndObserveBulkData(vtkDataObject* data) VTK_OVERRIDE;
+
   /// Called when a display node is added/removed/modified. Propagate the mesh
   /// to the new display node.
   virtual void UpdateDisplayNodeMesh(vtkMRMLDisplayNode *dnode);
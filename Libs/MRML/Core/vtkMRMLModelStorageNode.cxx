@@ -21,6 +21,7 @@
 #include <vtkActor.h>
 #include <vtkBYUReader.h>
 #include <vtkCellArray.h>
+#include <vtkDataReader.h>
 #include <vtkDataSetSurfaceFilter.h>
 #include <vtkFieldData.h>
 #include <vtkNew.h>
@@ -35,6 +36,7 @@
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
 #include <vtkSTLReader.h>
 #include <vtkSTLWriter.h>
 #include <vtkStringArray.h>
@@ -120,6 +122,97 @@ bool vtkMRMLModelStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
   return refNode->IsA("vtkMRMLModelNode");
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Create the VTK reader of a model file, ready to be updated.
+// Return NULL if the file is not in a format read by a VTK reader.
+vtkAlgorithm* NewModelFileReader(const std::string& fullName)
+{
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
+  if ( extension == std::string(".g") || extension == std::string(".byu") )
+    {
+    vtkBYUReader* reader = vtkBYUReader::New();
+    reader->SetGeometryFileName(fullName.c_str());
+    return reader;
+    }
+  else if (extension == std::string(".vtk"))
+    {
+    vtkNew<vtkPolyDataReader> polyDataReader;
+    polyDataReader->SetFileName(fullName.c_str());
+    vtkNew<vtkUnstructuredGridReader> unstructuredGridReader;
+    unstructuredGridReader->SetFileName(fullName.c_str());
+    vtkDataReader* reader = NULL;
+    if (polyDataReader->IsFilePolyData())
+      {
+      reader = polyDataReader.GetPointer();
+      }
+    else if (unstructuredGridReader->IsFileUnstructuredGrid())
+      {
+      reader = unstructuredGridReader.GetPointer();
+      }
+    else
+      {
+      return NULL;
+      }
+    reader->ReadAllScalarsOn();
+    reader->ReadAllVectorsOn();
+    reader->ReadAllNormalsOn();
+    reader->ReadAllTensorsOn();
+    reader->ReadAllColorScalarsOn();
+    reader->ReadAllTCoordsOn();
+    reader->ReadAllFieldsOn();
+    reader->Register(NULL);
+    return reader;
+    }
+  else if (extension == std::string(".vtp"))
+    {
+    vtkXMLPolyDataReader* reader = vtkXMLPolyDataReader::New();
+    reader->SetFileName(fullName.c_str());
+    return reader;
+    }
+  else if (extension == std::string(".vtu"))
+    {
+    vtkXMLUnstructuredGridReader* reader = vtkXMLUnstructuredGridReader::New();
+    reader->SetFileName(fullName.c_str());
+    return reader;
+    }
+  else if (extension == std::string(".stl"))
+    {
+    vtkSTLReader* reader = vtkSTLReader::New();
+    reader->SetFileName(fullName.c_str());
+    return reader;
+    }
+  else if (extension == std::string(".ply"))
+    {
+    vtkPLYReader* reader = vtkPLYReader::New();
+    reader->SetFileName(fullName.c_str());
+    return reader;
+    }
+  else if (extension == std::string(".obj"))
+    {
+    vtkOBJReader* reader = vtkOBJReader::New();
+    reader->SetFileName(fullName.c_str());
+    return reader;
+    }
+  return NULL;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkAlgorithm* vtkMRMLModelStorageNode::InstantiatePrefetchReader(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty() || !vtksys::SystemTools::FileExists(fullName.c_str()))
+    {
+    return NULL;
+    }
+  return NewModelFileReader(fullName);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -152,84 +245,32 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   int result = 1;
   try
     {
-    if ( extension == std::string(".g") || extension == std::string(".byu") )
+    // The file may have already been read by PrefetchData()
+    vtkSmartPointer<vtkAlgorithm> reader = this->TakePrefetchedReader(refNode);
+    if (reader.GetPointer() == NULL)
       {
-      vtkNew<vtkBYUReader> reader;
-      reader->SetGeometryFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
-      }
-    else if (extension == std::string(".vtk"))
-      {
-      vtkNew<vtkPolyDataReader> reader;
-      reader->SetFileName(fullName.c_str());
-      vtkNew<vtkUnstructuredGridReader> unstructuredGridReader;
-      unstructuredGridReader->SetFileName(fullName.c_str());
-
-      if (reader->IsFilePolyData())
+      reader.TakeReference(NewModelFileReader(fullName));
+      if (reader.GetPointer() != NULL)
         {
         reader->Update();
-        reader->ReadAllScalarsOn();
-        reader->ReadAllVectorsOn();
-        reader->ReadAllNormalsOn();
-        reader->ReadAllTensorsOn();
-        reader->ReadAllColorScalarsOn();
-        reader->ReadAllTCoordsOn();
-        reader->ReadAllFieldsOn();
-        modelNode->SetPolyDataConnection(reader->GetOutputPort());
         }
-      else if (unstructuredGridReader->IsFileUnstructuredGrid())
+      }
+
+    if (reader.GetPointer() != NULL)
+      {
+      if (vtkUnstructuredGrid::SafeDownCast(reader->GetOutputDataObject(0)))
         {
-        unstructuredGridReader->ReadAllScalarsOn();
-        unstructuredGridReader->ReadAllVectorsOn();
-        unstructuredGridReader->ReadAllNormalsOn();
-        unstructuredGridReader->ReadAllTensorsOn();
-        unstructuredGridReader->ReadAllColorScalarsOn();
-        unstructuredGridReader->ReadAllTCoordsOn();
-        unstructuredGridReader->ReadAllFieldsOn();
-        unstructuredGridReader->Update();
-        modelNode->SetUnstructuredGridConnection(unstructuredGridReader->GetOutputPort());
+        modelNode->SetUnstructuredGridConnection(reader->GetOutputPort());
         }
       else
         {
-        vtkErrorMacro("File " << fullName.c_str()
-                      << " is not recognized as polydata nor as an unstructured grid.");
+        modelNode->SetPolyDataConnection(reader->GetOutputPort());
         }
       }
-    else if (extension == std::string(".vtp"))
-      {
-      vtkNew<vtkXMLPolyDataReader> reader;
-      reader->SetFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
-      }
-    else if (extension == std::string(".vtu"))
-      {
-      vtkNew<vtkXMLUnstructuredGridReader> reader;
-      reader->SetFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetUnstructuredGridConnection(reader->GetOutputPort());
-      }
-    else if (extension == std::string(".stl"))
-      {
-      vtkNew<vtkSTLReader> reader;
-      reader->SetFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
-      }
-    else if (extension == std::string(".ply"))
-      {
-      vtkNew<vtkPLYReader> reader;
-      reader->SetFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
-      }
-    else if (extension == std::string(".obj"))
+    else if (extension == std::string(".vtk"))
       {
-      vtkNew<vtkOBJReader> reader;
-      reader->SetFileName(fullName.c_str());
-      reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      vtkErrorMacro("File " << fullName.c_str()
+                    << " is not recognized as polydata nor as an unstructured grid.");
       }
     else if (extension == std::string(".meta"))  // model in meta format
       {
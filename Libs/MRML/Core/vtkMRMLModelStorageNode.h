@@ -56,6 +56,10 @@ protected:
   /// Get data node that is associated with this storage node
   vtkMRMLModelNode* GetAssociatedDataNode();
 
+  /// Read the model file ahead of ReadDataInternal(), see PrefetchData().
+  /// Only formats read by VTK readers are supported.
+  virtual vtkAlgorithm* InstantiatePrefetchReader(vtkMRMLNode* refNode) VTK_OVERRIDE;
+
   /// Read data and set it in the referenced node
   virtual int ReadDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
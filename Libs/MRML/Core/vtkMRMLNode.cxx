@@ -18,6 +18,7 @@ Version:   $Revision: 1.11 $
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkDataObject.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
@@ -50,6 +51,9 @@ vtkMRMLNode::vtkMRMLNode()
   this->Selected = 0;
 
   this->AddToScene = 1;
+  this->SharesBulkData = false;
+  this->SharedBulkDataCopySource = NULL;
+  this->SharedBulkDataCopySourceMTime = 0;
 
   this->DisableModifiedEvent = 0;
   this->ModifiedEventPending = 0;
@@ -139,6 +143,115 @@ void vtkMRMLNode::CopyWithScene(vtkMRMLNode *node)
   this->Copy(node);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::CopyWithSceneSharingBulkData(vtkMRMLNode *node)
+{
+  this->SharesBulkData = true;
+  this->CopyWithScene(node);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataObject> vtkMRMLNode::GetSharedBulkDataCopy()
+{
+  vtkDataObject* data = this->GetBulkData();
+  if (!data || this->SharesBulkData)
+    {
+    // the data of a snapshot is already read-only
+    return data;
+    }
+  // the arrays are referenced, not copied: in-place editors detach them
+  // with StartBulkDataModify()
+  if (this->SharedBulkDataCopy.GetPointer() &&
+      this->SharedBulkDataCopySource == data &&
+      this->SharedBulkDataCopySourceMTime == data->GetMTime())
+    {
+    return this->SharedBulkDataCopy.GetPointer();
+    }
+  vtkSmartPointer<vtkDataObject> copy = vtkSmartPointer<vtkDataObject>::Take(data->NewInstance());
+  copy->ShallowCopy(data);
+  this->SharedBulkDataCopy = copy;
+  this->SharedBulkDataCopySource = data;
+  this->SharedBulkDataCopySourceMTime = data->GetMTime();
+  return copy;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::CopySharedBulkData(vtkMRMLNode* node)
+{
+  vtkDataObject* snapshotData = node ? node->GetBulkData() : NULL;
+  if (!snapshotData)
+    {
+    return;
+    }
+  vtkDataObject* data = this->GetBulkData();
+  if (data && !this->SharesBulkData &&
+      this->SharedBulkDataCopy.GetPointer() == snapshotData &&
+      this->SharedBulkDataCopySource == data &&
+      this->SharedBulkDataCopySourceMTime == data->GetMTime())
+    {
+    // the snapshot was made from the current data, nothing changed
+    return;
+    }
+  vtkSmartPointer<vtkDataObject> copy = vtkSmartPointer<vtkDataObject>::Take(snapshotData->NewInstance());
+  copy->ShallowCopy(snapshotData);
+  this->SetAndObserveBulkData(copy);
+  if (!this->SharesBulkData)
+    {
+    // the arrays are shared with the snapshot
+    this->SharedBulkDataCopy = snapshotData;
+    this->SharedBulkDataCopySource = copy;
+    this->SharedBulkDataCopySourceMTime = copy->GetMTime();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::StopSharingBulkData()
+{
+  if (!this->SharesBulkData)
+    {
+    return;
+    }
+  this->SharesBulkData = false;
+  vtkDataObject* snapshotData = this->GetBulkData();
+  if (!snapshotData)
+    {
+    return;
+    }
+  // keep the snapshot data alive while the node data is replaced
+  vtkSmartPointer<vtkDataObject> sharedData = snapshotData;
+  vtkSmartPointer<vtkDataObject> copy = vtkSmartPointer<vtkDataObject>::Take(snapshotData->NewInstance());
+  copy->ShallowCopy(snapshotData);
+  this->SetAndObserveBulkData(copy);
+  this->SharedBulkDataCopy = sharedData;
+  this->SharedBulkDataCopySource = copy;
+  this->SharedBulkDataCopySourceMTime = copy->GetMTime();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::StartBulkDataModify()
+{
+  vtkDataObject* data = this->GetBulkData();
+  if (!data || this->SharesBulkData || this->SharedBulkDataCopySource != data)
+    {
+    // the arrays are not referenced by any snapshot
+    return;
+    }
+  // The node gets its own arrays, the snapshots keep the current ones. The
+  // data object is kept so that the pipelines using it are not changed.
+  vtkSmartPointer<vtkDataObject> sharedData = vtkSmartPointer<vtkDataObject>::Take(data->NewInstance());
+  sharedData->ShallowCopy(data);
+  data->DeepCopy(sharedData);
+  this->ReleaseSharedBulkData();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::ReleaseSharedBulkData()
+{
+  this->SharedBulkDataCopy = NULL;
+  this->SharedBulkDataCopySource = NULL;
+  this->SharedBulkDataCopySourceMTime = 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::Copy(vtkMRMLNode *node)
 {
@@ -967,6 +1080,34 @@ void vtkMRMLNode::SetAddToSceneNoModify(int value)
    this->AddToScene = value;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::SetName(const char* _arg)
+{
+  // Mostly copied from vtkSetStringMacro() in vtkSetGet.cxx
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Name to " << (_arg?_arg:"(null)") );
+  if ( this->Name == NULL && _arg == NULL) { return;}
+  if ( this->Name && _arg && (!strcmp(this->Name,_arg))) { return;}
+  char* oldName = this->Name;
+  if (_arg)
+    {
+    size_t n = strlen(_arg) + 1;
+    char *cp1 =  new char[n];
+    const char *cp2 = (_arg);
+    this->Name = cp1;
+    do { *cp1++ = *cp2++; } while ( --n );
+    }
+   else
+    {
+    this->Name = NULL;
+    }
+  if (this->Scene)
+    {
+    this->Scene->NodeNameChanged(this, oldName);
+    }
+  if (oldName) { delete [] oldName; }
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::SetID (const char* _arg)
 {
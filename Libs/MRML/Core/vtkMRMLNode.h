@@ -21,6 +21,7 @@
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
 
+class vtkDataObject;
 class vtkMRMLScene;
 class vtkStringArray;
 
@@ -220,6 +221,37 @@ public:
   /// \sa vtkMRMLScene::AddNode(vtkMRMLNode*)
   void CopyWithScene(vtkMRMLNode *node);
 
+  /// \brief Copy everything (including Scene and ID) from another node of
+  /// the same type into a read-only snapshot of the node.
+  ///
+  /// Same as CopyWithScene(vtkMRMLNode*), except for nodes with bulk data
+  /// (image, mesh...): this node gets its own data object, shallow copied
+  /// from the bulk data of \a node. The arrays are referenced, not copied,
+  /// so a snapshot costs no memory until \a node gets new data (e.g.
+  /// SetAndObserveImageData()), which leaves the snapshot data unchanged.
+  /// Code that modifies the arrays of \a node in place must call
+  /// StartBulkDataModify() first, otherwise the snapshots are modified too.
+  /// The bulk data of a snapshot must not be modified, and it is not set to
+  /// the display nodes.
+  /// Copying a snapshot into a node with Copy() gives the node a data object
+  /// referencing the arrays of the snapshot, unless the node data is
+  /// unmodified since the snapshot was made, in which case it is kept.
+  /// This is used by the scene undo/redo stacks.
+  ///
+  /// \sa CopyWithScene(vtkMRMLNode*), vtkMRMLScene::SaveStateForUndo(),
+  /// StartBulkDataModify()
+  void CopyWithSceneSharingBulkData(vtkMRMLNode *node);
+
+  /// \brief Prepare the bulk data (image, mesh...) to be modified in place.
+  ///
+  /// The arrays of the bulk data may be referenced by undo snapshots (see
+  /// CopyWithSceneSharingBulkData()). If so, they are replaced by copies
+  /// owned by the node only, in the same data object, and the snapshots keep
+  /// the original arrays. Call it before writing into the scalars, points or
+  /// cells of the node data, and get the arrays again afterward.
+  /// Replacing the data (e.g. SetAndObserveImageData()) doesn't require it.
+  void StartBulkDataModify();
+
   /// \brief Reset node attributes to the initial state as defined in the
   /// constructor or the passed default node.
   ///
@@ -333,7 +365,9 @@ public:
   vtkGetStringMacro(Description);
 
   /// Name of this node, to be set by the user
-  vtkSetStringMacro(Name);
+  /// The scene the node belongs to is notified of the change to keep its
+  /// name index up to date.
+  virtual void SetName(const char* name);
   vtkGetStringMacro(Name);
 
   /// ID use by other nodes to reference this node in XML.
@@ -865,6 +899,30 @@ protected:
   /// map contains existing role-id pairs, so we don't repeat them
   void ParseReferencesAttribute(const char *attValue, std::map<std::string, std::string> &references);
 
+  /// Bulk data (image, mesh...) of the node, NULL if none.
+  /// Nodes with bulk data implement these methods to support
+  /// CopyWithSceneSharingBulkData().
+  virtual vtkDataObject* GetBulkData() { return NULL; }
+  virtual void SetAndObserveBulkData(vtkDataObject* vtkNotUsed(data)) {}
+
+  /// Return a read-only shallow copy of the bulk data. The same copy is
+  /// returned until the bulk data is replaced or modified.
+  vtkSmartPointer<vtkDataObject> GetSharedBulkDataCopy();
+
+  /// Set a shallow copy of the bulk data of \a node, a snapshot made by
+  /// CopyWithSceneSharingBulkData(). The bulk data of this node is kept if
+  /// it is unmodified since the snapshot was made.
+  void CopySharedBulkData(vtkMRMLNode* node);
+
+  /// Give a snapshot its own data object, sharing the arrays of the snapshot
+  /// data, so that it can be used as a regular node (e.g. when it is added
+  /// back into the scene by undo).
+  void StopSharingBulkData();
+
+  /// Forget that the arrays of the bulk data are referenced by snapshots.
+  /// Called when the bulk data is replaced.
+  void ReleaseSharedBulkData();
+
   /// Holders for MRML callbacks
   vtkCallbackCommand *MRMLCallbackCommand;
 
@@ -882,6 +940,19 @@ protected:
 
   int  SaveWithScene;
 
+  /// Set on snapshots made by CopyWithSceneSharingBulkData(). Copy() of nodes
+  /// with bulk data must then set GetSharedBulkDataCopy() of the copied node
+  /// instead of observing its data objects.
+  bool SharesBulkData;
+
+  /// Last copy returned by GetSharedBulkDataCopy(), it is kept alive by the
+  /// snapshots only. SharedBulkDataCopySource (used for comparison only) is
+  /// the bulk data whose arrays are referenced by snapshots, NULL if none,
+  /// and SharedBulkDataCopySourceMTime its MTime when the copy was made.
+  vtkWeakPointer<vtkDataObject> SharedBulkDataCopy;
+  vtkDataObject* SharedBulkDataCopySource;
+  vtkMTimeType SharedBulkDataCopySourceMTime;
+
   // We don't increase the reference count of Scene when store its pointer
   // therefore we must use a weak pointer to prevent pointer dangling when
   // the scene is deleted.
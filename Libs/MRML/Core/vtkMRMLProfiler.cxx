@@ -0,0 +1,390 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLProfiler.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkMutexLock.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+//----------------------------------------------------------------------------
+// The profiler singleton.
+// This MUST be default initialized to zero by the compiler and is
+// therefore not initialized here. The ClassInitialize and
+// ClassFinalize methods handle this instance.
+static vtkMRMLProfiler* vtkMRMLProfilerInstance;
+
+//----------------------------------------------------------------------------
+// Must NOT be initialized. Default initialization to zero is necessary.
+unsigned int vtkMRMLProfilerInitialize::Count;
+
+//----------------------------------------------------------------------------
+// Implementation of vtkMRMLProfilerInitialize class.
+//----------------------------------------------------------------------------
+vtkMRMLProfilerInitialize::vtkMRMLProfilerInitialize()
+{
+  if(++Self::Count == 1)
+    {
+    vtkMRMLProfiler::classInitialize();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfilerInitialize::~vtkMRMLProfilerInitialize()
+{
+  if(--Self::Count == 0)
+    {
+    vtkMRMLProfiler::classFinalize();
+    }
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool compareTotalTime(const std::pair<double, std::pair<const char*, const char*> >& a,
+                      const std::pair<double, std::pair<const char*, const char*> >& b)
+{
+  return a.first > b.first;
+}
+
+//----------------------------------------------------------------------------
+void writeJSONString(ostream& os, const char* str)
+{
+  os << '"';
+  for (const char* c = str; c && *c; ++c)
+    {
+    if (*c == '"' || *c == '\\')
+      {
+      os << '\\';
+      }
+    if (static_cast<unsigned char>(*c) >= 0x20)
+      {
+      os << *c;
+      }
+    }
+  os << '"';
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Up the reference count so it behaves like New
+vtkMRMLProfiler* vtkMRMLProfiler::New()
+{
+  vtkMRMLProfiler* ret = vtkMRMLProfiler::GetInstance();
+  ret->Register(NULL);
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+// Return the single instance of the vtkMRMLProfiler
+vtkMRMLProfiler* vtkMRMLProfiler::GetInstance()
+{
+  if(!vtkMRMLProfilerInstance)
+    {
+    // Try the factory first
+    vtkMRMLProfilerInstance = (vtkMRMLProfiler*)vtkObjectFactory::CreateInstance("vtkMRMLProfiler");
+    // if the factory did not provide one, then create it here
+    if(!vtkMRMLProfilerInstance)
+      {
+      vtkMRMLProfilerInstance = new vtkMRMLProfiler;
+#ifdef VTK_HAS_INITIALIZE_OBJECT_BASE
+      vtkMRMLProfilerInstance->InitializeObjectBase();
+#endif
+      }
+    }
+  // return the instance
+  return vtkMRMLProfilerInstance;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::classInitialize()
+{
+  // Allocate the singleton
+  vtkMRMLProfilerInstance = vtkMRMLProfiler::GetInstance();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::classFinalize()
+{
+  vtkMRMLProfilerInstance->Delete();
+  vtkMRMLProfilerInstance = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::CallSiteStatisticsType::CallSiteStatisticsType()
+  : CallCount(0)
+  , TotalTime(0.)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::vtkMRMLProfiler()
+{
+  this->Enabled = false;
+  this->BufferSize = 100000;
+  this->NextRecord = 0;
+  this->NumberOfDroppedRecords = 0;
+  this->ClearTime = vtkMRMLProfiler::GetTime();
+  this->Lock = vtkSimpleMutexLock::New();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::~vtkMRMLProfiler()
+{
+  this->Lock->Delete();
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLProfiler::GetTime()
+{
+  return vtkTimerLog::GetUniversalTime();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::SetBufferSize(int size)
+{
+  if (size < 1)
+    {
+    vtkErrorMacro("SetBufferSize: invalid size " << size);
+    return;
+    }
+  this->Lock->Lock();
+  this->BufferSize = size;
+  this->Records.clear();
+  this->NextRecord = 0;
+  this->Lock->Unlock();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::Clear()
+{
+  this->Lock->Lock();
+  this->Records.clear();
+  this->NextRecord = 0;
+  this->NumberOfDroppedRecords = 0;
+  this->CallSiteStatistics.clear();
+  this->ClearTime = vtkMRMLProfiler::GetTime();
+  this->Threads.clear();
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::AddRecord(const char* category, const char* name,
+                                unsigned long eventId, double startTime, double elapsedTime)
+{
+  RecordType record;
+  record.Category = category;
+  record.Name = name;
+  record.EventId = eventId;
+  record.StartTime = startTime;
+  record.ElapsedTime = elapsedTime;
+  vtkMultiThreaderIDType threadId = vtkMultiThreader::GetCurrentThreadID();
+
+  this->Lock->Lock();
+  // threads are numbered from 1 in the order of their first record
+  record.ThreadId = 0;
+  for (size_t i = 0; i < this->Threads.size() && !record.ThreadId; ++i)
+    {
+    if (vtkMultiThreader::ThreadsEqual(this->Threads[i], threadId))
+      {
+      record.ThreadId = static_cast<int>(i) + 1;
+      }
+    }
+  if (!record.ThreadId)
+    {
+    this->Threads.push_back(threadId);
+    record.ThreadId = static_cast<int>(this->Threads.size());
+    }
+  // the buffer is allocated as it fills up
+  if (static_cast<int>(this->Records.size()) < this->BufferSize)
+    {
+    this->Records.push_back(record);
+    }
+  else
+    {
+    this->Records[this->NextRecord] = record;
+    this->NumberOfDroppedRecords++;
+    }
+  this->NextRecord = (this->NextRecord + 1) % this->BufferSize;
+
+  CallSiteStatisticsType& statistics = this->CallSiteStatistics[CallSiteType(category, name)];
+  statistics.CallCount++;
+  statistics.TotalTime += elapsedTime;
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLProfiler::GetNumberOfRecords()
+{
+  return static_cast<int>(this->Records.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLProfiler::GetNumberOfDroppedRecords()
+{
+  return this->NumberOfDroppedRecords;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::CallSiteStatisticsType vtkMRMLProfiler
+::GetCallSiteStatistics(const char* category, const char* name)
+{
+  // The same literal may have different addresses in different libraries
+  CallSiteStatisticsType sum;
+  if (!category || !name)
+    {
+    return sum;
+    }
+  this->Lock->Lock();
+  CallSiteStatisticsMapType::const_iterator it;
+  for (it = this->CallSiteStatistics.begin(); it != this->CallSiteStatistics.end(); ++it)
+    {
+    if (strcmp(it->first.first, category) == 0 && strcmp(it->first.second, name) == 0)
+      {
+      sum.CallCount += it->second.CallCount;
+      sum.TotalTime += it->second.TotalTime;
+      }
+    }
+  this->Lock->Unlock();
+  return sum;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLProfiler::GetCallCount(const char* category, const char* name)
+{
+  return this->GetCallSiteStatistics(category, name).CallCount;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLProfiler::GetTotalTime(const char* category, const char* name)
+{
+  return this->GetCallSiteStatistics(category, name).TotalTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::PrintStatistics(ostream& os)
+{
+  this->Lock->Lock();
+  std::vector< std::pair<double, CallSiteType> > callSites;
+  CallSiteStatisticsMapType::const_iterator it;
+  for (it = this->CallSiteStatistics.begin(); it != this->CallSiteStatistics.end(); ++it)
+    {
+    callSites.push_back(std::make_pair(it->second.TotalTime, it->first));
+    }
+  std::sort(callSites.begin(), callSites.end(), compareTotalTime);
+  for (size_t i = 0; i < callSites.size(); ++i)
+    {
+    const CallSiteStatisticsType& statistics = this->CallSiteStatistics[callSites[i].second];
+    os << callSites[i].second.first << " " << callSites[i].second.second << ": "
+       << statistics.CallCount << " calls, " << statistics.TotalTime << "s\n";
+    }
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::WriteChromeTrace(ostream& os)
+{
+  this->Lock->Lock();
+  os << "{\"traceEvents\":[";
+  // oldest record first
+  int numberOfRecords = static_cast<int>(this->Records.size());
+  int firstRecord = (numberOfRecords < this->BufferSize ? 0 : this->NextRecord);
+  for (int i = 0; i < numberOfRecords; ++i)
+    {
+    const RecordType& record = this->Records[(firstRecord + i) % numberOfRecords];
+    os << (i > 0 ? ",\n" : "\n");
+    // complete event, timestamps in microseconds
+    os << "{\"name\":";
+    writeJSONString(os, record.Name);
+    os << ",\"cat\":";
+    writeJSONString(os, record.Category);
+    os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.ThreadId
+       << ",\"ts\":" << static_cast<long long>((record.StartTime - this->ClearTime) * 1e6)
+       << ",\"dur\":" << static_cast<long long>(record.ElapsedTime * 1e6);
+    if (record.EventId != vtkCommand::NoEvent)
+      {
+      os << ",\"args\":{\"event\":";
+      writeJSONString(os, vtkCommand::GetStringFromEventId(record.EventId));
+      os << ",\"eventId\":" << record.EventId << "}";
+      }
+    os << "}";
+    }
+  os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedRecords\":"
+     << this->NumberOfDroppedRecords << "}}\n";
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLProfiler::WriteChromeTrace(const char* fileName)
+{
+  if (!fileName)
+    {
+    vtkErrorMacro("WriteChromeTrace: no file name");
+    return false;
+    }
+  std::ofstream file(fileName);
+  if (!file.is_open())
+    {
+    vtkErrorMacro("WriteChromeTrace: cannot open " << fileName);
+    return false;
+    }
+  this->WriteChromeTrace(file);
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLProfiler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Enabled: " << this->Enabled << "\n";
+  os << indent << "BufferSize: " << this->BufferSize << "\n";
+  os << indent << "NumberOfRecords: " << this->GetNumberOfRecords() << "\n";
+  os << indent << "NumberOfDroppedRecords: " << this->NumberOfDroppedRecords << "\n";
+  os << indent << "NumberOfCallSites: " << this->CallSiteStatistics.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::Scope::Scope(const char* category, const char* name, unsigned long eventId)
+  : Category(category)
+  , Name(name)
+  , EventId(eventId)
+  , StartTime(-1.)
+{
+  if (vtkMRMLProfilerInstance && vtkMRMLProfilerInstance->Enabled)
+    {
+    this->StartTime = vtkMRMLProfiler::GetTime();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLProfiler::Scope::~Scope()
+{
+  if (this->StartTime >= 0. && vtkMRMLProfilerInstance)
+    {
+    vtkMRMLProfilerInstance->AddRecord(this->Category, this->Name, this->EventId,
+      this->StartTime, vtkMRMLProfiler::GetTime() - this->StartTime);
+    }
+}
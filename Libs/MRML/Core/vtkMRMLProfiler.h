@@ -0,0 +1,205 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLProfiler_h
+#define __vtkMRMLProfiler_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <utility>
+#include <vector>
+
+class vtkSimpleMutexLock;
+
+/// \brief Records the time spent in MRML callbacks.
+///
+/// The profiler records the calls of instrumented call sites: the callbacks
+/// invoked by vtkEventBroker, vtkMRMLAbstractLogic::ProcessMRMLSceneEvents()
+/// and ProcessMRMLNodesEvents() (which includes displayable managers) and
+/// vtkMRMLAbstractDisplayableManager::UpdateFromMRML().
+/// A call site is identified by a category (the instrumented method) and a
+/// name (usually the class name of the object handling the call).
+///
+/// The call count and inclusive time are accumulated per call site, and the
+/// most recent calls are kept in a ring buffer that can be saved in the
+/// Chrome trace event format (open with chrome://tracing or Perfetto).
+///
+/// Instrumentation is compiled in only if MRML is configured with
+/// MRML_USE_PROFILER, and records only while the profiler is enabled:
+/// \code
+/// vtkMRMLProfiler::GetInstance()->EnabledOn();
+/// // ... interact ...
+/// vtkMRMLProfiler::GetInstance()->WriteChromeTrace("/tmp/trace.json");
+/// \endcode
+/// \sa vtkMRMLProfileScopeMacro
+class VTK_MRML_EXPORT vtkMRMLProfiler : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkMRMLProfiler, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  ///
+  /// Return the singleton instance with no reference counting.
+  static vtkMRMLProfiler* GetInstance();
+
+  ///
+  /// This is a singleton pattern New. Clients that call this must call
+  /// Delete on the object.
+  static vtkMRMLProfiler* New();
+
+  /// Record calls only when enabled. Off by default.
+  vtkGetMacro(Enabled, bool);
+  vtkSetMacro(Enabled, bool);
+  vtkBooleanMacro(Enabled, bool);
+
+  /// Maximum number of calls kept for the trace, the oldest calls are
+  /// overwritten first. Setting the size clears the recorded calls.
+  /// Default is 100000.
+  void SetBufferSize(int size);
+  vtkGetMacro(BufferSize, int);
+
+  /// Remove the recorded calls and statistics.
+  void Clear();
+
+  /// Number of calls in the ring buffer, and number of calls that were
+  /// overwritten since the last Clear().
+  int GetNumberOfRecords();
+  int GetNumberOfDroppedRecords();
+
+  /// Number of calls and inclusive time in seconds of a call site since the
+  /// last Clear(), 0 if the call site has not been called.
+  int GetCallCount(const char* category, const char* name);
+  double GetTotalTime(const char* category, const char* name);
+
+  /// Print one line per call site, sorted by inclusive time.
+  void PrintStatistics(ostream& os);
+
+  /// Write the recorded calls as a Chrome trace event JSON object.
+  void WriteChromeTrace(ostream& os);
+  /// Write the recorded calls to a Chrome trace event JSON file.
+  /// Return false if the file can't be written.
+  bool WriteChromeTrace(const char* fileName);
+
+  /// Record a call of a call site that started at startTime (as returned by
+  /// GetTime()). The category and name are not copied, they must be string
+  /// literals or class names. eventId is the processed event, if any.
+  void AddRecord(const char* category, const char* name, unsigned long eventId,
+                 double startTime, double elapsedTime);
+
+  /// Current time in seconds.
+  static double GetTime();
+
+  /// Record the lifetime of the scope as a call, if the profiler is enabled.
+  class Scope
+  {
+  public:
+    Scope(const char* category, const char* name, unsigned long eventId = 0);
+    ~Scope();
+  private:
+    const char* Category;
+    const char* Name;
+    unsigned long EventId;
+    double StartTime;
+  };
+
+protected:
+  vtkMRMLProfiler();
+  virtual ~vtkMRMLProfiler();
+  vtkMRMLProfiler(const vtkMRMLProfiler&);
+  void operator=(const vtkMRMLProfiler&);
+
+  ///
+  /// Singleton management functions.
+  static void classInitialize();
+  static void classFinalize();
+
+  friend class vtkMRMLProfilerInitialize;
+
+  struct RecordType
+  {
+    const char* Category;
+    const char* Name;
+    unsigned long EventId;
+    double StartTime;
+    double ElapsedTime;
+    /// Index of the recording thread in Threads, plus one
+    int ThreadId;
+  };
+  struct CallSiteStatisticsType
+  {
+    CallSiteStatisticsType();
+    int CallCount;
+    double TotalTime;
+  };
+  typedef std::pair<const char*, const char*> CallSiteType;
+  typedef std::map<CallSiteType, CallSiteStatisticsType> CallSiteStatisticsMapType;
+
+  /// Sum the statistics of the call sites with the same category and name
+  CallSiteStatisticsType GetCallSiteStatistics(const char* category, const char* name);
+
+  bool Enabled;
+  int BufferSize;
+  /// Ring buffer of the recorded calls, NextRecord is the index of the next
+  /// record to write.
+  std::vector<RecordType> Records;
+  int NextRecord;
+  int NumberOfDroppedRecords;
+  CallSiteStatisticsMapType CallSiteStatistics;
+  /// Time of the last Clear(), origin of the trace timestamps
+  double ClearTime;
+  /// Threads that added records since the last Clear(), in order of their
+  /// first record
+  std::vector<vtkMultiThreaderIDType> Threads;
+  /// Calls can be recorded from any thread
+  vtkSimpleMutexLock* Lock;
+};
+
+/// Utility class to make sure vtkMRMLProfiler is initialized before it is used.
+class VTK_MRML_EXPORT vtkMRMLProfilerInitialize
+{
+public:
+  typedef vtkMRMLProfilerInitialize Self;
+
+  vtkMRMLProfilerInitialize();
+  ~vtkMRMLProfilerInitialize();
+private:
+  static unsigned int Count;
+};
+
+/// This instance will show up in any translation unit that uses
+/// vtkMRMLProfiler. It will make sure vtkMRMLProfiler is initialized
+/// before it is used.
+static vtkMRMLProfilerInitialize vtkMRMLProfilerInitializer;
+
+/// Record the calls of the enclosing scope with vtkMRMLProfiler.
+/// Expands to nothing if MRML is not configured with MRML_USE_PROFILER.
+/// \code
+/// vtkMRMLProfileScopeMacro("ProcessMRMLNodesEvents", this->GetClassName(), eid);
+/// \endcode
+#ifdef MRML_USE_PROFILER
+# define vtkMRMLProfileScopeMacro(category, name, eventId) \
+  vtkMRMLProfiler::Scope vtkMRMLProfilerScope(category, name, eventId)
+#else
+# define vtkMRMLProfileScopeMacro(category, name, eventId)
+#endif
+
+#endif
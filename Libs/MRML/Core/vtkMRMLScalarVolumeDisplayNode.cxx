@@ -14,6 +14,7 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkImageMapToWindowLevelThresholdColors.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
@@ -105,6 +106,12 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort() );
   this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort() );
 
+  // Same output as the pipeline above without the intermediate images.
+  this->MapToWindowLevelThresholdColors = vtkImageMapToWindowLevelThresholdColors::New();
+  this->MapToWindowLevelThresholdColors->SetWindow(256.);
+  this->MapToWindowLevelThresholdColors->SetLevel(128.);
+  this->MapToWindowLevelThresholdColors->ThresholdBetween(VTK_SHORT_MIN, VTK_SHORT_MAX);
+
   this->Bimodal = NULL;
   this->Accumulate = NULL;
   this->IsInCalculateAutoLevels = false;
@@ -126,6 +133,7 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
   this->ExtractRGB->Delete();
   this->ExtractAlpha->Delete();
   this->MultiplyAlpha->Delete();
+  this->MapToWindowLevelThresholdColors->Delete();
 
   if (this->Bimodal)
     {
@@ -178,6 +186,7 @@ void vtkMRMLScalarVolumeDisplayNode
 {
   this->Threshold->SetInputConnection(imageDataConnection);
   this->MapToWindowLevelColors->SetInputConnection(imageDataConnection);
+  this->MapToWindowLevelThresholdColors->SetInputConnection(imageDataConnection);
 }
 
 //----------------------------------------------------------------------------
@@ -185,6 +194,7 @@ void vtkMRMLScalarVolumeDisplayNode
 ::SetBackgroundImageStencilDataConnection(vtkAlgorithmOutput *imageDataConnection)
 {
   this->MultiplyAlpha->SetStencilConnection(imageDataConnection);
+  this->MapToWindowLevelThresholdColors->SetStencilConnection(imageDataConnection);
 }
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetBackgroundImageStencilDataConnection()
@@ -206,7 +216,7 @@ vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetInputImageDataConnection(
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetOutputImageDataConnection()
 {
-  return this->AppendComponents->GetOutputPort();
+  return this->MapToWindowLevelThresholdColors->GetOutputPort();
 }
 
 //----------------------------------------------------------------------------
@@ -441,6 +451,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindow(double window)
     }
 
   this->MapToWindowLevelColors->SetWindow(window);
+  this->MapToWindowLevelThresholdColors->SetWindow(window);
   this->Modified();
 }
 
@@ -459,6 +470,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetLevel(double level)
     }
 
   this->MapToWindowLevelColors->SetLevel(level);
+  this->MapToWindowLevelThresholdColors->SetLevel(level);
   this->Modified();
 }
 
@@ -473,6 +485,8 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindowLevel(double window, double level)
 
   this->MapToWindowLevelColors->SetWindow(window);
   this->MapToWindowLevelColors->SetLevel(level);
+  this->MapToWindowLevelThresholdColors->SetWindow(window);
+  this->MapToWindowLevelThresholdColors->SetLevel(level);
   this->Modified();
 }
 
@@ -509,6 +523,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetApplyThreshold(int apply)
     }
   this->ApplyThreshold = apply;
   this->Threshold->SetOutValue(apply ? 0 : 255);
+  this->MapToWindowLevelThresholdColors->SetApplyThreshold(apply);
   this->Modified();
 }
 
@@ -545,6 +560,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetThreshold(double lowerThreshold, double
     return;
     }
   this->Threshold->ThresholdBetween( lowerThreshold, upperThreshold );
+  this->MapToWindowLevelThresholdColors->ThresholdBetween( lowerThreshold, upperThreshold );
   this->Modified();
 }
 
@@ -572,6 +588,7 @@ void vtkMRMLScalarVolumeDisplayNode::UpdateLookupTable(vtkMRMLColorNode* newColo
       }
     }
   this->MapToColors->SetLookupTable(lookupTable);
+  this->MapToWindowLevelThresholdColors->SetLookupTable(lookupTable);
 }
 
 //---------------------------------------------------------------------------
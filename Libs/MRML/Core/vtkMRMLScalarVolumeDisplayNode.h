@@ -27,6 +27,7 @@ class vtkImageCast;
 class vtkImageLogic;
 class vtkImageMapToColors;
 class vtkImageMapToWindowLevelColors;
+class vtkImageMapToWindowLevelThresholdColors;
 class vtkImageStencil;
 class vtkImageThreshold;
 class vtkImageExtractComponents;
@@ -236,6 +237,11 @@ protected:
   vtkImageExtractComponents *ExtractAlpha;
   vtkImageStencil *MultiplyAlpha;
 
+  /// Computes the output of the filters above in a single pass.
+  /// Subclasses that rewire the filters above must override
+  /// GetOutputImageDataConnection() to return AppendComponents' output.
+  vtkImageMapToWindowLevelThresholdColors *MapToWindowLevelThresholdColors;
+
   ///
   /// window level presets
   std::vector<WindowLevelPreset> WindowLevelPresets;
@@ -54,6 +54,8 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLSliceCompositeNode.h"
 #include "vtkMRMLSliceNode.h"
 #include "vtkMRMLSnapshotClipNode.h"
+#include "vtkMRMLStorableNode.h"
+#include "vtkMRMLStorageNode.h"
 #include "vtkMRMLSubjectHierarchyNode.h"
 #include "vtkMRMLTableNode.h"
 #include "vtkMRMLTableStorageNode.h"
@@ -84,6 +86,9 @@ Version:   $Revision: 1.18 $
 #include <vtkCollection.h>
 #include <vtkDebugLeaks.h>
 #include <vtkErrorCode.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
 
@@ -106,10 +111,101 @@ vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable)
 vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection)
 
+//------------------------------------------------------------------------------
+/// Class and name indices of the scene nodes.
+/// Node lists are kept in the scene order: nodes are ranked by their position
+/// in the Nodes collection at the time they were indexed.
+class vtkMRMLScene::vtkNodeIndex
+{
+public:
+  typedef std::vector<vtkMRMLNode*> NodeListType;
+  typedef std::map<vtkMRMLNode*, unsigned long> PositionMapType;
+
+  struct PositionLess
+  {
+    PositionLess(const PositionMapType& positions) : Positions(positions) {}
+    bool operator()(vtkMRMLNode* a, vtkMRMLNode* b) const
+      {
+      return this->Positions.find(a)->second < this->Positions.find(b)->second;
+      }
+    const PositionMapType& Positions;
+  };
+
+  vtkNodeIndex()
+    {
+    this->MTime = 0;
+    this->NextPosition = 0;
+    }
+
+  void Clear()
+    {
+    this->Positions.clear();
+    this->NextPosition = 0;
+    this->NodesByClass.clear();
+    this->ClassLists.clear();
+    this->NodesByName.clear();
+    this->MTime = 0;
+    }
+
+  /// Insert \a node in \a nodes, keeping the scene order.
+  void InsertNode(NodeListType& nodes, vtkMRMLNode* node)
+    {
+    nodes.insert(std::upper_bound(nodes.begin(), nodes.end(), node,
+                                  PositionLess(this->Positions)), node);
+    }
+
+  /// Remove \a node from \a nodes.
+  void EraseNode(NodeListType& nodes, vtkMRMLNode* node)
+    {
+    NodeListType::iterator it = std::lower_bound(nodes.begin(), nodes.end(), node,
+                                                 PositionLess(this->Positions));
+    if (it != nodes.end() && *it == node)
+      {
+      nodes.erase(it);
+      }
+    }
+
+  /// Return the indexed class lists \a node belongs to.
+  std::vector<NodeListType*>& GetClassLists(vtkMRMLNode* node)
+    {
+    std::map<std::string, std::vector<NodeListType*> >::iterator it =
+      this->ClassLists.find(node->GetClassName());
+    if (it != this->ClassLists.end())
+      {
+      return it->second;
+      }
+    std::vector<NodeListType*>& classLists = this->ClassLists[node->GetClassName()];
+    for (std::map<std::string, NodeListType>::iterator classIt = this->NodesByClass.begin();
+         classIt != this->NodesByClass.end(); ++classIt)
+      {
+      if (node->IsA(classIt->first.c_str()))
+        {
+        classLists.push_back(&classIt->second);
+        }
+      }
+    return classLists;
+    }
+
+  /// Rank of the nodes in the scene
+  PositionMapType Positions;
+  unsigned long NextPosition;
+  /// Nodes of a class and its subclasses. Only the classes that have been
+  /// queried are indexed.
+  std::map<std::string, NodeListType> NodesByClass;
+  /// For each node class, the NodesByClass lists the nodes of that class
+  /// belong to.
+  std::map<std::string, std::vector<NodeListType*> > ClassLists;
+  std::map<std::string, NodeListType> NodesByName;
+  /// Nodes collection MTime the indices are in sync with.
+  vtkMTimeType MTime;
+  NodeListType EmptyList;
+};
+
 //------------------------------------------------------------------------------
 vtkMRMLScene::vtkMRMLScene()
 {
   this->NodeIDsMTime = 0;
+  this->NodeIndex = new vtkNodeIndex;
   this->SceneModifiedTime = 0;
 
   this->RegisteredNodeClasses.clear();
@@ -137,6 +233,8 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->ReadDataOnLoad = 1;
 
+  this->NumberOfReadDataThreads = 1;
+
   this->LastLoadedVersion = NULL;
   this->Version = NULL;
   this->SetVersion(CURRENT_MRML_VERSION);
@@ -240,6 +338,8 @@ vtkMRMLScene::~vtkMRMLScene()
     this->Nodes->Delete();
     this->Nodes = NULL;
     }
+  delete this->NodeIndex;
+  this->NodeIndex = NULL;
 
   for (unsigned int n=0; n<this->RegisteredNodeClasses.size(); n++)
     {
@@ -738,6 +838,103 @@ int vtkMRMLScene::Connect()
   return res;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+
+//------------------------------------------------------------------------------
+struct PrefetchDataInfo
+{
+  std::vector<vtkMRMLStorageNode*> StorageNodes;
+  std::vector<vtkMRMLNode*> StorableNodes;
+  std::vector<int> Prefetched;
+  size_t NextIndex;
+  vtkSimpleMutexLock* Lock;
+};
+
+//------------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE PrefetchDataThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  PrefetchDataInfo* info = static_cast<PrefetchDataInfo*>(threadInfo->UserData);
+  while (true)
+    {
+    info->Lock->Lock();
+    size_t index = info->NextIndex++;
+    info->Lock->Unlock();
+    if (index >= info->StorageNodes.size())
+      {
+      break;
+      }
+    info->Prefetched[index] =
+      info->StorageNodes[index]->ReadPrefetchData(info->StorableNodes[index]);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::PrefetchStorableNodesData(vtkCollection* nodes, vtkCollection* storageNodes)
+{
+  if (nodes == NULL || storageNodes == NULL)
+    {
+    return;
+    }
+  // Storage nodes are looked up on the calling thread, the worker threads
+  // only read files
+  PrefetchDataInfo info;
+  std::set<vtkMRMLStorageNode*> uniqueStorageNodes;
+  vtkCollectionSimpleIterator it;
+  vtkMRMLNode* node = NULL;
+  for (nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+    {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+    if (storableNode == NULL || !storableNode->GetAddToScene())
+      {
+      continue;
+      }
+    for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); ++i)
+      {
+      vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(i);
+      // A storage node shared by several nodes is read ahead for the first one only
+      if (storageNode != NULL && uniqueStorageNodes.insert(storageNode).second)
+        {
+        storageNode->ClearPrefetchedData();
+        info.StorageNodes.push_back(storageNode);
+        info.StorableNodes.push_back(storableNode);
+        }
+      }
+    }
+  if (info.StorageNodes.size() < 2)
+    {
+    // Nothing to gain from reading ahead
+    return;
+    }
+  info.Prefetched.resize(info.StorageNodes.size(), 0);
+  info.NextIndex = 0;
+  vtkNew<vtkSimpleMutexLock> lock;
+  info.Lock = lock.GetPointer();
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(std::min(this->NumberOfReadDataThreads,
+                                        static_cast<int>(info.StorageNodes.size())));
+  threader->SetSingleMethod(PrefetchDataThreadFunction, &info);
+  threader->SingleMethodExecute();
+
+  // The worker threads don't reference the storable nodes, weak pointers are
+  // not thread safe
+  for (size_t i = 0; i < info.StorageNodes.size(); ++i)
+    {
+    if (info.Prefetched[i])
+      {
+      info.StorageNodes[i]->SetPrefetchedDataNode(info.StorableNodes[i]);
+      storageNodes->AddItem(info.StorageNodes[i]);
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Import()
 {
@@ -798,6 +995,14 @@ int vtkMRMLScene::Import()
 
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, NULL);
 
+    // Read the data files concurrently, UpdateScene then sets the
+    // data in the nodes
+    vtkNew<vtkCollection> prefetchedStorageNodes;
+    if (this->NumberOfReadDataThreads > 1 && this->ReadDataOnLoad)
+      {
+      this->PrefetchStorableNodesData(addedNodes, prefetchedStorageNodes.GetPointer());
+      }
+
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
@@ -822,6 +1027,14 @@ int vtkMRMLScene::Import()
         }
       }
 
+    // Release the data that has not been used
+    vtkMRMLStorageNode* storageNode = NULL;
+    for (prefetchedStorageNodes->InitTraversal(it);
+         (storageNode = vtkMRMLStorageNode::SafeDownCast(prefetchedStorageNodes->GetNextItemAsObject(it))) ;)
+      {
+      storageNode->ClearPrefetchedData();
+      }
+
     this->Modified();
     this->RemoveUnusedNodeReferences();
 #ifdef MRMLSCENE_VERBOSE
@@ -1183,10 +1396,12 @@ vtkMRMLNode* vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
     n->SetName(this->GenerateUniqueName(n).c_str());
     }
   n->SetScene( this );
+  bool nodeIndexUpToDate = this->IsNodeIndexUpToDate();
   this->Nodes->vtkCollection::AddItem((vtkObject *)n);
 
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  this->AddNodeToIndex(n, nodeIndexUpToDate);
 
   //n->OnNodeAddedToScene();
 
@@ -1340,10 +1555,12 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
     {
     n->SetScene(0);
     }
+  bool nodeIndexUpToDate = this->IsNodeIndexUpToDate();
   this->Nodes->vtkCollection::RemoveItem((vtkObject *)n);
 
   std::string nid=n->GetID();
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromIndex(n, nodeIndexUpToDate);
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1521,18 +1738,7 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
     }
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      num++;
-      }
-    }
-  return num;
+  return static_cast<int>(this->GetIndexedNodesByClass(className).size());
 }
 
 //------------------------------------------------------------------------------
@@ -1544,16 +1750,7 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
     }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      nodes.push_back(node);
-      }
-    }
+  nodes = this->GetIndexedNodesByClass(className);
   return static_cast<int>(nodes.size());
 }
 
@@ -1566,15 +1763,10 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return 0;
     }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes = this->GetIndexedNodesByClass(className);
+  for (std::vector<vtkMRMLNode*>::const_iterator it = classNodes.begin(); it != classNodes.end(); ++it)
     {
-    if (node->IsA(className))
-      {
-      nodes->AddItem(node);
-      }
+    nodes->AddItem(*it);
     }
   return nodes;
 }
@@ -1635,13 +1827,11 @@ vtkMRMLNode* vtkMRMLScene::GetSingletonNode(const char* singletonTag, const char
     return NULL;
     }
 
-  vtkCollectionSimpleIterator it;
-  vtkMRMLNode* node = NULL;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes = this->GetIndexedNodesByClass(className);
+  for (std::vector<vtkMRMLNode*>::const_iterator it = classNodes.begin(); it != classNodes.end(); ++it)
     {
-    if (node->IsA(className) &&
-        node->GetSingletonTag() != NULL &&
+    vtkMRMLNode* node = *it;
+    if (node->GetSingletonTag() != NULL &&
         strcmp(node->GetSingletonTag(), singletonTag) == 0)
       {
       return node;
@@ -1711,22 +1901,12 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return NULL;
     }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes = this->GetIndexedNodesByClass(className);
+  if (n >= static_cast<int>(classNodes.size()))
     {
-    if (node->IsA(className))
-      {
-      if (num == n)
-        {
-        return node;
-        }
-      num++;
-      }
+    return NULL;
     }
-  return NULL;
+  return classNodes[n];
 }
 
 //------------------------------------------------------------------------------
@@ -1746,15 +1926,10 @@ vtkCollection* vtkMRMLScene::GetNodesByName(const char* name)
     return nodes;
     }
 
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& namedNodes = this->GetIndexedNodesByName(name);
+  for (std::vector<vtkMRMLNode*>::const_iterator it = namedNodes.begin(); it != namedNodes.end(); ++it)
     {
-    if (!strcmp(node->GetName(), name))
-      {
-      nodes->AddItem(node);
-      }
+    nodes->AddItem(*it);
     }
   return nodes;
 }
@@ -1765,6 +1940,32 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNode(const char* byName,
                                         const int* byHideFromEditors,
                                         bool exactNameMatch)
 {
+  if (byClass)
+    {
+    // Only the nodes of the requested class need to be checked
+    const std::vector<vtkMRMLNode*>& classNodes = this->GetIndexedNodesByClass(byClass);
+    for (std::vector<vtkMRMLNode*>::const_iterator it = classNodes.begin(); it != classNodes.end(); ++it)
+      {
+      vtkMRMLNode* node = *it;
+      if (exactNameMatch && byName &&
+          node->GetName() != 0 && strcmp(node->GetName(), byName) != 0)
+        {
+        continue;
+        }
+      if (!exactNameMatch && byName &&
+          node->GetName() != 0 && !vtksys::RegularExpression(byName).find(node->GetName()))
+        {
+        continue;
+        }
+      if (byHideFromEditors && node->GetHideFromEditors() != *byHideFromEditors)
+        {
+        continue;
+        }
+      return node;
+      }
+    return 0;
+    }
+
   vtkCollectionSimpleIterator it;
   vtkMRMLNode* node;
   for (this->Nodes->InitTraversal(it);
@@ -1781,10 +1982,6 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNode(const char* byName,
       {
       continue;
       }
-    if (byClass && !node->IsA(byClass))
-      {
-      continue;
-      }
     if (byHideFromEditors && node->GetHideFromEditors() != *byHideFromEditors)
       {
       continue;
@@ -1797,23 +1994,14 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNode(const char* byName,
 //------------------------------------------------------------------------------
 vtkMRMLNode* vtkMRMLScene::GetFirstNodeByName(const char* name)
 {
-  vtkMRMLNode *node = 0;
   if (name == 0)
     {
     vtkErrorMacro("GetNodesByName: name is null");
-    return node;
+    return 0;
     }
 
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->GetName() != 0 && !strcmp(node->GetName(), name))
-      {
-      return node;
-      }
-    }
-  return 0;
+  const std::vector<vtkMRMLNode*>& namedNodes = this->GetIndexedNodesByName(name);
+  return namedNodes.empty() ? 0 : namedNodes.front();
 }
 
 //------------------------------------------------------------------------------
@@ -1873,13 +2061,12 @@ vtkCollection* vtkMRMLScene::GetNodesByClassByName(const char* className, const
     return nodes;
     }
 
-  vtkMRMLNode *node;
-  for (int n=0; n < this->Nodes->GetNumberOfItems(); n++)
+  const std::vector<vtkMRMLNode*>& namedNodes = this->GetIndexedNodesByName(name);
+  for (std::vector<vtkMRMLNode*>::const_iterator it = namedNodes.begin(); it != namedNodes.end(); ++it)
     {
-    node = (vtkMRMLNode*)this->Nodes->GetItemAsObject(n);
-    if (!strcmp(node->GetName(), name) && node->IsA(className))
+    if ((*it)->IsA(className))
       {
-      nodes->AddItem(node);
+      nodes->AddItem(*it);
       }
     }
 
@@ -2500,10 +2687,11 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
     return;
     }
 
+  // Bulk data arrays are referenced by the snapshot, not copied.
   vtkMRMLNode *snode = copyNode->CreateNodeInstance();
   if (snode != NULL)
     {
-    snode->CopyWithScene(copyNode);
+    snode->CopyWithSceneSharingBulkData(copyNode);
     }
   vtkCollection* undoScene = dynamic_cast < vtkCollection *>( this->UndoStack.back() );
   int nnodes = undoScene->GetNumberOfItems();
@@ -2532,7 +2720,9 @@ void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
   vtkMRMLNode *snode = copyNode->CreateNodeInstance();
   if (snode != NULL)
     {
-    snode->CopyWithSceneWithSingleModifiedEvent(copyNode);
+    int wasModifying = snode->StartModify();
+    snode->CopyWithSceneSharingBulkData(copyNode);
+    snode->EndModify(wasModifying);
     }
   vtkCollection* undoScene = dynamic_cast < vtkCollection *>( this->RedoStack.back() );
   int nnodes = undoScene->GetNumberOfItems();
@@ -2648,6 +2838,8 @@ void vtkMRMLScene::Undo()
 
   for (nn=0; nn<addNodes.size(); nn++)
     {
+    // the node may be a snapshot, its bulk data must not be shared anymore
+    addNodes[nn]->StopSharingBulkData();
     this->AddNode(addNodes[nn]);
     }
   for (nn=0; nn<removeNodes.size(); nn++)
@@ -2769,6 +2961,8 @@ void vtkMRMLScene::Redo()
 
   for (nn=0; nn<addNodes.size(); nn++)
     {
+    // the node may be a snapshot, its bulk data must not be shared anymore
+    addNodes[nn]->StopSharingBulkData();
     this->AddNode(addNodes[nn]);
     }
   for (nn=0; nn<removeNodes.size(); nn++)
@@ -3133,6 +3327,162 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//-----------------------------------------------------------------------------
+bool vtkMRMLScene::IsNodeIndexUpToDate()const
+{
+  return this->Nodes && this->NodeIndex->MTime != 0
+    && this->NodeIndex->MTime == this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeIndex()
+{
+  if (!this->Nodes || this->IsNodeIndexUpToDate())
+    {
+    return;
+    }
+#ifdef MRMLSCENE_VERBOSE
+  std::cerr << "Recompute node class and name indices..." << std::endl;
+#endif
+  this->NodeIndex->Clear();
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    this->NodeIndex->Positions[node] = this->NodeIndex->NextPosition++;
+    if (node->GetName())
+      {
+      this->NodeIndex->NodesByName[node->GetName()].push_back(node);
+      }
+    }
+  this->NodeIndex->MTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToIndex(vtkMRMLNode* node, bool wasUpToDate)
+{
+  if (!wasUpToDate || !node)
+    {
+    // The indices will be rebuilt at the next query
+    return;
+    }
+  // The node has been appended to the scene, it is appended to the lists too.
+  this->NodeIndex->Positions[node] = this->NodeIndex->NextPosition++;
+  if (node->GetName())
+    {
+    this->NodeIndex->NodesByName[node->GetName()].push_back(node);
+    }
+  std::vector<vtkNodeIndex::NodeListType*>& classLists = this->NodeIndex->GetClassLists(node);
+  for (std::vector<vtkNodeIndex::NodeListType*>::iterator it = classLists.begin();
+       it != classLists.end(); ++it)
+    {
+    (*it)->push_back(node);
+    }
+  this->NodeIndex->MTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromIndex(vtkMRMLNode* node, bool wasUpToDate)
+{
+  if (!wasUpToDate || !node
+      || this->NodeIndex->Positions.find(node) == this->NodeIndex->Positions.end())
+    {
+    // The indices will be rebuilt at the next query
+    this->NodeIndex->MTime = 0;
+    return;
+    }
+  if (node->GetName())
+    {
+    std::map<std::string, vtkNodeIndex::NodeListType>::iterator nameIt =
+      this->NodeIndex->NodesByName.find(node->GetName());
+    if (nameIt != this->NodeIndex->NodesByName.end())
+      {
+      this->NodeIndex->EraseNode(nameIt->second, node);
+      if (nameIt->second.empty())
+        {
+        this->NodeIndex->NodesByName.erase(nameIt);
+        }
+      }
+    }
+  std::vector<vtkNodeIndex::NodeListType*>& classLists = this->NodeIndex->GetClassLists(node);
+  for (std::vector<vtkNodeIndex::NodeListType*>::iterator it = classLists.begin();
+       it != classLists.end(); ++it)
+    {
+    this->NodeIndex->EraseNode(**it, node);
+    }
+  this->NodeIndex->Positions.erase(node);
+  this->NodeIndex->MTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::NodeNameChanged(vtkMRMLNode* node, const char* oldName)
+{
+  if (!this->IsNodeIndexUpToDate()
+      || this->NodeIndex->Positions.find(node) == this->NodeIndex->Positions.end())
+    {
+    // The node is not indexed (yet)
+    return;
+    }
+  if (oldName)
+    {
+    std::map<std::string, vtkNodeIndex::NodeListType>::iterator nameIt =
+      this->NodeIndex->NodesByName.find(oldName);
+    if (nameIt != this->NodeIndex->NodesByName.end())
+      {
+      this->NodeIndex->EraseNode(nameIt->second, node);
+      if (nameIt->second.empty())
+        {
+        this->NodeIndex->NodesByName.erase(nameIt);
+        }
+      }
+    }
+  if (node->GetName())
+    {
+    this->NodeIndex->InsertNode(this->NodeIndex->NodesByName[node->GetName()], node);
+    }
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<vtkMRMLNode*>& vtkMRMLScene::GetIndexedNodesByClass(const char* className)
+{
+  this->UpdateNodeIndex();
+  std::map<std::string, vtkNodeIndex::NodeListType>::iterator classIt =
+    this->NodeIndex->NodesByClass.find(className);
+  if (classIt != this->NodeIndex->NodesByClass.end())
+    {
+    return classIt->second;
+    }
+  // First query of this class, index it.
+  vtkNodeIndex::NodeListType& classNodes = this->NodeIndex->NodesByClass[className];
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    if (node->IsA(className))
+      {
+      classNodes.push_back(node);
+      }
+    }
+  // The cached class lists must now take into account the new class
+  this->NodeIndex->ClassLists.clear();
+  return classNodes;
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<vtkMRMLNode*>& vtkMRMLScene::GetIndexedNodesByName(const char* name)
+{
+  this->UpdateNodeIndex();
+  std::map<std::string, vtkNodeIndex::NodeListType>::iterator nameIt =
+    this->NodeIndex->NodesByName.find(name);
+  if (nameIt == this->NodeIndex->NodesByName.end())
+    {
+    return this->NodeIndex->EmptyList;
+    }
+  return nameIt->second;
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -58,6 +58,9 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   /// so that it can call protected methods, for example UpdateNodeIDs()
   /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// make vtkMRMLNode a friend so that it can notify the scene when its name
+  /// changes (see NodeNameChanged()).
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -280,7 +283,9 @@ public:
   /// Get number of nodes of a specified class in the scene
   int GetNumberOfNodesByClass(const char* className);
 
-  /// Get vector of nodes of a specified class in the scene
+  /// Get vector of nodes of a specified class in the scene.
+  /// The content of \a nodes is replaced (not appended to), in scene order.
+  /// Return the number of nodes.
   int GetNodesByClass(const char *className, std::vector<vtkMRMLNode *> &nodes);
 
   /// \warning You are responsible for deleting the returned collection.
@@ -468,6 +473,18 @@ public:
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
+  /// \brief Number of threads used by Import() to read the data files of
+  /// the imported storable nodes.
+  ///
+  /// If more than 1, the local files are read concurrently by the storage
+  /// nodes (see vtkMRMLStorageNode::PrefetchData()) before the nodes are
+  /// updated. The data is then set in the nodes, and the events are invoked,
+  /// on the calling thread in the same order as for a serial import.
+  /// 1 by default (files are read one after the other).
+  /// \sa Import(), SetReadDataOnLoad()
+  vtkSetClampMacro(NumberOfReadDataThreads,int,1,VTK_INT_MAX);
+  vtkGetMacro(NumberOfReadDataThreads,int);
+
   void SetErrorMessage(const std::string &error);
   std::string GetErrorMessage();
 
@@ -752,6 +769,40 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// \brief Synchronize the class and name indices used to speedup
+  /// GetNodesByClass(), GetNthNodeByClass(), GetNodesByName()... with the
+  /// \a Nodes collection.
+  ///
+  /// The indices are updated incrementally by AddNode() and RemoveNode(). Any
+  /// other change of the \a Nodes collection (e.g. InsertAfterNode()) makes
+  /// the indices out of date, they are then rebuilt at the next query.
+  void UpdateNodeIndex();
+
+  /// Return true if the indices reflect the current \a Nodes collection.
+  bool IsNodeIndexUpToDate()const;
+
+  /// Add node to the class and name indices. Must be called right after the
+  /// node is appended to the \a Nodes collection.
+  /// \a wasUpToDate is the value of IsNodeIndexUpToDate() before the node was
+  /// appended.
+  void AddNodeToIndex(vtkMRMLNode* node, bool wasUpToDate);
+
+  /// Remove node from the class and name indices. Must be called right after
+  /// the node is removed from the \a Nodes collection.
+  void RemoveNodeFromIndex(vtkMRMLNode* node, bool wasUpToDate);
+
+  /// Called by vtkMRMLNode::SetName() to keep the name index up to date.
+  void NodeNameChanged(vtkMRMLNode* node, const char* oldName);
+
+  /// Return the nodes that are of class \a className (or of a subclass) in
+  /// the scene order.
+  /// The list is computed at the first query of the class and updated
+  /// incrementally after that.
+  const std::vector<vtkMRMLNode*>& GetIndexedNodesByClass(const char* className);
+
+  /// Return the nodes named \a name in the scene order.
+  const std::vector<vtkMRMLNode*>& GetIndexedNodesByName(const char* name);
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
@@ -802,10 +853,21 @@ protected:
 
   int ReadDataOnLoad;
 
+  int NumberOfReadDataThreads;
+
   vtkMTimeType  NodeIDsMTime;
 
+  class vtkNodeIndex;
+  vtkNodeIndex* NodeIndex;
+
   void RemoveAllNodes(bool removeSingletons);
 
+  /// Read the data files of the storable nodes in \a nodes on
+  /// NumberOfReadDataThreads threads, ahead of UpdateScene().
+  /// The storage nodes that read data are added to \a storageNodes.
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  void PrefetchStorableNodesData(vtkCollection* nodes, vtkCollection* storageNodes);
+
   char * Version;
   char * LastLoadedVersion;
 
@@ -274,6 +274,11 @@ void vtkMRMLStorableNode::UpdateScene(vtkMRMLScene *scene)
     {
     return;
     }
+  // The data is read later, not reading it now is not an error
+  if (scene && scene->GetReadDataOnLoad() == 0)
+    {
+    return;
+    }
 
   int numStorageNodes = this->GetNumberOfNodeReferences(this->GetStorageNodeReferenceRole());
 
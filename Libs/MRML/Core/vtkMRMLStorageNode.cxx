@@ -22,7 +22,10 @@ Version:   $Revision: 1.1.1.1 $
 #include "vtkMRMLScene.h"
 
 // VTK includes
+#include <vtkAlgorithm.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCommand.h>
+#include <vtkErrorCode.h>
 #include <vtkNew.h>
 #include <vtkStringArray.h>
 #include <vtkURIHandler.h>
@@ -1198,6 +1201,123 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
   return res;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+// Record errors of a prefetch reader instead of displaying them, as the file
+// is read again by ReadData if prefetching fails
+void PrefetchReaderErrorCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                                 void* clientData, void* vtkNotUsed(callData))
+{
+  bool* errorOccurred = static_cast<bool*>(clientData);
+  *errorOccurred = true;
+}
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::PrefetchData(vtkMRMLNode* refNode)
+{
+  this->ClearPrefetchedData();
+  if (!this->ReadPrefetchData(refNode))
+    {
+    return 0;
+    }
+  this->SetPrefetchedDataNode(refNode);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::ReadPrefetchData(vtkMRMLNode* refNode)
+{
+  // The weak pointer to the node is not modified here: it is not thread safe
+  this->PrefetchedReader = NULL;
+  this->PrefetchedReaderFileName.clear();
+
+  if (refNode == NULL || !refNode->GetAddToScene())
+    {
+    return 0;
+    }
+  if (this->GetScene() && this->GetScene()->GetReadDataOnLoad() == 0)
+    {
+    return 0;
+    }
+  // Remote files are downloaded by ReadData
+  if (this->GetFileName() == NULL || this->GetURI() != NULL)
+    {
+    return 0;
+    }
+  if (!this->CanReadInReferenceNode(refNode))
+    {
+    return 0;
+    }
+
+  vtkSmartPointer<vtkAlgorithm> reader;
+  reader.TakeReference(this->InstantiatePrefetchReader(refNode));
+  if (reader.GetPointer() == NULL)
+    {
+    return 0;
+    }
+
+  bool errorOccurred = false;
+  vtkNew<vtkCallbackCommand> errorCallback;
+  errorCallback->SetCallback(PrefetchReaderErrorCallback);
+  errorCallback->SetClientData(&errorOccurred);
+  reader->AddObserver(vtkCommand::ErrorEvent, errorCallback.GetPointer());
+  try
+    {
+    reader->Update();
+    }
+  catch (...)
+    {
+    errorOccurred = true;
+    }
+  reader->RemoveObserver(errorCallback.GetPointer());
+  if (errorOccurred || reader->GetErrorCode() != vtkErrorCode::NoError)
+    {
+    return 0;
+    }
+
+  this->PrefetchedReader = reader;
+  this->PrefetchedReaderFileName = this->GetFullNameFromFileName();
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::SetPrefetchedDataNode(vtkMRMLNode* refNode)
+{
+  this->PrefetchedReaderNode = refNode;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::ClearPrefetchedData()
+{
+  this->PrefetchedReader = NULL;
+  this->PrefetchedReaderNode = NULL;
+  this->PrefetchedReaderFileName.clear();
+}
+
+//------------------------------------------------------------------------------
+vtkAlgorithm* vtkMRMLStorageNode::InstantiatePrefetchReader(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer<vtkAlgorithm> vtkMRMLStorageNode::TakePrefetchedReader(vtkMRMLNode* refNode)
+{
+  vtkSmartPointer<vtkAlgorithm> reader;
+  if (this->PrefetchedReader.GetPointer() != NULL
+      && this->PrefetchedReaderNode.GetPointer() != NULL
+      && this->PrefetchedReaderNode.GetPointer() == refNode
+      && this->PrefetchedReaderFileName == this->GetFullNameFromFileName())
+    {
+    reader = this->PrefetchedReader;
+    }
+  this->ClearPrefetchedData();
+  return reader;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
 {
@@ -20,6 +20,9 @@
 class vtkURIHandler;
 
 // VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+class vtkAlgorithm;
 class vtkStringArray;
 
 // STD includes
@@ -51,6 +54,35 @@ public:
   /// \sa SetFileName(), ReadDataInternal(), GetStoredTime()
   virtual int ReadData(vtkMRMLNode *refNode, bool temporaryFile = false);
 
+  /// Read the file content from \a FileName into memory, without modifying
+  /// the referenced node, the scene or this node and without invoking events.
+  /// The data is used by the next ReadData() call for the same referenced node
+  /// and file name, instead of reading the file again.
+  /// Same as ReadPrefetchData() followed by SetPrefetchedDataNode(), it must
+  /// be called on the main thread.
+  /// Only local files of storage nodes that implement
+  /// InstantiatePrefetchReader() can be prefetched.
+  /// Return 1 on success, 0 if the data could not be prefetched. In that case
+  /// ReadData() reads the file as usual, and reports the errors.
+  /// \sa ReadData(), ClearPrefetchedData(), vtkMRMLScene::SetNumberOfReadDataThreads()
+  int PrefetchData(vtkMRMLNode *refNode);
+
+  /// Read the file content for \a refNode into memory, as PrefetchData(),
+  /// without associating it to \a refNode: ReadData() uses the data only
+  /// after SetPrefetchedDataNode() is called.
+  /// It is thread safe to call ReadPrefetchData on different storage nodes at
+  /// the same time, which is how the scene reads the data of the nodes
+  /// concurrently during import. ClearPrefetchedData() and
+  /// SetPrefetchedDataNode() must be called on the main thread, before and
+  /// after the concurrent reading.
+  int ReadPrefetchData(vtkMRMLNode *refNode);
+
+  /// Associate the data read by ReadPrefetchData() to \a refNode.
+  void SetPrefetchedDataNode(vtkMRMLNode *refNode);
+
+  /// Release the data read by PrefetchData() that has not been used by ReadData().
+  void ClearPrefetchedData();
+
   ///
   /// Write data from a  referenced node
   /// Return 1 on success, 0 on failure.
@@ -318,6 +350,20 @@ protected:
   /// To be reimplemented in subclass.
   virtual int WriteDataInternal(vtkMRMLNode* refNode);
 
+  /// Create and set up the reader that ReadDataInternal() would use to read
+  /// the file for the referenced node, without updating it.
+  /// Must not modify the referenced node or this node, as it may be called
+  /// from a worker thread. The caller owns the returned reader.
+  /// Returns NULL by default (prefetching not supported).
+  /// To be reimplemented in subclass.
+  /// \sa PrefetchData(), TakePrefetchedReader()
+  virtual vtkAlgorithm* InstantiatePrefetchReader(vtkMRMLNode* refNode);
+
+  /// Return the reader updated by PrefetchData() for the referenced node and
+  /// the current file name, NULL if there is none.
+  /// To be called by ReadDataInternal(). The prefetched data is released.
+  vtkSmartPointer<vtkAlgorithm> TakePrefetchedReader(vtkMRMLNode* refNode);
+
   ///
   /// If the URI is not null, fetch it and save it to the node's FileName location or
   /// load directly into the reference node.
@@ -363,6 +409,12 @@ protected:
   /// Can be reset with InvalidateFile.
   /// \sa InvalidateFile
   vtkTimeStamp* StoredTime;
+
+  /// Reader updated by PrefetchData(), with the node and the full file name
+  /// it was updated for
+  vtkSmartPointer<vtkAlgorithm> PrefetchedReader;
+  vtkWeakPointer<vtkMRMLNode> PrefetchedReaderNode;
+  std::string PrefetchedReaderFileName;
 };
 
 #endif
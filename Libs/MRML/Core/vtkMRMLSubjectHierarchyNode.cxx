@@ -107,6 +107,21 @@ public:
   /// It can be static as the item IDs are unique in one application session.
   static std::map<vtkIdType, vtkSubjectHierarchyItem*> ItemCache;
 
+  /// Items in the lookup caches below, in the order they were added to the cache.
+  /// The caches contain the items of all the trees, lookup functions only return
+  /// the items that are in the branch they are called on.
+  typedef std::vector<vtkSubjectHierarchyItem*> CachedItemVector;
+  /// Cache to speed up lookup by data node
+  static std::map<vtkMRMLNode*, CachedItemVector> DataNodeItemCache;
+  /// Cache to speed up lookup by UID name and value (exact match)
+  static std::map<std::pair<std::string, std::string>, CachedItemVector> UIDItemCache;
+  /// Cache to speed up lookup by UID name and any of the UIDs in the value
+  /// (e.g. instance UIDs, separated by spaces)
+  static std::map<std::pair<std::string, std::string>, CachedItemVector> UIDListItemCache;
+  /// Data node the item is cached with. The data node member is a weak pointer,
+  /// so it may be reset before the item is removed from the cache.
+  vtkMRMLNode* CachedDataNode;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -168,7 +183,8 @@ public:
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
   /// \return Item if found, NULL otherwise
   vtkSubjectHierarchyItem* FindChildByUID(std::string uidName, std::string uidValue, bool recursive=true);
-  /// Find child by UID list (containing). For example find UID in instance UID list
+  /// Find child by UID list (containing). For example find UID in instance UID list.
+  /// The list is split at spaces, and the UID needs to match one of the list elements
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
   /// \return Item if found, NULL otherwise
   vtkSubjectHierarchyItem* FindChildByUIDList(std::string uidName, std::string uidValue, bool recursive=true);
@@ -214,6 +230,21 @@ public:
   void ReparentChildrenToParent();
   /// Remove all children. Do not delete data nodes from the scene. Used in destructor, and for deleting virtual branches
   void RemoveAllChildren();
+  /// Add item to the data node and UID lookup caches. Called when the item is added to the tree
+  void AddToLookupCaches();
+  /// Remove item from the data node and UID lookup caches. Called when the item is removed from the tree
+  void RemoveFromLookupCaches();
+  /// Add a UID of the item to the UID lookup caches
+  void AddUIDToLookupCaches(const std::string& uidName, const std::string& uidValue);
+  /// Remove a UID of the item from the UID lookup caches
+  void RemoveUIDFromLookupCaches(const std::string& uidName, const std::string& uidValue);
+  /// Get first item from the cached items that is a child of this item
+  /// \param recursive Flag whether to accept only direct children (false) or any item in the branch (true)
+  /// \param dataNode If specified, then only items associated to this data node are accepted
+  vtkSubjectHierarchyItem* FindChildInCachedItems(const CachedItemVector& cachedItems, bool recursive, vtkMRMLNode* dataNode=NULL);
+  /// Determine whether the item is in the ID cache, i.e. it is in a tree and not a scene or unresolved item
+  bool IsCached();
+
   /// Remove all observers from item and its data node if any
   //void RemoveAllObservers(); //TODO: Needed? (the callback object belongs to the SH node so introduction of a new member would be needed)
 
@@ -248,6 +279,34 @@ vtkStandardNewMacro(vtkSubjectHierarchyItem);
 vtkIdType vtkSubjectHierarchyItem::NextSubjectHierarchyItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID + 1;
 
 std::map<vtkIdType, vtkSubjectHierarchyItem*> vtkSubjectHierarchyItem::ItemCache = std::map<vtkIdType, vtkSubjectHierarchyItem*>();
+std::map<vtkMRMLNode*, vtkSubjectHierarchyItem::CachedItemVector> vtkSubjectHierarchyItem::DataNodeItemCache;
+std::map<std::pair<std::string, std::string>, vtkSubjectHierarchyItem::CachedItemVector> vtkSubjectHierarchyItem::UIDItemCache;
+std::map<std::pair<std::string, std::string>, vtkSubjectHierarchyItem::CachedItemVector> vtkSubjectHierarchyItem::UIDListItemCache;
+
+namespace
+{
+//---------------------------------------------------------------------------
+template<class Key>
+void RemoveItemFromCache(std::map<Key, vtkSubjectHierarchyItem::CachedItemVector>& cache,
+                         const Key& key, vtkSubjectHierarchyItem* item)
+{
+  typename std::map<Key, vtkSubjectHierarchyItem::CachedItemVector>::iterator cacheIt = cache.find(key);
+  if (cacheIt == cache.end())
+    {
+    return;
+    }
+  vtkSubjectHierarchyItem::CachedItemVector& items = cacheIt->second;
+  vtkSubjectHierarchyItem::CachedItemVector::iterator itemIt = std::find(items.begin(), items.end(), item);
+  if (itemIt != items.end())
+    {
+    items.erase(itemIt);
+    }
+  if (items.empty())
+    {
+    cache.erase(cacheIt);
+    }
+}
+}
 
 //---------------------------------------------------------------------------
 // vtkSubjectHierarchyItem methods
@@ -263,6 +322,7 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
   , TemporaryID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
   , TemporaryDataNodeID("")
   , TemporaryParentItemID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  , CachedDataNode(NULL)
 {
   this->Children.clear();
   this->Attributes.clear();
@@ -301,8 +361,9 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
     vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
     this->Parent->Children.push_back(childPointer);
 
-    // Add to cache
+    // Add to caches
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    this->AddToLookupCaches();
     }
   else
     {
@@ -338,8 +399,9 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
     vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
     this->Parent->Children.push_back(childPointer);
 
-    // Add to cache
+    // Add to caches
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    this->AddToLookupCaches();
     }
   else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
             || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
@@ -737,24 +799,12 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByDataNode(vtkMRMLNod
     return NULL;
     }
 
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  std::map<vtkMRMLNode*, CachedItemVector>::iterator cacheIt = vtkSubjectHierarchyItem::DataNodeItemCache.find(dataNode);
+  if (cacheIt == vtkSubjectHierarchyItem::DataNodeItemCache.end())
     {
-    vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (dataNode == currentItem->DataNode.GetPointer())
-      {
-      return currentItem;
-      }
-    if (recursive)
-      {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByDataNode(dataNode);
-      if (foundItemInBranch)
-        {
-        return foundItemInBranch;
-        }
-      }
+    return NULL;
     }
-  return NULL;
+  return this->FindChildInCachedItems(cacheIt->second, recursive, dataNode);
 }
 
 //---------------------------------------------------------------------------
@@ -764,24 +814,14 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
     {
     return NULL;
     }
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+
+  std::map<std::pair<std::string, std::string>, CachedItemVector>::iterator cacheIt =
+    vtkSubjectHierarchyItem::UIDItemCache.find(std::make_pair(uidName, uidValue));
+  if (cacheIt == vtkSubjectHierarchyItem::UIDItemCache.end())
     {
-    vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (!currentItem->GetUID(uidName).compare(uidValue))
-      {
-      return currentItem;
-      }
-    if (recursive)
-      {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUID(uidName, uidValue);
-      if (foundItemInBranch)
-        {
-        return foundItemInBranch;
-        }
-      }
+    return NULL;
     }
-  return NULL;
+  return this->FindChildInCachedItems(cacheIt->second, recursive);
 }
 
 //---------------------------------------------------------------------------
@@ -791,20 +831,42 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
     {
     return NULL;
     }
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+
+  std::map<std::pair<std::string, std::string>, CachedItemVector>::iterator cacheIt =
+    vtkSubjectHierarchyItem::UIDListItemCache.find(std::make_pair(uidName, uidValue));
+  if (cacheIt == vtkSubjectHierarchyItem::UIDListItemCache.end())
     {
-    vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (currentItem->GetUID(uidName).find(uidValue) != std::string::npos)
+    return NULL;
+    }
+  return this->FindChildInCachedItems(cacheIt->second, recursive);
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildInCachedItems(
+  const CachedItemVector& cachedItems, bool recursive, vtkMRMLNode* dataNode/*=NULL*/)
+{
+  for (CachedItemVector::const_iterator itemIt=cachedItems.begin(); itemIt!=cachedItems.end(); ++itemIt)
+    {
+    vtkSubjectHierarchyItem* currentItem = (*itemIt);
+    if (dataNode && currentItem->DataNode.GetPointer() != dataNode)
       {
-      return currentItem;
+      // Data node of the item was deleted, and a new node was created at the same address
+      continue;
       }
-    if (recursive)
+    if (!recursive)
       {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUIDList(uidName, uidValue);
-      if (foundItemInBranch)
+      if (currentItem->Parent == this)
         {
-        return foundItemInBranch;
+        return currentItem;
+        }
+      continue;
+      }
+    // Accept the item if this item is among its ancestors
+    for (vtkSubjectHierarchyItem* ancestorItem = currentItem->Parent; ancestorItem; ancestorItem = ancestorItem->Parent)
+      {
+      if (ancestorItem == this)
+        {
+        return currentItem;
         }
       }
     }
@@ -1105,7 +1167,8 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
   removedItem->ReparentChildrenToParent();
 
-  // Remove from cache
+  // Remove from caches
+  removedItem->RemoveFromLookupCaches();
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
 
   // Invoke events
@@ -1149,7 +1212,8 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
   removedItem->ReparentChildrenToParent();
 
-  // Remove from cache
+  // Remove from caches
+  removedItem->RemoveFromLookupCaches();
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
 
   // Invoke events
@@ -1237,24 +1301,113 @@ void vtkSubjectHierarchyItem::RemoveAllChildren()
 //    }
 //}
 
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::IsCached()
+{
+  std::map<vtkIdType, vtkSubjectHierarchyItem*>::iterator itemIt = vtkSubjectHierarchyItem::ItemCache.find(this->ID);
+  return (itemIt != vtkSubjectHierarchyItem::ItemCache.end() && itemIt->second == this);
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddToLookupCaches()
+{
+  this->CachedDataNode = this->DataNode.GetPointer();
+  if (this->CachedDataNode)
+    {
+    vtkSubjectHierarchyItem::DataNodeItemCache[this->CachedDataNode].push_back(this);
+    }
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+    {
+    this->AddUIDToLookupCaches(uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveFromLookupCaches()
+{
+  if (this->CachedDataNode)
+    {
+    RemoveItemFromCache(vtkSubjectHierarchyItem::DataNodeItemCache, this->CachedDataNode, this);
+    this->CachedDataNode = NULL;
+    }
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+    {
+    this->RemoveUIDFromLookupCaches(uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddUIDToLookupCaches(const std::string& uidName, const std::string& uidValue)
+{
+  if (uidName.empty() || uidValue.empty())
+    {
+    return;
+    }
+  vtkSubjectHierarchyItem::UIDItemCache[std::make_pair(uidName, uidValue)].push_back(this);
+
+  std::vector<std::string> uidList;
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidList);
+  for (std::vector<std::string>::iterator listIt = uidList.begin(); listIt != uidList.end(); ++listIt)
+    {
+    if (listIt->empty())
+      {
+      continue;
+      }
+    CachedItemVector& items = vtkSubjectHierarchyItem::UIDListItemCache[std::make_pair(uidName, *listIt)];
+    // The same UID may be listed multiple times
+    if (items.empty() || items.back() != this)
+      {
+      items.push_back(this);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveUIDFromLookupCaches(const std::string& uidName, const std::string& uidValue)
+{
+  if (uidName.empty() || uidValue.empty())
+    {
+    return;
+    }
+  RemoveItemFromCache(vtkSubjectHierarchyItem::UIDItemCache, std::make_pair(uidName, uidValue), this);
+
+  std::vector<std::string> uidList;
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidList);
+  for (std::vector<std::string>::iterator listIt = uidList.begin(); listIt != uidList.end(); ++listIt)
+    {
+    RemoveItemFromCache(vtkSubjectHierarchyItem::UIDListItemCache, std::make_pair(uidName, *listIt), this);
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
 {
+  bool cached = this->IsCached();
+
   // Use the find function to prevent adding an empty UID to the map
-  if (this->UIDs.find(uidName) != this->UIDs.end())
+  std::map<std::string, std::string>::iterator uidIt = this->UIDs.find(uidName);
+  if (uidIt != this->UIDs.end())
     {
     // Log warning if the new UID value is different than the one already set
-    if (this->UIDs[uidName].compare(uidValue))
+    if (uidIt->second.compare(uidValue))
       {
       vtkWarningMacro( "SetUID: UID with name '" << uidName << "' already exists in subject hierarchy item '" << this->GetName()
-        << "' with value '" << this->UIDs[uidName] << "'. Replacing it with value '" << uidValue << "'" );
+        << "' with value '" << uidIt->second << "'. Replacing it with value '" << uidValue << "'" );
       }
     else
       {
       return; // Do nothing if the UID values match
       }
+    if (cached)
+      {
+      this->RemoveUIDFromLookupCaches(uidName, uidIt->second);
+      }
     }
   this->UIDs[uidName] = uidValue;
+  if (cached)
+    {
+    this->AddUIDToLookupCaches(uidName, uidValue);
+    }
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -253,8 +253,9 @@ public:
 
   /// Find subject hierarchy item according to a UID (by containing). For example find UID in instance UID list
   /// \param uidName UID string to lookup
-  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item
-  /// \return First match
+  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item,
+  ///   as one of the elements of the space-separated UID list
+  /// \return First match (the first item the UID was set to)
   /// \sa GetUID()
   vtkIdType GetItemByUIDList(const char* uidName, const char* uidValue);
 
@@ -256,6 +256,68 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
 }
 } // end of anonymous namespace
 
+//----------------------------------------------------------------------------
+vtkITKArchetypeImageSeriesReader* vtkMRMLVolumeArchetypeStorageNode::InstantiateReader(
+  vtkMRMLNode* refNode, const std::string& fullName)
+{
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+
+  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
+    {
+    reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
+    }
+  else if (refNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+    {
+    reader = vtkSmartPointer<vtkITKArchetypeDiffusionTensorImageReaderFile>::New();
+    reader->SetSingleFile( this->GetSingleFile() );
+    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    }
+  else
+    {
+    reader = vtkSmartPointer<vtkITKArchetypeImageSeriesScalarReader>::New();
+    reader->SetSingleFile( this->GetSingleFile() );
+    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    }
+
+  if (reader.GetPointer() == NULL)
+    {
+    return NULL;
+    }
+
+  // Set the list of file names on the reader
+  reader->ResetFileNames();
+  reader->SetArchetype(fullName.c_str());
+
+  // Workaround
+  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
+
+  // Center image
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  if (this->CenterImage)
+    {
+    reader->SetUseNativeOriginOff();
+    }
+  else
+    {
+    reader->SetUseNativeOriginOn();
+    }
+
+  reader->Register(NULL);
+  return reader;
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithm* vtkMRMLVolumeArchetypeStorageNode::InstantiatePrefetchReader(vtkMRMLNode* refNode)
+{
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty() || vtkMRMLScalarVolumeNode::SafeDownCast(refNode) == NULL)
+    {
+    return NULL;
+    }
+  return this->InstantiateReader(refNode, fullName);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -291,23 +353,13 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
-
-  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
-    {
-    reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
-    }
-  else if (refNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
-    {
-    reader = vtkSmartPointer<vtkITKArchetypeDiffusionTensorImageReaderFile>::New();
-    reader->SetSingleFile( this->GetSingleFile() );
-    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
-    }
-  else
+  // The file may have already been read by PrefetchData()
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader =
+    vtkITKArchetypeImageSeriesReader::SafeDownCast(this->TakePrefetchedReader(refNode));
+  bool prefetched = (reader.GetPointer() != NULL);
+  if (!prefetched)
     {
-    reader = vtkSmartPointer<vtkITKArchetypeImageSeriesScalarReader>::New();
-    reader->SetSingleFile( this->GetSingleFile() );
-    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    reader.TakeReference(this->InstantiateReader(refNode, fullName));
     }
 
   if (reader.GetPointer() == NULL)
@@ -316,50 +368,33 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
-
   if (volNode->GetImageData())
     {
     volNode->SetAndObserveImageData(NULL);
     }
 
-  // Set the list of file names on the reader
-  reader->ResetFileNames();
-  reader->SetArchetype(fullName.c_str());
-
-  // Workaround
-  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
-
-  // Center image
-  reader->SetOutputScalarTypeToNative();
-  reader->SetDesiredCoordinateOrientationToNative();
-  if (this->CenterImage)
-    {
-    reader->SetUseNativeOriginOff();
-    }
-  else
-    {
-    reader->SetUseNativeOriginOn();
-    }
-
   bool readingWorked = true;
   std::string errorMessage = "";
-  try
+  if (!prefetched)
     {
-    vtkDebugMacro("ReadData: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
-    reader->Update();
-    if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
+    try
+      {
+      vtkDebugMacro("ReadData: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
+      reader->Update();
+      if (reader->GetErrorCode() != vtkErrorCode::NoError)
+        {
+        readingWorked = false;
+        errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
+        }
+      }
+    catch (itk::ExceptionObject& e)
       {
       readingWorked = false;
-      errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
+      errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
+                                                  + e.GetDescription() + "\n";
       }
     }
-  catch (itk::ExceptionObject& e)
-    {
-    readingWorked = false;
-    errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
-                                                + e.GetDescription() + "\n";
-    }
   if (!readingWorked)
     {
     std::string reader0thFileName;
@@ -101,6 +101,13 @@ protected:
 
   vtkITKArchetypeImageSeriesReader* InstantiateVectorVolumeReader(const std::string &fullName);
 
+  /// Create the reader of the archetype file for the referenced node,
+  /// ready to be updated. The caller owns the returned reader.
+  vtkITKArchetypeImageSeriesReader* InstantiateReader(vtkMRMLNode* refNode, const std::string &fullName);
+
+  /// Read the archetype file ahead of ReadDataInternal(), see PrefetchData()
+  virtual vtkAlgorithm* InstantiatePrefetchReader(vtkMRMLNode* refNode) VTK_OVERRIDE;
+
   /// Read data and set it in the referenced node
   virtual int ReadDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
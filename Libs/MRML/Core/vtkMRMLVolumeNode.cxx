@@ -193,7 +193,21 @@ void vtkMRMLVolumeNode::Copy(vtkMRMLNode *anode)
     // Only copy bulk data if it exists - this handles the case
     // of restoring from SceneViews, where the nodes will not
     // have bulk data.
-    this->SetImageDataConnection(node->GetImageDataConnection());
+    if (this->SharesBulkData)
+      {
+      // Snapshot: read-only shallow copy of the image data, see
+      // StartBulkDataModify()
+      this->SetAndObserveBulkData(node->GetSharedBulkDataCopy());
+      }
+    else if (node->SharesBulkData)
+      {
+      // Restore from a snapshot
+      this->CopySharedBulkData(node);
+      }
+    else
+      {
+      this->SetImageDataConnection(node->GetImageDataConnection());
+      }
     }
 
   anode->SetDisableModifiedEvent(amode);
@@ -708,6 +722,7 @@ void vtkMRMLVolumeNode::SetAndObserveImageData(vtkImageData *imageData)
       oldProducer->GetOutputDataObject(0)->RemoveObservers(
         vtkCommand::ModifiedEvent, this->DataEventForwarder);
       }
+    this->ReleaseSharedBulkData();
     this->SetImageDataConnection(0);
     }
   else
@@ -733,6 +748,8 @@ void vtkMRMLVolumeNode::SetAndObserveImageData(vtkImageData *imageData)
       }
     this->DataEventForwarder->SetTarget(tp.GetPointer());
     imageData->AddObserver(vtkCommand::ModifiedEvent, this->DataEventForwarder);
+    // the undo snapshots keep the arrays of the previous image data
+    this->ReleaseSharedBulkData();
     this->SetImageDataConnection(tp->GetOutputPort());
     }
 }
@@ -805,9 +822,26 @@ void vtkMRMLVolumeNode
 ::SetImageDataToDisplayNode(vtkMRMLVolumeDisplayNode* volumeDisplayNode)
 {
   assert(volumeDisplayNode);
+  if (this->SharesBulkData)
+    {
+    // the display nodes belong to the node the snapshot was made from
+    return;
+    }
   volumeDisplayNode->SetInputImageDataConnection(this->GetImageDataConnection());
 }
 
+//----------------------------------------------------------------------------
+vtkDataObject* vtkMRMLVolumeNode::GetBulkData()
+{
+  return this->GetImageData();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeNode::SetAndObserveBulkData(vtkDataObject* data)
+{
+  this->SetAndObserveImageData(vtkImageData::SafeDownCast(data));
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeNode::OnNodeReferenceAdded(vtkMRMLNodeReference *reference)
 {
@@ -828,7 +862,7 @@ void vtkMRMLVolumeNode::UpdateDisplayNodeImageData(vtkMRMLDisplayNode* dNode)
   vtkMRMLVolumeDisplayNode* vNode = vtkMRMLVolumeDisplayNode::SafeDownCast(dNode);
   if (vNode)
     {
-    vNode->SetInputImageDataConnection(this->ImageDataConnection);
+    this->SetImageDataToDisplayNode(vNode);
     }
 }
 
@@ -21,6 +21,7 @@ class vtkMRMLVolumeDisplayNode;
 
 // VTK includes
 class vtkAlgorithmOutput;
+class vtkDataObject;
 class vtkEventForwarderCommand;
 class vtkImageData;
 class vtkMatrix4x4;
@@ -221,6 +222,10 @@ protected:
   void SetImageDataToDisplayNodes();
   void SetImageDataToDisplayNode(vtkMRMLVolumeDisplayNode* displayNode);
 
+  /// The image data is the bulk data of the node.
+  virtual vtkDataObject* GetBulkData() VTK_OVERRIDE;
+  virtual void SetAndObserveBulkData(vtkDataObject* data) VTK_OVERRIDE;
+
   /// Called when a display node is added/removed/modified. Propagate the polydata
   /// to the new display node.
   virtual void UpdateDisplayNodeImageData(vtkMRMLDisplayNode *dnode);
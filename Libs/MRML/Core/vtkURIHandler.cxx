@@ -111,6 +111,30 @@ void vtkURIHandler::StageFileWrite ( const char * vtkNotUsed( source ), const ch
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkURIHandler::StageFileRead ( const char * source, const char * destination,
+                                    vtkDataTransfer* vtkNotUsed( transfer ) )
+{
+  this->StageFileRead ( source, destination );
+}
+
+//----------------------------------------------------------------------------
+int vtkURIHandler::StageFilesRead ( const std::vector<std::string>& sources,
+                                    const std::vector<std::string>& destinations )
+{
+  if ( sources.size() != destinations.size() )
+    {
+    vtkErrorMacro("StageFilesRead: " << sources.size() << " sources for "
+                  << destinations.size() << " destinations");
+    return static_cast<int>(sources.size());
+    }
+  for ( size_t i = 0; i < sources.size(); ++i )
+    {
+    this->StageFileRead ( sources[i].c_str(), destinations[i].c_str() );
+    }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkURIHandler::StageFileRead(const char * vtkNotUsed( source ),
                              const char * vtkNotUsed( destination ),
@@ -3,11 +3,16 @@
 
 // MRML includes
 #include "vtkMRML.h"
+class vtkDataTransfer;
 class vtkPermissionPrompter;
 
 // VTK includes
 #include <vtkObject.h>
 
+// STD includes
+#include <string>
+#include <vector>
+
 class VTK_MRML_EXPORT vtkURIHandler : public vtkObject
 {
 public:
@@ -26,6 +31,20 @@ public:
   virtual void StageFileRead ( const char *source, const char * destination );
   virtual void StageFileWrite ( const char *source, const char * destination );
 
+  ///
+  /// Read a file and report its progress into \a transfer. Handlers that
+  /// support progress reporting and cancellation should reimplement this
+  /// method, by default the transfer is ignored.
+  virtual void StageFileRead ( const char *source, const char * destination,
+                               vtkDataTransfer* transfer );
+
+  ///
+  /// Read several files at once. Handlers that can run concurrent transfers
+  /// should reimplement this method, by default files are read one after the other.
+  /// Returns the number of files that could not be read.
+  virtual int StageFilesRead ( const std::vector<std::string>& sources,
+                               const std::vector<std::string>& destinations );
+
   ///
   /// various Read/Write method footprints useful to redefine in specific handlers.
   virtual void StageFileRead(const char * source,
@@ -0,0 +1,209 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkExtractPlaneCrossingCells.h>
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkAppendFilter.h>
+#include <vtkCutter.h>
+#include <vtkElevationFilter.h>
+#include <vtkIdList.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtkUnstructuredGrid.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int compareContours(vtkPolyData* expected, vtkPolyData* actual)
+{
+  CHECK_INT(static_cast<int>(actual->GetNumberOfPoints()), static_cast<int>(expected->GetNumberOfPoints()));
+  CHECK_INT(static_cast<int>(actual->GetNumberOfCells()), static_cast<int>(expected->GetNumberOfCells()));
+  for (vtkIdType pointId = 0; pointId < expected->GetNumberOfPoints(); ++pointId)
+    {
+    double expectedPoint[3];
+    double actualPoint[3];
+    expected->GetPoint(pointId, expectedPoint);
+    actual->GetPoint(pointId, actualPoint);
+    CHECK_BOOL(expectedPoint[0] == actualPoint[0]
+      && expectedPoint[1] == actualPoint[1]
+      && expectedPoint[2] == actualPoint[2], true);
+    }
+  vtkDataArray* expectedScalars = expected->GetPointData()->GetScalars();
+  vtkDataArray* actualScalars = actual->GetPointData()->GetScalars();
+  CHECK_BOOL(expectedScalars != NULL, actualScalars != NULL);
+  for (vtkIdType pointId = 0; expectedScalars && pointId < expected->GetNumberOfPoints(); ++pointId)
+    {
+    CHECK_DOUBLE(actualScalars->GetTuple1(pointId), expectedScalars->GetTuple1(pointId));
+    }
+  for (vtkIdType cellId = 0; cellId < expected->GetNumberOfCells(); ++cellId)
+    {
+    vtkNew<vtkIdList> expectedIds;
+    vtkNew<vtkIdList> actualIds;
+    expected->GetCellPoints(cellId, expectedIds.GetPointer());
+    actual->GetCellPoints(cellId, actualIds.GetPointer());
+    CHECK_INT(static_cast<int>(actualIds->GetNumberOfIds()), static_cast<int>(expectedIds->GetNumberOfIds()));
+    for (vtkIdType i = 0; i < expectedIds->GetNumberOfIds(); ++i)
+      {
+      CHECK_INT(static_cast<int>(actualIds->GetId(i)), static_cast<int>(expectedIds->GetId(i)));
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testIdenticalContours(vtkAlgorithmOutput* meshPort)
+{
+  vtkNew<vtkPlane> plane;
+
+  vtkNew<vtkCutter> cutter;
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetGenerateCutScalars(0);
+  cutter->SetInputConnection(meshPort);
+
+  vtkNew<vtkExtractPlaneCrossingCells> culler;
+  culler->SetPlane(plane.GetPointer());
+  culler->SetInputConnection(meshPort);
+  vtkNew<vtkCutter> culledCutter;
+  culledCutter->SetCutFunction(plane.GetPointer());
+  culledCutter->SetGenerateCutScalars(0);
+  culledCutter->SetInputConnection(culler->GetOutputPort());
+
+  const double normals[][3] = {{0., 0., 1.}, {0.3, -0.2, 0.9}};
+  for (int n = 0; n < 2; ++n)
+    {
+    plane->SetNormal(normals[n][0], normals[n][1], normals[n][2]);
+    for (double offset = -60.; offset <= 60.; offset += 7.5)
+      {
+      plane->SetOrigin(0., 0., offset);
+      cutter->Update();
+      culledCutter->Update();
+      CHECK_EXIT_SUCCESS(compareContours(cutter->GetOutput(), culledCutter->GetOutput()));
+      }
+    // Moving the plane along its normal reuses the index
+    CHECK_INT(culler->GetNumberOfIndexBuilds(), n + 1);
+    }
+
+  // The plane touching a vertex of the mesh
+  plane->SetNormal(0., 0., 1.);
+  plane->SetOrigin(0., 0., 50.);
+  cutter->Update();
+  culledCutter->Update();
+  CHECK_EXIT_SUCCESS(compareContours(cutter->GetOutput(), culledCutter->GetOutput()));
+  CHECK_INT(culler->GetNumberOfIndexBuilds(), 3);
+
+  // Only the crossing cells are kept
+  vtkPointSet* culledMesh = vtkPointSet::SafeDownCast(culler->GetOutputDataObject(0));
+  vtkPointSet* mesh = vtkPointSet::SafeDownCast(
+    meshPort->GetProducer()->GetOutputDataObject(meshPort->GetIndex()));
+  CHECK_BOOL(culledMesh->GetNumberOfCells() < mesh->GetNumberOfCells(), true);
+  CHECK_BOOL(culledMesh->GetNumberOfCells() > 0, true);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int benchmark(int resolution)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.);
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+
+  vtkNew<vtkPlane> plane;
+  vtkNew<vtkCutter> cutter;
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetInputConnection(sphere->GetOutputPort());
+  vtkNew<vtkExtractPlaneCrossingCells> culler;
+  culler->SetPlane(plane.GetPointer());
+  culler->SetInputConnection(sphere->GetOutputPort());
+  vtkNew<vtkCutter> culledCutter;
+  culledCutter->SetCutFunction(plane.GetPointer());
+  culledCutter->SetInputConnection(culler->GetOutputPort());
+  // Build the index
+  culledCutter->Update();
+
+  vtkNew<vtkTimerLog> timer;
+  double cutterTime = 0.;
+  double culledTime = 0.;
+  const int steps = 20;
+  for (int step = 0; step < steps; ++step)
+    {
+    plane->SetOrigin(0., 0., -45. + 90. * step / steps);
+    timer->StartTimer();
+    cutter->Update();
+    timer->StopTimer();
+    cutterTime += timer->GetElapsedTime();
+
+    timer->StartTimer();
+    culledCutter->Update();
+    timer->StopTimer();
+    culledTime += timer->GetElapsedTime();
+    }
+  CHECK_INT(culler->GetNumberOfIndexBuilds(), 1);
+
+  std::cout << "<DartMeasurement name=\"CutterTime\" type=\"numeric/double\">"
+            << cutterTime / steps << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"CulledCutterTime\" type=\"numeric/double\">"
+            << culledTime / steps << "</DartMeasurement>" << std::endl;
+  std::cout << sphere->GetOutput()->GetNumberOfCells() << " triangles: "
+            << cutterTime / steps << "s to cut the whole mesh, "
+            << culledTime / steps << "s to cut the crossing cells" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkExtractPlaneCrossingCellsTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.);
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  vtkNew<vtkElevationFilter> elevation;
+  elevation->SetInputConnection(sphere->GetOutputPort());
+  elevation->SetLowPoint(0., 0., -50.);
+  elevation->SetHighPoint(0., 0., 50.);
+  CHECK_EXIT_SUCCESS(testIdenticalContours(elevation->GetOutputPort()));
+
+  vtkNew<vtkAppendFilter> toUnstructuredGrid;
+  toUnstructuredGrid->SetInputConnection(elevation->GetOutputPort());
+  CHECK_EXIT_SUCCESS(testIdenticalContours(toUnstructuredGrid->GetOutputPort()));
+
+  // The index is rebuilt when the mesh changes
+  vtkNew<vtkPlane> plane;
+  vtkNew<vtkExtractPlaneCrossingCells> culler;
+  culler->SetPlane(plane.GetPointer());
+  culler->SetInputConnection(sphere->GetOutputPort());
+  culler->Update();
+  sphere->SetRadius(40.);
+  culler->Update();
+  CHECK_INT(culler->GetNumberOfIndexBuilds(), 2);
+
+  CHECK_EXIT_SUCCESS(benchmark(500));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,282 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkExtractPlaneCrossingCells.h"
+
+// VTK includes
+#include <vtkCellData.h>
+#include <vtkFieldData.h>
+#include <vtkIdList.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkExtractPlaneCrossingCells);
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkExtractPlaneCrossingCells, Plane, vtkPlane);
+
+//----------------------------------------------------------------------------
+vtkExtractPlaneCrossingCells::vtkExtractPlaneCrossingCells()
+{
+  this->Plane = NULL;
+  this->IndexedInput = NULL;
+  this->IndexNormal[0] = 0.;
+  this->IndexNormal[1] = 0.;
+  this->IndexNormal[2] = 0.;
+  this->NumberOfIndexBuilds = 0;
+  this->MaximumSortedCellExtent = 0.;
+  this->Tolerance = 0.;
+}
+
+//----------------------------------------------------------------------------
+vtkExtractPlaneCrossingCells::~vtkExtractPlaneCrossingCells()
+{
+  this->SetPlane(NULL);
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkExtractPlaneCrossingCells::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->Plane && this->Plane->GetMTime() > mTime)
+    {
+    mTime = this->Plane->GetMTime();
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractPlaneCrossingCells::BuildIndex(vtkPointSet* input, const double normal[3])
+{
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  const vtkIdType numberOfCells = input->GetNumberOfCells();
+
+  // Project the points once, cells share most of their points
+  std::vector<double> projections(numberOfPoints);
+  double rangeMin = VTK_DOUBLE_MAX;
+  double rangeMax = VTK_DOUBLE_MIN;
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double point[3];
+    input->GetPoint(pointId, point);
+    projections[pointId] = normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2];
+    rangeMin = std::min(rangeMin, projections[pointId]);
+    rangeMax = std::max(rangeMax, projections[pointId]);
+    }
+
+  this->CellMinimums.resize(numberOfCells);
+  this->CellMaximums.resize(numberOfCells);
+  double sumOfExtents = 0.;
+  vtkNew<vtkIdList> cellPointIds;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    input->GetCellPoints(cellId, cellPointIds.GetPointer());
+    double cellMin = VTK_DOUBLE_MAX;
+    double cellMax = VTK_DOUBLE_MIN;
+    for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+      {
+      const double projection = projections[cellPointIds->GetId(i)];
+      cellMin = std::min(cellMin, projection);
+      cellMax = std::max(cellMax, projection);
+      }
+    this->CellMinimums[cellId] = cellMin;
+    this->CellMaximums[cellId] = cellMax;
+    if (cellMax >= cellMin)
+      {
+      sumOfExtents += cellMax - cellMin;
+      }
+    }
+
+  // A few very long cells (e.g. a long line along the normal) would make every
+  // query visit a large part of the sorted cells, keep them aside.
+  const double longCellExtent = (numberOfCells > 0 ? 8. * sumOfExtents / numberOfCells : 0.);
+  std::vector<std::pair<double, vtkIdType> > sortedCells;
+  sortedCells.reserve(numberOfCells);
+  this->LongCells.clear();
+  this->MaximumSortedCellExtent = 0.;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const double cellMin = this->CellMinimums[cellId];
+    const double cellMax = this->CellMaximums[cellId];
+    if (cellMax < cellMin)
+      {
+      // empty cell
+      continue;
+      }
+    const double extent = cellMax - cellMin;
+    if (extent > longCellExtent && longCellExtent > 0.)
+      {
+      this->LongCells.push_back(cellId);
+      continue;
+      }
+    this->MaximumSortedCellExtent = std::max(this->MaximumSortedCellExtent, extent);
+    sortedCells.push_back(std::make_pair(cellMin, cellId));
+    }
+  std::sort(sortedCells.begin(), sortedCells.end());
+  this->SortedMinimums.resize(sortedCells.size());
+  this->SortedCells.resize(sortedCells.size());
+  for (size_t i = 0; i < sortedCells.size(); ++i)
+    {
+    this->SortedMinimums[i] = sortedCells[i].first;
+    this->SortedCells[i] = sortedCells[i].second;
+    }
+
+  // The cutter evaluates the plane function as n.(p-o) and this index as
+  // n.p - n.o, include the cells that may only differ by rounding.
+  this->Tolerance = 1e-6 * (1. + std::max(fabs(rangeMin), fabs(rangeMax)));
+
+  this->IndexedInput = input;
+  this->IndexNormal[0] = normal[0];
+  this->IndexNormal[1] = normal[1];
+  this->IndexNormal[2] = normal[2];
+  this->IndexBuildTime.Modified();
+  ++this->NumberOfIndexBuilds;
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractPlaneCrossingCells::FindCrossingCells(double offset, std::vector<vtkIdType>& cellIds)
+{
+  cellIds.clear();
+  const double lower = offset - this->Tolerance;
+  const double upper = offset + this->Tolerance;
+
+  // Cells that start above the plane cannot cross it, and the ones that
+  // start more than MaximumSortedCellExtent below it end below it.
+  const std::vector<double>& minimums = this->SortedMinimums;
+  std::vector<double>::const_iterator first = std::lower_bound(
+    minimums.begin(), minimums.end(), lower - this->MaximumSortedCellExtent);
+  std::vector<double>::const_iterator last = std::upper_bound(first, minimums.end(), upper);
+  for (std::vector<double>::const_iterator it = first; it != last; ++it)
+    {
+    const vtkIdType cellId = this->SortedCells[it - minimums.begin()];
+    if (this->CellMaximums[cellId] >= lower)
+      {
+      cellIds.push_back(cellId);
+      }
+    }
+  for (std::vector<vtkIdType>::const_iterator it = this->LongCells.begin(); it != this->LongCells.end(); ++it)
+    {
+    if (this->CellMinimums[*it] <= upper && this->CellMaximums[*it] >= lower)
+      {
+      cellIds.push_back(*it);
+      }
+    }
+
+  // Keep the order of the input cells
+  std::sort(cellIds.begin(), cellIds.end());
+}
+
+//----------------------------------------------------------------------------
+int vtkExtractPlaneCrossingCells::RequestData(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  vtkPointSet* input = vtkPointSet::GetData(inputVector[0], 0);
+  vtkPointSet* output = vtkPointSet::GetData(outputVector, 0);
+  if (!input || !output)
+    {
+    return 0;
+    }
+
+  vtkPolyData* inputPolyData = vtkPolyData::SafeDownCast(input);
+  vtkUnstructuredGrid* inputGrid = vtkUnstructuredGrid::SafeDownCast(input);
+  if (!this->Plane || !input->GetPoints() || (!inputPolyData && !inputGrid))
+    {
+    output->ShallowCopy(input);
+    return 1;
+    }
+
+  double* normal = this->Plane->GetNormal();
+  if (this->IndexedInput != input
+    || this->IndexBuildTime < input->GetMTime()
+    || this->IndexNormal[0] != normal[0]
+    || this->IndexNormal[1] != normal[1]
+    || this->IndexNormal[2] != normal[2])
+    {
+    this->BuildIndex(input, normal);
+    }
+
+  double* origin = this->Plane->GetOrigin();
+  const double offset = normal[0] * origin[0] + normal[1] * origin[1] + normal[2] * origin[2];
+  std::vector<vtkIdType> cellIds;
+  this->FindCrossingCells(offset, cellIds);
+
+  // Points are shared with the input, only the cells are filtered
+  output->SetPoints(input->GetPoints());
+  output->GetPointData()->PassData(input->GetPointData());
+  output->GetFieldData()->PassData(input->GetFieldData());
+  vtkCellData* inputCellData = input->GetCellData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+
+  vtkNew<vtkIdList> cellPointIds;
+  if (inputPolyData)
+    {
+    // Polydata cells are ordered by type (verts, lines, polys, strips), and so
+    // are the increasing cell IDs: inserting them in order keeps the same order.
+    vtkPolyData* outputPolyData = vtkPolyData::SafeDownCast(output);
+    outputPolyData->Allocate(static_cast<vtkIdType>(cellIds.size()));
+    for (std::vector<vtkIdType>::const_iterator it = cellIds.begin(); it != cellIds.end(); ++it)
+      {
+      inputPolyData->GetCellPoints(*it, cellPointIds.GetPointer());
+      vtkIdType outputCellId = outputPolyData->InsertNextCell(inputPolyData->GetCellType(*it), cellPointIds.GetPointer());
+      outputCellData->CopyData(inputCellData, *it, outputCellId);
+      }
+    }
+  else
+    {
+    vtkUnstructuredGrid* outputGrid = vtkUnstructuredGrid::SafeDownCast(output);
+    outputGrid->Allocate(static_cast<vtkIdType>(cellIds.size()));
+    for (std::vector<vtkIdType>::const_iterator it = cellIds.begin(); it != cellIds.end(); ++it)
+      {
+      int cellType = inputGrid->GetCellType(*it);
+      if (cellType == VTK_POLYHEDRON)
+        {
+        inputGrid->GetFaceStream(*it, cellPointIds.GetPointer());
+        }
+      else
+        {
+        inputGrid->GetCellPoints(*it, cellPointIds.GetPointer());
+        }
+      vtkIdType outputCellId = outputGrid->InsertNextCell(cellType, cellPointIds.GetPointer());
+      outputCellData->CopyData(inputCellData, *it, outputCellId);
+      }
+    }
+  output->Squeeze();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractPlaneCrossingCells::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfIndexBuilds: " << this->NumberOfIndexBuilds << "\n";
+}
@@ -0,0 +1,104 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkExtractPlaneCrossingCells_h
+#define __vtkExtractPlaneCrossingCells_h
+
+// VTK includes
+#include <vtkPointSetAlgorithm.h>
+#include <vtkTimeStamp.h>
+
+// MRML includes
+#include "vtkMRMLDisplayableManagerExport.h"
+
+// STD includes
+#include <vector>
+
+class vtkPlane;
+
+/// \brief Keep only the cells of a mesh that may cross a plane.
+///
+/// Output has the same points and point data as the input, and the cells
+/// whose extent along the plane normal contains the plane, in the same order
+/// as in the input. Cutting the output with the plane (vtkCutter) gives the
+/// same contour as cutting the input, without visiting the other cells.
+///
+/// The extents of the cells along the normal are indexed once, sorted by
+/// their lower bound; the index is rebuilt only when the input or the
+/// direction of the plane normal changes. Moving the plane along its normal
+/// only queries the index, which costs O(log(cells) + candidate cells).
+///
+/// vtkPolyData and vtkUnstructuredGrid inputs are culled, other point sets
+/// are passed through.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkExtractPlaneCrossingCells
+  : public vtkPointSetAlgorithm
+{
+public:
+  static vtkExtractPlaneCrossingCells* New();
+  vtkTypeMacro(vtkExtractPlaneCrossingCells, vtkPointSetAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Plane that the output cells cross.
+  virtual void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  /// Take the plane modification time into account.
+  virtual vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+  /// Number of times the index was built. For testing purposes.
+  vtkGetMacro(NumberOfIndexBuilds, int);
+
+protected:
+  vtkExtractPlaneCrossingCells();
+  virtual ~vtkExtractPlaneCrossingCells();
+
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  /// Compute the extents of the cells of the input along the normal.
+  void BuildIndex(vtkPointSet* input, const double normal[3]);
+
+  /// Fill cellIds with the (increasing) IDs of the cells whose extent along
+  /// the normal contains offset.
+  void FindCrossingCells(double offset, std::vector<vtkIdType>& cellIds);
+
+  vtkPlane* Plane;
+
+  /// Index of the cells along IndexNormal for the input IndexedInput.
+  vtkPointSet* IndexedInput;
+  vtkTimeStamp IndexBuildTime;
+  double IndexNormal[3];
+  int NumberOfIndexBuilds;
+
+  /// Lower and upper projection of each cell on the normal.
+  std::vector<double> CellMinimums;
+  std::vector<double> CellMaximums;
+  /// Cells sorted by lower projection, excluding the long cells.
+  std::vector<double> SortedMinimums;
+  std::vector<vtkIdType> SortedCells;
+  /// Largest extent of the sorted cells.
+  double MaximumSortedCellExtent;
+  /// Cells much longer than the others, always tested.
+  std::vector<vtkIdType> LongCells;
+  /// Margin that absorbs rounding differences with the cutter.
+  double Tolerance;
+
+private:
+  vtkExtractPlaneCrossingCells(const vtkExtractPlaneCrossingCells&);
+  void operator=(const vtkExtractPlaneCrossingCells&);
+};
+
+#endif
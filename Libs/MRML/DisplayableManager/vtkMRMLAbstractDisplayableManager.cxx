@@ -28,6 +28,7 @@
 
 // MRML includes
 #include <vtkMRMLInteractionNode.h>
+#include <vtkMRMLProfiler.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
 
@@ -851,6 +852,7 @@ void vtkMRMLAbstractDisplayableManager::RequestRender()
 
   if (this->Internal->UpdateFromMRMLRequested)
     {
+    vtkMRMLProfileScopeMacro("UpdateFromMRML", this->GetClassName(), vtkCommand::NoEvent);
     this->UpdateFromMRML();
     }
 
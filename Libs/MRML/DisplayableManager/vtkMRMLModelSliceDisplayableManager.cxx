@@ -18,6 +18,7 @@
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelSliceDisplayableManager.h"
 #include "vtkMRMLModelDisplayableManager.h"
+#include "vtkExtractPlaneCrossingCells.h"
 
 // MRML includes
 #include <vtkMRMLApplicationLogic.h>
@@ -80,6 +81,7 @@ public:
     vtkSmartPointer<vtkDataSetSurfaceFilter> SurfaceExtractor;
     vtkSmartPointer<vtkTransformFilter> ModelWarper;
     vtkSmartPointer<vtkPlane> Plane;
+    vtkSmartPointer<vtkExtractPlaneCrossingCells> CellCuller;
     vtkSmartPointer<vtkCutter> Cutter;
     vtkSmartPointer<vtkSampleImplicitFunctionFilter> SliceDistance;
     vtkSmartPointer<vtkProp> Actor;
@@ -339,6 +341,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   Pipeline* pipeline = new Pipeline();
   pipeline->Actor = actor.GetPointer();
   pipeline->Cutter = vtkSmartPointer<vtkCutter>::New();
+  pipeline->CellCuller = vtkSmartPointer<vtkExtractPlaneCrossingCells>::New();
   pipeline->SliceDistance = vtkSmartPointer<vtkSampleImplicitFunctionFilter>::New();
   pipeline->TransformToSlice = vtkSmartPointer<vtkTransform>::New();
   pipeline->NodeToWorld = vtkSmartPointer<vtkGeneralTransform>::New();
@@ -352,7 +355,11 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
   pipeline->Cutter->SetCutFunction(pipeline->Plane);
   pipeline->Cutter->SetGenerateCutScalars(0);
-  pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+  // Only the cells crossing the slice plane are cut. The cells are indexed
+  // along the slice normal, moving the slice offset does not visit the others.
+  pipeline->CellCuller->SetPlane(pipeline->Plane);
+  pipeline->CellCuller->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+  pipeline->Cutter->SetInputConnection(pipeline->CellCuller->GetOutputPort());
   // Projection is created from outer surface of volumetric meshes (for polydata surface
   // extraction is just shallow-copy)
   pipeline->SurfaceExtractor->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
@@ -475,7 +482,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
     // show intersection in the slice view
     // include clipper in the pipeline
     pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
-    pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+    pipeline->Cutter->SetInputConnection(pipeline->CellCuller->GetOutputPort());
 
     //  Set Poly Data Transform
     vtkNew<vtkMatrix4x4> rasToSliceXY;
@@ -0,0 +1,255 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLApplicationLogic.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLModelStorageNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSceneViewNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void addModelNode(vtkMRMLScene* scene, const char* name, const std::string& fileName)
+{
+  vtkNew<vtkMRMLModelStorageNode> storageNode;
+  storageNode->SetFileName(fileName.c_str());
+  scene->AddNode(storageNode.GetPointer());
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetName(name);
+  scene->AddNode(modelNode.GetPointer());
+  modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+}
+
+//-----------------------------------------------------------------------------
+// Create a bundle with a model in the bundle, a model read from an absolute
+// path outside of the bundle and optionally a model with a missing file.
+int createBundle(const std::string& testDirectory, const std::string& modelFileName,
+                 bool withMissingFile, std::string& bundleFileName)
+{
+  std::string bundleDirectory = testDirectory + "/bundle";
+  vtksys::SystemTools::RemoveADirectory(bundleDirectory.c_str());
+  CHECK_BOOL(vtksys::SystemTools::MakeDirectory((bundleDirectory + "/Data").c_str()), true);
+  CHECK_BOOL(vtksys::SystemTools::CopyAFile(modelFileName.c_str(),
+    (bundleDirectory + "/Data").c_str()), true);
+  std::string modelBaseName = vtksys::SystemTools::GetFilenameName(modelFileName);
+
+  vtkNew<vtkMRMLScene> scene;
+  std::string sceneFileName = bundleDirectory + "/bundle.mrml";
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetRootDirectory(bundleDirectory.c_str());
+  addModelNode(scene.GetPointer(), "InBundle", bundleDirectory + "/Data/" + modelBaseName);
+  addModelNode(scene.GetPointer(), "OutsideBundle", modelFileName);
+  if (withMissingFile)
+    {
+    addModelNode(scene.GetPointer(), "Missing", bundleDirectory + "/Data/missing.vtk");
+    }
+  scene->SetSaveToXMLString(1);
+  CHECK_INT(scene->Commit(), 1);
+
+  // Storage nodes write paths relative to the scene, make the path of the
+  // model outside of the bundle absolute
+  std::string sceneXML = scene->GetSceneXMLString();
+  vtkNew<vtkMRMLModelNode> encoder;
+  std::string relativePath = encoder->URLEncodeString(
+    vtksys::SystemTools::RelativePath(bundleDirectory.c_str(), modelFileName.c_str()).c_str());
+  std::string absolutePath = encoder->URLEncodeString(modelFileName.c_str());
+  vtksys::SystemTools::ReplaceString(sceneXML, ("\"" + relativePath + "\"").c_str(),
+                                     ("\"" + absolutePath + "\"").c_str());
+  std::ofstream sceneFile(sceneFileName.c_str());
+  sceneFile << sceneXML;
+  sceneFile.close();
+
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  bundleFileName = testDirectory + "/bundle.mrb";
+  vtksys::SystemTools::RemoveFile(bundleFileName.c_str());
+  CHECK_BOOL(appLogic->Zip(bundleFileName.c_str(), bundleDirectory.c_str()), true);
+  CHECK_BOOL(vtksys::SystemTools::RemoveADirectory(bundleDirectory.c_str()), true);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType numberOfPoints(vtkMRMLScene* scene, const char* name)
+{
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(scene->GetFirstNodeByName(name));
+  return (modelNode && modelNode->GetPolyData()) ? modelNode->GetPolyData()->GetNumberOfPoints() : 0;
+}
+
+//-----------------------------------------------------------------------------
+int testLoad(const std::string& testDirectory, const std::string& modelFileName)
+{
+  std::string bundleFileName;
+  CHECK_EXIT_SUCCESS(createBundle(testDirectory, modelFileName, false, bundleFileName));
+
+  // Extracted files are removed after they are read
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  appLogic->SetMRMLScene(scene.GetPointer());
+  std::string temporaryDirectory = testDirectory + "/load";
+  CHECK_BOOL(appLogic->LoadSlicerDataBundle(bundleFileName.c_str(), temporaryDirectory.c_str()), true);
+  CHECK_INT(scene->GetErrorCode(), 0);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 2);
+  CHECK_BOOL(numberOfPoints(scene.GetPointer(), "InBundle") > 0, true);
+  CHECK_INT(numberOfPoints(scene.GetPointer(), "OutsideBundle"),
+            numberOfPoints(scene.GetPointer(), "InBundle"));
+  std::string extractedFileName = temporaryDirectory + "/bundle/Data/" +
+    vtksys::SystemTools::GetFilenameName(modelFileName);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(extractedFileName.c_str()), false);
+
+  // Importing keeps the nodes of the scene, they are not read again
+  CHECK_BOOL(appLogic->LoadSlicerDataBundle(bundleFileName.c_str(), temporaryDirectory.c_str(), false), true);
+  CHECK_INT(scene->GetErrorCode(), 0);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 4);
+
+  // OpenSlicerDataBundle keeps the extracted files
+  vtkNew<vtkMRMLScene> openedScene;
+  appLogic->SetMRMLScene(openedScene.GetPointer());
+  std::string openDirectory = testDirectory + "/open";
+  CHECK_BOOL(appLogic->OpenSlicerDataBundle(bundleFileName.c_str(), openDirectory.c_str()), true);
+  CHECK_INT(openedScene->GetErrorCode(), 0);
+  CHECK_BOOL(numberOfPoints(openedScene.GetPointer(), "InBundle") > 0, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((openDirectory + "/bundle/Data/" +
+    vtksys::SystemTools::GetFilenameName(modelFileName)).c_str()), true);
+  appLogic->SetMRMLScene(0);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int testLoadWithMissingFile(const std::string& testDirectory, const std::string& modelFileName)
+{
+  std::string bundleFileName;
+  CHECK_EXIT_SUCCESS(createBundle(testDirectory, modelFileName, true, bundleFileName));
+
+  // Read errors are reported, the other nodes are still read
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  appLogic->SetMRMLScene(scene.GetPointer());
+  std::string temporaryDirectory = testDirectory + "/missing";
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(appLogic->LoadSlicerDataBundle(bundleFileName.c_str(), temporaryDirectory.c_str()), true);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_INT(scene->GetErrorCode(), 1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 3);
+  CHECK_BOOL(numberOfPoints(scene.GetPointer(), "InBundle") > 0, true);
+  CHECK_BOOL(numberOfPoints(scene.GetPointer(), "OutsideBundle") > 0, true);
+  CHECK_INT(numberOfPoints(scene.GetPointer(), "Missing"), 0);
+  appLogic->SetMRMLScene(0);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int testOpenWithSceneView(const std::string& testDirectory, const std::string& modelFileName)
+{
+  // Bundle with a model that is only in a scene view: it was deleted from
+  // the scene after the scene view was stored
+  std::string bundleDirectory = testDirectory + "/sceneViewBundle";
+  vtksys::SystemTools::RemoveADirectory(bundleDirectory.c_str());
+  CHECK_BOOL(vtksys::SystemTools::MakeDirectory((bundleDirectory + "/Data").c_str()), true);
+  CHECK_BOOL(vtksys::SystemTools::CopyAFile(modelFileName.c_str(),
+    (bundleDirectory + "/Data").c_str()), true);
+  std::string modelBaseName = vtksys::SystemTools::GetFilenameName(modelFileName);
+  {
+  vtkNew<vtkMRMLScene> scene;
+  std::string sceneFileName = bundleDirectory + "/bundle.mrml";
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetRootDirectory(bundleDirectory.c_str());
+  addModelNode(scene.GetPointer(), "InSceneView", bundleDirectory + "/Data/" + modelBaseName);
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode;
+  scene->AddNode(sceneViewNode.GetPointer());
+  sceneViewNode->StoreScene();
+  vtkMRMLModelNode* modelNode =
+    vtkMRMLModelNode::SafeDownCast(scene->GetFirstNodeByName("InSceneView"));
+  CHECK_NOT_NULL(modelNode);
+  scene->RemoveNode(modelNode->GetStorageNode());
+  scene->RemoveNode(modelNode);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 0);
+  CHECK_INT(scene->Commit(), 1);
+  }
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  std::string bundleFileName = testDirectory + "/sceneViewBundle.mrb";
+  vtksys::SystemTools::RemoveFile(bundleFileName.c_str());
+  CHECK_BOOL(appLogic->Zip(bundleFileName.c_str(), bundleDirectory.c_str()), true);
+  CHECK_BOOL(vtksys::SystemTools::RemoveADirectory(bundleDirectory.c_str()), true);
+  std::string extractedFileName = "/sceneViewBundle/Data/" + modelBaseName;
+
+  // Loading without keeping the files does not extract it
+  vtkNew<vtkMRMLScene> scene;
+  appLogic->SetMRMLScene(scene.GetPointer());
+  std::string temporaryDirectory = testDirectory + "/sceneViewLoad";
+  CHECK_BOOL(appLogic->LoadSlicerDataBundle(bundleFileName.c_str(), temporaryDirectory.c_str()), true);
+  CHECK_INT(scene->GetErrorCode(), 0);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((temporaryDirectory + extractedFileName).c_str()), false);
+
+  // Opening keeps the files the scene view reads when it is restored
+  vtkNew<vtkMRMLScene> openedScene;
+  appLogic->SetMRMLScene(openedScene.GetPointer());
+  std::string openDirectory = testDirectory + "/sceneViewOpen";
+  CHECK_BOOL(appLogic->OpenSlicerDataBundle(bundleFileName.c_str(), openDirectory.c_str()), true);
+  CHECK_INT(openedScene->GetErrorCode(), 0);
+  CHECK_INT(openedScene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 0);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((openDirectory + extractedFileName).c_str()), true);
+
+  vtkMRMLSceneViewNode* sceneViewNode = vtkMRMLSceneViewNode::SafeDownCast(
+    openedScene->GetFirstNodeByClass("vtkMRMLSceneViewNode"));
+  CHECK_NOT_NULL(sceneViewNode);
+  CHECK_NOT_NULL(sceneViewNode->GetStoredScene());
+  vtkMRMLModelNode* storedModelNode = vtkMRMLModelNode::SafeDownCast(
+    sceneViewNode->GetStoredScene()->GetFirstNodeByName("InSceneView"));
+  CHECK_NOT_NULL(storedModelNode);
+  CHECK_NOT_NULL(storedModelNode->GetStorageNode());
+  CHECK_BOOL(vtksys::SystemTools::FileExists(
+    storedModelNode->GetStorageNode()->GetFullNameFromFileName().c_str()), true);
+  appLogic->SetMRMLScene(0);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLApplicationLogicBundleTest(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkMRMLApplicationLogicBundleTest /path/to/model.vtk" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string modelFileName = vtksys::SystemTools::CollapseFullPath(argv[1]);
+  std::string testDirectory = vtksys::SystemTools::GetCurrentWorkingDirectory() +
+    "/vtkMRMLApplicationLogicBundleTest";
+  vtksys::SystemTools::RemoveADirectory(testDirectory.c_str());
+  CHECK_BOOL(vtksys::SystemTools::MakeDirectory(testDirectory.c_str()), true);
+
+  CHECK_EXIT_SUCCESS(testLoad(testDirectory, modelFileName));
+  CHECK_EXIT_SUCCESS(testLoadWithMissingFile(testDirectory, modelFileName));
+  CHECK_EXIT_SUCCESS(testOpenWithSceneView(testDirectory, modelFileName));
+
+  vtksys::SystemTools::RemoveADirectory(testDirectory.c_str());
+  return EXIT_SUCCESS;
+}
@@ -21,6 +21,7 @@
 
 // STD includes
 #include <cstring>
+#include <fstream>
 #include <iostream>
 
 namespace
@@ -215,6 +216,74 @@ long copy_data(struct archive *ar, struct archive *aw)
   return r;
 }
 
+// --------------------------------------------------------------------------
+// Returns true if the nrrd file data is compressed, the encoding is
+// given in the header that ends with an empty line.
+bool is_compressed_nrrd(const char* fileName)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  std::string line;
+  for (int lineIndex = 0; lineIndex < 1000 && std::getline(file, line); ++lineIndex)
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    if (line.empty())
+      {
+      break;
+      }
+    if (line.compare(0, 9, "encoding:") == 0)
+      {
+      std::string encoding = vtksys::SystemTools::LowerCase(line.substr(9));
+      return encoding.find("gz") != std::string::npos
+        || encoding.find("bz2") != std::string::npos
+        || encoding.find("bzip2") != std::string::npos;
+      }
+    }
+  return false;
+}
+
+// --------------------------------------------------------------------------
+// Returns true if the file content is compressed, deflating it again
+// would cost time for no space gain.
+bool is_compressed_file(const char* fileName)
+{
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  if (extension == ".nrrd")
+    {
+    return is_compressed_nrrd(fileName);
+    }
+  const char* compressedExtensions[] =
+    { ".gz", ".bz2", ".zip", ".mrb", ".mgz", ".png", ".jpg", ".jpeg", 0 };
+  for (int i = 0; compressedExtensions[i]; ++i)
+    {
+    if (extension == compressedExtensions[i])
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+// --------------------------------------------------------------------------
+// Opens the archive for reading, returns NULL on error
+struct archive* open_archive_for_read(const char* archiveFileName)
+{
+  struct archive* a = archive_read_new();
+  archive_read_support_filter_all(a);
+  archive_read_support_format_all(a);
+  if (archive_read_open_filename(a, archiveFileName, 10240) != ARCHIVE_OK)
+    {
+    vtkArchiveTools::Error("Problem with archive_read_open_filename(): ",
+                           archive_error_string(a));
+    archive_read_free(a);
+    return NULL;
+    }
+  return a;
+}
+
 } // end of anonymous namespace
 
 //-----------------------------------------------------------------------------
@@ -252,6 +321,151 @@ bool list_archive(const char* archiveFileName, std::vector<std::string>& files)
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool read_archive_entry(const char* archiveFileName, const char* entryName, std::string& content)
+{
+  if (!archiveFileName || !entryName)
+    {
+    vtkArchiveTools::Error("Read entry:", "Invalid archive or entry name");
+    return false;
+    }
+  struct archive* a = open_archive_for_read(archiveFileName);
+  if (!a)
+    {
+    return false;
+    }
+
+  bool found = false;
+  bool success = true;
+  struct archive_entry* entry;
+  int r;
+  while ((r = archive_read_next_header(a, &entry)) != ARCHIVE_EOF)
+    {
+    if (r != ARCHIVE_OK)
+      {
+      vtkArchiveTools::Error("Problem with archive_read_next_header(): ",
+                             archive_error_string(a));
+      success = false;
+      break;
+      }
+    if (strcmp(archive_entry_pathname(entry), entryName) != 0)
+      {
+      // headers of zip files give the entry size, the data is skipped without
+      // being decompressed
+      archive_read_data_skip(a);
+      continue;
+      }
+    found = true;
+    content.clear();
+    if (archive_entry_size_is_set(entry))
+      {
+      content.reserve(static_cast<size_t>(archive_entry_size(entry)));
+      }
+    char buff[BUFSIZ];
+    long len;
+    while ((len = static_cast<long>(archive_read_data(a, buff, sizeof(buff)))) > 0)
+      {
+      content.append(buff, static_cast<size_t>(len));
+      }
+    if (len < 0)
+      {
+      vtkArchiveTools::Error("Read entry error:", archive_error_string(a));
+      success = false;
+      }
+    break;
+    }
+
+  archive_read_close(a);
+  archive_read_free(a);
+  if (success && !found)
+    {
+    vtkArchiveTools::Error("Read entry: entry not found:", entryName);
+    }
+  return success && found;
+}
+
+//-----------------------------------------------------------------------------
+bool extract_archive_entries(const char* archiveFileName,
+                             const char* destinationDirectory,
+                             const std::set<std::string>& entryNames,
+                             std::vector<std::string>* extracted_files)
+{
+  if (!archiveFileName || !destinationDirectory)
+    {
+    vtkArchiveTools::Error("Extract entries:", "Invalid archive or directory");
+    return false;
+    }
+  if (entryNames.empty())
+    {
+    return true;
+    }
+  struct archive* a = open_archive_for_read(archiveFileName);
+  if (!a)
+    {
+    return false;
+    }
+
+  bool success = true;
+  size_t numberOfExtractedEntries = 0;
+  struct archive_entry* entry;
+  int r;
+  while (numberOfExtractedEntries < entryNames.size()
+         && (r = archive_read_next_header(a, &entry)) != ARCHIVE_EOF)
+    {
+    if (r != ARCHIVE_OK)
+      {
+      vtkArchiveTools::Error("Problem with archive_read_next_header(): ",
+                             archive_error_string(a));
+      success = false;
+      break;
+      }
+    const char* entryName = archive_entry_pathname(entry);
+    if (archive_entry_filetype(entry) != AE_IFREG
+        || entryNames.find(entryName) == entryNames.end())
+      {
+      archive_read_data_skip(a);
+      continue;
+      }
+    ++numberOfExtractedEntries;
+
+    std::string fileName = std::string(destinationDirectory) + "/" + entryName;
+    vtksys::SystemTools::MakeDirectory(
+      vtksys::SystemTools::GetFilenamePath(fileName).c_str());
+    FILE* fd = fopen(fileName.c_str(), "wb");
+    if (!fd)
+      {
+      vtkArchiveTools::Error("Extract entries: cannot open:", fileName.c_str());
+      success = false;
+      break;
+      }
+    char buff[BUFSIZ];
+    long len;
+    while ((len = static_cast<long>(archive_read_data(a, buff, sizeof(buff)))) > 0)
+      {
+      if (fwrite(buff, 1, static_cast<size_t>(len), fd) != static_cast<size_t>(len))
+        {
+        len = -1;
+        break;
+        }
+      }
+    fclose(fd);
+    if (extracted_files)
+      {
+      extracted_files->push_back(fileName);
+      }
+    if (len < 0)
+      {
+      vtkArchiveTools::Error("Extract entries error:", fileName.c_str());
+      success = false;
+      break;
+      }
+    }
+
+  archive_read_close(a);
+  archive_read_free(a);
+  return success;
+}
+
 //-----------------------------------------------------------------------------
 bool extract_tar(const char* tarFileName, bool verbose, bool extract, std::vector<std::string> * extracted_files)
 {
@@ -443,6 +657,9 @@ bool zip(const char* zipFileName, const char* directoryToZip)
     archive_entry_set_size(entry, fileLength);
     archive_entry_set_filetype(entry, AE_IFREG);
     archive_entry_set_perm(entry, 0644);
+    // the compression is applied to the entries written after it is set
+    archive_write_set_format_option(zipArchive, "zip", "compression",
+      is_compressed_file(fileName) ? "store" : compression_type.c_str());
     archive_write_header(zipArchive, entry);
 
     //
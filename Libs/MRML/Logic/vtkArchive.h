@@ -14,6 +14,7 @@
 #define __vtkArchive_h
 
 // STD includes
+#include <set>
 #include <string>
 #include <vector>
 
@@ -35,8 +36,25 @@ VTK_MRML_LOGIC_EXPORT bool list_archive(
 VTK_MRML_LOGIC_EXPORT bool extract_tar(const char* tarFileName, bool verbose, bool extract,
                                        std::vector<std::string> * extracted_files = 0);
 
+// reads the content of a single entry of the archive into memory, without
+// extracting the other entries
+VTK_MRML_LOGIC_EXPORT bool read_archive_entry(const char* archiveFileName,
+                                              const char* entryName,
+                                              std::string& content);
+
+// extracts the given entries of the archive into the destination directory,
+// the other entries are skipped. Entry paths are kept, relative to the
+// destination directory. Files that were written are appended to
+// extracted_files if it is not null.
+VTK_MRML_LOGIC_EXPORT bool extract_archive_entries(const char* archiveFileName,
+                                                   const char* destinationDirectory,
+                                                   const std::set<std::string>& entryNames,
+                                                   std::vector<std::string>* extracted_files = 0);
+
 // creates a zip file with the full contents of the directory (recurses)
 // zip entries will include relative path of including tail of directoryToZip
+// Files that are already compressed (gzip encoded nrrd, .gz, .png, ...)
+// are stored without being compressed again.
 VTK_MRML_LOGIC_EXPORT bool zip(const char* zipFileName, const char* directoryToZip);
 
 // unzips zip file into specified directory
@@ -18,6 +18,7 @@
 
 // MRML includes
 #include "vtkMRMLNode.h"
+#include "vtkMRMLProfiler.h"
 #include "vtkMRMLScene.h"
 
 // VTK includes
@@ -165,6 +166,7 @@ void vtkMRMLAbstractLogic::MRMLSceneCallback(vtkObject*caller, unsigned long eid
     }
 
   vtkDebugWithObjectMacro(self, "In vtkMRMLAbstractLogic MRMLSceneCallback");
+  vtkMRMLProfileScopeMacro("ProcessMRMLSceneEvents", self->GetClassName(), eid);
 
   self->SetInMRMLSceneCallbackFlag(self->GetInMRMLSceneCallbackFlag() + 1);
   int oldProcessingEvent = self->GetProcessingMRMLSceneEvent();
@@ -193,6 +195,7 @@ void vtkMRMLAbstractLogic::MRMLNodesCallback(vtkObject* caller, unsigned long ei
     return;
     }
   vtkDebugWithObjectMacro(self, "In vtkMRMLAbstractLogic MRMLNodesCallback");
+  vtkMRMLProfileScopeMacro("ProcessMRMLNodesEvents", self->GetClassName(), eid);
 
   self->SetInMRMLNodesCallbackFlag(self->GetInMRMLNodesCallbackFlag() + 1);
   self->ProcessMRMLNodesEvents(caller, eid, callData);
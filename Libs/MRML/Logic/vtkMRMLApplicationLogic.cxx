@@ -53,6 +53,7 @@
 
 // STD includes
 #include <cassert>
+#include <set>
 #include <sstream>
 
 // For LoadDefaultParameterSets
@@ -506,25 +507,240 @@ std::string vtkMRMLApplicationLogic::UnpackSlicerDataBundle(const char *sdbFileP
 //----------------------------------------------------------------------------
 bool vtkMRMLApplicationLogic::OpenSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory)
 {
-  if (!this->GetMRMLScene())
+  return this->LoadSlicerDataBundle(sdbFilePath, temporaryDirectory, true, true);
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Bundle entries of the files read by the storage node: its file names and,
+// for header files, the data files that share the header base name
+// (e.g. the .raw.gz file of a .nhdr file).
+std::set<std::string> GetStorageNodeBundleEntries(vtkMRMLStorageNode* storageNode,
+                                                  const std::string& bundleDirectory,
+                                                  const std::set<std::string>& bundleEntries)
+{
+  std::set<std::string> entries;
+  if (storageNode->GetFileName() == NULL)
+    {
+    return entries;
+    }
+  std::vector<std::string> fullNames;
+  fullNames.push_back(storageNode->GetFullNameFromFileName());
+  for (int n = 0; n < storageNode->GetNumberOfFileNames(); ++n)
+    {
+    fullNames.push_back(storageNode->GetFullNameFromNthFileName(n));
+    }
+  for (std::vector<std::string>::iterator it = fullNames.begin(); it != fullNames.end(); ++it)
+    {
+    std::string entry = vtksys::SystemTools::RelativePath(bundleDirectory.c_str(),
+      vtksys::SystemTools::CollapseFullPath(it->c_str()).c_str());
+    if (bundleEntries.find(entry) != bundleEntries.end())
+      {
+      entries.insert(entry);
+      }
+    }
+  if (entries.empty())
+    {
+    return entries;
+    }
+
+  std::string mainEntry = vtksys::SystemTools::RelativePath(bundleDirectory.c_str(),
+    vtksys::SystemTools::CollapseFullPath(fullNames[0].c_str()).c_str());
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(mainEntry));
+  if (extension == ".nhdr" || extension == ".hdr" || extension == ".mhd")
+    {
+    std::string prefix = mainEntry.substr(0, mainEntry.size() - extension.size()) + ".";
+    for (std::set<std::string>::const_iterator it = bundleEntries.lower_bound(prefix);
+         it != bundleEntries.end() && it->compare(0, prefix.size(), prefix) == 0; ++it)
+      {
+      if (it->find('/', prefix.size()) == std::string::npos)
+        {
+        entries.insert(*it);
+        }
+      }
+    }
+  return entries;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+bool vtkMRMLApplicationLogic::LoadSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory,
+                                                   bool clear, bool keepExtractedFiles)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (!scene)
     {
     vtkErrorMacro("no scene");
     return false;
     }
+  if (!sdbFilePath || !temporaryDirectory)
+    {
+    vtkErrorMacro("invalid bundle file or temporary directory");
+    return false;
+    }
 
-  std::string mrmlFile = this->UnpackSlicerDataBundle(sdbFilePath, temporaryDirectory);
-
-  if ( mrmlFile.empty() )
+  std::vector<std::string> entryList;
+  if (!list_archive(sdbFilePath, entryList))
     {
-    vtkErrorMacro("Could not unpack mrml scene");
+    vtkErrorMacro("could not open bundle file");
+    return false;
+    }
+  std::string mrmlEntry;
+  for (std::vector<std::string>::iterator it = entryList.begin(); it != entryList.end(); ++it)
+    {
+    if (vtksys::SystemTools::LowerCase(
+          vtksys::SystemTools::GetFilenameLastExtension(*it)) == ".mrml")
+      {
+      mrmlEntry = *it;
+      break;
+      }
+    }
+  if (mrmlEntry.empty())
+    {
+    vtkErrorMacro("could not find mrml file in archive");
+    return false;
+    }
+  std::string sceneXML;
+  if (!read_archive_entry(sdbFilePath, mrmlEntry.c_str(), sceneXML))
+    {
+    vtkErrorMacro("could not read mrml file " << mrmlEntry << " in archive");
     return false;
     }
 
-  this->GetMRMLScene()->SetURL( mrmlFile.c_str() );
-  int success = this->GetMRMLScene()->Connect();
-  if ( !success )
+  // The file names of the storage nodes are resolved as if the bundle was
+  // unpacked in the temporary directory
+  std::string bundleDirectory = vtksys::SystemTools::CollapseFullPath(temporaryDirectory);
+  std::string mrmlFile = bundleDirectory + "/" + mrmlEntry;
+  scene->SetURL(mrmlFile.c_str());
+  scene->SetRootDirectory(vtksys::SystemTools::GetParentDirectory(mrmlFile.c_str()).c_str());
+  int loadFromXMLString = scene->GetLoadFromXMLString();
+  int readDataOnLoad = scene->GetReadDataOnLoad();
+  scene->SetLoadFromXMLString(1);
+  scene->SetSceneXMLString(sceneXML);
+  scene->SetReadDataOnLoad(0);
+
+  // The import state is kept until the data is read, so that the nodes
+  // have their data when EndImportEvent is invoked
+  bool undoFlag = scene->GetUndoFlag();
+  if (clear)
+    {
+    scene->StartState(vtkMRMLScene::BatchProcessState);
+    scene->Clear(0);
+    }
+  // Only the nodes of the bundle read their data
+  std::vector<vtkMRMLNode*> existingNodes;
+  scene->GetNodesByClass("vtkMRMLStorableNode", existingNodes);
+  std::set<vtkMRMLNode*> existingNodeSet(existingNodes.begin(), existingNodes.end());
+  scene->GetNodesByClass("vtkMRMLSceneViewNode", existingNodes);
+  existingNodeSet.insert(existingNodes.begin(), existingNodes.end());
+
+  scene->StartState(vtkMRMLScene::ImportState);
+  // Storable nodes don't report read errors while reading is disabled,
+  // the error code is only set by actual import errors
+  int success = scene->Import();
+  scene->SetLoadFromXMLString(loadFromXMLString);
+  scene->SetReadDataOnLoad(readDataOnLoad);
+
+  if (success && readDataOnLoad)
+    {
+    std::set<std::string> bundleEntries(entryList.begin(), entryList.end());
+    std::set<std::string> keptEntries;
+    std::vector<vtkMRMLNode*> nodes;
+    scene->GetNodesByClass("vtkMRMLStorableNode", nodes);
+    for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+      {
+      vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(*it);
+      if (!storableNode->GetAddToScene()
+          || existingNodeSet.find(storableNode) != existingNodeSet.end())
+        {
+        continue;
+        }
+      for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); ++i)
+        {
+        vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(i);
+        if (!storageNode)
+          {
+          continue;
+          }
+        // Files that are not in the bundle (absolute paths, URIs) are read
+        // from where they are
+        std::set<std::string> entries =
+          GetStorageNodeBundleEntries(storageNode, bundleDirectory, bundleEntries);
+        std::vector<std::string> extractedFiles;
+        bool extracted = entries.empty() ||
+          extract_archive_entries(sdbFilePath, bundleDirectory.c_str(), entries, &extractedFiles);
+        if (!extracted || !storageNode->ReadData(storableNode))
+          {
+          scene->SetErrorCode(1);
+          scene->SetErrorMessage(std::string("Error reading file ") +
+            (storageNode->GetFileName() ? storageNode->GetFileName() :
+             storageNode->GetURI() ? storageNode->GetURI() : "(null)"));
+          }
+        if (keepExtractedFiles)
+          {
+          keptEntries.insert(entries.begin(), entries.end());
+          }
+        for (std::vector<std::string>::iterator fileIt = extractedFiles.begin();
+             !keepExtractedFiles && fileIt != extractedFiles.end(); ++fileIt)
+          {
+          vtksys::SystemTools::RemoveFile(fileIt->c_str());
+          }
+        }
+      }
+
+    // The nodes that are only in scene views (e.g. deleted from the scene
+    // after the view was stored) read their files when the view is restored,
+    // their files are extracted too when the extracted files are kept
+    std::set<std::string> sceneViewEntries;
+    scene->GetNodesByClass("vtkMRMLSceneViewNode", nodes);
+    for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin();
+         keepExtractedFiles && it != nodes.end(); ++it)
+      {
+      vtkMRMLSceneViewNode* sceneViewNode = vtkMRMLSceneViewNode::SafeDownCast(*it);
+      vtkMRMLScene* storedScene = sceneViewNode ? sceneViewNode->GetStoredScene() : 0;
+      if (!storedScene || existingNodeSet.find(sceneViewNode) != existingNodeSet.end())
+        {
+        continue;
+        }
+      // The file names of the stored nodes are relative to the main scene
+      storedScene->SetRootDirectory(scene->GetRootDirectory());
+      std::vector<vtkMRMLNode*> storageNodes;
+      storedScene->GetNodesByClass("vtkMRMLStorageNode", storageNodes);
+      for (std::vector<vtkMRMLNode*>::iterator storageIt = storageNodes.begin();
+           storageIt != storageNodes.end(); ++storageIt)
+        {
+        std::set<std::string> entries = GetStorageNodeBundleEntries(
+          vtkMRMLStorageNode::SafeDownCast(*storageIt), bundleDirectory, bundleEntries);
+        for (std::set<std::string>::iterator entryIt = entries.begin(); entryIt != entries.end(); ++entryIt)
+          {
+          if (keptEntries.find(*entryIt) == keptEntries.end())
+            {
+            sceneViewEntries.insert(*entryIt);
+            }
+          }
+        }
+      }
+    if (!extract_archive_entries(sdbFilePath, bundleDirectory.c_str(), sceneViewEntries))
+      {
+      scene->SetErrorCode(1);
+      scene->SetErrorMessage("Error extracting the files of the scene views");
+      }
+    }
+
+  scene->EndState(vtkMRMLScene::ImportState);
+  if (clear)
+    {
+    scene->EndState(vtkMRMLScene::BatchProcessState);
+    scene->SetUndoFlag(undoFlag);
+    }
+  if (!success)
     {
-    vtkErrorMacro("Could not connect to scene");
+    vtkErrorMacro("Could not load scene from " << sdbFilePath);
     return false;
     }
   return true;
@@ -160,8 +160,27 @@ public:
   /// Open the file into a temp directory and load the scene file
   /// inside.  Note that the first mrml file found in the extracted
   /// directory will be used.
+  /// The data files read by the scene nodes are kept in the temporary
+  /// directory, as well as the files of the nodes only stored in scene
+  /// views, so that restoring a scene view can read them.
+  /// \sa LoadSlicerDataBundle()
   bool OpenSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory);
 
+  /// Load the scene of the bundle without unpacking it.
+  /// The scene file is read from the bundle into memory, then the files
+  /// of each storable node are extracted into \a temporaryDirectory only
+  /// when the node reads them. They are removed right after unless
+  /// \a keepExtractedFiles is true, in which case the files of the nodes
+  /// of the scene views are extracted too. Nodes whose files are not in the bundle
+  /// (absolute paths, URIs) read them as in vtkMRMLScene::Import().
+  /// The first mrml file in the bundle is used.
+  /// If \a clear is true the scene is cleared first, as by
+  /// vtkMRMLScene::Connect(), otherwise the bundle is imported.
+  /// Returns false if the scene could not be loaded, the scene error
+  /// code is set if a data file could not be read.
+  bool LoadSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory,
+                            bool clear = true, bool keepExtractedFiles = false);
+
   /// Unpack the file into a temp directory and return the scene file
   /// inside.  Note that the first mrml file found in the extracted
   /// directory will be used.
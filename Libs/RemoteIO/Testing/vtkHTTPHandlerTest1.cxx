@@ -0,0 +1,687 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// RemoteIO includes
+#include "vtkHTTPHandler.h"
+
+// MRML includes
+#include <vtkDataTransfer.h>
+#include <vtkMRMLCoreTestingMacros.h>
+
+// VTK includes
+#include <vtkClientSocket.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkServerSocket.h>
+#include <vtkSocketCollection.h>
+#include <vtkTimerLog.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <csignal>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+/// Minimal HTTP/1.1 server serving in-memory files on localhost.
+/// Connections are kept alive and each of them is served by its own thread.
+/// Every response is delayed by a latency to emulate a remote server.
+class TestHTTPServer
+{
+public:
+  TestHTTPServer();
+  ~TestHTTPServer();
+
+  /// Files must be added before the server is started.
+  void AddFile(const std::string& path, const std::string& content);
+  void SetLatency(unsigned int milliseconds);
+  /// When disabled, the server ignores range requests and always sends the
+  /// whole file. Enabled by default.
+  void SetRangeSupport(bool enabled);
+  /// Strong validator sent in the ETag header of a file
+  std::string GetETag(const std::string& path);
+
+  bool Start();
+  void Stop();
+  std::string GetURL(const std::string& path);
+
+  int GetNumberOfConnections();
+  std::string GetLastRange();
+  std::string GetLastIfRange();
+
+private:
+  struct Connection
+  {
+    TestHTTPServer* Server;
+    vtkClientSocket* Socket;
+    int ThreadID;
+    bool Finished;
+  };
+
+  static VTK_THREAD_RETURN_TYPE AcceptThreadFunction(void* arg);
+  static VTK_THREAD_RETURN_TYPE ConnectionThreadFunction(void* arg);
+  void AcceptConnections();
+  void ServeConnection(Connection* connection);
+  bool Respond(vtkClientSocket* socket, const std::string& header);
+  bool IsStopped();
+
+  std::map<std::string, std::string> Files;
+  unsigned int Latency;
+  bool RangeSupport;
+  vtkServerSocket* ServerSocket;
+  vtkMultiThreader* Threader;
+  int AcceptThreadID;
+
+  vtkSimpleMutexLock Lock;
+  bool Stopped;
+  int NumberOfConnections;
+  std::string LastRange;
+  std::string LastIfRange;
+};
+
+//---------------------------------------------------------------------------
+TestHTTPServer::TestHTTPServer()
+  : Latency(0)
+  , RangeSupport(true)
+  , ServerSocket(vtkServerSocket::New())
+  , Threader(vtkMultiThreader::New())
+  , AcceptThreadID(-1)
+  , Stopped(false)
+  , NumberOfConnections(0)
+{
+}
+
+//---------------------------------------------------------------------------
+TestHTTPServer::~TestHTTPServer()
+{
+  this->Stop();
+  this->ServerSocket->Delete();
+  this->Threader->Delete();
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::AddFile(const std::string& path, const std::string& content)
+{
+  this->Files[path] = content;
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::SetLatency(unsigned int milliseconds)
+{
+  this->Lock.Lock();
+  this->Latency = milliseconds;
+  this->Lock.Unlock();
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::SetRangeSupport(bool enabled)
+{
+  this->Lock.Lock();
+  this->RangeSupport = enabled;
+  this->Lock.Unlock();
+}
+
+//---------------------------------------------------------------------------
+std::string TestHTTPServer::GetETag(const std::string& path)
+{
+  std::map<std::string, std::string>::const_iterator file = this->Files.find(path);
+  unsigned long hash = 5381;
+  for (size_t i = 0; file != this->Files.end() && i < file->second.size(); ++i)
+    {
+    hash = hash * 33 + static_cast<unsigned char>(file->second[i]);
+    }
+  std::stringstream etag;
+  etag << "\"" << std::hex << hash << "\"";
+  return etag.str();
+}
+
+//---------------------------------------------------------------------------
+bool TestHTTPServer::Start()
+{
+  // Let the system choose a free port
+  if (this->ServerSocket->CreateServer(0) != 0)
+    {
+    return false;
+    }
+  this->AcceptThreadID = this->Threader->SpawnThread(
+    &TestHTTPServer::AcceptThreadFunction, this);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::Stop()
+{
+  if (this->AcceptThreadID < 0)
+    {
+    return;
+    }
+  this->Lock.Lock();
+  this->Stopped = true;
+  this->Lock.Unlock();
+  this->Threader->TerminateThread(this->AcceptThreadID);
+  this->AcceptThreadID = -1;
+  this->ServerSocket->CloseSocket();
+}
+
+//---------------------------------------------------------------------------
+std::string TestHTTPServer::GetURL(const std::string& path)
+{
+  std::stringstream url;
+  url << "http://127.0.0.1:" << this->ServerSocket->GetServerPort() << path;
+  return url.str();
+}
+
+//---------------------------------------------------------------------------
+int TestHTTPServer::GetNumberOfConnections()
+{
+  this->Lock.Lock();
+  int numberOfConnections = this->NumberOfConnections;
+  this->Lock.Unlock();
+  return numberOfConnections;
+}
+
+//---------------------------------------------------------------------------
+std::string TestHTTPServer::GetLastRange()
+{
+  this->Lock.Lock();
+  std::string range = this->LastRange;
+  this->Lock.Unlock();
+  return range;
+}
+
+//---------------------------------------------------------------------------
+std::string TestHTTPServer::GetLastIfRange()
+{
+  this->Lock.Lock();
+  std::string ifRange = this->LastIfRange;
+  this->Lock.Unlock();
+  return ifRange;
+}
+
+//---------------------------------------------------------------------------
+bool TestHTTPServer::IsStopped()
+{
+  this->Lock.Lock();
+  bool stopped = this->Stopped;
+  this->Lock.Unlock();
+  return stopped;
+}
+
+//---------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE TestHTTPServer::AcceptThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  static_cast<TestHTTPServer*>(info->UserData)->AcceptConnections();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//---------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE TestHTTPServer::ConnectionThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  Connection* connection = static_cast<Connection*>(info->UserData);
+  connection->Server->ServeConnection(connection);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::AcceptConnections()
+{
+  std::vector<Connection*> connections;
+  while (!this->IsStopped())
+    {
+    vtkClientSocket* socket = this->ServerSocket->WaitForConnection(100);
+    if (socket)
+      {
+      Connection* connection = new Connection;
+      connection->Server = this;
+      connection->Socket = socket;
+      connection->Finished = false;
+      this->Lock.Lock();
+      ++this->NumberOfConnections;
+      this->Lock.Unlock();
+      connection->ThreadID = this->Threader->SpawnThread(
+        &TestHTTPServer::ConnectionThreadFunction, connection);
+      connections.push_back(connection);
+      }
+    // Release the threads of closed connections
+    for (std::vector<Connection*>::iterator it = connections.begin(); it != connections.end();)
+      {
+      this->Lock.Lock();
+      bool finished = (*it)->Finished;
+      this->Lock.Unlock();
+      if (!finished)
+        {
+        ++it;
+        continue;
+        }
+      this->Threader->TerminateThread((*it)->ThreadID);
+      (*it)->Socket->Delete();
+      delete *it;
+      it = connections.erase(it);
+      }
+    }
+  // Connection threads exit as soon as they notice the server is stopped
+  for (size_t i = 0; i < connections.size(); ++i)
+    {
+    this->Threader->TerminateThread(connections[i]->ThreadID);
+    connections[i]->Socket->Delete();
+    delete connections[i];
+    }
+}
+
+//---------------------------------------------------------------------------
+void TestHTTPServer::ServeConnection(Connection* connection)
+{
+  vtkNew<vtkSocketCollection> sockets;
+  sockets->AddItem(connection->Socket);
+  std::string buffer;
+  while (!this->IsStopped())
+    {
+    std::string::size_type headerEnd = buffer.find("\r\n\r\n");
+    if (headerEnd == std::string::npos)
+      {
+      int selected = sockets->SelectSockets(100);
+      if (selected == 0)
+        {
+        continue;
+        }
+      char data[1024];
+      int received = (selected > 0 ? connection->Socket->Receive(data, sizeof(data), 0) : 0);
+      if (received <= 0)
+        {
+        // client closed the connection
+        break;
+        }
+      buffer.append(data, received);
+      continue;
+      }
+    std::string header = buffer.substr(0, headerEnd);
+    buffer.erase(0, headerEnd + 4);
+    if (!this->Respond(connection->Socket, header))
+      {
+      break;
+      }
+    }
+  connection->Socket->CloseSocket();
+  this->Lock.Lock();
+  connection->Finished = true;
+  this->Lock.Unlock();
+}
+
+//---------------------------------------------------------------------------
+bool TestHTTPServer::Respond(vtkClientSocket* socket, const std::string& header)
+{
+  std::istringstream lines(header);
+  std::string method;
+  std::string path;
+  std::string line;
+  lines >> method >> path;
+  std::getline(lines, line);
+  std::string range;
+  std::string ifRange;
+  bool closeConnection = false;
+  while (std::getline(lines, line))
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    if (line.find("Range: bytes=") == 0)
+      {
+      range = line.substr(13);
+      }
+    else if (line.find("If-Range: ") == 0)
+      {
+      ifRange = line.substr(10);
+      }
+    else if (line == "Connection: close")
+      {
+      closeConnection = true;
+      }
+    }
+
+  this->Lock.Lock();
+  this->LastRange = range;
+  this->LastIfRange = ifRange;
+  unsigned int latency = this->Latency;
+  bool rangeSupport = this->RangeSupport;
+  this->Lock.Unlock();
+  if (latency > 0)
+    {
+    vtksys::SystemTools::Delay(latency);
+    }
+
+  std::stringstream response;
+  std::string body;
+  std::map<std::string, std::string>::const_iterator file = this->Files.find(path);
+  if (method != "GET" || file == this->Files.end())
+    {
+    response << "HTTP/1.1 404 Not Found\r\n";
+    }
+  else if (range.empty() || !rangeSupport ||
+           (!ifRange.empty() && ifRange != this->GetETag(path)))
+    {
+    // the whole file is sent if the file changed since the validator was received
+    body = file->second;
+    response << "HTTP/1.1 200 OK\r\n"
+             << "ETag: " << this->GetETag(path) << "\r\n";
+    }
+  else
+    {
+    // "first-last" or "first-"
+    size_t size = file->second.size();
+    size_t first = 0;
+    size_t last = size - 1;
+    char separator = 0;
+    std::istringstream rangeStream(range);
+    rangeStream >> first >> separator;
+    if (!(rangeStream >> last) || last >= size)
+      {
+      last = size - 1;
+      }
+    if (first >= size || first > last)
+      {
+      response << "HTTP/1.1 416 Range Not Satisfiable\r\n"
+               << "Content-Range: bytes */" << size << "\r\n";
+      }
+    else
+      {
+      body = file->second.substr(first, last - first + 1);
+      response << "HTTP/1.1 206 Partial Content\r\n"
+               << "ETag: " << this->GetETag(path) << "\r\n"
+               << "Content-Range: bytes " << first << "-" << last << "/" << size << "\r\n";
+      }
+    }
+  response << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+  std::string data = response.str();
+  if (!socket->Send(data.c_str(), static_cast<int>(data.size())))
+    {
+    return false;
+    }
+  return !closeConnection;
+}
+
+//---------------------------------------------------------------------------
+std::string makeContent(size_t size, int seed)
+{
+  std::string content(size, ' ');
+  for (size_t i = 0; i < size; ++i)
+    {
+    content[i] = static_cast<char>('a' + (i * 7 + seed) % 26);
+    }
+  return content;
+}
+
+//---------------------------------------------------------------------------
+std::string readFile(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+//---------------------------------------------------------------------------
+void writeFile(const std::string& fileName, const std::string& content)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  file.write(content.c_str(), content.size());
+}
+
+//---------------------------------------------------------------------------
+int testDownload(TestHTTPServer& server, const std::string& tempDirectory,
+                 const std::string& content);
+int testRangeAndResume(TestHTTPServer& server, const std::string& tempDirectory,
+                       const std::string& content);
+int testThroughput(TestHTTPServer& server, const std::string& tempDirectory,
+                   const std::vector<std::string>& contents);
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkHTTPHandlerTest1(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDirectory = std::string(argv[1]) + "/vtkHTTPHandlerTest1";
+  vtksys::SystemTools::RemoveADirectory(tempDirectory.c_str());
+  vtksys::SystemTools::MakeDirectory(tempDirectory.c_str());
+#ifndef _WIN32
+  // Cancelled downloads close the connection while the server is sending
+  signal(SIGPIPE, SIG_IGN);
+#endif
+
+  TestHTTPServer server;
+  std::string content = makeContent(100000, 0);
+  server.AddFile("/volume.nrrd", content);
+  const int numberOfFiles = 16;
+  std::vector<std::string> contents;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream path;
+    path << "/file" << i << ".nrrd";
+    contents.push_back(makeContent(256 * 1024, i));
+    server.AddFile(path.str(), contents.back());
+    }
+  CHECK_BOOL(server.Start(), true);
+
+  CHECK_EXIT_SUCCESS(testDownload(server, tempDirectory, content));
+  CHECK_EXIT_SUCCESS(testRangeAndResume(server, tempDirectory, content));
+  CHECK_EXIT_SUCCESS(testThroughput(server, tempDirectory, contents));
+
+  server.Stop();
+  vtksys::SystemTools::RemoveADirectory(tempDirectory.c_str());
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int testDownload(TestHTTPServer& server, const std::string& tempDirectory,
+                 const std::string& content)
+{
+  vtkNew<vtkHTTPHandler> handler;
+  CHECK_INT(handler->CanHandleURI(server.GetURL("/volume.nrrd").c_str()), 1);
+
+  // Progress is reported in the data transfer
+  std::string destination = tempDirectory + "/volume.nrrd";
+  vtkNew<vtkDataTransfer> transfer;
+  transfer->SetProgress(0);
+  handler->StageFileRead(server.GetURL("/volume.nrrd").c_str(), destination.c_str(),
+                         transfer.GetPointer());
+  CHECK_BOOL(readFile(destination) == content, true);
+  CHECK_INT(transfer->GetProgress(), 100);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((destination + ".part").c_str()), false);
+
+  // Cancelled downloads don't overwrite the destination
+  transfer->SetCancelRequested(1);
+  writeFile(destination, "previous");
+  handler->SetEnableResume(0);
+  handler->StageFileRead(server.GetURL("/volume.nrrd").c_str(), destination.c_str(),
+                         transfer.GetPointer());
+  CHECK_BOOL(readFile(destination) == "previous", true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((destination + ".part").c_str()), false);
+
+  // HTTP errors are reported and don't create files
+  std::string missingDestination = tempDirectory + "/missing.nrrd";
+  std::vector<std::string> sources(1, server.GetURL("/missing.nrrd"));
+  std::vector<std::string> destinations(1, missingDestination);
+  vtkObject::GlobalWarningDisplayOff();
+  int numberOfFailures = handler->StageFilesRead(sources, destinations);
+  vtkObject::GlobalWarningDisplayOn();
+  CHECK_INT(numberOfFailures, 1);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(missingDestination.c_str()), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((missingDestination + ".part").c_str()), false);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testRangeAndResume(TestHTTPServer& server, const std::string& tempDirectory,
+                       const std::string& content)
+{
+  vtkNew<vtkHTTPHandler> handler;
+  std::string source = server.GetURL("/volume.nrrd");
+
+  std::string rangeDestination = tempDirectory + "/range.bin";
+  CHECK_BOOL(handler->StageFileReadRange(source.c_str(), rangeDestination.c_str(), 1000, 1999), true);
+  CHECK_STD_STRING(server.GetLastRange(), "1000-1999");
+  CHECK_BOOL(readFile(rangeDestination) == content.substr(1000, 1000), true);
+  CHECK_BOOL(handler->StageFileReadRange(source.c_str(), rangeDestination.c_str(), 99000, -1), true);
+  CHECK_BOOL(readFile(rangeDestination) == content.substr(99000), true);
+
+  // The whole file sent by a server that ignores ranges is rejected, the
+  // destination is not modified
+  server.SetRangeSupport(false);
+  vtkObject::GlobalWarningDisplayOff();
+  bool rangeRead = handler->StageFileReadRange(source.c_str(), rangeDestination.c_str(), 1000, 1999);
+  vtkObject::GlobalWarningDisplayOn();
+  server.SetRangeSupport(true);
+  CHECK_BOOL(rangeRead, false);
+  CHECK_STD_STRING(server.GetLastRange(), "1000-1999");
+  CHECK_BOOL(readFile(rangeDestination) == content.substr(99000), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists((rangeDestination + ".part").c_str()), false);
+
+  // An interrupted download is resumed from the partial file if the file
+  // did not change on the server
+  std::string destination = tempDirectory + "/resumed.nrrd";
+  std::string partialFile = destination + ".part";
+  std::string validatorFile = destination + ".part.validator";
+  std::string etag = server.GetETag("/volume.nrrd");
+  writeFile(partialFile, content.substr(0, 40000));
+  writeFile(validatorFile, etag + "\n");
+  handler->SetEnableResume(1);
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_STD_STRING(server.GetLastRange(), "40000-");
+  CHECK_STD_STRING(server.GetLastIfRange(), etag);
+  CHECK_BOOL(readFile(destination) == content, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFile.c_str()), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(validatorFile.c_str()), false);
+
+  // Without validator, the partial file is not trusted
+  writeFile(partialFile, std::string(40000, 'x'));
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_STD_STRING(server.GetLastRange(), "");
+  CHECK_BOOL(readFile(destination) == content, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFile.c_str()), false);
+
+  // The file changed on the server: it is sent again and replaces the
+  // partial file instead of being appended to it
+  writeFile(partialFile, std::string(40000, 'x'));
+  writeFile(validatorFile, "\"previous\"\n");
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_STD_STRING(server.GetLastRange(), "40000-");
+  CHECK_BOOL(readFile(destination) == content, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFile.c_str()), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(validatorFile.c_str()), false);
+
+  // Servers that don't support ranges send the whole file
+  server.SetRangeSupport(false);
+  writeFile(partialFile, std::string(40000, 'x'));
+  writeFile(validatorFile, etag + "\n");
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  server.SetRangeSupport(true);
+  CHECK_STD_STRING(server.GetLastRange(), "40000-");
+  CHECK_BOOL(readFile(destination) == content, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFile.c_str()), false);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testThroughput(TestHTTPServer& server, const std::string& tempDirectory,
+                   const std::vector<std::string>& contents)
+{
+  const int numberOfFiles = static_cast<int>(contents.size());
+  std::vector<std::string> sources;
+  std::vector<std::string> destinations;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream path;
+    path << "/file" << i << ".nrrd";
+    sources.push_back(server.GetURL(path.str()));
+    destinations.push_back(tempDirectory + path.str());
+    }
+  double megabytes = 0.;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    megabytes += contents[i].size() / 1000000.;
+    }
+  server.SetLatency(50);
+
+  // Previous behavior: one file at a time, one connection per file
+  vtkNew<vtkTimerLog> timer;
+  int connections = server.GetNumberOfConnections();
+  timer->StartTimer();
+  {
+  vtkNew<vtkHTTPHandler> handler;
+  handler->SetForbidReuse(1);
+  handler->SetMaximumNumberOfConcurrentTransfers(1);
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    handler->StageFileRead(sources[i].c_str(), destinations[i].c_str());
+    }
+  }
+  timer->StopTimer();
+  double sequentialTime = timer->GetElapsedTime();
+  CHECK_INT(server.GetNumberOfConnections() - connections, numberOfFiles);
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    CHECK_BOOL(readFile(destinations[i]) == contents[i], true);
+    vtksys::SystemTools::RemoveFile(destinations[i].c_str());
+    }
+
+  // Concurrent transfers reusing their connections
+  connections = server.GetNumberOfConnections();
+  timer->StartTimer();
+  {
+  vtkNew<vtkHTTPHandler> handler;
+  handler->SetMaximumNumberOfConcurrentTransfers(4);
+  CHECK_INT(handler->StageFilesRead(sources, destinations), 0);
+  }
+  timer->StopTimer();
+  double concurrentTime = timer->GetElapsedTime();
+  CHECK_BOOL(server.GetNumberOfConnections() - connections <= 4, true);
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    CHECK_BOOL(readFile(destinations[i]) == contents[i], true);
+    }
+  server.SetLatency(0);
+
+  std::cout << "<DartMeasurement name=\"vtkHTTPHandler-SequentialThroughput\" type=\"numeric/double\">"
+            << megabytes / sequentialTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"vtkHTTPHandler-ConcurrentThroughput\" type=\"numeric/double\">"
+            << megabytes / concurrentTime << "</DartMeasurement>" << std::endl;
+  // With a 50ms latency per request, 4 concurrent transfers must be faster.
+  CHECK_BOOL(concurrentTime < sequentialTime, true);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
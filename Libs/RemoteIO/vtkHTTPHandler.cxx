@@ -3,11 +3,27 @@
 #include "vtkHTTPHandler.h"
 
 // MRML includes
+#include <vtkDataTransfer.h>
 #include <vtkPermissionPrompter.h>
 
+// VTK includes
+#include <vtkConditionVariable.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
 // CURL includes
 #include <curl/curl.h>
 
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
 #if defined(_MSC_VER)
 #pragma warning ( disable : 4786 )
 #endif
@@ -19,9 +35,96 @@ public:
   vtkInternal(vtkHTTPHandler* external);
   ~vtkInternal();
 
+  /// A download handled by the transfer engine.
+  struct TransferRequest
+  {
+    TransferRequest(const std::string& source, const std::string& destination,
+                    vtkDataTransfer* dataTransfer = NULL)
+      : Source(source)
+      , Destination(destination)
+      , PartialFile(destination + ".part")
+      , ValidatorFile(destination + ".part.validator")
+      , DataTransfer(dataTransfer)
+      , ForbidReuse(0)
+      , Resume(0)
+      , RangeFirst(-1)
+      , ResumeFrom(0)
+      , ResponseChecked(false)
+      , ContentRangeStart(-1)
+      , DiscardPartialFile(false)
+      , File(NULL)
+      , Handle(NULL)
+      , Headers(NULL)
+      , Result(CURLE_OK)
+      , ResponseCode(0)
+      , Done(false)
+    {
+    }
+    std::string Source;
+    std::string Destination;
+    /// The file is downloaded into PartialFile and renamed into
+    /// Destination when the download succeeds.
+    std::string PartialFile;
+    /// ETag or Last-Modified date of the file being downloaded into
+    /// PartialFile. It is sent in If-Range when the download is resumed so
+    /// that the server sends the whole file if it has changed.
+    std::string ValidatorFile;
+    /// HTTP range ("first-last"), empty to download the whole file.
+    std::string Range;
+    /// First byte of Range, the server must send a response starting there.
+    curl_off_t RangeFirst;
+    vtkDataTransfer* DataTransfer;
+    int ForbidReuse;
+    int Resume;
+    curl_off_t ResumeFrom;
+    /// Set when the headers of the final response have been processed.
+    bool ResponseChecked;
+    /// Headers of the current response
+    std::string ETag;
+    std::string LastModified;
+    curl_off_t ContentRangeStart;
+    /// The partial file can't be resumed and must be removed.
+    bool DiscardPartialFile;
+    FILE* File;
+    CURL* Handle;
+    curl_slist* Headers;
+    CURLcode Result;
+    long ResponseCode;
+    bool Done;
+  };
+
+  /// Queue the requests, start the engine if needed and wait for their completion.
+  void RunTransfers(const std::vector<TransferRequest*>& requests);
+
+  static VTK_THREAD_RETURN_TYPE EngineThreadFunction(void* arg);
+  void RunEngine();
+  bool SetupTransfer(TransferRequest* request, CURL* handle);
+  void CompleteTransfer(TransferRequest* request, CURLcode result);
+
+  static size_t WriteCallback(void* ptr, size_t size, size_t nmemb, void* userData);
+  static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userData);
+  static int ProgressCallback(void* clientData, double dltotal, double dlnow,
+                              double ultotal, double ulnow);
+#if LIBCURL_VERSION_NUM >= 0x072000
+  static int TransferInfoCallback(void* clientData, curl_off_t dltotal, curl_off_t dlnow,
+                                  curl_off_t ultotal, curl_off_t ulnow);
+#endif
+
   vtkHTTPHandler* External;
+  /// Easy handle used for uploads
   CURL* CurlHandle;
+  vtkSimpleMutexLock UploadLock;
   int ForbidReuse;
+  int EnableResume;
+  int MaximumNumberOfConcurrentTransfers;
+
+  /// Transfer engine, Lock protects the members below.
+  vtkMultiThreader* Threader;
+  int EngineThreadID;
+  bool StopEngine;
+  vtkSimpleMutexLock Lock;
+  vtkConditionVariable* Condition;
+  std::deque<TransferRequest*> PendingRequests;
 };
 
 //----------------------------------------------------------------------------
@@ -32,68 +135,507 @@ vtkHTTPHandler::vtkInternal::vtkInternal(vtkHTTPHandler* external):External(exte
 {
   this->CurlHandle = NULL;
   this->ForbidReuse = 0;
+  this->EnableResume = 1;
+  this->MaximumNumberOfConcurrentTransfers = 4;
+  this->Threader = vtkMultiThreader::New();
+  this->EngineThreadID = -1;
+  this->StopEngine = false;
+  this->Condition = vtkConditionVariable::New();
 }
 
 //-----------------------------------------------------------------------------
 vtkHTTPHandler::vtkInternal::~vtkInternal()
 {
+  this->Lock.Lock();
+  this->StopEngine = true;
+  this->Condition->Broadcast();
+  this->Lock.Unlock();
+  if (this->EngineThreadID >= 0)
+    {
+    this->Threader->TerminateThread(this->EngineThreadID);
+    }
+  this->Threader->Delete();
+  this->Condition->Delete();
   this->CurlHandle = NULL;
 }
 
-//----------------------------------------------------------------------------
-// vtkHTTPHandler methods
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::RunTransfers(const std::vector<TransferRequest*>& requests)
+{
+  this->Lock.Lock();
+  if (this->EngineThreadID < 0)
+    {
+    this->EngineThreadID = this->Threader->SpawnThread(
+      &vtkHTTPHandler::vtkInternal::EngineThreadFunction, this);
+    }
+  for (size_t i = 0; i < requests.size(); ++i)
+    {
+    requests[i]->ForbidReuse = this->ForbidReuse;
+    requests[i]->Resume = this->EnableResume && requests[i]->Range.empty();
+    this->PendingRequests.push_back(requests[i]);
+    }
+  this->Condition->Broadcast();
+  for (size_t i = 0; i < requests.size(); ++i)
+    {
+    while (!requests[i]->Done)
+      {
+      this->Condition->Wait(this->Lock);
+      }
+    }
+  this->Lock.Unlock();
+}
 
-//----------------------------------------------------------------------------
-vtkStandardNewMacro ( vtkHTTPHandler );
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkHTTPHandler::vtkInternal::EngineThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  static_cast<vtkInternal*>(info->UserData)->RunEngine();
+  return VTK_THREAD_RETURN_VALUE;
+}
 
-//----------------------------------------------------------------------------
-size_t read_callback(void *ptr, size_t size, size_t nmemb, FILE *stream)
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::RunEngine()
 {
-  size_t retcode;
+  CURLM* multiHandle = curl_multi_init();
+  // Easy handles are kept after their transfer so that their connections
+  // can be reused by the next requests.
+  std::vector<CURL*> idleHandles;
+  std::vector<TransferRequest*> activeRequests;
 
-  /* in real-world cases, this would probably get this data differently
-     as this fread() stuff is exactly what the library already would do
-     by default internally */
-  retcode = fread(ptr, size, nmemb, stream);
+  while (true)
+    {
+    std::vector<TransferRequest*> newRequests;
+    this->Lock.Lock();
+    while (!this->StopEngine && activeRequests.empty() && this->PendingRequests.empty())
+      {
+      this->Condition->Wait(this->Lock);
+      }
+    const size_t maximumNumberOfTransfers =
+      static_cast<size_t>(std::max(1, this->MaximumNumberOfConcurrentTransfers));
+    while (!this->PendingRequests.empty() &&
+           activeRequests.size() + newRequests.size() < maximumNumberOfTransfers)
+      {
+      newRequests.push_back(this->PendingRequests.front());
+      this->PendingRequests.pop_front();
+      }
+    bool stop = this->StopEngine;
+    this->Lock.Unlock();
+    if (stop)
+      {
+      break;
+      }
 
-  std::cout << "*** We read " << retcode << " bytes from file\n";
+    for (size_t i = 0; i < newRequests.size(); ++i)
+      {
+      CURL* handle = NULL;
+      if (idleHandles.empty())
+        {
+        handle = curl_easy_init();
+        }
+      else
+        {
+        handle = idleHandles.back();
+        idleHandles.pop_back();
+        curl_easy_reset(handle);
+        }
+      if (!handle || !this->SetupTransfer(newRequests[i], handle))
+        {
+        if (handle)
+          {
+          idleHandles.push_back(handle);
+          }
+        newRequests[i]->Handle = NULL;
+        this->CompleteTransfer(newRequests[i], handle ? CURLE_WRITE_ERROR : CURLE_FAILED_INIT);
+        continue;
+        }
+      curl_multi_add_handle(multiHandle, handle);
+      activeRequests.push_back(newRequests[i]);
+      }
 
-  return retcode;
+    int runningHandles = 0;
+    curl_multi_perform(multiHandle, &runningHandles);
+
+    CURLMsg* message = NULL;
+    int remainingMessages = 0;
+    while ((message = curl_multi_info_read(multiHandle, &remainingMessages)) != NULL)
+      {
+      if (message->msg != CURLMSG_DONE)
+        {
+        continue;
+        }
+      CURL* handle = message->easy_handle;
+      CURLcode result = message->data.result;
+      char* privateData = NULL;
+      curl_easy_getinfo(handle, CURLINFO_PRIVATE, &privateData);
+      TransferRequest* request = reinterpret_cast<TransferRequest*>(privateData);
+      curl_multi_remove_handle(multiHandle, handle);
+      idleHandles.push_back(handle);
+      activeRequests.erase(std::find(activeRequests.begin(), activeRequests.end(), request));
+      this->CompleteTransfer(request, result);
+      }
+
+    if (!activeRequests.empty())
+      {
+#if LIBCURL_VERSION_NUM >= 0x071C00
+      curl_multi_wait(multiHandle, NULL, 0, 20, NULL);
+#else
+      // curl_multi_wait() requires curl 7.28
+      fd_set readSet;
+      fd_set writeSet;
+      fd_set exceptionSet;
+      FD_ZERO(&readSet);
+      FD_ZERO(&writeSet);
+      FD_ZERO(&exceptionSet);
+      int maximumFileDescriptor = -1;
+      curl_multi_fdset(multiHandle, &readSet, &writeSet, &exceptionSet, &maximumFileDescriptor);
+      if (maximumFileDescriptor < 0)
+        {
+        // no socket to wait for yet (e.g. name resolution)
+        vtksys::SystemTools::Delay(20);
+        }
+      else
+        {
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 20000;
+        select(maximumFileDescriptor + 1, &readSet, &writeSet, &exceptionSet, &timeout);
+        }
+#endif
+      }
+    }
+
+  // The handler is being deleted: abort everything that is still running
+  for (size_t i = 0; i < activeRequests.size(); ++i)
+    {
+    curl_multi_remove_handle(multiHandle, activeRequests[i]->Handle);
+    idleHandles.push_back(activeRequests[i]->Handle);
+    this->CompleteTransfer(activeRequests[i], CURLE_ABORTED_BY_CALLBACK);
+    }
+  this->Lock.Lock();
+  while (!this->PendingRequests.empty())
+    {
+    TransferRequest* request = this->PendingRequests.front();
+    this->PendingRequests.pop_front();
+    request->Result = CURLE_ABORTED_BY_CALLBACK;
+    request->Done = true;
+    }
+  this->Condition->Broadcast();
+  this->Lock.Unlock();
+  for (size_t i = 0; i < idleHandles.size(); ++i)
+    {
+    curl_easy_cleanup(idleHandles[i]);
+    }
+  curl_multi_cleanup(multiHandle);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkHTTPHandler::vtkInternal::SetupTransfer(TransferRequest* request, CURL* handle)
+{
+  request->Handle = handle;
+  request->ResumeFrom = 0;
+  request->ResponseChecked = false;
+  request->ETag.clear();
+  request->LastModified.clear();
+  request->ContentRangeStart = -1;
+  request->DiscardPartialFile = false;
+  // A partial file can only be resumed if the server can tell whether the
+  // file has changed since it was downloaded.
+  std::string validator;
+  if (request->Resume && vtksys::SystemTools::FileExists(request->PartialFile.c_str(), true))
+    {
+    std::ifstream validatorFile(request->ValidatorFile.c_str());
+    std::getline(validatorFile, validator);
+    if (!validator.empty())
+      {
+      request->ResumeFrom = static_cast<curl_off_t>(
+        vtksys::SystemTools::FileLength(request->PartialFile.c_str()));
+      }
+    }
+  request->File = fopen(request->PartialFile.c_str(), request->ResumeFrom > 0 ? "ab" : "wb");
+  if (request->File == NULL)
+    {
+    return false;
+    }
+
+  if (request->ForbidReuse)
+    {
+    curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 1L);
+    }
+  curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  curl_easy_setopt(handle, CURLOPT_URL, request->Source.c_str());
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+  // HTTP errors (e.g. 404) fail the transfer instead of being saved as the file
+  curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
+  curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 3L); // in seconds (type long)
+  // curl must not install signal handlers from a secondary thread
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &vtkInternal::WriteCallback);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, request);
+  curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &vtkInternal::HeaderCallback);
+  curl_easy_setopt(handle, CURLOPT_HEADERDATA, request);
+  curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+#if LIBCURL_VERSION_NUM >= 0x072000
+  curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, &vtkInternal::TransferInfoCallback);
+  curl_easy_setopt(handle, CURLOPT_XFERINFODATA, request);
+#else
+  curl_easy_setopt(handle, CURLOPT_PROGRESSFUNCTION, &vtkInternal::ProgressCallback);
+  curl_easy_setopt(handle, CURLOPT_PROGRESSDATA, request);
+#endif
+  curl_easy_setopt(handle, CURLOPT_PRIVATE, request);
+  if (!request->Range.empty())
+    {
+    curl_easy_setopt(handle, CURLOPT_RANGE, request->Range.c_str());
+    }
+  else if (request->ResumeFrom > 0)
+    {
+    // CURLOPT_RESUME_FROM_LARGE is not used: curl fails the transfer when
+    // the server replies with the whole file, HeaderCallback restarts it instead.
+    std::stringstream range;
+    range << request->ResumeFrom << "-";
+    curl_easy_setopt(handle, CURLOPT_RANGE, range.str().c_str());
+    request->Headers = curl_slist_append(request->Headers, ("If-Range: " + validator).c_str());
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, request->Headers);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::CompleteTransfer(TransferRequest* request, CURLcode result)
+{
+  if (request->File)
+    {
+    fclose(request->File);
+    request->File = NULL;
+    }
+  if (request->Handle)
+    {
+    curl_easy_getinfo(request->Handle, CURLINFO_RESPONSE_CODE, &request->ResponseCode);
+    request->Handle = NULL;
+    }
+  if (request->Headers)
+    {
+    curl_slist_free_all(request->Headers);
+    request->Headers = NULL;
+    }
+  if (result == CURLE_OK && (request->ResumeFrom > 0 || !request->Range.empty()) &&
+      !request->ResponseChecked)
+    {
+    // No response header was received, the partial file can't be trusted
+    result = CURLE_RANGE_ERROR;
+    request->DiscardPartialFile = true;
+    }
+  if (result == CURLE_WRITE_ERROR && request->DiscardPartialFile)
+    {
+    // HeaderCallback rejected the range sent by the server
+    result = CURLE_RANGE_ERROR;
+    }
+  if (result == CURLE_OK)
+    {
+    vtksys::SystemTools::RemoveFile(request->Destination.c_str());
+    if (rename(request->PartialFile.c_str(), request->Destination.c_str()) != 0)
+      {
+      result = CURLE_WRITE_ERROR;
+      }
+    else if (request->DataTransfer)
+      {
+      request->DataTransfer->SetProgressNoModify(100);
+      }
+    }
+  // Keep partially downloaded data to resume later, unless the server refused
+  // the request (the partial file may be complete or stale) or did not send
+  // a validator to check that the file is unchanged when it is resumed.
+  std::string validator = !request->ETag.empty() ? request->ETag : request->LastModified;
+  bool keepPartialFile = result != CURLE_OK && request->Resume &&
+    result != CURLE_HTTP_RETURNED_ERROR && !request->DiscardPartialFile &&
+    !validator.empty() && vtksys::SystemTools::FileExists(request->PartialFile.c_str(), true);
+  if (keepPartialFile)
+    {
+    std::ofstream validatorFile(request->ValidatorFile.c_str());
+    validatorFile << validator << "\n";
+    keepPartialFile = validatorFile.good();
+    }
+  if (!keepPartialFile)
+    {
+    if (result != CURLE_OK)
+      {
+      vtksys::SystemTools::RemoveFile(request->PartialFile.c_str());
+      }
+    vtksys::SystemTools::RemoveFile(request->ValidatorFile.c_str());
+    }
+
+  this->Lock.Lock();
+  request->Result = result;
+  request->Done = true;
+  this->Condition->Broadcast();
+  this->Lock.Unlock();
 }
 
 //----------------------------------------------------------------------------
-size_t write_callback(void *ptr, size_t size, size_t nmemb, void *stream)
+size_t vtkHTTPHandler::vtkInternal::WriteCallback(void* ptr, size_t size, size_t nmemb, void* userData)
 {
-  if (stream == NULL)
+  TransferRequest* request = static_cast<TransferRequest*>(userData);
+  if (request->File == NULL)
     {
-    std::cerr << "write_callback: can't write, stream is null. size = " << size << std::endl;
     return 0;
     }
-  int written = fwrite(ptr, size, nmemb, (FILE *)stream);
-  return written;
+  return fwrite(ptr, 1, size * nmemb, request->File);
 }
 
 //----------------------------------------------------------------------------
-size_t ProgressCallback(FILE* vtkNotUsed( outputFile ), double dltotal, double dlnow, double ultotal, double ulnow)
+size_t vtkHTTPHandler::vtkInternal::HeaderCallback(char* buffer, size_t size, size_t nitems, void* userData)
 {
-  if(ultotal == 0)
+  TransferRequest* request = static_cast<TransferRequest*>(userData);
+  size_t length = size * nitems;
+  std::string line(buffer, length);
+  while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r'))
+    {
+    line.erase(line.size() - 1);
+    }
+  if (line.compare(0, 5, "HTTP/") == 0)
     {
-    if(dltotal > 0)
+    // Status line: headers of a new response (e.g. after a redirection)
+    request->ETag.clear();
+    request->LastModified.clear();
+    request->ContentRangeStart = -1;
+    return length;
+    }
+  if (!line.empty())
+    {
+    std::string::size_type colon = line.find(':');
+    if (colon == std::string::npos)
+      {
+      return length;
+      }
+    std::string name = vtksys::SystemTools::LowerCase(line.substr(0, colon));
+    std::string value = line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    if (name == "etag" && value.compare(0, 2, "W/") != 0)
+      {
+      // weak validators can't be used in If-Range
+      request->ETag = value;
+      }
+    else if (name == "last-modified")
+      {
+      request->LastModified = value;
+      }
+    else if (name == "content-range" && value.compare(0, 6, "bytes ") == 0)
       {
-      std::cout << "<filter-progress>" << dlnow/dltotal
-                << "</filter-progress>" << std::endl;
+      std::istringstream range(value.substr(6));
+      long long first = -1;
+      if (range >> first)
+        {
+        request->ContentRangeStart = static_cast<curl_off_t>(first);
+        }
       }
+    return length;
     }
-  else
+
+  // End of the headers, ignore informational responses and redirections
+  long responseCode = 0;
+  curl_easy_getinfo(request->Handle, CURLINFO_RESPONSE_CODE, &responseCode);
+  if (responseCode < 200 || (responseCode >= 300 && responseCode < 400) ||
+      request->ResponseChecked)
+    {
+    return length;
+    }
+  request->ResponseChecked = true;
+  if (responseCode >= 400)
+    {
+    return length;
+    }
+  if (!request->Range.empty())
+    {
+    // Only the requested range can be written into the destination, a
+    // server ignoring the range would send the whole file instead.
+    if (responseCode == 206 && request->ContentRangeStart == request->RangeFirst)
+      {
+      return length;
+      }
+    request->DiscardPartialFile = true;
+    return 0;
+    }
+  if (request->ResumeFrom <= 0)
+    {
+    return length;
+    }
+  if (responseCode == 206 && request->ContentRangeStart == request->ResumeFrom)
+    {
+    return length;
+    }
+  if (responseCode == 206)
+    {
+    // unexpected range, the partial file can't be completed
+    request->DiscardPartialFile = true;
+    return 0;
+    }
+  // The server sent the whole file, either because it doesn't support ranges
+  // or because the file changed since the partial download: restart from scratch.
+  fclose(request->File);
+  request->File = fopen(request->PartialFile.c_str(), "wb");
+  request->ResumeFrom = 0;
+  return request->File ? length : 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::vtkInternal::ProgressCallback(void* clientData, double dltotal, double dlnow,
+                                                  double vtkNotUsed(ultotal), double vtkNotUsed(ulnow))
+{
+  TransferRequest* request = static_cast<TransferRequest*>(clientData);
+  if (request->DataTransfer == NULL)
+    {
+    return 0;
+    }
+  if (request->DataTransfer->GetCancelRequested())
+    {
+    // abort the transfer
+    return 1;
+    }
+  if (dltotal > 0)
     {
-    std::cout << ulnow*100/ultotal << "%" << std::endl;
+    double resumeFrom = static_cast<double>(request->ResumeFrom);
+    request->DataTransfer->SetProgressNoModify(
+      static_cast<int>(100. * (resumeFrom + dlnow) / (resumeFrom + dltotal)));
     }
   return 0;
 }
 
+#if LIBCURL_VERSION_NUM >= 0x072000
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::vtkInternal::TransferInfoCallback(void* clientData, curl_off_t dltotal, curl_off_t dlnow,
+                                                      curl_off_t ultotal, curl_off_t ulnow)
+{
+  return vtkInternal::ProgressCallback(clientData,
+    static_cast<double>(dltotal), static_cast<double>(dlnow),
+    static_cast<double>(ultotal), static_cast<double>(ulnow));
+}
+#endif
+
+//----------------------------------------------------------------------------
+// vtkHTTPHandler methods
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro ( vtkHTTPHandler );
+
+//----------------------------------------------------------------------------
+size_t read_callback(void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+  size_t retcode;
+
+  /* in real-world cases, this would probably get this data differently
+     as this fread() stuff is exactly what the library already would do
+     by default internally */
+  retcode = fread(ptr, size, nmemb, stream);
+
+  std::cout << "*** We read " << retcode << " bytes from file\n";
+
+  return retcode;
+}
+
 //----------------------------------------------------------------------------
 vtkHTTPHandler::vtkHTTPHandler()
 {
+  curl_global_init(CURL_GLOBAL_ALL);
   this->Internal = new vtkInternal(this);
 }
 
@@ -101,12 +643,17 @@ vtkHTTPHandler::vtkHTTPHandler()
 vtkHTTPHandler::~vtkHTTPHandler()
 {
   delete this->Internal;
+  curl_global_cleanup();
 }
 
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf ( os, indent );
+  os << indent << "ForbidReuse: " << this->GetForbidReuse() << "\n";
+  os << indent << "EnableResume: " << this->GetEnableResume() << "\n";
+  os << indent << "MaximumNumberOfConcurrentTransfers: "
+     << this->GetMaximumNumberOfConcurrentTransfers() << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -162,10 +709,46 @@ int vtkHTTPHandler::GetForbidReuse()
   return this->Internal->ForbidReuse;
 }
 
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::SetMaximumNumberOfConcurrentTransfers(int value)
+{
+  if (this->Internal->MaximumNumberOfConcurrentTransfers == value)
+    {
+    return;
+    }
+  this->Internal->Lock.Lock();
+  this->Internal->MaximumNumberOfConcurrentTransfers = value;
+  this->Internal->Condition->Broadcast();
+  this->Internal->Lock.Unlock();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetMaximumNumberOfConcurrentTransfers()
+{
+  return this->Internal->MaximumNumberOfConcurrentTransfers;
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::SetEnableResume(int value)
+{
+  if (this->Internal->EnableResume == value)
+    {
+    return;
+    }
+  this->Internal->EnableResume = value;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetEnableResume()
+{
+  return this->Internal->EnableResume;
+}
+
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::InitTransfer( )
 {
-  curl_global_init(CURL_GLOBAL_ALL);
   vtkDebugMacro("vtkHTTPHandler: InitTransfer: initialising CurlHandle");
   this->Internal->CurlHandle = curl_easy_init();
   if (this->Internal->CurlHandle == NULL)
@@ -184,49 +767,92 @@ int vtkHTTPHandler::CloseTransfer( )
 
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::StageFileRead(const char * source, const char * destination)
+{
+  this->StageFileRead(source, destination, NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::StageFileRead(const char * source, const char * destination,
+                                   vtkDataTransfer* transfer)
 {
   if (source == NULL || destination == NULL)
     {
     vtkErrorMacro("StageFileRead: source or dest is null!");
     return;
     }
-  /*
-  if (this->LocalFile)
+  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
+  vtkInternal::TransferRequest request(source, destination, transfer);
+  std::vector<vtkInternal::TransferRequest*> requests(1, &request);
+  this->Internal->RunTransfers(requests);
+  this->ReportTransferResult(request.Source.c_str(), request.Result, request.ResponseCode);
+}
+
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::StageFileReadRange(const char * source, const char * destination,
+                                        vtkIdType first, vtkIdType last)
+{
+  if (source == NULL || destination == NULL || first < 0)
     {
-    this->LocalFile->close();
-    delete this->LocalFile;
-    this->LocalFile = NULL;
+    vtkErrorMacro("StageFileReadRange: invalid source, dest or range");
+    return false;
     }
-  this->LocalFile = new std::ofstream(destination, std::ios::binary);
-  */
-  this->InitTransfer( );
-
-
-  if ( this->Internal->ForbidReuse )
+  vtkInternal::TransferRequest request(source, destination);
+  std::stringstream range;
+  range << first << "-";
+  if (last >= 0)
     {
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FORBID_REUSE, 1);
+    range << last;
     }
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_HTTPGET, 1);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_URL, source);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_NOPROGRESS, false);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FOLLOWLOCATION, true);
-  // use the default curl write call back
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEFUNCTION, NULL); // write_callback);
-  this->LocalFile = fopen(destination, "wb");
-  // output goes into LocalFile, must be  FILE*
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEDATA, this->LocalFile);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSDATA, NULL);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSFUNCTION, ProgressCallback);
-
-  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+  request.Range = range.str();
+  request.RangeFirst = static_cast<curl_off_t>(first);
+  std::vector<vtkInternal::TransferRequest*> requests(1, &request);
+  this->Internal->RunTransfers(requests);
+  return this->ReportTransferResult(request.Source.c_str(), request.Result, request.ResponseCode);
+}
 
-  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
-  CURLcode retval = curl_easy_perform(this->Internal->CurlHandle);
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::StageFilesRead(const std::vector<std::string>& sources,
+                                   const std::vector<std::string>& destinations)
+{
+  if (sources.size() != destinations.size())
+    {
+    vtkErrorMacro("StageFilesRead: " << sources.size() << " sources for "
+                  << destinations.size() << " destinations");
+    return static_cast<int>(sources.size());
+    }
+  std::deque<vtkInternal::TransferRequest> transfers;
+  std::vector<vtkInternal::TransferRequest*> requests;
+  for (size_t i = 0; i < sources.size(); ++i)
+    {
+    transfers.push_back(vtkInternal::TransferRequest(sources[i], destinations[i]));
+    requests.push_back(&transfers.back());
+    }
+  this->Internal->RunTransfers(requests);
+  int numberOfFailures = 0;
+  for (size_t i = 0; i < requests.size(); ++i)
+    {
+    if (!this->ReportTransferResult(requests[i]->Source.c_str(),
+                                    requests[i]->Result, requests[i]->ResponseCode))
+      {
+      ++numberOfFailures;
+      }
+    }
+  return numberOfFailures;
+}
 
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::ReportTransferResult(const char* source, int result, long responseCode)
+{
+  CURLcode retval = static_cast<CURLcode>(result);
   if (retval == CURLE_OK)
     {
     vtkDebugMacro("StageFileRead: successful return from curl");
+    return true;
+    }
+  else if (retval == CURLE_ABORTED_BY_CALLBACK)
+    {
+    vtkDebugMacro("StageFileRead: download of " << source << " was cancelled");
+    return false;
     }
   else if (retval == CURLE_BAD_FUNCTION_ARGUMENT)
     {
@@ -239,7 +865,8 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
   else
     {
     const char *stringError = curl_easy_strerror(retval);
-    vtkErrorMacro("StageFileRead: error running curl: " << stringError);
+    vtkErrorMacro("StageFileRead: error running curl on " << source << ": " << stringError
+                  << " (HTTP response code " << responseCode << ")");
     //--- in case the permissions were not correct and that's
     //--- the reason the read command failed,
     //--- reset the 'remember check' in the permissions
@@ -249,20 +876,9 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
       this->GetPermissionPrompter()->SetRemember ( 0 );
       }
     }
-  this->CloseTransfer();
-
-  /*
-  this->LocalFile->close();
-  delete this->LocalFile;
-  this->LocalFile = NULL;
-  */
-  if (this->LocalFile)
-    {
-    fclose(this->LocalFile);
-    }
+  return false;
 }
 
-
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::StageFileWrite(const char * source, const char * destination)
 {
@@ -276,6 +892,8 @@ void vtkHTTPHandler::StageFileWrite(const char * source, const char * destinatio
     }
   this->LocalFile = new std::ofstream(destination, std::ios::binary);
   */
+  // Uploads are not handled by the transfer engine, run one at a time.
+  this->Internal->UploadLock.Lock();
   this->LocalFile = fopen(source, "r");
 
   this->InitTransfer( );
@@ -311,6 +929,8 @@ void vtkHTTPHandler::StageFileWrite(const char * source, const char * destinatio
   this->CloseTransfer();
 
   fclose(this->LocalFile);
+  this->LocalFile = NULL;
+  this->Internal->UploadLock.Unlock();
   /*
   this->LocalFile->close();
   delete this->LocalFile;
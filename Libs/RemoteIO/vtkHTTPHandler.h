@@ -32,9 +32,42 @@ public:
   void SetForbidReuse(int value);
   int GetForbidReuse();
 
+  /// Maximum number of downloads that are run concurrently (4 by default).
+  /// Downloads are driven by a single transfer engine thread that reuses
+  /// the connections to the servers; requests exceeding this limit are queued.
+  void SetMaximumNumberOfConcurrentTransfers(int value);
+  int GetMaximumNumberOfConcurrentTransfers();
+
+  /// When set (default), an interrupted download is kept next to its
+  /// destination ("<destination>.part") and resumed by the next read of the
+  /// same file. Otherwise the partial file is removed.
+  /// The ETag (or Last-Modified date) of the file is kept in
+  /// "<destination>.part.validator" and sent with the range request: if the
+  /// file changed on the server, or if the server does not support ranges,
+  /// the whole file is downloaded again. Downloads from servers that send no
+  /// validator are not kept.
+  void SetEnableResume(int value);
+  int GetEnableResume();
+
   /// This function wraps curl functionality to download a specified URL to a specified dir
+  /// It blocks until the download is completed.
   virtual void StageFileRead(const char * source, const char * destination) VTK_OVERRIDE;
+  /// Download a file and report its progress into \a transfer. The download
+  /// is aborted if a cancel is requested on the transfer.
+  virtual void StageFileRead(const char * source, const char * destination,
+                             vtkDataTransfer* transfer) VTK_OVERRIDE;
   using vtkURIHandler::StageFileRead;
+  /// Download the bytes [first, last] of a file. A negative \a last reads
+  /// until the end of the file. Returns true on success, false if the server
+  /// does not send the requested range (e.g. it ignores ranges and sends the
+  /// whole file), in which case \a destination is not modified.
+  bool StageFileReadRange(const char * source, const char * destination,
+                          vtkIdType first, vtkIdType last);
+  /// Download several files concurrently, up to
+  /// GetMaximumNumberOfConcurrentTransfers() at a time.
+  /// Returns the number of files that could not be downloaded.
+  virtual int StageFilesRead(const std::vector<std::string>& sources,
+                             const std::vector<std::string>& destinations) VTK_OVERRIDE;
   virtual void StageFileWrite(const char * source, const char * destination) VTK_OVERRIDE;
   using vtkURIHandler::StageFileWrite;
   virtual void InitTransfer () VTK_OVERRIDE;
@@ -46,6 +79,9 @@ protected:
   vtkHTTPHandler(const vtkHTTPHandler&);
   void operator=(const vtkHTTPHandler&);
 
+  /// Report an error if a download failed. Returns true on success.
+  bool ReportTransferResult(const char* source, int result, long responseCode);
+
 private:
   class vtkInternal;
   vtkInternal* Internal;
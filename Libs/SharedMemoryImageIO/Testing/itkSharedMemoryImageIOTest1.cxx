@@ -0,0 +1,346 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SharedMemoryImageIO includes
+#include "itkSharedMemoryImageIO.h"
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkIntTypes.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+typedef itk::Image<short, 3> ImageType;
+
+//----------------------------------------------------------------------------
+std::string segmentFileName(const char* suffix)
+{
+  std::stringstream fileName;
+#ifndef _WIN32
+  fileName << "shm:/itkSharedMemoryImageIOTest1-" << getpid() << "-" << suffix;
+#else
+  fileName << "shm:/itkSharedMemoryImageIOTest1-" << suffix;
+#endif
+  return fileName.str();
+}
+
+//----------------------------------------------------------------------------
+ImageType::Pointer createImage()
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 7; size[1] = 5; size[2] = 3;
+  ImageType::RegionType region;
+  region.SetSize(size);
+  image->SetRegions(region);
+  double spacing[3] = {0.5, 1.5, 2.5};
+  image->SetSpacing(spacing);
+  double origin[3] = {-10., 20., 30.};
+  image->SetOrigin(origin);
+  ImageType::DirectionType direction;
+  direction.Fill(0.);
+  direction[0][1] = 1.;
+  direction[1][0] = -1.;
+  direction[2][2] = 1.;
+  image->SetDirection(direction);
+  image->Allocate();
+  short value = -100;
+  itk::ImageRegionIterator<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    it.Set(value++);
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+// Return true if reading the segment throws an exception.
+bool readFails(const std::string& fileName)
+{
+  itk::SharedMemoryImageIO::Pointer io = itk::SharedMemoryImageIO::New();
+  io->SetFileName(fileName);
+  try
+    {
+    io->ReadImageInformation();
+    }
+  catch (itk::ExceptionObject&)
+    {
+    return true;
+    }
+  return false;
+}
+
+#ifndef _WIN32
+//----------------------------------------------------------------------------
+// Overwrite bytes of an existing segment.
+bool patchSegment(const std::string& fileName, size_t offset, const void* data, size_t size)
+{
+  std::string segmentName = fileName.substr(std::strlen("shm:"));
+  int fd = shm_open(segmentName.c_str(), O_RDWR, 0);
+  if (fd == -1)
+    {
+    return false;
+    }
+  void* segment = mmap(0, offset + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED)
+    {
+    return false;
+    }
+  memcpy(static_cast<char*>(segment) + offset, data, size);
+  munmap(segment, offset + size);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Create a segment that only contains the given bytes.
+bool createRawSegment(const std::string& fileName, const void* data, size_t size)
+{
+  std::string segmentName = fileName.substr(std::strlen("shm:"));
+  int fd = shm_open(segmentName.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd == -1)
+    {
+    return false;
+    }
+  bool success = (write(fd, data, size) == static_cast<ssize_t>(size));
+  close(fd);
+  return success;
+}
+#endif
+
+//----------------------------------------------------------------------------
+int testFileNames()
+{
+  if (!itk::SharedMemoryImageIO::IsSharedMemoryFileName("shm:/image") ||
+      itk::SharedMemoryImageIO::IsSharedMemoryFileName("shm:image") ||
+      itk::SharedMemoryImageIO::IsSharedMemoryFileName("/tmp/image.nrrd") ||
+      itk::SharedMemoryImageIO::IsSharedMemoryFileName(0))
+    {
+    std::cerr << "Line " << __LINE__ << ": IsSharedMemoryFileName failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::SharedMemoryImageIO::Pointer io = itk::SharedMemoryImageIO::New();
+  if (io->CanWriteFile("/tmp/image.nrrd") ||
+      io->CanReadFile(segmentFileName("missing").c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << ": CanWriteFile or CanReadFile failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testRoundTrip()
+{
+  std::string fileName = segmentFileName("roundtrip");
+  ImageType::Pointer image = createImage();
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetImageIO(itk::SharedMemoryImageIO::New());
+  writer->SetFileName(fileName);
+  writer->SetInput(image);
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& exception)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << ": "
+              << exception << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::SharedMemoryImageIO::Pointer io = itk::SharedMemoryImageIO::New();
+  if (!io->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << ": CanReadFile failed for " << fileName << std::endl;
+    itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetImageIO(io);
+  reader->SetFileName(fileName);
+  try
+    {
+    reader->Update();
+    }
+  catch (itk::ExceptionObject& exception)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to read " << fileName << ": "
+              << exception << std::endl;
+    itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  ImageType::Pointer readImage = reader->GetOutput();
+
+  bool success = true;
+  if (readImage->GetLargestPossibleRegion() != image->GetLargestPossibleRegion() ||
+      readImage->GetSpacing() != image->GetSpacing() ||
+      readImage->GetOrigin() != image->GetOrigin() ||
+      readImage->GetDirection() != image->GetDirection())
+    {
+    std::cerr << "Line " << __LINE__ << ": image geometry differs after round trip" << std::endl;
+    success = false;
+    }
+  itk::ImageRegionConstIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> readIt(readImage, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(), readIt.GoToBegin(); success && !it.IsAtEnd(); ++it, ++readIt)
+    {
+    if (it.Get() != readIt.Get())
+      {
+      std::cerr << "Line " << __LINE__ << ": voxel " << it.GetIndex() << " differs: "
+                << readIt.Get() << " != " << it.Get() << std::endl;
+      success = false;
+      }
+    }
+
+  // The segment persists until it is removed
+  if (!itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str()) ||
+      itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str()) ||
+      io->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << ": RemoveSegment failed" << std::endl;
+    success = false;
+    }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//----------------------------------------------------------------------------
+int testInvalidSegments()
+{
+  if (!readFails(segmentFileName("missing")))
+    {
+    std::cerr << "Line " << __LINE__ << ": a missing segment was read" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+#ifndef _WIN32
+  bool success = true;
+
+  // Segment smaller than the header
+  std::string fileName = segmentFileName("truncated");
+  const char truncated[4] = {'S', 'L', 'S', 'H'};
+  if (!createRawSegment(fileName, truncated, sizeof(truncated)) || !readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": a truncated segment was read" << std::endl;
+    success = false;
+    }
+  itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+
+  // Segment that was not written by SharedMemoryImageIO
+  fileName = segmentFileName("garbage");
+  char garbage[512];
+  memset(garbage, 0x5a, sizeof(garbage));
+  if (!createRawSegment(fileName, garbage, sizeof(garbage)) || !readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": a segment with an invalid header was read" << std::endl;
+    success = false;
+    }
+  itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+
+  // Valid header with an image size that does not match the buffer size.
+  // The first dimension is the first 64-bit field of the header, after the
+  // 8 byte magic string and the six 32-bit fields.
+  fileName = segmentFileName("mismatch");
+  itk::SharedMemoryImageIO::Pointer writerIO = itk::SharedMemoryImageIO::New();
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetImageIO(writerIO);
+  writer->SetFileName(fileName);
+  writer->SetInput(createImage());
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& exception)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << ": "
+              << exception << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to read " << fileName << std::endl;
+    success = false;
+    }
+  const size_t sizeOffset = 8 + 6 * sizeof(itk::uint32_t);
+  const itk::uint64_t mismatchedSize = 8;
+  if (!patchSegment(fileName, sizeOffset, &mismatchedSize, sizeof(mismatchedSize)) ||
+      !readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": a segment with a mismatched size was read" << std::endl;
+    success = false;
+    }
+  const itk::uint64_t size = 7;
+  if (!patchSegment(fileName, sizeOffset, &size, sizeof(size)) || readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to restore " << fileName << std::endl;
+    success = false;
+    }
+
+  // Unsupported header version
+  const itk::uint32_t version = 2;
+  if (!patchSegment(fileName, 8, &version, sizeof(version)) || !readFails(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << ": a segment with an unknown version was read" << std::endl;
+    success = false;
+    }
+  itk::SharedMemoryImageIO::RemoveSegment(fileName.c_str());
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int itkSharedMemoryImageIOTest1(int, char*[])
+{
+  if (!itk::SharedMemoryImageIO::IsSupported())
+    {
+    std::cout << "Shared memory segments are not supported, skipping test" << std::endl;
+    return EXIT_SUCCESS;
+    }
+  if (testFileNames() != EXIT_SUCCESS ||
+      testRoundTrip() != EXIT_SUCCESS ||
+      testInvalidSegments() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+/// itkSharedMemoryIOExport
+///
+/// The itkSharedMemoryIOExport captures some system differences between Unix
+/// and Windows operating systems.
+
+#ifndef itkSharedMemoryIOExport_h
+#define itkSharedMemoryIOExport_h
+
+#include <itkSharedMemoryImageIOConfigure.h>
+
+#if defined(WIN32) && !defined(SharedMemoryIO_STATIC)
+#if defined(SharedMemoryIO_EXPORTS)
+#define SharedMemoryImageIO_EXPORT __declspec( dllexport )
+#else
+#define SharedMemoryImageIO_EXPORT __declspec( dllimport )
+#endif
+#else
+#define SharedMemoryImageIO_EXPORT
+#endif
+
+#endif
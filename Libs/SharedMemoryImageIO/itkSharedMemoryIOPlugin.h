@@ -0,0 +1,25 @@
+#ifndef itkSharedMemoryIOPlugin_h
+#define itkSharedMemoryIOPlugin_h
+
+#include "itkObjectFactoryBase.h"
+
+#ifdef WIN32
+#ifdef SharedMemoryIOPlugin_EXPORTS
+#define SharedMemoryIOPlugin_EXPORT __declspec(dllexport)
+#else
+#define SharedMemoryIOPlugin_EXPORT __declspec(dllimport)
+#endif
+#else
+#define SharedMemoryIOPlugin_EXPORT
+#endif
+
+/**
+ * Routine that is called when the shared library is loaded by
+ * itk::ObjectFactoryBase::LoadDynamicFactories().
+ *
+ * itkLoad() is C (not C++) function.
+ */
+extern "C" {
+    SharedMemoryIOPlugin_EXPORT itk::ObjectFactoryBase* itkLoad();
+}
+#endif
@@ -0,0 +1,382 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageIO.h"
+#include "itkIntTypes.h"
+
+// STD includes
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char SharedMemoryScheme[] = "shm:";
+const char SharedMemoryMagic[8] = {'S', 'L', 'S', 'H', 'M', 'I', 'M', 'G'};
+const itk::uint32_t SharedMemoryVersion = 1;
+const unsigned int SharedMemoryMaximumDimension = 4;
+// Image buffer starts on a cache line boundary after the header
+const itk::uint64_t SharedMemoryBufferAlignment = 64;
+
+//----------------------------------------------------------------------------
+struct SharedMemoryImageHeader
+{
+  char Magic[8];
+  itk::uint32_t Version;
+  itk::uint32_t ComponentType;
+  itk::uint32_t PixelType;
+  itk::uint32_t NumberOfComponents;
+  itk::uint32_t NumberOfDimensions;
+  itk::uint32_t Reserved;
+  itk::uint64_t Size[SharedMemoryMaximumDimension];
+  double Spacing[SharedMemoryMaximumDimension];
+  double Origin[SharedMemoryMaximumDimension];
+  // Column-major: Direction[i * MaximumDimension + j] is the j-th
+  // component of the i-th axis.
+  double Direction[SharedMemoryMaximumDimension * SharedMemoryMaximumDimension];
+  itk::uint64_t BufferOffset;
+  itk::uint64_t BufferSize;
+};
+
+//----------------------------------------------------------------------------
+itk::uint64_t GetBufferOffset()
+{
+  return ((sizeof(SharedMemoryImageHeader) + SharedMemoryBufferAlignment - 1)
+          / SharedMemoryBufferAlignment) * SharedMemoryBufferAlignment;
+}
+
+//----------------------------------------------------------------------------
+// "shm:/name" -> "/name"
+std::string GetSegmentName(const std::string& filename)
+{
+  return filename.substr(sizeof(SharedMemoryScheme) - 1);
+}
+
+} // end of anonymous namespace
+
+namespace itk {
+//----------------------------------------------------------------------------
+SharedMemoryImageIO
+::SharedMemoryImageIO()
+{
+  this->m_Segment = 0;
+  this->m_SegmentSize = 0;
+}
+
+//----------------------------------------------------------------------------
+SharedMemoryImageIO
+::~SharedMemoryImageIO()
+{
+  this->UnmapSegment();
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::IsSupported()
+{
+#ifdef _WIN32
+  return false;
+#else
+  return true;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::IsSharedMemoryFileName(const char* filename)
+{
+  return filename != 0 &&
+    strncmp(filename, SharedMemoryScheme, sizeof(SharedMemoryScheme) - 1) == 0 &&
+    filename[sizeof(SharedMemoryScheme) - 1] == '/';
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::RemoveSegment(const char* filename)
+{
+  if (!IsSupported() || !IsSharedMemoryFileName(filename))
+    {
+    return false;
+    }
+#ifdef _WIN32
+  return false;
+#else
+  return shm_unlink(GetSegmentName(filename).c_str()) == 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::MapSegment(const std::string& filename, bool create, SizeValueType size)
+{
+  this->UnmapSegment();
+#ifdef _WIN32
+  (void)filename;
+  (void)create;
+  (void)size;
+  return false;
+#else
+  std::string segmentName = GetSegmentName(filename);
+  int fd = shm_open(segmentName.c_str(),
+                    create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY,
+                    S_IRUSR | S_IWUSR);
+  if (fd == -1)
+    {
+    return false;
+    }
+  if (create)
+    {
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+      {
+      close(fd);
+      shm_unlink(segmentName.c_str());
+      return false;
+      }
+    }
+  else
+    {
+    struct stat segmentStat;
+    if (fstat(fd, &segmentStat) != 0)
+      {
+      close(fd);
+      return false;
+      }
+    size = static_cast<SizeValueType>(segmentStat.st_size);
+    }
+  if (size < sizeof(SharedMemoryImageHeader))
+    {
+    close(fd);
+    return false;
+    }
+  void* segment = mmap(0, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                       MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (segment == MAP_FAILED)
+    {
+    if (create)
+      {
+      shm_unlink(segmentName.c_str());
+      }
+    return false;
+    }
+  this->m_SegmentName = filename;
+  this->m_Segment = segment;
+  this->m_SegmentSize = size;
+  return true;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::UnmapSegment()
+{
+#ifndef _WIN32
+  if (this->m_Segment)
+    {
+    munmap(this->m_Segment, this->m_SegmentSize);
+    }
+#endif
+  this->m_SegmentName = "";
+  this->m_Segment = 0;
+  this->m_SegmentSize = 0;
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::CanReadFile(const char* filename)
+{
+  if (!IsSupported() || !IsSharedMemoryFileName(filename))
+    {
+    return false;
+    }
+#ifdef _WIN32
+  return false;
+#else
+  int fd = shm_open(GetSegmentName(filename).c_str(), O_RDONLY, 0);
+  if (fd == -1)
+    {
+    return false;
+    }
+  close(fd);
+  return true;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::ReadImageInformation()
+{
+  if (!this->MapSegment(m_FileName, false, 0))
+    {
+    itkExceptionMacro("Unable to map shared memory segment " << m_FileName);
+    }
+  const SharedMemoryImageHeader* header =
+    reinterpret_cast<const SharedMemoryImageHeader*>(this->m_Segment);
+  if (memcmp(header->Magic, SharedMemoryMagic, sizeof(SharedMemoryMagic)) != 0 ||
+      header->Version != SharedMemoryVersion ||
+      header->NumberOfDimensions == 0 ||
+      header->NumberOfDimensions > SharedMemoryMaximumDimension ||
+      header->BufferOffset + header->BufferSize > this->m_SegmentSize)
+    {
+    std::string segmentName = this->m_SegmentName;
+    this->UnmapSegment();
+    itkExceptionMacro("Invalid shared memory image segment " << segmentName);
+    }
+
+  unsigned int dimension = header->NumberOfDimensions;
+  this->SetNumberOfDimensions(dimension);
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    this->SetDimensions(i, static_cast<SizeValueType>(header->Size[i]));
+    this->SetSpacing(i, header->Spacing[i]);
+    this->SetOrigin(i, header->Origin[i]);
+    std::vector<double> direction(dimension);
+    for (unsigned int j = 0; j < dimension; ++j)
+      {
+      direction[j] = header->Direction[i * SharedMemoryMaximumDimension + j];
+      }
+    this->SetDirection(i, direction);
+    }
+  this->SetComponentType(static_cast<IOComponentType>(header->ComponentType));
+  this->SetPixelType(static_cast<IOPixelType>(header->PixelType));
+  this->SetNumberOfComponents(header->NumberOfComponents);
+
+  if (this->GetImageSizeInBytes() != header->BufferSize)
+    {
+    std::string segmentName = this->m_SegmentName;
+    this->UnmapSegment();
+    itkExceptionMacro("Inconsistent buffer size in shared memory segment " << segmentName);
+    }
+}
+
+//----------------------------------------------------------------------------
+const void*
+SharedMemoryImageIO
+::GetBuffer() const
+{
+  if (!this->m_Segment)
+    {
+    return 0;
+    }
+  const SharedMemoryImageHeader* header =
+    reinterpret_cast<const SharedMemoryImageHeader*>(this->m_Segment);
+  return reinterpret_cast<const char*>(this->m_Segment) + header->BufferOffset;
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::Read(void* buffer)
+{
+  if (!this->m_Segment || this->m_SegmentName != m_FileName)
+    {
+    this->ReadImageInformation();
+    }
+  // Streaming is not supported, the whole image is requested
+  memcpy(buffer, this->GetBuffer(), this->GetImageSizeInBytes());
+  this->UnmapSegment();
+}
+
+//----------------------------------------------------------------------------
+bool
+SharedMemoryImageIO
+::CanWriteFile(const char* filename)
+{
+  return IsSupported() && IsSharedMemoryFileName(filename);
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::WriteImageInformation()
+{
+}
+
+//----------------------------------------------------------------------------
+void*
+SharedMemoryImageIO
+::CreateBuffer()
+{
+  unsigned int dimension = this->GetNumberOfDimensions();
+  if (dimension == 0 || dimension > SharedMemoryMaximumDimension)
+    {
+    itkExceptionMacro("Unsupported image dimension " << dimension
+                      << " for shared memory segment " << m_FileName);
+    }
+  itk::uint64_t bufferSize = this->GetImageSizeInBytes();
+  itk::uint64_t bufferOffset = GetBufferOffset();
+  if (!this->MapSegment(m_FileName, true,
+                        static_cast<SizeValueType>(bufferOffset + bufferSize)))
+    {
+    itkExceptionMacro("Unable to create shared memory segment " << m_FileName);
+    }
+
+  SharedMemoryImageHeader* header =
+    reinterpret_cast<SharedMemoryImageHeader*>(this->m_Segment);
+  memset(header, 0, sizeof(SharedMemoryImageHeader));
+  memcpy(header->Magic, SharedMemoryMagic, sizeof(SharedMemoryMagic));
+  header->Version = SharedMemoryVersion;
+  header->ComponentType = static_cast<itk::uint32_t>(this->GetComponentType());
+  header->PixelType = static_cast<itk::uint32_t>(this->GetPixelType());
+  header->NumberOfComponents = this->GetNumberOfComponents();
+  header->NumberOfDimensions = dimension;
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    header->Size[i] = this->GetDimensions(i);
+    header->Spacing[i] = this->GetSpacing(i);
+    header->Origin[i] = this->GetOrigin(i);
+    std::vector<double> direction = this->GetDirection(i);
+    for (unsigned int j = 0; j < dimension && j < direction.size(); ++j)
+      {
+      header->Direction[i * SharedMemoryMaximumDimension + j] = direction[j];
+      }
+    }
+  header->BufferOffset = bufferOffset;
+  header->BufferSize = bufferSize;
+
+  return reinterpret_cast<char*>(this->m_Segment) + bufferOffset;
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::Write(const void* buffer)
+{
+  // Streaming is not supported, the whole image is written
+  void* segmentBuffer = this->CreateBuffer();
+  memcpy(segmentBuffer, buffer, this->GetImageSizeInBytes());
+  // The segment persists until the application removes it
+  this->UnmapSegment();
+}
+
+//----------------------------------------------------------------------------
+void
+SharedMemoryImageIO
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "SegmentName: " << this->m_SegmentName << std::endl;
+  os << indent << "SegmentSize: " << this->m_SegmentSize << std::endl;
+}
+
+} // end namespace itk
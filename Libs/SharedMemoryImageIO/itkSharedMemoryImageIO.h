@@ -0,0 +1,126 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageIO_h
+#define itkSharedMemoryImageIO_h
+
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkSharedMemoryIOExport.h"
+
+#include "itkImageIOBase.h"
+
+namespace itk
+{
+/** \class SharedMemoryImageIO
+ * \brief ImageIO object for exchanging images through named shared memory
+ *
+ * SharedMemoryImageIO reads and writes images stored in a named
+ * POSIX shared memory segment. The segment starts with a small
+ * header (pixel type, size, spacing, origin and direction in LPS)
+ * followed by the image buffer.
+ *
+ * It is used by Slicer to communicate with command line modules
+ * executed in a separate process without writing temporary files:
+ * the application creates the segment of each input image and copies
+ * the MRML node voxels directly into it, the command line module
+ * reads/writes its images with a standard ITK ImageFileReader or
+ * ImageFileWriter and the application copies the output segments
+ * back into the MRML nodes. Unlike MRMLIDImageIO, this IO does not
+ * depend on VTK or MRML and can be safely loaded by executables
+ * through the ITK_AUTOLOAD_PATH mechanism.
+ *
+ * The "filename" specified looks like:
+ *     <code>shm:/\<segment name\></code>
+ *
+ * Shared memory segments are not supported on Windows, callers
+ * should check IsSupported() and fall back to files.
+ */
+class SharedMemoryImageIO_EXPORT SharedMemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIO  Self;
+  typedef ImageIOBase          Superclass;
+  typedef SmartPointer<Self>   Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIO, ImageIOBase);
+
+  /** Return true if shared memory segments are supported on this platform. */
+  static bool IsSupported();
+
+  /** Return true if the filename uses the shared memory scheme ("shm:"). */
+  static bool IsSharedMemoryFileName(const char* filename);
+
+  /** Remove the shared memory segment designated by filename. The memory
+   * is released when the last process that mapped it unmaps it.
+   * Return false if the segment does not exist. */
+  static bool RemoveSegment(const char* filename);
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanReadFile(const char*) ITK_OVERRIDE;
+
+  /** Set the spacing and dimension information for the set filename. */
+  virtual void ReadImageInformation() ITK_OVERRIDE;
+
+  /** Reads the data from the segment into the memory buffer provided. */
+  virtual void Read(void* buffer) ITK_OVERRIDE;
+
+  /** Return a pointer to the image buffer mapped by
+   * ReadImageInformation(). The pointer is valid until the IO object is
+   * destroyed or another segment is mapped. */
+  const void* GetBuffer() const;
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Determine the file type. Returns true if this ImageIO can write the
+   * file specified. */
+  virtual bool CanWriteFile(const char*) ITK_OVERRIDE;
+
+  /** The header is written with the image buffer in Write(). */
+  virtual void WriteImageInformation() ITK_OVERRIDE;
+
+  /** Writes the data to the segment from the memory buffer provided. */
+  virtual void Write(const void* buffer) ITK_OVERRIDE;
+
+  /** Create the segment for the current image information and return
+   * a pointer to its image buffer so that the caller can fill it
+   * directly, without an intermediate copy. The pointer is valid until
+   * the IO object is destroyed or another segment is mapped. */
+  void* CreateBuffer();
+
+protected:
+  SharedMemoryImageIO();
+  ~SharedMemoryImageIO();
+  void PrintSelf(std::ostream& os, Indent indent) const ITK_OVERRIDE;
+
+  /** Map an existing segment (read-only) or create a new segment of
+   * the requested size. Return false on failure. */
+  bool MapSegment(const std::string& filename, bool create, SizeValueType size);
+  void UnmapSegment();
+
+private:
+  SharedMemoryImageIO(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  std::string   m_SegmentName;
+  void*         m_Segment;
+  SizeValueType m_SegmentSize;
+};
+
+
+} /// end namespace itk
+#endif /// itkSharedMemoryImageIO_h
@@ -0,0 +1,41 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageIOFactory.h"
+#include "itkVersion.h"
+
+
+namespace itk
+{
+SharedMemoryImageIOFactory::SharedMemoryImageIOFactory()
+{
+  this->RegisterOverride("itkImageIOBase",
+                         "itkSharedMemoryImageIO",
+                         "ImageIO to exchange images through shared memory.",
+                         1,
+                         CreateObjectFunction<SharedMemoryImageIO>::New());
+}
+
+SharedMemoryImageIOFactory::~SharedMemoryImageIOFactory()
+{
+}
+
+const char*
+SharedMemoryImageIOFactory::GetITKSourceVersion(void) const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char*
+SharedMemoryImageIOFactory::GetDescription() const
+{
+  return "ImageIOFactory that imports/exports data to a shared memory segment.";
+}
+
+} // end namespace itk
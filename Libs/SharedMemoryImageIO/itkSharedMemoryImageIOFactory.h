@@ -0,0 +1,65 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageIOFactory_h
+#define itkSharedMemoryImageIOFactory_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+#include "itkSharedMemoryImageIO.h"
+
+#include "itkSharedMemoryIOExport.h"
+
+namespace itk
+{
+/** \class SharedMemoryImageIOFactory
+ * \brief Create instances of SharedMemoryImageIO objects using an object factory.
+ */
+class SharedMemoryImageIO_EXPORT SharedMemoryImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIOFactory  Self;
+  typedef ObjectFactoryBase           Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char* GetITKSourceVersion(void) const ITK_OVERRIDE;
+  virtual const char* GetDescription(void) const ITK_OVERRIDE;
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro(Self);
+  static SharedMemoryImageIOFactory* FactoryNew() { return new SharedMemoryImageIOFactory;}
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory(void)
+  {
+    SharedMemoryImageIOFactory::Pointer factory = SharedMemoryImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory(factory);
+  }
+
+protected:
+  SharedMemoryImageIOFactory();
+  ~SharedMemoryImageIOFactory();
+
+private:
+  SharedMemoryImageIOFactory(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+
+} /// end namespace itk
+
+#endif
@@ -9,11 +9,16 @@
 
 #include "vtkOrientedGridTransform.h"
 
+#include "vtkImageData.h"
 #include "vtkMath.h"
 #include "vtkMatrix4x4.h"
+#include "vtkMutexLock.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 
+#include <algorithm>
+#include <cmath>
+
 vtkStandardNewMacro(vtkOrientedGridTransform);
 
 vtkCxxSetObjectMacro(vtkOrientedGridTransform,GridDirectionMatrix,vtkMatrix4x4);
@@ -26,6 +31,19 @@ vtkOrientedGridTransform::vtkOrientedGridTransform()
   this->OutputToGridIndexTransformMatrixCached = vtkMatrix4x4::New();
 
   this->LastWarningMTime = 0;
+
+  this->UseCachedInverse = false;
+  this->CachedInverseGridRefinement = 1;
+  this->CachedInverseMaximumError = 0.1;
+  for (int i = 0; i < 3; i++)
+    {
+    this->CachedInverseGridExtent[2*i] = 0;
+    this->CachedInverseGridExtent[2*i+1] = -1;
+    this->CachedInverseGridIncrements[i] = 0;
+    }
+  this->CachedInverseError = -1.0;
+  this->CachedInverseGridValid = false;
+  this->CachedInverseGridLock = vtkSimpleMutexLock::New();
 }
 
 //----------------------------------------------------------------------------
@@ -42,6 +60,8 @@ vtkOrientedGridTransform::~vtkOrientedGridTransform()
     this->OutputToGridIndexTransformMatrixCached->Delete();
     this->OutputToGridIndexTransformMatrixCached = NULL;
     }
+  this->CachedInverseGridLock->Delete();
+  this->CachedInverseGridLock = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -54,6 +74,20 @@ void vtkOrientedGridTransform::PrintSelf(ostream& os, vtkIndent indent)
     {
     this->GridDirectionMatrix->PrintSelf(os,indent.GetNextIndent());
     }
+  os << indent << "UseCachedInverse: " << this->UseCachedInverse << "\n";
+  os << indent << "CachedInverseGridRefinement: " << this->CachedInverseGridRefinement << "\n";
+  os << indent << "CachedInverseMaximumError: " << this->CachedInverseMaximumError << "\n";
+  os << indent << "CachedInverseError: ";
+  this->CachedInverseGridLock->Lock();
+  if (this->CachedInverseGridValid)
+    {
+    os << this->CachedInverseError << "\n";
+    }
+  else
+    {
+    os << "(not computed)\n";
+    }
+  this->CachedInverseGridLock->Unlock();
 }
 
 //------------------------------------------------------------------------
@@ -174,6 +208,19 @@ void vtkOrientedGridTransform::ForwardTransformDerivative(const double inPoint[3
   outPoint[2] = inPoint[2] + (displacement[2]*scale + shift);
 }
 
+//----------------------------------------------------------------------------
+void vtkOrientedGridTransform::InverseTransformPoint(const double inPoint[3],
+                                                     double outPoint[3])
+{
+  if (this->UseCachedInverse && this->GridDirectionMatrix != NULL && this->GridPointer != NULL
+    && this->CachedInverseTransformPoint(inPoint, outPoint))
+    {
+    return;
+    }
+  double derivative[3][3];
+  this->InverseTransformDerivative(inPoint, outPoint, derivative);
+}
+
 //----------------------------------------------------------------------------
 void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3],
                                                   double outPoint[3],
@@ -185,6 +232,37 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
     return;
     }
 
+  if (this->UseCachedInverse && this->CachedInverseTransformPoint(inPoint, outPoint))
+    {
+    // derivative of the forward transform at the inverse point, as in the
+    // iterative inverse
+    double forwardPoint[3];
+    this->ForwardTransformDerivative(outPoint, forwardPoint, derivative);
+    return;
+    }
+
+  double error = 0.0;
+  if (!this->IterativeInverseTransformDerivative(inPoint, outPoint, derivative, error))
+    {
+    if (this->MTime > this->LastWarningMTime)
+      {
+      vtkWarningMacro("InverseTransformPoint: no convergence (" <<
+                      inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
+                      ") error = " << error << " after " <<
+                      this->InverseIterations << " iterations."
+                      "  Further convergence warnings suppressed until transform is modified.");
+      this->LastWarningMTime = this->MTime;
+      }
+    this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::IterativeInverseTransformDerivative(const double inPoint[3],
+                                                                   double outPoint[3],
+                                                                   double derivative[3][3],
+                                                                   double& error)
+{
   void *gridPtr = this->GridPointer;
   int gridType = this->GridScalarType;
 
@@ -317,29 +395,251 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
 
   vtkDebugMacro("Inverse Iterations: " << (i+1));
 
-  if (i >= n)
+  error = sqrt(errorSquared);
+  bool converged = (i < n);
+  if (!converged)
     {
     // didn't converge: back up to last good result
     inverse[0] = lastInverse[0];
     inverse[1] = lastInverse[1];
     inverse[2] = lastInverse[2];
-
-    if (this->MTime > this->LastWarningMTime)
-      {
-      vtkWarningMacro("InverseTransformPoint: no convergence (" <<
-                      inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
-                      ") error = " << sqrt(errorSquared) << " after " <<
-                      i << " iterations."
-                      "  Further convergence warnings suppressed until transform is modified.");
-      this->LastWarningMTime = this->MTime;
-      }
-    this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
     }
 
   // convert point
   outPoint[0] = inverse[0];
   outPoint[1] = inverse[1];
   outPoint[2] = inverse[2];
+
+  return converged;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct CachedInverseGridThreadInfo
+{
+  vtkOrientedGridTransform* Transform;
+  // If false, compute the inverse at the grid nodes.
+  // If true, compare the cached inverse to the iterative inverse at the
+  // center of the grid cells.
+  bool ComputeError;
+  int NextSlice;
+  vtkSimpleMutexLock* Lock;
+  std::vector<double> MaximumErrors; // one per thread
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::CachedInverseTransformPoint(const double inPoint[3],
+                                                           double outPoint[3])
+{
+  if (!this->UpdateCachedInverseGrid()
+    || this->CachedInverseError > this->CachedInverseMaximumError)
+    {
+    return false;
+    }
+  return this->InterpolateCachedInverseGrid(inPoint, outPoint);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::InterpolateCachedInverseGrid(const double inPoint[3],
+                                                            double outPoint[3])
+{
+  double point[3];
+  vtkLinearTransformPoint(this->OutputToGridIndexTransformMatrixCached->Element, inPoint, point);
+  const double refinement = this->CachedInverseGridParameters[0];
+  for (int i = 0; i < 3; i++)
+    {
+    point[i] *= refinement;
+    // the iterative inverse extrapolates differently outside of the grid
+    if (point[i] < this->CachedInverseGridExtent[2*i] || point[i] > this->CachedInverseGridExtent[2*i+1])
+      {
+      return false;
+      }
+    }
+
+  double displacement[3];
+  this->InterpolationFunction(point, displacement, NULL,
+                              &this->CachedInverseGrid[0], VTK_DOUBLE,
+                              this->CachedInverseGridExtent, this->CachedInverseGridIncrements);
+
+  outPoint[0] = inPoint[0] + displacement[0];
+  outPoint[1] = inPoint[1] + displacement[1];
+  outPoint[2] = inPoint[2] + displacement[2];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double vtkOrientedGridTransform::GetCachedInverseError()
+{
+  this->Update();
+  if (this->GridPointer == NULL || !this->UpdateCachedInverseGrid())
+    {
+    return -1.0;
+    }
+  return this->CachedInverseError;
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::UpdateCachedInverseGrid()
+{
+  if (this->GridPointer == NULL)
+    {
+    return false;
+    }
+  // Points may be transformed by several threads (e.g. by vtkImageReslice),
+  // only one computes the grid. CachedInverseGridValid is only accessed with
+  // the lock held: without a memory barrier, another thread could see it set
+  // before the grid is written.
+  this->CachedInverseGridLock->Lock();
+  if (!this->CachedInverseGridValid)
+    {
+    this->ComputeCachedInverseGrid();
+    }
+  this->CachedInverseGridLock->Unlock();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedGridTransform::GetCachedInverseGridParameters(std::vector<double>& parameters)
+{
+  parameters.clear();
+  parameters.push_back(this->CachedInverseGridRefinement);
+  parameters.push_back(this->InterpolationMode);
+  parameters.push_back(this->DisplacementScale);
+  parameters.push_back(this->DisplacementShift);
+  parameters.push_back(this->InverseTolerance);
+  parameters.push_back(this->InverseIterations);
+  for (int i = 0; i < 6; i++)
+    {
+    parameters.push_back(this->GridExtent[i]);
+    }
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 4; col++)
+      {
+      parameters.push_back(this->GridIndexToOutputTransformMatrixCached->GetElement(row, col));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedGridTransform::ComputeCachedInverseGrid()
+{
+  this->CachedInverseGridBuildTime.Modified();
+  this->GetCachedInverseGridParameters(this->CachedInverseGridParameters);
+
+  const int refinement = this->CachedInverseGridRefinement;
+  int dimensions[3];
+  for (int i = 0; i < 3; i++)
+    {
+    this->CachedInverseGridExtent[2*i] = this->GridExtent[2*i] * refinement;
+    this->CachedInverseGridExtent[2*i+1] = this->GridExtent[2*i+1] * refinement;
+    dimensions[i] = this->CachedInverseGridExtent[2*i+1] - this->CachedInverseGridExtent[2*i] + 1;
+    }
+  this->CachedInverseGridIncrements[0] = 3;
+  this->CachedInverseGridIncrements[1] = 3 * static_cast<vtkIdType>(dimensions[0]);
+  this->CachedInverseGridIncrements[2] = this->CachedInverseGridIncrements[1] * dimensions[1];
+  this->CachedInverseGrid.assign(this->CachedInverseGridIncrements[2] * dimensions[2], 0.0);
+
+  vtkNew<vtkMultiThreader> threader;
+  vtkNew<vtkSimpleMutexLock> lock;
+  CachedInverseGridThreadInfo info;
+  info.Transform = this;
+  info.Lock = lock.GetPointer();
+  info.MaximumErrors.assign(threader->GetNumberOfThreads(), 0.0);
+  threader->SetSingleMethod(vtkOrientedGridTransform::ComputeCachedInverseGridThreadFunction, &info);
+
+  // Inverse at the grid nodes
+  info.ComputeError = false;
+  info.NextSlice = 0;
+  threader->SingleMethodExecute();
+
+  // Largest difference with the iterative inverse between the grid nodes
+  info.ComputeError = true;
+  info.NextSlice = 0;
+  threader->SingleMethodExecute();
+  this->CachedInverseError = *std::max_element(info.MaximumErrors.begin(), info.MaximumErrors.end());
+
+  vtkDebugMacro("Cached inverse grid computed, error = " << this->CachedInverseError);
+  if (this->CachedInverseError > this->CachedInverseMaximumError)
+    {
+    vtkWarningMacro("Cached inverse error (" << this->CachedInverseError << ") is larger than "
+                    << this->CachedInverseMaximumError << ", the iterative inverse is used instead."
+                    "  Increase CachedInverseGridRefinement to reduce the error.");
+    }
+
+  this->CachedInverseGridValid = true;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkOrientedGridTransform::ComputeCachedInverseGridThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  CachedInverseGridThreadInfo* info = static_cast<CachedInverseGridThreadInfo*>(threadInfo->UserData);
+  vtkOrientedGridTransform* self = info->Transform;
+  const int* extent = self->CachedInverseGridExtent;
+  const vtkIdType* increments = self->CachedInverseGridIncrements;
+  const double refinement = self->CachedInverseGridParameters[0];
+
+  // Grid nodes, or cell centers (nodes along flat axes)
+  int numberOfSamples[3];
+  double sampleOffset[3];
+  for (int i = 0; i < 3; i++)
+    {
+    const int numberOfNodes = extent[2*i+1] - extent[2*i] + 1;
+    const bool cellCenters = (info->ComputeError && numberOfNodes > 1);
+    numberOfSamples[i] = (cellCenters ? numberOfNodes - 1 : numberOfNodes);
+    sampleOffset[i] = (cellCenters ? 0.5 : 0.0);
+    }
+
+  double maximumError = 0.0;
+  while (true)
+    {
+    info->Lock->Lock();
+    int k = info->NextSlice++;
+    info->Lock->Unlock();
+    if (k >= numberOfSamples[2])
+      {
+      break;
+      }
+    for (int j = 0; j < numberOfSamples[1]; j++)
+      {
+      for (int i = 0; i < numberOfSamples[0]; i++)
+        {
+        double index[3] =
+          {
+          (extent[0] + i + sampleOffset[0]) / refinement,
+          (extent[2] + j + sampleOffset[1]) / refinement,
+          (extent[4] + k + sampleOffset[2]) / refinement
+          };
+        double point[3];
+        vtkLinearTransformPoint(self->GridIndexToOutputTransformMatrixCached->Element, index, point);
+        double inverse[3];
+        double derivative[3][3];
+        double error = 0.0;
+        self->IterativeInverseTransformDerivative(point, inverse, derivative, error);
+        if (!info->ComputeError)
+          {
+          double* displacement = &self->CachedInverseGrid[i*increments[0] + j*increments[1] + k*increments[2]];
+          displacement[0] = inverse[0] - point[0];
+          displacement[1] = inverse[1] - point[1];
+          displacement[2] = inverse[2] - point[2];
+          continue;
+          }
+        double cachedInverse[3];
+        if (self->InterpolateCachedInverseGrid(point, cachedInverse))
+          {
+          maximumError = std::max(maximumError,
+            sqrt(vtkMath::Distance2BetweenPoints(inverse, cachedInverse)));
+          }
+        }
+      }
+    }
+  info->MaximumErrors[threadInfo->ThreadID] = maximumError;
+  return VTK_THREAD_RETURN_VALUE;
 }
 
 //----------------------------------------------------------------------------
@@ -348,6 +648,9 @@ void vtkOrientedGridTransform::InternalDeepCopy(vtkAbstractTransform *transform)
   vtkOrientedGridTransform *gridTransform = (vtkOrientedGridTransform *)transform;
 
   this->SetGridDirectionMatrix(gridTransform->GetGridDirectionMatrix());
+  this->SetUseCachedInverse(gridTransform->GetUseCachedInverse());
+  this->SetCachedInverseGridRefinement(gridTransform->GetCachedInverseGridRefinement());
+  this->SetCachedInverseMaximumError(gridTransform->GetCachedInverseMaximumError());
 
   // Cached matrices will be recomputed automatically in InternalUpdate()
   // therefore we do not need to copy them.
@@ -385,6 +688,21 @@ void vtkOrientedGridTransform::InternalUpdate()
   // Compute Output to GridIndex transform
   vtkMatrix4x4::Invert(this->GridIndexToOutputTransformMatrixCached, this->OutputToGridIndexTransformMatrixCached);
 
+  // The cached inverse grid is kept while the displacement field is unchanged
+  // (this transform is also modified when it is inverted).
+  this->CachedInverseGridLock->Lock();
+  if (this->CachedInverseGridValid)
+    {
+    std::vector<double> parameters;
+    this->GetCachedInverseGridParameters(parameters);
+    vtkImageData* grid = this->GetDisplacementGrid();
+    if (grid == NULL || grid->GetMTime() > this->CachedInverseGridBuildTime
+      || parameters != this->CachedInverseGridParameters)
+      {
+      this->CachedInverseGridValid = false;
+      }
+    }
+  this->CachedInverseGridLock->Unlock();
 }
 
 //----------------------------------------------------------------------------
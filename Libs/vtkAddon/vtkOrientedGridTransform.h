@@ -20,6 +20,11 @@
 
 #include "vtkCommand.h"
 #include "vtkGridTransform.h"
+#include "vtkMultiThreader.h"
+
+#include <vector>
+
+class vtkSimpleMutexLock;
 
 class VTK_ADDON_EXPORT vtkOrientedGridTransform : public vtkGridTransform
 {
@@ -40,6 +45,38 @@ public:
   // Make another transform of the same type.
   vtkAbstractTransform *MakeTransform() VTK_OVERRIDE;
 
+  // Description:
+  // If enabled, the inverse transform uses inverse displacements computed
+  // once (in parallel) at the nodes of a grid with the same orientation as
+  // the displacement grid, instead of running the iterative inverse for each
+  // point. The grid is kept until the displacement field changes.
+  // Points outside the grid, and all points if the cached inverse error is
+  // larger than CachedInverseMaximumError, use the iterative inverse.
+  // Disabled by default.
+  vtkSetMacro(UseCachedInverse, bool);
+  vtkGetMacro(UseCachedInverse, bool);
+  vtkBooleanMacro(UseCachedInverse, bool);
+
+  // Description:
+  // Number of cached inverse grid intervals per displacement grid interval.
+  // Higher values reduce the cached inverse error at the cost of memory and
+  // computation time. Default is 1.
+  vtkSetClampMacro(CachedInverseGridRefinement, int, 1, 16);
+  vtkGetMacro(CachedInverseGridRefinement, int);
+
+  // Description:
+  // Largest accepted distance between the cached and the iterative inverse.
+  // Default is 0.1.
+  vtkSetMacro(CachedInverseMaximumError, double);
+  vtkGetMacro(CachedInverseMaximumError, double);
+
+  // Description:
+  // Largest distance between the cached inverse and the iterative inverse,
+  // measured at the centers of the cached inverse grid cells.
+  // The cached inverse grid is computed if needed.
+  // Returns -1 if there is no displacement grid.
+  double GetCachedInverseError();
+
   /// List of custom events fired by the class.
   // ConvergenceFailureEvent is invoked when the gradient cannot be
   // inverted, probably due to a singular transform or numeric instability.
@@ -66,6 +103,7 @@ protected:
   using vtkGridTransform::ForwardTransformPoint;
   using vtkGridTransform::ForwardTransformDerivative;
   using vtkGridTransform::InverseTransformDerivative;
+  using vtkGridTransform::InverseTransformPoint;
 
   // Description:
   // Internal functions for calculating the transformation.
@@ -77,6 +115,36 @@ protected:
   void InverseTransformDerivative(const double in[3], double out[3],
                                   double derivative[3][3]) VTK_OVERRIDE;
 
+  void InverseTransformPoint(const double in[3], double out[3]) VTK_OVERRIDE;
+
+  // Description:
+  // Newton search of the inverse, without reporting convergence failures.
+  // Returns false if it did not converge, error is then set to the last
+  // step length.
+  bool IterativeInverseTransformDerivative(const double in[3], double out[3],
+                                           double derivative[3][3], double& error);
+
+  // Description:
+  // Compute the inverse of a point from the cached inverse grid.
+  // Returns false if the cached inverse cannot be used for this point.
+  bool CachedInverseTransformPoint(const double in[3], double out[3]);
+
+  // Description:
+  // Interpolate the cached inverse grid. Returns false outside of the grid.
+  bool InterpolateCachedInverseGrid(const double in[3], double out[3]);
+
+  // Description:
+  // Compute the cached inverse grid if it is not up-to-date.
+  // Returns false if there is no displacement grid.
+  bool UpdateCachedInverseGrid();
+  void ComputeCachedInverseGrid();
+  static VTK_THREAD_RETURN_TYPE ComputeCachedInverseGridThreadFunction(void* arg);
+
+  // Description:
+  // Parameters of the transform the cached inverse grid depends on,
+  // the grid refinement first.
+  void GetCachedInverseGridParameters(std::vector<double>& parameters);
+
   // Description:
   // Grid axis direction vectors (i, j, k) in the output space
   vtkMatrix4x4* GridDirectionMatrix;
@@ -92,6 +160,25 @@ protected:
   // by keeping track of the MTime when the last warning was issued.
   vtkMTimeType LastWarningMTime;
 
+  bool UseCachedInverse;
+  int CachedInverseGridRefinement;
+  double CachedInverseMaximumError;
+
+  // Description:
+  // Inverse displacements (3 components, double) at the nodes of the cached
+  // inverse grid. Its index coordinates are the displacement grid index
+  // coordinates multiplied by CachedInverseGridRefinement.
+  std::vector<double> CachedInverseGrid;
+  int CachedInverseGridExtent[6];
+  vtkIdType CachedInverseGridIncrements[3];
+  double CachedInverseError;
+  bool CachedInverseGridValid;
+  vtkSimpleMutexLock* CachedInverseGridLock;
+  // Description:
+  // Displacement field the cached inverse grid was computed from.
+  vtkTimeStamp CachedInverseGridBuildTime;
+  std::vector<double> CachedInverseGridParameters;
+
 private:
   vtkOrientedGridTransform(const vtkOrientedGridTransform&);  // Not implemented.
   void operator=(const vtkOrientedGridTransform&);  // Not implemented.
@@ -0,0 +1,352 @@
+#include <vtkITKArchetypeImageSeriesScalarReader.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Read the DICOM tags of the files and describe how they are grouped.
+std::string readHeaders(const std::vector<std::string>& fileNames,
+                        int numberOfThreads, bool useCache)
+{
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> reader;
+  reader->SetArchetype(fileNames[0].c_str());
+  reader->SetSingleFile(0);
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetNumberOfHeaderReaderThreads(numberOfThreads);
+  reader->SetUseHeaderCache(useCache);
+  for (size_t f = 0; f < fileNames.size(); ++f)
+    {
+    reader->AddFileName(fileNames[f].c_str());
+    }
+  reader->UpdateInformation();
+
+  std::stringstream headers;
+  headers << "SeriesInstanceUIDs:";
+  for (unsigned int n = 0; n < reader->GetNumberOfSeriesInstanceUIDs(); ++n)
+    {
+    headers << " " << reader->GetNthSeriesInstanceUID(n);
+    }
+  headers << "\nContentTime: " << reader->GetNumberOfContentTime()
+          << "\nTriggerTime: " << reader->GetNumberOfTriggerTime()
+          << "\nEchoNumbers: " << reader->GetNumberOfEchoNumbers()
+          << "\nSliceLocation: " << reader->GetNumberOfSliceLocation()
+          << "\nImageOrientationPatient: " << reader->GetNumberOfImageOrientationPatient()
+          << "\nImagePositionPatient:";
+  for (unsigned int n = 0; n < reader->GetNumberOfImagePositionPatient(); ++n)
+    {
+    float* position = reader->GetNthImagePositionPatient(n);
+    headers << " (" << position[0] << "," << position[1] << "," << position[2] << ")";
+    }
+  headers << "\n";
+  return headers.str();
+}
+
+//----------------------------------------------------------------------------
+bool readFile(const std::string& fileName, std::string& content)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  std::stringstream stream;
+  stream << file.rdbuf();
+  content = stream.str();
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+// Change the last character of the series instance UID in the file and
+// optionally append bytes after the pixel data. The modification time of the
+// file is restored, the file is only seen modified if its size changes.
+bool patchSeriesInstanceUID(const std::string& fileName, const std::string& uid,
+                            char lastCharacter, bool changeSize)
+{
+  std::string stampFileName = fileName + ".stamp";
+  std::string content;
+  if (!itksys::SystemTools::CopyAFile(fileName.c_str(), stampFileName.c_str()) ||
+      !itksys::SystemTools::CopyFileTime(fileName.c_str(), stampFileName.c_str()) ||
+      !readFile(fileName, content))
+    {
+    return false;
+    }
+  // the last character may already be patched
+  size_t uidPosition = content.find(uid.substr(0, uid.size() - 1));
+  if (uidPosition == std::string::npos)
+    {
+    return false;
+    }
+  content[uidPosition + uid.size() - 1] = lastCharacter;
+  if (changeSize)
+    {
+    content.append(2, '\0');
+    }
+  std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  file << content;
+  file.close();
+  bool success = itksys::SystemTools::CopyFileTime(stampFileName.c_str(), fileName.c_str());
+  itksys::SystemTools::RemoveFile(stampFileName.c_str());
+  return success && !file.fail();
+}
+
+//----------------------------------------------------------------------------
+// Copy the first numberOfFiles files of the series into a directory.
+bool copyFiles(const std::vector<std::string>& sourceFileNames, size_t numberOfFiles,
+               const std::string& directory, std::vector<std::string>& fileNames)
+{
+  itksys::SystemTools::RemoveADirectory(directory.c_str());
+  if (!itksys::SystemTools::MakeDirectory(directory.c_str()))
+    {
+    return false;
+    }
+  fileNames.clear();
+  for (size_t f = 0; f < numberOfFiles && f < sourceFileNames.size(); ++f)
+    {
+    std::string fileName = directory + "/" +
+      itksys::SystemTools::GetFilenameName(sourceFileNames[f]);
+    if (!itksys::SystemTools::CopyAFile(sourceFileNames[f].c_str(), fileName.c_str()))
+      {
+      return false;
+      }
+    fileNames.push_back(fileName);
+    }
+  return fileNames.size() == numberOfFiles;
+}
+
+//----------------------------------------------------------------------------
+#define CHECK_HEADERS(actual, expected) \
+  if ((actual) != (expected)) \
+    { \
+    std::cerr << "Line " << __LINE__ << ": unexpected headers:\n" << (actual) \
+              << "expected:\n" << (expected) << std::endl; \
+    return EXIT_FAILURE; \
+    }
+
+#define CHECK_NUMBER(actual, expected) \
+  if ((actual) != (expected)) \
+    { \
+    std::cerr << "Line " << __LINE__ << ": " #actual " is " << (actual) \
+              << ", expected " << (expected) << std::endl; \
+    return EXIT_FAILURE; \
+    }
+
+#define CHECK_TRUE(condition) \
+  if (!(condition)) \
+    { \
+    std::cerr << "Line " << __LINE__ << ": " #condition " failed" << std::endl; \
+    return EXIT_FAILURE; \
+    }
+
+//----------------------------------------------------------------------------
+int testParallelReading(const std::vector<std::string>& fileNames)
+{
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  std::string serialHeaders = readHeaders(fileNames, 1, false);
+  CHECK_TRUE(serialHeaders.find("SeriesInstanceUIDs: ") != std::string::npos);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), 0);
+
+  // The tags are grouped in the order of the files, whatever the thread
+  // that reads them
+  for (int numberOfThreads = 2; numberOfThreads <= 8; numberOfThreads *= 2)
+    {
+    CHECK_HEADERS(readHeaders(fileNames, numberOfThreads, false), serialHeaders);
+    }
+
+  // Cached tags are the same as the tags read from the files
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), serialHeaders);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(),
+               static_cast<int>(fileNames.size()));
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), serialHeaders);
+  CHECK_HEADERS(readHeaders(fileNames, 1, true), serialHeaders);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(),
+               static_cast<int>(fileNames.size()));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testCacheInvalidation(const std::vector<std::string>& fileNames)
+{
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  std::string headers = readHeaders(fileNames, 4, true);
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> reader;
+  reader->SetArchetype(fileNames[0].c_str());
+  reader->SetSingleFile(0);
+  reader->AddFileName(fileNames[0].c_str());
+  reader->UpdateInformation();
+  CHECK_NUMBER(reader->GetNumberOfSeriesInstanceUIDs(), 1u);
+  std::string uid = reader->GetNthSeriesInstanceUID(0);
+  CHECK_TRUE(!uid.empty());
+  char patchedCharacter = (uid[uid.size() - 1] == '1' ? '2' : '1');
+
+  // Same modification time and size: the cached tags are used
+  CHECK_TRUE(patchSeriesInstanceUID(fileNames[0], uid, patchedCharacter, false));
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  std::string uncachedHeaders = readHeaders(fileNames, 4, false);
+  CHECK_TRUE(uncachedHeaders != headers);
+
+  // Size changed: the file is read again
+  CHECK_TRUE(patchSeriesInstanceUID(fileNames[0], uid, patchedCharacter, true));
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), uncachedHeaders);
+
+  // Modification time changed: the file is read again
+  long modifiedTime = itksys::SystemTools::ModifiedTime(fileNames[0]);
+  CHECK_TRUE(patchSeriesInstanceUID(fileNames[0], uid, uid[uid.size() - 1], false));
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), uncachedHeaders);
+  itksys::SystemTools::Delay(1100);
+  CHECK_TRUE(itksys::SystemTools::Touch(fileNames[0].c_str(), false));
+  CHECK_TRUE(itksys::SystemTools::ModifiedTime(fileNames[0]) != modifiedTime);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(),
+               static_cast<int>(fileNames.size()));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testCacheSize(const std::vector<std::string>& fileNames,
+                  const std::vector<std::string>& otherFileNames)
+{
+  int defaultCacheSize = vtkITKArchetypeImageSeriesReader::GetHeaderCacheSize();
+  CHECK_NUMBER(defaultCacheSize, 50000);
+  int numberOfFiles = static_cast<int>(fileNames.size());
+  int numberOfOtherFiles = static_cast<int>(otherFileNames.size());
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  std::string headers = readHeaders(fileNames, 4, false);
+  std::string otherHeaders = readHeaders(otherFileNames, 4, false);
+
+  // The least recently read directory is forgotten first
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheSize(numberOfFiles);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), numberOfFiles);
+  CHECK_HEADERS(readHeaders(otherFileNames, 4, true), otherHeaders);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), numberOfOtherFiles);
+
+  // A directory that does not fit is partially cached
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheSize(numberOfFiles - 1);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), numberOfOtherFiles);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), numberOfFiles - 1);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+
+  // Reducing the size trims the cache
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheSize(0);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), 0);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(), 0);
+
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheSize(defaultCacheSize);
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testCacheDirectory(const std::vector<std::string>& fileNames,
+                       const std::string& cacheDirectory)
+{
+  CHECK_TRUE(vtkITKArchetypeImageSeriesReader::GetHeaderCacheDirectory().empty());
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(cacheDirectory.c_str());
+  CHECK_TRUE(vtkITKArchetypeImageSeriesReader::GetHeaderCacheDirectory() == cacheDirectory);
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+
+  // The tags of the directory are saved in one file after the scan
+  std::string headers = readHeaders(fileNames, 4, true);
+  itksys::Directory directory;
+  CHECK_TRUE(directory.Load(cacheDirectory));
+  int numberOfCacheFiles = 0;
+  std::string cacheFileName;
+  for (unsigned long n = 0; n < directory.GetNumberOfFiles(); ++n)
+    {
+    std::string fileName = directory.GetFile(n);
+    if (fileName != "." && fileName != "..")
+      {
+      cacheFileName = cacheDirectory + "/" + fileName;
+      ++numberOfCacheFiles;
+      }
+    }
+  CHECK_NUMBER(numberOfCacheFiles, 1);
+  CHECK_TRUE(itksys::SystemTools::GetFilenameLastExtension(cacheFileName) == ".txt");
+
+  // A new session (empty memory cache) uses the saved tags: a file modified
+  // with the same modification time and size is not read again
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> reader;
+  reader->SetArchetype(fileNames[0].c_str());
+  reader->SetSingleFile(0);
+  reader->AddFileName(fileNames[0].c_str());
+  reader->SetUseHeaderCache(false);
+  reader->UpdateInformation();
+  std::string uid = reader->GetNthSeriesInstanceUID(0);
+  CHECK_TRUE(!uid.empty());
+  char patchedCharacter = (uid[uid.size() - 1] == '1' ? '2' : '1');
+  CHECK_TRUE(patchSeriesInstanceUID(fileNames[0], uid, patchedCharacter, false));
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), headers);
+  CHECK_NUMBER(vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders(),
+               static_cast<int>(fileNames.size()));
+
+  // Without cache directory, the tags are read from the files
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(NULL);
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  std::string uncachedHeaders = readHeaders(fileNames, 4, false);
+  CHECK_TRUE(uncachedHeaders != headers);
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), uncachedHeaders);
+
+  // Unsupported cache files are ignored
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(cacheDirectory.c_str());
+  std::ofstream cacheFile(cacheFileName.c_str(), std::ios::trunc);
+  cacheFile << "unknown version\n";
+  cacheFile.close();
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  CHECK_HEADERS(readHeaders(fileNames, 4, true), uncachedHeaders);
+
+  vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(NULL);
+  vtkITKArchetypeImageSeriesReader::ClearHeaderCache();
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 3)
+    {
+    std::cerr << "Usage: vtkITKArchetypeImageSeriesReaderHeaderCacheTest"
+              << " /path/to/file1.dcm /path/to/file2.dcm [...]" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::vector<std::string> sourceFileNames(argv + 1, argv + argc);
+  std::string testDirectory = itksys::SystemTools::GetCurrentWorkingDirectory() +
+    "/vtkITKArchetypeImageSeriesReaderHeaderCacheTest";
+  itksys::SystemTools::RemoveADirectory(testDirectory.c_str());
+
+  std::vector<std::string> fileNames;
+  std::vector<std::string> otherFileNames;
+  CHECK_TRUE(copyFiles(sourceFileNames, sourceFileNames.size(), testDirectory + "/series", fileNames));
+  CHECK_TRUE(copyFiles(sourceFileNames, 2, testDirectory + "/other", otherFileNames));
+
+  int result = EXIT_SUCCESS;
+  if (testParallelReading(fileNames) != EXIT_SUCCESS ||
+      testCacheInvalidation(fileNames) != EXIT_SUCCESS ||
+      testCacheSize(fileNames, otherFileNames) != EXIT_SUCCESS ||
+      testCacheDirectory(fileNames, testDirectory + "/cache") != EXIT_SUCCESS)
+    {
+    result = EXIT_FAILURE;
+    }
+  itksys::SystemTools::RemoveADirectory(testDirectory.c_str());
+  return result;
+}
@@ -23,10 +23,13 @@
 #include <vtkMatrix4x4.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtksys/MD5.h>
 
 // ITK includes
 #include <itkNiftiImageIO.h>
@@ -39,6 +42,11 @@
 
 // STD includes
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
 #include <vector>
 
 #include "itkArchetypeSeriesFileNames.h"
@@ -48,10 +56,492 @@
 #include "itkDCMTKImageIO.h"
 #include "itkGDCMSeriesFileNames.h"
 #include "itkGDCMImageIO.h"
+
+// GDCM includes
+#include "gdcmReader.h"
+#include "gdcmStringFilter.h"
+#include "gdcmTag.h"
 #endif
 
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesReader);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Read a list of files on several threads. Files are handed out one at a
+/// time: reading time varies a lot between files on network storage.
+struct ParallelFileReading
+{
+  ParallelFileReading(size_t numberOfFiles)
+    : NumberOfFiles(numberOfFiles)
+    , NextFile(0)
+    {
+    }
+  virtual ~ParallelFileReading()
+    {
+    }
+
+  /// Called concurrently with different files, by numberOfThreads threads.
+  virtual void ReadFile(int threadId, size_t fileIndex) = 0;
+
+  void Execute(int numberOfThreads);
+
+  size_t NumberOfFiles;
+  size_t NextFile;
+  vtkSimpleMutexLock Lock;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE ParallelFileReadingThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ParallelFileReading* reading = static_cast<ParallelFileReading*>(threadInfo->UserData);
+  while (true)
+    {
+    reading->Lock.Lock();
+    if (reading->NextFile >= reading->NumberOfFiles)
+      {
+      reading->Lock.Unlock();
+      break;
+      }
+    size_t fileIndex = reading->NextFile++;
+    reading->Lock.Unlock();
+    reading->ReadFile(threadInfo->ThreadID, fileIndex);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void ParallelFileReading::Execute(int numberOfThreads)
+{
+  numberOfThreads = std::min(numberOfThreads, static_cast<int>(this->NumberOfFiles));
+  if (numberOfThreads < 1)
+    {
+    return;
+    }
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(ParallelFileReadingThreadFunction, this);
+  threader->SingleMethodExecute();
+}
+
+//----------------------------------------------------------------------------
+/// Read the pixel type of files with one image IO per thread.
+struct ComponentTypeReading : public ParallelFileReading
+{
+  ComponentTypeReading(const std::vector<std::string>& fileNames, size_t numberOfFiles)
+    : ParallelFileReading(numberOfFiles)
+    , FileNames(fileNames)
+    , ComponentTypes(numberOfFiles, itk::ImageIOBase::UNKNOWNCOMPONENTTYPE)
+    {
+    }
+
+  virtual void ReadFile(int threadId, size_t fileIndex)
+    {
+    itk::ImageIOBase* imageIO = this->ImageIOs[threadId];
+    try
+      {
+      imageIO->SetFileName(this->FileNames[fileIndex]);
+      imageIO->ReadImageInformation();
+      this->ComponentTypes[fileIndex] = imageIO->GetComponentType();
+      }
+    catch (itk::ExceptionObject&)
+      {
+      // the component type stays unknown, the file is read again by the caller
+      }
+    }
+
+  const std::vector<std::string>& FileNames;
+  /// One image IO per thread
+  std::vector<itk::ImageIOBase::Pointer> ImageIOs;
+  std::vector<itk::ImageIOBase::IOComponentType> ComponentTypes;
+};
+
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+
+//----------------------------------------------------------------------------
+/// DICOM tags used to group the files of a directory into volumes.
+enum GroupingTagIndex
+{
+  SeriesInstanceUIDTag = 0,
+  ContentTimeTag,
+  TriggerTimeTag,
+  EchoNumbersTag,
+  DiffusionGradientOrientationTag,
+  SliceLocationTag,
+  ImageOrientationPatientTag,
+  ImagePositionPatientTag,
+  NumberOfGroupingTags
+};
+
+struct GroupingTag
+{
+  uint16_t Group;
+  uint16_t Element;
+  const char* Key;
+};
+
+const GroupingTag GroupingTags[NumberOfGroupingTags] =
+{
+  { 0x0020, 0x000e, "0020|000e" },
+  { 0x0008, 0x0033, "0008|0033" },
+  { 0x0018, 0x1060, "0018|1060" },
+  { 0x0018, 0x0086, "0018|0086" },
+  { 0x0010, 0x9089, "0010|9089" },
+  { 0x0020, 0x1041, "0020|1041" },
+  { 0x0020, 0x0037, "0020|0037" },
+  { 0x0020, 0x0032, "0020|0032" }
+};
+
+//----------------------------------------------------------------------------
+/// Modification time and size of a file: the cached tags of a file are valid
+/// only if both are unchanged. The modification time has a resolution of one
+/// second, the size catches most of the rewrites within the same second.
+struct FileStamp
+{
+  FileStamp()
+    : ModifiedTime(0)
+    , FileLength(0)
+    {
+    }
+  FileStamp(const std::string& fileName)
+    : ModifiedTime(itksys::SystemTools::ModifiedTime(fileName))
+    , FileLength(itksys::SystemTools::FileLength(fileName))
+    {
+    }
+  bool operator==(const FileStamp& other) const
+    {
+    return this->ModifiedTime == other.ModifiedTime
+      && this->FileLength == other.FileLength;
+    }
+
+  long ModifiedTime;
+  unsigned long FileLength;
+};
+
+//----------------------------------------------------------------------------
+/// Grouping tags of the files read so far, by directory then by file name.
+/// The cache lives in memory for the duration of the process. It holds at
+/// most HeaderCacheSize files: the least recently used directories are
+/// forgotten first.
+/// If HeaderCacheDirectory is set, the tags of each directory are also saved
+/// in a file of HeaderCacheDirectory after the directory is scanned, and
+/// loaded from it the first time the directory is scanned by the process.
+struct HeaderCacheEntry
+{
+  FileStamp Stamp;
+  std::vector<std::string> TagValues;
+};
+struct DirectoryHeaderCache
+{
+  DirectoryHeaderCache()
+    : LastUsed(0)
+    , Modified(false)
+    {
+    }
+  std::map<std::string, HeaderCacheEntry> Entries;
+  unsigned long LastUsed;
+  /// Entries changed since the directory was loaded or saved
+  bool Modified;
+};
+typedef std::map<std::string, DirectoryHeaderCache> HeaderCacheType;
+
+HeaderCacheType HeaderCache;
+int HeaderCacheSize = 50000;
+int NumberOfCachedHeaders = 0;
+unsigned long HeaderCacheUseCount = 0;
+vtkSimpleMutexLock HeaderCacheLock;
+
+std::string HeaderCacheDirectory;
+/// Directories whose cache file has been loaded (or found missing)
+std::set<std::string> LoadedHeaderCacheDirectories;
+/// First line of the cache files. Must be changed when GroupingTags or the
+/// format of the file changes, older files are then ignored.
+const char HeaderCacheFileVersion[] = "vtkITKArchetypeImageSeriesReader header cache 1";
+
+//----------------------------------------------------------------------------
+/// Copy the cached tags of the file if its stamp is unchanged.
+/// Must be called with HeaderCacheLock locked.
+bool FindCachedHeader(const std::string& directory, const std::string& name,
+                      const FileStamp& stamp, std::vector<std::string>& tagValues)
+{
+  HeaderCacheType::iterator directoryIt = HeaderCache.find(directory);
+  if (directoryIt == HeaderCache.end())
+    {
+    return false;
+    }
+  directoryIt->second.LastUsed = ++HeaderCacheUseCount;
+  std::map<std::string, HeaderCacheEntry>::const_iterator entryIt =
+    directoryIt->second.Entries.find(name);
+  if (entryIt == directoryIt->second.Entries.end() || !(entryIt->second.Stamp == stamp))
+    {
+    return false;
+    }
+  tagValues = entryIt->second.TagValues;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Forget the least recently used directories, other than \a keptDirectory,
+/// until the cache holds less than \a maximumNumberOfHeaders files.
+/// Must be called with HeaderCacheLock locked.
+void TrimHeaderCache(int maximumNumberOfHeaders, const std::string& keptDirectory)
+{
+  while (NumberOfCachedHeaders > maximumNumberOfHeaders)
+    {
+    HeaderCacheType::iterator oldestIt = HeaderCache.end();
+    for (HeaderCacheType::iterator directoryIt = HeaderCache.begin();
+         directoryIt != HeaderCache.end(); ++directoryIt)
+      {
+      if (directoryIt->first != keptDirectory &&
+          (oldestIt == HeaderCache.end() || directoryIt->second.LastUsed < oldestIt->second.LastUsed))
+        {
+        oldestIt = directoryIt;
+        }
+      }
+    if (oldestIt == HeaderCache.end())
+      {
+      return;
+      }
+    NumberOfCachedHeaders -= static_cast<int>(oldestIt->second.Entries.size());
+    // the directory is loaded again from its cache file if it is scanned again
+    LoadedHeaderCacheDirectories.erase(oldestIt->first);
+    HeaderCache.erase(oldestIt);
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Must be called with HeaderCacheLock locked.
+void AddCachedHeader(const std::string& directory, const std::string& name,
+                     const HeaderCacheEntry& entry)
+{
+  DirectoryHeaderCache& directoryCache = HeaderCache[directory];
+  directoryCache.LastUsed = ++HeaderCacheUseCount;
+  std::map<std::string, HeaderCacheEntry>::iterator entryIt = directoryCache.Entries.find(name);
+  if (entryIt != directoryCache.Entries.end())
+    {
+    entryIt->second = entry;
+    directoryCache.Modified = true;
+    return;
+    }
+  TrimHeaderCache(HeaderCacheSize - 1, directory);
+  if (NumberOfCachedHeaders >= HeaderCacheSize)
+    {
+    // the directory alone fills the cache, its other files stay cached
+    if (directoryCache.Entries.empty())
+      {
+      HeaderCache.erase(directory);
+      }
+    return;
+    }
+  directoryCache.Entries[name] = entry;
+  directoryCache.Modified = true;
+  ++NumberOfCachedHeaders;
+}
+
+//----------------------------------------------------------------------------
+/// File of HeaderCacheDirectory holding the tags of the files of \a directory.
+std::string GetHeaderCacheFileName(const std::string& directory)
+{
+  char hash[33];
+  vtksysMD5* md5 = vtksysMD5_New();
+  vtksysMD5_Initialize(md5);
+  vtksysMD5_Append(md5, reinterpret_cast<const unsigned char*>(directory.c_str()),
+                   static_cast<int>(directory.size()));
+  vtksysMD5_FinalizeHex(md5, hash);
+  vtksysMD5_Delete(md5);
+  hash[32] = 0;
+  return HeaderCacheDirectory + "/" + hash + ".txt";
+}
+
+//----------------------------------------------------------------------------
+/// Split a line of a cache file, empty fields are kept.
+std::vector<std::string> SplitHeaderCacheLine(const std::string& line)
+{
+  std::vector<std::string> fields;
+  size_t start = 0;
+  size_t tab = line.find('\t');
+  while (tab != std::string::npos)
+    {
+    fields.push_back(line.substr(start, tab - start));
+    start = tab + 1;
+    tab = line.find('\t', start);
+    }
+  fields.push_back(line.substr(start));
+  return fields;
+}
+
+//----------------------------------------------------------------------------
+/// Load the cache file of \a directory, unless the directory is already
+/// cached in memory (memory is more recent).
+/// Must be called with HeaderCacheLock locked.
+void LoadHeaderCacheFile(const std::string& directory)
+{
+  if (HeaderCacheDirectory.empty() ||
+      !LoadedHeaderCacheDirectories.insert(directory).second ||
+      HeaderCache.find(directory) != HeaderCache.end())
+    {
+    return;
+    }
+  // The file starts with the version and the directory, then each line is:
+  // file name, modification time, file size, tag values, separated by tabs
+  std::ifstream file(GetHeaderCacheFileName(directory).c_str());
+  std::string line;
+  if (!std::getline(file, line) || line != HeaderCacheFileVersion ||
+      !std::getline(file, line) || line != directory)
+    {
+    return;
+    }
+  while (std::getline(file, line))
+    {
+    std::vector<std::string> fields = SplitHeaderCacheLine(line);
+    if (fields.size() != static_cast<size_t>(3 + NumberOfGroupingTags))
+      {
+      continue;
+      }
+    HeaderCacheEntry entry;
+    entry.Stamp.ModifiedTime = atol(fields[1].c_str());
+    entry.Stamp.FileLength = strtoul(fields[2].c_str(), NULL, 10);
+    entry.TagValues.assign(fields.begin() + 3, fields.end());
+    AddCachedHeader(directory, fields[0], entry);
+    }
+  HeaderCacheType::iterator directoryIt = HeaderCache.find(directory);
+  if (directoryIt != HeaderCache.end())
+    {
+    directoryIt->second.Modified = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Write the cache file of \a directory if its tags changed. The file is
+/// written next to the cache file then renamed, so that other processes
+/// never read a partially written file.
+/// Must be called with HeaderCacheLock locked.
+void SaveHeaderCacheFile(const std::string& directory)
+{
+  HeaderCacheType::iterator directoryIt = HeaderCache.find(directory);
+  if (HeaderCacheDirectory.empty() || directoryIt == HeaderCache.end() ||
+      !directoryIt->second.Modified ||
+      !itksys::SystemTools::MakeDirectory(HeaderCacheDirectory.c_str()))
+    {
+    return;
+    }
+  std::string fileName = GetHeaderCacheFileName(directory);
+  std::string temporaryFileName = fileName + ".tmp";
+  std::ofstream file(temporaryFileName.c_str(), std::ios::trunc);
+  file << HeaderCacheFileVersion << "\n" << directory << "\n";
+  for (std::map<std::string, HeaderCacheEntry>::const_iterator entryIt = directoryIt->second.Entries.begin();
+       entryIt != directoryIt->second.Entries.end(); ++entryIt)
+    {
+    if (entryIt->first.find_first_of("\t\n") != std::string::npos)
+      {
+      continue;
+      }
+    file << entryIt->first << "\t" << entryIt->second.Stamp.ModifiedTime
+         << "\t" << entryIt->second.Stamp.FileLength;
+    for (std::vector<std::string>::const_iterator tagIt = entryIt->second.TagValues.begin();
+         tagIt != entryIt->second.TagValues.end(); ++tagIt)
+      {
+      // the spaces, tabs and new lines of the tag values have been removed
+      file << "\t" << *tagIt;
+      }
+    file << "\n";
+    }
+  file.close();
+  if (file.fail())
+    {
+    itksys::SystemTools::RemoveFile(temporaryFileName.c_str());
+    return;
+    }
+  itksys::SystemTools::RemoveFile(fileName.c_str());
+  if (rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+    itksys::SystemTools::RemoveFile(temporaryFileName.c_str());
+    return;
+    }
+  directoryIt->second.Modified = false;
+}
+
+//----------------------------------------------------------------------------
+/// Read the grouping tags of DICOM files. Only the data elements up to the
+/// last grouping tag are parsed, pixel data is never read.
+struct GroupingTagReading : public ParallelFileReading
+{
+  GroupingTagReading(const std::vector<std::string>& fileNames, bool useCache)
+    : ParallelFileReading(fileNames.size())
+    , FileNames(fileNames)
+    , UseCache(useCache)
+    , TagValues(fileNames.size())
+    , Failed(fileNames.size(), 0)
+    {
+    for (int tagIndex = 0; tagIndex < NumberOfGroupingTags; ++tagIndex)
+      {
+      this->Tags.insert(gdcm::Tag(GroupingTags[tagIndex].Group, GroupingTags[tagIndex].Element));
+      }
+    }
+
+  virtual void ReadFile(int vtkNotUsed(threadId), size_t fileIndex)
+    {
+    const std::string& fileName = this->FileNames[fileIndex];
+    std::vector<std::string>& tagValues = this->TagValues[fileIndex];
+    std::string directory;
+    std::string name;
+    HeaderCacheEntry entry;
+    if (this->UseCache)
+      {
+      directory = itksys::SystemTools::GetFilenamePath(fileName);
+      name = itksys::SystemTools::GetFilenameName(fileName);
+      entry.Stamp = FileStamp(fileName);
+      HeaderCacheLock.Lock();
+      bool found = FindCachedHeader(directory, name, entry.Stamp, tagValues);
+      HeaderCacheLock.Unlock();
+      if (found)
+        {
+        return;
+        }
+      }
+
+    gdcm::Reader reader;
+    reader.SetFileName(fileName.c_str());
+    if (!reader.ReadSelectedTags(this->Tags))
+      {
+      this->Failed[fileIndex] = 1;
+      return;
+      }
+    gdcm::StringFilter stringFilter;
+    stringFilter.SetFile(reader.GetFile());
+    tagValues.resize(NumberOfGroupingTags);
+    for (int tagIndex = 0; tagIndex < NumberOfGroupingTags; ++tagIndex)
+      {
+      std::string tagValue = stringFilter.ToString(
+        gdcm::Tag(GroupingTags[tagIndex].Group, GroupingTags[tagIndex].Element));
+      // Same as vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces
+      tagValue.erase(std::remove_if(tagValue.begin(), tagValue.end(), isspace), tagValue.end());
+      tagValues[tagIndex] = tagValue;
+      }
+
+    if (this->UseCache)
+      {
+      entry.TagValues = tagValues;
+      HeaderCacheLock.Lock();
+      AddCachedHeader(directory, name, entry);
+      HeaderCacheLock.Unlock();
+      }
+    }
+
+  const std::vector<std::string>& FileNames;
+  bool UseCache;
+  std::set<gdcm::Tag> Tags;
+  std::vector<std::vector<std::string> > TagValues;
+  // not a vector<bool>, whose elements can't be written concurrently
+  std::vector<char> Failed;
+};
+
+#endif
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
 {
@@ -73,6 +563,9 @@ vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
   this->SetDICOMImageIOApproachToGDCM();
 #endif
 
+  this->NumberOfHeaderReaderThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->UseHeaderCache = true;
+
   this->OutputScalarType = VTK_FLOAT;
   this->NumberOfComponents = 0;
   this->UseNativeScalarType = 0;
@@ -175,9 +668,88 @@ void vtkITKArchetypeImageSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
     }
   os << ")\n";
 #ifdef VTKITK_BUILD_DICOM_SUPPORT
-  os << indent << "DICOMImageIOApproach: " << this->GetDICOMImageIOApproach();
+  os << indent << "DICOMImageIOApproach: " << this->GetDICOMImageIOApproach() << "\n";
 #else
-  os << indent << "DICOMImageIOApproach: " << "NA";
+  os << indent << "DICOMImageIOApproach: " << "NA" << "\n";
+#endif
+  os << indent << "NumberOfHeaderReaderThreads: " << this->NumberOfHeaderReaderThreads << "\n";
+  os << indent << "UseHeaderCache: " << this->UseHeaderCache << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkITKArchetypeImageSeriesReader::ClearHeaderCache()
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  HeaderCache.clear();
+  LoadedHeaderCacheDirectories.clear();
+  NumberOfCachedHeaders = 0;
+  HeaderCacheLock.Unlock();
+#endif
+}
+
+//----------------------------------------------------------------------------
+void vtkITKArchetypeImageSeriesReader::SetHeaderCacheDirectory(const char* directory)
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  HeaderCacheDirectory = (directory ? directory : "");
+  LoadedHeaderCacheDirectories.clear();
+  HeaderCacheLock.Unlock();
+#else
+  (void)directory;
+#endif
+}
+
+//----------------------------------------------------------------------------
+std::string vtkITKArchetypeImageSeriesReader::GetHeaderCacheDirectory()
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  std::string directory = HeaderCacheDirectory;
+  HeaderCacheLock.Unlock();
+  return directory;
+#else
+  return std::string();
+#endif
+}
+
+//----------------------------------------------------------------------------
+void vtkITKArchetypeImageSeriesReader::SetHeaderCacheSize(int numberOfFiles)
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  HeaderCacheSize = std::max(numberOfFiles, 0);
+  TrimHeaderCache(HeaderCacheSize, std::string());
+  HeaderCacheLock.Unlock();
+#else
+  (void)numberOfFiles;
+#endif
+}
+
+//----------------------------------------------------------------------------
+int vtkITKArchetypeImageSeriesReader::GetHeaderCacheSize()
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  int size = HeaderCacheSize;
+  HeaderCacheLock.Unlock();
+  return size;
+#else
+  return 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+int vtkITKArchetypeImageSeriesReader::GetNumberOfCachedHeaders()
+{
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+  HeaderCacheLock.Lock();
+  int numberOfHeaders = NumberOfCachedHeaders;
+  HeaderCacheLock.Unlock();
+  return numberOfHeaders;
+#else
+  return 0;
 #endif
 }
 
@@ -741,59 +1313,89 @@ int vtkITKArchetypeImageSeriesReader::RequestInformation(
       {
       double min = 0, max = 0;
 
-      for( unsigned int f = 0; f < this->FileNames.size(); f++ )
+      // All the files but the last one are read in parallel. The last file is
+      // read by imageIO, that provides the number of components and the meta
+      // data dictionary.
+      size_t numberOfFiles = this->FileNames.size();
+      ComponentTypeReading componentTypeReading(this->FileNames, numberOfFiles - 1);
+      int numberOfThreads = std::min(this->NumberOfHeaderReaderThreads, static_cast<int>(numberOfFiles - 1));
+      for (int threadId = 0; threadId < numberOfThreads; ++threadId)
         {
-        imageIO->SetFileName( this->FileNames[f] );
-        imageIO->ReadImageInformation();
+        itk::ImageIOBase::Pointer threadImageIO =
+          dynamic_cast<itk::ImageIOBase*>(imageIO->CreateAnother().GetPointer());
+        if (threadImageIO.IsNull())
+          {
+          numberOfThreads = 0;
+          break;
+          }
+        componentTypeReading.ImageIOs.push_back(threadImageIO);
+        }
+      componentTypeReading.Execute(numberOfThreads);
 
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::UCHAR )
+      for( unsigned int f = 0; f < numberOfFiles; f++ )
+        {
+        itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+        if ( f < numberOfFiles - 1 )
+          {
+          componentType = componentTypeReading.ComponentTypes[f];
+          }
+        if ( componentType == itk::ImageIOBase::UNKNOWNCOMPONENTTYPE )
+          {
+          // Last file, or file that could not be read in parallel: errors are
+          // reported by reading it again.
+          imageIO->SetFileName( this->FileNames[f] );
+          imageIO->ReadImageInformation();
+          componentType = imageIO->GetComponentType();
+          }
+
+        if ( componentType == itk::ImageIOBase::UCHAR )
           {
           min = std::numeric_limits<uint8_t>::min() < min ? std::numeric_limits<uint8_t>::min() : min;
           max = std::numeric_limits<uint8_t>::max() > max ? std::numeric_limits<uint8_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::CHAR )
+        if ( componentType == itk::ImageIOBase::CHAR )
           {
           min = std::numeric_limits<int8_t>::min() < min ? std::numeric_limits<int8_t>::min() : min;
           max = std::numeric_limits<int8_t>::max() > max ? std::numeric_limits<int8_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::USHORT )
+        if ( componentType == itk::ImageIOBase::USHORT )
           {
           min = std::numeric_limits<uint16_t>::min() < min ? std::numeric_limits<uint16_t>::min() : min;
           max = std::numeric_limits<uint16_t>::max() > max ? std::numeric_limits<uint16_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::SHORT )
+        if ( componentType == itk::ImageIOBase::SHORT )
           {
           min = std::numeric_limits<int16_t>::min() < min ? std::numeric_limits<int16_t>::min() : min;
           max = std::numeric_limits<int16_t>::max() > max ? std::numeric_limits<int16_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::UINT )
+        if ( componentType == itk::ImageIOBase::UINT )
           {
           min = std::numeric_limits<uint32_t>::min() < min ? std::numeric_limits<uint32_t>::min() : min;
           max = std::numeric_limits<uint32_t>::max() > max ? std::numeric_limits<uint32_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::INT )
+        if ( componentType == itk::ImageIOBase::INT )
           {
           min = std::numeric_limits<int32_t>::min() < min ? std::numeric_limits<int32_t>::min() : min;
           max = std::numeric_limits<int32_t>::max() > max ? std::numeric_limits<int32_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::ULONG )
+        if ( componentType == itk::ImageIOBase::ULONG )
           { // note that on windows ULONG is only 32 bit
           min = std::numeric_limits<uint64_t>::min() < min ? std::numeric_limits<uint64_t>::min() : min;
           max = std::numeric_limits<uint64_t>::max() > max ? std::numeric_limits<uint64_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::LONG )
+        if ( componentType == itk::ImageIOBase::LONG )
           { // note that on windows LONG is only 32 bit
           min = std::numeric_limits<int64_t>::min() < min ? std::numeric_limits<int64_t>::min() : min;
           max = std::numeric_limits<int64_t>::max() > max ? std::numeric_limits<int64_t>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::FLOAT )
+        if ( componentType == itk::ImageIOBase::FLOAT )
           {
           // use -max() as min() for both float and double as temp workaround
           // should switch to lowest() function in C++ 11 in the future
           min = -std::numeric_limits<float>::max() < min ? -std::numeric_limits<float>::max() : min;
           max = std::numeric_limits<float>::max() > max ? std::numeric_limits<float>::max() : max;
           }
-        if ( imageIO->GetComponentType() == itk::ImageIOBase::DOUBLE )
+        if ( componentType == itk::ImageIOBase::DOUBLE )
           {
           min = -std::numeric_limits<double>::max() < min ? -std::numeric_limits<double>::max() : min;
           max = std::numeric_limits<double>::max() > max ? std::numeric_limits<double>::max() : max;
@@ -1224,21 +1826,53 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     return;
     }
 
-  // if Archetype is a Dicom File
+  // if Archetype is a Dicom File, read the tags of all the files in parallel
+  std::set<std::string> directories;
+  for (int f = 0; this->UseHeaderCache && f < nFiles; f++)
+    {
+    directories.insert(itksys::SystemTools::GetFilenamePath(this->AllFileNames[f]));
+    }
+  HeaderCacheLock.Lock();
+  for (std::set<std::string>::iterator it = directories.begin(); it != directories.end(); ++it)
+    {
+    LoadHeaderCacheFile(*it);
+    }
+  HeaderCacheLock.Unlock();
+  GroupingTagReading groupingTagReading(this->AllFileNames, this->UseHeaderCache);
+  groupingTagReading.Execute(this->NumberOfHeaderReaderThreads);
+  HeaderCacheLock.Lock();
+  for (std::set<std::string>::iterator it = directories.begin(); it != directories.end(); ++it)
+    {
+    SaveHeaderCacheFile(*it);
+    }
+  HeaderCacheLock.Unlock();
+
+  // The tags are inserted in the order of the files, as the indices of the
+  // unique values depend on it.
   gdcmIO->SetFileName( this->Archetype );
   for (int f = 0; f < nFiles; f++)
   {
-    gdcmIO->SetFileName( this->AllFileNames[f] );
-    gdcmIO->ReadImageInformation();
-    itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
+    std::vector<std::string>& tagValues = groupingTagReading.TagValues[f];
+    if (groupingTagReading.Failed[f])
+    {
+      // Let GDCMImageIO read the file and report errors
+      gdcmIO->SetFileName( this->AllFileNames[f] );
+      gdcmIO->ReadImageInformation();
+      itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
+      // Use vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces to remove extra spaces
+      // from the DICOM tag, because extra spaces were found in some DICOM file before/after the
+      // multi-value separator backslashes.
+      tagValues.resize(NumberOfGroupingTags);
+      for (int tagIndex = 0; tagIndex < NumberOfGroupingTags; ++tagIndex)
+      {
+        tagValues[tagIndex] = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(
+          dict, GroupingTags[tagIndex].Key);
+      }
+    }
     std::string tagValue;
 
-    // Use vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces to remove extra spaces
-    // from the DICOM tag, because extra spaces were found in some DICOM file before/after the
-    // multi-value separator backslashes.
-
     // series instance UID
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|000e");
+    tagValue = tagValues[SeriesInstanceUIDTag];
     if (!tagValue.empty())
     {
       int idx = InsertSeriesInstanceUIDs( tagValue.c_str() );
@@ -1250,7 +1884,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // content time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0008|0033");
+    tagValue = tagValues[ContentTimeTag];
     if (!tagValue.empty())
     {
       int idx = InsertContentTime( tagValue.c_str() );
@@ -1262,7 +1896,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // trigger time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|1060");
+    tagValue = tagValues[TriggerTimeTag];
     if (!tagValue.empty())
     {
       int idx = InsertTriggerTime( tagValue.c_str() );
@@ -1274,7 +1908,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // echo numbers
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|0086");
+    tagValue = tagValues[EchoNumbersTag];
     if (!tagValue.empty())
     {
       int idx = InsertEchoNumbers( tagValue.c_str() );
@@ -1286,7 +1920,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // diffision gradient orientation
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0010|9089");
+    tagValue = tagValues[DiffusionGradientOrientationTag];
     if (!tagValue.empty())
     {
       float a[3] = { -1 };
@@ -1300,7 +1934,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // slice location
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|1041");
+    tagValue = tagValues[SliceLocationTag];
     if (!tagValue.empty())
     {
       float a = -1;
@@ -1314,7 +1948,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // image orientation patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0037");
+    tagValue = tagValues[ImageOrientationPatientTag];
     if (!tagValue.empty())
     {
       float a[6] = { -1 };
@@ -1327,7 +1961,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       this->IndexImageOrientationPatient[f] = -1;
     }
     // image position patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0032");
+    tagValue = tagValues[ImagePositionPatientTag];
     if (!tagValue.empty())
     {
       float a[3] = { -1 };
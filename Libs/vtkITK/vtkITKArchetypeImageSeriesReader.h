@@ -251,6 +251,51 @@ public:
   vtkSetMacro(UseOrientationFromFile, int);
   vtkGetMacro(UseOrientationFromFile, int);
 
+  ///
+  /// Number of threads used to read the headers of the files of a series.
+  /// Only the headers are read: the DICOM tags used to group the files up to
+  /// the pixel data, and the pixel type of the files of the selected volume.
+  /// (Default is the number of processors)
+  vtkSetClampMacro(NumberOfHeaderReaderThreads, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfHeaderReaderThreads, int);
+
+  ///
+  /// Whether the DICOM tags used to group the files are reused from the
+  /// previous readings of the same files. Cached tags are shared by all the
+  /// readers and kept per directory, in memory, and saved between sessions
+  /// if a cache directory is set. They are read again when the modification
+  /// time or the size of the file changes. (Default is true)
+  /// \sa SetHeaderCacheSize(), ClearHeaderCache(), SetHeaderCacheDirectory()
+  vtkSetMacro(UseHeaderCache, bool);
+  vtkGetMacro(UseHeaderCache, bool);
+  vtkBooleanMacro(UseHeaderCache, bool);
+
+  ///
+  /// Maximum number of files whose DICOM tags are cached. When the cache is
+  /// full, the tags of the least recently read directories are forgotten.
+  /// (Default is 50000)
+  static void SetHeaderCacheSize(int numberOfFiles);
+  static int GetHeaderCacheSize();
+
+  ///
+  /// Number of files whose DICOM tags are currently cached.
+  static int GetNumberOfCachedHeaders();
+
+  ///
+  /// Forget the cached DICOM tags of all the directories. The files of the
+  /// cache directory are kept, they are loaded again when the directories
+  /// are scanned.
+  static void ClearHeaderCache();
+
+  ///
+  /// Directory where the cached DICOM tags are saved, one file per scanned
+  /// directory, to be reused by the next sessions. The file of a directory
+  /// is loaded the first time the directory is scanned, and written after
+  /// each scan that read new tags. Empty to keep the tags in memory only.
+  /// (Default is empty)
+  static void SetHeaderCacheDirectory(const char* directory);
+  static std::string GetHeaderCacheDirectory();
+
   ///
   /// Returns an IJK to RAS transformation matrix
   vtkMatrix4x4* GetRasToIjkMatrix();
@@ -838,6 +883,9 @@ protected:
 
   int DICOMImageIOApproach;
 
+  int NumberOfHeaderReaderThreads;
+  bool UseHeaderCache;
+
   bool GroupingByTags;
   int SelectedUID;
   int SelectedContentTime;
@@ -0,0 +1,288 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationConverterFactory.h"
+
+// STD includes
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Create a binary labelmap with a box of foreground voxels. The image extent is the box padded by margin voxels.
+void CreateBoxLabelmap(vtkOrientedImageData* imageData, const int boxExtent[6], int margin)
+{
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  imageToWorldMatrix->SetElement(0, 0, 0.5);
+  imageToWorldMatrix->SetElement(1, 1, 0.8);
+  imageToWorldMatrix->SetElement(2, 2, 1.2);
+  imageToWorldMatrix->SetElement(0, 3, -20.0);
+  imageToWorldMatrix->SetElement(1, 3, 10.0);
+  imageToWorldMatrix->SetElement(2, 3, 5.0);
+  imageData->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  imageData->SetExtent(boxExtent[0] - margin, boxExtent[1] + margin, boxExtent[2] - margin,
+    boxExtent[3] + margin, boxExtent[4] - margin, boxExtent[5] + margin);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  vtkOrientedImageDataResample::FillImage(imageData, 0);
+  vtkOrientedImageDataResample::FillImage(imageData, 1, boxExtent);
+}
+
+//----------------------------------------------------------------------------
+bool CompareSurfaces(vtkPolyData* expected, vtkPolyData* actual, bool exactTopology, int line)
+{
+  if (exactTopology && (expected->GetNumberOfPoints() != actual->GetNumberOfPoints()
+    || expected->GetNumberOfPolys() != actual->GetNumberOfPolys()))
+    {
+    std::cerr << line << ": Surface mismatch. Expected " << expected->GetNumberOfPoints() << " points, "
+      << expected->GetNumberOfPolys() << " polys, got " << actual->GetNumberOfPoints() << " points, "
+      << actual->GetNumberOfPolys() << " polys" << std::endl;
+    return false;
+    }
+  if ((expected->GetNumberOfPolys() == 0) != (actual->GetNumberOfPolys() == 0))
+    {
+    std::cerr << line << ": Surface mismatch, one of the surfaces is empty" << std::endl;
+    return false;
+    }
+  double expectedBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  double actualBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  expected->GetBounds(expectedBounds);
+  actual->GetBounds(actualBounds);
+  for (int i = 0; i < 6; ++i)
+    {
+    if (fabs(expectedBounds[i] - actualBounds[i]) > 0.01)
+      {
+      std::cerr << line << ": Surface bounds mismatch at index " << i << ": expected "
+        << expectedBounds[i] << ", got " << actualBounds[i] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void CountEventsCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  int* numberOfEvents = reinterpret_cast<int*>(clientData);
+  (*numberOfEvents)++;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkBinaryLabelmapToClosedSurfaceConversionRuleTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Boxes with different extents: touching boxes, a box touching the border of its image and an empty labelmap
+  const int numberOfLabelmaps = 5;
+  const int boxExtents[numberOfLabelmaps][6] = {
+    { 10, 30, 10, 30, 10, 30 },
+    { 31, 45, 12, 20, 14, 40 },
+    { 50, 52, 50, 70, 0, 5 },
+    { 5, 8, 40, 60, 35, 50 },
+    { 60, 61, 0, 1, 60, 61 } };
+  const int margins[numberOfLabelmaps] = { 2, 3, 0, 5, 1 };
+
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > labelmaps;
+  std::vector<vtkOrientedImageData*> labelmapPointers;
+  for (int i = 0; i < numberOfLabelmaps; ++i)
+    {
+    vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    CreateBoxLabelmap(labelmap, boxExtents[i], margins[i]);
+    labelmaps.push_back(labelmap);
+    labelmapPointers.push_back(labelmap);
+    }
+  // empty labelmap
+  vtkOrientedImageDataResample::FillImage(labelmaps[4], 0);
+
+  // Check results without decimation and smoothing: surfaces must be identical,
+  // then with the default parameters: surfaces must cover the same region.
+  for (int defaultParameters = 0; defaultParameters < 2; ++defaultParameters)
+    {
+    vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+    if (!defaultParameters)
+      {
+      rule->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetDecimationFactorParameterName(), "0.0");
+      rule->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0.0");
+      }
+
+    vtkNew<vtkTimerLog> timer;
+    timer->StartTimer();
+    std::vector<vtkSmartPointer<vtkPolyData> > expectedSurfaces;
+    for (int i = 0; i < numberOfLabelmaps; ++i)
+      {
+      vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+      if (!rule->Convert(labelmaps[i], surface))
+        {
+        std::cerr << __LINE__ << ": Conversion of segment " << i << " failed" << std::endl;
+        return EXIT_FAILURE;
+        }
+      expectedSurfaces.push_back(surface);
+      }
+    timer->StopTimer();
+    double perSegmentTime = timer->GetElapsedTime();
+
+    timer->StartTimer();
+    std::vector<vtkSmartPointer<vtkPolyData> > surfaces;
+    std::vector<vtkPolyData*> surfacePointers;
+    for (int i = 0; i < numberOfLabelmaps; ++i)
+      {
+      surfaces.push_back(vtkSmartPointer<vtkPolyData>::New());
+      surfacePointers.push_back(surfaces.back());
+      }
+    if (!rule->ConvertInSinglePass(labelmapPointers, surfacePointers, 4))
+      {
+      std::cerr << __LINE__ << ": Single pass conversion failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    timer->StopTimer();
+    double singlePassTime = timer->GetElapsedTime();
+
+    for (int i = 0; i < numberOfLabelmaps; ++i)
+      {
+      if (!CompareSurfaces(expectedSurfaces[i], surfaces[i], !defaultParameters, __LINE__))
+        {
+        std::cerr << "  segment " << i << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if (surfaces[4]->GetNumberOfPoints() != 0)
+      {
+      std::cerr << __LINE__ << ": Surface of empty labelmap is not empty" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    std::cout << "<DartMeasurement name=\"ClosedSurfaceConversion-PerSegment-" << defaultParameters
+              << "\" type=\"numeric/double\">" << perSegmentTime << "</DartMeasurement>" << std::endl;
+    std::cout << "<DartMeasurement name=\"ClosedSurfaceConversion-SinglePass-" << defaultParameters
+              << "\" type=\"numeric/double\">" << singlePassTime << "</DartMeasurement>" << std::endl;
+    }
+
+  // Labels of a merged labelmap, including a label that is listed twice and one that is not present
+  vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+  vtkNew<vtkOrientedImageData> mergedLabelmap;
+  CreateBoxLabelmap(mergedLabelmap.GetPointer(), boxExtents[0], 2);
+  vtkOrientedImageDataResample::FillImage(mergedLabelmap.GetPointer(), 3, boxExtents[0]);
+  std::vector<int> labelValues;
+  labelValues.push_back(3);
+  labelValues.push_back(7);
+  labelValues.push_back(3);
+  std::vector<vtkSmartPointer<vtkPolyData> > mergedSurfaces;
+  std::vector<vtkPolyData*> mergedSurfacePointers;
+  for (size_t i = 0; i < labelValues.size(); ++i)
+    {
+    mergedSurfaces.push_back(vtkSmartPointer<vtkPolyData>::New());
+    mergedSurfacePointers.push_back(mergedSurfaces.back());
+    }
+  if (!rule->ConvertMergedLabelmap(mergedLabelmap.GetPointer(), labelValues, mergedSurfacePointers))
+    {
+    std::cerr << __LINE__ << ": Merged labelmap conversion failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkNew<vtkPolyData> expectedSurface;
+  rule->Convert(labelmaps[0], expectedSurface.GetPointer());
+  if (!CompareSurfaces(expectedSurface.GetPointer(), mergedSurfaces[0], false, __LINE__)
+    || !CompareSurfaces(expectedSurface.GetPointer(), mergedSurfaces[2], false, __LINE__)
+    || mergedSurfaces[1]->GetNumberOfPoints() != 0)
+    {
+    std::cerr << __LINE__ << ": Unexpected surfaces from merged labelmap" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Overlapping labelmaps cannot be converted in a single pass, outputs must be left unchanged
+  vtkNew<vtkOrientedImageData> overlappingLabelmap;
+  const int overlappingExtent[6] = { 25, 35, 25, 35, 25, 35 };
+  CreateBoxLabelmap(overlappingLabelmap.GetPointer(), overlappingExtent, 1);
+  std::vector<vtkOrientedImageData*> overlappingLabelmaps;
+  overlappingLabelmaps.push_back(labelmaps[0]);
+  overlappingLabelmaps.push_back(overlappingLabelmap.GetPointer());
+  std::vector<vtkPolyData*> overlappingSurfaces;
+  overlappingSurfaces.push_back(mergedSurfaces[0]);
+  overlappingSurfaces.push_back(mergedSurfaces[1]);
+  vtkIdType numberOfPointsBefore = mergedSurfaces[0]->GetNumberOfPoints();
+  if (rule->ConvertInSinglePass(overlappingLabelmaps, overlappingSurfaces)
+    || mergedSurfaces[0]->GetNumberOfPoints() != numberOfPointsBefore)
+    {
+    std::cerr << __LINE__ << ": Overlapping labelmaps must not be converted in a single pass" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Segmentation uses single pass conversion and falls back to per-segment conversion
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToClosedSurfaceConversionRule>::New() );
+  for (int overlapping = 0; overlapping < 2; ++overlapping)
+    {
+    vtkNew<vtkSegmentation> segmentation;
+    segmentation->SetMasterRepresentationName(
+      vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName() );
+    for (int i = 0; i < numberOfLabelmaps - 1; ++i)
+      {
+      vtkNew<vtkSegment> segment;
+      segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(),
+        (overlapping && i == 1) ? overlappingLabelmap.GetPointer() : labelmaps[i].GetPointer());
+      segmentation->AddSegment(segment.GetPointer());
+      }
+    int numberOfRepresentationModifiedEvents = 0;
+    vtkNew<vtkCallbackCommand> countEventsCommand;
+    countEventsCommand->SetClientData(&numberOfRepresentationModifiedEvents);
+    countEventsCommand->SetCallback(CountEventsCallback);
+    segmentation->AddObserver(vtkSegmentation::RepresentationModified, countEventsCommand.GetPointer());
+    if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()))
+      {
+      std::cerr << __LINE__ << ": Conversion to closed surface failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (numberOfRepresentationModifiedEvents != numberOfLabelmaps - 1)
+      {
+      std::cerr << __LINE__ << ": Unexpected number of RepresentationModified events: "
+        << numberOfRepresentationModifiedEvents << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::vector<std::string> segmentIds;
+    segmentation->GetSegmentIDs(segmentIds);
+    for (int i = 0; i < numberOfLabelmaps - 1; ++i)
+      {
+      vtkPolyData* surface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentIds[i])->GetRepresentation(
+        vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()));
+      vtkNew<vtkPolyData> segmentSurface;
+      rule->Convert((overlapping && i == 1) ? overlappingLabelmap.GetPointer() : labelmaps[i].GetPointer(),
+        segmentSurface.GetPointer());
+      if (!surface || !CompareSurfaces(segmentSurface.GetPointer(), surface, false, __LINE__))
+        {
+        std::cerr << __LINE__ << ": Unexpected closed surface of segment " << i << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  std::cout << "Binary labelmap to closed surface conversion test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationHistory.h"
+
+// STD includes
+#include <cstring>
+
+namespace
+{
+
+const int DIMENSION = 64;
+
+//----------------------------------------------------------------------------
+vtkOrientedImageData* GetLabelmap(vtkSegmentation* segmentation, const std::string& segmentId)
+{
+  vtkSegment* segment = segmentation->GetSegment(segmentId);
+  if (!segment)
+    {
+    return NULL;
+    }
+  return vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(
+    vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+}
+
+//----------------------------------------------------------------------------
+std::string AddLabelmapSegment(vtkSegmentation* segmentation, const char* name)
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, DIMENSION - 1, 0, DIMENSION - 1, 0, DIMENSION - 1);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  memset(labelmap->GetScalarPointer(), 0, DIMENSION * DIMENSION * DIMENSION);
+  vtkNew<vtkSegment> segment;
+  segment->SetName(name);
+  segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(),
+    labelmap.GetPointer());
+  std::string segmentId = segmentation->GenerateUniqueSegmentID(name);
+  segmentation->AddSegment(segment.GetPointer(), segmentId);
+  return segmentId;
+}
+
+//----------------------------------------------------------------------------
+// Paint a square of the given value into slice k
+void PaintSlice(vtkOrientedImageData* labelmap, int k, unsigned char value)
+{
+  for (int j = 10; j < 30; ++j)
+    {
+    for (int i = 10; i < 30; ++i)
+      {
+      *static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) = value;
+      }
+    }
+  labelmap->Modified();
+}
+
+//----------------------------------------------------------------------------
+int CountVoxels(vtkOrientedImageData* labelmap)
+{
+  int count = 0;
+  unsigned char* voxels = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+  for (int i = 0; i < DIMENSION * DIMENSION * DIMENSION; ++i)
+    {
+    count += (voxels[i] != 0 ? 1 : 0);
+    }
+  return count;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(
+    vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
+  std::string segmentId1 = AddLabelmapSegment(segmentation.GetPointer(), "segment1");
+  std::string segmentId2 = AddLabelmapSegment(segmentation.GetPointer(), "segment2");
+  PaintSlice(GetLabelmap(segmentation.GetPointer(), segmentId2), 5, 1);
+
+  vtkNew<vtkSegmentationHistory> history;
+  history->SetMaximumNumberOfStates(10);
+  history->SetSegmentation(segmentation.GetPointer());
+
+  // Paint one slice of the first segment in each step.
+  // State is saved before each modification, as in the segment editor.
+  const int numberOfSteps = 5;
+  for (int step = 0; step < numberOfSteps; ++step)
+    {
+    if (!history->SaveState())
+      {
+      std::cerr << __LINE__ << ": Failed to save state" << std::endl;
+      return EXIT_FAILURE;
+      }
+    PaintSlice(GetLabelmap(segmentation.GetPointer(), segmentId1), 20 + step, 1);
+    }
+  if (history->GetNumberOfStates() != numberOfSteps)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of states: " << history->GetNumberOfStates() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Unchanged slices are shared between states, so the history must be much
+  // smaller than a single uncompressed copy of the labelmaps.
+  unsigned long labelmapSize = DIMENSION * DIMENSION * DIMENSION / 1024;
+  unsigned long memorySize = history->GetMemorySize();
+  std::cout << "History memory size: " << memorySize << " kB, labelmap size: " << labelmapSize << " kB" << std::endl;
+  if (memorySize == 0 || memorySize >= labelmapSize)
+    {
+    std::cerr << __LINE__ << ": Unexpected history memory size: " << memorySize << " kB" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Undo
+  vtkOrientedImageData* labelmap1 = GetLabelmap(segmentation.GetPointer(), segmentId1);
+  int paintedSliceVoxels = 20 * 20;
+  if (CountVoxels(labelmap1) != numberOfSteps * paintedSliceVoxels)
+    {
+    std::cerr << __LINE__ << ": Unexpected labelmap content" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int step = numberOfSteps - 1; step >= 0; --step)
+    {
+    if (!history->IsRestorePreviousStateAvailable() || !history->RestorePreviousState())
+      {
+      std::cerr << __LINE__ << ": Failed to restore previous state" << std::endl;
+      return EXIT_FAILURE;
+      }
+    labelmap1 = GetLabelmap(segmentation.GetPointer(), segmentId1);
+    if (!labelmap1 || CountVoxels(labelmap1) != step * paintedSliceVoxels)
+      {
+      std::cerr << __LINE__ << ": Unexpected labelmap content after undo" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (CountVoxels(GetLabelmap(segmentation.GetPointer(), segmentId2)) != paintedSliceVoxels)
+    {
+    std::cerr << __LINE__ << ": Unexpected content of unchanged segment after undo" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Redo
+  for (int step = 1; step <= numberOfSteps; ++step)
+    {
+    if (!history->IsRestoreNextStateAvailable() || !history->RestoreNextState())
+      {
+      std::cerr << __LINE__ << ": Failed to restore next state" << std::endl;
+      return EXIT_FAILURE;
+      }
+    labelmap1 = GetLabelmap(segmentation.GetPointer(), segmentId1);
+    if (CountVoxels(labelmap1) != step * paintedSliceVoxels)
+      {
+      std::cerr << __LINE__ << ": Unexpected labelmap content after redo" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (*static_cast<unsigned char*>(labelmap1->GetScalarPointer(15, 15, 20)) != 1
+    || *static_cast<unsigned char*>(labelmap1->GetScalarPointer(15, 15, 19)) != 0)
+    {
+    std::cerr << __LINE__ << ": Unexpected voxel value after redo" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Removed segment is restored by undo
+  history->SaveState();
+  segmentation->RemoveSegment(segmentId2);
+  history->RestorePreviousState();
+  if (!GetLabelmap(segmentation.GetPointer(), segmentId2)
+    || CountVoxels(GetLabelmap(segmentation.GetPointer(), segmentId2)) != paintedSliceVoxels)
+    {
+    std::cerr << __LINE__ << ": Failed to restore removed segment" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Memory budget removes oldest states but keeps the last two
+  for (int step = 0; step < numberOfSteps; ++step)
+    {
+    history->SaveState();
+    PaintSlice(GetLabelmap(segmentation.GetPointer(), segmentId1), 40 + step, 2);
+    }
+  history->SetMaximumMemorySize(1);
+  if (history->GetNumberOfStates() != 2)
+    {
+    std::cerr << __LINE__ << ": Memory budget not applied, number of states: " << history->GetNumberOfStates() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!history->RestorePreviousState() || history->IsRestorePreviousStateAvailable())
+    {
+    std::cerr << __LINE__ << ": Unexpected undo availability after applying memory budget" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  history->RemoveAllStates();
+  if (history->GetNumberOfStates() != 0 || history->GetMemorySize() != 0)
+    {
+    std::cerr << __LINE__ << ": Failed to remove all states" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Segmentation history test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
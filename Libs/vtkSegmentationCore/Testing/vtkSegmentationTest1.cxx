@@ -25,6 +25,7 @@
 #include <vtkSphereSource.h>
 #include <vtkMatrix4x4.h>
 #include <vtkImageAccumulate.h>
+#include <vtkCallbackCommand.h>
 
 // SegmentationCore includes
 #include "vtkSegmentation.h"
@@ -37,6 +38,7 @@
 
 void CreateSpherePolyData(vtkPolyData* polyData);
 void CreateCubeLabelmap(vtkOrientedImageData* imageData);
+void CountEventsCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
 
 //----------------------------------------------------------------------------
 int vtkSegmentationTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
@@ -283,10 +285,77 @@ int vtkSegmentationTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  //////////////////////////////////////////////////////////////////////////
+  // Convert segments in parallel
+
+  vtkNew<vtkSegmentation> parallelSegmentation;
+  parallelSegmentation->SetMasterRepresentationName(
+    vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName() );
+  parallelSegmentation->SetNumberOfConversionThreads(4);
+  if (parallelSegmentation->GetNumberOfConversionThreads() != 4)
+    {
+    std::cerr << __LINE__ << ": Failed to set number of conversion threads!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int numberOfParallelSegments = 8;
+  for (int segmentIndex = 0; segmentIndex < numberOfParallelSegments; ++segmentIndex)
+    {
+    vtkNew<vtkPolyData> parallelPolyData;
+    CreateSpherePolyData(parallelPolyData.GetPointer());
+    vtkNew<vtkSegment> parallelSegment;
+    parallelSegment->AddRepresentation(
+      vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), parallelPolyData.GetPointer());
+    parallelSegmentation->AddSegment(parallelSegment.GetPointer());
+    }
+  int numberOfRepresentationModifiedEvents = 0;
+  vtkNew<vtkCallbackCommand> countEventsCommand;
+  countEventsCommand->SetClientData(&numberOfRepresentationModifiedEvents);
+  countEventsCommand->SetCallback(CountEventsCallback);
+  parallelSegmentation->AddObserver(vtkSegmentation::RepresentationModified, countEventsCommand.GetPointer());
+  if (!parallelSegmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()))
+    {
+    std::cerr << __LINE__ << ": Parallel conversion to binary labelmap failed!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (numberOfRepresentationModifiedEvents != numberOfParallelSegments)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of RepresentationModified events after parallel conversion: "
+      << numberOfRepresentationModifiedEvents << std::endl;
+    return EXIT_FAILURE;
+    }
+  // All segments must use the default geometry computed for the first segment
+  std::vector<std::string> parallelSegmentIds;
+  parallelSegmentation->GetSegmentIDs(parallelSegmentIds);
+  for (std::vector<std::string>::iterator segmentIdIt = parallelSegmentIds.begin(); segmentIdIt != parallelSegmentIds.end(); ++segmentIdIt)
+    {
+    vtkOrientedImageData* parallelImageData = vtkOrientedImageData::SafeDownCast(parallelSegmentation->GetSegment(*segmentIdIt)->GetRepresentation(
+      vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()) );
+    if (!parallelImageData || vtkSegmentationConverter::SerializeImageGeometry(parallelImageData).compare(defaultGeometryString))
+      {
+      std::cerr << __LINE__ << ": Unexpected binary labelmap after parallel conversion of segment " << *segmentIdIt << std::endl;
+      return EXIT_FAILURE;
+      }
+    imageAccumulate->SetInputData(parallelImageData);
+    imageAccumulate->Update();
+    if (imageAccumulate->GetMax()[0] != 1)
+      {
+      std::cerr << __LINE__ << ": Binary labelmap converted in parallel has no foreground voxels!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   std::cout << "Segmentation test passed." << std::endl;
   return EXIT_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void CountEventsCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  int* numberOfEvents = reinterpret_cast<int*>(clientData);
+  (*numberOfEvents)++;
+}
+
 //----------------------------------------------------------------------------
 void CreateSpherePolyData(vtkPolyData* polyData)
 {
@@ -22,15 +22,23 @@
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 
 #include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
 
 // VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
 #include <vtkDecimatePro.h>
 #include <vtkDiscreteMarchingCubes.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageConstantPad.h>
 #include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkTransform.h>
@@ -38,9 +46,132 @@
 #include <vtkVersion.h>
 #include <vtkWindowedSincPolyDataFilter.h>
 
+// STD includes
+#include <algorithm>
+#include <map>
+
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToClosedSurfaceConversionRule);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Surface of one label: triangles are stored as point ids of the marching cubes output
+struct LabelSurfaceJob
+{
+  std::vector<vtkIdType> TrianglePointIds;
+  vtkPolyData* ClosedSurface;
+};
+
+//----------------------------------------------------------------------------
+/// Shared state of the threads processing the label surfaces
+struct LabelSurfaceProcessingInfo
+{
+  vtkPoints* Points;
+  vtkMatrix4x4* ImageToWorldMatrix;
+  double DecimationFactor;
+  double SmoothingFactor;
+  bool ComputeSurfaceNormals;
+  std::vector<LabelSurfaceJob> Jobs;
+  vtkSimpleMutexLock Lock;
+  size_t NextJob;
+};
+
+//----------------------------------------------------------------------------
+/// Extract the triangles of each label into a separate poly data and post-process it.
+VTK_THREAD_RETURN_TYPE ProcessLabelSurfacesThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  LabelSurfaceProcessingInfo* info = static_cast<LabelSurfaceProcessingInfo*>(threadInfo->UserData);
+
+  // Marching cubes point id -> label surface point id. Entries are reset after each label.
+  std::vector<vtkIdType> pointMap(info->Points->GetNumberOfPoints(), -1);
+  while (true)
+    {
+    info->Lock.Lock();
+    size_t jobIndex = info->NextJob++;
+    info->Lock.Unlock();
+    if (jobIndex >= info->Jobs.size())
+      {
+      break;
+      }
+    LabelSurfaceJob& job = info->Jobs[jobIndex];
+    if (job.TrianglePointIds.empty())
+      {
+      job.ClosedSurface->Reset();
+      continue;
+      }
+
+    vtkNew<vtkPoints> points;
+    points->SetDataType(info->Points->GetDataType());
+    vtkNew<vtkCellArray> polys;
+    polys->Allocate(polys->EstimateSize(static_cast<vtkIdType>(job.TrianglePointIds.size() / 3), 3));
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (size_t pointIndex = 0; pointIndex + 2 < job.TrianglePointIds.size(); pointIndex += 3)
+      {
+      vtkIdType triangle[3] = { 0, 0, 0 };
+      for (int corner = 0; corner < 3; ++corner)
+        {
+        vtkIdType pointId = job.TrianglePointIds[pointIndex + corner];
+        if (pointMap[pointId] < 0)
+          {
+          info->Points->GetPoint(pointId, point);
+          pointMap[pointId] = points->InsertNextPoint(point);
+          }
+        triangle[corner] = pointMap[pointId];
+        }
+      polys->InsertNextCell(3, triangle);
+      }
+    for (std::vector<vtkIdType>::iterator pointIdIt = job.TrianglePointIds.begin();
+      pointIdIt != job.TrianglePointIds.end(); ++pointIdIt)
+      {
+      pointMap[*pointIdIt] = -1;
+      }
+
+    vtkNew<vtkPolyData> surface;
+    surface->SetPoints(points.GetPointer());
+    surface->SetPolys(polys.GetPointer());
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::PostProcessSurface(surface.GetPointer(), info->ImageToWorldMatrix,
+      info->DecimationFactor, info->SmoothingFactor, info->ComputeSurfaceNormals, job.ClosedSurface);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+/// Paint the voxels of a binary labelmap that are set to the fill value (maximum) into the merged labelmap.
+/// Sets overlap and stops if a voxel is already painted.
+template<class ImageScalarType>
+void MergeBinaryLabelmapGeneric(vtkImageData* binaryLabelmap, vtkImageData* mergedLabelmap, short labelValue, bool &overlap)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  binaryLabelmap->GetExtent(extent);
+  ImageScalarType fillValue = static_cast<ImageScalarType>(binaryLabelmap->GetScalarRange()[1]);
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      ImageScalarType* binaryPtr = static_cast<ImageScalarType*>(binaryLabelmap->GetScalarPointer(extent[0], j, k));
+      short* mergedPtr = static_cast<short*>(mergedLabelmap->GetScalarPointer(extent[0], j, k));
+      for (int i = extent[0]; i <= extent[1]; ++i, ++binaryPtr, ++mergedPtr)
+        {
+        if (*binaryPtr != fillValue)
+          {
+          continue;
+          }
+        if (*mergedPtr != 0)
+          {
+          overlap = true;
+          return;
+          }
+        *mergedPtr = labelValue;
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurfaceConversionRule()
 {
@@ -180,6 +311,19 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkDataObject* sour
     return true;
     }
 
+  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  orientedBinaryLabelMap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+  vtkBinaryLabelmapToClosedSurfaceConversionRule::PostProcessSurface(processingResult, labelmapImageToWorldMatrix,
+    decimationFactor, smoothingFactor, computeSurfaceNormals > 0, closedSurfacePolyData);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::PostProcessSurface(vtkPolyData* surface, vtkMatrix4x4* imageToWorldMatrix,
+  double decimationFactor, double smoothingFactor, bool computeSurfaceNormals, vtkPolyData* closedSurfacePolyData)
+{
+  vtkSmartPointer<vtkPolyData> processingResult = surface;
+
   // Decimate
   if (decimationFactor > 0.0)
     {
@@ -213,15 +357,13 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkDataObject* sour
 
   // Transform the result surface from labelmap IJK to world coordinate system
   vtkSmartPointer<vtkTransform> labelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  orientedBinaryLabelMap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
-  labelmapGeometryTransform->SetMatrix(labelmapImageToWorldMatrix);
+  labelmapGeometryTransform->SetMatrix(imageToWorldMatrix);
 
   vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
   transformPolyDataFilter->SetInputData(processingResult);
   transformPolyDataFilter->SetTransform(labelmapGeometryTransform);
 
-  if (computeSurfaceNormals>0)
+  if (computeSurfaceNormals)
     {
     vtkSmartPointer<vtkPolyDataNormals> polyDataNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
     polyDataNormals->SetInputConnection(transformPolyDataFilter->GetOutputPort());
@@ -237,7 +379,6 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkDataObject* sour
     transformPolyDataFilter->Update();
     closedSurfacePolyData->ShallowCopy(transformPolyDataFilter->GetOutput());
     }
-  return true;
 }
 
 //----------------------------------------------------------------------------
@@ -305,3 +446,266 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::IsLabelmapPaddingNecessary(
 
   return paddingNecessary;
 }
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::ConvertMergedLabelmap(vtkOrientedImageData* mergedLabelmap,
+  const std::vector<int>& labelValues, const std::vector<vtkPolyData*>& closedSurfaces, int numberOfThreads)
+{
+  if (!mergedLabelmap)
+    {
+    vtkErrorMacro("ConvertMergedLabelmap: Invalid input labelmap");
+    return false;
+    }
+  if (labelValues.size() != closedSurfaces.size())
+    {
+    vtkErrorMacro("ConvertMergedLabelmap: Number of label values (" << labelValues.size()
+      << ") and output surfaces (" << closedSurfaces.size() << ") do not match");
+    return false;
+    }
+  for (std::vector<vtkPolyData*>::const_iterator surfaceIt = closedSurfaces.begin(); surfaceIt != closedSurfaces.end(); ++surfaceIt)
+    {
+    if (!(*surfaceIt))
+      {
+      vtkErrorMacro("ConvertMergedLabelmap: Invalid output surface");
+      return false;
+      }
+    }
+  if (labelValues.empty())
+    {
+    return true;
+    }
+
+  int* mergedLabelmapExtent = mergedLabelmap->GetExtent();
+  if (mergedLabelmapExtent[0] > mergedLabelmapExtent[1]
+    || mergedLabelmapExtent[2] > mergedLabelmapExtent[3]
+    || mergedLabelmapExtent[4] > mergedLabelmapExtent[5])
+    {
+    vtkDebugMacro("ConvertMergedLabelmap: No polygons can be created, input image extent is empty");
+    for (std::vector<vtkPolyData*>::const_iterator surfaceIt = closedSurfaces.begin(); surfaceIt != closedSurfaces.end(); ++surfaceIt)
+      {
+      (*surfaceIt)->Reset();
+      }
+    return true;
+    }
+
+  // Pad once for all labels, see Convert
+  vtkSmartPointer<vtkImageData> labelmap = mergedLabelmap;
+  if (this->IsLabelmapPaddingNecessary(labelmap))
+    {
+    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
+    padder->SetInputData(labelmap);
+    int extent[6] = { 0, -1, 0, -1, 0, -1 };
+    labelmap->GetExtent(extent);
+    padder->SetOutputWholeExtent(extent[0] - 1, extent[1] + 1, extent[2] - 1, extent[3] + 1, extent[4] - 1, extent[5] + 1);
+    padder->Update();
+    labelmap = padder->GetOutput();
+    }
+  vtkSmartPointer<vtkImageData> labelmapWithIdentityGeometry = vtkSmartPointer<vtkImageData>::New();
+  labelmapWithIdentityGeometry->ShallowCopy(labelmap);
+  labelmapWithIdentityGeometry->SetOrigin(0, 0, 0);
+  labelmapWithIdentityGeometry->SetSpacing(1.0, 1.0, 1.0);
+
+  // Run marching cubes for all labels at once. Discrete marching cubes stores the label value
+  // of each triangle in the cell scalars.
+  vtkSmartPointer<vtkDiscreteMarchingCubes> marchingCubes = vtkSmartPointer<vtkDiscreteMarchingCubes>::New();
+  marchingCubes->SetInputData(labelmapWithIdentityGeometry);
+  std::map<int, std::vector<size_t> > labelToJobIndices;
+  int numberOfContourValues = 0;
+  for (size_t labelIndex = 0; labelIndex < labelValues.size(); ++labelIndex)
+    {
+    if (labelValues[labelIndex] == 0)
+      {
+      // background
+      continue;
+      }
+    if (labelToJobIndices.find(labelValues[labelIndex]) == labelToJobIndices.end())
+      {
+      marchingCubes->SetValue(numberOfContourValues++, labelValues[labelIndex]);
+      }
+    labelToJobIndices[labelValues[labelIndex]].push_back(labelIndex);
+    }
+  marchingCubes->ComputeGradientsOff();
+  marchingCubes->ComputeNormalsOff();
+  marchingCubes->ComputeScalarsOn();
+  if (numberOfContourValues > 0)
+    {
+    marchingCubes->Update();
+    }
+
+  LabelSurfaceProcessingInfo info;
+  info.Jobs.resize(labelValues.size());
+  for (size_t labelIndex = 0; labelIndex < labelValues.size(); ++labelIndex)
+    {
+    info.Jobs[labelIndex].ClosedSurface = closedSurfaces[labelIndex];
+    }
+
+  // Sort triangles by label
+  vtkPolyData* marchingCubesOutput = marchingCubes->GetOutput();
+  vtkDataArray* triangleLabels = marchingCubesOutput->GetCellData()->GetScalars();
+  if (numberOfContourValues > 0 && marchingCubesOutput->GetNumberOfPolys() > 0 && triangleLabels)
+    {
+    vtkCellArray* polys = marchingCubesOutput->GetPolys();
+    vtkIdType npts = 0;
+    vtkIdType* pts = NULL;
+    vtkIdType cellId = 0;
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts); ++cellId)
+      {
+      std::map<int, std::vector<size_t> >::iterator labelIt =
+        labelToJobIndices.find(static_cast<int>(triangleLabels->GetTuple1(cellId)));
+      if (labelIt == labelToJobIndices.end() || npts != 3)
+        {
+        continue;
+        }
+      std::vector<vtkIdType>& trianglePointIds = info.Jobs[labelIt->second[0]].TrianglePointIds;
+      trianglePointIds.insert(trianglePointIds.end(), pts, pts + 3);
+      }
+    // Labels listed more than once get the same surface
+    for (std::map<int, std::vector<size_t> >::iterator labelIt = labelToJobIndices.begin(); labelIt != labelToJobIndices.end(); ++labelIt)
+      {
+      for (size_t i = 1; i < labelIt->second.size(); ++i)
+        {
+        info.Jobs[labelIt->second[i]].TrianglePointIds = info.Jobs[labelIt->second[0]].TrianglePointIds;
+        }
+      }
+    }
+
+  vtkNew<vtkPoints> emptyPoints;
+  info.Points = marchingCubesOutput->GetPoints() ? marchingCubesOutput->GetPoints() : emptyPoints.GetPointer();
+  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  mergedLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+  info.ImageToWorldMatrix = labelmapImageToWorldMatrix;
+  info.DecimationFactor = vtkVariant(this->ConversionParameters[GetDecimationFactorParameterName()].first).ToDouble();
+  info.SmoothingFactor = vtkVariant(this->ConversionParameters[GetSmoothingFactorParameterName()].first).ToDouble();
+  info.ComputeSurfaceNormals = vtkVariant(this->ConversionParameters[GetComputeSurfaceNormalsParameterName()].first).ToInt() > 0;
+  info.NextJob = 0;
+
+  // Post-process the surfaces in parallel
+  if (numberOfThreads <= 0)
+    {
+    numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  numberOfThreads = std::min(numberOfThreads, static_cast<int>(info.Jobs.size()));
+  if (numberOfThreads <= 1)
+    {
+    vtkMultiThreader::ThreadInfo threadInfo;
+    threadInfo.ThreadID = 0;
+    threadInfo.NumberOfThreads = 1;
+    threadInfo.UserData = &info;
+    ProcessLabelSurfacesThreadFunction(&threadInfo);
+    }
+  else
+    {
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(ProcessLabelSurfacesThreadFunction, &info);
+    threader->SingleMethodExecute();
+    }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::ConvertInSinglePass(const std::vector<vtkOrientedImageData*>& binaryLabelmaps,
+  const std::vector<vtkPolyData*>& closedSurfaces, int numberOfThreads)
+{
+  if (binaryLabelmaps.size() != closedSurfaces.size())
+    {
+    vtkErrorMacro("ConvertInSinglePass: Number of labelmaps (" << binaryLabelmaps.size()
+      << ") and output surfaces (" << closedSurfaces.size() << ") do not match");
+    return false;
+    }
+
+  // Collect non-empty labelmaps and compute the extent that contains all of them
+  std::vector<size_t> nonEmptyIndices;
+  vtkOrientedImageData* referenceLabelmap = NULL;
+  int mergedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (size_t labelmapIndex = 0; labelmapIndex < binaryLabelmaps.size(); ++labelmapIndex)
+    {
+    vtkOrientedImageData* binaryLabelmap = binaryLabelmaps[labelmapIndex];
+    if (!binaryLabelmap || !closedSurfaces[labelmapIndex])
+      {
+      vtkErrorMacro("ConvertInSinglePass: Invalid input labelmap or output surface");
+      return false;
+      }
+    int* extent = binaryLabelmap->GetExtent();
+    if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5]
+      || !binaryLabelmap->GetPointData()->GetScalars() || binaryLabelmap->GetScalarRange()[1] == 0.0)
+      {
+      continue;
+      }
+    if (!referenceLabelmap)
+      {
+      referenceLabelmap = binaryLabelmap;
+      std::copy(extent, extent + 6, mergedExtent);
+      }
+    else
+      {
+      if (!vtkOrientedImageDataResample::DoGeometriesMatch(referenceLabelmap, binaryLabelmap))
+        {
+        vtkDebugMacro("ConvertInSinglePass: Labelmap geometries do not match, labelmaps cannot be merged");
+        return false;
+        }
+      for (int i = 0; i < 3; ++i)
+        {
+        mergedExtent[2 * i] = std::min(mergedExtent[2 * i], extent[2 * i]);
+        mergedExtent[2 * i + 1] = std::max(mergedExtent[2 * i + 1], extent[2 * i + 1]);
+        }
+      }
+    nonEmptyIndices.push_back(labelmapIndex);
+    }
+  if (nonEmptyIndices.size() > VTK_SHORT_MAX)
+    {
+    vtkDebugMacro("ConvertInSinglePass: Too many labelmaps to merge");
+    return false;
+    }
+
+  // Paint each labelmap into the merged labelmap with a distinct label
+  std::vector<int> labelValues;
+  std::vector<vtkPolyData*> nonEmptyClosedSurfaces;
+  vtkSmartPointer<vtkOrientedImageData> mergedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  if (referenceLabelmap)
+    {
+    vtkSmartPointer<vtkMatrix4x4> imageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    referenceLabelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+    mergedLabelmap->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix);
+    mergedLabelmap->SetExtent(mergedExtent);
+    mergedLabelmap->AllocateScalars(VTK_SHORT, 1);
+    vtkOrientedImageDataResample::FillImage(mergedLabelmap, 0);
+    }
+  for (size_t i = 0; i < nonEmptyIndices.size(); ++i)
+    {
+    vtkOrientedImageData* binaryLabelmap = binaryLabelmaps[nonEmptyIndices[i]];
+    short labelValue = static_cast<short>(i + 1);
+    bool overlap = false;
+    switch (binaryLabelmap->GetScalarType())
+      {
+      vtkTemplateMacro(MergeBinaryLabelmapGeneric<VTK_TT>(binaryLabelmap, mergedLabelmap, labelValue, overlap));
+      default:
+        vtkErrorMacro("ConvertInSinglePass: Unknown image scalar type!");
+        return false;
+      }
+    if (overlap)
+      {
+      vtkDebugMacro("ConvertInSinglePass: Labelmaps overlap, they cannot be merged");
+      return false;
+      }
+    labelValues.push_back(labelValue);
+    nonEmptyClosedSurfaces.push_back(closedSurfaces[nonEmptyIndices[i]]);
+    }
+
+  // Labelmaps can be merged, outputs can be modified now
+  for (size_t labelmapIndex = 0, nonEmptyIndex = 0; labelmapIndex < binaryLabelmaps.size(); ++labelmapIndex)
+    {
+    if (nonEmptyIndex < nonEmptyIndices.size() && nonEmptyIndices[nonEmptyIndex] == labelmapIndex)
+      {
+      ++nonEmptyIndex;
+      continue;
+      }
+    closedSurfaces[labelmapIndex]->Reset();
+    }
+  if (labelValues.empty())
+    {
+    return true;
+    }
+  return this->ConvertMergedLabelmap(mergedLabelmap, labelValues, nonEmptyClosedSurfaces, numberOfThreads);
+}
@@ -27,6 +27,13 @@
 
 #include "vtkSegmentationCoreConfigure.h"
 
+// STD includes
+#include <vector>
+
+class vtkMatrix4x4;
+class vtkOrientedImageData;
+class vtkPolyData;
+
 /// \ingroup SegmentationCore
 /// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
 ///   closed surface representation (vtkPolyData type). The conversion algorithm
@@ -61,6 +68,32 @@ public:
   /// Update the target representation based on the source representation
   virtual bool Convert(vtkDataObject* sourceRepresentation, vtkDataObject* targetRepresentation) VTK_OVERRIDE;
 
+  /// Create a closed surface for each label of a labelmap that contains several labels
+  /// (such as the merged labelmap generated for exporting segments).
+  /// Surfaces of all labels are extracted in a single pass over the voxels, then each surface is
+  /// decimated, smoothed and transformed to the world coordinate system in parallel, using the
+  /// current conversion parameters. Results are the same as converting a binary labelmap
+  /// of each label using \sa Convert.
+  /// \param mergedLabelmap Labelmap containing the labels
+  /// \param labelValues Voxel value of each label. Zero is background.
+  /// \param closedSurfaces Output surface of each label. Must have as many items as labelValues.
+  ///   The surfaces are modified from worker threads, they must not be observed.
+  /// \param numberOfThreads Number of threads for processing the surfaces. 0 = vtkMultiThreader global default.
+  bool ConvertMergedLabelmap(vtkOrientedImageData* mergedLabelmap, const std::vector<int>& labelValues,
+    const std::vector<vtkPolyData*>& closedSurfaces, int numberOfThreads = 0);
+
+  /// Convert the binary labelmaps of several segments with \sa ConvertMergedLabelmap.
+  /// Labelmaps must have the same geometry (except extent) and must not overlap.
+  /// Return false without modifying the surfaces if the labelmaps cannot be merged.
+  bool ConvertInSinglePass(const std::vector<vtkOrientedImageData*>& binaryLabelmaps,
+    const std::vector<vtkPolyData*>& closedSurfaces, int numberOfThreads = 0);
+
+  /// Decimate, smooth, transform to world coordinate system and compute normals of a surface
+  /// generated by marching cubes in the IJK coordinate system of the labelmap.
+  /// Only uses local filters so that it can be called from several threads at once.
+  static void PostProcessSurface(vtkPolyData* surface, vtkMatrix4x4* imageToWorldMatrix,
+    double decimationFactor, double smoothingFactor, bool computeSurfaceNormals, vtkPolyData* closedSurface);
+
   /// Get the cost of the conversion.
   virtual unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=NULL, vtkDataObject* targetRepresentation=NULL) VTK_OVERRIDE;
 
@@ -20,6 +20,7 @@
 
 // SegmentationCore includes
 #include "vtkSegmentation.h"
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 
 #include "vtkSegmentationConverterRule.h"
 #include "vtkSegmentationConverterFactory.h"
@@ -35,6 +36,9 @@
 #include <vtkMath.h>
 #include <vtkVersion.h>
 #include <vtkCallbackCommand.h>
+#include <vtkConditionVariable.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkStringArray.h>
 #include <vtkAbstractTransform.h>
 #include <vtkMatrix4x4.h>
@@ -61,6 +65,188 @@ public:
     }
 };
 
+//----------------------------------------------------------------------------
+typedef std::vector<vtkSmartPointer<vtkSegmentationConverterRule> > ConverterRuleListType;
+typedef std::vector<std::pair<std::string, vtkSmartPointer<vtkDataObject> > > RepresentationListType;
+
+//----------------------------------------------------------------------------
+/// Conversion of one segment. Converted representations are collected in
+/// Representations and only added to the segment on the calling thread.
+struct SegmentConversionJob
+{
+  std::string SegmentId;
+  vtkSegment* Segment;
+  RepresentationListType Representations;
+  bool Success;
+};
+
+//----------------------------------------------------------------------------
+/// Shared state of worker threads and the calling thread during parallel conversion
+struct ParallelConversionInfo
+{
+  vtkSegmentation* Segmentation;
+  std::string TargetRepresentationName;
+  bool OverwriteExisting;
+  bool AlwaysInvokeRepresentationModified;
+
+  /// Each worker thread uses its own copy of the conversion rules
+  std::vector<ConverterRuleListType> WorkerRules;
+  std::vector<SegmentConversionJob> Jobs;
+
+  vtkNew<vtkMutexLock> Lock;
+  vtkNew<vtkConditionVariable> JobCompleted;
+  size_t NextJob;
+  std::deque<size_t> CompletedJobs;
+  int NumberOfFinishedWorkers;
+  bool Canceled;
+};
+
+//----------------------------------------------------------------------------
+vtkDataObject* FindRepresentation(vtkSegment* segment, RepresentationListType& representations, const std::string& name)
+{
+  for (RepresentationListType::iterator reprIt = representations.begin(); reprIt != representations.end(); ++reprIt)
+    {
+    if (reprIt->first == name)
+      {
+      return reprIt->second;
+      }
+    }
+  return segment->GetRepresentation(name);
+}
+
+//----------------------------------------------------------------------------
+/// Execute each conversion step of the path without modifying the segment.
+/// Same logic as vtkSegmentation::ConvertSegmentUsingPath, but target representations are always
+/// created as new objects, so that existing representations are not modified from a worker thread.
+bool ConvertSegmentRepresentations(SegmentConversionJob& job, ConverterRuleListType& rules, bool overwriteExisting)
+{
+  for (ConverterRuleListType::iterator ruleIt = rules.begin(); ruleIt != rules.end(); ++ruleIt)
+    {
+    vtkSegmentationConverterRule* currentConversionRule = *ruleIt;
+    vtkDataObject* sourceRepresentation = FindRepresentation(job.Segment, job.Representations,
+      currentConversionRule->GetSourceRepresentationName());
+    if (!sourceRepresentation)
+      {
+      return false;
+      }
+    std::string targetRepresentationName = currentConversionRule->GetTargetRepresentationName();
+    if (FindRepresentation(job.Segment, job.Representations, targetRepresentationName) && !overwriteExisting)
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkDataObject> targetRepresentation = vtkSmartPointer<vtkDataObject>::Take(
+      currentConversionRule->ConstructRepresentationObjectByRepresentation(targetRepresentationName) );
+    if (!targetRepresentation.GetPointer())
+      {
+      return false;
+      }
+    currentConversionRule->Convert(sourceRepresentation, targetRepresentation);
+
+    bool found = false;
+    for (RepresentationListType::iterator reprIt = job.Representations.begin(); reprIt != job.Representations.end(); ++reprIt)
+      {
+      if (reprIt->first == targetRepresentationName)
+        {
+        reprIt->second = targetRepresentation;
+        found = true;
+        }
+      }
+    if (!found)
+      {
+      job.Representations.push_back(std::make_pair(targetRepresentationName, targetRepresentation));
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Add converted representations to the segment and notify observers. Called on the calling thread.
+void ApplyConvertedRepresentations(ParallelConversionInfo* info, SegmentConversionJob& job)
+{
+  bool targetRepresentationModified = false;
+  for (RepresentationListType::iterator reprIt = job.Representations.begin(); reprIt != job.Representations.end(); ++reprIt)
+    {
+    // Keep existing representation objects, as they may be observed
+    vtkDataObject* existingRepresentation = job.Segment->GetRepresentation(reprIt->first);
+    if (existingRepresentation && !strcmp(existingRepresentation->GetClassName(), reprIt->second->GetClassName()))
+      {
+      existingRepresentation->ShallowCopy(reprIt->second);
+      }
+    else
+      {
+      job.Segment->AddRepresentation(reprIt->first, reprIt->second);
+      }
+    if (reprIt->first == info->TargetRepresentationName)
+      {
+      targetRepresentationModified = true;
+      }
+    }
+  job.Representations.clear();
+  if (targetRepresentationModified || info->AlwaysInvokeRepresentationModified)
+    {
+    const char* segmentId = job.SegmentId.c_str();
+    info->Segmentation->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentId);
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Thread 0 is the calling thread, it applies the results of completed jobs.
+/// All other threads convert segments.
+VTK_THREAD_RETURN_TYPE ConvertSegmentsThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ParallelConversionInfo* info = static_cast<ParallelConversionInfo*>(threadInfo->UserData);
+  int numberOfWorkers = static_cast<int>(info->WorkerRules.size());
+
+  info->Lock->Lock();
+  if (threadInfo->ThreadID == 0)
+    {
+    while (true)
+      {
+      while (info->CompletedJobs.empty() && info->NumberOfFinishedWorkers < numberOfWorkers)
+        {
+        info->JobCompleted->Wait(info->Lock.GetPointer());
+        }
+      if (info->CompletedJobs.empty())
+        {
+        // all workers are finished
+        break;
+        }
+      size_t jobIndex = info->CompletedJobs.front();
+      info->CompletedJobs.pop_front();
+      info->Lock->Unlock();
+      if (info->Jobs[jobIndex].Success)
+        {
+        ApplyConvertedRepresentations(info, info->Jobs[jobIndex]);
+        }
+      info->Lock->Lock();
+      }
+    }
+  else if (threadInfo->ThreadID <= numberOfWorkers)
+    {
+    ConverterRuleListType& rules = info->WorkerRules[threadInfo->ThreadID - 1];
+    while (!info->Canceled && info->NextJob < info->Jobs.size())
+      {
+      size_t jobIndex = info->NextJob++;
+      info->Lock->Unlock();
+      bool success = ConvertSegmentRepresentations(info->Jobs[jobIndex], rules, info->OverwriteExisting);
+      info->Lock->Lock();
+      info->Jobs[jobIndex].Success = success;
+      if (!success)
+        {
+        // stop conversion of remaining segments, as in sequential conversion
+        info->Canceled = true;
+        }
+      info->CompletedJobs.push_back(jobIndex);
+      info->JobCompleted->Signal();
+      }
+    info->NumberOfFinishedWorkers++;
+    info->JobCompleted->Signal();
+    }
+  info->Lock->Unlock();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //----------------------------------------------------------------------------
 vtkSegmentation::vtkSegmentation()
 {
@@ -77,6 +263,9 @@ vtkSegmentation::vtkSegmentation()
 
   this->MasterRepresentationModifiedEnabled = true;
 
+  this->NumberOfConversionThreads = 1;
+  this->SetNumberOfConversionThreads(vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+
   this->SegmentIdAutogeneratorIndex = 0;
 }
 
@@ -143,6 +332,7 @@ void vtkSegmentation::DeepCopy(vtkSegmentation* aSegmentation)
 
   // Copy conversion parameters
   this->Converter->DeepCopy(aSegmentation->Converter);
+  this->SetNumberOfConversionThreads(aSegmentation->NumberOfConversionThreads);
 
   // Deep copy segments list
   for (std::deque< std::string >::iterator segmentIdIt = aSegmentation->SegmentIds.begin(); segmentIdIt != aSegmentation->SegmentIds.end(); ++segmentIdIt)
@@ -178,6 +368,7 @@ void vtkSegmentation::PrintSelf(ostream& os, vtkIndent indent)
     vtkSegment* segment = this->Segments[*segmentIdIt];
     segment->PrintSelf(os, indent.GetNextIndent());
     }
+  os << indent << "NumberOfConversionThreads:  " << this->NumberOfConversionThreads << "\n";
   os << indent << "Segment converter:\n";
   this->Converter->PrintSelf(os, indent.GetNextIndent());
 }
@@ -968,6 +1159,166 @@ bool vtkSegmentation::ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentati
   return true;
 }
 
+//---------------------------------------------------------------------------
+bool vtkSegmentation::ConvertSegmentsUsingPath(vtkSegmentationConverter::ConversionPathType path,
+  const std::string& targetRepresentationName, bool overwriteExisting, bool alwaysInvokeRepresentationModified)
+{
+  // Labelmap to closed surface conversion of several segments is done in a single marching cubes pass
+  // if the labelmaps can be merged. Otherwise segments are converted one by one.
+  vtkBinaryLabelmapToClosedSurfaceConversionRule* labelmapToSurfaceRule = (path.size() == 1 ?
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::SafeDownCast(path.front()) : NULL);
+  if (labelmapToSurfaceRule)
+    {
+    std::vector<std::string> segmentIds;
+    std::vector<vtkOrientedImageData*> binaryLabelmaps;
+    std::vector<vtkPolyData*> existingClosedSurfaces;
+    // The surfaces are converted on worker threads into new objects, the existing
+    // representations are only modified on the calling thread.
+    std::vector<vtkPolyData*> closedSurfaces;
+    std::vector<vtkSmartPointer<vtkPolyData> > newClosedSurfaces;
+    for (SegmentMap::iterator segmentIt = this->Segments.begin(); segmentIt != this->Segments.end(); ++segmentIt)
+      {
+      vtkDataObject* targetRepresentation = segmentIt->second->GetRepresentation(labelmapToSurfaceRule->GetTargetRepresentationName());
+      if (targetRepresentation && !overwriteExisting)
+        {
+        continue;
+        }
+      vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+        segmentIt->second->GetRepresentation(labelmapToSurfaceRule->GetSourceRepresentationName()));
+      vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(targetRepresentation);
+      if (!binaryLabelmap || (targetRepresentation && !closedSurface))
+        {
+        // let the regular conversion report the error
+        segmentIds.clear();
+        break;
+        }
+      segmentIds.push_back(segmentIt->first);
+      binaryLabelmaps.push_back(binaryLabelmap);
+      existingClosedSurfaces.push_back(closedSurface);
+      newClosedSurfaces.push_back(vtkSmartPointer<vtkPolyData>::New());
+      closedSurfaces.push_back(newClosedSurfaces.back());
+      }
+    if (segmentIds.size() > 1
+      && labelmapToSurfaceRule->ConvertInSinglePass(binaryLabelmaps, closedSurfaces, this->NumberOfConversionThreads))
+      {
+      for (size_t segmentIndex = 0; segmentIndex < segmentIds.size(); ++segmentIndex)
+        {
+        // Keep existing representation objects, as they may be observed
+        if (existingClosedSurfaces[segmentIndex])
+          {
+          existingClosedSurfaces[segmentIndex]->ShallowCopy(newClosedSurfaces[segmentIndex]);
+          }
+        else
+          {
+          this->GetSegment(segmentIds[segmentIndex])->AddRepresentation(
+            labelmapToSurfaceRule->GetTargetRepresentationName(), newClosedSurfaces[segmentIndex]);
+          }
+        // representation has been modified
+        const char* segmentId = segmentIds[segmentIndex].c_str();
+        this->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentId);
+        }
+      return true;
+      }
+    }
+
+  int numberOfWorkers = std::min(this->NumberOfConversionThreads, static_cast<int>(this->Segments.size()) - 1);
+  int globalMaximumNumberOfThreads = vtkMultiThreader::GetGlobalMaximumNumberOfThreads();
+  if (globalMaximumNumberOfThreads > 0)
+    {
+    // one thread is used for applying the conversion results
+    numberOfWorkers = std::min(numberOfWorkers, globalMaximumNumberOfThreads - 1);
+    }
+  if (numberOfWorkers < 2)
+    {
+    numberOfWorkers = 0;
+    }
+
+  // The first segment is converted on the calling thread using the rules of the converter.
+  // Rules may store information in their conversion parameters during conversion (such as
+  // the default reference geometry) that must be the same for all segments, therefore
+  // copies of the rules for the worker threads are only made after the first conversion.
+  SegmentMap::iterator segmentIt = this->Segments.begin();
+  for (size_t segmentIndex = 0; segmentIt != this->Segments.end() && (numberOfWorkers == 0 || segmentIndex < 1);
+    ++segmentIt, ++segmentIndex)
+    {
+    vtkDataObject* representationBefore = segmentIt->second->GetRepresentation(targetRepresentationName);
+    vtkMTimeType representationBeforeMTime = (representationBefore ? representationBefore->GetMTime() : 0);
+    if (!this->ConvertSegmentUsingPath(segmentIt->second, path, overwriteExisting))
+      {
+      vtkErrorMacro("CreateRepresentation: Conversion failed");
+      return false;
+      }
+    vtkDataObject* representationAfter = segmentIt->second->GetRepresentation(targetRepresentationName);
+    if (alwaysInvokeRepresentationModified || representationBefore != representationAfter
+      || (representationAfter != NULL && representationBeforeMTime != representationAfter->GetMTime()) )
+      {
+      // representation has been modified
+      const char* segmentId = segmentIt->first.c_str();
+      this->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentId);
+      }
+    }
+  if (segmentIt == this->Segments.end())
+    {
+    return true;
+    }
+
+  ParallelConversionInfo info;
+  info.Segmentation = this;
+  info.TargetRepresentationName = targetRepresentationName;
+  info.OverwriteExisting = overwriteExisting;
+  info.AlwaysInvokeRepresentationModified = alwaysInvokeRepresentationModified;
+  info.NextJob = 0;
+  info.NumberOfFinishedWorkers = 0;
+  info.Canceled = false;
+  for (; segmentIt != this->Segments.end(); ++segmentIt)
+    {
+    SegmentConversionJob job;
+    job.SegmentId = segmentIt->first;
+    job.Segment = segmentIt->second;
+    job.Success = false;
+    info.Jobs.push_back(job);
+    }
+  numberOfWorkers = std::min(numberOfWorkers, static_cast<int>(info.Jobs.size()));
+  info.WorkerRules.resize(numberOfWorkers);
+  for (int workerIndex = 0; workerIndex < numberOfWorkers; ++workerIndex)
+    {
+    for (vtkSegmentationConverter::ConversionPathType::iterator ruleIt = path.begin(); ruleIt != path.end(); ++ruleIt)
+      {
+      if (!(*ruleIt))
+        {
+        vtkErrorMacro("ConvertSegmentsUsingPath: Invalid converter rule!");
+        return false;
+        }
+      info.WorkerRules[workerIndex].push_back(vtkSmartPointer<vtkSegmentationConverterRule>::Take((*ruleIt)->Clone()));
+      }
+    }
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(numberOfWorkers + 1);
+  threader->SetSingleMethod(ConvertSegmentsThreadFunction, &info);
+  threader->SingleMethodExecute();
+
+  if (info.Canceled)
+    {
+    vtkErrorMacro("CreateRepresentation: Conversion failed");
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentation::SetNumberOfConversionThreads(int numberOfThreads)
+{
+  // one thread is reserved for applying the conversion results
+  numberOfThreads = std::max(1, std::min(numberOfThreads, VTK_MAX_THREADS - 1));
+  if (numberOfThreads == this->NumberOfConversionThreads)
+    {
+    return;
+    }
+  this->NumberOfConversionThreads = numberOfThreads;
+  this->Modified();
+}
+
 //---------------------------------------------------------------------------
 bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentationName, bool alwaysConvert/*=false*/)
 {
@@ -1030,22 +1381,9 @@ bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentati
     }
 
   // Perform conversion on all segments (no overwrites)
-  for (SegmentMap::iterator segmentIt = this->Segments.begin(); segmentIt != this->Segments.end(); ++segmentIt)
+  if (!this->ConvertSegmentsUsingPath(cheapestPath, targetRepresentationName, alwaysConvert, false))
     {
-    vtkDataObject* representationBefore = segmentIt->second->GetRepresentation(targetRepresentationName);
-    if (!this->ConvertSegmentUsingPath(segmentIt->second, cheapestPath, alwaysConvert))
-      {
-      vtkErrorMacro("CreateRepresentation: Conversion failed");
-      return false;
-      }
-    vtkDataObject* representationAfter = segmentIt->second->GetRepresentation(targetRepresentationName);
-    if (representationBefore != representationAfter
-      || (representationBefore != NULL && representationAfter != NULL && representationBefore->GetMTime() != representationAfter->GetMTime()) )
-      {
-      // representation has been modified
-      const char* segmentId = segmentIt->first.c_str();
-      this->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentId);
-      }
+    return false;
     }
 
   this->InvokeEvent(vtkSegmentation::ContainedRepresentationNamesModified);
@@ -1070,15 +1408,10 @@ bool vtkSegmentation::CreateRepresentation(vtkSegmentationConverter::ConversionP
   this->Converter->SetConversionParameters(parameters);
 
   // Perform conversion on all segments (do overwrites)
-  for (SegmentMap::iterator segmentIt = this->Segments.begin(); segmentIt != this->Segments.end(); ++segmentIt)
+  std::string targetRepresentationName = path.back()->GetTargetRepresentationName();
+  if (!this->ConvertSegmentsUsingPath(path, targetRepresentationName, true, true))
     {
-    if (!this->ConvertSegmentUsingPath(segmentIt->second, path, true))
-      {
-      vtkErrorMacro("CreateRepresentation: Conversion failed");
-      return false;
-      }
-    const char* segmentId = segmentIt->first.c_str();
-    this->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentId);
+    return false;
     }
 
   this->InvokeEvent(vtkSegmentation::ContainedRepresentationNamesModified);
@@ -324,6 +324,16 @@ public:
   bool CreateRepresentation(vtkSegmentationConverter::ConversionPathType path,
                             vtkSegmentationConverterRule::ConversionParameterListType parameters);
 
+  /// Set number of threads used for converting segments in \sa CreateRepresentation.
+  /// Segments are independent from each other, therefore they are converted in parallel,
+  /// each thread using its own copy of the conversion rules. RepresentationModified events
+  /// are still invoked from the calling thread, as soon as conversion of a segment is completed.
+  /// If set to 1 then segments are converted one after the other.
+  /// By default it is set to vtkMultiThreader::GetGlobalDefaultNumberOfThreads().
+  void SetNumberOfConversionThreads(int numberOfThreads);
+  /// Get number of threads used for converting segments.
+  vtkGetMacro(NumberOfConversionThreads, int);
+
   /// Removes a representation from all segments if present
   void RemoveRepresentation(const std::string& representationName);
 
@@ -385,6 +395,15 @@ protected:
   /// \return Success flag
   bool ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConverter::ConversionPathType path, bool overwriteExisting=false);
 
+  /// Convert all segments along a specified path, using NumberOfConversionThreads threads.
+  /// RepresentationModified event is invoked for each segment when its conversion is completed.
+  /// \param targetRepresentationName Name of the representation that is created by the path
+  /// \param alwaysInvokeRepresentationModified If false then RepresentationModified is only invoked
+  ///   for segments whose target representation has changed
+  /// \return Success flag
+  bool ConvertSegmentsUsingPath(vtkSegmentationConverter::ConversionPathType path,
+    const std::string& targetRepresentationName, bool overwriteExisting, bool alwaysInvokeRepresentationModified);
+
   /// Converts a single segment to a representation.
   bool ConvertSingleSegment(std::string segmentId, std::string targetRepresentationName);
 
@@ -434,6 +453,9 @@ protected:
   /// Modified events of  master representations are observed
   bool MasterRepresentationModifiedEnabled;
 
+  /// Number of threads used for converting segments
+  int NumberOfConversionThreads;
+
   /// This number is incremented and used for generating the next
   /// segment ID.
   int SegmentIdAutogeneratorIndex;
@@ -20,23 +20,165 @@
 
 // SegmentationCore includes
 #include "vtkSegmentationHistory.h"
+#include "vtkSegmentationConverter.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
+#include "vtkOrientedImageData.h"
 
 // VTK includes
 #include <vtkNew.h>
+#include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
 #include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <cstring>
+#include <set>
+
+namespace
+{
+
+// First byte of a compressed slice block
+const unsigned char SLICE_ENCODING_RAW = 0;
+const unsigned char SLICE_ENCODING_RUN_LENGTH = 1;
+
+//----------------------------------------------------------------------------
+// Run-length encode a slice. Each run is stored as a run length (unsigned int)
+// followed by the value of a voxel (elementSize bytes). If run-length encoding
+// does not reduce the size then the raw voxel values are stored.
+// Returns NULL if all voxels of the slice are zero.
+vtkSmartPointer<vtkUnsignedCharArray> EncodeSlice(const unsigned char* data,
+  vtkIdType numberOfElements, int elementSize)
+{
+  std::vector<unsigned char> runs;
+  bool allZero = true;
+  const vtkIdType rawSize = numberOfElements * elementSize;
+  vtkIdType runStart = 0;
+  while (runStart < numberOfElements)
+    {
+    const unsigned char* value = data + runStart * elementSize;
+    vtkIdType runEnd = runStart + 1;
+    while (runEnd < numberOfElements && runEnd - runStart < static_cast<vtkIdType>(VTK_UNSIGNED_INT_MAX)
+      && memcmp(value, data + runEnd * elementSize, elementSize) == 0)
+      {
+      ++runEnd;
+      }
+    for (int i = 0; i < elementSize && allZero; ++i)
+      {
+      allZero = (value[i] == 0);
+      }
+    if (static_cast<vtkIdType>(runs.size()) < rawSize)
+      {
+      unsigned int runLength = static_cast<unsigned int>(runEnd - runStart);
+      const unsigned char* runLengthBytes = reinterpret_cast<const unsigned char*>(&runLength);
+      runs.insert(runs.end(), runLengthBytes, runLengthBytes + sizeof(unsigned int));
+      runs.insert(runs.end(), value, value + elementSize);
+      }
+    else if (!allZero)
+      {
+      // Run-length encoding is not worth it and the slice is not empty
+      break;
+      }
+    runStart = runEnd;
+    }
+
+  if (allZero)
+    {
+    return NULL;
+    }
+
+  vtkSmartPointer<vtkUnsignedCharArray> block = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  if (static_cast<vtkIdType>(runs.size()) < rawSize)
+    {
+    block->SetNumberOfValues(static_cast<vtkIdType>(runs.size()) + 1);
+    block->SetValue(0, SLICE_ENCODING_RUN_LENGTH);
+    memcpy(block->GetPointer(1), &runs[0], runs.size());
+    }
+  else
+    {
+    block->SetNumberOfValues(rawSize + 1);
+    block->SetValue(0, SLICE_ENCODING_RAW);
+    memcpy(block->GetPointer(1), data, rawSize);
+    }
+  return block;
+}
+
+//----------------------------------------------------------------------------
+void DecodeSlice(vtkUnsignedCharArray* block, unsigned char* data,
+  vtkIdType numberOfElements, int elementSize)
+{
+  const vtkIdType rawSize = numberOfElements * elementSize;
+  if (!block)
+    {
+    memset(data, 0, rawSize);
+    return;
+    }
+  const unsigned char* encoded = block->GetPointer(1);
+  if (block->GetValue(0) == SLICE_ENCODING_RAW)
+    {
+    memcpy(data, encoded, rawSize);
+    return;
+    }
+  const unsigned char* encodedEnd = block->GetPointer(0) + block->GetNumberOfValues();
+  unsigned char* dataEnd = data + rawSize;
+  while (encoded < encodedEnd && data < dataEnd)
+    {
+    unsigned int runLength = 0;
+    memcpy(&runLength, encoded, sizeof(unsigned int));
+    encoded += sizeof(unsigned int);
+    for (unsigned int i = 0; i < runLength && data < dataEnd; ++i)
+      {
+      memcpy(data, encoded, elementSize);
+      data += elementSize;
+      }
+    encoded += elementSize;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool IsSliceEqual(vtkUnsignedCharArray* block1, vtkUnsignedCharArray* block2)
+{
+  if (block1 == block2)
+    {
+    return true;
+    }
+  if (!block1 || !block2 || block1->GetNumberOfValues() != block2->GetNumberOfValues())
+    {
+    return false;
+    }
+  return memcmp(block1->GetPointer(0), block2->GetPointer(0), block1->GetNumberOfValues()) == 0;
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
 
+//----------------------------------------------------------------------------
+vtkSegmentationHistory::CompressedLabelmap::CompressedLabelmap()
+  : ScalarType(VTK_UNSIGNED_CHAR)
+  , NumberOfScalarComponents(1)
+{
+  for (int i = 0; i < 6; i += 2)
+    {
+    this->Extent[i] = 0;
+    this->Extent[i+1] = -1;
+    }
+  for (int i = 0; i < 16; ++i)
+    {
+    this->ImageToWorldMatrix[i] = (i % 5 == 0 ? 1.0 : 0.0);
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkSegmentationHistory::vtkSegmentationHistory()
 {
   this->Segmentation = NULL;
 
   this->MaximumNumberOfStates = 5;
+  this->MaximumMemorySize = 0;
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
@@ -95,6 +237,8 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "MaximumNumberOfStates: " << this->MaximumNumberOfStates << "\n";
+  os << indent << "MaximumMemorySize: " << this->MaximumMemorySize << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -115,6 +259,9 @@ bool vtkSegmentationHistory::SaveState()
   this->RemoveAllNextStates();
 
   SegmentationState newSegmentationState;
+  SyncedLabelmapsMap previousSyncedLabelmaps;
+  previousSyncedLabelmaps.swap(this->SyncedLabelmaps);
+  std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
 
   std::vector<std::string> segmentIDs;
   this->Segmentation->GetSegmentIDs(segmentIDs);
@@ -141,6 +288,37 @@ bool vtkSegmentationHistory::SaveState()
     vtkSmartPointer<vtkSegment> segmentClone = vtkSmartPointer<vtkSegment>::New();
     CopySegment(segmentClone, segment, baselineSegment);
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
+
+    // Binary labelmap is stored compressed, sharing unchanged slices with the baseline
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(labelmapRepresentationName));
+    if (labelmap == NULL)
+      {
+      continue;
+      }
+    CompressedLabelmap& compressedLabelmap = newSegmentationState.Labelmaps[*segmentIDIt];
+    const CompressedLabelmap* baselineLabelmap = NULL;
+    SyncedLabelmapsMap::iterator syncedIt = previousSyncedLabelmaps.find(*segmentIDIt);
+    if (syncedIt != previousSyncedLabelmaps.end())
+      {
+      baselineLabelmap = &(syncedIt->second.Compressed);
+      if (syncedIt->second.Labelmap == labelmap && syncedIt->second.MTime == labelmap->GetMTime())
+        {
+        // labelmap has not changed since it was last saved or restored
+        compressedLabelmap = syncedIt->second.Compressed;
+        this->SetSyncedLabelmap(*segmentIDIt, compressedLabelmap, labelmap);
+        continue;
+        }
+      }
+    else if (this->SegmentationStates.size() > 0)
+      {
+      LabelmapsMap::iterator baselineLabelmapIt = this->SegmentationStates.back().Labelmaps.find(*segmentIDIt);
+      if (baselineLabelmapIt != this->SegmentationStates.back().Labelmaps.end())
+        {
+        baselineLabelmap = &(baselineLabelmapIt->second);
+        }
+      }
+    vtkSegmentationHistory::CompressLabelmap(labelmap, baselineLabelmap, compressedLabelmap);
+    this->SetSyncedLabelmap(*segmentIDIt, compressedLabelmap, labelmap);
     }
   this->SegmentationStates.push_back(newSegmentationState);
 
@@ -165,6 +343,12 @@ void vtkSegmentationHistory::CopySegment(vtkSegment* destination, vtkSegment* so
     representationNameIt != representationNames.end(); ++representationNameIt)
     {
     vtkDataObject* sourceRepresentation = source->GetRepresentation(*representationNameIt);
+    if (*representationNameIt == vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()
+      && vtkOrientedImageData::SafeDownCast(sourceRepresentation))
+      {
+      // binary labelmap is stored in the state in compressed form
+      continue;
+      }
     vtkDataObject* baselineRepresentation = NULL;
     if (baseline)
       {
@@ -246,6 +430,7 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
   this->RestoreStateInProgress = true;
 
   SegmentationState restoredState = this->SegmentationStates[stateIndex];
+  std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
 
   std::set<std::string> segmentIDsToKeep;
   for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
@@ -253,17 +438,52 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
     {
     segmentIDsToKeep.insert(restoredSegmentsIt->first);
     vtkSegment* segment = this->Segmentation->GetSegment(restoredSegmentsIt->first);
+
+    // Reuse the current labelmap object so that only the changed slices have to be decoded
+    vtkSmartPointer<vtkOrientedImageData> labelmap;
+    LabelmapsMap::iterator restoredLabelmapIt = restoredState.Labelmaps.find(restoredSegmentsIt->first);
+    if (restoredLabelmapIt != restoredState.Labelmaps.end())
+      {
+      const CompressedLabelmap* currentLabelmap = NULL;
+      if (segment != NULL)
+        {
+        labelmap = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(labelmapRepresentationName));
+        currentLabelmap = this->GetSyncedLabelmap(restoredSegmentsIt->first, labelmap);
+        }
+      if (labelmap.GetPointer() == NULL)
+        {
+        labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+        }
+      vtkSegmentationHistory::DecompressLabelmap(restoredLabelmapIt->second, labelmap, currentLabelmap);
+      }
+
     if (segment != NULL)
       {
       segment->DeepCopy(restoredSegmentsIt->second);
+      if (labelmap.GetPointer())
+        {
+        segment->AddRepresentation(labelmapRepresentationName, labelmap);
+        }
       segment->Modified();
       }
     else
       {
       vtkSmartPointer<vtkSegment> newSegment = vtkSmartPointer<vtkSegment>::New();
       newSegment->DeepCopy(restoredSegmentsIt->second);
+      if (labelmap.GetPointer())
+        {
+        newSegment->AddRepresentation(labelmapRepresentationName, labelmap);
+        }
       this->Segmentation->AddSegment(newSegment);
       }
+    if (labelmap.GetPointer())
+      {
+      this->SetSyncedLabelmap(restoredSegmentsIt->first, restoredLabelmapIt->second, labelmap);
+      }
+    else
+      {
+      this->SyncedLabelmaps.erase(restoredSegmentsIt->first);
+      }
     }
 
   // Removed segments that were not in the restored state
@@ -277,6 +497,7 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
       continue;
       }
     this->Segmentation->RemoveSegment(*segmentIDIt);
+    this->SyncedLabelmaps.erase(*segmentIDIt);
     }
 
   this->Segmentation->ReorderSegments(restoredState.SegmentIds);
@@ -326,12 +547,23 @@ void vtkSegmentationHistory::RemoveAllNextStates()
 void vtkSegmentationHistory::RemoveAllObsoleteStates()
 {
   bool modified = false;
-  while ((this->SegmentationStates.size() > this->MaximumNumberOfStates) && (!this->SegmentationStates.empty()))
+  while (!this->SegmentationStates.empty())
     {
+    bool tooManyStates = (this->SegmentationStates.size() > this->MaximumNumberOfStates);
+    // Always keep the last two states so that the last change can be undone
+    bool tooMuchMemory = (this->MaximumMemorySize > 0 && this->SegmentationStates.size() > 2
+      && this->GetMemorySize() > this->MaximumMemorySize);
+    if (!tooManyStates && !tooMuchMemory)
+      {
+      break;
+      }
     this->SegmentationStates.pop_front();
-    this->LastRestoredState--;
+    if (this->LastRestoredState > 0)
+      {
+      this->LastRestoredState--;
+      }
     modified = true;
-   }
+    }
   if (modified)
     {
     this->Modified();
@@ -350,6 +582,192 @@ void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumber
   this->Modified();
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetMaximumMemorySize(unsigned long maximumMemorySize)
+{
+  if (maximumMemorySize == this->MaximumMemorySize)
+    {
+    return;
+    }
+  this->MaximumMemorySize = maximumMemorySize;
+  this->RemoveAllObsoleteStates();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkSegmentationHistory::GetMemorySize()
+{
+  // Count each shared object only once
+  std::set<vtkObject*> countedObjects;
+  vtkTypeUInt64 memorySizeInBytes = 0;
+  for (std::deque<SegmentationState>::iterator stateIt = this->SegmentationStates.begin();
+    stateIt != this->SegmentationStates.end(); ++stateIt)
+    {
+    for (LabelmapsMap::iterator labelmapIt = stateIt->Labelmaps.begin();
+      labelmapIt != stateIt->Labelmaps.end(); ++labelmapIt)
+      {
+      const std::vector<vtkSmartPointer<vtkUnsignedCharArray> >& slices = labelmapIt->second.Slices;
+      for (std::vector<vtkSmartPointer<vtkUnsignedCharArray> >::const_iterator sliceIt = slices.begin();
+        sliceIt != slices.end(); ++sliceIt)
+        {
+        if (sliceIt->GetPointer() && countedObjects.insert(sliceIt->GetPointer()).second)
+          {
+          memorySizeInBytes += (*sliceIt)->GetSize();
+          }
+        }
+      }
+    for (SegmentsMap::iterator segmentIt = stateIt->Segments.begin();
+      segmentIt != stateIt->Segments.end(); ++segmentIt)
+      {
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (std::vector<std::string>::iterator representationNameIt = representationNames.begin();
+        representationNameIt != representationNames.end(); ++representationNameIt)
+        {
+        vtkDataObject* representation = segmentIt->second->GetRepresentation(*representationNameIt);
+        if (representation && countedObjects.insert(representation).second)
+          {
+          memorySizeInBytes += static_cast<vtkTypeUInt64>(representation->GetActualMemorySize()) * 1024;
+          }
+        }
+      }
+    }
+  return static_cast<unsigned long>((memorySizeInBytes + 1023) / 1024);
+}
+
+//---------------------------------------------------------------------------
+unsigned int vtkSegmentationHistory::GetNumberOfStates()
+{
+  return static_cast<unsigned int>(this->SegmentationStates.size());
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::CompressLabelmap(vtkOrientedImageData* labelmap,
+  const CompressedLabelmap* baseline, CompressedLabelmap& compressed)
+{
+  labelmap->GetExtent(compressed.Extent);
+  compressed.ScalarType = labelmap->GetScalarType();
+  compressed.NumberOfScalarComponents = labelmap->GetNumberOfScalarComponents();
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  labelmap->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  for (int i = 0; i < 16; ++i)
+    {
+    compressed.ImageToWorldMatrix[i] = imageToWorldMatrix->GetElement(i / 4, i % 4);
+    }
+  compressed.Slices.clear();
+  if (labelmap->IsEmpty() || labelmap->GetPointData()->GetScalars() == NULL)
+    {
+    return;
+    }
+
+  const int* extent = compressed.Extent;
+  const vtkIdType numberOfElementsPerSlice = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1);
+  const int numberOfSlices = extent[5] - extent[4] + 1;
+  const int elementSize = labelmap->GetScalarSize() * compressed.NumberOfScalarComponents;
+  const unsigned char* data = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+
+  // Slices can only be shared with the baseline if voxels are laid out the same way
+  bool shareWithBaseline = (baseline != NULL && baseline->ScalarType == compressed.ScalarType
+    && baseline->NumberOfScalarComponents == compressed.NumberOfScalarComponents
+    && static_cast<int>(baseline->Slices.size()) == numberOfSlices);
+  for (int i = 0; i < 6 && shareWithBaseline; ++i)
+    {
+    shareWithBaseline = (baseline->Extent[i] == compressed.Extent[i]);
+    }
+
+  compressed.Slices.resize(numberOfSlices);
+  for (int sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+    {
+    vtkSmartPointer<vtkUnsignedCharArray> slice = EncodeSlice(
+      data + sliceIndex * numberOfElementsPerSlice * elementSize, numberOfElementsPerSlice, elementSize);
+    if (shareWithBaseline && IsSliceEqual(slice, baseline->Slices[sliceIndex]))
+      {
+      compressed.Slices[sliceIndex] = baseline->Slices[sliceIndex];
+      }
+    else
+      {
+      compressed.Slices[sliceIndex] = slice;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+int vtkSegmentationHistory::DecompressLabelmap(const CompressedLabelmap& compressed,
+  vtkOrientedImageData* labelmap, const CompressedLabelmap* currentCompressed)
+{
+  // Partial update is only possible if the voxels are laid out the same way
+  bool partialUpdate = (currentCompressed != NULL && currentCompressed->ScalarType == compressed.ScalarType
+    && currentCompressed->NumberOfScalarComponents == compressed.NumberOfScalarComponents
+    && currentCompressed->Slices.size() == compressed.Slices.size()
+    && !compressed.Slices.empty());
+  for (int i = 0; i < 6 && partialUpdate; ++i)
+    {
+    partialUpdate = (currentCompressed->Extent[i] == compressed.Extent[i]);
+    }
+
+  if (!partialUpdate)
+    {
+    labelmap->Initialize();
+    labelmap->SetExtent(const_cast<int*>(compressed.Extent));
+    if (!compressed.Slices.empty())
+      {
+      labelmap->AllocateScalars(compressed.ScalarType, compressed.NumberOfScalarComponents);
+      }
+    }
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  imageToWorldMatrix->DeepCopy(compressed.ImageToWorldMatrix);
+  labelmap->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+
+  int numberOfDecodedSlices = 0;
+  if (!compressed.Slices.empty())
+    {
+    const int* extent = compressed.Extent;
+    const vtkIdType numberOfElementsPerSlice = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1);
+    const int elementSize = labelmap->GetScalarSize() * compressed.NumberOfScalarComponents;
+    unsigned char* data = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+    for (size_t sliceIndex = 0; sliceIndex < compressed.Slices.size(); ++sliceIndex)
+      {
+      if (partialUpdate && currentCompressed->Slices[sliceIndex] == compressed.Slices[sliceIndex])
+        {
+        // slice content is already up-to-date
+        continue;
+        }
+      DecodeSlice(compressed.Slices[sliceIndex], data + sliceIndex * numberOfElementsPerSlice * elementSize,
+        numberOfElementsPerSlice, elementSize);
+      ++numberOfDecodedSlices;
+      }
+    }
+  labelmap->Modified();
+  return numberOfDecodedSlices;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetSyncedLabelmap(const std::string& segmentId,
+  const CompressedLabelmap& compressed, vtkOrientedImageData* labelmap)
+{
+  SyncedLabelmap& synced = this->SyncedLabelmaps[segmentId];
+  synced.Compressed = compressed;
+  synced.Labelmap = labelmap;
+  synced.MTime = labelmap->GetMTime();
+}
+
+//---------------------------------------------------------------------------
+const vtkSegmentationHistory::CompressedLabelmap* vtkSegmentationHistory::GetSyncedLabelmap(
+  const std::string& segmentId, vtkOrientedImageData* labelmap)
+{
+  if (labelmap == NULL)
+    {
+    return NULL;
+    }
+  SyncedLabelmapsMap::iterator syncedIt = this->SyncedLabelmaps.find(segmentId);
+  if (syncedIt == this->SyncedLabelmaps.end()
+    || syncedIt->second.Labelmap != labelmap || syncedIt->second.MTime != labelmap->GetMTime())
+    {
+    return NULL;
+    }
+  return &(syncedIt->second.Compressed);
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller),
   unsigned long vtkNotUsed(eid),
@@ -379,6 +797,7 @@ void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller
 void vtkSegmentationHistory::RemoveAllStates()
 {
   this->SegmentationStates.clear();
+  this->SyncedLabelmaps.clear();
   this->LastRestoredState = 0;
   this->Modified();
 }
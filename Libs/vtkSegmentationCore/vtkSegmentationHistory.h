@@ -33,10 +33,20 @@
 #include "vtkSegmentationCoreConfigure.h"
 
 class vtkCallbackCommand;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
+class vtkUnsignedCharArray;
 
 /// \ingroup SegmentationCore
+/// \brief Undo/redo history of a segmentation.
+///
+/// Binary labelmap representations are not deep-copied into each state.
+/// They are stored compressed, one run-length encoded block per slice, and
+/// blocks that did not change since the previous state are shared between
+/// states. Therefore a state only costs memory for the slices that have been
+/// modified. When a state is restored, only the slices that differ from
+/// the current content of the labelmap are decoded.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -82,6 +92,22 @@ public:
   /// Get the limit of how many states may be stored.
   vtkGetMacro(MaximumNumberOfStates, unsigned int);
 
+  /// Limits how much memory the stored states may use, in kibibytes
+  /// (same unit as vtkDataObject::GetActualMemorySize). 0 means no limit (default).
+  /// If the limit is exceeded then the oldest states are removed, but the two
+  /// most recent states are always kept so that the last change can be undone.
+  void SetMaximumMemorySize(unsigned long maximumMemorySize);
+
+  /// Get the limit of how much memory the stored states may use, in kibibytes.
+  vtkGetMacro(MaximumMemorySize, unsigned long);
+
+  /// Get memory used by the stored states, in kibibytes.
+  /// Data shared between states is only counted once.
+  unsigned long GetMemorySize();
+
+  /// Get number of stored states.
+  unsigned int GetNumberOfStates();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -103,21 +129,71 @@ protected:
 
   /// Deep copies source segment to destination segment. If the same representation is found in baseline
   /// with up-to-date timestamp then the representation is reused from baseline.
+  /// Binary labelmap representation is not copied, it is stored separately in compressed form.
   void CopySegment(vtkSegment* destination, vtkSegment* source, vtkSegment* baseline);
 
 protected:  /// Container type for segments. Maps segment IDs to segment objects
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
 
+  /// Binary labelmap stored as one compressed block per slice.
+  /// Blocks are immutable once created, therefore they can be shared between states.
+  struct CompressedLabelmap
+    {
+    CompressedLabelmap();
+    int Extent[6];
+    int ScalarType;
+    int NumberOfScalarComponents;
+    double ImageToWorldMatrix[16];
+    /// Compressed content of each slice. NULL if the slice only contains zeros.
+    std::vector<vtkSmartPointer<vtkUnsignedCharArray> > Slices;
+    };
+
+  /// Container type for compressed labelmaps. Maps segment IDs to labelmaps
+  typedef std::map<std::string, CompressedLabelmap> LabelmapsMap;
+
   struct SegmentationState
     {
     SegmentsMap Segments;
+    LabelmapsMap Labelmaps; // binary labelmap representation of segments
     std::vector<std::string> SegmentIds; // order of segments
     };
 
+  /// Compressed labelmap that the labelmap of a segment was identical to
+  /// when it was last saved or restored.
+  struct SyncedLabelmap
+    {
+    SyncedLabelmap() : Labelmap(NULL), MTime(0) {}
+    CompressedLabelmap Compressed;
+    vtkOrientedImageData* Labelmap; // only used for comparison, not dereferenced
+    vtkMTimeType MTime;
+    };
+  typedef std::map<std::string, SyncedLabelmap> SyncedLabelmapsMap;
+
+  /// Compresses the labelmap. Slices that are identical to the corresponding slice
+  /// in baseline are shared with the baseline.
+  static void CompressLabelmap(vtkOrientedImageData* labelmap,
+    const CompressedLabelmap* baseline, CompressedLabelmap& compressed);
+
+  /// Writes compressed labelmap into the labelmap image. If the labelmap is known to be
+  /// identical to currentCompressed then only slices that differ from it are decoded.
+  /// \return Number of decoded slices
+  static int DecompressLabelmap(const CompressedLabelmap& compressed,
+    vtkOrientedImageData* labelmap, const CompressedLabelmap* currentCompressed);
+
+  /// Update the synced labelmap of a segment after it was saved or restored.
+  void SetSyncedLabelmap(const std::string& segmentId,
+    const CompressedLabelmap& compressed, vtkOrientedImageData* labelmap);
+
+  /// Get the compressed labelmap that the current labelmap of the segment is identical to.
+  /// Returns NULL if the labelmap has been modified since it was last saved or restored.
+  const CompressedLabelmap* GetSyncedLabelmap(const std::string& segmentId, vtkOrientedImageData* labelmap);
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
   unsigned int MaximumNumberOfStates;
+  unsigned long MaximumMemorySize;
+  SyncedLabelmapsMap SyncedLabelmaps;
 
   // Index of the state in SegmentationStates that was restored last.
   // If index == size of states then it means that the segmentation has changed
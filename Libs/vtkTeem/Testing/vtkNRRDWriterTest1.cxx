@@ -0,0 +1,143 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkNRRDReader.h>
+#include <vtkNRRDWriter.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int writeAndReadBack(vtkImageData* image, const std::string& fileName,
+                     int numberOfThreads, bool compression)
+{
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  vtkNew<vtkNRRDWriter> writer;
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(image);
+  writer->SetIJKToRASMatrix(ijkToRAS.GetPointer());
+  writer->SetUseCompression(compression ? 1 : 0);
+  writer->SetNumberOfThreads(numberOfThreads);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  writer->Write();
+  timer->StopTimer();
+  if (writer->GetWriteError())
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << numberOfThreads << " thread(s), compression " << compression
+            << ": written in " << timer->GetElapsedTime() << "s" << std::endl;
+
+  vtkNew<vtkNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  timer->StartTimer();
+  reader->Update();
+  timer->StopTimer();
+  std::cout << "  read in " << timer->GetElapsedTime() << "s" << std::endl;
+
+  vtkImageData* readImage = reader->GetOutput();
+  int dimensions[3] = {0, 0, 0};
+  int readDimensions[3] = {0, 0, 0};
+  image->GetDimensions(dimensions);
+  readImage->GetDimensions(readDimensions);
+  if (readDimensions[0] != dimensions[0]
+      || readDimensions[1] != dimensions[1]
+      || readDimensions[2] != dimensions[2]
+      || readImage->GetNumberOfScalarComponents() != image->GetNumberOfScalarComponents()
+      || readImage->GetScalarType() != image->GetScalarType())
+    {
+    std::cerr << "Line " << __LINE__ << ": " << fileName
+              << " does not have the geometry of the written image" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  vtkDataArray* readScalars = readImage->GetPointData()->GetScalars();
+  size_t size = static_cast<size_t>(scalars->GetDataSize()) * scalars->GetDataTypeSize();
+  if (memcmp(scalars->GetVoidPointer(0), readScalars->GetVoidPointer(0), size) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << fileName
+              << " does not have the written voxels" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkNRRDWriterTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+
+  // Multi-component labelmap-like image, larger than a compression chunk
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(160, 150, 40);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+  unsigned char* ptr = static_cast<unsigned char*>(image->GetScalarPointer());
+  vtkIdType numberOfValues = image->GetPointData()->GetScalars()->GetDataSize();
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+    {
+    // runs of identical values with some noise, as in segmentations
+    ptr[i] = static_cast<unsigned char>(((i / 997) % 7) * ((i % 13) == 0 ? 3 : 1));
+    }
+
+  const int threads[] = {1, 2, 5};
+  for (int i = 0; i < 3; ++i)
+    {
+    std::string fileName = tempDir + "/vtkNRRDWriterTest1.nrrd";
+    if (writeAndReadBack(image.GetPointer(), fileName, threads[i], true) != EXIT_SUCCESS)
+      {
+      return EXIT_FAILURE;
+      }
+    vtksys::SystemTools::RemoveFile(fileName.c_str());
+    }
+  std::string rawFileName = tempDir + "/vtkNRRDWriterTest1_raw.nrrd";
+  if (writeAndReadBack(image.GetPointer(), rawFileName, 2, false) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile(rawFileName.c_str());
+
+  // Detached header: written by Teem with a single thread
+  std::string detachedFileName = tempDir + "/vtkNRRDWriterTest1.nhdr";
+  if (writeAndReadBack(image.GetPointer(), detachedFileName, 4, true) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -907,10 +907,65 @@ void vtkNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInforma
     return;
     }
 
+  vtkDataArray* array = NULL;
+  switch(this->PointDataType)
+    {
+    case vtkDataSetAttributes::SCALARS:
+      array = imageData->GetPointData()->GetScalars();
+      break;
+    case vtkDataSetAttributes::VECTORS:
+      array = imageData->GetPointData()->GetVectors();
+      break;
+    case vtkDataSetAttributes::NORMALS:
+      array = imageData->GetPointData()->GetNormals();
+      break;
+    case vtkDataSetAttributes::TENSORS:
+      array = imageData->GetPointData()->GetTensors();
+      break;
+    }
+  void *ptr = NULL;
+  if (array)
+    {
+    array->SetName("NRRDImage");
+    //get pointer
+    ptr = array->GetVoidPointer(0);
+    }
+  this->ComputeDataIncrements();
+
+  // When the data in the file has the same layout as the output array
+  // (the range axis, if any, is the fastest and no tensor conversion is
+  // needed), Teem decodes it straight into the output array: it reuses
+  // nrrd->data when it has the size of the data in the header (read by
+  // ExecuteInformation).
+  bool readIntoOutput = false;
+  if (ptr && this->nrrd->data == NULL && this->nrrd->dim > 0)
+    {
+    unsigned int headerRangeAxisIdx[NRRD_DIM_MAX] = { 0 };
+    unsigned int headerRangeAxisNum = nrrdRangeAxesGet(this->nrrd, headerRangeAxisIdx);
+    int kind = this->nrrd->axis[0].kind;
+    readIntoOutput = (headerRangeAxisNum == 0 || (headerRangeAxisNum == 1 && headerRangeAxisIdx[0] == 0))
+      && kind != nrrdKind3DMaskedSymMatrix && kind != nrrdKind3DSymMatrix
+      && nrrdElementSize(this->nrrd) * nrrdElementNumber(this->nrrd)
+        == static_cast<size_t>(array->GetDataSize()) * array->GetDataTypeSize();
+    }
+  NrrdIoState *nio = nrrdIoStateNew();
+  if (readIntoOutput)
+    {
+    this->nrrd->data = ptr;
+    // the output array owns the memory, Teem must not free it on error
+    nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataUponReadError, AIR_TRUE);
+    }
+
   // Read in the this->nrrd.  Yes, this means that the header is being read
   // twice: once by ExecuteInformation, and once here
-  if ( nrrdLoad(this->nrrd, this->GetFileName(), NULL) != 0 )
+  int loadError = nrrdLoad(this->nrrd, this->GetFileName(), nio);
+  nio = nrrdIoStateNix(nio);
+  if ( loadError != 0 )
     {
+    if (readIntoOutput)
+      {
+      this->nrrd->data = NULL;
+      }
     char *err =  biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Read: Error reading " << this->GetFileName() << ":\n" << err);
     return;
@@ -922,30 +977,6 @@ void vtkNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInforma
     return;
     }
 
-  void *ptr = NULL;
-  switch(this->PointDataType)
-    {
-    case vtkDataSetAttributes::SCALARS:
-      imageData->GetPointData()->GetScalars()->SetName("NRRDImage");
-      //get pointer
-      ptr = imageData->GetPointData()->GetScalars()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::VECTORS:
-      imageData->GetPointData()->GetVectors()->SetName("NRRDImage");
-      //get pointer
-      ptr = imageData->GetPointData()->GetVectors()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::NORMALS:
-      imageData->GetPointData()->GetNormals()->SetName("NRRDImage");
-      ptr = imageData->GetPointData()->GetNormals()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::TENSORS:
-      imageData->GetPointData()->GetTensors()->SetName("NRRDImage");
-      ptr = imageData->GetPointData()->GetTensors()->GetVoidPointer(0);
-      break;
-    }
-  this->ComputeDataIncrements();
-
   unsigned int rangeAxisIdx[NRRD_DIM_MAX] = { 0 };
   unsigned int rangeAxisNum = nrrdRangeAxesGet(this->nrrd, rangeAxisIdx);
   if (rangeAxisNum > 1)
@@ -1083,7 +1114,12 @@ void vtkNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInforma
     // be called here if it existed.
     }
 
-  if (ptr)
+  if (readIntoOutput)
+    {
+    // the data is already in the output array, which owns it
+    this->nrrd->data = NULL;
+    }
+  else if (ptr)
     {
     memcpy(ptr, this->nrrd->data, nrrdElementSize(this->nrrd)*nrrdElementNumber(this->nrrd));
     }
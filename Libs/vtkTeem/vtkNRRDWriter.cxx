@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <map>
+#include <vector>
 
 #include "vtkNRRDWriter.h"
 
@@ -7,13 +11,99 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
 
 class AttributeMapType: public std::map<std::string, std::string> {};
 class AxisInfoMapType : public std::map<unsigned int, std::string> {};
 
 vtkStandardNewMacro(vtkNRRDWriter);
 
+namespace
+{
+
+/// Size of the data chunks compressed by each thread. The deflate history
+/// restarts at each chunk, which costs a negligible compression ratio.
+const size_t CompressionChunkSize = 1 << 20;
+
+//----------------------------------------------------------------------------
+struct ParallelCompressionInfo
+{
+  const unsigned char* Data;
+  size_t DataSize;
+  int Level;
+  std::vector<std::vector<unsigned char> > CompressedChunks;
+  std::vector<uLong> ChunkChecksums;
+  // not a vector<bool>, whose elements can't be written concurrently
+  std::vector<char> ChunkFailed;
+  size_t NextChunk;
+  vtkSimpleMutexLock Lock;
+};
+
+//----------------------------------------------------------------------------
+/// Compress a chunk as raw deflate data. All the chunks but the last one end
+/// with a sync flush (an empty stored block ending on a byte boundary) instead
+/// of a final block, so that the compressed chunks can be concatenated into a
+/// single deflate stream.
+bool CompressChunk(const unsigned char* data, size_t size, int level, bool lastChunk,
+  std::vector<unsigned char>& compressed)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // negative window bits: no zlib header, the gzip header is written once
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+    return false;
+    }
+  // leave room for the sync flush marker
+  compressed.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = &compressed[0];
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  int status = deflate(&stream, lastChunk ? Z_FINISH : Z_SYNC_FLUSH);
+  bool success = (stream.avail_in == 0 && stream.avail_out > 0
+    && status == (lastChunk ? Z_STREAM_END : Z_OK));
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE CompressChunksThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ParallelCompressionInfo* info = static_cast<ParallelCompressionInfo*>(threadInfo->UserData);
+  size_t numberOfChunks = info->CompressedChunks.size();
+  while (true)
+    {
+    info->Lock.Lock();
+    if (info->NextChunk >= numberOfChunks)
+      {
+      info->Lock.Unlock();
+      break;
+      }
+    size_t chunk = info->NextChunk++;
+    info->Lock.Unlock();
+
+    size_t offset = chunk * CompressionChunkSize;
+    size_t size = std::min(CompressionChunkSize, info->DataSize - offset);
+    const unsigned char* chunkData = info->Data + offset;
+    info->ChunkChecksums[chunk] = crc32(crc32(0L, Z_NULL, 0), chunkData, static_cast<uInt>(size));
+    if (!CompressChunk(chunkData, size, info->Level, chunk == numberOfChunks - 1,
+      info->CompressedChunks[chunk]))
+      {
+      info->ChunkFailed[chunk] = 1;
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkNRRDWriter::vtkNRRDWriter()
 {
@@ -23,6 +113,7 @@ vtkNRRDWriter::vtkNRRDWriter()
   this->IJKToRASMatrix = vtkMatrix4x4::New();
   this->MeasurementFrameMatrix = vtkMatrix4x4::New();
   this->UseCompression = 1;
+  this->NumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
   this->DiffusionWeigthedData = 0;
   this->FileType = VTK_BINARY;
   this->WriteErrorOff();
@@ -373,8 +464,20 @@ void vtkNRRDWriter::WriteData()
   // set endianness as unknown of output
   nio->endian = airEndianUnknown;
 
-  // Write the nrrd to file.
-  if (nrrdSave(this->GetFileName(), nrrd, nio))
+  // Write the nrrd to file. Large compressed images are compressed in
+  // parallel, unless the header is detached or the file is not a NRRD.
+  size_t dataSize = nrrdElementSize(nrrd) * nrrdElementNumber(nrrd);
+  if (nio->encoding == nrrdEncodingGzip
+    && this->NumberOfThreads > 1
+    && dataSize > CompressionChunkSize
+    && airEndsWith(this->GetFileName(), NRRD_EXT_NRRD))
+    {
+    if (!this->WriteCompressedNRRD(nrrd, nio))
+      {
+      this->WriteErrorOn();
+      }
+    }
+  else if (nrrdSave(this->GetFileName(), nrrd, nio))
     {
     char *err = biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Write: Error writing "
@@ -387,10 +490,96 @@ void vtkNRRDWriter::WriteData()
   return;
 }
 
+//----------------------------------------------------------------------------
+bool vtkNRRDWriter::WriteCompressedNRRD(Nrrd* nrrd, NrrdIoState* nio)
+{
+  // Let Teem write the header of the gzip encoded data, without the data.
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, AIR_TRUE);
+  char* header = NULL;
+  if (nrrdStringWrite(&header, nrrd, nio))
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    vtkErrorMacro("Write: Error writing header of "
+                      << this->GetFileName() << ":\n" << err);
+    return false;
+    }
+  std::string headerString(header);
+  free(header);
+  // The header ends with an empty line, the data follows.
+  if (headerString.size() < 2 || headerString.compare(headerString.size() - 2, 2, "\n\n") != 0)
+    {
+    headerString += "\n";
+    }
+
+  ParallelCompressionInfo info;
+  info.Data = static_cast<const unsigned char*>(nrrd->data);
+  info.DataSize = nrrdElementSize(nrrd) * nrrdElementNumber(nrrd);
+  info.Level = nio->zlibLevel;
+  size_t numberOfChunks = (info.DataSize + CompressionChunkSize - 1) / CompressionChunkSize;
+  info.CompressedChunks.resize(numberOfChunks);
+  info.ChunkChecksums.resize(numberOfChunks, 0);
+  info.ChunkFailed.resize(numberOfChunks, 0);
+  info.NextChunk = 0;
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(static_cast<int>(
+    std::min(static_cast<size_t>(this->NumberOfThreads), numberOfChunks)));
+  threader->SetSingleMethod(CompressChunksThreadFunction, &info);
+  threader->SingleMethodExecute();
+
+  uLong checksum = crc32(0L, Z_NULL, 0);
+  for (size_t chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+    if (info.ChunkFailed[chunk])
+      {
+      vtkErrorMacro("Write: Error compressing data of " << this->GetFileName());
+      return false;
+      }
+    size_t chunkSize = std::min(CompressionChunkSize, info.DataSize - chunk * CompressionChunkSize);
+    checksum = crc32_combine(checksum, info.ChunkChecksums[chunk], static_cast<z_off_t>(chunkSize));
+    }
+
+  std::ofstream file(this->GetFileName(), ios::out | ios::binary);
+  if (!file)
+    {
+    vtkErrorMacro("Write: Cannot open " << this->GetFileName());
+    return false;
+    }
+  file.write(headerString.c_str(), headerString.size());
+  // gzip member header: magic number, deflate method, no flags, no
+  // modification time, no extra flags, unknown operating system
+  const unsigned char gzipHeader[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff };
+  file.write(reinterpret_cast<const char*>(gzipHeader), sizeof(gzipHeader));
+  for (size_t chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+    const std::vector<unsigned char>& compressed = info.CompressedChunks[chunk];
+    file.write(reinterpret_cast<const char*>(&compressed[0]), compressed.size());
+    }
+  // gzip member trailer: CRC-32 and size modulo 2^32 of the data, little endian
+  unsigned char gzipTrailer[8];
+  for (int i = 0; i < 4; ++i)
+    {
+    gzipTrailer[i] = static_cast<unsigned char>((checksum >> (8 * i)) & 0xff);
+    gzipTrailer[4 + i] = static_cast<unsigned char>((info.DataSize >> (8 * i)) & 0xff);
+    }
+  file.write(reinterpret_cast<const char*>(gzipTrailer), sizeof(gzipTrailer));
+  file.close();
+  if (file.fail())
+    {
+    vtkErrorMacro("Write: Error writing " << this->GetFileName());
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
 void vtkNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "UseCompression: " << this->UseCompression << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+
   os << indent << "RAS to IJK Matrix: ";
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
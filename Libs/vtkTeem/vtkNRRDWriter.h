@@ -55,6 +55,13 @@ public:
   vtkGetMacro(UseCompression,int);
   vtkBooleanMacro(UseCompression,int);
 
+  ///
+  /// Number of threads used to compress the data. Large images are split
+  /// into chunks that are compressed concurrently into a single gzip stream,
+  /// readable by any NRRD reader. (Default is the number of processors)
+  vtkSetClampMacro(NumberOfThreads,int,1,VTK_INT_MAX);
+  vtkGetMacro(NumberOfThreads,int);
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -100,6 +107,7 @@ protected:
   vtkMatrix4x4* MeasurementFrameMatrix;
 
   int UseCompression;
+  int NumberOfThreads;
   int FileType;
 
   AttributeMapType *Attributes;
@@ -111,6 +119,8 @@ private:
   void operator=(const vtkNRRDWriter&);  /// Not implemented.
   void vtkImageDataInfoToNrrdInfo(vtkImageData *in, int &nrrdKind, size_t &numComp, int &vtkType, void **buffer);
   int VTKToNrrdPixelType( const int vtkPixelType );
+  /// Write the header with Teem and compress the data with NumberOfThreads threads
+  bool WriteCompressedNRRD(Nrrd* nrrd, NrrdIoState* nio);
   int DiffusionWeigthedData;
 };
 
@@ -26,8 +26,178 @@
 #include "vtkStringArray.h"
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <sstream>
 
+/// Size of the buffer of the file stream when writing, number of characters
+#define MARKUPS_WRITE_BUFFER_SIZE 1048576
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Read the whole file in a buffer
+bool ReadFileContent(const std::string& fileName, std::vector<char>& content)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open())
+    {
+    return false;
+    }
+  file.seekg(0, std::ios::end);
+  std::streamoff size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  if (size < 0)
+    {
+    return false;
+    }
+  content.resize(static_cast<size_t>(size));
+  if (size > 0)
+    {
+    file.read(&content[0], size);
+    content.resize(static_cast<size_t>(file.gcount()));
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool StartsWith(const char* begin, const char* end, const char* prefix)
+{
+  size_t prefixLength = strlen(prefix);
+  return static_cast<size_t>(end - begin) >= prefixLength &&
+    strncmp(begin, prefix, prefixLength) == 0;
+}
+
+//----------------------------------------------------------------------------
+// Split a line of a markups file in fields without copying it
+class FieldTokenizer
+{
+public:
+  FieldTokenizer(const char* begin, const char* end, char separator)
+    : Position(begin), End(end), Separator(separator), AtEnd(false)
+  {
+  }
+
+  /// Get the next field, return false if there are no more fields
+  bool NextField(const char*& fieldBegin, const char*& fieldEnd)
+  {
+    if (this->AtEnd)
+      {
+      return false;
+      }
+    fieldBegin = this->Position;
+    fieldEnd = static_cast<const char*>(memchr(this->Position, this->Separator, this->End - this->Position));
+    if (!fieldEnd)
+      {
+      fieldEnd = this->End;
+      this->AtEnd = true;
+      }
+    this->Position = fieldEnd + 1;
+    return true;
+  }
+
+  /// Parse the next field as a number, return defaultValue if there is none
+  double NextDouble(double defaultValue)
+  {
+    char number[64];
+    if (!this->NextNumberField(number))
+      {
+      return defaultValue;
+      }
+    return atof(number);
+  }
+  int NextInt(int defaultValue)
+  {
+    char number[64];
+    if (!this->NextNumberField(number))
+      {
+      return defaultValue;
+      }
+    return atoi(number);
+  }
+
+  /// Get the next field as a string. A field starting with a double quote
+  /// ends at the next double quote followed by the separator, with the quotes
+  /// kept. Return true if the string has quotes to remove.
+  bool NextString(std::string& value)
+  {
+    if (this->AtEnd)
+      {
+      value.clear();
+      return false;
+      }
+    if (this->Position >= this->End || *this->Position != '"')
+      {
+      const char* fieldBegin;
+      const char* fieldEnd;
+      this->NextField(fieldBegin, fieldEnd);
+      value.assign(fieldBegin, fieldEnd);
+      return memchr(fieldBegin, '"', fieldEnd - fieldBegin) != NULL;
+      }
+    // look for the end quote, doubled quotes are part of the string
+    const char* fieldBegin = this->Position;
+    const char* fieldEnd = fieldBegin + 1;
+    while (fieldEnd < this->End)
+      {
+      if (*fieldEnd == '"')
+        {
+        if (fieldEnd + 1 < this->End && fieldEnd[1] == '"')
+          {
+          fieldEnd += 2;
+          continue;
+          }
+        ++fieldEnd;
+        break;
+        }
+      ++fieldEnd;
+      }
+    value.assign(fieldBegin, fieldEnd);
+    if (fieldEnd >= this->End)
+      {
+      this->AtEnd = true;
+      }
+    else
+      {
+      // skip anything up to the separator
+      const char* separator = static_cast<const char*>(memchr(fieldEnd, this->Separator, this->End - fieldEnd));
+      if (separator)
+        {
+        this->Position = separator + 1;
+        }
+      else
+        {
+        this->AtEnd = true;
+        }
+      }
+    return true;
+  }
+
+protected:
+  bool NextNumberField(char number[64])
+  {
+    const char* fieldBegin;
+    const char* fieldEnd;
+    if (!this->NextField(fieldBegin, fieldEnd) || fieldBegin == fieldEnd)
+      {
+      return false;
+      }
+    size_t length = std::min(static_cast<size_t>(fieldEnd - fieldBegin), static_cast<size_t>(63));
+    memcpy(number, fieldBegin, length);
+    number[length] = '\0';
+    return true;
+  }
+
+  const char* Position;
+  const char* End;
+  char Separator;
+  bool AtEnd;
+};
+
+} // end of anonymous namespace
+
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLMarkupsFiducialStorageNode);
 
@@ -125,336 +295,163 @@ int vtkMRMLMarkupsFiducialStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     parseAsAnnotationFiducial = true;
     }
 
-  // open the file for reading input
-  fstream fstr;
-
-  fstr.open(fullName.c_str(), fstream::in);
+  // read the whole file at once and parse it in place
+  std::vector<char> content;
+  if (!ReadFileContent(fullName, content))
+    {
+    vtkErrorMacro("ERROR opening markups file " << this->FileName << endl);
+    return 0;
+    }
 
-  if (fstr.is_open())
+  // the markups are added all at once when the file is parsed, other events
+  // are invoked at the end
+  int wasModifying = markupsNode->StartModify();
+  if (markupsNode->GetNumberOfMarkups() > 0)
     {
-    if (markupsNode->GetNumberOfMarkups() > 0)
-      {
-      // clear out the list
-      markupsNode->RemoveAllMarkups();
-      }
+    // clear out the list
+    markupsNode->RemoveAllMarkups();
+    }
 
-    char line[MARKUPS_BUFFER_SIZE];
+  const char* contentBegin = content.empty() ? NULL : &content[0];
+  const char* contentEnd = contentBegin + content.size();
 
-    // save the valid lines in a vector, parse them once know the max id
-    std::vector<std::string>lines;
-    int thisMarkupNumber = 0;
+  std::vector<Markup> markups;
+  markups.reserve(std::count(content.begin(), content.end(), '\n') + 1);
 
-    // check for the version
-    std::string version;
-    // only print out the warning once
-    bool printedVersionWarning = false;
+  // check for the version
+  std::string version;
+  // only print out the warning once
+  bool printedVersionWarning = false;
 
-    // coordinate system
-    int coordinateSystemFlag = 0;
+  const char versionPrefix[] = "# Markups fiducial file version = ";
+  const char coordinateSystemPrefix[] = "# CoordinateSystem = ";
 
-    while (fstr.good())
+  const char* lineBegin = contentBegin;
+  while (lineBegin < contentEnd)
+    {
+    const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', contentEnd - lineBegin));
+    const char* nextLine = lineEnd ? lineEnd + 1 : contentEnd;
+    if (!lineEnd)
       {
-      fstr.getline(line, MARKUPS_BUFFER_SIZE);
-
-      // does it start with a #?
-      if (line[0] == '#')
-        {
-        vtkDebugMacro("Comment line, checking:\n\"" << line << "\"");
+      lineEnd = contentEnd;
+      }
+    if (lineEnd > lineBegin && lineEnd[-1] == '\r')
+      {
+      --lineEnd;
+      }
 
-        // if there's a space after the hash, check for the version
-        if (line[1] == ' ')
-          {
-          vtkDebugMacro("Have a possible option in line " << line);
-          std::string lineString = std::string(line);
-          if (lineString.find("# Markups fiducial file version = ") != std::string::npos)
-            {
-            version = lineString.substr(34,std::string::npos);
-            vtkDebugMacro("Version = " << version);
-            }
-          else if (lineString.find("# CoordinateSystem = ") != std::string::npos)
-            {
-            std::string str = lineString.substr(21,std::string::npos);
-            coordinateSystemFlag = atoi(str.c_str());
-            vtkDebugMacro("CoordinateSystem = " << coordinateSystemFlag);
-            this->SetCoordinateSystem(coordinateSystemFlag);
-            }
-          else if (lineString.find("# columns = ") != std::string::npos)
-            {
-            // the markups header, fixed
-            }
-          }
-        }
-      else
+    // does it start with a #?
+    if (lineBegin[0] == '#')
+      {
+      // if there's a space after the hash, check for the version
+      if (lineEnd - lineBegin > 1 && lineBegin[1] == ' ')
         {
-        // is it empty?
-        if (line[0] == '\0')
+        if (StartsWith(lineBegin, lineEnd, versionPrefix))
           {
-          vtkDebugMacro("Empty line, skipping:\n\"" << line << "\"");
+          version.assign(lineBegin + sizeof(versionPrefix) - 1, lineEnd);
+          vtkDebugMacro("Version = " << version);
           }
-        else
+        else if (StartsWith(lineBegin, lineEnd, coordinateSystemPrefix))
           {
-          if (version.size() == 0)
-            {
-            std::string label = std::string("");
-            double x = 0.0, y = 0.0, z = 0.0;
-            int sel = 1, vis = 1;
-
-            markupsNode->AddMarkupWithNPoints(1);
-
-            std::stringstream ss(line);
-            std::string component;
-
-            if (parseAsAnnotationFiducial)
-              {
-              // annotation fiducial line format = point|x|y|z|sel|vis
-              // label
-              getline(ss, component, '|');
-              if (component.size())
-                {
-                vtkDebugMacro("Got point string = " << component.c_str());
-                // use the file name for the point label
-                std::string filenameName = vtksys::SystemTools::GetFilenameName(this->GetFileName());
-                label = vtksys::SystemTools::GetFilenameWithoutExtension(filenameName);
-                markupsNode->SetNthMarkupLabel(thisMarkupNumber,label);
-                }
-
-              // x,y,z
-              getline(ss, component, '|');
-              x = atof(component.c_str());
-              getline(ss, component, '|');
-              y = atof(component.c_str());
-              getline(ss, component, '|');
-              z = atof(component.c_str());
-              markupsNode->SetMarkupPoint(thisMarkupNumber,0,x,y,z);
-
-              // selected
-              getline(ss, component, '|');
-              sel = atoi(component.c_str());
-              markupsNode->SetNthMarkupSelected(thisMarkupNumber,sel);
-
-              // visibility
-              getline(ss, component, '|');
-              vtkDebugMacro("component = " << component.c_str());
-              vis = atoi(component.c_str());
-              markupsNode->SetNthMarkupVisibility(thisMarkupNumber,vis);
-              }
-            else
-              {
-              if (!printedVersionWarning)
-                {
-                vtkWarningMacro("Have an unversioned file, assuming Slicer 3 format .fcsv");
-                printedVersionWarning = true;
-                }
-              // point line format = label,x,y,z,sel,vis
-
-              // label
-              getline(ss, component, ',');
-              if (component.size())
-                {
-                vtkDebugMacro("Got label = " << component.c_str());
-                label = component;
-                markupsNode->SetNthMarkupLabel(thisMarkupNumber,label);
-                }
-
-              // x,y,z
-              getline(ss, component, ',');
-              x = atof(component.c_str());
-              getline(ss, component, ',');
-              y = atof(component.c_str());
-              getline(ss, component, ',');
-              z = atof(component.c_str());
-              markupsNode->SetMarkupPoint(thisMarkupNumber,0,x,y,z);
-
-              // selected
-              getline(ss, component, ',');
-              sel = atoi(component.c_str());
-              markupsNode->SetNthMarkupSelected(thisMarkupNumber,sel);
-
-              // visibility
-              getline(ss, component, ',');
-              vtkDebugMacro("component = " << component.c_str());
-              vis = atoi(component.c_str());
-              markupsNode->SetNthMarkupVisibility(thisMarkupNumber,vis);
-              }
-            thisMarkupNumber++;
-            }
-          else
-            {
-            // Slicer 4 markups fiducial file
-            vtkDebugMacro("\n\n\n\nVersion = " << version << ", got a line: \n\"" << line << "\"");
-            std::string id = std::string("");
-            double x = 0.0, y = 0.0, z = 0.0;
-            double ow = 0.0, ox = 0.0, oy = 0.0, oz = 1.0;
-            int sel = 1, vis = 1, lock = 0;
-            std::string associatedNodeID = std::string("");
-            std::string label = std::string("");
-            std::string desc = std::string("");
-
-            std::stringstream ss(line);
-            int numPoints = 1;
-            markupsNode->AddMarkupWithNPoints(numPoints);
-
-            std::string component;
-
-            // id
-            getline(ss, component, ',');
-            if (component.size())
-              {
-              vtkDebugMacro("Got id = " << component.c_str());
-              id = component;
-              markupsNode->SetNthMarkupID(thisMarkupNumber,id);
-              }
-            else
-              {
-              vtkDebugMacro("No ID");
-              if (this->GetScene())
-                {
-                markupsNode->SetNthMarkupID(thisMarkupNumber,this->GetScene()->GenerateUniqueName(this->GetID()));
-                }
-              }
-
-            // x,y,z
-            getline(ss, component, ',');
-            x = atof(component.c_str());
-            getline(ss, component, ',');
-            y = atof(component.c_str());
-            getline(ss, component, ',');
-            z = atof(component.c_str());
-            if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::RAS)
-              {
-              markupsNode->SetMarkupPoint(thisMarkupNumber,0,x,y,z);
-              }
-            else if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::LPS)
-              {
-              markupsNode->SetMarkupPointLPS(thisMarkupNumber,0,x,y,z);
-              }
-            else
-              {
-              // IJK not implemented yet, assume RAS
-              markupsNode->SetMarkupPoint(thisMarkupNumber,0,x,y,z);
-              }
-
-            // orientatation
-            getline(ss, component, ',');
-            ow = atof(component.c_str());
-            getline(ss, component, ',');
-            ox = atof(component.c_str());
-            getline(ss, component, ',');
-            oy = atof(component.c_str());
-            getline(ss, component, ',');
-            oz = atof(component.c_str());
-            markupsNode->SetNthMarkupOrientation(thisMarkupNumber, ow, ox, oy, oz);
-
-            // visibility
-            getline(ss, component, ',');
-            vtkDebugMacro("component = " << component.c_str());
-            vis = atoi(component.c_str());
-            markupsNode->SetNthMarkupVisibility(thisMarkupNumber,vis);
-
-            // selected
-            getline(ss, component, ',');
-            sel = atoi(component.c_str());
-            markupsNode->SetNthMarkupSelected(thisMarkupNumber,sel);
-
-            // locked
-            getline(ss, component, ',');
-            lock = atoi(component.c_str());
-            markupsNode->SetNthMarkupLocked(thisMarkupNumber,lock);
-
-            // label
-            // the label may have quotes around it, look for the end quote and comma
-            // std::cout << "Line ss = '" << ss.str().c_str() << "'" << std::endl;
-            std::string labelDescID;
-            getline(ss, labelDescID);
-            // if there's no quote at the start of the line, the label was
-            // checked to be sure that there are no commas in it, so extract
-            // to the next comma
-            size_t endCommaPos;
-            if (labelDescID[0] != '"')
-              {
-              endCommaPos = labelDescID.find(",");
-              component = labelDescID.substr(0, endCommaPos);
-              }
-            else
-              {
-              component = this->GetFirstQuotedString(labelDescID, &endCommaPos);
-              }
-            if (component.size())
-              {
-              vtkDebugMacro("Got label = " << component.c_str());
-              label = this->ConvertStringFromStorageFormat(component);
-              markupsNode->SetNthMarkupLabel(thisMarkupNumber, label);
-              }
-            else
-              {
-              vtkDebugMacro("No label");
-              markupsNode->SetNthMarkupLabel(thisMarkupNumber,"");
-              }
-
-            // description
-            // get the rest of the string after the label
-            std::string descID = labelDescID.substr(endCommaPos + 1);
-            // the description may have quotes around it as well
-            if (descID[0] != '"')
-              {
-              endCommaPos = descID.find(",");
-              component = descID.substr(0, endCommaPos);
-              }
-            else
-              {
-              component = this->GetFirstQuotedString(descID, &endCommaPos);
-              }
-            if (component.size())
-              {
-              vtkDebugMacro("Got desc = " << component.c_str());
-              desc = this->ConvertStringFromStorageFormat(component);
-              markupsNode->SetNthMarkupDescription(thisMarkupNumber, desc);
-              }
-            else
-              {
-              vtkDebugMacro("No description");
-              markupsNode->SetNthMarkupDescription(thisMarkupNumber,"");
-              }
-
-            // in case the file was written by hand, the associated node id
-            // might be empty
-            size_t associatedNodeIDPos = ss.str().find_last_of(',');
-            if (associatedNodeIDPos != std::string::npos)
-              {
-              component = ss.str().substr(associatedNodeIDPos + 1);
-              if (component.size())
-                {
-                vtkDebugMacro("Got associated node id = " << component.c_str());
-                associatedNodeID = component;
-                markupsNode->SetNthMarkupAssociatedNodeID(thisMarkupNumber,associatedNodeID);
-                }
-              else
-                {
-                vtkDebugMacro("no associated node id");
-                markupsNode->SetNthMarkupAssociatedNodeID(thisMarkupNumber,"");
-                }
-              }
-            else
-              {
-                  markupsNode->SetNthMarkupAssociatedNodeID(thisMarkupNumber,"");
-              }
-
-            thisMarkupNumber++;
-            vtkDebugMacro("Line parsed, got id = " << id << ", vis = " << vis << ", sel = " << sel
-                          << ", associatedNodeID = " << associatedNodeID.c_str()
-                          << ", label = '" << label.c_str() << "', markup number is now " << thisMarkupNumber);
-            } // point line
+          std::string str(lineBegin + sizeof(coordinateSystemPrefix) - 1, lineEnd);
+          int coordinateSystemFlag = atoi(str.c_str());
+          vtkDebugMacro("CoordinateSystem = " << coordinateSystemFlag);
+          this->SetCoordinateSystem(coordinateSystemFlag);
           }
+        // "# columns = " is the markups header, fixed
         }
       }
-    fstr.close();
-    }
-  else
-    {
-    vtkErrorMacro("ERROR opening markups file " << this->FileName << endl);
-    return 0;
+    else if (lineEnd == lineBegin)
+      {
+      vtkDebugMacro("Empty line, skipping");
+      }
+    else if (version.size() == 0)
+      {
+      // legacy files are small, add the markups one by one
+      if (!printedVersionWarning && !parseAsAnnotationFiducial)
+        {
+        vtkWarningMacro("Have an unversioned file, assuming Slicer 3 format .fcsv");
+        printedVersionWarning = true;
+        }
+      // annotation fiducial line format = point|x|y|z|sel|vis
+      // Slicer 3 point line format = label,x,y,z,sel,vis
+      FieldTokenizer tokenizer(lineBegin, lineEnd, parseAsAnnotationFiducial ? '|' : ',');
+      std::string label;
+      tokenizer.NextString(label);
+      if (parseAsAnnotationFiducial && label.size())
+        {
+        // use the file name for the point label
+        std::string filenameName = vtksys::SystemTools::GetFilenameName(this->GetFileName());
+        label = vtksys::SystemTools::GetFilenameWithoutExtension(filenameName);
+        }
+      double x = tokenizer.NextDouble(0.0);
+      double y = tokenizer.NextDouble(0.0);
+      double z = tokenizer.NextDouble(0.0);
+      vtkVector3d point(x, y, z);
+      int markupIndex = markupsNode->AddMarkupWithNPoints(1, std::string(), &point);
+      if (label.size())
+        {
+        markupsNode->SetNthMarkupLabel(markupIndex, label);
+        }
+      markupsNode->SetNthMarkupSelected(markupIndex, tokenizer.NextInt(1));
+      markupsNode->SetNthMarkupVisibility(markupIndex, tokenizer.NextInt(1));
+      }
+    else
+      {
+      // Slicer 4 markups fiducial file
+      // id,x,y,z,ow,ox,oy,oz,vis,sel,lock,label,desc,associatedNodeID
+      FieldTokenizer tokenizer(lineBegin, lineEnd, ',');
+      markups.resize(markups.size() + 1);
+      Markup& markup = markups.back();
+
+      tokenizer.NextString(markup.ID);
+      if (markup.ID.empty() && this->GetScene())
+        {
+        markup.ID = this->GetScene()->GenerateUniqueName(this->GetID());
+        }
+      // otherwise the node generates a unique id
+
+      double x = tokenizer.NextDouble(0.0);
+      double y = tokenizer.NextDouble(0.0);
+      double z = tokenizer.NextDouble(0.0);
+      if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::LPS)
+        {
+        x = -x;
+        y = -y;
+        }
+      // IJK not implemented yet, assume RAS
+      markup.points.push_back(vtkVector3d(x, y, z));
+
+      // orientation
+      markup.OrientationWXYZ[0] = tokenizer.NextDouble(0.0);
+      markup.OrientationWXYZ[1] = tokenizer.NextDouble(0.0);
+      markup.OrientationWXYZ[2] = tokenizer.NextDouble(0.0);
+      markup.OrientationWXYZ[3] = tokenizer.NextDouble(1.0);
+
+      markup.Visibility = (tokenizer.NextInt(1) != 0);
+      markup.Selected = (tokenizer.NextInt(1) != 0);
+      markup.Locked = (tokenizer.NextInt(0) != 0);
+
+      // label and description may have quotes around them
+      if (tokenizer.NextString(markup.Label))
+        {
+        markup.Label = this->ConvertStringFromStorageFormat(markup.Label);
+        }
+      if (tokenizer.NextString(markup.Description))
+        {
+        markup.Description = this->ConvertStringFromStorageFormat(markup.Description);
+        }
+      // in case the file was written by hand, the associated node id
+      // might be empty
+      tokenizer.NextString(markup.AssociatedNodeID);
+      }
+
+    lineBegin = nextLine;
     }
 
+  markupsNode->AddMarkups(markups);
+  markupsNode->EndModify(wasModifying);
+
   return 1;
 }
 
@@ -482,8 +479,18 @@ int vtkMRMLMarkupsFiducialStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  // open the file for writing
+  if (this->GetCoordinateSystem() != vtkMRMLMarkupsFiducialStorageNode::RAS &&
+      this->GetCoordinateSystem() != vtkMRMLMarkupsFiducialStorageNode::LPS &&
+      this->GetCoordinateSystem() != vtkMRMLMarkupsFiducialStorageNode::IJK)
+    {
+    vtkErrorMacro("WriteData: invalid coordinate system index " << this->GetCoordinateSystem());
+    return 0;
+    }
+
+  // open the file for writing, with a large buffer as lines are short
+  std::vector<char> buffer(MARKUPS_WRITE_BUFFER_SIZE);
   fstream of;
+  of.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
 
   of.open(fullName.c_str(), fstream::out);
 
@@ -494,9 +501,13 @@ int vtkMRMLMarkupsFiducialStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     }
   int numberOfMarkups = markupsNode->GetNumberOfMarkups();
 
+  // the default precision of 6 significant digits truncates the coordinates
+  // of the markups far from the origin
+  of.precision(std::numeric_limits<double>::digits10);
+
   // put down a header
-  of << "# Markups fiducial file version = " << Slicer_VERSION << endl;
-  of << "# CoordinateSystem = " << this->GetCoordinateSystem() << endl;
+  of << "# Markups fiducial file version = " << Slicer_VERSION << "\n";
+  of << "# CoordinateSystem = " << this->GetCoordinateSystem() << "\n";
 
   // label the columns
   // id,x,y,z,ow,ox,oy,oz,vis,sel,lock,label,desc,associatedNodeID
@@ -505,58 +516,38 @@ int vtkMRMLMarkupsFiducialStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   // id,x,y,z,ow,ox,oy,oz,vis,sel,lock,,,
   // label can have spaces, everything up to next comma is used, no quotes
   // necessary, same with the description
-  of << "# columns = id,x,y,z,ow,ox,oy,oz,vis,sel,lock,label,desc,associatedNodeID" << endl;
+  of << "# columns = id,x,y,z,ow,ox,oy,oz,vis,sel,lock,label,desc,associatedNodeID\n";
   for (int i = 0; i < numberOfMarkups; i++)
     {
-    std::string id = markupsNode->GetNthMarkupID(i);
-    of << id.c_str();
-    vtkDebugMacro("WriteDataInternal: wrote id " << id.c_str());
+    // write the markup fields directly, without copies
+    Markup *markup = markupsNode->GetNthMarkup(i);
+    of << markup->ID;
 
-    int p = 0;
     double xyz[3] = { 0.0, 0.0, 0.0 };
-    if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::RAS)
-      {
-      markupsNode->GetMarkupPoint(i,p,xyz);
-      }
-    else if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::LPS)
-      {
-      markupsNode->GetMarkupPointLPS(i,p,xyz);
-      }
-    else if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::IJK)
+    if (!markup->points.empty())
       {
-      // not implemented yet, use RAS
-//      markupsNode->GetMarkupPointIJK(i,p,xyz);
-      markupsNode->GetMarkupPoint(i,p,xyz);
+      xyz[0] = markup->points[0].GetX();
+      xyz[1] = markup->points[0].GetY();
+      xyz[2] = markup->points[0].GetZ();
       }
-    else
+    if (this->GetCoordinateSystem() == vtkMRMLMarkupsFiducialStorageNode::LPS)
       {
-      vtkErrorMacro("WriteData: invalid coordinate system index " << this->GetCoordinateSystem());
-      return 0;
+      xyz[0] = -xyz[0];
+      xyz[1] = -xyz[1];
       }
-
+    // IJK not implemented yet, use RAS
     of << "," << xyz[0] << "," << xyz[1] << "," << xyz[2];
 
-    double orientation[4];
-    markupsNode->GetNthMarkupOrientation(i, orientation);
-    bool vis = markupsNode->GetNthMarkupVisibility(i);
-    bool sel = markupsNode->GetNthMarkupSelected(i);
-    bool lock = markupsNode->GetNthMarkupLocked(i);
-
-    std::string label = this->ConvertStringToStorageFormat(markupsNode->GetNthMarkupLabel(i));
-    std::string desc = this->ConvertStringToStorageFormat(markupsNode->GetNthMarkupDescription(i));
-
-    std::string associatedNodeID = markupsNode->GetNthMarkupAssociatedNodeID(i);
-    if (associatedNodeID.size() == 0)
-      {
-      associatedNodeID = std::string("");
-      }
+    const double* orientation = markup->OrientationWXYZ;
     of << "," << orientation[0] << "," << orientation[1] << "," << orientation[2] << "," << orientation[3];
-    of << "," << vis << "," << sel << "," << lock;
-    of << "," << label;
-    of << "," << desc;
-    of << "," << associatedNodeID;
-
-    of << endl;
+    of << "," << markup->Visibility << "," << markup->Selected << "," << markup->Locked;
+    of << ",";
+    this->WriteStringInStorageFormat(of, markup->Label);
+    of << ",";
+    this->WriteStringInStorageFormat(of, markup->Description);
+    of << "," << markup->AssociatedNodeID;
+
+    of << "\n";
     }
 
   of.close();
@@ -565,6 +556,20 @@ int vtkMRMLMarkupsFiducialStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialStorageNode::WriteStringInStorageFormat(ostream& of, const std::string& value)
+{
+  if (value.find_first_of(",\"") == std::string::npos)
+    {
+    // nothing to escape
+    of << value;
+    }
+  else
+    {
+    of << this->ConvertStringToStorageFormat(value);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLMarkupsFiducialStorageNode::InitializeSupportedReadFileTypes()
 {
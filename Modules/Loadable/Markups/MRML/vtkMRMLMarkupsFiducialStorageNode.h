@@ -81,6 +81,10 @@ protected:
   /// necessary, same with the description
   virtual int WriteDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Write the string in the stream, converted to the storage format only
+  /// if it contains characters that need to be escaped
+  void WriteStringInStorageFormat(ostream& of, const std::string& value);
+
 };
 
 #endif
@@ -29,16 +29,19 @@
 #include <vtkAbstractTransform.h>
 #include <vtkBitArray.h>
 #include <vtkCommand.h>
+#include <vtkIdList.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStringArray.h>
 
 // STD includes
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLMarkupsNode);
@@ -51,6 +54,10 @@ vtkMRMLMarkupsNode::vtkMRMLMarkupsNode()
   this->Locked = 0;
   this->MarkupLabelFormat = std::string("%N-%d");
   this->MaximumNumberOfMarkups = 0;
+  this->MarkupPoints = vtkSmartPointer<vtkPoints>::New();
+  this->MarkupPoints->SetDataTypeToDouble();
+  this->MarkupFirstPointIndices.push_back(0);
+  this->MarkupIndexByIDUpToDate = true;
 }
 
 //----------------------------------------------------------------------------
@@ -142,6 +149,9 @@ void vtkMRMLMarkupsNode::Copy(vtkMRMLNode *anode)
     }
 
   this->Markups.clear();
+  this->UpdateMarkupPoints();
+  this->MarkupIndexByID.clear();
+  this->MarkupIndexByIDUpToDate = true;
   int numMarkups = node->GetNumberOfMarkups();
   for (int n = 0; n < numMarkups; n++)
     {
@@ -233,9 +243,14 @@ void vtkMRMLMarkupsNode::RemoveAllMarkups()
 
   this->SetLocked(0); // Should this be done here ?
 
-  while(this->Markups.size() > 0)
+  if (!this->Markups.empty())
     {
-    this->RemoveMarkup(0);
+    this->Markups.clear();
+    this->UpdateMarkupPoints();
+    this->MarkupIndexByID.clear();
+    this->MarkupIndexByIDUpToDate = true;
+    this->Modified();
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::MarkupRemovedEvent);
     }
   this->MaximumNumberOfMarkups = 0;
 
@@ -486,6 +501,12 @@ int vtkMRMLMarkupsNode::AddMarkup(Markup markup)
   this->MaximumNumberOfMarkups++;
 
   int markupIndex = this->GetNumberOfMarkups() - 1;
+  this->InsertNthMarkupPoints(markupIndex);
+  if (this->MarkupIndexByIDUpToDate)
+    {
+    // keep the first markup if the ID is already used
+    this->MarkupIndexByID.insert(std::make_pair(markup.ID, markupIndex));
+    }
 
   this->Modified();
   this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::MarkupAddedEvent, (void*)&markupIndex);
@@ -536,10 +557,92 @@ int vtkMRMLMarkupsNode::AddPointToNthMarkup(vtkVector3d point, int n)
   if (this->MarkupExists(n))
     {
     this->Markups[n].points.push_back(point);
+    // insert the point after the last point of the markup
+    vtkIdType pointId = this->MarkupFirstPointIndices[n + 1];
+    this->MarkupPoints->InsertNextPoint(0.0, 0.0, 0.0);
+    double* points = static_cast<double*>(this->MarkupPoints->GetVoidPointer(0));
+    vtkIdType numberOfPoints = this->MarkupPoints->GetNumberOfPoints();
+    memmove(points + 3 * (pointId + 1), points + 3 * pointId,
+            3 * (numberOfPoints - 1 - pointId) * sizeof(double));
+    this->MarkupPoints->SetPoint(pointId, point.GetData());
+    this->MarkupPoints->Modified();
+    for (size_t i = n + 1; i < this->MarkupFirstPointIndices.size(); ++i)
+      {
+      ++this->MarkupFirstPointIndices[i];
+      }
     }
   return pointIndex;
 }
 
+//-----------------------------------------------------------
+int vtkMRMLMarkupsNode::AddPointsToNewMarkups(vtkPoints* points)
+{
+  if (!points)
+    {
+    vtkErrorMacro("AddPointsToNewMarkups: invalid points");
+    return -1;
+    }
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  if (numberOfPoints == 0)
+    {
+    return -1;
+    }
+  int firstMarkupIndex = this->GetNumberOfMarkups();
+  this->Markups.reserve(this->Markups.size() + numberOfPoints);
+  this->MarkupFirstPointIndices.reserve(this->MarkupFirstPointIndices.size() + numberOfPoints);
+
+  int wasModifying = this->StartModify();
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    vtkVector3d point;
+    points->GetPoint(i, point.GetData());
+    this->AddPointToNewMarkup(point);
+    }
+  this->EndModify(wasModifying);
+  return firstMarkupIndex;
+}
+
+//-----------------------------------------------------------
+int vtkMRMLMarkupsNode::AddMarkups(std::vector<Markup>& markups)
+{
+  if (markups.empty())
+    {
+    return -1;
+    }
+  int firstMarkupIndex = this->GetNumberOfMarkups();
+  this->Markups.resize(this->Markups.size() + markups.size());
+  for (size_t i = 0; i < markups.size(); ++i)
+    {
+    // swap the strings and points rather than copying them
+    Markup& source = markups[i];
+    Markup& target = this->Markups[firstMarkupIndex + i];
+    target.ID.swap(source.ID);
+    target.Label.swap(source.Label);
+    target.Description.swap(source.Description);
+    target.AssociatedNodeID.swap(source.AssociatedNodeID);
+    target.points.swap(source.points);
+    for (int j = 0; j < 4; ++j)
+      {
+      target.OrientationWXYZ[j] = source.OrientationWXYZ[j];
+      }
+    target.Selected = source.Selected;
+    target.Locked = source.Locked;
+    target.Visibility = source.Visibility;
+    if (target.ID.empty())
+      {
+      target.ID = this->GenerateUniqueMarkupID();
+      }
+    this->MaximumNumberOfMarkups++;
+    }
+  markups.clear();
+  this->UpdateMarkupPoints();
+  this->MarkupIndexByIDUpToDate = false;
+
+  this->Modified();
+  this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::MarkupAddedEvent);
+  return firstMarkupIndex;
+}
+
 //-----------------------------------------------------------
 vtkVector3d vtkMRMLMarkupsNode::GetMarkupPointVector(int markupIndex, int pointIndex)
 {
@@ -591,13 +694,63 @@ void vtkMRMLMarkupsNode::RemoveMarkup(int m)
   if (this->MarkupExists(m))
     {
     vtkDebugMacro("RemoveMarkup: m = " << m << ", markups size = " << this->Markups.size());
+    this->RemoveNthMarkupPoints(m);
     this->Markups.erase(this->Markups.begin() + m);
+    this->MarkupIndexByIDUpToDate = false;
 
     this->Modified();
     this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::MarkupRemovedEvent, (void*)&m);
     }
 }
 
+//-----------------------------------------------------------
+void vtkMRMLMarkupsNode::RemoveMarkups(vtkIdList* markupIndices)
+{
+  if (!markupIndices)
+    {
+    vtkErrorMacro("RemoveMarkups: invalid markup indices");
+    return;
+    }
+  int numberOfMarkups = this->GetNumberOfMarkups();
+  std::vector<bool> removed(numberOfMarkups, false);
+  bool removedAny = false;
+  for (vtkIdType i = 0; i < markupIndices->GetNumberOfIds(); ++i)
+    {
+    int m = static_cast<int>(markupIndices->GetId(i));
+    if (!this->MarkupExists(m))
+      {
+      continue;
+      }
+    removed[m] = true;
+    removedAny = true;
+    }
+  if (!removedAny)
+    {
+    return;
+    }
+
+  // compact the list in place rather than erasing the markups one by one
+  int keptMarkups = 0;
+  for (int m = 0; m < numberOfMarkups; ++m)
+    {
+    if (removed[m])
+      {
+      continue;
+      }
+    if (keptMarkups != m)
+      {
+      std::swap(this->Markups[keptMarkups], this->Markups[m]);
+      }
+    ++keptMarkups;
+    }
+  this->Markups.resize(keptMarkups);
+  this->UpdateMarkupPoints();
+  this->MarkupIndexByIDUpToDate = false;
+
+  this->Modified();
+  this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::MarkupRemovedEvent);
+}
+
 //-----------------------------------------------------------
 bool vtkMRMLMarkupsNode::InsertMarkup(Markup m, int targetIndex)
 {
@@ -621,6 +774,8 @@ bool vtkMRMLMarkupsNode::InsertMarkup(Markup m, int targetIndex)
 
   std::vector < Markup >::iterator result;
   result = this->Markups.insert(pos, m);
+  this->InsertNthMarkupPoints(destIndex);
+  this->MarkupIndexByIDUpToDate = false;
 
   // sanity check
   if (result->Label.compare(m.Label) != 0)
@@ -685,6 +840,8 @@ void vtkMRMLMarkupsNode::SwapMarkups(int m1, int m2)
   this->CopyMarkup(this->GetNthMarkup(m2), m1Markup);
   // and copy the backup of the first one into the second
   this->CopyMarkup(&m1MarkupBackup, this->GetNthMarkup(m2));
+  this->UpdateMarkupPoints();
+  this->MarkupIndexByIDUpToDate = false;
 
   // and let listeners know that two markups have changed
   this->Modified();
@@ -725,6 +882,8 @@ void vtkMRMLMarkupsNode::SetMarkupPoint(const int markupIndex, const int pointIn
     markup->points[pointIndex].SetX(x);
     markup->points[pointIndex].SetY(y);
     markup->points[pointIndex].SetZ(z);
+    this->MarkupPoints->SetPoint(this->MarkupFirstPointIndices[markupIndex] + pointIndex, x, y, z);
+    this->MarkupPoints->Modified();
     }
   else
     {
@@ -735,6 +894,68 @@ void vtkMRMLMarkupsNode::SetMarkupPoint(const int markupIndex, const int pointIn
   this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent, (void*)&markupIndex);
 }
 
+//-----------------------------------------------------------
+vtkPoints* vtkMRMLMarkupsNode::GetAllMarkupPoints()
+{
+  return this->MarkupPoints;
+}
+
+//-----------------------------------------------------------
+vtkIdType vtkMRMLMarkupsNode::GetNthMarkupFirstPointIndex(int n)
+{
+  if (!this->MarkupExists(n))
+    {
+    return -1;
+    }
+  return this->MarkupFirstPointIndices[n];
+}
+
+//-----------------------------------------------------------
+bool vtkMRMLMarkupsNode::SetAllMarkupPoints(vtkPoints* points)
+{
+  if (!points)
+    {
+    vtkErrorMacro("SetAllMarkupPoints: invalid points");
+    return false;
+    }
+  if (points->GetNumberOfPoints() != this->MarkupPoints->GetNumberOfPoints())
+    {
+    vtkErrorMacro("SetAllMarkupPoints: " << points->GetNumberOfPoints()
+                  << " points given, the markups have " << this->MarkupPoints->GetNumberOfPoints());
+    return false;
+    }
+  if (points != this->MarkupPoints.GetPointer())
+    {
+    if (points->GetDataType() == VTK_DOUBLE)
+      {
+      memcpy(this->MarkupPoints->GetVoidPointer(0), points->GetVoidPointer(0),
+             3 * points->GetNumberOfPoints() * sizeof(double));
+      }
+    else
+      {
+      for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+        {
+        this->MarkupPoints->SetPoint(i, points->GetPoint(i));
+        }
+      }
+    }
+  this->MarkupPoints->Modified();
+
+  const double* point = static_cast<double*>(this->MarkupPoints->GetVoidPointer(0));
+  for (std::vector<Markup>::iterator markupIt = this->Markups.begin(); markupIt != this->Markups.end(); ++markupIt)
+    {
+    for (std::vector<vtkVector3d>::iterator pointIt = markupIt->points.begin(); pointIt != markupIt->points.end(); ++pointIt)
+      {
+      pointIt->Set(point[0], point[1], point[2]);
+      point += 3;
+      }
+    }
+
+  this->Modified();
+  this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent);
+  return true;
+}
+
 //-----------------------------------------------------------
 void vtkMRMLMarkupsNode::SetMarkupPointLPS(const int markupIndex, const int pointIndex,
                                         const double x, const double y, const double z)
@@ -880,17 +1101,23 @@ int vtkMRMLMarkupsNode::GetMarkupIndexByID(const char* markupID)
     return -1;
     }
 
-  int numberOfMarkups = this->GetNumberOfMarkups();
-  for (int i = 0; i < numberOfMarkups; ++i)
+  if (!this->MarkupIndexByIDUpToDate)
     {
-    Markup* compareMarkup = this->GetNthMarkup(i);
-    if (compareMarkup &&
-        strcmp(compareMarkup->ID.c_str(), markupID) == 0)
+    this->MarkupIndexByID.clear();
+    int numberOfMarkups = this->GetNumberOfMarkups();
+    for (int i = 0; i < numberOfMarkups; ++i)
       {
-      return i;
+      // keep the first markup if the ID is already used
+      this->MarkupIndexByID.insert(std::make_pair(this->Markups[i].ID, i));
       }
+    this->MarkupIndexByIDUpToDate = true;
+    }
+  std::map<std::string, int>::const_iterator it = this->MarkupIndexByID.find(markupID);
+  if (it == this->MarkupIndexByID.end())
+    {
+    return -1;
     }
-  return -1;
+  return it->second;
 }
 
 //-------------------------------------------------------------------------
@@ -922,6 +1149,7 @@ void vtkMRMLMarkupsNode::SetNthMarkupID(int n, std::string id)
         {
         vtkDebugMacro("Changing markup " << n << " associated node id from " << markup->ID.c_str() << " to " << id.c_str());
         markup->ID = std::string(id.c_str());
+        this->MarkupIndexByIDUpToDate = false;
         }
       else
         {
@@ -1109,19 +1337,10 @@ bool vtkMRMLMarkupsNode::CanApplyNonLinearTransforms()const
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsNode::ApplyTransform(vtkAbstractTransform* transform)
 {
-  int numMarkups = this->GetNumberOfMarkups();
-  double xyzIn[3];
-  double xyzOut[3];
-  for (int m=0; m<numMarkups; m++)
-    {
-    int numPoints = this->GetNumberOfPointsInNthMarkup(m);
-    for (int n=0; n<numPoints; n++)
-      {
-      this->GetMarkupPoint(m, n, xyzIn);
-      transform->TransformPoint(xyzIn,xyzOut);
-      this->SetMarkupPointFromArray(m, n, xyzOut);
-      }
-    }
+  vtkNew<vtkPoints> transformedPoints;
+  transformedPoints->SetDataTypeToDouble();
+  transform->TransformPoints(this->MarkupPoints, transformedPoints.GetPointer());
+  this->SetAllMarkupPoints(transformedPoints.GetPointer());
   this->StorableModifiedTime.Modified();
   this->Modified();
 }
@@ -1277,3 +1496,86 @@ std::string vtkMRMLMarkupsNode::ReplaceListNameInMarkupLabelFormat()
     }
   return newFormatString;
 }
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::InsertNthMarkupPoints(int n)
+{
+  const std::vector<vtkVector3d>& markupPoints = this->Markups[n].points;
+  vtkIdType numberOfMarkupPoints = static_cast<vtkIdType>(markupPoints.size());
+  vtkIdType firstPointId = this->MarkupFirstPointIndices[n];
+  this->MarkupFirstPointIndices.insert(this->MarkupFirstPointIndices.begin() + n, firstPointId);
+  for (size_t i = n + 1; i < this->MarkupFirstPointIndices.size(); ++i)
+    {
+    this->MarkupFirstPointIndices[i] += numberOfMarkupPoints;
+    }
+  if (numberOfMarkupPoints == 0)
+    {
+    return;
+    }
+
+  // InsertNextPoint grows the array geometrically, appending is amortized O(1)
+  vtkIdType numberOfPoints = this->MarkupPoints->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < numberOfMarkupPoints; ++i)
+    {
+    this->MarkupPoints->InsertNextPoint(0.0, 0.0, 0.0);
+    }
+  double* points = static_cast<double*>(this->MarkupPoints->GetVoidPointer(0));
+  if (firstPointId < numberOfPoints)
+    {
+    memmove(points + 3 * (firstPointId + numberOfMarkupPoints), points + 3 * firstPointId,
+            3 * (numberOfPoints - firstPointId) * sizeof(double));
+    }
+  for (vtkIdType i = 0; i < numberOfMarkupPoints; ++i)
+    {
+    memcpy(points + 3 * (firstPointId + i), markupPoints[i].GetData(), 3 * sizeof(double));
+    }
+  this->MarkupPoints->Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::RemoveNthMarkupPoints(int n)
+{
+  vtkIdType firstPointId = this->MarkupFirstPointIndices[n];
+  vtkIdType numberOfMarkupPoints = this->MarkupFirstPointIndices[n + 1] - firstPointId;
+  this->MarkupFirstPointIndices.erase(this->MarkupFirstPointIndices.begin() + n);
+  for (size_t i = n; i < this->MarkupFirstPointIndices.size(); ++i)
+    {
+    this->MarkupFirstPointIndices[i] -= numberOfMarkupPoints;
+    }
+  if (numberOfMarkupPoints == 0)
+    {
+    return;
+    }
+
+  vtkIdType numberOfPoints = this->MarkupPoints->GetNumberOfPoints();
+  double* points = static_cast<double*>(this->MarkupPoints->GetVoidPointer(0));
+  memmove(points + 3 * firstPointId, points + 3 * (firstPointId + numberOfMarkupPoints),
+          3 * (numberOfPoints - firstPointId - numberOfMarkupPoints) * sizeof(double));
+  // shrinking keeps the allocated memory
+  this->MarkupPoints->SetNumberOfPoints(numberOfPoints - numberOfMarkupPoints);
+  this->MarkupPoints->Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::UpdateMarkupPoints()
+{
+  this->MarkupFirstPointIndices.resize(this->Markups.size() + 1);
+  vtkIdType numberOfPoints = 0;
+  for (size_t m = 0; m < this->Markups.size(); ++m)
+    {
+    this->MarkupFirstPointIndices[m] = numberOfPoints;
+    numberOfPoints += static_cast<vtkIdType>(this->Markups[m].points.size());
+    }
+  this->MarkupFirstPointIndices[this->Markups.size()] = numberOfPoints;
+
+  this->MarkupPoints->SetNumberOfPoints(numberOfPoints);
+  vtkIdType pointId = 0;
+  for (std::vector<Markup>::const_iterator markupIt = this->Markups.begin(); markupIt != this->Markups.end(); ++markupIt)
+    {
+    for (std::vector<vtkVector3d>::const_iterator pointIt = markupIt->points.begin(); pointIt != markupIt->points.end(); ++pointIt)
+      {
+      this->MarkupPoints->SetPoint(pointId++, pointIt->GetData());
+      }
+    }
+  this->MarkupPoints->Modified();
+}
@@ -28,8 +28,13 @@
 #include <vtkSmartPointer.h>
 #include <vtkVector.h>
 
-class vtkStringArray;
+// STD includes
+#include <map>
+
+class vtkIdList;
 class vtkMatrix4x4;
+class vtkPoints;
+class vtkStringArray;
 
 /// see doxygen enabled comment in class description
 typedef struct
@@ -49,7 +54,7 @@ typedef struct
 /// Markups nodes contains a list of markups that each contain a list of points.
 /// Visualization parameters for these nodes are controlled by the
 /// vtkMRMLMarkupsDisplayNode class.
-/// Each markup has a unique ID.
+/// Each markup has a unique ID, markups are indexed by ID for fast lookup.
 /// Each markup is defined by a certain number of RAS points,
 /// 1 for fiducials, 2 for rulers, 3 for angles, etc.
 /// Each markup has an orientation defined by a quaternion. It's represented
@@ -193,6 +198,18 @@ public:
   int AddPointWorldToNewMarkup(vtkVector3d point, std::string label = std::string());
   /// Add a point to the nth markup, returning the point index
   int AddPointToNthMarkup(vtkVector3d point, int n);
+  /// Create a new markup with one point for each point.
+  /// Invoke a single MarkupAddedEvent without markup index and a single
+  /// Modified event.
+  /// Return index of the first new markup, -1 on failure.
+  int AddPointsToNewMarkups(vtkPoints* points);
+  /// Append the markups to the list, keeping their properties. The content
+  /// of the markups is moved into the node and the vector is cleared.
+  /// Markups without ID get a unique ID.
+  /// Invoke a single MarkupAddedEvent without markup index and a single
+  /// Modified event.
+  /// Return index of the first new markup, -1 on failure.
+  int AddMarkups(std::vector<Markup>& markups);
 
   /// Get the position of the pointIndex'th point in markupIndex markup,
   /// returning it as a vtkVector3d
@@ -207,8 +224,29 @@ public:
   /// Returns 0 on failure, 1 on success.
   int GetMarkupPointWorld(int markupIndex, int pointIndex, double worldxyz[4]);
 
+  /// Get the points of all the markups, the points of a markup are
+  /// stored contiguously, starting at GetNthMarkupFirstPointIndex(n).
+  /// The node keeps the points up to date (same object for the life time of
+  /// the node), they can be shared with a polydata or a filter without copy.
+  /// The points must not be modified directly.
+  /// \sa SetAllMarkupPoints
+  vtkPoints* GetAllMarkupPoints();
+  /// Return the index in GetAllMarkupPoints() of the first point of the
+  /// nth markup, -1 if n is invalid.
+  vtkIdType GetNthMarkupFirstPointIndex(int n);
+  /// Set the position of all the points of all the markups, ordered as in
+  /// GetAllMarkupPoints().
+  /// Invoke a single PointModifiedEvent without markup index and a single
+  /// Modified event.
+  /// Returns false if the number of points doesn't match.
+  bool SetAllMarkupPoints(vtkPoints* points);
+
   /// Remove a markup
   void RemoveMarkup(int m);
+  /// Remove the markups whose indices are in the list.
+  /// Invoke a single MarkupRemovedEvent without markup index and a single
+  /// Modified event.
+  void RemoveMarkups(vtkIdList* markupIndices);
 
   /// Insert a markup in this list at targetIndex.
   /// If targetIndex is < 0, insert at the start of the list.
@@ -359,11 +397,32 @@ protected:
   /// have been in this list
   std::string GenerateUniqueMarkupID();;
 
+  /// Store the points of the nth markup, just inserted in the list, in
+  /// MarkupPoints.
+  void InsertNthMarkupPoints(int n);
+  /// Remove the points of the nth markup, about to be removed from the list,
+  /// from MarkupPoints.
+  void RemoveNthMarkupPoints(int n);
+  /// Fill MarkupPoints with the points of all the markups.
+  void UpdateMarkupPoints();
+
 private:
   /// Vector of point sets, each markup can have N markups of the same type
   /// saved in the vector.
   std::vector < Markup > Markups;
 
+  /// Copy of the points of all the markups, in markup order.
+  vtkSmartPointer<vtkPoints> MarkupPoints;
+  /// Index in MarkupPoints of the first point of each markup, followed by
+  /// the total number of points.
+  std::vector<vtkIdType> MarkupFirstPointIndices;
+
+  /// Markup index by markup ID. Markups appended to the list are added to
+  /// the map, other changes of the list mark it out of date and it is
+  /// rebuilt at the next lookup.
+  std::map<std::string, int> MarkupIndexByID;
+  bool MarkupIndexByIDUpToDate;
+
   int Locked;
 
   std::string MarkupLabelFormat;
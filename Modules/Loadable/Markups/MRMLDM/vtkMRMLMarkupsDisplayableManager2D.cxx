@@ -613,8 +613,18 @@ void vtkMRMLMarkupsDisplayableManager2D::OnMRMLMarkupsPointModifiedEvent(vtkMRML
   vtkAbstractWidget *widget = this->Helper->GetWidget(markupsNode);
   if (widget)
     {
-    // Update the standard settings of all widgets.
-    this->UpdateNthSeedPositionFromMRML(n, widget, markupsNode);
+    if (n >= 0)
+      {
+      this->UpdateNthSeedPositionFromMRML(n, widget, markupsNode);
+      }
+    else
+      {
+      // points of several markups were set at once
+      for (int i = 0; i < markupsNode->GetNumberOfMarkups(); ++i)
+        {
+        this->UpdateNthSeedPositionFromMRML(i, widget, markupsNode);
+        }
+      }
 
     // Propagate MRML changes to widget
     this->PropagateMRMLToWidget(markupsNode, widget);
@@ -125,7 +125,7 @@ protected:
   void OnMRMLMarkupsNodeTransformModifiedEvent(vtkMRMLNode* node);
   void OnMRMLMarkupsNodeLockModifiedEvent(vtkMRMLNode* node);
   void OnMRMLMarkupsDisplayNodeModifiedEvent(vtkMRMLNode *node);
-  void OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n);
+  virtual void OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n);
   /// Subclasses need to react to new markups being added to or removed
   /// from a markups node or modified
   virtual void OnMRMLMarkupsNodeMarkupAddedEvent(vtkMRMLMarkupsNode * vtkNotUsed(markupsNode), int vtkNotUsed(n)) {};
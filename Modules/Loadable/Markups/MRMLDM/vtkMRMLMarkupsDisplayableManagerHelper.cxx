@@ -22,6 +22,9 @@
 // MarkupsModule/MRMLDisplayableManager includes
 #include "vtkMRMLMarkupsDisplayableManagerHelper.h"
 
+// MarkupsModule/VTKWidgets includes
+#include <vtkMarkupsGlyphActors.h>
+
 // VTK includes
 #include <vtkAbstractWidget.h>
 #include <vtkCollection.h>
@@ -103,6 +106,15 @@ void vtkMRMLMarkupsDisplayableManagerHelper::PrintSelf(ostream& os, vtkIndent in
     os << indent.GetNextIndent() << it->first.c_str() << " : projection is "
        << (it->second ? "not null" : "null") << std::endl;
     }
+
+  os << indent << "Glyph actors:" << std::endl;
+  for (GlyphActorsIt it = this->GlyphActors.begin();
+       it != this->GlyphActors.end();
+       ++it)
+    {
+    os << indent.GetNextIndent() << it->first->GetID() << " : "
+       << it->second->GetNumberOfDrawnPoints() << " drawn points" << std::endl;
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -305,6 +317,97 @@ vtkAbstractWidget * vtkMRMLMarkupsDisplayableManagerHelper::GetPointProjectionWi
   return it->second;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsDisplayableManagerHelper::RecordGlyphActorsForNode(vtkMarkupsGlyphActors* glyphActors, vtkMRMLMarkupsNode *node)
+{
+  if (!glyphActors || !node)
+    {
+    return;
+    }
+  this->GlyphActors[node] = glyphActors;
+}
+
+//---------------------------------------------------------------------------
+vtkMarkupsGlyphActors * vtkMRMLMarkupsDisplayableManagerHelper::GetGlyphActors(vtkMRMLMarkupsNode * node)
+{
+  if (!node)
+    {
+    return 0;
+    }
+  GlyphActorsIt it = this->GlyphActors.find(node);
+  if (it == this->GlyphActors.end())
+    {
+    return 0;
+    }
+  return it->second;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsDisplayableManagerHelper::RecordProjectionGlyphActorsForNode(
+  vtkMarkupsGlyphActors* glyphActors, vtkMRMLMarkupsNode *node, bool behindSlice)
+{
+  if (!glyphActors || !node)
+    {
+    return;
+    }
+  if (behindSlice)
+    {
+    this->BehindProjectionGlyphActors[node] = glyphActors;
+    }
+  else
+    {
+    this->FrontProjectionGlyphActors[node] = glyphActors;
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkMarkupsGlyphActors * vtkMRMLMarkupsDisplayableManagerHelper::GetProjectionGlyphActors(
+  vtkMRMLMarkupsNode * node, bool behindSlice)
+{
+  if (!node)
+    {
+    return 0;
+    }
+  std::map<vtkMRMLMarkupsNode*, vtkSmartPointer<vtkMarkupsGlyphActors> >& projectionGlyphActors =
+    behindSlice ? this->BehindProjectionGlyphActors : this->FrontProjectionGlyphActors;
+  GlyphActorsIt it = projectionGlyphActors.find(node);
+  if (it == projectionGlyphActors.end())
+    {
+    return 0;
+    }
+  return it->second;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsDisplayableManagerHelper::RemoveProjectionGlyphActors(vtkMRMLMarkupsNode * node)
+{
+  GlyphActorsIt it = this->FrontProjectionGlyphActors.find(node);
+  if (it != this->FrontProjectionGlyphActors.end())
+    {
+    it->second->SetRenderer(NULL);
+    this->FrontProjectionGlyphActors.erase(it);
+    }
+  it = this->BehindProjectionGlyphActors.find(node);
+  if (it != this->BehindProjectionGlyphActors.end())
+    {
+    it->second->SetRenderer(NULL);
+    this->BehindProjectionGlyphActors.erase(it);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsDisplayableManagerHelper::RemoveGlyphActors(vtkMRMLMarkupsNode * node)
+{
+  this->RemoveProjectionGlyphActors(node);
+  GlyphActorsIt it = this->GlyphActors.find(node);
+  if (it == this->GlyphActors.end())
+    {
+    return;
+    }
+  it->second->SetRenderer(NULL);
+  this->GlyphActors.erase(it);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsDisplayableManagerHelper::RemoveAllWidgetsAndNodes()
 {
@@ -338,6 +441,28 @@ void vtkMRMLMarkupsDisplayableManagerHelper::RemoveAllWidgetsAndNodes()
     }
   this->WidgetPointProjections.clear();
 
+  for (GlyphActorsIt glyphIt = this->GlyphActors.begin();
+       glyphIt != this->GlyphActors.end();
+       ++glyphIt)
+    {
+    glyphIt->second->SetRenderer(NULL);
+    }
+  this->GlyphActors.clear();
+  for (GlyphActorsIt glyphIt = this->FrontProjectionGlyphActors.begin();
+       glyphIt != this->FrontProjectionGlyphActors.end();
+       ++glyphIt)
+    {
+    glyphIt->second->SetRenderer(NULL);
+    }
+  this->FrontProjectionGlyphActors.clear();
+  for (GlyphActorsIt glyphIt = this->BehindProjectionGlyphActors.begin();
+       glyphIt != this->BehindProjectionGlyphActors.end();
+       ++glyphIt)
+    {
+    glyphIt->second->SetRenderer(NULL);
+    }
+  this->BehindProjectionGlyphActors.clear();
+
   this->MarkupsNodeList.clear();
 }
 
@@ -376,6 +501,8 @@ void vtkMRMLMarkupsDisplayableManagerHelper::RemoveWidgetAndNode(
     this->WidgetIntersections.erase(node);
     }
 
+  this->RemoveGlyphActors(node);
+
   // go through the list and remove the projection points for it
   // this can get called after a markup has been removed from the list,
   // so turn it around and iterate through all the markups in all the lists,
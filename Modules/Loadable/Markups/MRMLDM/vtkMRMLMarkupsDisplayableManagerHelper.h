@@ -44,6 +44,9 @@
 #include <vtkMRMLInteractionNode.h>
 class vtkMRMLMarkupsDisplayNode;
 
+// MarkupsModule/VTKWidgets includes
+class vtkMarkupsGlyphActors;
+
 /// \ingroup Slicer_QtModules_Markups
 class VTK_SLICER_MARKUPS_MODULE_MRMLDISPLAYABLEMANAGER_EXPORT vtkMRMLMarkupsDisplayableManagerHelper :
     public vtkObject
@@ -76,9 +79,26 @@ public:
   /// projection widget per unique point.
   vtkAbstractWidget * GetPointProjectionWidget(std::string uniqueFiducialID);
 
-  /// Remove all widgets, intersection widgets, nodes
+  /// Keep track of the glyph actors drawing the points of a node
+  void RecordGlyphActorsForNode(vtkMarkupsGlyphActors* glyphActors, vtkMRMLMarkupsNode *node);
+  /// Get the glyph actors drawing the points of a node, NULL if the node is
+  /// drawn with one handle per point
+  vtkMarkupsGlyphActors * GetGlyphActors(vtkMRMLMarkupsNode * node);
+  /// Keep track of the glyph actors drawing the slice projections of the
+  /// points of a node that are in front of or behind the slice
+  void RecordProjectionGlyphActorsForNode(vtkMarkupsGlyphActors* glyphActors, vtkMRMLMarkupsNode *node, bool behindSlice);
+  /// Get the glyph actors drawing the slice projections of the points of a
+  /// node that are in front of or behind the slice, NULL if there are none
+  vtkMarkupsGlyphActors * GetProjectionGlyphActors(vtkMRMLMarkupsNode * node, bool behindSlice);
+  /// Remove the projection glyph actors of a node from their renderer and forget them
+  void RemoveProjectionGlyphActors(vtkMRMLMarkupsNode * node);
+  /// Remove the glyph actors and the projection glyph actors of a node from
+  /// their renderer and forget them
+  void RemoveGlyphActors(vtkMRMLMarkupsNode * node);
+
+  /// Remove all widgets, intersection widgets, glyph actors, nodes
   void RemoveAllWidgetsAndNodes();
-  /// Remove a node, its widget and its intersection widget
+  /// Remove a node, its widget, its intersection widget and its glyph actors
   void RemoveWidgetAndNode(vtkMRMLMarkupsNode *node);
 
 
@@ -109,6 +129,17 @@ public:
   /// .. and its associated convenient typedef
   typedef std::map<std::string, vtkAbstractWidget*>::iterator WidgetPointProjectionsIt;
 
+  /// Map of glyph actors drawing all the points of the nodes with many points
+  std::map<vtkMRMLMarkupsNode*, vtkSmartPointer<vtkMarkupsGlyphActors> > GlyphActors;
+
+  /// .. and its associated convenient typedef
+  typedef std::map<vtkMRMLMarkupsNode*, vtkSmartPointer<vtkMarkupsGlyphActors> >::iterator GlyphActorsIt;
+
+  /// Maps of glyph actors drawing the slice projections of the points that are
+  /// in front of and behind the slice, for the nodes drawn with glyph actors
+  std::map<vtkMRMLMarkupsNode*, vtkSmartPointer<vtkMarkupsGlyphActors> > FrontProjectionGlyphActors;
+  std::map<vtkMRMLMarkupsNode*, vtkSmartPointer<vtkMarkupsGlyphActors> > BehindProjectionGlyphActors;
+
   //
   // End of The Lists!!
   //
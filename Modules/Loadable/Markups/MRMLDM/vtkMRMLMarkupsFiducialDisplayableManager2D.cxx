@@ -24,6 +24,7 @@
 #include "vtkMRMLMarkupsFiducialDisplayableManager2D.h"
 
 // MarkupsModule/VTKWidgets includes
+#include <vtkMarkupsGlyphActors.h>
 #include <vtkMarkupsGlyphSource2D.h>
 
 // MRMLDisplayableManager includes
@@ -33,18 +34,22 @@
 #include <vtkMRMLInteractionNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLTransformNode.h>
 
 // VTK includes
 #include <vtkAbstractWidget.h>
 #include <vtkFollower.h>
+#include <vtkGeneralTransform.h>
 #include <vtkHandleRepresentation.h>
 #include <vtkInteractorStyle.h>
 #include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkOrientedPolygonalHandleRepresentation3D.h>
 #include <vtkPickingManager.h>
 #include <vtkPointHandleRepresentation2D.h>
+#include <vtkPoints.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
@@ -53,10 +58,12 @@
 #include <vtkSeedRepresentation.h>
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
+#include <vtkTextProperty.h>
 
 // STD includes
 #include <sstream>
 #include <string>
+#include <vector>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLMarkupsFiducialDisplayableManager2D);
@@ -114,15 +121,7 @@ public:
           {
           this->Node->SetAttribute("Markups.MovingInSliceView", sliceNode->GetLayoutName());
           std::ostringstream seedNumber;
-          int *n =  reinterpret_cast<int *>(callData);
-          if (n != NULL)
-            {
-            seedNumber << *n;
-            }
-          else
-            {
-            seedNumber << "-1";
-            }
+          seedNumber << this->GetMarkupIndex(callData);
           this->Node->SetAttribute("Markups.MovingMarkupIndex", seedNumber.str().c_str());
           }
         else
@@ -147,7 +146,7 @@ public:
       // If calldata is NULL, invoking an event may cause a crash (e.g., Python observer
       // tries to dereference the NULL pointer), therefore it's important to always pass a valid pointer
       // and indicate invalidity with value (-1).
-      this->LastInteractionEventMarkupIndex = (callData ? *(reinterpret_cast<int *>(callData)) : -1);
+      this->LastInteractionEventMarkupIndex = this->GetMarkupIndex(callData);
       this->PointMovedSinceStartInteraction = false;
       this->Node->InvokeEvent(vtkMRMLMarkupsNode::PointStartInteractionEvent, &this->LastInteractionEventMarkupIndex);
       }
@@ -162,7 +161,7 @@ public:
         {
         // Most of the time vtkCommand::EndInteractionEvent does not provide
         // seed index, but in case we get a value then update the markup index.
-        this->LastInteractionEventMarkupIndex = *(reinterpret_cast<int *>(callData));
+        this->LastInteractionEventMarkupIndex = this->GetMarkupIndex(callData);
         }
       this->Node->InvokeEvent(vtkMRMLMarkupsNode::PointEndInteractionEvent, &this->LastInteractionEventMarkupIndex);
       if (!this->PointMovedSinceStartInteraction)
@@ -216,7 +215,11 @@ public:
           }
 
         // propagate the changes to MRML
-        this->DisplayableManager->UpdateNthMarkupPositionFromWidget(n, this->Node, this->Widget);
+        int markupIndex = this->GetMarkupIndex(&n);
+        if (markupIndex >= 0)
+          {
+          this->DisplayableManager->UpdateNthMarkupPositionFromWidget(markupIndex, this->Node, this->Widget);
+          }
         this->PointMovedSinceStartInteraction = true;
         }
       else
@@ -226,6 +229,19 @@ public:
       }
   }
 
+  /// Return the index of the markup moved by the seed passed as call data
+  int GetMarkupIndex(void *callData)
+  {
+    int seedIndex = (callData ? *(reinterpret_cast<int *>(callData)) : -1);
+    vtkMRMLMarkupsFiducialDisplayableManager2D *fiducialDisplayableManager =
+      vtkMRMLMarkupsFiducialDisplayableManager2D::SafeDownCast(this->DisplayableManager);
+    if (seedIndex < 0 || !fiducialDisplayableManager)
+      {
+      return seedIndex;
+      }
+    return fiducialDisplayableManager->GetMarkupIndexFromSeedIndex(this->Node, seedIndex);
+  }
+
   void SetWidget(vtkAbstractWidget *w)
     {
     this->Widget = w;
@@ -253,9 +269,225 @@ public:
 void vtkMRMLMarkupsFiducialDisplayableManager2D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "GlyphRenderingThreshold: " << this->GlyphRenderingThreshold << "\n";
   this->Helper->PrintSelf(os, indent);
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsFiducialDisplayableManager2D::UseGlyphRendering(vtkMRMLMarkupsNode* node)
+{
+  // the glyphs are drawn in the XY coordinates of a single renderer
+  return node && !this->IsInLightboxMode() &&
+    node->GetNumberOfMarkups() > this->GlyphRenderingThreshold;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLMarkupsFiducialDisplayableManager2D::GetMarkupIndexFromSeedIndex(vtkMRMLMarkupsNode* node, int seedIndex)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(node);
+  if (!glyphActors)
+    {
+    return seedIndex;
+    }
+  // the only seed shows the active glyph
+  return (seedIndex == 0 ? static_cast<int>(glyphActors->GetActivePointId()) : -1);
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLMarkupsFiducialDisplayableManager2D::GetSeedIndexFromMarkupIndex(vtkMRMLMarkupsNode* node, int n)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(node);
+  if (!glyphActors)
+    {
+    return n;
+    }
+  return (n >= 0 && n == glyphActors->GetActivePointId() ? 0 : -1);
+}
+
+//---------------------------------------------------------------------------
+vtkMarkupsGlyphActors* vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateGlyphActors(vtkMRMLMarkupsFiducialNode* fiducialNode)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (!glyphActors)
+    {
+    vtkNew<vtkMarkupsGlyphActors> newGlyphActors;
+    newGlyphActors->ViewportCoordinatesOn();
+    newGlyphActors->SetRenderer(this->GetRenderer());
+    this->Helper->RecordGlyphActorsForNode(newGlyphActors.GetPointer(), fiducialNode);
+    glyphActors = newGlyphActors.GetPointer();
+    }
+
+  vtkMRMLSliceNode *sliceNode = this->GetMRMLSliceNode();
+  vtkMRMLMarkupsDisplayNode *displayNode = fiducialNode->GetMarkupsDisplayNode();
+  bool listVisible = (sliceNode && displayNode &&
+                      displayNode->GetVisibility() &&
+                      displayNode->IsDisplayableInView(sliceNode->GetID()));
+
+  // the fiducials that are not on the slice are projected on it, as the
+  // projection widgets do when there is one handle per fiducial
+  vtkMarkupsGlyphActors *frontProjectionGlyphActors = NULL;
+  vtkMarkupsGlyphActors *behindProjectionGlyphActors = NULL;
+  if (listVisible && (displayNode->GetSliceProjection() & vtkMRMLMarkupsDisplayNode::ProjectionOn))
+    {
+    frontProjectionGlyphActors = this->GetOrCreateProjectionGlyphActors(fiducialNode, false);
+    behindProjectionGlyphActors = this->GetOrCreateProjectionGlyphActors(fiducialNode, true);
+    }
+  else
+    {
+    this->Helper->RemoveProjectionGlyphActors(fiducialNode);
+    }
+
+  // world positions of the fiducials
+  int numberOfFiducials = fiducialNode->GetNumberOfMarkups();
+  vtkSmartPointer<vtkPoints> worldPoints = fiducialNode->GetAllMarkupPoints();
+  if (worldPoints->GetNumberOfPoints() != numberOfFiducials)
+    {
+    worldPoints = vtkSmartPointer<vtkPoints>::New();
+    worldPoints->SetNumberOfPoints(numberOfFiducials);
+    for (int n = 0; n < numberOfFiducials; n++)
+      {
+      double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+      if (fiducialNode->GetNumberOfPointsInNthMarkup(n) > 0)
+        {
+        fiducialNode->GetMarkupPointWorld(n, 0, worldCoordinates);
+        }
+      worldPoints->SetPoint(n, worldCoordinates);
+      }
+    }
+  else if (fiducialNode->GetParentTransformNode())
+    {
+    vtkNew<vtkGeneralTransform> transformToWorld;
+    fiducialNode->GetParentTransformNode()->GetTransformToWorld(transformToWorld.GetPointer());
+    vtkNew<vtkPoints> transformedPoints;
+    transformToWorld->TransformPoints(worldPoints, transformedPoints.GetPointer());
+    worldPoints = transformedPoints.GetPointer();
+    }
+
+  // project them to XY, the third coordinate being the distance to the slice
+  vtkSmartPointer<vtkPoints> xyPoints = glyphActors->GetPoints();
+  if (!xyPoints)
+    {
+    xyPoints = vtkSmartPointer<vtkPoints>::New();
+    }
+  xyPoints->SetNumberOfPoints(numberOfFiducials);
+  vtkNew<vtkMatrix4x4> rasToXYMatrix;
+  double maxDistance = 0.5;
+  if (sliceNode)
+    {
+    vtkMatrix4x4::Invert(sliceNode->GetXYToRAS(), rasToXYMatrix.GetPointer());
+    maxDistance += sliceNode->GetDimensions()[2] - 1;
+    }
+  for (int n = 0; n < numberOfFiducials; n++)
+    {
+    double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+    worldPoints->GetPoint(n, worldCoordinates);
+    double xyCoordinates[4];
+    rasToXYMatrix->MultiplyPoint(worldCoordinates, xyCoordinates);
+    xyPoints->SetPoint(n, xyCoordinates[0], xyCoordinates[1], 0.0);
+
+    bool fiducialVisible = listVisible && fiducialNode->GetNthFiducialVisibility(n);
+    bool selected = fiducialNode->GetNthFiducialSelected(n);
+    bool behindSlice = (xyCoordinates[2] < -0.5);
+    bool inFrontOfSlice = (xyCoordinates[2] >= maxDistance);
+    glyphActors->SetNthPointVisibility(n, fiducialVisible && !behindSlice && !inFrontOfSlice);
+    glyphActors->SetNthPointSelected(n, selected);
+    glyphActors->SetNthPointLabel(n, fiducialNode->GetNthFiducialLabel(n));
+    if (frontProjectionGlyphActors && behindProjectionGlyphActors)
+      {
+      frontProjectionGlyphActors->SetNthPointVisibility(n, fiducialVisible && inFrontOfSlice);
+      frontProjectionGlyphActors->SetNthPointSelected(n, selected);
+      behindProjectionGlyphActors->SetNthPointVisibility(n, fiducialVisible && behindSlice);
+      behindProjectionGlyphActors->SetNthPointSelected(n, selected);
+      }
+    }
+  xyPoints->Modified();
+  glyphActors->SetPoints(xyPoints);
+
+  if (displayNode)
+    {
+    // same size in pixels as the slice projections
+    glyphActors->SetGlyphType(displayNode->GetGlyphType());
+    glyphActors->SetGlyphSize(displayNode->GetGlyphScale() * 2.0);
+    glyphActors->SetColor(displayNode->GetColor());
+    glyphActors->SetSelectedColor(displayNode->GetSelectedColor());
+    glyphActors->SetOpacity(displayNode->GetOpacity());
+
+    // the labels have the color of their fiducial
+    vtkTextProperty *textProperty = glyphActors->GetLabelTextProperty();
+    textProperty->SetFontSize(static_cast<int>(displayNode->GetTextScale() * 4.0));
+    }
+
+  if (frontProjectionGlyphActors && behindProjectionGlyphActors)
+    {
+    double color[3];
+    double selectedColor[3];
+    if (displayNode->GetSliceProjectionUseFiducialColor())
+      {
+      displayNode->GetColor(color);
+      displayNode->GetSelectedColor(selectedColor);
+      }
+    else
+      {
+      displayNode->GetSliceProjectionColor(color);
+      displayNode->GetSliceProjectionColor(selectedColor);
+      }
+    vtkMarkupsGlyphActors *projectionGlyphActors[2] = {frontProjectionGlyphActors, behindProjectionGlyphActors};
+    for (int i = 0; i < 2; ++i)
+      {
+      projectionGlyphActors[i]->SetPoints(xyPoints);
+      projectionGlyphActors[i]->SetGlyphType(displayNode->GetGlyphType());
+      projectionGlyphActors[i]->SetGlyphSize(displayNode->GetGlyphScale() * 2.0);
+      projectionGlyphActors[i]->SetColor(color);
+      projectionGlyphActors[i]->SetSelectedColor(selectedColor);
+      projectionGlyphActors[i]->SetOpacity(displayNode->GetSliceProjectionOpacity());
+      }
+    behindProjectionGlyphActors->SetFilled(!displayNode->GetSliceProjectionOutlinedBehindSlicePlane());
+    }
+  return glyphActors;
+}
+
+//---------------------------------------------------------------------------
+vtkMarkupsGlyphActors* vtkMRMLMarkupsFiducialDisplayableManager2D::GetOrCreateProjectionGlyphActors(
+  vtkMRMLMarkupsFiducialNode* fiducialNode, bool behindSlice)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetProjectionGlyphActors(fiducialNode, behindSlice);
+  if (!glyphActors)
+    {
+    vtkNew<vtkMarkupsGlyphActors> newGlyphActors;
+    newGlyphActors->ViewportCoordinatesOn();
+    newGlyphActors->SetRenderer(this->GetRenderer());
+    this->Helper->RecordProjectionGlyphActorsForNode(newGlyphActors.GetPointer(), fiducialNode, behindSlice);
+    glyphActors = newGlyphActors.GetPointer();
+    }
+  return glyphActors;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::SetActiveGlyph(vtkMRMLMarkupsFiducialNode* fiducialNode, int n)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  vtkSeedWidget *seedWidget = vtkSeedWidget::SafeDownCast(this->Helper->GetWidget(fiducialNode));
+  if (!glyphActors || !seedWidget)
+    {
+    return;
+    }
+  glyphActors->SetActivePointId(n);
+  if (n < 0)
+    {
+    vtkSeedRepresentation *seedRepresentation = vtkSeedRepresentation::SafeDownCast(seedWidget->GetRepresentation());
+    while (seedRepresentation && seedRepresentation->GetNumberOfSeeds() > 0)
+      {
+      seedWidget->DeleteSeed(0);
+      }
+    }
+  else
+    {
+    this->SetNthSeed(n, fiducialNode, seedWidget);
+    }
+  seedWidget->GetRepresentation()->NeedToRenderOn();
+  seedWidget->Modified();
+}
+
 //---------------------------------------------------------------------------
 /// Create a new seed widget.
 vtkAbstractWidget * vtkMRMLMarkupsFiducialDisplayableManager2D::CreateWidget(vtkMRMLMarkupsNode* node)
@@ -409,6 +641,12 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthMarkupPositionFromWidg
     {
     return false;
     }
+  int seedIndex = this->GetSeedIndexFromMarkupIndex(pointsNode, n);
+  if (seedIndex < 0 || seedIndex >= seedRepresentation->GetNumberOfSeeds())
+    {
+    // drawn by a glyph
+    return false;
+    }
 
   bool positionChanged = false;
 
@@ -423,7 +661,7 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthMarkupPositionFromWidg
 
   this->GetWorldToDisplayCoordinates(pointTransformed,displayCoordinates1);
 
-  seedRepresentation->GetSeedDisplayPosition(n,displayCoordinatesBuffer1);
+  seedRepresentation->GetSeedDisplayPosition(seedIndex,displayCoordinatesBuffer1);
 
   if (this->GetDisplayCoordinatesChanged(displayCoordinates1,displayCoordinatesBuffer1))
     {
@@ -459,6 +697,12 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthSeedPositionFromMRML(i
     {
     return false;
     }
+  int seedIndex = this->GetSeedIndexFromMarkupIndex(pointsNode, n);
+  if (seedIndex < 0 || seedIndex >= seedRepresentation->GetNumberOfSeeds())
+    {
+    // drawn by a glyph
+    return false;
+    }
   bool positionChanged = false;
 
 //  std::cout << "UpdateNthSeedPositionFromMRML: n = " << n << std::endl;
@@ -474,7 +718,7 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthSeedPositionFromMRML(i
 
   this->GetWorldToDisplayCoordinates(pointTransformed,displayCoordinates1);
 
-  seedRepresentation->GetSeedDisplayPosition(n,displayCoordinatesBuffer1);
+  seedRepresentation->GetSeedDisplayPosition(seedIndex,displayCoordinatesBuffer1);
 
   if (this->GetDisplayCoordinatesChanged(displayCoordinates1,displayCoordinatesBuffer1))
     {
@@ -487,7 +731,7 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthSeedPositionFromMRML(i
     if (seedRepresentation->GetRenderer() != NULL &&
         seedRepresentation->GetRenderer()->IsActiveCameraCreated())
       {
-      seedRepresentation->SetSeedDisplayPosition(n,displayCoordinates1);
+      seedRepresentation->SetSeedDisplayPosition(seedIndex,displayCoordinates1);
       positionChanged = true;
       }
     else
@@ -527,12 +771,19 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
     return;
     }
 
+  // when drawing glyphs, only the active fiducial has a handle
+  int seedIndex = this->GetSeedIndexFromMarkupIndex(fiducialNode, n);
+  if (seedIndex < 0)
+    {
+    return;
+    }
+
   int numberOfHandles = seedRepresentation->GetNumberOfSeeds();
   vtkDebugMacro("SetNthSeed, n = " << n << ", number of handles = " << numberOfHandles);
 
   // does this handle need to be created?
   bool createdNewHandle = false;
-  if (n >= numberOfHandles)
+  if (seedIndex >= numberOfHandles)
     {
     // create a new handle
     vtkHandleWidget* newhandle = seedWidget->CreateNewHandle();
@@ -564,10 +815,10 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
 
   // can have a 3d or 2d handle depending on if in light box mode or not
   vtkOrientedPolygonalHandleRepresentation3D *handleRep =
-    vtkOrientedPolygonalHandleRepresentation3D::SafeDownCast(seedRepresentation->GetHandleRepresentation(n));
+    vtkOrientedPolygonalHandleRepresentation3D::SafeDownCast(seedRepresentation->GetHandleRepresentation(seedIndex));
   // might be in lightbox mode where using a 2d point handle
   vtkPointHandleRepresentation2D *pointHandleRep =
-    vtkPointHandleRepresentation2D::SafeDownCast(seedRepresentation->GetHandleRepresentation(n));
+    vtkPointHandleRepresentation2D::SafeDownCast(seedRepresentation->GetHandleRepresentation(seedIndex));
 
   // update the postion
   bool positionChanged = this->UpdateNthSeedPositionFromMRML(n, seedWidget, fiducialNode);
@@ -582,7 +833,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
               << ", number of seeds = "
               <<  seedRepresentation->GetNumberOfSeeds()
               << ", handle rep = "
-              << (seedRepresentation->GetHandleRepresentation(n) ? seedRepresentation->GetHandleRepresentation(n)->GetClassName() : "null"));
+              << (seedRepresentation->GetHandleRepresentation(seedIndex) ? seedRepresentation->GetHandleRepresentation(seedIndex)->GetClassName() : "null"));
     return;
     }
 
@@ -599,7 +850,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
   if (handleRep)
     {
     // set the glyph type if a new handle was created, or the glyph type changed
-    int oldGlyphType = this->Helper->GetNodeGlyphType(displayNode, n);
+    int oldGlyphType = this->Helper->GetNodeGlyphType(displayNode, seedIndex);
     if (createdNewHandle ||
         oldGlyphType != displayNode->GetGlyphType())
       {
@@ -642,7 +893,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
         }
       // TBD: keep with the assumption of one glyph type per markups node,
       // that each seed has to have the same type, but update if necessary
-      this->Helper->SetNodeGlyphType(displayNode, displayNode->GetGlyphType(), n);
+      this->Helper->SetNodeGlyphType(displayNode, displayNode->GetGlyphType(), seedIndex);
       }  // end of glyph type
 
     // set the color
@@ -718,7 +969,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
         {
         handleRep->LabelVisibilityOn();
         }
-      seedWidget->GetSeed(n)->EnabledOn();
+      seedWidget->GetSeed(seedIndex)->EnabledOn();
       // if the fiducial is visible, turn off projection
       vtkSeedWidget* fiducialSeed = vtkSeedWidget::SafeDownCast(this->Helper->GetPointProjectionWidget(fiducialNode->GetNthMarkupID(n)));
       if (fiducialSeed && fiducialSeed->GetSeed(0))
@@ -900,7 +1151,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
         (interactionNode->GetCurrentInteractionMode() == vtkMRMLInteractionNode::Place)
         && (interactionNode->GetPlaceModePersistence() == 1);
       }
-    vtkHandleWidget *seed = seedWidget->GetSeed(n);
+    vtkHandleWidget *seed = seedWidget->GetSeed(seedIndex);
     if (listLocked || persistentPlaceMode)
       {
       seed->ProcessEventsOff();
@@ -928,7 +1179,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::SetNthSeed(int n, vtkMRMLMarkup
     // update visibility and enabled (if the point handle is still enabled
     // while invisible, mousing near it will show it)
     pointHandleRep->SetVisibility(fidVisible);
-    seedWidget->GetSeed(n)->SetEnabled(fidVisible);
+    seedWidget->GetSeed(seedIndex)->SetEnabled(fidVisible);
     }
 }
 
@@ -1087,10 +1338,53 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::PropagateMRMLToWidget(vtkMRMLMa
       }
     }
 
-  for (int n = 0; n < numberOfFiducials; n++)
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (this->UseGlyphRendering(fiducialNode))
     {
-    // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
-    this->SetNthSeed(n, fiducialNode, seedWidget);
+    if (!glyphActors)
+      {
+      // switch from one handle per fiducial to glyphs, the projections are
+      // drawn by the projection glyph actors
+      glyphActors = this->UpdateGlyphActors(fiducialNode);
+      this->SetActiveGlyph(fiducialNode, -1);
+      for (int n = 0; n < numberOfFiducials; n++)
+        {
+        vtkAbstractWidget *projectionWidget =
+          this->Helper->GetPointProjectionWidget(fiducialNode->GetNthMarkupID(n));
+        if (projectionWidget)
+          {
+          projectionWidget->Off();
+          }
+        }
+      }
+    else
+      {
+      this->UpdateGlyphActors(fiducialNode);
+      }
+    // the active fiducial may have moved away from the slice
+    vtkIdType activePointId = glyphActors->GetActivePointId();
+    if (activePointId >= 0 && !glyphActors->GetNthPointVisibility(activePointId))
+      {
+      this->SetActiveGlyph(fiducialNode, -1);
+      }
+    else if (activePointId >= 0)
+      {
+      this->SetNthSeed(static_cast<int>(activePointId), fiducialNode, seedWidget);
+      }
+    }
+  else
+    {
+    if (glyphActors)
+      {
+      // switch from glyphs to one handle per fiducial
+      this->SetActiveGlyph(fiducialNode, -1);
+      this->Helper->RemoveGlyphActors(fiducialNode);
+      }
+    for (int n = 0; n < numberOfFiducials; n++)
+      {
+      // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
+      this->SetNthSeed(n, fiducialNode, seedWidget);
+      }
     }
 
 
@@ -1164,14 +1458,19 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::PropagateWidgetToMRML(vtkAbstra
   int numberOfSeeds = seedRepresentation->GetNumberOfSeeds();
 
   bool atLeastOnePositionChanged = false;
-  for (int n = 0; n < numberOfSeeds; n++)
+  for (int seedIndex = 0; seedIndex < numberOfSeeds; seedIndex++)
     {
+    int n = this->GetMarkupIndexFromSeedIndex(fiducialNode, seedIndex);
+    if (n < 0 || n >= fiducialNode->GetNumberOfMarkups())
+      {
+      continue;
+      }
     double worldCoordinates1[4];
     bool thisPositionChanged = false;
     // 2D widget was changed
 
     double displayCoordinates1[4];
-    seedRepresentation->GetSeedDisplayPosition(n,displayCoordinates1);
+    seedRepresentation->GetSeedDisplayPosition(seedIndex,displayCoordinates1);
     vtkDebugMacro("PropagateWidgetToMRML: 2d DM: widget display coords = "
           << displayCoordinates1[0] << ", " << displayCoordinates1[1]
           << ", " << displayCoordinates1[2]);
@@ -1353,6 +1652,53 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::AdditionnalInitializeStep()
   // don't add the key press event, as it triggers a crash on start up
   //vtkDebugMacro("Adding an observer on the key press event");
   this->AddInteractorStyleObservableEvent(vtkCommand::KeyPressEvent);
+  // show the handle of the glyph under the mouse cursor
+  this->AddInteractorObservableEvent(vtkCommand::MouseMoveEvent);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::OnInteractorEvent(int eventid)
+{
+  this->Superclass::OnInteractorEvent(eventid);
+
+  if (eventid != vtkCommand::MouseMoveEvent ||
+      this->Helper->GlyphActors.empty())
+    {
+    return;
+    }
+
+  int *eventPosition = this->GetInteractor()->GetEventPosition();
+  bool activeGlyphChanged = false;
+  // copy the nodes as SetActiveGlyph may modify the map
+  std::vector<vtkMRMLMarkupsNode*> glyphNodes;
+  vtkMRMLMarkupsDisplayableManagerHelper::GlyphActorsIt it;
+  for (it = this->Helper->GlyphActors.begin(); it != this->Helper->GlyphActors.end(); ++it)
+    {
+    glyphNodes.push_back(it->first);
+    }
+  for (unsigned int i = 0; i < glyphNodes.size(); ++i)
+    {
+    vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(glyphNodes[i]);
+    vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+    vtkSeedWidget *seedWidget = vtkSeedWidget::SafeDownCast(this->Helper->GetWidget(fiducialNode));
+    if (!fiducialNode || !glyphActors || !seedWidget ||
+        !seedWidget->GetEnabled() ||
+        seedWidget->GetWidgetState() == vtkSeedWidget::MovingSeed)
+      {
+      // keep the handle that is being dragged
+      continue;
+      }
+    vtkIdType pointId = glyphActors->FindPoint(eventPosition[0], eventPosition[1]);
+    if (pointId != glyphActors->GetActivePointId())
+      {
+      this->SetActiveGlyph(fiducialNode, static_cast<int>(pointId));
+      activeGlyphChanged = true;
+      }
+    }
+  if (activeGlyphChanged)
+    {
+    this->RequestRender();
+    }
 }
 
 
@@ -1454,6 +1800,28 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::UpdatePosition(vtkAbstractWidge
   //this->Updating = 0;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n)
+{
+  vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (!glyphActors)
+    {
+    this->Superclass::OnMRMLMarkupsPointModifiedEvent(node, n);
+    return;
+    }
+  // only move the glyphs and the active handle instead of visiting all the
+  // fiducials widgets
+  this->UpdateGlyphActors(fiducialNode);
+  vtkAbstractWidget *widget = this->Helper->GetWidget(fiducialNode);
+  vtkIdType activePointId = glyphActors->GetActivePointId();
+  if (widget && activePointId >= 0 && (n < 0 || n == activePointId))
+    {
+    this->UpdateNthSeedPositionFromMRML(static_cast<int>(activePointId), widget, fiducialNode);
+    }
+  this->RequestRender();
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLSceneEndClose()
 {
@@ -1487,7 +1855,15 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLMarkupsNodeNthMarkupModif
    vtkErrorMacro("OnMRMLMarkupsNodeNthMarkupModifiedEvent: Could not get seed widget!")
    return;
    }
-  this->SetNthSeed(n, vtkMRMLMarkupsFiducialNode::SafeDownCast(node), seedWidget);
+  vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  if (fiducialNode && this->Helper->GetGlyphActors(node))
+    {
+    // visibility on the slice depends on the position, update all the glyphs
+    this->PropagateMRMLToWidget(node, widget);
+    this->RequestRender();
+    return;
+    }
+  this->SetNthSeed(n, fiducialNode, seedWidget);
 }
 
 //---------------------------------------------------------------------------
@@ -1514,6 +1890,14 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLMarkupsNodeMarkupAddedEve
     this->AddWidget(markupsNode);
     return;
     }
+  if (this->Helper->GetGlyphActors(markupsNode) ||
+      this->UseGlyphRendering(markupsNode))
+    {
+    // only the glyphs need to be updated
+    this->PropagateMRMLToWidget(markupsNode, widget);
+    this->RequestRender();
+    return;
+    }
 
   vtkSeedWidget* seedWidget = vtkSeedWidget::SafeDownCast(widget);
   if (!seedWidget)
@@ -24,6 +24,7 @@
 // MarkupsModule/MRMLDisplayableManager includes
 #include "vtkMRMLMarkupsDisplayableManager2D.h"
 
+class vtkMarkupsGlyphActors;
 class vtkMRMLMarkupsFiducialNode;
 class vtkSlicerViewerWidget;
 class vtkMRMLMarkupsDisplayNode;
@@ -45,9 +46,20 @@ public:
   /// Update a single markup position from the seed widget, return true if the position changed
   virtual bool UpdateNthMarkupPositionFromWidget(int n, vtkMRMLMarkupsNode* pointsNode, vtkAbstractWidget * widget) VTK_OVERRIDE;
 
+  /// Nodes with more fiducials than this threshold are drawn by a single glyph
+  /// actor and a single label actor, and only the fiducial under the mouse
+  /// cursor gets an interactive handle. Not used in light box mode.
+  /// Default is 500.
+  vtkSetMacro(GlyphRenderingThreshold, int);
+  vtkGetMacro(GlyphRenderingThreshold, int);
+
+  /// Return the index of the fiducial moved by the nth seed of the node widget,
+  /// -1 if there is none.
+  int GetMarkupIndexFromSeedIndex(vtkMRMLMarkupsNode* node, int seedIndex);
+
 protected:
 
-  vtkMRMLMarkupsFiducialDisplayableManager2D(){this->Focus="vtkMRMLMarkupsFiducialNode";}
+  vtkMRMLMarkupsFiducialDisplayableManager2D(){this->Focus="vtkMRMLMarkupsFiducialNode";this->GlyphRenderingThreshold=500;}
   virtual ~vtkMRMLMarkupsFiducialDisplayableManager2D(){}
 
   /// Callback for click in RenderWindow
@@ -79,6 +91,29 @@ protected:
 
   /// Respond to control point modified events
   virtual void UpdatePosition(vtkAbstractWidget *widget, vtkMRMLNode *node) VTK_OVERRIDE;
+  /// Only move the glyphs and the handle when drawing with glyphs
+  virtual void OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n) VTK_OVERRIDE;
+
+  /// Observe mouse moves to show the handle of the fiducial under the cursor
+  virtual void OnInteractorEvent(int eventid) VTK_OVERRIDE;
+
+  /// Return true if the node has too many fiducials to be drawn with one
+  /// handle per fiducial
+  bool UseGlyphRendering(vtkMRMLMarkupsNode* node);
+  /// Return the index of the seed showing the nth fiducial, -1 if the
+  /// fiducial is drawn by a glyph
+  int GetSeedIndexFromMarkupIndex(vtkMRMLMarkupsNode* node, int n);
+  /// Create or update the glyph actors drawing the fiducials of the node,
+  /// the fiducials are projected to the XY coordinates of the slice view and
+  /// only those close to the slice are drawn. If slice projection is on, the
+  /// other fiducials are drawn by the projection glyph actors.
+  vtkMarkupsGlyphActors* UpdateGlyphActors(vtkMRMLMarkupsFiducialNode* fiducialNode);
+  /// Get or create the glyph actors drawing the projections of the fiducials
+  /// that are in front of or behind the slice
+  vtkMarkupsGlyphActors* GetOrCreateProjectionGlyphActors(vtkMRMLMarkupsFiducialNode* fiducialNode, bool behindSlice);
+  /// Show the nth fiducial with the handle of the node widget instead of a
+  /// glyph, remove the handle if n < 0
+  void SetActiveGlyph(vtkMRMLMarkupsFiducialNode* fiducialNode, int n);
 
   // Clean up when scene closes
   virtual void OnMRMLSceneEndClose() VTK_OVERRIDE;
@@ -88,6 +123,7 @@ private:
   vtkMRMLMarkupsFiducialDisplayableManager2D(const vtkMRMLMarkupsFiducialDisplayableManager2D&); /// Not implemented
   void operator=(const vtkMRMLMarkupsFiducialDisplayableManager2D&); /// Not Implemented
 
+  int GlyphRenderingThreshold;
 };
 
 #endif
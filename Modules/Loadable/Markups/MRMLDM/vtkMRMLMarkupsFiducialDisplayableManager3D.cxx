@@ -24,6 +24,7 @@
 #include "vtkMRMLMarkupsFiducialDisplayableManager3D.h"
 
 // MarkupsModule/VTKWidgets includes
+#include <vtkMarkupsGlyphActors.h>
 #include <vtkMarkupsGlyphSource2D.h>
 
 // MRMLDisplayableManager includes
@@ -33,11 +34,13 @@
 #include <vtkMRMLInteractionNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLTransformNode.h>
 #include <vtkMRMLViewNode.h>
 
 // VTK includes
 #include <vtkAbstractWidget.h>
 #include <vtkFollower.h>
+#include <vtkGeneralTransform.h>
 #include <vtkHandleRepresentation.h>
 #include <vtkInteractorStyle.h>
 #include <vtkMath.h>
@@ -45,6 +48,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkOrientedPolygonalHandleRepresentation3D.h>
 #include <vtkPickingManager.h>
+#include <vtkPoints.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
@@ -53,10 +57,12 @@
 #include <vtkSmartPointer.h>
 #include <vtkSeedRepresentation.h>
 #include <vtkSphereSource.h>
+#include <vtkTextProperty.h>
 
 // STD includes
 #include <sstream>
 #include <string>
+#include <vector>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLMarkupsFiducialDisplayableManager3D);
@@ -107,7 +113,7 @@ public:
       // If calldata is NULL, invoking an event may cause a crash (e.g., Python observer
       // tries to dereference the NULL pointer), therefore it's important to always pass a valid pointer
       // and indicate invalidity with value (-1).
-      this->LastInteractionEventMarkupIndex = (callData ? *(reinterpret_cast<int *>(callData)) : -1);
+      this->LastInteractionEventMarkupIndex = this->GetMarkupIndex(callData);
       this->PointMovedSinceStartInteraction = false;
       this->Node->InvokeEvent(vtkMRMLMarkupsNode::PointStartInteractionEvent, &this->LastInteractionEventMarkupIndex);
       // no need to propagate to MRML, just notify external observers that the user selected a markup
@@ -125,7 +131,7 @@ public:
         {
         // Most of the time vtkCommand::EndInteractionEvent does not provide
         // seed index, but in case we get a value then update the markup index.
-        this->LastInteractionEventMarkupIndex = *(reinterpret_cast<int *>(callData));
+        this->LastInteractionEventMarkupIndex = this->GetMarkupIndex(callData);
         }
       this->Node->InvokeEvent(vtkMRMLMarkupsNode::PointEndInteractionEvent, &this->LastInteractionEventMarkupIndex);
       if (!this->PointMovedSinceStartInteraction)
@@ -142,6 +148,19 @@ public:
     this->DisplayableManager->PropagateWidgetToMRML(this->Widget, this->Node);
   }
 
+  /// Return the index of the markup moved by the seed passed as call data
+  int GetMarkupIndex(void *callData)
+  {
+    int seedIndex = (callData ? *(reinterpret_cast<int *>(callData)) : -1);
+    vtkMRMLMarkupsFiducialDisplayableManager3D *fiducialDisplayableManager =
+      vtkMRMLMarkupsFiducialDisplayableManager3D::SafeDownCast(this->DisplayableManager);
+    if (seedIndex < 0 || !fiducialDisplayableManager)
+      {
+      return seedIndex;
+      }
+    return fiducialDisplayableManager->GetMarkupIndexFromSeedIndex(this->Node, seedIndex);
+  }
+
   void SetWidget(vtkAbstractWidget *w)
     {
     this->Widget = w;
@@ -169,9 +188,154 @@ public:
 void vtkMRMLMarkupsFiducialDisplayableManager3D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "GlyphRenderingThreshold: " << this->GlyphRenderingThreshold << "\n";
   this->Helper->PrintSelf(os, indent);
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsFiducialDisplayableManager3D::UseGlyphRendering(vtkMRMLMarkupsNode* node)
+{
+  return node && node->GetNumberOfMarkups() > this->GlyphRenderingThreshold;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLMarkupsFiducialDisplayableManager3D::GetMarkupIndexFromSeedIndex(vtkMRMLMarkupsNode* node, int seedIndex)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(node);
+  if (!glyphActors)
+    {
+    return seedIndex;
+    }
+  // the only seed shows the active glyph
+  return (seedIndex == 0 ? static_cast<int>(glyphActors->GetActivePointId()) : -1);
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLMarkupsFiducialDisplayableManager3D::GetSeedIndexFromMarkupIndex(vtkMRMLMarkupsNode* node, int n)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(node);
+  if (!glyphActors)
+    {
+    return n;
+    }
+  return (n >= 0 && n == glyphActors->GetActivePointId() ? 0 : -1);
+}
+
+//---------------------------------------------------------------------------
+vtkMarkupsGlyphActors* vtkMRMLMarkupsFiducialDisplayableManager3D::UpdateGlyphActors(vtkMRMLMarkupsFiducialNode* fiducialNode)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (!glyphActors)
+    {
+    vtkNew<vtkMarkupsGlyphActors> newGlyphActors;
+    newGlyphActors->SetRenderer(this->GetRenderer());
+    this->Helper->RecordGlyphActorsForNode(newGlyphActors.GetPointer(), fiducialNode);
+    glyphActors = newGlyphActors.GetPointer();
+    }
+
+  this->UpdateGlyphPoints(fiducialNode, glyphActors);
+
+  vtkMRMLMarkupsDisplayNode *displayNode = fiducialNode->GetMarkupsDisplayNode();
+  bool listVisible = true;
+  vtkMRMLViewNode *viewNode = this->GetMRMLViewNode();
+  if (!displayNode ||
+      (viewNode && displayNode->GetVisibility(viewNode->GetID()) == 0) ||
+      displayNode->GetVisibility() == 0)
+    {
+    listVisible = false;
+    }
+
+  int numberOfFiducials = fiducialNode->GetNumberOfMarkups();
+  for (int n = 0; n < numberOfFiducials; n++)
+    {
+    glyphActors->SetNthPointVisibility(n, listVisible && fiducialNode->GetNthFiducialVisibility(n));
+    glyphActors->SetNthPointSelected(n, fiducialNode->GetNthFiducialSelected(n));
+    glyphActors->SetNthPointLabel(n, fiducialNode->GetNthFiducialLabel(n));
+    }
+
+  if (displayNode)
+    {
+    glyphActors->SetGlyphType(displayNode->GetGlyphType());
+    glyphActors->SetGlyphSize(displayNode->GetGlyphScale());
+    glyphActors->SetColor(displayNode->GetColor());
+    glyphActors->SetSelectedColor(displayNode->GetSelectedColor());
+    glyphActors->SetOpacity(displayNode->GetOpacity());
+
+    vtkProperty *prop = glyphActors->GetProperty();
+    prop->SetAmbient(displayNode->GetAmbient());
+    prop->SetDiffuse(displayNode->GetDiffuse());
+    prop->SetSpecular(displayNode->GetSpecular());
+
+    // the labels have the color of their fiducial
+    vtkTextProperty *textProperty = glyphActors->GetLabelTextProperty();
+    textProperty->SetFontSize(static_cast<int>(displayNode->GetTextScale() * 4.0));
+    }
+  return glyphActors;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager3D::UpdateGlyphPoints(vtkMRMLMarkupsNode* node, vtkMarkupsGlyphActors* glyphActors)
+{
+  vtkPoints *markupPoints = node->GetAllMarkupPoints();
+  int numberOfFiducials = node->GetNumberOfMarkups();
+  vtkMRMLTransformNode *transformNode = node->GetParentTransformNode();
+  if (!transformNode &&
+      markupPoints->GetNumberOfPoints() == numberOfFiducials)
+    {
+    // one point per fiducial in world coordinates, no need for a copy
+    glyphActors->SetPoints(markupPoints);
+    return;
+    }
+
+  vtkNew<vtkPoints> worldPoints;
+  if (markupPoints->GetNumberOfPoints() == numberOfFiducials)
+    {
+    vtkNew<vtkGeneralTransform> transformToWorld;
+    transformNode->GetTransformToWorld(transformToWorld.GetPointer());
+    transformToWorld->TransformPoints(markupPoints, worldPoints.GetPointer());
+    }
+  else
+    {
+    worldPoints->SetNumberOfPoints(numberOfFiducials);
+    for (int n = 0; n < numberOfFiducials; n++)
+      {
+      double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+      if (node->GetNumberOfPointsInNthMarkup(n) > 0)
+        {
+        node->GetMarkupPointWorld(n, 0, worldCoordinates);
+        }
+      worldPoints->SetPoint(n, worldCoordinates);
+      }
+    }
+  glyphActors->SetPoints(worldPoints.GetPointer());
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager3D::SetActiveGlyph(vtkMRMLMarkupsFiducialNode* fiducialNode, int n)
+{
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  vtkSeedWidget *seedWidget = vtkSeedWidget::SafeDownCast(this->Helper->GetWidget(fiducialNode));
+  if (!glyphActors || !seedWidget)
+    {
+    return;
+    }
+  glyphActors->SetActivePointId(n);
+  if (n < 0)
+    {
+    vtkSeedRepresentation *seedRepresentation = vtkSeedRepresentation::SafeDownCast(seedWidget->GetRepresentation());
+    while (seedRepresentation && seedRepresentation->GetNumberOfSeeds() > 0)
+      {
+      seedWidget->DeleteSeed(0);
+      }
+    }
+  else
+    {
+    this->SetNthSeed(n, fiducialNode, seedWidget);
+    }
+  seedWidget->GetRepresentation()->NeedToRenderOn();
+  seedWidget->Modified();
+}
+
 //---------------------------------------------------------------------------
 /// Create a new widget.
 vtkAbstractWidget * vtkMRMLMarkupsFiducialDisplayableManager3D::CreateWidget(vtkMRMLMarkupsNode* node)
@@ -285,6 +449,12 @@ bool vtkMRMLMarkupsFiducialDisplayableManager3D::UpdateNthSeedPositionFromMRML(i
     {
     return false;
     }
+  int seedIndex = this->GetSeedIndexFromMarkupIndex(pointsNode, n);
+  if (seedIndex < 0 || seedIndex >= seedRepresentation->GetNumberOfSeeds())
+    {
+    // drawn by a glyph
+    return false;
+    }
   bool positionChanged = false;
 
   // transform fiducial point using parent transforms
@@ -293,7 +463,7 @@ bool vtkMRMLMarkupsFiducialDisplayableManager3D::UpdateNthSeedPositionFromMRML(i
 
   // for 3d managers, compare world positions
   double seedWorldCoord[4];
-  seedRepresentation->GetSeedWorldPosition(n,seedWorldCoord);
+  seedRepresentation->GetSeedWorldPosition(seedIndex,seedWorldCoord);
 
   if (this->GetWorldCoordinatesChanged(seedWorldCoord, fidWorldCoord))
     {
@@ -305,7 +475,7 @@ bool vtkMRMLMarkupsFiducialDisplayableManager3D::UpdateNthSeedPositionFromMRML(i
                   << fidWorldCoord[0] << ", "
                   << fidWorldCoord[1] << ", "
                   << fidWorldCoord[2]);
-    seedRepresentation->GetHandleRepresentation(n)->SetWorldPosition(fidWorldCoord);
+    seedRepresentation->GetHandleRepresentation(seedIndex)->SetWorldPosition(fidWorldCoord);
     positionChanged = true;
     }
   else
@@ -334,12 +504,19 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
     return;
     }
 
+  // when drawing glyphs, only the active fiducial has a handle
+  int seedIndex = this->GetSeedIndexFromMarkupIndex(fiducialNode, n);
+  if (seedIndex < 0)
+    {
+    return;
+    }
+
   int numberOfHandles = seedRepresentation->GetNumberOfSeeds();
   vtkDebugMacro("SetNthSeed, n = " << n << ", number of handles = " << numberOfHandles);
 
   // does this handle need to be created?
   bool createdNewHandle = false;
-  if (n >= numberOfHandles)
+  if (seedIndex >= numberOfHandles)
     {
     // create a new handle
     vtkHandleWidget* newhandle = seedWidget->CreateNewHandle();
@@ -368,14 +545,14 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
     }
 
   vtkOrientedPolygonalHandleRepresentation3D *handleRep =
-    vtkOrientedPolygonalHandleRepresentation3D::SafeDownCast(seedRepresentation->GetHandleRepresentation(n));
+    vtkOrientedPolygonalHandleRepresentation3D::SafeDownCast(seedRepresentation->GetHandleRepresentation(seedIndex));
   if (!handleRep)
     {
     vtkErrorMacro("Failed to get an oriented polygonal handle rep for n = "
           << n << ", number of seeds = "
           << seedRepresentation->GetNumberOfSeeds()
           << ", handle rep = "
-          << (seedRepresentation->GetHandleRepresentation(n) ? seedRepresentation->GetHandleRepresentation(n)->GetClassName() : "null"));
+          << (seedRepresentation->GetHandleRepresentation(seedIndex) ? seedRepresentation->GetHandleRepresentation(seedIndex)->GetClassName() : "null"));
     return;
     }
 
@@ -404,7 +581,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
       {
       handleRep->LabelVisibilityOn();
       }
-    seedWidget->GetSeed(n)->EnabledOn();
+    seedWidget->GetSeed(seedIndex)->EnabledOn();
     }
   else
     {
@@ -412,7 +589,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
     handleRep->HandleVisibilityOff();
     handleRep->DisablePicking();
     handleRep->LabelVisibilityOff();
-    seedWidget->GetSeed(n)->EnabledOff();
+    seedWidget->GetSeed(seedIndex)->EnabledOff();
     }
 
   // update locked
@@ -429,7 +606,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
       (interactionNode->GetCurrentInteractionMode() == vtkMRMLInteractionNode::Place)
       && (interactionNode->GetPlaceModePersistence() == 1);
     }
-  vtkHandleWidget *seed = seedWidget->GetSeed(n);
+  vtkHandleWidget *seed = seedWidget->GetSeed(seedIndex);
   if (listLocked || persistentPlaceMode)
     {
     seed->ProcessEventsOff();
@@ -441,7 +618,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
     }
 
   // set the glyph type if a new handle was created, or the glyph type changed
-  int oldGlyphType = this->Helper->GetNodeGlyphType(displayNode, n);
+  int oldGlyphType = this->Helper->GetNodeGlyphType(displayNode, seedIndex);
   if (createdNewHandle ||
       oldGlyphType != displayNode->GetGlyphType())
     {
@@ -483,7 +660,7 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::SetNthSeed(int n, vtkMRMLMarkup
       }
     // TBD: keep with the assumption of one glyph type per markups node,
     // but they may have different glyphs during update
-    this->Helper->SetNodeGlyphType(displayNode, displayNode->GetGlyphType(), n);
+    this->Helper->SetNodeGlyphType(displayNode, displayNode->GetGlyphType(), seedIndex);
     }  // end of glyph type
 
   // update the text display properties if there is text
@@ -591,10 +768,42 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::PropagateMRMLToWidget(vtkMRMLMa
 
   vtkDebugMacro("Fids PropagateMRMLToWidget, node num markups = " << numberOfFiducials);
 
-  for (int n = 0; n < numberOfFiducials; n++)
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (this->UseGlyphRendering(fiducialNode))
     {
-    // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
-    this->SetNthSeed(n, fiducialNode, seedWidget);
+    if (!glyphActors)
+      {
+      // switch from one handle per fiducial to glyphs
+      glyphActors = this->UpdateGlyphActors(fiducialNode);
+      this->SetActiveGlyph(fiducialNode, -1);
+      }
+    else
+      {
+      this->UpdateGlyphActors(fiducialNode);
+      }
+    vtkIdType activePointId = glyphActors->GetActivePointId();
+    if (activePointId >= 0 && !glyphActors->GetNthPointVisibility(activePointId))
+      {
+      this->SetActiveGlyph(fiducialNode, -1);
+      }
+    else if (activePointId >= 0)
+      {
+      this->SetNthSeed(static_cast<int>(activePointId), fiducialNode, seedWidget);
+      }
+    }
+  else
+    {
+    if (glyphActors)
+      {
+      // switch from glyphs to one handle per fiducial
+      this->SetActiveGlyph(fiducialNode, -1);
+      this->Helper->RemoveGlyphActors(fiducialNode);
+      }
+    for (int n = 0; n < numberOfFiducials; n++)
+      {
+      // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
+      this->SetNthSeed(n, fiducialNode, seedWidget);
+      }
     }
 
   // update lock status
@@ -660,10 +869,15 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::PropagateWidgetToMRML(vtkAbstra
   int numberOfSeeds = seedRepresentation->GetNumberOfSeeds();
 
   bool positionChanged = false;
-  for (int n = 0; n < numberOfSeeds; n++)
+  for (int seedIndex = 0; seedIndex < numberOfSeeds; seedIndex++)
     {
+    int n = this->GetMarkupIndexFromSeedIndex(fiducialNode, seedIndex);
+    if (n < 0 || n >= fiducialNode->GetNumberOfMarkups())
+      {
+      continue;
+      }
     double worldCoordinates1[4];
-    seedRepresentation->GetSeedWorldPosition(n,worldCoordinates1);
+    seedRepresentation->GetSeedWorldPosition(seedIndex,worldCoordinates1);
     vtkDebugMacro("PropagateWidgetToMRML: 3d: widget seed " << n
           << " world coords = " << worldCoordinates1[0] << ", "
           << worldCoordinates1[1] << ", "<< worldCoordinates1[2]);
@@ -829,6 +1043,53 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::AdditionnalInitializeStep()
   // don't add the key press event, as it triggers a crash on start up
   //vtkDebugMacro("Adding an observer on the key press event");
   this->AddInteractorStyleObservableEvent(vtkCommand::KeyPressEvent);
+  // show the handle of the glyph under the mouse cursor
+  this->AddInteractorObservableEvent(vtkCommand::MouseMoveEvent);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager3D::OnInteractorEvent(int eventid)
+{
+  this->Superclass::OnInteractorEvent(eventid);
+
+  if (eventid != vtkCommand::MouseMoveEvent ||
+      this->Helper->GlyphActors.empty())
+    {
+    return;
+    }
+
+  int *eventPosition = this->GetInteractor()->GetEventPosition();
+  bool activeGlyphChanged = false;
+  // copy the nodes as SetActiveGlyph may modify the map
+  std::vector<vtkMRMLMarkupsNode*> glyphNodes;
+  vtkMRMLMarkupsDisplayableManagerHelper::GlyphActorsIt it;
+  for (it = this->Helper->GlyphActors.begin(); it != this->Helper->GlyphActors.end(); ++it)
+    {
+    glyphNodes.push_back(it->first);
+    }
+  for (unsigned int i = 0; i < glyphNodes.size(); ++i)
+    {
+    vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(glyphNodes[i]);
+    vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+    vtkSeedWidget *seedWidget = vtkSeedWidget::SafeDownCast(this->Helper->GetWidget(fiducialNode));
+    if (!fiducialNode || !glyphActors || !seedWidget ||
+        !seedWidget->GetEnabled() ||
+        seedWidget->GetWidgetState() == vtkSeedWidget::MovingSeed)
+      {
+      // keep the handle that is being dragged
+      continue;
+      }
+    vtkIdType pointId = glyphActors->FindPoint(eventPosition[0], eventPosition[1]);
+    if (pointId != glyphActors->GetActivePointId())
+      {
+      this->SetActiveGlyph(fiducialNode, static_cast<int>(pointId));
+      activeGlyphChanged = true;
+      }
+    }
+  if (activeGlyphChanged)
+    {
+    this->RequestRender();
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -921,6 +1182,28 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::UpdatePosition(vtkAbstractWidge
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager3D::OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n)
+{
+  vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(fiducialNode);
+  if (!glyphActors)
+    {
+    this->Superclass::OnMRMLMarkupsPointModifiedEvent(node, n);
+    return;
+    }
+  // only move the glyphs and the active handle instead of visiting all the
+  // fiducials
+  this->UpdateGlyphPoints(fiducialNode, glyphActors);
+  vtkAbstractWidget *widget = this->Helper->GetWidget(fiducialNode);
+  vtkIdType activePointId = glyphActors->GetActivePointId();
+  if (widget && activePointId >= 0 && (n < 0 || n == activePointId))
+    {
+    this->UpdateNthSeedPositionFromMRML(static_cast<int>(activePointId), widget, fiducialNode);
+    }
+  this->RequestRender();
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsFiducialDisplayableManager3D::OnMRMLSceneEndClose()
 {
@@ -951,7 +1234,21 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::OnMRMLMarkupsNodeNthMarkupModif
    vtkErrorMacro("OnMRMLMarkupsNodeNthMarkupModifiedEvent: Could not get seed widget!")
    return;
    }
-  this->SetNthSeed(n, vtkMRMLMarkupsFiducialNode::SafeDownCast(node), seedWidget);
+  vtkMRMLMarkupsFiducialNode *fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  vtkMarkupsGlyphActors *glyphActors = this->Helper->GetGlyphActors(node);
+  if (glyphActors && fiducialNode)
+    {
+    vtkMRMLMarkupsDisplayNode *displayNode = fiducialNode->GetMarkupsDisplayNode();
+    vtkMRMLViewNode *viewNode = this->GetMRMLViewNode();
+    bool visible = displayNode && displayNode->GetVisibility() &&
+      (!viewNode || displayNode->GetVisibility(viewNode->GetID())) &&
+      fiducialNode->GetNthFiducialVisibility(n);
+    glyphActors->SetNthPointVisibility(n, visible);
+    glyphActors->SetNthPointSelected(n, fiducialNode->GetNthFiducialSelected(n));
+    glyphActors->SetNthPointLabel(n, fiducialNode->GetNthFiducialLabel(n));
+    this->RequestRender();
+    }
+  this->SetNthSeed(n, fiducialNode, seedWidget);
 }
 
 //---------------------------------------------------------------------------
@@ -977,6 +1274,14 @@ void vtkMRMLMarkupsFiducialDisplayableManager3D::OnMRMLMarkupsNodeMarkupAddedEve
     this->AddWidget(markupsNode);
     return;
     }
+  if (this->Helper->GetGlyphActors(markupsNode) ||
+      this->UseGlyphRendering(markupsNode))
+    {
+    // only the glyphs need to be updated
+    this->PropagateMRMLToWidget(markupsNode, widget);
+    this->RequestRender();
+    return;
+    }
 
   vtkSeedWidget* seedWidget = vtkSeedWidget::SafeDownCast(widget);
   if (!seedWidget)
@@ -24,6 +24,7 @@
 // MarkupsModule/MRMLDisplayableManager includes
 #include "vtkMRMLMarkupsDisplayableManager3D.h"
 
+class vtkMarkupsGlyphActors;
 class vtkMRMLMarkupsFiducialNode;
 class vtkSlicerViewerWidget;
 class vtkMRMLMarkupsDisplayNode;
@@ -39,9 +40,19 @@ public:
   vtkTypeMacro(vtkMRMLMarkupsFiducialDisplayableManager3D, vtkMRMLMarkupsDisplayableManager3D);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  /// Nodes with more fiducials than this threshold are drawn by a single glyph
+  /// actor and a single label actor, and only the fiducial under the mouse
+  /// cursor gets an interactive handle. Default is 500.
+  vtkSetMacro(GlyphRenderingThreshold, int);
+  vtkGetMacro(GlyphRenderingThreshold, int);
+
+  /// Return the index of the fiducial moved by the nth seed of the node widget,
+  /// -1 if there is none.
+  int GetMarkupIndexFromSeedIndex(vtkMRMLMarkupsNode* node, int seedIndex);
+
 protected:
 
-  vtkMRMLMarkupsFiducialDisplayableManager3D(){this->Focus="vtkMRMLMarkupsFiducialNode";}
+  vtkMRMLMarkupsFiducialDisplayableManager3D(){this->Focus="vtkMRMLMarkupsFiducialNode";this->GlyphRenderingThreshold=500;}
   virtual ~vtkMRMLMarkupsFiducialDisplayableManager3D(){}
 
   /// Callback for click in RenderWindow
@@ -75,6 +86,25 @@ protected:
   virtual bool UpdateNthSeedPositionFromMRML(int n, vtkAbstractWidget *widget, vtkMRMLMarkupsNode *pointsNode) VTK_OVERRIDE;
   /// Respond to control point modified events
   virtual void UpdatePosition(vtkAbstractWidget *widget, vtkMRMLNode *node) VTK_OVERRIDE;
+  /// Only move the glyphs and the handle when drawing with glyphs
+  virtual void OnMRMLMarkupsPointModifiedEvent(vtkMRMLNode *node, int n) VTK_OVERRIDE;
+
+  /// Observe mouse moves to show the handle of the fiducial under the cursor
+  virtual void OnInteractorEvent(int eventid) VTK_OVERRIDE;
+
+  /// Return true if the node has too many fiducials to be drawn with one
+  /// handle per fiducial
+  bool UseGlyphRendering(vtkMRMLMarkupsNode* node);
+  /// Return the index of the seed showing the nth fiducial, -1 if the
+  /// fiducial is drawn by a glyph
+  int GetSeedIndexFromMarkupIndex(vtkMRMLMarkupsNode* node, int n);
+  /// Create or update the glyph actors drawing the fiducials of the node
+  vtkMarkupsGlyphActors* UpdateGlyphActors(vtkMRMLMarkupsFiducialNode* fiducialNode);
+  /// Set the world positions of the fiducials to the glyph actors
+  void UpdateGlyphPoints(vtkMRMLMarkupsNode* node, vtkMarkupsGlyphActors* glyphActors);
+  /// Show the nth fiducial with the handle of the node widget instead of a
+  /// glyph, remove the handle if n < 0
+  void SetActiveGlyph(vtkMRMLMarkupsFiducialNode* fiducialNode, int n);
 
   // Clean up when scene closes
   virtual void OnMRMLSceneEndClose() VTK_OVERRIDE;
@@ -83,6 +113,8 @@ private:
 
   vtkMRMLMarkupsFiducialDisplayableManager3D(const vtkMRMLMarkupsFiducialDisplayableManager3D&); /// Not implemented
   void operator=(const vtkMRMLMarkupsFiducialDisplayableManager3D&); /// Not Implemented
+
+  int GlyphRenderingThreshold;
 };
 
 #endif
@@ -0,0 +1,135 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLCoreTestingUtilities.h"
+#include "vtkMRMLMarkupsDisplayNode.h"
+#include "vtkMRMLMarkupsFiducialNode.h"
+#include "vtkMRMLMarkupsFiducialStorageNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+
+using namespace vtkMRMLCoreTestingUtilities;
+
+//----------------------------------------------------------------------------
+// test writing and reading large fiducial files, with timings.
+// Usage: vtkMRMLMarkupsFiducialStorageNodeTest4 fileName [numberOfMarkups]
+int vtkMRMLMarkupsFiducialStorageNodeTest4(int argc, char * argv[] )
+{
+  std::string fileName = "markupsFiducialStorageNodeBenchmark.fcsv";
+  if (argc > 1)
+    {
+    fileName = argv[1];
+    }
+  int numberOfMarkups = 100000;
+  if (argc > 2)
+    {
+    numberOfMarkups = atoi(argv[2]);
+    }
+  CHECK_BOOL(numberOfMarkups > 1, true);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLMarkupsFiducialStorageNode> storageNode;
+  vtkNew<vtkMRMLMarkupsFiducialNode> markupsNode;
+  vtkNew<vtkMRMLMarkupsDisplayNode> displayNode;
+  scene->AddNode(storageNode.GetPointer());
+  scene->AddNode(markupsNode.GetPointer());
+  scene->AddNode(displayNode.GetPointer());
+  markupsNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  markupsNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  storageNode->SetFileName(fileName.c_str());
+
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(numberOfMarkups);
+  for (int i = 0; i < numberOfMarkups; ++i)
+    {
+    points->SetPoint(i, i * 0.5, -i * 0.1, 100. + i * 1e-4);
+    }
+  markupsNode->AddPointsToNewMarkups(points.GetPointer());
+  // a few markups need escaping or have other properties
+  markupsNode->SetNthMarkupLabel(1, "label, with comma");
+  markupsNode->SetNthMarkupDescription(1, "\"fully quoted\"");
+  markupsNode->SetNthMarkupAssociatedNodeID(1, "vtkMRMLScalarVolumeNode1");
+  markupsNode->SetNthMarkupLocked(1, true);
+  markupsNode->SetNthMarkupVisibility(1, false);
+  std::string lastID = markupsNode->GetNthMarkupID(numberOfMarkups - 1);
+  std::string lastLabel = markupsNode->GetNthMarkupLabel(numberOfMarkups - 1);
+
+  vtkNew<vtkTimerLog> timer;
+
+  timer->StartTimer();
+  CHECK_INT(storageNode->WriteData(markupsNode.GetPointer()), 1);
+  timer->StopTimer();
+  double writeTime = timer->GetElapsedTime();
+
+  vtkNew<vtkMRMLMarkupsFiducialNode> readNode;
+  scene->AddNode(readNode.GetPointer());
+  readNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  readNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  vtkNew<vtkMRMLNodeCallback> callback;
+  readNode->AddObserver(vtkCommand::AnyEvent, callback.GetPointer());
+
+  timer->StartTimer();
+  CHECK_INT(storageNode->ReadData(readNode.GetPointer()), 1);
+  timer->StopTimer();
+  double readTime = timer->GetElapsedTime();
+
+  // the markups are added at once
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLMarkupsNode::MarkupAddedEvent), 1);
+  CHECK_INT(callback->GetNumberOfModified(), 1);
+
+  CHECK_INT(readNode->GetNumberOfMarkups(), numberOfMarkups);
+  CHECK_STD_STRING(readNode->GetNthMarkupLabel(1), "label, with comma");
+  CHECK_STD_STRING(readNode->GetNthMarkupDescription(1), "\"fully quoted\"");
+  CHECK_STD_STRING(readNode->GetNthMarkupAssociatedNodeID(1), "vtkMRMLScalarVolumeNode1");
+  CHECK_BOOL(readNode->GetNthMarkupLocked(1), true);
+  CHECK_BOOL(readNode->GetNthMarkupVisibility(1), false);
+  CHECK_STD_STRING(readNode->GetNthMarkupID(numberOfMarkups - 1), lastID);
+  CHECK_STD_STRING(readNode->GetNthMarkupLabel(numberOfMarkups - 1), lastLabel);
+  CHECK_INT(readNode->GetMarkupIndexByID(lastID.c_str()), numberOfMarkups - 1);
+  // the coordinates are written with enough digits to be read back
+  for (int i = 0; i < numberOfMarkups; ++i)
+    {
+    double point[3];
+    readNode->GetMarkupPoint(i, 0, point);
+    double* expectedPoint = points->GetPoint(i);
+    CHECK_DOUBLE_TOLERANCE(point[0], expectedPoint[0], 1e-9);
+    CHECK_DOUBLE_TOLERANCE(point[1], expectedPoint[1], 1e-9);
+    CHECK_DOUBLE_TOLERANCE(point[2], expectedPoint[2], 1e-9);
+    }
+
+  // reading again replaces the markups
+  CHECK_INT(storageNode->ReadData(readNode.GetPointer()), 1);
+  CHECK_INT(readNode->GetNumberOfMarkups(), numberOfMarkups);
+
+  std::cout << "<DartMeasurement name=\"WriteFiducialsTime\" type=\"numeric/double\">"
+            << writeTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"ReadFiducialsTime\" type=\"numeric/double\">"
+            << readTime << "</DartMeasurement>" << std::endl;
+  std::cout << numberOfMarkups << " markups: written in " << writeTime
+            << "s, read in " << readTime << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
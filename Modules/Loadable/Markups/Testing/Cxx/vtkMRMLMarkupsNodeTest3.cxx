@@ -0,0 +1,216 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLCoreTestingUtilities.h"
+#include "vtkMRMLMarkupsNode.h"
+
+// VTK includes
+#include <vtkIdList.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+using namespace vtkMRMLCoreTestingUtilities;
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Check that the shared points and the ID index match the markups
+int checkMarkups(vtkMRMLMarkupsNode* node)
+{
+  vtkPoints* points = node->GetAllMarkupPoints();
+  vtkIdType pointId = 0;
+  for (int m = 0; m < node->GetNumberOfMarkups(); ++m)
+    {
+    CHECK_INT(static_cast<int>(node->GetNthMarkupFirstPointIndex(m)), static_cast<int>(pointId));
+    for (int p = 0; p < node->GetNumberOfPointsInNthMarkup(m); ++p)
+      {
+      double expected[3];
+      node->GetMarkupPoint(m, p, expected);
+      double* actual = points->GetPoint(pointId++);
+      CHECK_DOUBLE(actual[0], expected[0]);
+      CHECK_DOUBLE(actual[1], expected[1]);
+      CHECK_DOUBLE(actual[2], expected[2]);
+      }
+    std::string id = node->GetNthMarkupID(m);
+    CHECK_INT(node->GetMarkupIndexByID(id.c_str()), m);
+    CHECK_POINTER(node->GetMarkupByID(id.c_str()), node->GetNthMarkup(m));
+    }
+  CHECK_INT(static_cast<int>(points->GetNumberOfPoints()), static_cast<int>(pointId));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testEditing()
+{
+  vtkNew<vtkMRMLMarkupsNode> node;
+  vtkPoints* points = node->GetAllMarkupPoints();
+  CHECK_NOT_NULL(points);
+  CHECK_INT(static_cast<int>(points->GetNumberOfPoints()), 0);
+
+  for (int i = 0; i < 5; ++i)
+    {
+    node->AddMarkupWithNPoints(i % 3);
+    }
+  node->SetMarkupPoint(1, 0, 1., 2., 3.);
+  node->SetMarkupPoint(4, 0, 4., 5., 6.);
+  node->AddPointToNthMarkup(vtkVector3d(7., 8., 9.), 1);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+  // The points are kept in the same object
+  CHECK_POINTER(node->GetAllMarkupPoints(), points);
+
+  Markup markup;
+  node->InitMarkup(&markup);
+  markup.points.push_back(vtkVector3d(-1., -2., -3.));
+  CHECK_BOOL(node->InsertMarkup(markup, 2), true);
+  CHECK_INT(node->GetMarkupIndexByID(markup.ID.c_str()), 2);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  node->SwapMarkups(0, 5);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  node->RemoveMarkup(1);
+  CHECK_INT(node->GetMarkupIndexByID(markup.ID.c_str()), 1);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  // IDs generated without scene are based on the number of added markups
+  node->AddPointToNewMarkup(vtkVector3d(0., 0., 0.));
+  CHECK_BOOL(node->ResetNthMarkupID(0), true);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  CHECK_INT(node->GetMarkupIndexByID("nonexistent"), -1);
+  CHECK_NULL(node->GetMarkupByID("nonexistent"));
+
+  vtkNew<vtkMRMLMarkupsNode> copy;
+  copy->Copy(node.GetPointer());
+  CHECK_EXIT_SUCCESS(checkMarkups(copy.GetPointer()));
+  CHECK_INT(static_cast<int>(copy->GetAllMarkupPoints()->GetNumberOfPoints()),
+            static_cast<int>(points->GetNumberOfPoints()));
+
+  vtkNew<vtkTransform> transform;
+  transform->Translate(10., 0., -10.);
+  node->ApplyTransform(transform.GetPointer());
+  CHECK_DOUBLE(node->GetMarkupPointVector(0, 0).GetX(), copy->GetMarkupPointVector(0, 0).GetX() + 10.);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  node->RemoveAllMarkups();
+  CHECK_INT(static_cast<int>(points->GetNumberOfPoints()), 0);
+  CHECK_INT(node->GetMarkupIndexByID(markup.ID.c_str()), -1);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testBatchEditing()
+{
+  vtkNew<vtkMRMLMarkupsNode> node;
+  vtkNew<vtkMRMLNodeCallback> callback;
+  node->AddObserver(vtkCommand::AnyEvent, callback.GetPointer());
+
+  vtkNew<vtkPoints> newPoints;
+  for (int i = 0; i < 10; ++i)
+    {
+    newPoints->InsertNextPoint(i, 2 * i, 3 * i);
+    }
+  CHECK_INT(node->AddPointsToNewMarkups(newPoints.GetPointer()), 0);
+  CHECK_INT(node->AddPointsToNewMarkups(newPoints.GetPointer()), 10);
+  CHECK_INT(node->GetNumberOfMarkups(), 20);
+  CHECK_INT(callback->GetNumberOfModified(), 2);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLMarkupsNode::MarkupAddedEvent), 2);
+  CHECK_DOUBLE(node->GetMarkupPointVector(13, 0).GetY(), 6.);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  callback->ResetNumberOfEvents();
+  vtkNew<vtkPoints> movedPoints;
+  movedPoints->SetDataTypeToFloat();
+  for (int i = 0; i < 20; ++i)
+    {
+    movedPoints->InsertNextPoint(-i, 0., i);
+    }
+  CHECK_BOOL(node->SetAllMarkupPoints(movedPoints.GetPointer()), true);
+  CHECK_INT(callback->GetNumberOfModified(), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLMarkupsNode::PointModifiedEvent), 1);
+  CHECK_DOUBLE(node->GetMarkupPointVector(13, 0).GetX(), -13.);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(node->SetAllMarkupPoints(newPoints.GetPointer()), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  callback->ResetNumberOfEvents();
+  std::string lastID = node->GetNthMarkupID(19);
+  vtkNew<vtkIdList> removed;
+  removed->InsertNextId(0);
+  removed->InsertNextId(5);
+  removed->InsertNextId(6);
+  removed->InsertNextId(5);
+  node->RemoveMarkups(removed.GetPointer());
+  CHECK_INT(node->GetNumberOfMarkups(), 17);
+  CHECK_INT(callback->GetNumberOfModified(), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLMarkupsNode::MarkupRemovedEvent), 1);
+  CHECK_INT(node->GetMarkupIndexByID(lastID.c_str()), 16);
+  CHECK_DOUBLE(node->GetMarkupPointVector(5, 0).GetX(), -8.);
+  CHECK_EXIT_SUCCESS(checkMarkups(node.GetPointer()));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int benchmark(int numberOfMarkups)
+{
+  vtkNew<vtkMRMLMarkupsNode> node;
+  vtkNew<vtkTimerLog> timer;
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfMarkups; ++i)
+    {
+    node->AddPointToNewMarkup(vtkVector3d(i, 0., 0.));
+    }
+  timer->StopTimer();
+  double addTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfMarkups; ++i)
+    {
+    std::string id = node->GetNthMarkupID(i);
+    CHECK_INT(node->GetMarkupIndexByID(id.c_str()), i);
+    }
+  timer->StopTimer();
+  double lookupTime = timer->GetElapsedTime();
+
+  std::cout << "<DartMeasurement name=\"AddMarkupsTime\" type=\"numeric/double\">"
+            << addTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"LookupMarkupsByIDTime\" type=\"numeric/double\">"
+            << lookupTime << "</DartMeasurement>" << std::endl;
+  std::cout << numberOfMarkups << " markups: added in " << addTime
+            << "s, all looked up by ID in " << lookupTime << "s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// test ID lookup, shared points and batch editing
+int vtkMRMLMarkupsNodeTest3(int , char * [] )
+{
+  CHECK_EXIT_SUCCESS(testEditing());
+  CHECK_EXIT_SUCCESS(testBatchEditing());
+  CHECK_EXIT_SUCCESS(benchmark(50000));
+  return EXIT_SUCCESS;
+}
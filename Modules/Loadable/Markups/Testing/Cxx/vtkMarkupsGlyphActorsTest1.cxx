@@ -0,0 +1,207 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MarkupsModule/VTKWidgets includes
+#include "vtkMarkupsGlyphActors.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLMarkupsDisplayNode.h"
+
+// VTK includes
+#include <vtkActor2D.h>
+#include <vtkActor2DCollection.h>
+#include <vtkCamera.h>
+#include <vtkDataSet.h>
+#include <vtkLabeledDataMapper.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkTextProperty.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Return the number of labels drawn in the renderer with the given color
+int CountLabels(vtkRenderer* renderer, const double color[3])
+{
+  int count = 0;
+  vtkActor2DCollection* actors = renderer->GetActors2D();
+  actors->InitTraversal();
+  for (vtkActor2D* actor = actors->GetNextActor2D(); actor; actor = actors->GetNextActor2D())
+    {
+    vtkLabeledDataMapper* mapper = vtkLabeledDataMapper::SafeDownCast(actor->GetMapper());
+    if (!mapper || !actor->GetVisibility())
+      {
+      continue;
+      }
+    double* labelColor = mapper->GetLabelTextProperty()->GetColor();
+    if (labelColor[0] == color[0] && labelColor[1] == color[1] && labelColor[2] == color[2])
+      {
+      count += static_cast<int>(mapper->GetInput()->GetNumberOfPoints());
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int TestViewportCoordinates(vtkRenderer* renderer)
+{
+  vtkNew<vtkMarkupsGlyphActors> glyphActors;
+  glyphActors->ViewportCoordinatesOn();
+  glyphActors->SetRenderer(renderer);
+  glyphActors->SetGlyphType(vtkMRMLMarkupsDisplayNode::Circle2D);
+  glyphActors->SetGlyphSize(5.0);
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 0);
+  CHECK_INT(glyphActors->FindPoint(50, 50), -1);
+
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(10.0, 10.0, 0.0);
+  points->InsertNextPoint(50.0, 50.0, 0.0);
+  points->InsertNextPoint(90.0, 90.0, 0.0);
+  points->InsertNextPoint(52.0, 50.0, 0.0);
+  glyphActors->SetPoints(points.GetPointer());
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 4);
+
+  // Hidden points are neither drawn nor found
+  glyphActors->SetNthPointVisibility(0, false);
+  CHECK_BOOL(glyphActors->GetNthPointVisibility(0), false);
+  CHECK_BOOL(glyphActors->GetNthPointVisibility(3), true);
+  CHECK_BOOL(glyphActors->GetNthPointVisibility(4), false);
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 3);
+  CHECK_INT(glyphActors->FindPoint(10, 10), -1);
+
+  // Closest point within the tolerance
+  CHECK_INT(glyphActors->FindPoint(49, 50), 1);
+  CHECK_INT(glyphActors->FindPoint(54, 51), 3);
+  CHECK_INT(glyphActors->FindPoint(89, 92), 2);
+  CHECK_INT(glyphActors->FindPoint(70, 70), -1);
+  glyphActors->SetTolerance(1.0);
+  CHECK_INT(glyphActors->FindPoint(88, 90), -1);
+  glyphActors->SetTolerance(10.0);
+
+  // The active point is shown by a handle instead of a glyph, and it is kept
+  // while the position is within the tolerance
+  glyphActors->SetActivePointId(1);
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 2);
+  CHECK_INT(glyphActors->FindPoint(53, 50), 1);
+  glyphActors->SetActivePointId(-1);
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 3);
+  CHECK_INT(glyphActors->FindPoint(53, 50), 3);
+
+  // Points modified in place are drawn at their new position
+  points->SetPoint(2, 20.0, 20.0, 0.0);
+  points->Modified();
+  CHECK_INT(glyphActors->FindPoint(21, 20), 2);
+  CHECK_INT(glyphActors->FindPoint(89, 92), -1);
+
+  // Labels have the color of their point
+  const double color[3] = {0.0, 1.0, 0.0};
+  const double selectedColor[3] = {1.0, 0.5, 0.0};
+  glyphActors->SetColor(color[0], color[1], color[2]);
+  glyphActors->SetSelectedColor(selectedColor[0], selectedColor[1], selectedColor[2]);
+  glyphActors->GetLabelTextProperty()->SetColor(0.0, 0.0, 1.0);
+  glyphActors->SetNthPointLabel(0, "F-1");
+  glyphActors->SetNthPointLabel(1, "F-2");
+  glyphActors->SetNthPointLabel(2, "F-3");
+  glyphActors->SetNthPointSelected(2, true);
+  glyphActors->Update();
+  CHECK_INT(CountLabels(renderer, color), 1);
+  CHECK_INT(CountLabels(renderer, selectedColor), 1);
+  glyphActors->SetNthPointSelected(1, true);
+  glyphActors->Update();
+  CHECK_INT(CountLabels(renderer, color), 0);
+  CHECK_INT(CountLabels(renderer, selectedColor), 2);
+  glyphActors->SetNthPointVisibility(0, true);
+  glyphActors->Update();
+  CHECK_INT(CountLabels(renderer, color), 1);
+
+  // Outlined glyphs
+  CHECK_BOOL(glyphActors->GetFilled(), true);
+  glyphActors->FilledOff();
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 4);
+
+  renderer->GetRenderWindow()->Render();
+
+  // The actors are removed from the renderer
+  glyphActors->SetRenderer(NULL);
+  CHECK_INT(CountLabels(renderer, selectedColor), 0);
+  CHECK_INT(glyphActors->FindPoint(21, 20), -1);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestWorldCoordinates(vtkRenderer* renderer)
+{
+  vtkNew<vtkMarkupsGlyphActors> glyphActors;
+  glyphActors->SetRenderer(renderer);
+  glyphActors->SetGlyphType(vtkMRMLMarkupsDisplayNode::Sphere3D);
+
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(0.0, 0.0, 0.0);
+  points->InsertNextPoint(20.0, 0.0, 0.0);
+  points->InsertNextPoint(0.0, -30.0, 10.0);
+  glyphActors->SetPoints(points.GetPointer());
+  glyphActors->SetNthPointLabel(1, "F-2");
+  CHECK_INT(glyphActors->GetNumberOfDrawnPoints(), 3);
+
+  // Parallel projection of the XY plane, one world unit per pixel and the
+  // origin in the center of the 100x100 view
+  vtkCamera* camera = renderer->GetActiveCamera();
+  camera->ParallelProjectionOn();
+  camera->SetPosition(0.0, 0.0, 100.0);
+  camera->SetFocalPoint(0.0, 0.0, 0.0);
+  camera->SetViewUp(0.0, 1.0, 0.0);
+  camera->SetParallelScale(50.0);
+  renderer->ResetCameraClippingRange(-50.0, 50.0, -50.0, 50.0, -50.0, 50.0);
+
+  CHECK_INT(glyphActors->FindPoint(50, 50), 0);
+  CHECK_INT(glyphActors->FindPoint(68, 52), 1);
+  CHECK_INT(glyphActors->FindPoint(50, 22), 2);
+  CHECK_INT(glyphActors->FindPoint(50, 35), -1);
+
+  // Turning the camera moves the points in display coordinates: the X axis
+  // is up and the Y axis is to the left
+  camera->SetViewUp(1.0, 0.0, 0.0);
+  CHECK_INT(glyphActors->FindPoint(68, 52), -1);
+  CHECK_INT(glyphActors->FindPoint(50, 68), 1);
+  CHECK_INT(glyphActors->FindPoint(78, 50), 2);
+
+  renderer->GetRenderWindow()->Render();
+  glyphActors->SetRenderer(NULL);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMarkupsGlyphActorsTest1(int , char * [] )
+{
+  vtkNew<vtkMarkupsGlyphActors> glyphActors;
+  EXERCISE_BASIC_OBJECT_METHODS(glyphActors.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(100, 100);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  CHECK_EXIT_SUCCESS(TestViewportCoordinates(renderer.GetPointer()));
+  CHECK_EXIT_SUCCESS(TestWorldCoordinates(renderer.GetPointer()));
+  return EXIT_SUCCESS;
+}
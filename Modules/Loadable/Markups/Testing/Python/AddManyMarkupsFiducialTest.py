@@ -244,6 +244,8 @@ class AddManyMarkupsFiducialTestTest(unittest.TestCase):
     """
     self.setUp()
     self.test_AddManyMarkupsFiducialTest1()
+    self.setUp()
+    self.test_AddManyMarkupsFiducialTest2()
 
   def test_AddManyMarkupsFiducialTest1(self):
 
@@ -261,3 +263,84 @@ class AddManyMarkupsFiducialTestTest(unittest.TestCase):
     logic.run(100,100)
 
     self.delayDisplay('Test passed!')
+
+  def fiducialDisplayableManager(self, view, className):
+    managers = vtk.vtkCollection()
+    view.getDisplayableManagers(managers)
+    for i in range(managers.GetNumberOfItems()):
+      manager = managers.GetItemAsObject(i)
+      if manager.GetClassName() == className:
+        return manager
+    return None
+
+  def numberOfGlyphs(self, glyphActors):
+    # the fiducial under the mouse cursor is drawn by a handle
+    activeGlyphs = 1 if glyphActors.GetActivePointId() >= 0 else 0
+    return glyphActors.GetNumberOfDrawnPoints() + activeGlyphs
+
+  def test_AddManyMarkupsFiducialTest2(self):
+    """Add more fiducials than the glyph rendering threshold of the displayable
+    managers, they are drawn by glyph actors instead of one handle each.
+    """
+    self.delayDisplay("Starting the glyph rendering test")
+
+    layoutManager = slicer.app.layoutManager()
+    layoutManager.setLayout(slicer.vtkMRMLLayoutNode.SlicerLayoutFourUpView)
+
+    # fiducials from S = 0 to S = 999
+    numToAdd = 1000
+    logic = AddManyMarkupsFiducialTestLogic()
+    logic.run(numToAdd, 0, 1)
+    fidNode = slicer.mrmlScene.GetFirstNodeByClass('vtkMRMLMarkupsFiducialNode')
+    displayNode = fidNode.GetDisplayNode()
+    slicer.app.processEvents()
+
+    # 3D view: all the fiducials are drawn by the glyph actors
+    threeDManager = self.fiducialDisplayableManager(
+      layoutManager.threeDWidget(0).threeDView(), 'vtkMRMLMarkupsFiducialDisplayableManager3D')
+    self.assertIsNotNone(threeDManager)
+    self.assertLess(threeDManager.GetGlyphRenderingThreshold(), numToAdd)
+    glyphActors = threeDManager.GetHelper().GetGlyphActors(fidNode)
+    self.assertIsNotNone(glyphActors)
+    self.assertEqual(self.numberOfGlyphs(glyphActors), numToAdd)
+
+    # hidden fiducials are not drawn
+    fidNode.SetNthFiducialVisibility(0, False)
+    slicer.app.processEvents()
+    self.assertEqual(self.numberOfGlyphs(glyphActors), numToAdd - 1)
+    fidNode.SetNthFiducialVisibility(0, True)
+
+    # slice view: only the fiducial on the slice is drawn
+    sliceWidget = layoutManager.sliceWidget('Red')
+    sliceWidget.sliceLogic().SetSliceOffset(100.0)
+    slicer.app.processEvents()
+    sliceManager = self.fiducialDisplayableManager(
+      sliceWidget.sliceView(), 'vtkMRMLMarkupsFiducialDisplayableManager2D')
+    self.assertIsNotNone(sliceManager)
+    helper = sliceManager.GetHelper()
+    glyphActors = helper.GetGlyphActors(fidNode)
+    self.assertIsNotNone(glyphActors)
+    self.assertEqual(self.numberOfGlyphs(glyphActors), 1)
+
+    # the other fiducials are projected on the slice
+    displayNode.SliceProjectionOn()
+    displayNode.SliceProjectionOutlinedBehindSlicePlaneOn()
+    slicer.app.processEvents()
+    frontProjections = helper.GetProjectionGlyphActors(fidNode, False)
+    behindProjections = helper.GetProjectionGlyphActors(fidNode, True)
+    self.assertIsNotNone(frontProjections)
+    self.assertIsNotNone(behindProjections)
+    self.assertEqual(frontProjections.GetNumberOfDrawnPoints(), numToAdd - 101)
+    self.assertEqual(behindProjections.GetNumberOfDrawnPoints(), 100)
+    self.assertFalse(behindProjections.GetFilled())
+    displayNode.SliceProjectionOff()
+    slicer.app.processEvents()
+    self.assertIsNone(helper.GetProjectionGlyphActors(fidNode, False))
+
+    # below the threshold, the fiducials are drawn with one handle each
+    threeDManager.SetGlyphRenderingThreshold(numToAdd)
+    fidNode.Modified()
+    slicer.app.processEvents()
+    self.assertIsNone(threeDManager.GetHelper().GetGlyphActors(fidNode))
+
+    self.delayDisplay('Test passed!')
@@ -0,0 +1,637 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MarkupsModule/VTKWidgets includes
+#include "vtkMarkupsGlyphActors.h"
+#include "vtkMarkupsGlyphSource2D.h"
+
+// MRML includes
+#include <vtkMRMLMarkupsDisplayNode.h>
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkActor2D.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkCellData.h>
+#include <vtkGlyph2D.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkLabeledDataMapper.h>
+#include <vtkLabelPlacementMapper.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPointSetToLabelHierarchy.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper2D.h>
+#include <vtkProperty.h>
+#include <vtkRenderer.h>
+#include <vtkSphereSource.h>
+#include <vtkStringArray.h>
+#include <vtkTextProperty.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkUnsignedCharArray.h>
+
+vtkStandardNewMacro(vtkMarkupsGlyphActors);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Projects points to display coordinates with a single matrix instead of
+// going through the renderer coordinate conversions for each point
+struct DisplayProjection
+{
+  bool Initialize(vtkRenderer* renderer, bool viewportCoordinates)
+  {
+    this->ViewportCoordinates = viewportCoordinates;
+    const int* origin = renderer->GetOrigin();
+    this->Origin[0] = origin[0];
+    this->Origin[1] = origin[1];
+    if (viewportCoordinates)
+      {
+      return true;
+      }
+    if (!renderer->IsActiveCameraCreated())
+      {
+      return false;
+      }
+    vtkMatrix4x4* worldToView = renderer->GetActiveCamera()->GetCompositeProjectionTransformMatrix(
+      renderer->GetTiledAspectRatio(), 0.0, 1.0);
+    for (int i = 0; i < 4; ++i)
+      {
+      for (int j = 0; j < 4; ++j)
+        {
+        this->WorldToView[i][j] = worldToView->GetElement(i, j);
+        }
+      }
+    const int* size = renderer->GetSize();
+    this->HalfSize[0] = size[0] / 2.0;
+    this->HalfSize[1] = size[1] / 2.0;
+    return true;
+  }
+
+  /// Squared distance in pixels between a point and a display position,
+  /// returns false if the point is behind the camera
+  bool GetDistance2(const double point[3], double x, double y, double& distance2) const
+  {
+    double dx = 0.0;
+    double dy = 0.0;
+    if (this->ViewportCoordinates)
+      {
+      dx = point[0] + this->Origin[0] - x;
+      dy = point[1] + this->Origin[1] - y;
+      }
+    else
+      {
+      const double (*m)[4] = this->WorldToView;
+      double w = m[3][0] * point[0] + m[3][1] * point[1] + m[3][2] * point[2] + m[3][3];
+      if (w <= 0.0)
+        {
+        return false;
+        }
+      double viewX = (m[0][0] * point[0] + m[0][1] * point[1] + m[0][2] * point[2] + m[0][3]) / w;
+      double viewY = (m[1][0] * point[0] + m[1][1] * point[1] + m[1][2] * point[2] + m[1][3]) / w;
+      dx = (viewX + 1.0) * this->HalfSize[0] + this->Origin[0] - x;
+      dy = (viewY + 1.0) * this->HalfSize[1] + this->Origin[1] - y;
+      }
+    distance2 = dx * dx + dy * dy;
+    return true;
+  }
+
+  bool ViewportCoordinates;
+  double Origin[2];
+  double HalfSize[2];
+  double WorldToView[4][4];
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkMarkupsGlyphActors::vtkMarkupsGlyphActors()
+{
+  this->ViewportCoordinates = false;
+  this->ActivePointId = -1;
+  this->GlyphType = vtkMRMLMarkupsDisplayNode::StarBurst2D;
+  this->GlyphSize = 1.0;
+  this->Color[0] = 1.0;
+  this->Color[1] = 1.0;
+  this->Color[2] = 1.0;
+  this->SelectedColor[0] = 1.0;
+  this->SelectedColor[1] = 0.0;
+  this->SelectedColor[2] = 0.0;
+  this->Opacity = 1.0;
+  this->Filled = true;
+  this->Tolerance = 10.0;
+  this->GlyphSourceType = -1;
+  this->GlyphSourceFilled = true;
+  this->RendererObserverTag = 0;
+
+  this->DrawnPoints = vtkSmartPointer<vtkPoints>::New();
+  this->DrawnPoints->SetDataTypeToDouble();
+  this->DrawnColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  this->DrawnColors->SetName("Colors");
+  this->DrawnColors->SetNumberOfComponents(4);
+  this->DrawnPolyData = vtkSmartPointer<vtkPolyData>::New();
+  this->DrawnPolyData->SetPoints(this->DrawnPoints);
+  this->DrawnPolyData->GetPointData()->SetScalars(this->DrawnColors);
+
+  this->GlyphSource = vtkSmartPointer<vtkPolyData>::New();
+  this->GlyphTransform = vtkSmartPointer<vtkTransform>::New();
+  this->GlyphTransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  this->GlyphTransformFilter->SetInputData(this->GlyphSource);
+  this->GlyphTransformFilter->SetTransform(this->GlyphTransform);
+
+  // world coordinates: one instance of the glyph per point
+  vtkNew<vtkGlyph3DMapper> glyphMapper;
+  glyphMapper->SetInputData(this->DrawnPolyData);
+  glyphMapper->SetSourceConnection(this->GlyphTransformFilter->GetOutputPort());
+  glyphMapper->ScalingOff();
+  glyphMapper->OrientOff();
+  glyphMapper->SetScalarModeToUsePointData();
+  glyphMapper->SetColorModeToDirectScalars();
+  glyphMapper->ScalarVisibilityOn();
+  this->GlyphActor = vtkSmartPointer<vtkActor>::New();
+  this->GlyphActor->SetMapper(glyphMapper.GetPointer());
+  this->GlyphActor->PickableOff();
+
+  // viewport coordinates: glyphs generated in pixels
+  vtkNew<vtkGlyph2D> glyph2D;
+  glyph2D->SetInputData(this->DrawnPolyData);
+  glyph2D->SetSourceConnection(this->GlyphTransformFilter->GetOutputPort());
+  glyph2D->SetScaleModeToDataScalingOff();
+  glyph2D->SetScaleFactor(1.0);
+  glyph2D->OrientOff();
+  glyph2D->SetColorModeToColorByScalar();
+  vtkNew<vtkPolyDataMapper2D> glyphMapper2D;
+  glyphMapper2D->SetInputConnection(glyph2D->GetOutputPort());
+  glyphMapper2D->SetColorModeToDirectScalars();
+  glyphMapper2D->ScalarVisibilityOn();
+  this->GlyphActor2D = vtkSmartPointer<vtkActor2D>::New();
+  this->GlyphActor2D->SetMapper(glyphMapper2D.GetPointer());
+  this->GlyphActor2D->PickableOff();
+
+  this->LabelTextProperty = vtkSmartPointer<vtkTextProperty>::New();
+  this->LabelTextProperty->SetJustificationToLeft();
+  this->LabelTextProperty->SetVerticalJustificationToCentered();
+  this->LabelTextProperty->SetFontSize(12);
+  for (int i = 0; i < 2; ++i)
+    {
+    LabelSet& labelSet = this->LabelSets[i];
+    labelSet.Points = vtkSmartPointer<vtkPoints>::New();
+    labelSet.Points->SetDataTypeToDouble();
+    labelSet.Labels = vtkSmartPointer<vtkStringArray>::New();
+    labelSet.Labels->SetName("Labels");
+    labelSet.PolyData = vtkSmartPointer<vtkPolyData>::New();
+    labelSet.PolyData->SetPoints(labelSet.Points);
+    labelSet.PolyData->GetPointData()->AddArray(labelSet.Labels);
+    labelSet.TextProperty = vtkSmartPointer<vtkTextProperty>::New();
+    labelSet.Actor = vtkSmartPointer<vtkActor2D>::New();
+    labelSet.Actor->PickableOff();
+    labelSet.Actor->VisibilityOff();
+    }
+
+  this->RendererCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->RendererCallback->SetClientData(this);
+  this->RendererCallback->SetCallback(vtkMarkupsGlyphActors::OnRendererStart);
+}
+
+//----------------------------------------------------------------------------
+vtkMarkupsGlyphActors::~vtkMarkupsGlyphActors()
+{
+  this->SetRenderer(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ViewportCoordinates: " << this->ViewportCoordinates << "\n";
+  os << indent << "Renderer: " << this->Renderer.GetPointer() << "\n";
+  os << indent << "Points: " << this->Points.GetPointer() << "\n";
+  os << indent << "ActivePointId: " << this->ActivePointId << "\n";
+  os << indent << "GlyphType: " << this->GlyphType << "\n";
+  os << indent << "GlyphSize: " << this->GlyphSize << "\n";
+  os << indent << "Color: " << this->Color[0] << ", " << this->Color[1] << ", " << this->Color[2] << "\n";
+  os << indent << "SelectedColor: " << this->SelectedColor[0] << ", "
+     << this->SelectedColor[1] << ", " << this->SelectedColor[2] << "\n";
+  os << indent << "Opacity: " << this->Opacity << "\n";
+  os << indent << "Filled: " << this->Filled << "\n";
+  os << indent << "Tolerance: " << this->Tolerance << "\n";
+  os << indent << "Number of drawn points: " << this->DrawnPointIds.size() << "\n";
+  os << indent << "Number of drawn labels: "
+     << this->LabelSets[0].Points->GetNumberOfPoints() + this->LabelSets[1].Points->GetNumberOfPoints() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::SetRenderer(vtkRenderer* renderer)
+{
+  if (this->Renderer == renderer)
+    {
+    return;
+    }
+  if (this->Renderer)
+    {
+    this->Renderer->RemoveViewProp(this->GlyphActor);
+    this->Renderer->RemoveViewProp(this->GlyphActor2D);
+    this->Renderer->RemoveViewProp(this->LabelSets[0].Actor);
+    this->Renderer->RemoveViewProp(this->LabelSets[1].Actor);
+    this->Renderer->RemoveObserver(this->RendererObserverTag);
+    this->RendererObserverTag = 0;
+    }
+  this->Renderer = renderer;
+  if (this->Renderer)
+    {
+    if (!this->LabelSets[0].Actor->GetMapper())
+      {
+      this->CreateLabelMapper(this->LabelSets[0]);
+      this->CreateLabelMapper(this->LabelSets[1]);
+      }
+    if (this->ViewportCoordinates)
+      {
+      this->Renderer->AddViewProp(this->GlyphActor2D);
+      }
+    else
+      {
+      this->Renderer->AddViewProp(this->GlyphActor);
+      }
+    this->Renderer->AddViewProp(this->LabelSets[0].Actor);
+    this->Renderer->AddViewProp(this->LabelSets[1].Actor);
+    this->RendererObserverTag = this->Renderer->AddObserver(
+      vtkCommand::StartEvent, this->RendererCallback);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::CreateLabelMapper(LabelSet& labelSet)
+{
+  if (this->ViewportCoordinates)
+    {
+    // only the points on the slice are drawn, no need to cull labels
+    vtkNew<vtkLabeledDataMapper> labelMapper;
+    labelMapper->SetInputData(labelSet.PolyData);
+    labelMapper->SetLabelModeToLabelFieldData();
+    labelMapper->SetFieldDataName("Labels");
+    labelMapper->SetLabelTextProperty(labelSet.TextProperty);
+    labelMapper->SetCoordinateSystem(vtkLabeledDataMapper::DISPLAY);
+    labelSet.Actor->SetMapper(labelMapper.GetPointer());
+    }
+  else
+    {
+    // overlapping labels are culled, which keeps rendering fast when
+    // many points are in view
+    vtkNew<vtkPointSetToLabelHierarchy> labelHierarchy;
+    labelHierarchy->SetInputData(labelSet.PolyData);
+    labelHierarchy->SetLabelArrayName("Labels");
+    labelHierarchy->SetTextProperty(labelSet.TextProperty);
+    vtkNew<vtkLabelPlacementMapper> labelMapper;
+    labelMapper->SetInputConnection(labelHierarchy->GetOutputPort());
+    labelSet.Actor->SetMapper(labelMapper.GetPointer());
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkRenderer* vtkMarkupsGlyphActors::GetRenderer()
+{
+  return this->Renderer;
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::SetPoints(vtkPoints* points)
+{
+  // always modified: the points may have been replaced in place
+  this->Points = points;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkPoints* vtkMarkupsGlyphActors::GetPoints()
+{
+  return this->Points;
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::SetNthPointVisibility(vtkIdType n, bool visible)
+{
+  if (n < 0)
+    {
+    return;
+    }
+  if (static_cast<vtkIdType>(this->PointHidden.size()) <= n)
+    {
+    if (visible)
+      {
+      return;
+      }
+    this->PointHidden.resize(n + 1, false);
+    }
+  if (this->PointHidden[n] != !visible)
+    {
+    this->PointHidden[n] = !visible;
+    this->Modified();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMarkupsGlyphActors::GetNthPointVisibility(vtkIdType n)
+{
+  if (n < 0 || (this->Points && n >= this->Points->GetNumberOfPoints()))
+    {
+    return false;
+    }
+  return n >= static_cast<vtkIdType>(this->PointHidden.size()) || !this->PointHidden[n];
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::SetNthPointSelected(vtkIdType n, bool selected)
+{
+  if (n < 0)
+    {
+    return;
+    }
+  if (static_cast<vtkIdType>(this->PointSelected.size()) <= n)
+    {
+    if (!selected)
+      {
+      return;
+      }
+    this->PointSelected.resize(n + 1, false);
+    }
+  if (this->PointSelected[n] != selected)
+    {
+    this->PointSelected[n] = selected;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::SetNthPointLabel(vtkIdType n, const std::string& label)
+{
+  if (n < 0)
+    {
+    return;
+    }
+  if (static_cast<vtkIdType>(this->PointLabels.size()) <= n)
+    {
+    if (label.empty())
+      {
+      return;
+      }
+    this->PointLabels.resize(n + 1);
+    }
+  if (this->PointLabels[n] != label)
+    {
+    this->PointLabels[n] = label;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkProperty* vtkMarkupsGlyphActors::GetProperty()
+{
+  return this->GlyphActor->GetProperty();
+}
+
+//----------------------------------------------------------------------------
+vtkTextProperty* vtkMarkupsGlyphActors::GetLabelTextProperty()
+{
+  return this->LabelTextProperty;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkMarkupsGlyphActors::GetNumberOfDrawnPoints()
+{
+  this->Update();
+  return static_cast<vtkIdType>(this->DrawnPointIds.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::Update()
+{
+  this->UpdateGlyphSource();
+  this->UpdateGlyphTransform();
+
+  vtkMTimeType drawnTime = this->DrawnTime.GetMTime();
+  if (this->GetMTime() <= drawnTime &&
+      this->LabelTextProperty->GetMTime() <= drawnTime &&
+      (!this->Points || this->Points->GetMTime() <= drawnTime))
+    {
+    return;
+    }
+
+  vtkIdType numberOfPoints = this->Points ? this->Points->GetNumberOfPoints() : 0;
+  vtkIdType numberOfHidden = static_cast<vtkIdType>(this->PointHidden.size());
+  vtkIdType numberOfSelected = static_cast<vtkIdType>(this->PointSelected.size());
+  vtkIdType numberOfLabels = static_cast<vtkIdType>(this->PointLabels.size());
+  unsigned char color[4];
+  unsigned char selectedColor[4];
+  for (int i = 0; i < 3; ++i)
+    {
+    color[i] = static_cast<unsigned char>(vtkMath::ClampValue(this->Color[i], 0.0, 1.0) * 255.0);
+    selectedColor[i] = static_cast<unsigned char>(vtkMath::ClampValue(this->SelectedColor[i], 0.0, 1.0) * 255.0);
+    }
+  color[3] = static_cast<unsigned char>(vtkMath::ClampValue(this->Opacity, 0.0, 1.0) * 255.0);
+  selectedColor[3] = color[3];
+
+  this->DrawnPointIds.clear();
+  this->DrawnPoints->Reset();
+  this->DrawnColors->Reset();
+  for (int i = 0; i < 2; ++i)
+    {
+    this->LabelSets[i].Points->Reset();
+    this->LabelSets[i].Labels->Reset();
+    }
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    if (pointId == this->ActivePointId ||
+        (pointId < numberOfHidden && this->PointHidden[pointId]))
+      {
+      continue;
+      }
+    double* point = this->Points->GetPoint(pointId);
+    this->DrawnPointIds.push_back(pointId);
+    this->DrawnPoints->InsertNextPoint(point);
+    bool selected = (pointId < numberOfSelected && this->PointSelected[pointId]);
+    this->DrawnColors->InsertNextTypedTuple(selected ? selectedColor : color);
+    if (pointId < numberOfLabels && !this->PointLabels[pointId].empty())
+      {
+      LabelSet& labelSet = this->LabelSets[selected ? 1 : 0];
+      labelSet.Points->InsertNextPoint(point);
+      labelSet.Labels->InsertNextValue(this->PointLabels[pointId]);
+      }
+    }
+  this->DrawnPoints->Modified();
+  this->DrawnColors->Modified();
+  this->DrawnPolyData->Modified();
+
+  this->GlyphActor2D->GetProperty()->SetOpacity(this->Opacity);
+  for (int i = 0; i < 2; ++i)
+    {
+    LabelSet& labelSet = this->LabelSets[i];
+    labelSet.Points->Modified();
+    labelSet.Labels->Modified();
+    labelSet.PolyData->Modified();
+    labelSet.TextProperty->ShallowCopy(this->LabelTextProperty);
+    labelSet.TextProperty->SetColor(i == 0 ? this->Color : this->SelectedColor);
+    labelSet.TextProperty->SetOpacity(this->Opacity);
+    labelSet.Actor->SetVisibility(labelSet.Points->GetNumberOfPoints() > 0);
+    }
+  this->DrawnTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::UpdateGlyphSource()
+{
+  if (this->GlyphSourceType == this->GlyphType &&
+      this->GlyphSourceFilled == this->Filled)
+    {
+    return;
+    }
+  if (!this->ViewportCoordinates && this->GlyphType == vtkMRMLMarkupsDisplayNode::Sphere3D)
+    {
+    vtkNew<vtkSphereSource> sphereSource;
+    sphereSource->SetRadius(0.5);
+    sphereSource->SetPhiResolution(10);
+    sphereSource->SetThetaResolution(10);
+    sphereSource->Update();
+    this->GlyphSource->DeepCopy(sphereSource->GetOutput());
+    }
+  else
+    {
+    // 3D glyphs are drawn with the closest 2D glyph, as the handles do
+    int glyphType = this->GlyphType;
+    if (glyphType == vtkMRMLMarkupsDisplayNode::Sphere3D)
+      {
+      glyphType = vtkMRMLMarkupsDisplayNode::Circle2D;
+      }
+    else if (glyphType == vtkMRMLMarkupsDisplayNode::Diamond3D)
+      {
+      glyphType = vtkMRMLMarkupsDisplayNode::Diamond2D;
+      }
+    vtkNew<vtkMarkupsGlyphSource2D> glyphSource;
+    glyphSource->SetGlyphType(glyphType);
+    glyphSource->SetScale(1.0);
+    glyphSource->SetFilled(this->Filled ? 1 : 0);
+    glyphSource->Update();
+    this->GlyphSource->DeepCopy(glyphSource->GetOutput());
+    }
+  // the colors come from the points
+  this->GlyphSource->GetCellData()->Initialize();
+  this->GlyphSourceType = this->GlyphType;
+  this->GlyphSourceFilled = this->Filled;
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::UpdateGlyphTransform()
+{
+  vtkCamera* camera = NULL;
+  if (!this->ViewportCoordinates && this->Renderer && this->Renderer->IsActiveCameraCreated())
+    {
+    camera = this->Renderer->GetActiveCamera();
+    }
+  vtkMTimeType transformTime = this->GlyphTransformTime.GetMTime();
+  if (this->GetMTime() <= transformTime &&
+      (!camera || camera->GetMTime() <= transformTime))
+    {
+    return;
+    }
+
+  this->GlyphTransform->Identity();
+  if (camera)
+    {
+    // same orientation as a vtkFollower: the glyph plane faces the camera
+    double viewUp[3];
+    double directionOfProjection[3];
+    camera->GetViewUp(viewUp);
+    camera->GetDirectionOfProjection(directionOfProjection);
+    double rz[3] = {-directionOfProjection[0], -directionOfProjection[1], -directionOfProjection[2]};
+    double rx[3];
+    double ry[3];
+    vtkMath::Cross(viewUp, rz, rx);
+    vtkMath::Normalize(rx);
+    vtkMath::Cross(rz, rx, ry);
+    vtkNew<vtkMatrix4x4> rotation;
+    for (int i = 0; i < 3; ++i)
+      {
+      rotation->SetElement(i, 0, rx[i]);
+      rotation->SetElement(i, 1, ry[i]);
+      rotation->SetElement(i, 2, rz[i]);
+      }
+    this->GlyphTransform->Concatenate(rotation.GetPointer());
+    }
+  this->GlyphTransform->Scale(this->GlyphSize, this->GlyphSize, this->GlyphSize);
+  this->GlyphTransformTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkMarkupsGlyphActors::FindPoint(double x, double y)
+{
+  this->Update();
+  if (!this->Renderer || !this->Points)
+    {
+    return -1;
+    }
+  DisplayProjection projection;
+  if (!projection.Initialize(this->Renderer, this->ViewportCoordinates))
+    {
+    return -1;
+    }
+  double tolerance2 = this->Tolerance * this->Tolerance;
+
+  // the active point keeps the handle as long as the position is close to it
+  if (this->ActivePointId >= 0 && this->ActivePointId < this->Points->GetNumberOfPoints() &&
+      (this->ActivePointId >= static_cast<vtkIdType>(this->PointHidden.size()) ||
+       !this->PointHidden[this->ActivePointId]))
+    {
+    double distance2 = 0.0;
+    if (projection.GetDistance2(this->Points->GetPoint(this->ActivePointId), x, y, distance2) &&
+        distance2 <= tolerance2)
+      {
+      return this->ActivePointId;
+      }
+    }
+
+  double closestDistance2 = tolerance2;
+  vtkIdType closestId = -1;
+  vtkIdType numberOfDrawnPoints = this->DrawnPoints->GetNumberOfPoints();
+  const double* points = numberOfDrawnPoints > 0 ?
+    static_cast<double*>(this->DrawnPoints->GetVoidPointer(0)) : NULL;
+  for (vtkIdType i = 0; i < numberOfDrawnPoints; ++i, points += 3)
+    {
+    double distance2 = 0.0;
+    if (projection.GetDistance2(points, x, y, distance2) &&
+        distance2 <= closestDistance2)
+      {
+      closestDistance2 = distance2;
+      closestId = i;
+      }
+    }
+  return closestId < 0 ? -1 : this->DrawnPointIds[closestId];
+}
+
+//----------------------------------------------------------------------------
+void vtkMarkupsGlyphActors::OnRendererStart(vtkObject* vtkNotUsed(caller),
+  unsigned long vtkNotUsed(eid), void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMarkupsGlyphActors* self = reinterpret_cast<vtkMarkupsGlyphActors*>(clientData);
+  self->Update();
+}
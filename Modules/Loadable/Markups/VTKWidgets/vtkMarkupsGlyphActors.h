@@ -0,0 +1,213 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+///  vtkMarkupsGlyphActors - draws a large set of markup points with one
+/// glyph actor and one label actor
+///
+/// Instead of one handle widget (and one representation and actor) per point,
+/// all the visible points are drawn by a single glyph actor, and their labels
+/// by a single label actor. The points are given once per markup, either in
+/// world coordinates (3D views, where 2D glyphs are turned to face the camera)
+/// or in viewport coordinates (slice views, where the glyphs have a constant
+/// size in pixels).
+///
+/// The drawn points are rebuilt lazily, before rendering or picking, when the
+/// points or their properties have been modified. The active point is not
+/// drawn, so that an interactive handle can be shown in its place. As with
+/// the handles, the labels have the color of their point.
+///
+/// Known limitations compared to one handle per point:
+/// - in world coordinates, overlapping labels are culled instead of all being
+///   drawn on top of each other;
+/// - Diamond3D glyphs are drawn as Diamond2D glyphs facing the camera;
+/// - the points are drawn in a single renderer, the displayable managers keep
+///   one handle per point in light box views.
+
+#ifndef __vtkMarkupsGlyphActors_h
+#define __vtkMarkupsGlyphActors_h
+
+#include "vtkSlicerMarkupsModuleVTKWidgetsExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+class vtkActor;
+class vtkActor2D;
+class vtkCallbackCommand;
+class vtkPoints;
+class vtkPolyData;
+class vtkProperty;
+class vtkRenderer;
+class vtkStringArray;
+class vtkTextProperty;
+class vtkTransform;
+class vtkTransformPolyDataFilter;
+class vtkUnsignedCharArray;
+
+class VTK_SLICER_MARKUPS_MODULE_VTKWIDGETS_EXPORT vtkMarkupsGlyphActors : public vtkObject
+{
+public:
+  static vtkMarkupsGlyphActors *New();
+  vtkTypeMacro(vtkMarkupsGlyphActors, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// If on, the points are in viewport coordinates (the XY coordinates of a
+  /// slice view) and the glyphs and labels are drawn in 2D. Otherwise the
+  /// points are in world coordinates. Must be set before the renderer.
+  /// Off by default.
+  vtkSetMacro(ViewportCoordinates, bool);
+  vtkGetMacro(ViewportCoordinates, bool);
+  vtkBooleanMacro(ViewportCoordinates, bool);
+
+  /// Renderer the glyph and label actors are added to. Setting another
+  /// renderer (or NULL) removes the actors from the previous one.
+  void SetRenderer(vtkRenderer* renderer);
+  vtkRenderer* GetRenderer();
+
+  /// Positions of the points, one per markup. The points are not copied,
+  /// modifying them updates the glyphs at the next render.
+  void SetPoints(vtkPoints* points);
+  vtkPoints* GetPoints();
+
+  /// Per point properties, by default points are visible, not selected and
+  /// have no label.
+  void SetNthPointVisibility(vtkIdType n, bool visible);
+  bool GetNthPointVisibility(vtkIdType n);
+  void SetNthPointSelected(vtkIdType n, bool selected);
+  void SetNthPointLabel(vtkIdType n, const std::string& label);
+
+  /// Point shown by an interactive handle instead of a glyph, -1 if none.
+  vtkSetMacro(ActivePointId, vtkIdType);
+  vtkGetMacro(ActivePointId, vtkIdType);
+
+  /// Glyph shape, one of vtkMRMLMarkupsDisplayNode::GlyphShapes.
+  vtkSetMacro(GlyphType, int);
+  vtkGetMacro(GlyphType, int);
+
+  /// Size of the glyphs, in world units or in pixels for viewport coordinates.
+  vtkSetMacro(GlyphSize, double);
+  vtkGetMacro(GlyphSize, double);
+
+  /// Colors of the unselected and selected points and of their labels, and
+  /// opacity of the glyphs and labels.
+  vtkSetVector3Macro(Color, double);
+  vtkGetVector3Macro(Color, double);
+  vtkSetVector3Macro(SelectedColor, double);
+  vtkGetVector3Macro(SelectedColor, double);
+  vtkSetMacro(Opacity, double);
+  vtkGetMacro(Opacity, double);
+
+  /// If off, 2D glyphs are drawn as outlines. On by default.
+  vtkSetMacro(Filled, bool);
+  vtkGetMacro(Filled, bool);
+  vtkBooleanMacro(Filled, bool);
+
+  /// Material of the glyphs in world coordinates.
+  vtkProperty* GetProperty();
+  /// Text property of the labels. Its color and opacity are ignored, the
+  /// labels are drawn with the color of their point and the opacity.
+  vtkTextProperty* GetLabelTextProperty();
+
+  /// Maximum distance in pixels between a display position and a drawn point
+  /// for FindPoint. Default is 10.
+  vtkSetMacro(Tolerance, double);
+  vtkGetMacro(Tolerance, double);
+
+  /// Return the id of the point that is the closest to the display position
+  /// (x, y) within the tolerance, -1 if there is none. The active point is
+  /// returned first if it is within the tolerance, so that its handle is kept
+  /// while the cursor is on it.
+  vtkIdType FindPoint(double x, double y);
+
+  /// Number of points drawn by the glyph actor.
+  vtkIdType GetNumberOfDrawnPoints();
+
+  /// Rebuild the drawn points if the points or their properties were modified.
+  /// Called before each render and pick.
+  void Update();
+
+protected:
+  vtkMarkupsGlyphActors();
+  virtual ~vtkMarkupsGlyphActors();
+
+  /// Turn the glyphs to face the camera (world coordinates only)
+  void UpdateGlyphTransform();
+  void UpdateGlyphSource();
+
+  /// Labels of the drawn points that are not selected (first set) or selected
+  /// (second set), each set being drawn with the color of its points
+  struct LabelSet
+  {
+    vtkSmartPointer<vtkPolyData> PolyData;
+    vtkSmartPointer<vtkPoints> Points;
+    vtkSmartPointer<vtkStringArray> Labels;
+    vtkSmartPointer<vtkTextProperty> TextProperty;
+    vtkSmartPointer<vtkActor2D> Actor;
+  };
+  void CreateLabelMapper(LabelSet& labelSet);
+
+  static void OnRendererStart(vtkObject* caller, unsigned long eid,
+                              void* clientData, void* callData);
+
+  bool ViewportCoordinates;
+  vtkIdType ActivePointId;
+  int GlyphType;
+  double GlyphSize;
+  double Color[3];
+  double SelectedColor[3];
+  double Opacity;
+  bool Filled;
+  double Tolerance;
+
+  vtkSmartPointer<vtkRenderer> Renderer;
+  vtkSmartPointer<vtkPoints> Points;
+  std::vector<bool> PointHidden;
+  std::vector<bool> PointSelected;
+  std::vector<std::string> PointLabels;
+
+  /// Visible points, their colors, and their ids in Points
+  vtkSmartPointer<vtkPolyData> DrawnPolyData;
+  vtkSmartPointer<vtkPoints> DrawnPoints;
+  vtkSmartPointer<vtkUnsignedCharArray> DrawnColors;
+  std::vector<vtkIdType> DrawnPointIds;
+  LabelSet LabelSets[2];
+  vtkTimeStamp DrawnTime;
+
+  vtkSmartPointer<vtkPolyData> GlyphSource;
+  vtkSmartPointer<vtkTransform> GlyphTransform;
+  vtkSmartPointer<vtkTransformPolyDataFilter> GlyphTransformFilter;
+  int GlyphSourceType;
+  bool GlyphSourceFilled;
+  vtkTimeStamp GlyphTransformTime;
+
+  vtkSmartPointer<vtkActor> GlyphActor;
+  vtkSmartPointer<vtkActor2D> GlyphActor2D;
+  vtkSmartPointer<vtkTextProperty> LabelTextProperty;
+  vtkSmartPointer<vtkCallbackCommand> RendererCallback;
+  unsigned long RendererObserverTag;
+
+private:
+  vtkMarkupsGlyphActors(const vtkMarkupsGlyphActors&); /// Not implemented
+  void operator=(const vtkMarkupsGlyphActors&); /// Not implemented
+};
+
+#endif
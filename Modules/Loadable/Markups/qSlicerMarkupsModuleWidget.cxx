@@ -2988,9 +2988,15 @@ void qSlicerMarkupsModuleWidget::onActiveMarkupsNodePointModifiedEvent(vtkObject
 {
   //qDebug() << "onActiveMarkupsNodePointModifiedEvent";
 
+  if (caller == NULL)
+    {
+    return;
+    }
   // the call data should be the index n
-  if (caller == NULL || callData == NULL)
+  if (callData == NULL)
     {
+    // batch update
+    this->updateWidgetFromMRML();
     return;
     }
   // qDebug() << "\tcaller class = " << caller->GetClassName();
@@ -0,0 +1,127 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations MRMLDM includes
+#include "vtkImageLabelMapToRGBA.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int checkColor(vtkImageData* image, int i, int j, int r, int g, int b, int a)
+{
+  unsigned char* color = static_cast<unsigned char*>(image->GetScalarPointer(i, j, 0));
+  CHECK_INT(color[0], r);
+  CHECK_INT(color[1], g);
+  CHECK_INT(color[2], b);
+  CHECK_INT(color[3], a);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBATest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Label image:
+  //   0 0 0 0 0 0 2
+  //   0 1 1 1 1 0 0
+  //   0 1 1 1 1 0 0
+  //   0 1 1 1 1 0 0
+  //   0 1 1 1 1 0 0
+  //   0 0 0 0 0 0 7
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetExtent(0, 6, 0, 5, 0, 0);
+  labelmap->AllocateScalars(VTK_SHORT, 1);
+  for (int j = 0; j <= 5; ++j)
+    {
+    for (int i = 0; i <= 6; ++i)
+      {
+      short label = (i >= 1 && i <= 4 && j >= 1 && j <= 4) ? 1 : 0;
+      *static_cast<short*>(labelmap->GetScalarPointer(i, j, 0)) = label;
+      }
+    }
+  *static_cast<short*>(labelmap->GetScalarPointer(6, 5, 0)) = 2;
+  *static_cast<short*>(labelmap->GetScalarPointer(6, 0, 0)) = 7;
+
+  vtkNew<vtkImageLabelMapToRGBA> mapper;
+  mapper->SetInputData(labelmap.GetPointer());
+  CHECK_INT(mapper->GetNumberOfLabels(), 0);
+  mapper->SetNumberOfLabels(2);
+  CHECK_INT(mapper->GetNumberOfLabels(), 2);
+
+  // Label 1: semi-transparent red fill over an opaque blue outline
+  const double fill1[4] = { 1.0, 0.0, 0.0, 0.5 };
+  const double outline1[4] = { 0.0, 0.0, 1.0, 1.0 };
+  mapper->SetLabelColors(1, fill1, outline1);
+  CHECK_BOOL(mapper->IsOutlineVisible(1), true);
+  // Label 2: same fill and outline, the outline is not visible
+  const double fill2[4] = { 0.0, 1.0, 0.0, 1.0 };
+  mapper->SetLabelColors(2, fill2, fill2);
+  CHECK_BOOL(mapper->IsOutlineVisible(2), false);
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  mapper->SetLabelColors(3, fill2, fill2);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  mapper->Update();
+  vtkImageData* output = mapper->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(output->GetNumberOfScalarComponents(), 4);
+
+  // Inside the label: fill color
+  CHECK_EXIT_SUCCESS(checkColor(output, 2, 2, 255, 0, 0, 128));
+  CHECK_EXIT_SUCCESS(checkColor(output, 3, 3, 255, 0, 0, 128));
+  // Border of the label: fill color composited over the outline color
+  CHECK_EXIT_SUCCESS(checkColor(output, 1, 1, 128, 0, 128, 255));
+  CHECK_EXIT_SUCCESS(checkColor(output, 4, 2, 128, 0, 128, 255));
+  // Background and out of range labels are transparent
+  CHECK_EXIT_SUCCESS(checkColor(output, 0, 0, 0, 0, 0, 0));
+  CHECK_EXIT_SUCCESS(checkColor(output, 6, 0, 0, 0, 0, 0));
+  // Label on the image border without visible outline
+  CHECK_EXIT_SUCCESS(checkColor(output, 6, 5, 0, 255, 0, 255));
+
+  // Thicker outline: only the 2x2 center of label 1 is filled
+  mapper->SetOutline(2);
+  mapper->Update();
+  CHECK_EXIT_SUCCESS(checkColor(output, 2, 2, 128, 0, 128, 255));
+  mapper->SetOutline(1);
+
+  // Setting the same colors does not modify the filter
+  vtkMTimeType mtime = mapper->GetMTime();
+  mapper->SetLabelColors(1, fill1, outline1);
+  CHECK_INT(static_cast<int>(mapper->GetMTime() - mtime), 0);
+  const double hiddenOutline[4] = { 0.0, 0.0, 1.0, 0.0 };
+  mapper->SetLabelColors(1, fill1, hiddenOutline);
+  CHECK_BOOL(mapper->GetMTime() > mtime, true);
+  CHECK_BOOL(mapper->IsOutlineVisible(1), false);
+  mapper->Update();
+  CHECK_EXIT_SUCCESS(checkColor(output, 1, 1, 255, 0, 0, 128));
+
+  // Changing the number of labels resets the colors
+  mapper->SetNumberOfLabels(2);
+  mapper->Update();
+  CHECK_EXIT_SUCCESS(checkColor(output, 2, 2, 0, 0, 0, 0));
+  CHECK_EXIT_SUCCESS(checkColor(output, 6, 5, 0, 0, 0, 0));
+
+  return EXIT_SUCCESS;
+}
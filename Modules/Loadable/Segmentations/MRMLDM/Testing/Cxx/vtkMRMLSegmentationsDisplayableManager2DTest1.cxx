@@ -0,0 +1,226 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations MRMLDM includes
+#include "vtkMRMLSegmentationsDisplayableManager2D.h"
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSegmentationDisplayNode.h>
+#include <vtkMRMLSegmentationNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWindowToImageFilter.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+
+const int DIMENSION = 64;
+
+//----------------------------------------------------------------------------
+vtkOrientedImageData* GetLabelmap(vtkSegmentation* segmentation, const std::string& segmentId)
+{
+  return vtkOrientedImageData::SafeDownCast(segmentation->GetSegmentRepresentation(
+    segmentId, vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+}
+
+//----------------------------------------------------------------------------
+// Paint the box [min, max[ of all the slices of the labelmap
+void PaintBox(vtkOrientedImageData* labelmap, int minI, int maxI, int minJ, int maxJ)
+{
+  for (int k = 0; k < DIMENSION; ++k)
+    {
+    for (int j = minJ; j < maxJ; ++j)
+      {
+      for (int i = minI; i < maxI; ++i)
+        {
+        *static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) = 1;
+        }
+      }
+    }
+  labelmap->Modified();
+}
+
+//----------------------------------------------------------------------------
+std::string AddLabelmapSegment(vtkSegmentation* segmentation, const char* name, double r, double g, double b,
+                               int minI, int maxI, int minJ, int maxJ)
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, DIMENSION - 1, 0, DIMENSION - 1, 0, DIMENSION - 1);
+  labelmap->SetOrigin(-DIMENSION / 2, -DIMENSION / 2, -DIMENSION / 2);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  memset(labelmap->GetScalarPointer(), 0, DIMENSION * DIMENSION * DIMENSION);
+  PaintBox(labelmap.GetPointer(), minI, maxI, minJ, maxJ);
+  vtkNew<vtkSegment> segment;
+  segment->SetName(name);
+  segment->SetColor(r, g, b);
+  segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(),
+    labelmap.GetPointer());
+  std::string segmentId = segmentation->GenerateUniqueSegmentID(name);
+  segmentation->AddSegment(segment.GetPointer(), segmentId);
+  return segmentId;
+}
+
+//----------------------------------------------------------------------------
+int CountVisibleProps(vtkRenderer* renderer)
+{
+  int count = 0;
+  vtkPropCollection* props = renderer->GetViewProps();
+  props->InitTraversal();
+  for (vtkProp* prop = props->GetNextProp(); prop; prop = props->GetNextProp())
+    {
+    count += prop->GetVisibility() ? 1 : 0;
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkUnsignedCharArray> Render(vtkRenderWindow* renderWindow)
+{
+  renderWindow->Render();
+  vtkNew<vtkWindowToImageFilter> windowToImage;
+  windowToImage->SetInput(renderWindow);
+  windowToImage->ReadFrontBufferOff();
+  windowToImage->Update();
+  vtkSmartPointer<vtkUnsignedCharArray> pixels = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  pixels->DeepCopy(windowToImage->GetOutput()->GetPointData()->GetScalars());
+  return pixels;
+}
+
+//----------------------------------------------------------------------------
+// Render the segmentation with composited labelmaps and with one pipeline per
+// segment, and check that both images are the same. Colors may differ by the
+// rounding of the blending of the fill and outline actors.
+int CheckCompositedRendering(vtkMRMLSegmentationsDisplayableManager2D* displayableManager,
+                             vtkRenderWindow* renderWindow, vtkRenderer* renderer,
+                             int expectedCompositedProps, int expectedSegmentProps)
+{
+  displayableManager->SetCompositeLabelmaps(true);
+  vtkSmartPointer<vtkUnsignedCharArray> compositedPixels = Render(renderWindow);
+  CHECK_INT(CountVisibleProps(renderer), expectedCompositedProps);
+
+  displayableManager->SetCompositeLabelmaps(false);
+  vtkSmartPointer<vtkUnsignedCharArray> segmentPixels = Render(renderWindow);
+  CHECK_INT(CountVisibleProps(renderer), expectedSegmentProps);
+  displayableManager->SetCompositeLabelmaps(true);
+
+  CHECK_INT(compositedPixels->GetNumberOfValues(), segmentPixels->GetNumberOfValues());
+  int numberOfColoredValues = 0;
+  for (vtkIdType i = 0; i < compositedPixels->GetNumberOfValues(); ++i)
+    {
+    int difference = abs(compositedPixels->GetValue(i) - segmentPixels->GetValue(i));
+    if (difference > 2)
+      {
+      std::cerr << "Line " << __LINE__ << ": value " << i << " differs: "
+                << static_cast<int>(compositedPixels->GetValue(i)) << " != "
+                << static_cast<int>(segmentPixels->GetValue(i)) << std::endl;
+      return EXIT_FAILURE;
+      }
+    numberOfColoredValues += (segmentPixels->GetValue(i) != 0 ? 1 : 0);
+    }
+  // Make sure that segments are rendered
+  CHECK_BOOL(numberOfColoredValues > 0, true);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSegmentationsDisplayableManager2DTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(DIMENSION, DIMENSION);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  vtkNew<vtkMRMLScene> scene;
+
+  // Axial slice through the middle of the labelmaps, one pixel per voxel
+  vtkNew<vtkMRMLSliceNode> sliceNode;
+  sliceNode->SetLayoutName("Red");
+  sliceNode->SetDimensions(DIMENSION, DIMENSION, 1);
+  sliceNode->SetFieldOfView(DIMENSION, DIMENSION, 1);
+  scene->AddNode(sliceNode.GetPointer());
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer.GetPointer());
+  displayableManagerGroup->SetMRMLDisplayableNode(sliceNode.GetPointer());
+  vtkNew<vtkMRMLSegmentationsDisplayableManager2D> displayableManager;
+  displayableManagerGroup->AddDisplayableManager(displayableManager.GetPointer());
+  CHECK_BOOL(displayableManager->GetCompositeLabelmaps(), true);
+
+  // Two segments that don't overlap, with semi-transparent fill
+  vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+  scene->AddNode(segmentationNode.GetPointer());
+  segmentationNode->CreateDefaultDisplayNodes();
+  vtkMRMLSegmentationDisplayNode* displayNode =
+    vtkMRMLSegmentationDisplayNode::SafeDownCast(segmentationNode->GetDisplayNode());
+  CHECK_NOT_NULL(displayNode);
+  displayNode->SetOpacity2DFill(0.5);
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  segmentation->SetMasterRepresentationName(
+    vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
+  std::string segmentId1 = AddLabelmapSegment(segmentation, "segment1", 1.0, 0.0, 0.0, 8, 24, 8, 24);
+  AddLabelmapSegment(segmentation, "segment2", 0.0, 1.0, 0.0, 40, 56, 40, 56);
+
+  // One actor for the two segments, instead of a fill and an outline actor per segment
+  CHECK_EXIT_SUCCESS(CheckCompositedRendering(displayableManager.GetPointer(),
+    renderWindow.GetPointer(), renderer.GetPointer(), 1, 4));
+
+  // Modify the labelmap in place: only the modified extent is merged again
+  PaintBox(GetLabelmap(segmentation, segmentId1), 8, 32, 8, 32);
+  segmentationNode->Modified();
+  CHECK_EXIT_SUCCESS(CheckCompositedRendering(displayableManager.GetPointer(),
+    renderWindow.GetPointer(), renderer.GetPointer(), 1, 4));
+
+  // A segment that overlaps the second segment: the fills of overlapping
+  // segments are blended, they keep their own actors
+  AddLabelmapSegment(segmentation, "segment3", 0.0, 0.0, 1.0, 48, 60, 48, 60);
+  CHECK_EXIT_SUCCESS(CheckCompositedRendering(displayableManager.GetPointer(),
+    renderWindow.GetPointer(), renderer.GetPointer(), 5, 6));
+
+  // Painting the first segment over the second one is detected when the
+  // modified extent is merged
+  PaintBox(GetLabelmap(segmentation, segmentId1), 8, 44, 8, 44);
+  segmentationNode->Modified();
+  CHECK_EXIT_SUCCESS(CheckCompositedRendering(displayableManager.GetPointer(),
+    renderWindow.GetPointer(), renderer.GetPointer(), 6, 6));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,273 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkImageLabelMapToRGBA.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelMapToRGBA);
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::vtkImageLabelMapToRGBA()
+{
+  this->Outline = 1;
+  this->SetNumberOfLabels(0);
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::~vtkImageLabelMapToRGBA()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::SetNumberOfLabels(int numberOfLabels)
+{
+  if (numberOfLabels < 0)
+    {
+    numberOfLabels = 0;
+    }
+  // Label 0 is the background, it stays transparent.
+  this->ColorTable.assign(2 * (numberOfLabels + 1) * 4, 0);
+  this->OutlineVisible.assign(numberOfLabels + 1, false);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::GetNumberOfLabels() const
+{
+  return static_cast<int>(this->OutlineVisible.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::SetLabelColors(int label,
+  const double fillColor[4], const double outlineColor[4])
+{
+  if (label < 1 || label > this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("SetLabelColors: Label " << label << " is out of range");
+    return;
+    }
+  // Fill color composited over the outline color
+  const double fillAlpha = fillColor[3];
+  const double outlineAlpha = outlineColor[3] * (1.0 - fillAlpha);
+  const double alpha = fillAlpha + outlineAlpha;
+  double composited[4] = { 0.0, 0.0, 0.0, alpha };
+  if (alpha > 0.0)
+    {
+    for (int i = 0; i < 3; ++i)
+      {
+      composited[i] = (fillColor[i] * fillAlpha + outlineColor[i] * outlineAlpha) / alpha;
+      }
+    }
+
+  unsigned char colors[8];
+  for (int i = 0; i < 4; ++i)
+    {
+    // Same rounding as vtkLookupTable
+    colors[i] = static_cast<unsigned char>(fillColor[i] * 255.0 + 0.5);
+    colors[i + 4] = static_cast<unsigned char>(composited[i] * 255.0 + 0.5);
+    }
+  unsigned char* labelColors = &this->ColorTable[2 * label * 4];
+  if (std::equal(colors, colors + 8, labelColors))
+    {
+    return;
+    }
+  std::copy(colors, colors + 8, labelColors);
+  this->OutlineVisible[label] = !std::equal(colors, colors + 4, colors + 4);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+const unsigned char* vtkImageLabelMapToRGBA::GetColorTable() const
+{
+  return &this->ColorTable[0];
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLabelMapToRGBA::IsOutlineVisible(int label) const
+{
+  return this->OutlineVisible[label];
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestInformation(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector),
+  vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestUpdateExtent(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+
+  // The outline test needs the neighbors within Outline voxels in the slice plane
+  int inExt[6] = { 0, -1, 0, -1, 0, -1 };
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
+  int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  for (int axis = 0; axis < 2; ++axis)
+    {
+    inExt[2 * axis] = std::max(inExt[2 * axis] - this->Outline, wholeExtent[2 * axis]);
+    inExt[2 * axis + 1] = std::min(inExt[2 * axis + 1] + this->Outline, wholeExtent[2 * axis + 1]);
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+  return 1;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageLabelMapToRGBAExecute(vtkImageLabelMapToRGBA* self,
+  vtkImageData* inData, vtkImageData* outData, const int wholeExtent[6],
+  int outExt[6], int threadId, T*)
+{
+  const int outline = self->GetOutline();
+  const int numberOfLabels = self->GetNumberOfLabels();
+  const unsigned char* colorTable = self->GetColorTable();
+
+  vtkIdType inIncX = 0;
+  vtkIdType inIncY = 0;
+  vtkIdType inIncZ = 0;
+  inData->GetIncrements(inIncX, inIncY, inIncZ);
+  vtkIdType outIncX = 0;
+  vtkIdType outIncY = 0;
+  vtkIdType outIncZ = 0;
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+
+  const unsigned long target = static_cast<unsigned long>(
+    (outExt[5] - outExt[4] + 1) * (outExt[3] - outExt[2] + 1) / 50.0) + 1;
+  unsigned long count = 0;
+
+  unsigned char* outPtr = static_cast<unsigned char*>(outData->GetScalarPointerForExtent(outExt));
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+    {
+    for (int y = outExt[2]; y <= outExt[3] && !self->AbortExecute; ++y)
+      {
+      if (threadId == 0)
+        {
+        if (count % target == 0)
+          {
+          self->UpdateProgress(count / (50.0 * target));
+          }
+        ++count;
+        }
+      const T* inPtr = static_cast<const T*>(inData->GetScalarPointer(outExt[0], y, z));
+      for (int x = outExt[0]; x <= outExt[1]; ++x, ++inPtr, outPtr += 4)
+        {
+        const T value = *inPtr;
+        if (value < 1 || value > numberOfLabels)
+          {
+          outPtr[0] = outPtr[1] = outPtr[2] = outPtr[3] = 0;
+          continue;
+          }
+        const int label = static_cast<int>(value);
+        bool isOutline = false;
+        if (self->IsOutlineVisible(label))
+          {
+          if (x - outline < wholeExtent[0] || x + outline > wholeExtent[1]
+            || y - outline < wholeExtent[2] || y + outline > wholeExtent[3])
+            {
+            isOutline = true;
+            }
+          for (int dy = -outline; dy <= outline && !isOutline; ++dy)
+            {
+            const T* neighborPtr = inPtr + dy * inIncY - outline;
+            for (int dx = -outline; dx <= outline; ++dx, ++neighborPtr)
+              {
+              if (*neighborPtr != value)
+                {
+                isOutline = true;
+                break;
+                }
+              }
+            }
+          }
+        const unsigned char* color = colorTable + 4 * (2 * label + (isOutline ? 1 : 0));
+        outPtr[0] = color[0];
+        outPtr[1] = color[1];
+        outPtr[2] = color[2];
+        outPtr[3] = color[3];
+        }
+      outPtr += outIncY;
+      }
+    outPtr += outIncZ;
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::ThreadedRequestData(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData,
+  vtkImageData** outData,
+  int outExt[6], int threadId)
+{
+  vtkImageData* input = inData[0][0];
+  if (!input || !input->GetPointData()->GetScalars())
+    {
+    return;
+    }
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("ThreadedRequestData: Input must have a single component");
+    return;
+    }
+  int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inputVector[0]->GetInformationObject(0)->Get(
+    vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageLabelMapToRGBAExecute(
+        this, input, outData[0], wholeExtent, outExt, threadId,
+        static_cast<VTK_TT*>(0)));
+    default:
+      vtkErrorMacro(<< "ThreadedRequestData: Unknown input ScalarType");
+      return;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfLabels: " << this->GetNumberOfLabels() << "\n";
+  os << indent << "Outline: " << this->Outline << "\n";
+}
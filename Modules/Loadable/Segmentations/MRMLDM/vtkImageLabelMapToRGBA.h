@@ -0,0 +1,91 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkImageLabelMapToRGBA_h
+#define __vtkImageLabelMapToRGBA_h
+
+#include "vtkSlicerSegmentationsModuleMRMLDisplayableManagerExport.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+// STD includes
+#include <vector>
+
+/// \brief Map a label image to the RGBA image of its fill and outline.
+///
+/// A voxel of label L (1 <= L <= NumberOfLabels) is on the outline of L if any
+/// voxel within Outline voxels along the first two axes has a different label
+/// or is outside of the image, as in vtkImageLabelOutline.
+/// Each label has a fill color and an outline color. Outline voxels get the
+/// fill color composited over the outline color, which is what an outline
+/// actor drawn below a fill actor shows. Other voxels of the label get the fill
+/// color, and voxels of label 0 or out of range labels are transparent.
+/// Both cases are a single lookup in a table of 2 colors per label.
+class VTK_SLICER_SEGMENTATIONS_MODULE_MRMLDISPLAYABLEMANAGER_EXPORT vtkImageLabelMapToRGBA
+  : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageLabelMapToRGBA *New();
+  vtkTypeMacro(vtkImageLabelMapToRGBA, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Set the number of labels. Colors of all the labels are reset to transparent.
+  void SetNumberOfLabels(int numberOfLabels);
+  int GetNumberOfLabels() const;
+
+  /// Set the fill and outline colors of a label, components in [0, 1].
+  /// The filter is not modified if the colors don't change.
+  void SetLabelColors(int label, const double fillColor[4], const double outlineColor[4]);
+
+  /// Half width of the outline in voxels. Default is 1.
+  vtkSetClampMacro(Outline, int, 0, VTK_INT_MAX);
+  vtkGetMacro(Outline, int);
+
+  /// Colors of the fill (index 2*label) and outline (index 2*label+1) voxels,
+  /// as RGBA tuples. Internally used by the execute method.
+  const unsigned char* GetColorTable() const;
+
+  /// True if the outline of the label looks different from its fill.
+  /// Internally used by the execute method to skip the neighborhood test.
+  bool IsOutlineVisible(int label) const;
+
+protected:
+  vtkImageLabelMapToRGBA();
+  virtual ~vtkImageLabelMapToRGBA();
+
+  virtual int RequestInformation(vtkInformation* request,
+                                 vtkInformationVector** inputVector,
+                                 vtkInformationVector* outputVector) VTK_OVERRIDE;
+  virtual int RequestUpdateExtent(vtkInformation* request,
+                                  vtkInformationVector** inputVector,
+                                  vtkInformationVector* outputVector) VTK_OVERRIDE;
+  virtual void ThreadedRequestData(vtkInformation* request,
+                                   vtkInformationVector** inputVector,
+                                   vtkInformationVector* outputVector,
+                                   vtkImageData*** inData,
+                                   vtkImageData** outData,
+                                   int outExt[6], int threadId) VTK_OVERRIDE;
+
+  int Outline;
+  std::vector<unsigned char> ColorTable;
+  std::vector<bool> OutlineVisible;
+
+private:
+  vtkImageLabelMapToRGBA(const vtkImageLabelMapToRGBA&);
+  void operator=(const vtkImageLabelMapToRGBA&);
+};
+
+#endif
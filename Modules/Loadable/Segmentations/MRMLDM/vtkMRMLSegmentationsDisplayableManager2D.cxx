@@ -31,6 +31,9 @@
 // MRML logic includes
 #include "vtkImageLabelOutline.h"
 
+// Segmentations MRMLDM includes
+#include "vtkImageLabelMapToRGBA.h"
+
 // SegmentationCore includes
 #include "vtkSegmentation.h"
 #include "vtkOrientedImageData.h"
@@ -118,6 +121,78 @@ void SnapToPermuteMatrix(vtkTransform* transform)
     }
 }
 
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Set the voxels of the merged labelmap (short scalars) within extent to
+// label where the binary labelmap is set. Labels that are overwritten are
+// flagged in overwrittenLabels.
+template <class T>
+void PaintLabel(vtkImageData* labelmap, vtkImageData* mergedLabelmap, const int extent[6],
+  short label, std::vector<bool>& overwrittenLabels, T*)
+{
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+      const T* labelmapPtr = static_cast<const T*>(labelmap->GetScalarPointer(extent[0], y, z));
+      short* mergedPtr = static_cast<short*>(mergedLabelmap->GetScalarPointer(extent[0], y, z));
+      for (int x = extent[0]; x <= extent[1]; ++x, ++labelmapPtr, ++mergedPtr)
+        {
+        if (*labelmapPtr > 0)
+          {
+          if (*mergedPtr != 0)
+            {
+            overwrittenLabels[*mergedPtr] = true;
+            }
+          *mergedPtr = label;
+          }
+        }
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+// Return true if the binary labelmap is set where the merged labelmap (short
+// scalars) is set, within extent.
+template <class T>
+bool IsLabelOverlapping(vtkImageData* labelmap, vtkImageData* mergedLabelmap, const int extent[6], T*)
+{
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+      const T* labelmapPtr = static_cast<const T*>(labelmap->GetScalarPointer(extent[0], y, z));
+      const short* mergedPtr = static_cast<const short*>(mergedLabelmap->GetScalarPointer(extent[0], y, z));
+      for (int x = extent[0]; x <= extent[1]; ++x, ++labelmapPtr, ++mergedPtr)
+        {
+        if (*labelmapPtr > 0 && *mergedPtr != 0)
+          {
+          return true;
+          }
+        }
+      }
+    }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+// Intersection of two extents, return false if it is empty.
+bool IntersectExtents(const int extent1[6], const int extent2[6], int intersection[6])
+{
+  bool empty = false;
+  for (int i = 0; i < 3; ++i)
+    {
+    intersection[2 * i] = std::max(extent1[2 * i], extent2[2 * i]);
+    intersection[2 * i + 1] = std::min(extent1[2 * i + 1], extent2[2 * i + 1]);
+    empty = empty || intersection[2 * i] > intersection[2 * i + 1];
+    }
+  return !empty;
+}
+
+} // end of anonymous namespace
+
 //---------------------------------------------------------------------------
 class vtkMRMLSegmentationsDisplayableManager2D::vtkInternal
 {
@@ -261,6 +336,68 @@ public:
   typedef std::map < vtkMRMLSegmentationDisplayNode*, PipelineMapType > PipelinesCacheType;
   PipelinesCacheType DisplayPipelines;
 
+  /// Pipeline showing the binary labelmaps of the segments of a display node
+  /// that don't overlap other segments: the labelmaps are merged into a segment
+  /// index image (segment i has label i+1), which is resliced once and mapped to
+  /// the fill and outline colors of the segments in a single pass.
+  struct CompositePipeline
+    {
+    /// Visible segment, with the modified time and extent of its labelmap when
+    /// it was merged. Segments that overlap other segments are not composited.
+    struct MergedSegment
+      {
+      std::string SegmentID;
+      bool Composited;
+      vtkMTimeType LabelmapMTime;
+      int LabelmapExtent[6];
+      };
+
+    CompositePipeline()
+      {
+      this->NodeToWorldTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->WorldToNodeTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->MergedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+
+      this->Actor = vtkSmartPointer<vtkActor2D>::New();
+      this->Reslice = vtkSmartPointer<vtkImageReslice>::New();
+      this->SliceToImageTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->ColorMapper = vtkSmartPointer<vtkImageLabelMapToRGBA>::New();
+
+      this->Reslice->SetBackgroundColor(0.0, 0.0, 0.0, 0.0);
+      this->Reslice->AutoCropOutputOff();
+      this->Reslice->SetOptimization(1);
+      this->Reslice->SetOutputOrigin(0.0, 0.0, 0.0);
+      this->Reslice->SetOutputSpacing(1.0, 1.0, 1.0);
+      this->Reslice->SetOutputDimensionality(3);
+      this->Reslice->SetInterpolationModeToNearestNeighbor();
+
+      this->SliceToImageTransform->PostMultiply();
+
+      this->ColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
+      vtkSmartPointer<vtkImageMapper> imageMapper = vtkSmartPointer<vtkImageMapper>::New();
+      imageMapper->SetInputConnection(this->ColorMapper->GetOutputPort());
+      imageMapper->SetColorWindow(255);
+      imageMapper->SetColorLevel(127.5);
+      this->Actor->SetMapper(imageMapper);
+      this->Actor->SetVisibility(0);
+      }
+
+    vtkSmartPointer<vtkGeneralTransform> NodeToWorldTransform;
+    vtkSmartPointer<vtkGeneralTransform> WorldToNodeTransform;
+
+    vtkSmartPointer<vtkOrientedImageData> MergedLabelmap;
+    std::vector<std::string> VisibleSegmentIDs; // visible labelmap segments at the last full merge
+    std::vector<MergedSegment> Segments; // visible segments, segment i has label i+1
+
+    vtkSmartPointer<vtkActor2D> Actor;
+    vtkSmartPointer<vtkImageReslice> Reslice;
+    vtkSmartPointer<vtkGeneralTransform> SliceToImageTransform;
+    vtkSmartPointer<vtkImageLabelMapToRGBA> ColorMapper;
+    };
+
+  typedef std::map < vtkMRMLSegmentationDisplayNode*, CompositePipeline* > CompositePipelinesCacheType;
+  CompositePipelinesCacheType CompositePipelines;
+
   typedef std::map < vtkMRMLSegmentationNode*, std::set< vtkMRMLSegmentationDisplayNode* > > SegmentationToDisplayCacheType;
   SegmentationToDisplayCacheType SegmentationToDisplayNodes;
 
@@ -284,7 +421,15 @@ public:
   void UpdateAllDisplayNodesForSegment(vtkMRMLSegmentationNode* segmentationNode);
   void UpdateSegmentPipelines(vtkMRMLSegmentationDisplayNode*, PipelineMapType&);
   void UpdateDisplayNodePipeline(vtkMRMLSegmentationDisplayNode*, PipelineMapType);
+  void UpdateCompositePipeline(vtkMRMLSegmentationDisplayNode*, const std::string& shownRepresentationName,
+    std::set<std::string>& compositedSegmentIDs);
+  void MergeLabelmaps(CompositePipeline* pipeline, vtkSegmentation* segmentation,
+    const std::vector<std::string>& segmentIDs, vtkOrientedImageData* referenceLabelmap);
+  bool PaintMergedLabelmap(CompositePipeline* pipeline, vtkSegmentation* segmentation,
+    const int extent[6], std::vector<bool>& overlappingSegments);
+  bool HasCompositedSegments(CompositePipeline* pipeline);
   void RemoveDisplayNode(vtkMRMLSegmentationDisplayNode* displayNode);
+  void UpdateAllDisplayNodePipelines();
 
   // Observations
   void AddObservations(vtkMRMLSegmentationNode* node);
@@ -297,6 +442,10 @@ public:
   bool UseDisplayableNode(vtkMRMLSegmentationNode* node);
   void ClearDisplayableNodes();
   bool IsSegmentVisibleInCurrentSlice(vtkMRMLSegmentationDisplayNode* displayNode, Pipeline* pipeline, const std::string &segmentID);
+  void SetResliceInput(vtkImageReslice* reslice, vtkGeneralTransform* sliceToImageTransform,
+    vtkGeneralTransform* worldToNodeTransform, vtkOrientedImageData* imageData);
+
+  bool CompositeLabelmaps;
 
 private:
   vtkSmartPointer<vtkMatrix4x4> SliceXYToRAS;
@@ -321,6 +470,7 @@ vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::vtkInternal(vtkMRMLSegmen
 
   this->SmoothFractionalLabelMapBorder = true;
   this->DefaultFractionalInterpolationType = VTK_LINEAR_INTERPOLATION;
+  this->CompositeLabelmaps = true;
 }
 
 //---------------------------------------------------------------------------
@@ -369,6 +519,12 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateSliceNode()
 {
   // Update the Slice node transform then update the DisplayNode pipelines to account for plane location
   this->SliceXYToRAS->DeepCopy( this->SliceNode->GetXYToRAS() );
+  this->UpdateAllDisplayNodePipelines();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateAllDisplayNodePipelines()
+{
   PipelinesCacheType::iterator displayNodeIt;
   for (displayNodeIt = this->DisplayPipelines.begin(); displayNodeIt != this->DisplayPipelines.end(); ++displayNodeIt)
     {
@@ -486,6 +642,11 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayableTra
         currentPipeline->SliceIntersectionUpdatedTime = 0; // Trigger slice intersection recomputation
         this->GetNodeTransformToWorld(mNode, currentPipeline->NodeToWorldTransform, currentPipeline->WorldToNodeTransform);
         }
+      CompositePipelinesCacheType::iterator compositeIt = this->CompositePipelines.find(*dnodesIter);
+      if (compositeIt != this->CompositePipelines.end())
+        {
+        this->GetNodeTransformToWorld(mNode, compositeIt->second->NodeToWorldTransform, compositeIt->second->WorldToNodeTransform);
+        }
       this->UpdateDisplayNodePipeline(pipelinesIter->first, pipelinesIter->second);
       }
     }
@@ -510,6 +671,14 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::RemoveDisplayNode(vt
     delete pipeline;
     }
   this->DisplayPipelines.erase(pipelinesIter);
+
+  CompositePipelinesCacheType::iterator compositeIt = this->CompositePipelines.find(displayNode);
+  if (compositeIt != this->CompositePipelines.end())
+    {
+    this->External->GetRenderer()->RemoveActor(compositeIt->second->Actor);
+    delete compositeIt->second;
+    this->CompositePipelines.erase(compositeIt);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -674,6 +843,8 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
   if (shownRepresenatationName.empty())
     {
     // Hide segmentation if there is no 2D representation to show
+    std::set<std::string> compositedSegmentIDs;
+    this->UpdateCompositePipeline(displayNode, shownRepresenatationName, compositedSegmentIDs);
     for (PipelineMapType::iterator pipelineIt=pipelines.begin(); pipelineIt!=pipelines.end(); ++pipelineIt)
       {
       pipelineIt->second->PolyDataOutlineActor->SetVisibility(false);
@@ -702,11 +873,24 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     return;
     }
 
+  // Show the segments that can be composited with a single actor
+  std::set<std::string> compositedSegmentIDs;
+  this->UpdateCompositePipeline(displayNode, shownRepresenatationName, compositedSegmentIDs);
+
   // For all pipelines (pipeline per segment)
   for (PipelineMapType::iterator pipelineIt=pipelines.begin(); pipelineIt!=pipelines.end(); ++pipelineIt)
     {
     Pipeline* pipeline = pipelineIt->second;
 
+    if (compositedSegmentIDs.find(pipelineIt->first) != compositedSegmentIDs.end())
+      {
+      pipeline->PolyDataOutlineActor->SetVisibility(false);
+      pipeline->PolyDataFillActor->SetVisibility(false);
+      pipeline->ImageOutlineActor->SetVisibility(false);
+      pipeline->ImageFillActor->SetVisibility(false);
+      continue;
+      }
+
     // Get visibility
     vtkMRMLSegmentationDisplayNode::SegmentDisplayProperties properties;
     displayNode->GetSegmentDisplayProperties(pipelineIt->first, properties);
@@ -875,34 +1059,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       pipeline->LookupTableFill->ForceBuild();
       pipeline->Reslice->SetBackgroundLevel(minimumValue);
 
-      // Calculate image IJK to world RAS transform
-      pipeline->SliceToImageTransform->Identity();
-      pipeline->SliceToImageTransform->Concatenate(this->SliceXYToRAS);
-      pipeline->SliceToImageTransform->Concatenate(pipeline->WorldToNodeTransform);
-      vtkSmartPointer<vtkMatrix4x4> worldToImageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-      imageData->GetWorldToImageMatrix(worldToImageMatrix);
-      pipeline->SliceToImageTransform->Concatenate(worldToImageMatrix);
-
-      // Create temporary copy of the segment image with default origin and spacing
-      vtkSmartPointer<vtkImageData> identityImageData = vtkSmartPointer<vtkImageData>::New();
-      identityImageData->ShallowCopy(imageData);
-      identityImageData->SetOrigin(0.0, 0.0, 0.0);
-      identityImageData->SetSpacing(1.0, 1.0, 1.0);
-
-      // Set Reslice transform
-      // vtkImageReslice works faster if the input is a linear transform, so try to convert it
-      // to a linear transform.
-      // Also attempt to make it a permute transform, as it makes reslicing even faster.
-      vtkSmartPointer<vtkTransform> linearSliceToImageTransform = vtkSmartPointer<vtkTransform>::New();
-      if (vtkMRMLTransformNode::IsGeneralTransformLinear(pipeline->SliceToImageTransform, linearSliceToImageTransform))
-        {
-        SnapToPermuteMatrix(linearSliceToImageTransform);
-        pipeline->Reslice->SetResliceTransform(linearSliceToImageTransform);
-        }
-      else
-        {
-        pipeline->Reslice->SetResliceTransform(pipeline->SliceToImageTransform);
-        }
+      this->SetResliceInput(pipeline->Reslice, pipeline->SliceToImageTransform, pipeline->WorldToNodeTransform, imageData);
 
       // Set the interpolation mode from the InterpolationType field if it exists
       // Default to nearest neighbor interpolation otherwise
@@ -918,13 +1075,6 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         pipeline->Reslice->SetInterpolationMode(this->DefaultFractionalInterpolationType);
         }
 
-      pipeline->Reslice->SetInputData(identityImageData);
-
-      int dimensions[3] = { 0, 0, 0 };
-      this->SliceNode->GetDimensions(dimensions);
-      int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
-      pipeline->Reslice->SetOutputExtent(sliceOutputExtent);
-
       // If ThresholdValue is not specified, then do not perform thresholding
       vtkDoubleArray* thresholdValue = vtkDoubleArray::SafeDownCast(
         imageData->GetFieldData()->GetAbstractArray(vtkSegmentationConverter::GetThresholdValueFieldName()));
@@ -967,6 +1117,343 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateCompositePipeline(
+  vtkMRMLSegmentationDisplayNode* displayNode, const std::string& shownRepresentationName,
+  std::set<std::string>& compositedSegmentIDs)
+{
+  compositedSegmentIDs.clear();
+  CompositePipelinesCacheType::iterator compositeIt = this->CompositePipelines.find(displayNode);
+  CompositePipeline* pipeline = (compositeIt != this->CompositePipelines.end() ? compositeIt->second : NULL);
+
+  vtkMRMLSegmentationNode* segmentationNode = vtkMRMLSegmentationNode::SafeDownCast(displayNode->GetDisplayableNode());
+  vtkSegmentation* segmentation = (segmentationNode ? segmentationNode->GetSegmentation() : NULL);
+  if ( !this->CompositeLabelmaps || !segmentation || !this->IsVisible(displayNode)
+    || shownRepresentationName != vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName() )
+    {
+    if (pipeline)
+      {
+      pipeline->Actor->SetVisibility(false);
+      }
+    return;
+    }
+
+  // Collect the visible segments shown as labelmap. Segments on another voxel grid
+  // would be drawn in a different order than with their own pipelines, so all
+  // segments keep their own pipelines if the grids differ.
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  std::vector<std::string> visibleSegmentIDs;
+  vtkOrientedImageData* referenceLabelmap = NULL;
+  bool geometriesMatch = true;
+  for (std::vector<std::string>::iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    vtkMRMLSegmentationDisplayNode::SegmentDisplayProperties properties;
+    displayNode->GetSegmentDisplayProperties(*segmentIdIt, properties);
+    bool segmentVisible = properties.Visible
+      && ( (properties.Visible2DOutline && displayNode->GetVisibility2DOutline())
+        || (properties.Visible2DFill && displayNode->GetVisibility2DFill()) );
+    if (!segmentVisible)
+      {
+      continue;
+      }
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+      segmentation->GetSegmentRepresentation(*segmentIdIt, shownRepresentationName));
+    if (!labelmap || labelmap->IsEmpty())
+      {
+      continue;
+      }
+    if (!referenceLabelmap)
+      {
+      referenceLabelmap = labelmap;
+      }
+    if (labelmap->GetNumberOfScalarComponents() != 1
+      || !vtkOrientedImageDataResample::DoGeometriesMatch(referenceLabelmap, labelmap))
+      {
+      geometriesMatch = false;
+      break;
+      }
+    visibleSegmentIDs.push_back(*segmentIdIt);
+    }
+
+  if (visibleSegmentIDs.empty() || !geometriesMatch || visibleSegmentIDs.size() > static_cast<size_t>(VTK_SHORT_MAX))
+    {
+    if (pipeline)
+      {
+      pipeline->Actor->SetVisibility(false);
+      }
+    return;
+    }
+
+  if (!pipeline)
+    {
+    pipeline = new CompositePipeline();
+    this->CompositePipelines[displayNode] = pipeline;
+    this->External->GetRenderer()->AddActor(pipeline->Actor);
+    this->GetNodeTransformToWorld(segmentationNode, pipeline->NodeToWorldTransform, pipeline->WorldToNodeTransform);
+    }
+
+  // Merge all the labelmaps when the visible segments or the grid changed.
+  // Otherwise only the extent of the modified labelmaps is merged again,
+  // and moving the slice only reslices the merged labelmap.
+  bool mergeAll = (pipeline->VisibleSegmentIDs != visibleSegmentIDs
+    || !vtkOrientedImageDataResample::DoGeometriesMatch(pipeline->MergedLabelmap, referenceLabelmap));
+  int* mergedExtent = pipeline->MergedLabelmap->GetExtent();
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  bool modified = false;
+  for (std::vector<CompositePipeline::MergedSegment>::iterator segmentIt = pipeline->Segments.begin();
+    !mergeAll && segmentIt != pipeline->Segments.end(); ++segmentIt)
+    {
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+      segmentation->GetSegmentRepresentation(segmentIt->SegmentID, shownRepresentationName));
+    if (labelmap->GetMTime() == segmentIt->LabelmapMTime)
+      {
+      continue;
+      }
+    int* extent = labelmap->GetExtent();
+    for (int i = 0; i < 3; ++i)
+      {
+      if (segmentIt->Composited
+        && (extent[2 * i] < mergedExtent[2 * i] || extent[2 * i + 1] > mergedExtent[2 * i + 1]))
+        {
+        // The labelmap grew beyond the merged labelmap
+        mergeAll = true;
+        }
+      // Voxels of the previous and current labelmap extents may have changed
+      int previousMin = std::min(extent[2 * i], segmentIt->LabelmapExtent[2 * i]);
+      int previousMax = std::max(extent[2 * i + 1], segmentIt->LabelmapExtent[2 * i + 1]);
+      modifiedExtent[2 * i] = (modified ? std::min(modifiedExtent[2 * i], previousMin) : previousMin);
+      modifiedExtent[2 * i + 1] = (modified ? std::max(modifiedExtent[2 * i + 1], previousMax) : previousMax);
+      }
+    modified = true;
+    }
+  if (!mergeAll && modified)
+    {
+    int paintExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    IntersectExtents(modifiedExtent, mergedExtent, paintExtent);
+    std::vector<bool> overlappingSegments;
+    if (!this->PaintMergedLabelmap(pipeline, segmentation, paintExtent, overlappingSegments))
+      {
+      // Segments that overlap must be drawn by their own pipelines
+      mergeAll = true;
+      }
+    }
+  if (mergeAll)
+    {
+    this->MergeLabelmaps(pipeline, segmentation, visibleSegmentIDs, referenceLabelmap);
+    }
+
+  if (!this->HasCompositedSegments(pipeline))
+    {
+    pipeline->Actor->SetVisibility(false);
+    return;
+    }
+  for (std::vector<CompositePipeline::MergedSegment>::iterator segmentIt = pipeline->Segments.begin();
+    segmentIt != pipeline->Segments.end(); ++segmentIt)
+    {
+    if (segmentIt->Composited)
+      {
+      compositedSegmentIDs.insert(segmentIt->SegmentID);
+      }
+    }
+
+  // Colors of the segments, a hidden fill or outline is transparent.
+  // The color mapper is only modified if a color changed.
+  int numberOfLabels = static_cast<int>(pipeline->Segments.size());
+  if (pipeline->ColorMapper->GetNumberOfLabels() != numberOfLabels)
+    {
+    pipeline->ColorMapper->SetNumberOfLabels(numberOfLabels);
+    }
+  for (int segmentIndex = 0; segmentIndex < numberOfLabels; ++segmentIndex)
+    {
+    if (!pipeline->Segments[segmentIndex].Composited)
+      {
+      continue;
+      }
+    const std::string& segmentID = pipeline->Segments[segmentIndex].SegmentID;
+    vtkMRMLSegmentationDisplayNode::SegmentDisplayProperties properties;
+    displayNode->GetSegmentDisplayProperties(segmentID, properties);
+    double color[3] = {vtkSegment::SEGMENT_COLOR_INVALID[0], vtkSegment::SEGMENT_COLOR_INVALID[1], vtkSegment::SEGMENT_COLOR_INVALID[2]};
+    displayNode->GetSegmentColor(segmentID, color);
+    bool fillVisible = properties.Visible2DFill && displayNode->GetVisibility2DFill();
+    bool outlineVisible = properties.Visible2DOutline && displayNode->GetVisibility2DOutline();
+    double fillColor[4] = { color[0], color[1], color[2],
+      fillVisible ? properties.Opacity2DFill * displayNode->GetOpacity2DFill() * displayNode->GetOpacity() : 0.0 };
+    double outlineColor[4] = { color[0], color[1], color[2],
+      outlineVisible ? properties.Opacity2DOutline * displayNode->GetOpacity2DOutline() * displayNode->GetOpacity() : 0.0 };
+    pipeline->ColorMapper->SetLabelColors(segmentIndex + 1, fillColor, outlineColor);
+    }
+  pipeline->ColorMapper->SetOutline(displayNode->GetSliceIntersectionThickness());
+
+  this->SetResliceInput(pipeline->Reslice, pipeline->SliceToImageTransform, pipeline->WorldToNodeTransform,
+    pipeline->MergedLabelmap);
+
+  pipeline->Actor->SetVisibility(true);
+  pipeline->Actor->SetPosition(0,0);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::MergeLabelmaps(CompositePipeline* pipeline,
+  vtkSegmentation* segmentation, const std::vector<std::string>& segmentIDs, vtkOrientedImageData* referenceLabelmap)
+{
+  pipeline->VisibleSegmentIDs = segmentIDs;
+  pipeline->Segments.clear();
+  int mergedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  referenceLabelmap->GetExtent(mergedExtent);
+  for (std::vector<std::string>::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    CompositePipeline::MergedSegment segment;
+    segment.SegmentID = *segmentIdIt;
+    segment.Composited = true;
+    segment.LabelmapMTime = 0;
+    pipeline->Segments.push_back(segment);
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segmentation->GetSegmentRepresentation(
+      *segmentIdIt, vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+    int* extent = labelmap->GetExtent();
+    for (int i = 0; i < 3; ++i)
+      {
+      mergedExtent[2 * i] = std::min(mergedExtent[2 * i], extent[2 * i]);
+      mergedExtent[2 * i + 1] = std::max(mergedExtent[2 * i + 1], extent[2 * i + 1]);
+      }
+    }
+
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  referenceLabelmap->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  pipeline->MergedLabelmap->SetExtent(mergedExtent);
+  pipeline->MergedLabelmap->AllocateScalars(VTK_SHORT, 1);
+  pipeline->MergedLabelmap->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+
+  std::vector<bool> overlappingSegments;
+  if (this->PaintMergedLabelmap(pipeline, segmentation, mergedExtent, overlappingSegments))
+    {
+    return;
+    }
+  // Where segments overlap, the fills of all the segments are blended and their
+  // outlines are drawn: leave the overlapping segments to their own pipelines.
+  // Not compositing segments can't make other segments overlap.
+  for (size_t segmentIndex = 0; segmentIndex < pipeline->Segments.size(); ++segmentIndex)
+    {
+    if (overlappingSegments[segmentIndex])
+      {
+      pipeline->Segments[segmentIndex].Composited = false;
+      }
+    }
+  this->PaintMergedLabelmap(pipeline, segmentation, mergedExtent, overlappingSegments);
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::HasCompositedSegments(CompositePipeline* pipeline)
+{
+  for (std::vector<CompositePipeline::MergedSegment>::iterator segmentIt = pipeline->Segments.begin();
+    segmentIt != pipeline->Segments.end(); ++segmentIt)
+    {
+    if (segmentIt->Composited)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::PaintMergedLabelmap(CompositePipeline* pipeline,
+  vtkSegmentation* segmentation, const int extent[6], std::vector<bool>& overlappingSegments)
+{
+  vtkOrientedImageDataResample::FillImage(pipeline->MergedLabelmap, 0, extent);
+  overlappingSegments.assign(pipeline->Segments.size(), false);
+  // Label i+1 is flagged when it is overwritten by another segment
+  std::vector<bool> overwrittenLabels(pipeline->Segments.size() + 1, false);
+  bool overlap = false;
+  std::vector<vtkOrientedImageData*> labelmaps;
+  for (size_t segmentIndex = 0; segmentIndex < pipeline->Segments.size(); ++segmentIndex)
+    {
+    CompositePipeline::MergedSegment& segment = pipeline->Segments[segmentIndex];
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segmentation->GetSegmentRepresentation(
+      segment.SegmentID, vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+    labelmaps.push_back(labelmap);
+    segment.LabelmapMTime = labelmap->GetMTime();
+    labelmap->GetExtent(segment.LabelmapExtent);
+    int paintExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (!segment.Composited || !IntersectExtents(extent, segment.LabelmapExtent, paintExtent))
+      {
+      continue;
+      }
+    std::fill(overwrittenLabels.begin(), overwrittenLabels.end(), false);
+    switch (labelmap->GetScalarType())
+      {
+      vtkTemplateMacro(PaintLabel(labelmap, pipeline->MergedLabelmap, paintExtent,
+        static_cast<short>(segmentIndex + 1), overwrittenLabels, static_cast<VTK_TT*>(0)));
+      }
+    for (size_t label = 1; label < overwrittenLabels.size(); ++label)
+      {
+      if (overwrittenLabels[label])
+        {
+        overlappingSegments[label - 1] = true;
+        overlappingSegments[segmentIndex] = true;
+        overlap = true;
+        }
+      }
+    }
+  // Segments that are not composited must not overlap the composited segments
+  for (size_t segmentIndex = 0; segmentIndex < pipeline->Segments.size() && !overlap; ++segmentIndex)
+    {
+    const CompositePipeline::MergedSegment& segment = pipeline->Segments[segmentIndex];
+    int checkExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (segment.Composited || !IntersectExtents(extent, segment.LabelmapExtent, checkExtent))
+      {
+      continue;
+      }
+    switch (labelmaps[segmentIndex]->GetScalarType())
+      {
+      vtkTemplateMacro(overlap = IsLabelOverlapping(labelmaps[segmentIndex], pipeline->MergedLabelmap,
+        checkExtent, static_cast<VTK_TT*>(0)));
+      }
+    }
+  pipeline->MergedLabelmap->Modified();
+  return !overlap;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::SetResliceInput(vtkImageReslice* reslice,
+  vtkGeneralTransform* sliceToImageTransform, vtkGeneralTransform* worldToNodeTransform, vtkOrientedImageData* imageData)
+{
+  // Calculate image IJK to world RAS transform
+  sliceToImageTransform->Identity();
+  sliceToImageTransform->Concatenate(this->SliceXYToRAS);
+  sliceToImageTransform->Concatenate(worldToNodeTransform);
+  vtkSmartPointer<vtkMatrix4x4> worldToImageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  imageData->GetWorldToImageMatrix(worldToImageMatrix);
+  sliceToImageTransform->Concatenate(worldToImageMatrix);
+
+  // Create temporary copy of the segment image with default origin and spacing
+  vtkSmartPointer<vtkImageData> identityImageData = vtkSmartPointer<vtkImageData>::New();
+  identityImageData->ShallowCopy(imageData);
+  identityImageData->SetOrigin(0.0, 0.0, 0.0);
+  identityImageData->SetSpacing(1.0, 1.0, 1.0);
+
+  // Set Reslice transform
+  // vtkImageReslice works faster if the input is a linear transform, so try to convert it
+  // to a linear transform.
+  // Also attempt to make it a permute transform, as it makes reslicing even faster.
+  vtkSmartPointer<vtkTransform> linearSliceToImageTransform = vtkSmartPointer<vtkTransform>::New();
+  if (vtkMRMLTransformNode::IsGeneralTransformLinear(sliceToImageTransform, linearSliceToImageTransform))
+    {
+    SnapToPermuteMatrix(linearSliceToImageTransform);
+    reslice->SetResliceTransform(linearSliceToImageTransform);
+    }
+  else
+    {
+    reslice->SetResliceTransform(sliceToImageTransform);
+    }
+
+  reslice->SetInputData(identityImageData);
+
+  int dimensions[3] = { 0, 0, 0 };
+  this->SliceNode->GetDimensions(dimensions);
+  int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
+  reslice->SetOutputExtent(sliceOutputExtent);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::AddObservations(vtkMRMLSegmentationNode* node)
 {
@@ -1143,6 +1630,26 @@ void vtkMRMLSegmentationsDisplayableManager2D::PrintSelf(ostream& os, vtkIndent
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "vtkMRMLSegmentationsDisplayableManager2D: " << this->GetClassName() << "\n";
+  os << indent << "CompositeLabelmaps: " << this->Internal->CompositeLabelmaps << "\n";
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::SetCompositeLabelmaps(bool composite)
+{
+  if (this->Internal->CompositeLabelmaps == composite)
+    {
+    return;
+    }
+  this->Internal->CompositeLabelmaps = composite;
+  this->Internal->UpdateAllDisplayNodePipelines();
+  this->Modified();
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLSegmentationsDisplayableManager2D::GetCompositeLabelmaps()
+{
+  return this->Internal->CompositeLabelmaps;
 }
 
 //---------------------------------------------------------------------------
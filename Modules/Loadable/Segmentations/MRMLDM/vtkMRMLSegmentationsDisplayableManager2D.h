@@ -43,6 +43,19 @@ public:
   /// \return Invalid string by default, meaning no information to display.
   virtual std::string GetDataProbeInfoStringForPosition(double xyz[3]) VTK_OVERRIDE;
 
+  /// If enabled, the binary labelmaps of the visible segments of a segmentation
+  /// are merged into a single segment index image, which is resliced once and
+  /// drawn by a single actor. When a labelmap is modified, only its extent is
+  /// merged again.
+  /// Segments that overlap other segments keep their own actors, so that their
+  /// fills are blended and all their outlines are drawn. Overlapping segments are
+  /// found when labelmaps are merged, and stay separate until the visible segments
+  /// change. If the labelmaps are not on the same voxel grid, all the segments keep
+  /// their own actors. Enabled by default.
+  void SetCompositeLabelmaps(bool composite);
+  bool GetCompositeLabelmaps();
+  vtkBooleanMacro(CompositeLabelmaps, bool);
+
 protected:
   virtual void UnobserveMRMLScene() VTK_OVERRIDE;
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node) VTK_OVERRIDE;
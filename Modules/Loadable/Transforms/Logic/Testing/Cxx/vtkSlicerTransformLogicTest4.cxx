@@ -0,0 +1,397 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Logic includes
+#include "vtkSlicerTransformLogic.h"
+
+// MRML includes
+#include "vtkMRMLBSplineTransformNode.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// vtkAddon includes
+#include <vtkOrientedBSplineTransform.h>
+#include <vtkOrientedGridTransform.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct ProgressInfo
+{
+  ProgressInfo() : NumberOfEvents(0), LastProgress(0.0) {}
+  int NumberOfEvents;
+  double LastProgress;
+};
+
+//----------------------------------------------------------------------------
+void onProgress(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                void* clientData, void* callData)
+{
+  ProgressInfo* info = reinterpret_cast<ProgressInfo*>(clientData);
+  info->NumberOfEvents++;
+  info->LastProgress = *reinterpret_cast<double*>(callData);
+}
+
+//----------------------------------------------------------------------------
+// Rotated and anisotropic volume, inside of the displacement grids to
+// avoid the convergence warnings of the inverse transforms
+vtkSmartPointer<vtkMRMLScalarVolumeNode> createReferenceVolume(vtkMRMLScene* scene)
+{
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 11, 0, 9, 0, 7);
+  image->AllocateScalars(VTK_SHORT, 1);
+  image->GetPointData()->GetScalars()->Fill(0);
+
+  vtkNew<vtkTransform> directions;
+  directions->RotateZ(30.0);
+  directions->RotateX(-15.0);
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetIJKToRASDirectionMatrix(directions->GetMatrix());
+  volumeNode->SetSpacing(3.0, 3.5, 4.0);
+  volumeNode->SetOrigin(-16.0, -15.0, -14.0);
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  scene->AddNode(volumeNode);
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> createVectorImage(int dimension, double spacing)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, dimension - 1, 0, dimension - 1, 0, dimension - 1);
+  image->SetSpacing(spacing, spacing, spacing);
+  double origin = -0.5 * spacing * (dimension - 1);
+  image->SetOrigin(origin, origin, origin);
+  image->AllocateScalars(VTK_DOUBLE, 3);
+  return image;
+}
+
+//----------------------------------------------------------------------------
+// Grid transform with a smooth displacement field, that is invertible
+vtkSmartPointer<vtkMRMLGridTransformNode> createGridTransformNode(vtkMRMLScene* scene)
+{
+  vtkSmartPointer<vtkImageData> displacements = createVectorImage(12, 8.0);
+  for (int k = 0; k < 12; ++k)
+    {
+    for (int j = 0; j < 12; ++j)
+      {
+      for (int i = 0; i < 12; ++i)
+        {
+        displacements->SetScalarComponentFromDouble(i, j, k, 0, 2.0 * sin(i * 0.4));
+        displacements->SetScalarComponentFromDouble(i, j, k, 1, 1.5 * cos(j * 0.3 + k * 0.2));
+        displacements->SetScalarComponentFromDouble(i, j, k, 2, 1.0 * sin(i * 0.2 + k * 0.5));
+        }
+      }
+    }
+  vtkNew<vtkTransform> directions;
+  directions->RotateY(10.0);
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacements);
+  gridTransform->SetGridDirectionMatrix(directions->GetMatrix());
+  gridTransform->SetInterpolationModeToCubic();
+
+  vtkSmartPointer<vtkMRMLGridTransformNode> transformNode = vtkSmartPointer<vtkMRMLGridTransformNode>::New();
+  transformNode->SetAndObserveTransformFromParent(gridTransform.GetPointer());
+  scene->AddNode(transformNode);
+  return transformNode;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLBSplineTransformNode> createBSplineTransformNode(vtkMRMLScene* scene)
+{
+  vtkSmartPointer<vtkImageData> coefficients = createVectorImage(8, 16.0);
+  for (int k = 0; k < 8; ++k)
+    {
+    for (int j = 0; j < 8; ++j)
+      {
+      for (int i = 0; i < 8; ++i)
+        {
+        coefficients->SetScalarComponentFromDouble(i, j, k, 0, 1.5 * sin(i + j * 0.5));
+        coefficients->SetScalarComponentFromDouble(i, j, k, 1, 1.0 * cos(j - k * 0.5));
+        coefficients->SetScalarComponentFromDouble(i, j, k, 2, 2.0 * sin(k * 0.7));
+        }
+      }
+    }
+  vtkNew<vtkMatrix4x4> directions;
+  vtkNew<vtkMatrix4x4> bulkTransform;
+  vtkNew<vtkOrientedBSplineTransform> bsplineTransform;
+  bsplineTransform->SetGridDirectionMatrix(directions.GetPointer());
+  bsplineTransform->SetCoefficientData(coefficients);
+  bsplineTransform->SetBulkTransformMatrix(bulkTransform.GetPointer());
+  bsplineTransform->SetBorderModeToZero();
+
+  vtkSmartPointer<vtkMRMLBSplineTransformNode> transformNode = vtkSmartPointer<vtkMRMLBSplineTransformNode>::New();
+  transformNode->SetAndObserveTransformFromParent(bsplineTransform.GetPointer());
+  scene->AddNode(transformNode);
+  return transformNode;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLLinearTransformNode> createLinearTransformNode(vtkMRMLScene* scene,
+                                                                      vtkTransform* transform)
+{
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  transformNode->SetMatrixTransformToParent(transform->GetMatrix());
+  scene->AddNode(transformNode);
+  return transformNode;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* getDisplacementGrid(vtkMRMLTransformNode* gridTransformNode)
+{
+  vtkOrientedGridTransform* gridTransform = gridTransformNode ?
+    vtkOrientedGridTransform::SafeDownCast(gridTransformNode->GetTransformFromParent()) : NULL;
+  return gridTransform ? gridTransform->GetDisplacementGrid() : NULL;
+}
+
+//----------------------------------------------------------------------------
+// Compare the sampled displacements with the displacements computed here
+// by transforming each voxel position with the given transform.
+int checkSamples(vtkImageData* image, vtkImageData* referenceImage, vtkMatrix4x4* ijkToRAS,
+                 vtkAbstractTransform* transform, bool magnitude, double tolerance)
+{
+  CHECK_NOT_NULL(image);
+  int extent[6];
+  image->GetExtent(extent);
+  int referenceExtent[6];
+  referenceImage->GetExtent(referenceExtent);
+  for (int i = 0; i < 6; ++i)
+    {
+    CHECK_INT(extent[i], referenceExtent[i]);
+    }
+  CHECK_INT(image->GetNumberOfScalarComponents(), magnitude ? 1 : 3);
+  vtkDataArray* samples = image->GetPointData()->GetScalars();
+
+  vtkIdType pointId = 0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i, ++pointId)
+        {
+        double point_IJK[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+        double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
+        double transformedPoint_RAS[3] = { 0.0, 0.0, 0.0 };
+        transform->TransformPoint(point_RAS, transformedPoint_RAS);
+        double expected[3] =
+          {
+          transformedPoint_RAS[0] - point_RAS[0],
+          transformedPoint_RAS[1] - point_RAS[1],
+          transformedPoint_RAS[2] - point_RAS[2]
+          };
+        if (magnitude)
+          {
+          expected[0] = vtkMath::Norm(expected);
+          }
+        for (int c = 0; c < (magnitude ? 1 : 3); ++c)
+          {
+          if (fabs(samples->GetComponent(pointId, c) - expected[c]) > tolerance)
+            {
+            std::cerr << "Line " << __LINE__ << ": sample (" << i << ", " << j << ", " << k
+                      << ") component " << c << " is " << samples->GetComponent(pointId, c)
+                      << ", expected " << expected[c] << std::endl;
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Sampled images must not depend on how rows are distributed between threads
+int checkSameSamples(vtkImageData* image, vtkImageData* serialImage)
+{
+  CHECK_NOT_NULL(image);
+  CHECK_NOT_NULL(serialImage);
+  vtkDataArray* samples = image->GetPointData()->GetScalars();
+  vtkDataArray* serialSamples = serialImage->GetPointData()->GetScalars();
+  CHECK_INT(samples->GetNumberOfTuples(), serialSamples->GetNumberOfTuples());
+  CHECK_INT(samples->GetNumberOfComponents(), serialSamples->GetNumberOfComponents());
+  for (vtkIdType i = 0; i < samples->GetNumberOfTuples(); ++i)
+    {
+    for (int c = 0; c < samples->GetNumberOfComponents(); ++c)
+      {
+      if (samples->GetComponent(i, c) != serialSamples->GetComponent(i, c))
+        {
+        std::cerr << "Line " << __LINE__ << ": sample " << i << " component " << c
+                  << " differs from the serial sampling: " << samples->GetComponent(i, c)
+                  << " != " << serialSamples->GetComponent(i, c) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+struct SampledImages
+{
+  vtkSmartPointer<vtkImageData> Vectors;
+  vtkSmartPointer<vtkImageData> Magnitudes;
+  vtkSmartPointer<vtkImageData> Grid;
+};
+
+//----------------------------------------------------------------------------
+SampledImages sampleTransform(vtkSlicerTransformLogic* logic, vtkMRMLTransformNode* transformNode,
+                              vtkMRMLVolumeNode* referenceVolumeNode)
+{
+  SampledImages images;
+  vtkMRMLVolumeNode* vectorVolumeNode = logic->CreateDisplacementVolumeFromTransform(
+    transformNode, referenceVolumeNode, false);
+  images.Vectors = vectorVolumeNode ? vectorVolumeNode->GetImageData() : NULL;
+  vtkMRMLVolumeNode* magnitudeVolumeNode = logic->CreateDisplacementVolumeFromTransform(
+    transformNode, referenceVolumeNode, true);
+  images.Magnitudes = magnitudeVolumeNode ? magnitudeVolumeNode->GetImageData() : NULL;
+  images.Grid = getDisplacementGrid(logic->ConvertToGridTransform(transformNode, referenceVolumeNode));
+  return images;
+}
+
+//----------------------------------------------------------------------------
+// Sample the transform on several threads and on a single thread, compare
+// both and compare with the transform to and from world.
+int checkTransformSampling(vtkSlicerTransformLogic* logic, vtkMRMLTransformNode* transformNode,
+                           vtkMRMLVolumeNode* referenceVolumeNode,
+                           vtkAbstractTransform* transformToWorld, vtkAbstractTransform* transformFromWorld,
+                           double tolerance)
+{
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  referenceVolumeNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  vtkImageData* referenceImage = referenceVolumeNode->GetImageData();
+
+  // Make sure that rows are distributed between threads, whatever the
+  // number of processors
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(4);
+  ProgressInfo progress;
+  vtkNew<vtkCallbackCommand> progressCallback;
+  progressCallback->SetCallback(onProgress);
+  progressCallback->SetClientData(&progress);
+  unsigned long observerTag = logic->AddObserver(vtkCommand::ProgressEvent, progressCallback.GetPointer());
+  SampledImages images = sampleTransform(logic, transformNode, referenceVolumeNode);
+  logic->RemoveObserver(observerTag);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  CHECK_BOOL(progress.NumberOfEvents >= 3, true);
+  CHECK_DOUBLE(progress.LastProgress, 1.0);
+
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  SampledImages serialImages = sampleTransform(logic, transformNode, referenceVolumeNode);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+
+  CHECK_EXIT_SUCCESS(checkSameSamples(images.Vectors, serialImages.Vectors));
+  CHECK_EXIT_SUCCESS(checkSameSamples(images.Magnitudes, serialImages.Magnitudes));
+  CHECK_EXIT_SUCCESS(checkSameSamples(images.Grid, serialImages.Grid));
+
+  CHECK_EXIT_SUCCESS(checkSamples(images.Vectors, referenceImage, ijkToRAS.GetPointer(),
+    transformToWorld, false, tolerance));
+  CHECK_EXIT_SUCCESS(checkSamples(images.Magnitudes, referenceImage, ijkToRAS.GetPointer(),
+    transformToWorld, true, tolerance));
+  // grid transforms are computed from world
+  CHECK_EXIT_SUCCESS(checkSamples(images.Grid, referenceImage, ijkToRAS.GetPointer(),
+    transformFromWorld, false, tolerance));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int testLinearTransformChain(vtkSlicerTransformLogic* logic, vtkMRMLVolumeNode* referenceVolumeNode)
+{
+  vtkMRMLScene* scene = logic->GetMRMLScene();
+  vtkNew<vtkTransform> parentTransform;
+  parentTransform->Translate(3.0, -4.0, 5.0);
+  parentTransform->RotateX(20.0);
+  vtkNew<vtkTransform> childTransform;
+  childTransform->Translate(-2.0, 1.0, 0.5);
+  childTransform->RotateZ(-35.0);
+  childTransform->Scale(1.1, 0.9, 1.05);
+  vtkSmartPointer<vtkMRMLLinearTransformNode> parentNode =
+    createLinearTransformNode(scene, parentTransform.GetPointer());
+  vtkSmartPointer<vtkMRMLLinearTransformNode> childNode =
+    createLinearTransformNode(scene, childTransform.GetPointer());
+  childNode->SetAndObserveTransformNodeID(parentNode->GetID());
+
+  // Expected displacements are computed from the matrices
+  vtkNew<vtkTransform> transformToWorld;
+  transformToWorld->Concatenate(parentTransform.GetPointer());
+  transformToWorld->Concatenate(childTransform.GetPointer());
+  vtkNew<vtkTransform> transformFromWorld;
+  transformFromWorld->SetMatrix(transformToWorld->GetMatrix());
+  transformFromWorld->Inverse();
+
+  return checkTransformSampling(logic, childNode, referenceVolumeNode,
+    transformToWorld.GetPointer(), transformFromWorld.GetPointer(), 1e-4);
+}
+
+//----------------------------------------------------------------------------
+int testNonLinearTransformChain(vtkSlicerTransformLogic* logic, vtkMRMLVolumeNode* referenceVolumeNode)
+{
+  vtkMRMLScene* scene = logic->GetMRMLScene();
+  vtkNew<vtkTransform> linearTransform;
+  linearTransform->Translate(1.0, 2.0, -1.5);
+  linearTransform->RotateY(12.0);
+  vtkSmartPointer<vtkMRMLLinearTransformNode> linearNode =
+    createLinearTransformNode(scene, linearTransform.GetPointer());
+  vtkSmartPointer<vtkMRMLGridTransformNode> gridNode = createGridTransformNode(scene);
+  gridNode->SetAndObserveTransformNodeID(linearNode->GetID());
+  vtkSmartPointer<vtkMRMLBSplineTransformNode> bsplineNode = createBSplineTransformNode(scene);
+  bsplineNode->SetAndObserveTransformNodeID(gridNode->GetID());
+
+  // Expected displacements are computed serially, with the transform chain
+  vtkNew<vtkGeneralTransform> transformToWorld;
+  bsplineNode->GetTransformToWorld(transformToWorld.GetPointer());
+  vtkNew<vtkGeneralTransform> transformFromWorld;
+  bsplineNode->GetTransformFromWorld(transformFromWorld.GetPointer());
+
+  return checkTransformSampling(logic, bsplineNode, referenceVolumeNode,
+    transformToWorld.GetPointer(), transformFromWorld.GetPointer(), 1e-4);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerTransformLogicTest4(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkSlicerTransformLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> referenceVolumeNode = createReferenceVolume(scene.GetPointer());
+
+  CHECK_EXIT_SUCCESS(testLinearTransformChain(logic.GetPointer(), referenceVolumeNode));
+  CHECK_EXIT_SUCCESS(testNonLinearTransformChain(logic.GetPointer(), referenceVolumeNode));
+
+  return EXIT_SUCCESS;
+}
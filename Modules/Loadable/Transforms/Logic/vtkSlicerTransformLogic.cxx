@@ -44,6 +44,8 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkLine.h>
 #include <vtkLookupTable.h>
 #include <vtkMath.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -77,8 +79,178 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "itkTranslationTransform.h"
 #include "itkTransformFactory.h"
 
+// STD includes
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkSlicerTransformLogic);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct DisplacementSamplingInfo
+{
+  // Transform copy used by each thread, transforms cache results
+  // (e.g. warning states) and are not safe to share between threads.
+  std::vector<vtkSmartPointer<vtkAbstractTransform> > Transforms;
+  // Set if the transform is linear, then transforms are not used.
+  vtkMatrix4x4* LinearTransform;
+  vtkMatrix4x4* IJKToRAS;
+  float* Voxels;
+  int NumberOfComponents; // 3 for displacement vectors, 1 for magnitude
+  int Extent[6];
+  int NumberOfRows;
+  int NextRow;
+  vtkSimpleMutexLock* Lock;
+  // Progress is reported by the calling thread (thread 0) only
+  vtkObject* ProgressReporter;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE SampleDisplacementRowsThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  DisplacementSamplingInfo* info = static_cast<DisplacementSamplingInfo*>(threadInfo->UserData);
+  vtkAbstractTransform* transform = info->LinearTransform ? NULL : info->Transforms[threadInfo->ThreadID].GetPointer();
+  const int* extent = info->Extent;
+  const int rowLength = extent[1] - extent[0] + 1;
+  const int numberOfRowsPerSlice = extent[3] - extent[2] + 1;
+  const bool reportProgress = (threadInfo->ThreadID == 0 && info->ProgressReporter != NULL);
+  int lastReportedPercent = 0;
+
+  double point_IJK[4] = { 0, 0, 0, 1 };
+  double point_RAS[4] = { 0, 0, 0, 1 };
+  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
+  while (true)
+    {
+    info->Lock->Lock();
+    int row = info->NextRow++;
+    info->Lock->Unlock();
+    if (row >= info->NumberOfRows)
+      {
+      break;
+      }
+    if (reportProgress && row * 100 / info->NumberOfRows > lastReportedPercent)
+      {
+      lastReportedPercent = row * 100 / info->NumberOfRows;
+      double progress = static_cast<double>(row) / info->NumberOfRows;
+      info->ProgressReporter->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      }
+
+    point_IJK[1] = extent[2] + row % numberOfRowsPerSlice;
+    point_IJK[2] = extent[4] + row / numberOfRowsPerSlice;
+    float* voxelPtr = info->Voxels + static_cast<vtkIdType>(row) * rowLength * info->NumberOfComponents;
+    for (int i = 0; i < rowLength; i++)
+      {
+      point_IJK[0] = extent[0] + i;
+      info->IJKToRAS->MultiplyPoint(point_IJK, point_RAS);
+      if (transform)
+        {
+        transform->TransformPoint(point_RAS, transformedPoint_RAS);
+        }
+      else
+        {
+        info->LinearTransform->MultiplyPoint(point_RAS, transformedPoint_RAS);
+        }
+      double displacement[3] =
+        {
+        transformedPoint_RAS[0] - point_RAS[0],
+        transformedPoint_RAS[1] - point_RAS[1],
+        transformedPoint_RAS[2] - point_RAS[2]
+        };
+      if (info->NumberOfComponents == 3)
+        {
+        // store the pointDislocationVector_RAS components in the image
+        *(voxelPtr++) = static_cast<float>(displacement[0]);
+        *(voxelPtr++) = static_cast<float>(displacement[1]);
+        *(voxelPtr++) = static_cast<float>(displacement[2]);
+        }
+      else
+        {
+        *(voxelPtr++) = static_cast<float>(vtkMath::Norm(displacement));
+        }
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Fill the image with the displacement (vector or magnitude) of the transform at each voxel.
+// Rows of voxels are distributed between threads. If progressReporter is set,
+// it invokes vtkCommand::ProgressEvent.
+bool GetTransformedPointSamplesAsImage(vtkImageData* image, vtkMRMLTransformNode* inputTransformNode,
+  vtkMatrix4x4* ijkToRAS, bool transformToWorld, bool magnitude, vtkObject* progressReporter)
+{
+  vtkNew<vtkGeneralTransform> inputTransform;
+  if (transformToWorld)
+    {
+    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
+    }
+  else
+    {
+    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
+    }
+
+  // The orientation of the volume cannot be set in the image
+  // therefore the volume will not appear in the correct position
+  // if the direction matrix is not identity.
+  image->AllocateScalars(VTK_FLOAT, magnitude ? 1 : 3);
+
+  DisplacementSamplingInfo info;
+  info.IJKToRAS = ijkToRAS;
+  info.Voxels = static_cast<float*>(image->GetScalarPointer());
+  info.NumberOfComponents = (magnitude ? 1 : 3);
+  image->GetExtent(info.Extent);
+  info.NumberOfRows = (info.Extent[3] - info.Extent[2] + 1) * (info.Extent[5] - info.Extent[4] + 1);
+  info.NextRow = 0;
+  info.ProgressReporter = progressReporter;
+  if (info.NumberOfRows <= 0 || info.Extent[1] < info.Extent[0])
+    {
+    return true;
+    }
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(std::min(threader->GetNumberOfThreads(), info.NumberOfRows));
+
+  // Linear transform chains (e.g. only linear transforms in the hierarchy)
+  // are evaluated by a matrix multiplication
+  vtkNew<vtkTransform> linearTransform;
+  info.LinearTransform = NULL;
+  if (vtkMRMLTransformNode::IsGeneralTransformLinear(inputTransform.GetPointer(), linearTransform.GetPointer()))
+    {
+    info.LinearTransform = linearTransform->GetMatrix();
+    }
+  else
+    {
+    inputTransform->Update();
+    info.Transforms.push_back(inputTransform.GetPointer());
+    for (int threadId = 1; threadId < threader->GetNumberOfThreads(); ++threadId)
+      {
+      vtkSmartPointer<vtkAbstractTransform> transformCopy =
+        vtkSmartPointer<vtkAbstractTransform>::Take(inputTransform->MakeTransform());
+      transformCopy->DeepCopy(inputTransform.GetPointer());
+      transformCopy->Update();
+      info.Transforms.push_back(transformCopy);
+      }
+    }
+
+  vtkNew<vtkSimpleMutexLock> lock;
+  info.Lock = lock.GetPointer();
+  threader->SetSingleMethod(SampleDisplacementRowsThreadFunction, &info);
+  threader->SingleMethodExecute();
+
+  if (progressReporter)
+    {
+    double progress = 1.0;
+    progressReporter->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    }
+  image->Modified();
+  return true;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSlicerTransformLogic::vtkSlicerTransformLogic()
 {
@@ -393,53 +565,8 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(vtkImag
     vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage failed: invalid input");
     return false;
   }
-
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
-
-  // The orientation of the volume cannot be set in the image
-  // therefore the volume will not appear in the correct position
-  // if the direction matrix is not identity.
-  magnitudeImage->AllocateScalars(VTK_FLOAT, 1);
-
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(magnitudeImage->GetScalarPointer());
-  int* extent = magnitudeImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
-  {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-        pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-        pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-        float mag = sqrt(
-          pointDislocationVector_RAS[0] * pointDislocationVector_RAS[0] +
-          pointDislocationVector_RAS[1] * pointDislocationVector_RAS[1] +
-          pointDislocationVector_RAS[2] * pointDislocationVector_RAS[2]);
-
-        *(voxelPtr++) = mag;
-      }
-    }
-  }
-
-  return true;
+  return GetTransformedPointSamplesAsImage(magnitudeImage, inputTransformNode, ijkToRAS, transformToWorld,
+    true /* magnitude */, NULL /* no progress reporting */);
 }
 
 //----------------------------------------------------------------------------
@@ -522,14 +649,8 @@ vtkMRMLVolumeNode* vtkSlicerTransformLogic::CreateDisplacementVolumeFromTransfor
   }
 
   // Fill the volume
-  if (magnitude)
-  {
-    vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(outputVolume, inputTransformNode, ijkToRas.GetPointer());
-  }
-  else
-  {
-    vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(outputVolume, inputTransformNode, ijkToRas.GetPointer());
-  }
+  GetTransformedPointSamplesAsImage(outputVolume, inputTransformNode, ijkToRas.GetPointer(),
+    true /* transform to world */, magnitude, this);
 
   if (outputVolumeNode->GetDisplayNode() == NULL)
   {
@@ -674,7 +795,8 @@ vtkMRMLTransformNode* vtkSlicerTransformLogic::ConvertToGridTransform(vtkMRMLTra
 
   // Fill the volume with displacement values
   bool transformToWorld = false; // usually grid transform is defined as transform from parent
-  vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(outputVolume, inputTransformNode, ijkToRas.GetPointer(), transformToWorld);
+  GetTransformedPointSamplesAsImage(outputVolume, inputTransformNode, ijkToRas.GetPointer(), transformToWorld,
+    false /* vectors */, this);
 
   return outputGridTransformNode.GetPointer();
 }
@@ -688,45 +810,8 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageDa
     vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage failed: invalid input");
     return false;
   }
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
-
-  // The orientation of the volume cannot be set in the image
-  // therefore the volume will not appear in the correct position
-  // if the direction matrix is not identity.
-  vectorImage->AllocateScalars(VTK_FLOAT, 3);
-
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(vectorImage->GetScalarPointer());
-  int* extent = vectorImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
-  {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        // store the pointDislocationVector_RAS components in the image
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[0] - point_RAS[0]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[1] - point_RAS[1]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[2] - point_RAS[2]);
-      }
-    }
-  }
-
-  return true;
+  return GetTransformedPointSamplesAsImage(vectorImage, inputTransformNode, ijkToRAS, transformToWorld,
+    false /* vectors */, NULL /* no progress reporting */);
 }
 
 //----------------------------------------------------------------------------
@@ -103,12 +103,14 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// If magnitude is false then a 3-component scalar volume is created, each voxel containing the displacement vector.
   /// referenceVolumeNode specifies the volume origin, spacing, extent, and orientation.
   /// If existingOutputVolumeNode is specified then instead of creating a new volume node, that existing node will be updated.
+  /// Voxels are computed by multiple threads, vtkCommand::ProgressEvent is invoked on the logic while they are computed.
   vtkMRMLVolumeNode* CreateDisplacementVolumeFromTransform(vtkMRMLTransformNode* inputTransformNode, vtkMRMLVolumeNode* referenceVolumeNode = NULL,
     bool magnitude = true, vtkMRMLVolumeNode* existingOutputVolumeNode = NULL);
 
   /// Convert the input transform to a grid transform.
   /// If referenceVolumeNode is specified then it will determine the origin, spacing, extent, and orientation of the displacement field.
   /// If existingOutputTransformNode is specified then instead of creating a new transform node, that existing node will be updated.
+  /// Displacements are computed by multiple threads, vtkCommand::ProgressEvent is invoked on the logic while they are computed.
   vtkMRMLTransformNode* ConvertToGridTransform(vtkMRMLTransformNode* inputTransformNode, vtkMRMLVolumeNode* referenceVolumeNode = NULL,
     vtkMRMLTransformNode* existingOutputTransformNode = NULL);
 
@@ -117,6 +119,7 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// The origin and spacing attributes of the output image are ignored (origin, spacing, and axis directions
   /// are all specified by ijkToRAS).
   /// If transformToWorld is true then transform to world is returned, otherwise transform from world is returned.
+  /// Voxels are computed by multiple threads, each using its own copy of the transform.
   /// Returns true on success.
   static bool GetTransformedPointSamplesAsMagnitudeImage(vtkImageData* outputMagnitudeImage, vtkMRMLTransformNode* inputTransformNode,
     vtkMatrix4x4* ijkToRAS, bool transformToWorld = true);
@@ -126,6 +129,7 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// The origin and spacing attributes of the output image are ignored (origin, spacing, and axis directions
   /// are all specified by ijkToRAS).
   /// If transformToWorld is true then transform to world is returned, otherwise transform from world is returned.
+  /// Voxels are computed by multiple threads, each using its own copy of the transform.
   /// Returns true on success.
   static bool GetTransformedPointSamplesAsVectorImage(vtkImageData* outputVectorImage, vtkMRMLTransformNode* inputTransformNode,
     vtkMatrix4x4* ijkToRAS, bool transformToWorld = true);